@@ -0,0 +1,22 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#library("builtin");
+
+void print(arg) {
+  _Logger._printString(arg.toString());
+}
+
+void exit(int status) {
+  if (status is !int) {
+    throw new IllegalArgumentException("int status expected");
+  }
+  _exit(status);
+}
+
+_exit(int status) native "Exit";
+
+class _Logger {
+  static void _printString(String s) native "Logger_PrintString";
+}
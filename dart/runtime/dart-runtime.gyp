@@ -29,5 +29,17 @@
         'vm/dart_api_impl.cc',
       ],
     },
+    {
+      # Standalone tool computing the retained sizes of the objects in a heap
+      # snapshot, see Dart_CreateHeapSnapshot.
+      'target_name': 'heap_snapshot_analyzer',
+      'type': 'executable',
+      'include_dirs': [
+        '.',
+      ],
+      'sources': [
+        'tools/heap_snapshot_analyzer.cc',
+      ],
+    },
   ],
 }
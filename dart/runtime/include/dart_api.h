@@ -100,6 +100,102 @@ DART_EXPORT Dart_Isolate Dart_CurrentIsolate();
 DART_EXPORT void Dart_EnterIsolate(Dart_Isolate isolate);
 DART_EXPORT void Dart_ExitIsolate();
 
+// Collects the garbage in the old generation of the current isolate and
+// compacts it, returning the memory of the pages left empty to the system.
+DART_EXPORT void Dart_CompactHeap();
+
+// Limits the size of each of the two semi-spaces of the new generation of the
+// current isolate, in kilobytes. The new generation grows and shrinks within
+// these limits depending on how often it is collected and how much of it
+// survives. The defaults are set by the --new_gen_semi_min_size and
+// --new_gen_semi_max_size flags.
+DART_EXPORT void Dart_SetNewSpaceLimits(intptr_t min_semi_space_kb,
+                                        intptr_t max_semi_space_kb);
+
+// Limits the size of the old generation of the current isolate, in
+// kilobytes. The default is set by the --old_gen_heap_size flag. Once an
+// allocation fails after a full collection, it is served from a reserve and
+// an OutOfMemoryException is thrown to the Dart code of the isolate when it
+// next returns from the VM runtime or a native function. Exhausting the
+// reserve as well aborts the process.
+DART_EXPORT void Dart_SetOldSpaceLimit(intptr_t max_old_space_kb);
+
+// Statistics of one space of the heap of an isolate. The code space is only
+// collected together with the old space, its pauses are included in both.
+typedef struct {
+  intptr_t used;  // Bytes in use by objects.
+  intptr_t capacity;  // Bytes reserved for objects.
+  intptr_t collections;  // Number of collections of the space.
+  int64_t collection_time_micros;  // Total pause time of the collections.
+  intptr_t unswept;  // Bytes in pages still to be swept, counted as used.
+  int64_t sweep_time_micros;  // Total time spent sweeping pages on demand.
+} Dart_HeapSpaceStats;
+
+typedef struct {
+  Dart_HeapSpaceStats new_space;
+  Dart_HeapSpaceStats old_space;
+  Dart_HeapSpaceStats code_space;
+} Dart_HeapStats;
+
+// Fills in the statistics of the heap of the current isolate. Cheap enough
+// to be polled periodically.
+DART_EXPORT void Dart_GetHeapStats(Dart_HeapStats* stats);
+
+typedef void (*Dart_HeapClassStatsCallback)(void* callback_data,
+                                            const char* class_name,
+                                            intptr_t instance_count,
+                                            intptr_t instance_bytes);
+
+// Walks all objects in the heap of the current isolate, including garbage
+// which has not been collected yet, and calls 'callback' once for each class
+// with instances with their number and the bytes they occupy. Classes are
+// reported by decreasing number of bytes. The walk takes time proportional
+// to the size of the heap.
+DART_EXPORT void Dart_GetHeapClassStats(Dart_HeapClassStatsCallback callback,
+                                        void* callback_data);
+
+typedef enum {
+  kGCScavenge = 0,
+  kGCMarkSweep,
+  kGCMarkCompact,
+} Dart_GCKind;
+
+typedef enum {
+  kGCAllocation = 0,  // An allocation did not fit into its space.
+  kGCPromotion,  // Promotion grew the old generation beyond its growth limit.
+  kGCFragmentation,  // The old generation was compacted between messages.
+  kGCExplicit,  // Requested by the VM or the embedder.
+} Dart_GCReason;
+
+// A garbage collection pause of an isolate. Times are in microseconds since
+// the epoch, sizes are the bytes in use in the whole heap of the isolate.
+typedef struct {
+  Dart_GCKind kind;
+  Dart_GCReason reason;
+  int64_t start_micros;
+  int64_t duration_micros;
+  intptr_t used_before;
+  intptr_t used_after;
+} Dart_GCEvent;
+
+typedef void (*Dart_GCEventCallback)(const Dart_GCEvent* event);
+
+// Sets the callback which is called after each garbage collection of any
+// isolate, on the thread of the collected isolate. The callback must not
+// call back into the Dart API.
+DART_EXPORT void Dart_SetGCEventCallback(Dart_GCEventCallback callback);
+
+// Copies up to 'length' of the most recent garbage collections of the
+// current isolate into 'events', oldest first, and returns their number. The
+// last 256 collections are kept.
+DART_EXPORT intptr_t Dart_GetGCEvents(Dart_GCEvent* events, intptr_t length);
+
+// Returns an upper bound in microseconds of the pause time of 'percentile'
+// percent of the collections of the given kind of the current isolate, or 0
+// if there were none. The bound is a power of two.
+DART_EXPORT int64_t Dart_GetGCPausePercentile(Dart_GCKind kind,
+                                              intptr_t percentile);
+
 // A convenience routine which processes any incoming messages for the
 // current isolate. The routine exits when all ports to the current
 // isolate are closed.
@@ -155,6 +251,19 @@ DART_EXPORT void Dart_SetMessageCallbacks(
     Dart_ClosePortCallback close_port_callback);
 
 // Handle a message on the current isolate.
+//
+// Once the message is handled, the isolate also runs the work it defers
+// until no Dart code is running: it writes a requested heap snapshot,
+// compacts a fragmented old space and compiles the functions queued for
+// optimization by --deferred_compilation. This work runs on the thread
+// calling Dart_HandleMessage. Embedders which deliver messages with a post
+// message callback must therefore keep calling Dart_HandleMessage.
+// Limitations:
+//  - This work is skipped when Dart_HandleMessage is called while Dart code
+//    of the isolate is running, e.g. from a native function. It is done
+//    when a later message is handled.
+//  - An isolate which receives no messages never runs it. Queued functions
+//    are then compiled when they get hot again, old space is not compacted.
 DART_EXPORT void Dart_HandleMessage(Dart_Port dest_port,
                                     Dart_Port reply_port,
                                     Dart_Message dart_message);
@@ -323,7 +432,21 @@ DART_EXPORT void Dart_EnterScope();
 DART_EXPORT void Dart_ExitScope();
 
 DART_EXPORT Dart_Handle Dart_NewPersistentHandle(Dart_Handle object);
-DART_EXPORT Dart_Handle Dart_MakeWeakPersistentHandle(Dart_Handle object);
+
+typedef void (*Dart_WeakPersistentHandleFinalizer)(Dart_Handle handle,
+                                                   void* peer);
+
+// Creates a weak persistent handle to the object of the local or persistent
+// handle 'object'. The weak handle does not keep the object alive. Once a
+// garbage collection finds the object unreachable, the handle is set to null
+// and 'callback' is called with the handle and 'peer'. The callbacks of all
+// handles cleared by a collection are run in a batch right after it, on the
+// thread of the isolate. A callback must not call back into the Dart API,
+// except to delete its handle with Dart_DeletePersistentHandle.
+DART_EXPORT Dart_Handle Dart_MakeWeakPersistentHandle(
+    Dart_Handle object,
+    void* peer,
+    Dart_WeakPersistentHandleFinalizer callback);
 DART_EXPORT Dart_Handle Dart_MakePersistentHandle(Dart_Handle object);
 DART_EXPORT void Dart_DeletePersistentHandle(Dart_Handle object);
 
@@ -353,6 +476,29 @@ DART_EXPORT Dart_Handle Dart_SetNativeInstanceField(Dart_Handle obj,
 DART_EXPORT Dart_Handle Dart_CreateSnapshot(uint8_t** snaphot_buffer,
                                             intptr_t* snapshot_size);
 
+// Heap snapshots for memory leak analysis.
+//
+// A heap snapshot is a compact binary graph of all objects in the heap of the
+// current isolate, with their classes, sizes and references, and of the roots
+// of the isolate. See runtime/vm/heap_snapshot.h for its format and
+// runtime/tools/heap_snapshot_analyzer.cc for a tool computing the retained
+// sizes of the objects in a snapshot.
+DART_EXPORT Dart_Handle Dart_CreateHeapSnapshot(uint8_t** buffer,
+                                                intptr_t* buffer_size);
+
+typedef void (*Dart_HeapSnapshotCallback)(const uint8_t* buffer,
+                                          intptr_t buffer_size);
+
+// Sets the callback which receives the snapshots requested with
+// Dart_RequestHeapSnapshot. The buffer is only valid during the call.
+DART_EXPORT void Dart_SetHeapSnapshotCallback(
+    Dart_HeapSnapshotCallback callback);
+
+// Requests a heap snapshot of the next isolate which handles a message, see
+// Dart_HandleMessage. Only sets a flag, so it is safe to call from a signal
+// handler.
+DART_EXPORT void Dart_RequestHeapSnapshot();
+
 // Message communication.
 DART_EXPORT bool Dart_PostIntArray(Dart_Port port,
                                    int field_count,
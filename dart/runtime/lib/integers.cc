@@ -201,6 +201,20 @@ DEFINE_NATIVE_ENTRY(Integer_bitXorFromInteger, 2) {
 }
 
 
+// On 64-bit platforms the product of two Smis does not always fit in an
+// int64_t; such products are computed with Bigints instead.
+static bool SmiProductMayOverflow(const Smi& left, const Smi& right) {
+  if (Smi::kBits < 32) {
+    return false;
+  }
+  const int64_t kLimit = static_cast<int64_t>(1) << 31;
+  const int64_t left_value = left.Value();
+  const int64_t right_value = right.Value();
+  return (left_value <= -kLimit) || (left_value >= kLimit) ||
+         (right_value <= -kLimit) || (right_value >= kLimit);
+}
+
+
 // The result is invalid if it is outside the range
 // Smi::kMaxValue..Smi::kMinValue.
 static int64_t BinaryOpWithTwoSmis(Token::Kind operation,
@@ -212,16 +226,11 @@ static int64_t BinaryOpWithTwoSmis(Token::Kind operation,
     case Token::kSUB:
       return left.Value() - right.Value();
     case Token::kMUL: {
-#if defined(TARGET_ARCH_X64)
-      // Overflow check for 64-bit platforms unimplemented.
-      UNIMPLEMENTED();
-      return 0;
-#else
+      ASSERT(!SmiProductMayOverflow(left, right));
       int64_t result_64 =
           static_cast<int64_t>(left.Value()) *
           static_cast<int64_t>(right.Value());
       return result_64;
-#endif
     }
     case Token::kTRUNCDIV:
       return left.Value() / right.Value();
@@ -280,12 +289,15 @@ static RawInteger* IntegerBinopHelper(Token::Kind operation,
     Smi& right_smi = Smi::Handle();
     left_smi ^= left_int.raw();
     right_smi ^= right_int.raw();
-    int64_t result = BinaryOpWithTwoSmis(operation, left_smi, right_smi);
-    if (Smi::IsValid64(result)) {
-      return Smi::New(result);
-    } else {
-      // Overflow to Mint.
-      return Mint::New(result);
+    if ((operation != Token::kMUL) ||
+        !SmiProductMayOverflow(left_smi, right_smi)) {
+      int64_t result = BinaryOpWithTwoSmis(operation, left_smi, right_smi);
+      if (Smi::IsValid64(result)) {
+        return Smi::New(result);
+      } else {
+        // Overflow to Mint.
+        return Mint::New(result);
+      }
     }
   } else if (AreBoth64bitOperands(left_int, right_int)) {
     // TODO(srdjan): Test for overflow of result instead of operand
@@ -0,0 +1,611 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Reads a heap snapshot written by the VM, see runtime/vm/heap_snapshot.h,
+// and prints the classes occupying most of the heap and the objects retaining
+// most of it. The retained size of an object is the number of bytes which
+// would be freed if the object was collected: its own size and the sizes of
+// the objects it dominates, i.e. of the objects only reachable through it.
+// Dominators are computed with the iterative algorithm described in "A Simple,
+// Fast Dominance Algorithm" by Cooper, Harvey and Kennedy.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "include/dart_api.h"
+
+#include "bin/globals.h"
+
+// Keep in sync with HeapSnapshotWriter in runtime/vm/heap_snapshot.h.
+static const char kMagic[] = "dartheap";
+static const intptr_t kMagicLength = 8;
+static const uintptr_t kVersion = 1;
+enum RecordTag {
+  kEndRecord = 0,
+  kObjectRecord,
+  kClassRecord,
+  kRootRecord,
+};
+
+static const intptr_t kDefaultTop = 20;
+// Maximal number of dominators printed for each of the top objects.
+static const intptr_t kMaxDominatorChain = 10;
+static const intptr_t kBitsPerUnsigned = 8 * sizeof(uintptr_t);
+static const intptr_t kRoot = 0;
+static const intptr_t kNoNode = -1;
+
+
+static void* Allocate(intptr_t size) {
+  void* result = malloc(size);
+  if (result == NULL) {
+    fprintf(stderr, "Out of memory\n");
+    exit(255);
+  }
+  return result;
+}
+
+
+static void* Reallocate(void* ptr, intptr_t size) {
+  void* result = realloc(ptr, size);
+  if (result == NULL) {
+    fprintf(stderr, "Out of memory\n");
+    exit(255);
+  }
+  return result;
+}
+
+
+// Growable array of plain values.
+template<typename T>
+class Array {
+ public:
+  Array() : data_(NULL), length_(0), capacity_(0) {}
+  ~Array() { free(data_); }
+
+  intptr_t length() const { return length_; }
+  T& operator[](intptr_t index) const { return data_[index]; }
+
+  void Add(T value) {
+    if (length_ == capacity_) {
+      capacity_ = (capacity_ == 0) ? 1024 : (2 * capacity_);
+      data_ = reinterpret_cast<T*>(Reallocate(data_, capacity_ * sizeof(T)));
+    }
+    data_[length_++] = value;
+  }
+
+  void SetLength(intptr_t length, T value) {
+    while (length_ < length) {
+      Add(value);
+    }
+  }
+
+ private:
+  T* data_;
+  intptr_t length_;
+  intptr_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(Array);
+};
+
+
+// Maps the ids of the snapshot to indices. Open addressed, ids are never 0.
+class IdMap {
+ public:
+  IdMap() : keys_(NULL), values_(NULL), count_(0), capacity_(0) { Grow(); }
+  ~IdMap() {
+    free(keys_);
+    free(values_);
+  }
+
+  void Insert(uintptr_t key, intptr_t value) {
+    intptr_t index = Find(key);
+    if (keys_[index] == 0) {
+      keys_[index] = key;
+      count_++;
+    }
+    values_[index] = value;
+    // Keep the load factor of the table below 50%.
+    if ((2 * count_) > capacity_) {
+      Grow();
+    }
+  }
+
+  intptr_t Lookup(uintptr_t key) const {
+    intptr_t index = Find(key);
+    return (keys_[index] == 0) ? kNoNode : values_[index];
+  }
+
+ private:
+  intptr_t Find(uintptr_t key) const {
+    intptr_t mask = capacity_ - 1;
+    intptr_t index = (key * 2654435761U) & mask;
+    while ((keys_[index] != 0) && (keys_[index] != key)) {
+      index = (index + 1) & mask;
+    }
+    return index;
+  }
+
+  void Grow() {
+    uintptr_t* old_keys = keys_;
+    intptr_t* old_values = values_;
+    intptr_t old_capacity = capacity_;
+    capacity_ = (old_capacity == 0) ? 1024 : (2 * old_capacity);
+    keys_ = reinterpret_cast<uintptr_t*>(
+        Allocate(capacity_ * sizeof(keys_[0])));
+    values_ = reinterpret_cast<intptr_t*>(
+        Allocate(capacity_ * sizeof(values_[0])));
+    memset(keys_, 0, capacity_ * sizeof(keys_[0]));
+    for (intptr_t i = 0; i < old_capacity; i++) {
+      if (old_keys[i] != 0) {
+        intptr_t index = Find(old_keys[i]);
+        keys_[index] = old_keys[i];
+        values_[index] = old_values[i];
+      }
+    }
+    free(old_keys);
+    free(old_values);
+  }
+
+  uintptr_t* keys_;
+  intptr_t* values_;
+  intptr_t count_;
+  intptr_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(IdMap);
+};
+
+
+// The object graph of a snapshot. Node 0 is an artificial root referencing
+// the roots of the isolate, the objects are nodes 1 to N.
+class HeapGraph {
+ public:
+  HeapGraph() {}
+  ~HeapGraph() {
+    for (intptr_t i = 0; i < class_names_.length(); i++) {
+      free(class_names_[i]);
+    }
+  }
+
+  bool Read(const uint8_t* buffer, intptr_t size);
+  void ComputeDominators();
+  void Print(intptr_t top) const;
+
+ private:
+  bool ReadUnsigned(uintptr_t* value);
+  bool Corrupt();
+  const char* ClassName(intptr_t node) const;
+  intptr_t Intersect(intptr_t a, intptr_t b) const;
+  void ComputePostOrder();
+  void ComputePredecessors();
+  void PrintDominatorChain(intptr_t node) const;
+
+  intptr_t NodeCount() const { return sizes_.length(); }
+
+  const uint8_t* current_;
+  const uint8_t* end_;
+
+  // Per node.
+  Array<uintptr_t> ids_;
+  Array<uintptr_t> class_ids_;
+  Array<intptr_t> sizes_;
+  Array<intptr_t> edge_id_starts_;  // Index of the first successor id.
+  Array<intptr_t> edge_starts_;  // Index of the first successor.
+  Array<intptr_t> post_order_numbers_;  // kNoNode if unreachable.
+  Array<intptr_t> pred_starts_;  // Index of the first predecessor.
+  Array<intptr_t> dominators_;
+  Array<intptr_t> retained_sizes_;
+
+  Array<uintptr_t> edge_ids_;  // Successor ids as read from the snapshot.
+  Array<intptr_t> edges_;  // Successors, kNoNode if outside of the heap.
+  Array<intptr_t> predecessors_;
+  Array<intptr_t> post_order_;  // Reachable nodes, root last.
+
+  IdMap nodes_;
+  IdMap classes_;
+  Array<char*> class_names_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapGraph);
+};
+
+
+bool HeapGraph::ReadUnsigned(uintptr_t* value) {
+  uintptr_t result = 0;
+  intptr_t shift = 0;
+  uint8_t byte;
+  do {
+    if ((current_ >= end_) || (shift >= kBitsPerUnsigned)) {
+      return false;
+    }
+    byte = *current_++;
+    result |= static_cast<uintptr_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while ((byte & 0x80) != 0);
+  *value = result;
+  return true;
+}
+
+
+bool HeapGraph::Corrupt() {
+  fprintf(stderr, "Truncated or corrupt heap snapshot\n");
+  return false;
+}
+
+
+bool HeapGraph::Read(const uint8_t* buffer, intptr_t size) {
+  current_ = buffer;
+  end_ = buffer + size;
+  if ((size < kMagicLength) || (memcmp(buffer, kMagic, kMagicLength) != 0)) {
+    fprintf(stderr, "Not a heap snapshot\n");
+    return false;
+  }
+  current_ += kMagicLength;
+  uintptr_t version;
+  uintptr_t word_size;
+  if (!ReadUnsigned(&version) || (version != kVersion) ||
+      !ReadUnsigned(&word_size)) {
+    fprintf(stderr, "Unsupported heap snapshot version\n");
+    return false;
+  }
+  // The artificial root.
+  ids_.Add(0);
+  class_ids_.Add(0);
+  sizes_.Add(0);
+  edge_id_starts_.Add(0);
+  Array<uintptr_t> root_ids;
+  while (true) {
+    uintptr_t tag;
+    uintptr_t id;
+    if (!ReadUnsigned(&tag)) {
+      return Corrupt();
+    }
+    if (tag == kEndRecord) {
+      break;
+    }
+    if (!ReadUnsigned(&id)) {
+      return Corrupt();
+    }
+    if (tag == kObjectRecord) {
+      uintptr_t class_id;
+      uintptr_t object_size;
+      uintptr_t edge_count;
+      if (!ReadUnsigned(&class_id) ||
+          !ReadUnsigned(&object_size) ||
+          !ReadUnsigned(&edge_count)) {
+        return Corrupt();
+      }
+      nodes_.Insert(id, ids_.length());
+      ids_.Add(id);
+      class_ids_.Add(class_id);
+      sizes_.Add(object_size);
+      edge_id_starts_.Add(edge_ids_.length());
+      for (uintptr_t i = 0; i < edge_count; i++) {
+        uintptr_t edge_id;
+        if (!ReadUnsigned(&edge_id)) {
+          return Corrupt();
+        }
+        edge_ids_.Add(edge_id);
+      }
+    } else if (tag == kClassRecord) {
+      uintptr_t length;
+      if (!ReadUnsigned(&length) ||
+          (length > static_cast<uintptr_t>(end_ - current_))) {
+        return Corrupt();
+      }
+      char* name = reinterpret_cast<char*>(Allocate(length + 1));
+      memmove(name, current_, length);
+      name[length] = '\0';
+      current_ += length;
+      classes_.Insert(id, class_names_.length());
+      class_names_.Add(name);
+    } else if (tag == kRootRecord) {
+      root_ids.Add(id);
+    } else {
+      return Corrupt();
+    }
+  }
+
+  // Resolve the ids of the successors, the roots are the successors of the
+  // artificial root.
+  edge_id_starts_.Add(edge_ids_.length());
+  edge_starts_.Add(0);
+  for (intptr_t i = 0; i < root_ids.length(); i++) {
+    edges_.Add(nodes_.Lookup(root_ids[i]));
+  }
+  for (intptr_t i = 1; i < NodeCount(); i++) {
+    edge_starts_.Add(edges_.length());
+    for (intptr_t j = edge_id_starts_[i]; j < edge_id_starts_[i + 1]; j++) {
+      edges_.Add(nodes_.Lookup(edge_ids_[j]));
+    }
+  }
+  edge_starts_.Add(edges_.length());
+  return true;
+}
+
+
+void HeapGraph::ComputePostOrder() {
+  // Depth first search from the root with an explicit stack of nodes and the
+  // index of the next successor to visit.
+  post_order_numbers_.SetLength(NodeCount(), kNoNode);
+  Array<bool> visited;
+  visited.SetLength(NodeCount(), false);
+  Array<intptr_t> stack_nodes;
+  Array<intptr_t> stack_edges;
+  visited[kRoot] = true;
+  stack_nodes.Add(kRoot);
+  stack_edges.Add(edge_starts_[kRoot]);
+  intptr_t top = 0;
+  while (top >= 0) {
+    intptr_t node = stack_nodes[top];
+    intptr_t edge = stack_edges[top];
+    if (edge == edge_starts_[node + 1]) {
+      post_order_numbers_[node] = post_order_.length();
+      post_order_.Add(node);
+      top--;
+      continue;
+    }
+    stack_edges[top] = edge + 1;
+    intptr_t successor = edges_[edge];
+    if ((successor != kNoNode) && !visited[successor]) {
+      visited[successor] = true;
+      top++;
+      if (top == stack_nodes.length()) {
+        stack_nodes.Add(successor);
+        stack_edges.Add(edge_starts_[successor]);
+      } else {
+        stack_nodes[top] = successor;
+        stack_edges[top] = edge_starts_[successor];
+      }
+    }
+  }
+}
+
+
+void HeapGraph::ComputePredecessors() {
+  // Count the predecessors of each node, then fill them in.
+  pred_starts_.SetLength(NodeCount() + 1, 0);
+  for (intptr_t i = 0; i < edges_.length(); i++) {
+    if (edges_[i] != kNoNode) {
+      pred_starts_[edges_[i] + 1]++;
+    }
+  }
+  for (intptr_t i = 0; i < NodeCount(); i++) {
+    pred_starts_[i + 1] += pred_starts_[i];
+  }
+  predecessors_.SetLength(pred_starts_[NodeCount()], kNoNode);
+  Array<intptr_t> next;
+  next.SetLength(NodeCount(), 0);
+  for (intptr_t node = 0; node < NodeCount(); node++) {
+    for (intptr_t i = edge_starts_[node]; i < edge_starts_[node + 1]; i++) {
+      intptr_t successor = edges_[i];
+      if (successor != kNoNode) {
+        predecessors_[pred_starts_[successor] + next[successor]] = node;
+        next[successor]++;
+      }
+    }
+  }
+}
+
+
+intptr_t HeapGraph::Intersect(intptr_t a, intptr_t b) const {
+  while (a != b) {
+    while (post_order_numbers_[a] < post_order_numbers_[b]) {
+      a = dominators_[a];
+    }
+    while (post_order_numbers_[b] < post_order_numbers_[a]) {
+      b = dominators_[b];
+    }
+  }
+  return a;
+}
+
+
+void HeapGraph::ComputeDominators() {
+  ComputePostOrder();
+  ComputePredecessors();
+  dominators_.SetLength(NodeCount(), kNoNode);
+  dominators_[kRoot] = kRoot;
+  // Iterate in reverse post order until no dominator changes. The root is
+  // last in post order.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (intptr_t i = post_order_.length() - 2; i >= 0; i--) {
+      intptr_t node = post_order_[i];
+      intptr_t dominator = kNoNode;
+      for (intptr_t j = pred_starts_[node]; j < pred_starts_[node + 1]; j++) {
+        intptr_t predecessor = predecessors_[j];
+        if (dominators_[predecessor] == kNoNode) {
+          // Unreachable or not processed yet.
+          continue;
+        }
+        dominator = (dominator == kNoNode) ?
+            predecessor : Intersect(predecessor, dominator);
+      }
+      if (dominators_[node] != dominator) {
+        dominators_[node] = dominator;
+        changed = true;
+      }
+    }
+  }
+  // A node is dominated by nodes later in post order, accumulate the sizes
+  // bottom up.
+  retained_sizes_.SetLength(NodeCount(), 0);
+  for (intptr_t i = 0; i < post_order_.length(); i++) {
+    intptr_t node = post_order_[i];
+    retained_sizes_[node] += sizes_[node];
+    if (node != kRoot) {
+      retained_sizes_[dominators_[node]] += retained_sizes_[node];
+    }
+  }
+}
+
+
+const char* HeapGraph::ClassName(intptr_t node) const {
+  intptr_t index = classes_.Lookup(class_ids_[node]);
+  return (index == kNoNode) ? "<unknown>" : class_names_[index];
+}
+
+
+void HeapGraph::PrintDominatorChain(intptr_t node) const {
+  intptr_t dominator = dominators_[node];
+  for (intptr_t i = 0; (i < kMaxDominatorChain) && (dominator != kRoot); i++) {
+    printf("      retained by %s @%#lx\n",
+           ClassName(dominator), static_cast<long>(ids_[dominator]));
+    dominator = dominators_[dominator];
+  }
+  if (dominator == kRoot) {
+    printf("      retained by roots\n");
+  }
+}
+
+
+// Sorts node indices by decreasing value in the array being sorted by.
+static const intptr_t* sort_values = NULL;
+static int CompareNodes(const void* a, const void* b) {
+  intptr_t a_value = sort_values[*reinterpret_cast<const intptr_t*>(a)];
+  intptr_t b_value = sort_values[*reinterpret_cast<const intptr_t*>(b)];
+  if (a_value > b_value) {
+    return -1;
+  }
+  return (a_value < b_value) ? 1 : 0;
+}
+
+
+void HeapGraph::Print(intptr_t top) const {
+  intptr_t total_size = 0;
+  intptr_t unreachable_count = 0;
+  intptr_t unreachable_size = 0;
+  for (intptr_t node = 1; node < NodeCount(); node++) {
+    total_size += sizes_[node];
+    if (post_order_numbers_[node] == kNoNode) {
+      unreachable_count++;
+      unreachable_size += sizes_[node];
+    }
+  }
+  printf("%ld objects, %ld bytes, %ld unreachable objects (%ld bytes)\n\n",
+         static_cast<long>(NodeCount() - 1),
+         static_cast<long>(total_size),
+         static_cast<long>(unreachable_count),
+         static_cast<long>(unreachable_size));
+
+  // Shallow sizes of the instances of each class.
+  Array<intptr_t> class_counts;
+  Array<intptr_t> class_sizes;
+  class_counts.SetLength(class_names_.length(), 0);
+  class_sizes.SetLength(class_names_.length(), 0);
+  for (intptr_t node = 1; node < NodeCount(); node++) {
+    intptr_t index = classes_.Lookup(class_ids_[node]);
+    if (index != kNoNode) {
+      class_counts[index]++;
+      class_sizes[index] += sizes_[node];
+    }
+  }
+  Array<intptr_t> order;
+  for (intptr_t i = 0; i < class_names_.length(); i++) {
+    order.Add(i);
+  }
+  if (order.length() > 0) {
+    sort_values = &class_sizes[0];
+    qsort(&order[0], order.length(), sizeof(intptr_t), CompareNodes);
+  }
+  printf("Top classes by size:\n");
+  printf("%10s %10s  %s\n", "count", "bytes", "class");
+  for (intptr_t i = 0; (i < top) && (i < order.length()); i++) {
+    intptr_t index = order[i];
+    printf("%10ld %10ld  %s\n",
+           static_cast<long>(class_counts[index]),
+           static_cast<long>(class_sizes[index]),
+           class_names_[index]);
+  }
+
+  // Objects retaining the most memory, excluding the artificial root.
+  Array<intptr_t> nodes;
+  for (intptr_t i = 0; i < post_order_.length(); i++) {
+    if (post_order_[i] != kRoot) {
+      nodes.Add(post_order_[i]);
+    }
+  }
+  if (nodes.length() > 0) {
+    sort_values = &retained_sizes_[0];
+    qsort(&nodes[0], nodes.length(), sizeof(intptr_t), CompareNodes);
+  }
+  printf("\nTop objects by retained size:\n");
+  printf("%10s %10s  %s\n", "retained", "bytes", "object");
+  for (intptr_t i = 0; (i < top) && (i < nodes.length()); i++) {
+    intptr_t node = nodes[i];
+    printf("%10ld %10ld  %s @%#lx\n",
+           static_cast<long>(retained_sizes_[node]),
+           static_cast<long>(sizes_[node]),
+           ClassName(node),
+           static_cast<long>(ids_[node]));
+    PrintDominatorChain(node);
+  }
+}
+
+
+static uint8_t* ReadFile(const char* name, intptr_t* size) {
+  FILE* file = fopen(name, "rb");
+  if (file == NULL) {
+    return NULL;
+  }
+  Array<uint8_t> contents;
+  uint8_t chunk[4096];
+  size_t read;
+  while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    for (size_t i = 0; i < read; i++) {
+      contents.Add(chunk[i]);
+    }
+  }
+  fclose(file);
+  *size = contents.length();
+  uint8_t* result = reinterpret_cast<uint8_t*>(Allocate(*size + 1));
+  for (intptr_t i = 0; i < *size; i++) {
+    result[i] = contents[i];
+  }
+  return result;
+}
+
+
+static void PrintUsage() {
+  fprintf(stderr,
+          "heap_snapshot_analyzer [--top=<count>] <heap-snapshot-file>\n");
+}
+
+
+int main(int argc, char** argv) {
+  const char* kTopOption = "--top=";
+  const intptr_t kTopOptionLength = strlen(kTopOption);
+  intptr_t top = kDefaultTop;
+  int i = 1;
+  while ((i < argc) && (strncmp(argv[i], "--", 2) == 0)) {
+    if (strncmp(argv[i], kTopOption, kTopOptionLength) == 0) {
+      top = atoi(argv[i] + kTopOptionLength);
+    } else {
+      PrintUsage();
+      return 255;
+    }
+    i++;
+  }
+  if (i != (argc - 1)) {
+    PrintUsage();
+    return 255;
+  }
+
+  intptr_t size = 0;
+  uint8_t* buffer = ReadFile(argv[i], &size);
+  if (buffer == NULL) {
+    fprintf(stderr, "Unable to read '%s'\n", argv[i]);
+    return 255;
+  }
+  HeapGraph graph;
+  if (!graph.Read(buffer, size)) {
+    free(buffer);
+    return 255;
+  }
+  free(buffer);
+  graph.ComputeDominators();
+  graph.Print(top);
+  return 0;
+}
@@ -10,8 +10,12 @@
 
 namespace dart {
 
-StackResource::StackResource() {
+StackResource::StackResource() : previous_(NULL) {
   Isolate* isolate = Isolate::Current();
+  // GC helper threads run without an isolate and have no resources to track.
+  if (isolate == NULL) {
+    return;
+  }
   previous_ = isolate->top_resource();
   isolate->set_top_resource(this);
 }
@@ -19,6 +23,9 @@ StackResource::StackResource() {
 
 StackResource::~StackResource() {
   Isolate* isolate = Isolate::Current();
+  if (isolate == NULL) {
+    return;
+  }
   StackResource* top = isolate->top_resource();
   ASSERT(top == this);
   isolate->set_top_resource(previous_);
@@ -7,8 +7,11 @@
 
 #include "vm/assembler.h"
 #include "vm/heap.h"
+#include "vm/isolate.h"
 #include "vm/memory_region.h"
+#include "vm/object.h"
 #include "vm/runtime_entry.h"
+#include "vm/stub_code.h"
 
 namespace dart {
 
@@ -1255,8 +1258,49 @@ void Assembler::CompareObject(Register reg, const Object& object) {
 void Assembler::StoreIntoObject(Register object,
                                 const FieldAddress& dest,
                                 Register value) {
-  // TODO(iposva): Add write barrier.
+  // While old space is marked concurrently, the value being overwritten in an
+  // old object is logged by the MarkingBarrier stub.
+  Label not_marking;
+  testl(object, Immediate(kNewObjectAlignmentOffset));
+  j(NOT_ZERO, &not_marking, Assembler::kNearJump);  // New object.
+  // Generated code only runs in the isolate it was generated for, the flag is
+  // tested at its absolute address and no register is needed.
+  cmpl(Address::Absolute(
+           Isolate::Current()->marking_buffer_block()->is_marking_address()),
+       Immediate(0));
+  j(EQUAL, &not_marking, Assembler::kNearJump);
+  // The MarkingBarrier stub expects the old value in EDX and preserves all
+  // registers.
+  pushl(EDX);
+  movl(EDX, dest);
+  call(&StubCode::MarkingBarrierLabel());
+  popl(EDX);
+  Bind(&not_marking);
+
   movl(dest, value);
+  // The store buffer only needs to be updated when a new object is stored
+  // into an old object.
+  Label done;
+  testl(value, Immediate(kNewObjectAlignmentOffset));
+  j(ZERO, &done, Assembler::kNearJump);  // Old object or Smi value.
+  testl(value, Immediate(kSmiTagMask));
+  j(ZERO, &done, Assembler::kNearJump);  // Smi value.
+  testl(object, Immediate(kNewObjectAlignmentOffset));
+  j(NOT_ZERO, &done, Assembler::kNearJump);  // Storing into a new object.
+  // The UpdateStoreBuffer stub expects the object in EDX and the address of
+  // the updated slot on the stack, it preserves all registers.
+  pushl(EDX);
+  leal(EDX, dest);
+  pushl(EDX);
+  if (object != EDX) {
+    movl(EDX, object);
+  } else {
+    movl(EDX, Address(ESP, kWordSize));
+  }
+  call(&StubCode::UpdateStoreBufferLabel());
+  popl(EDX);  // Address of the updated slot.
+  popl(EDX);
+  Bind(&done);
 }
 
 
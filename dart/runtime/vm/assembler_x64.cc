@@ -0,0 +1,1744 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/globals.h"
+#if defined(TARGET_ARCH_X64)
+
+#include "vm/assembler.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/memory_region.h"
+#include "vm/object.h"
+#include "vm/runtime_entry.h"
+#include "vm/stub_code.h"
+
+namespace dart {
+
+void Assembler::InitializeMemoryWithBreakpoints(uword data, int length) {
+  memset(reinterpret_cast<void*>(data), Instr::kBreakPointInstruction, length);
+}
+
+
+void Assembler::call(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_NONE);
+  EmitUint8(0xFF);
+  EmitRegisterOperand(2, reg);
+}
+
+
+void Assembler::call(const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(2, address, REX_NONE);
+  EmitUint8(0xFF);
+  EmitOperand(2, address);
+}
+
+
+void Assembler::call(Label* label) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xE8);
+  static const int kSize = 5;
+  EmitLabel(label, kSize);
+}
+
+
+void Assembler::call(const ExternalLabel* label) {
+  intptr_t call_start = buffer_.GetPosition();
+  {
+    // The target does not fit into the 32-bit displacement of a direct call
+    // in general, always use the 64-bit immediate form so that call sites
+    // can be patched.
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitRegisterREX(TMP, REX_W);
+    EmitUint8(0xB8 | (TMP & 7));
+    EmitInt64(label->address());
+  }
+  call(TMP);
+  ASSERT((buffer_.GetPosition() - call_start) == kCallExternalLabelSize);
+}
+
+
+void Assembler::pushq(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_NONE);
+  EmitUint8(0x50 | (reg & 7));
+}
+
+
+void Assembler::pushq(const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(6, address, REX_NONE);
+  EmitUint8(0xFF);
+  EmitOperand(6, address);
+}
+
+
+void Assembler::pushq(const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitUint8(0x68);
+    EmitImmediate(imm);
+  } else {
+    movq(TMP, imm);
+    pushq(TMP);
+  }
+}
+
+
+void Assembler::popq(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_NONE);
+  EmitUint8(0x58 | (reg & 7));
+}
+
+
+void Assembler::popq(const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(0, address, REX_NONE);
+  EmitUint8(0x8F);
+  EmitOperand(0, address);
+}
+
+
+void Assembler::movl(Register dst, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(dst, REX_NONE);
+  EmitUint8(0xB8 | (dst & 7));
+  EmitImmediate(imm);
+}
+
+
+void Assembler::movl(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(src, dst, REX_NONE);
+  EmitUint8(0x89);
+  EmitRegisterOperand(src, dst);
+}
+
+
+void Assembler::movl(Register dst, const Address& src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, src, REX_NONE);
+  EmitUint8(0x8B);
+  EmitOperand(dst, src);
+}
+
+
+void Assembler::movl(const Address& dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(src, dst, REX_NONE);
+  EmitUint8(0x89);
+  EmitOperand(src, dst);
+}
+
+
+void Assembler::movl(const Address& dst, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(0, dst, REX_NONE);
+  EmitUint8(0xC7);
+  EmitOperand(0, dst);
+  EmitImmediate(imm);
+}
+
+
+void Assembler::movzxb(Register dst, ByteRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  uint8_t rex = (dst > 7 ? REX_R : REX_NONE) | (src > 7 ? REX_B : REX_NONE);
+  // Without a REX prefix, SPL, BPL, SIL and DIL would be AH, CH, DH and BH.
+  if ((rex != REX_NONE) || (src >= SPL)) EmitUint8(REX_PREFIX | rex);
+  EmitUint8(0x0F);
+  EmitUint8(0xB6);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::movzxb(Register dst, const Address& src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, src, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0xB6);
+  EmitOperand(dst, src);
+}
+
+
+void Assembler::movsxb(Register dst, ByteRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  // Sign extend into all 64 bits of the destination.
+  uint8_t rex = REX_W | (dst > 7 ? REX_R : REX_NONE) |
+                (src > 7 ? REX_B : REX_NONE);
+  EmitUint8(REX_PREFIX | rex);
+  EmitUint8(0x0F);
+  EmitUint8(0xBE);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::movsxb(Register dst, const Address& src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, src, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0xBE);
+  EmitOperand(dst, src);
+}
+
+
+void Assembler::movb(Register dst, const Address& src) {
+  FATAL("Use movzxb or movsxb instead.");
+}
+
+
+void Assembler::movb(const Address& dst, ByteRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  uint8_t rex = (src > 7 ? REX_R : REX_NONE) | dst.rex();
+  if ((rex != REX_NONE) || (src >= SPL)) EmitUint8(REX_PREFIX | rex);
+  EmitUint8(0x88);
+  EmitOperand(src, dst);
+}
+
+
+void Assembler::movb(const Address& dst, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(0, dst, REX_NONE);
+  EmitUint8(0xC6);
+  EmitOperand(0, dst);
+  ASSERT(imm.is_int8());
+  EmitUint8(imm.value() & 0xFF);
+}
+
+
+void Assembler::movzxw(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0xB7);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::movzxw(Register dst, const Address& src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, src, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0xB7);
+  EmitOperand(dst, src);
+}
+
+
+void Assembler::movsxw(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0xBF);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::movsxw(Register dst, const Address& src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, src, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0xBF);
+  EmitOperand(dst, src);
+}
+
+
+void Assembler::movw(Register dst, const Address& src) {
+  FATAL("Use movzxw or movsxw instead.");
+}
+
+
+void Assembler::movw(const Address& dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandSizeOverride();
+  EmitOperandREX(src, dst, REX_NONE);
+  EmitUint8(0x89);
+  EmitOperand(src, dst);
+}
+
+
+void Assembler::movq(Register dst, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  if (imm.is_int32()) {
+    // Use the sign-extended 32-bit immediate form.
+    EmitRegisterREX(dst, REX_W);
+    EmitUint8(0xC7);
+    EmitRegisterOperand(0, dst);
+    EmitImmediate(imm);
+  } else {
+    EmitRegisterREX(dst, REX_W);
+    EmitUint8(0xB8 | (dst & 7));
+    EmitInt64(imm.value());
+  }
+}
+
+
+void Assembler::movq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(src, dst, REX_W);
+  EmitUint8(0x89);
+  EmitRegisterOperand(src, dst);
+}
+
+
+void Assembler::movq(Register dst, const Address& src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, src, REX_W);
+  EmitUint8(0x8B);
+  EmitOperand(dst, src);
+}
+
+
+void Assembler::movq(const Address& dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(src, dst, REX_W);
+  EmitUint8(0x89);
+  EmitOperand(src, dst);
+}
+
+
+void Assembler::movq(const Address& dst, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitOperandREX(0, dst, REX_W);
+    EmitUint8(0xC7);
+    EmitOperand(0, dst);
+    EmitImmediate(imm);
+  } else {
+    movq(TMP, imm);
+    movq(dst, TMP);
+  }
+}
+
+
+void Assembler::movsxd(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x63);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::movsxd(Register dst, const Address& src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, src, REX_W);
+  EmitUint8(0x63);
+  EmitOperand(dst, src);
+}
+
+
+void Assembler::leaq(Register dst, const Address& src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, src, REX_W);
+  EmitUint8(0x8D);
+  EmitOperand(dst, src);
+}
+
+
+void Assembler::cmovsq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x48);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::cmovnsq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x49);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::EmitXmmOp(uint8_t prefix,
+                          uint8_t opcode,
+                          XmmRegister dst,
+                          XmmRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  // The mandatory prefix precedes the REX prefix.
+  if (prefix != 0) EmitUint8(prefix);
+  EmitRegisterRegisterREX(static_cast<Register>(dst),
+                          static_cast<Register>(src),
+                          REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(opcode);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::EmitXmmOp(uint8_t prefix,
+                          uint8_t opcode,
+                          XmmRegister dst,
+                          const Address& src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  if (prefix != 0) EmitUint8(prefix);
+  EmitOperandREX(dst, src, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(opcode);
+  EmitOperand(dst, src);
+}
+
+
+void Assembler::movss(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0xF3, 0x10, dst, src);
+}
+
+
+void Assembler::movss(const Address& dst, XmmRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF3);
+  EmitOperandREX(src, dst, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0x11);
+  EmitOperand(src, dst);
+}
+
+
+void Assembler::movss(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF3, 0x10, dst, src);
+}
+
+
+void Assembler::movd(XmmRegister dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitRegisterRegisterREX(static_cast<Register>(dst), src, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0x6E);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::movd(Register dst, XmmRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitRegisterRegisterREX(static_cast<Register>(src), dst, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0x7E);
+  EmitRegisterOperand(src, dst);
+}
+
+
+void Assembler::movq(XmmRegister dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitRegisterRegisterREX(static_cast<Register>(dst), src, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x6E);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::movq(Register dst, XmmRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitRegisterRegisterREX(static_cast<Register>(src), dst, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x7E);
+  EmitRegisterOperand(src, dst);
+}
+
+
+void Assembler::addss(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF3, 0x58, dst, src);
+}
+
+
+void Assembler::addss(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0xF3, 0x58, dst, src);
+}
+
+
+void Assembler::subss(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF3, 0x5C, dst, src);
+}
+
+
+void Assembler::subss(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0xF3, 0x5C, dst, src);
+}
+
+
+void Assembler::mulss(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF3, 0x59, dst, src);
+}
+
+
+void Assembler::mulss(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0xF3, 0x59, dst, src);
+}
+
+
+void Assembler::divss(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF3, 0x5E, dst, src);
+}
+
+
+void Assembler::divss(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0xF3, 0x5E, dst, src);
+}
+
+
+void Assembler::movsd(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0xF2, 0x10, dst, src);
+}
+
+
+void Assembler::movsd(const Address& dst, XmmRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF2);
+  EmitOperandREX(src, dst, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0x11);
+  EmitOperand(src, dst);
+}
+
+
+void Assembler::movsd(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF2, 0x10, dst, src);
+}
+
+
+void Assembler::movups(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0, 0x10, dst, src);
+}
+
+
+void Assembler::movups(const Address& dst, XmmRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(src, dst, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0x11);
+  EmitOperand(src, dst);
+}
+
+
+void Assembler::addsd(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF2, 0x58, dst, src);
+}
+
+
+void Assembler::addsd(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0xF2, 0x58, dst, src);
+}
+
+
+void Assembler::subsd(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF2, 0x5C, dst, src);
+}
+
+
+void Assembler::subsd(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0xF2, 0x5C, dst, src);
+}
+
+
+void Assembler::mulsd(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF2, 0x59, dst, src);
+}
+
+
+void Assembler::mulsd(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0xF2, 0x59, dst, src);
+}
+
+
+void Assembler::divsd(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF2, 0x5E, dst, src);
+}
+
+
+void Assembler::divsd(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0xF2, 0x5E, dst, src);
+}
+
+
+void Assembler::cvtsi2ss(XmmRegister dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF3);
+  EmitRegisterRegisterREX(static_cast<Register>(dst), src, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x2A);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::cvtsi2sd(XmmRegister dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF2);
+  EmitRegisterRegisterREX(static_cast<Register>(dst), src, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x2A);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::cvtss2si(Register dst, XmmRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF3);
+  EmitRegisterRegisterREX(dst, static_cast<Register>(src), REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x2D);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::cvtss2sd(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF3, 0x5A, dst, src);
+}
+
+
+void Assembler::cvtsd2si(Register dst, XmmRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF2);
+  EmitRegisterRegisterREX(dst, static_cast<Register>(src), REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x2D);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::cvtsd2ss(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF2, 0x5A, dst, src);
+}
+
+
+void Assembler::cvttss2si(Register dst, XmmRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF3);
+  EmitRegisterRegisterREX(dst, static_cast<Register>(src), REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x2C);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::cvttsd2si(Register dst, XmmRegister src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF2);
+  EmitRegisterRegisterREX(dst, static_cast<Register>(src), REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x2C);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::cvtdq2pd(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF3, 0xE6, dst, src);
+}
+
+
+void Assembler::comiss(XmmRegister a, XmmRegister b) {
+  EmitXmmOp(0, 0x2F, a, b);
+}
+
+
+void Assembler::comisd(XmmRegister a, XmmRegister b) {
+  EmitXmmOp(0x66, 0x2F, a, b);
+}
+
+
+void Assembler::sqrtsd(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF2, 0x51, dst, src);
+}
+
+
+void Assembler::sqrtss(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0xF3, 0x51, dst, src);
+}
+
+
+void Assembler::xorpd(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0x66, 0x57, dst, src);
+}
+
+
+void Assembler::xorpd(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0x66, 0x57, dst, src);
+}
+
+
+void Assembler::xorps(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0, 0x57, dst, src);
+}
+
+
+void Assembler::xorps(XmmRegister dst, XmmRegister src) {
+  EmitXmmOp(0, 0x57, dst, src);
+}
+
+
+void Assembler::andpd(XmmRegister dst, const Address& src) {
+  EmitXmmOp(0x66, 0x54, dst, src);
+}
+
+
+void Assembler::xchgq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x87);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::cmpl(Register reg, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_NONE);
+  EmitComplex(7, Operand(reg), imm);
+}
+
+
+void Assembler::cmpl(Register reg0, Register reg1) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(reg0, reg1, REX_NONE);
+  EmitUint8(0x3B);
+  EmitRegisterOperand(reg0, reg1);
+}
+
+
+void Assembler::cmpl(const Address& address, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(7, address, REX_NONE);
+  EmitComplex(7, address, imm);
+}
+
+
+void Assembler::cmpq(Register reg, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitRegisterREX(reg, REX_W);
+    EmitComplex(7, Operand(reg), imm);
+  } else {
+    ASSERT(reg != TMP);
+    movq(TMP, imm);
+    cmpq(reg, TMP);
+  }
+}
+
+
+void Assembler::cmpq(Register reg0, Register reg1) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(reg0, reg1, REX_W);
+  EmitUint8(0x3B);
+  EmitRegisterOperand(reg0, reg1);
+}
+
+
+void Assembler::cmpq(Register reg, const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(reg, address, REX_W);
+  EmitUint8(0x3B);
+  EmitOperand(reg, address);
+}
+
+
+void Assembler::cmpq(const Address& address, Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(reg, address, REX_W);
+  EmitUint8(0x39);
+  EmitOperand(reg, address);
+}
+
+
+void Assembler::cmpq(const Address& address, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitOperandREX(7, address, REX_W);
+    EmitComplex(7, address, imm);
+  } else {
+    movq(TMP, imm);
+    cmpq(address, TMP);
+  }
+}
+
+
+void Assembler::testl(Register reg1, Register reg2) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(reg1, reg2, REX_NONE);
+  EmitUint8(0x85);
+  EmitRegisterOperand(reg1, reg2);
+}
+
+
+void Assembler::testl(Register reg, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  // For registers that have a byte variant (RAX, RBX, RCX, and RDX)
+  // we only test the byte register to keep the encoding short.
+  if (imm.is_uint8() && reg < 4) {
+    // Use zero-extended 8-bit immediate.
+    if (reg == RAX) {
+      EmitUint8(0xA8);
+    } else {
+      EmitUint8(0xF6);
+      EmitUint8(0xC0 + reg);
+    }
+    EmitUint8(imm.value() & 0xFF);
+  } else if (reg == RAX) {
+    // Use short form if the destination is RAX.
+    EmitUint8(0xA9);
+    EmitImmediate(imm);
+  } else {
+    EmitRegisterREX(reg, REX_NONE);
+    EmitUint8(0xF7);
+    EmitOperand(0, Operand(reg));
+    EmitImmediate(imm);
+  }
+}
+
+
+void Assembler::testq(Register reg1, Register reg2) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(reg1, reg2, REX_W);
+  EmitUint8(0x85);
+  EmitRegisterOperand(reg1, reg2);
+}
+
+
+void Assembler::testq(Register reg, const Immediate& imm) {
+  if (imm.is_uint8() && reg < 4) {
+    // Testing the low byte sets the zero flag like the full test.
+    testl(reg, imm);
+  } else if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    if (reg == RAX) {
+      EmitUint8(REX_PREFIX | REX_W);
+      EmitUint8(0xA9);
+    } else {
+      EmitRegisterREX(reg, REX_W);
+      EmitUint8(0xF7);
+      EmitOperand(0, Operand(reg));
+    }
+    EmitImmediate(imm);
+  } else {
+    ASSERT(reg != TMP);
+    movq(TMP, imm);
+    testq(reg, TMP);
+  }
+}
+
+
+void Assembler::andl(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_NONE);
+  EmitUint8(0x23);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::andl(Register dst, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(dst, REX_NONE);
+  EmitComplex(4, Operand(dst), imm);
+}
+
+
+void Assembler::andq(Register dst, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitRegisterREX(dst, REX_W);
+    EmitComplex(4, Operand(dst), imm);
+  } else {
+    ASSERT(dst != TMP);
+    movq(TMP, imm);
+    andq(dst, TMP);
+  }
+}
+
+
+void Assembler::andq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x23);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::andq(Register dst, const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, address, REX_W);
+  EmitUint8(0x23);
+  EmitOperand(dst, address);
+}
+
+
+void Assembler::orq(Register dst, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitRegisterREX(dst, REX_W);
+    EmitComplex(1, Operand(dst), imm);
+  } else {
+    ASSERT(dst != TMP);
+    movq(TMP, imm);
+    orq(dst, TMP);
+  }
+}
+
+
+void Assembler::orq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x0B);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::orq(Register dst, const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, address, REX_W);
+  EmitUint8(0x0B);
+  EmitOperand(dst, address);
+}
+
+
+void Assembler::xorq(Register dst, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitRegisterREX(dst, REX_W);
+    EmitComplex(6, Operand(dst), imm);
+  } else {
+    ASSERT(dst != TMP);
+    movq(TMP, imm);
+    xorq(dst, TMP);
+  }
+}
+
+
+void Assembler::xorq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x33);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::xorq(Register dst, const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, address, REX_W);
+  EmitUint8(0x33);
+  EmitOperand(dst, address);
+}
+
+
+void Assembler::addl(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_NONE);
+  EmitUint8(0x03);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::addl(Register reg, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_NONE);
+  EmitComplex(0, Operand(reg), imm);
+}
+
+
+void Assembler::addq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x03);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::addq(Register reg, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitRegisterREX(reg, REX_W);
+    EmitComplex(0, Operand(reg), imm);
+  } else {
+    ASSERT(reg != TMP);
+    movq(TMP, imm);
+    addq(reg, TMP);
+  }
+}
+
+
+void Assembler::addq(Register reg, const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(reg, address, REX_W);
+  EmitUint8(0x03);
+  EmitOperand(reg, address);
+}
+
+
+void Assembler::addq(const Address& address, Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(reg, address, REX_W);
+  EmitUint8(0x01);
+  EmitOperand(reg, address);
+}
+
+
+void Assembler::addq(const Address& address, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitOperandREX(0, address, REX_W);
+    EmitComplex(0, address, imm);
+  } else {
+    movq(TMP, imm);
+    addq(address, TMP);
+  }
+}
+
+
+void Assembler::adcq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x13);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::adcq(Register reg, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  ASSERT(imm.is_int32());
+  EmitRegisterREX(reg, REX_W);
+  EmitComplex(2, Operand(reg), imm);
+}
+
+
+void Assembler::adcq(Register dst, const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, address, REX_W);
+  EmitUint8(0x13);
+  EmitOperand(dst, address);
+}
+
+
+void Assembler::subl(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_NONE);
+  EmitUint8(0x2B);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::subl(Register reg, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_NONE);
+  EmitComplex(5, Operand(reg), imm);
+}
+
+
+void Assembler::subq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x2B);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::subq(Register reg, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitRegisterREX(reg, REX_W);
+    EmitComplex(5, Operand(reg), imm);
+  } else {
+    ASSERT(reg != TMP);
+    movq(TMP, imm);
+    subq(reg, TMP);
+  }
+}
+
+
+void Assembler::subq(Register reg, const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(reg, address, REX_W);
+  EmitUint8(0x2B);
+  EmitOperand(reg, address);
+}
+
+
+void Assembler::sbbq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x1B);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::sbbq(Register reg, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  ASSERT(imm.is_int32());
+  EmitRegisterREX(reg, REX_W);
+  EmitComplex(3, Operand(reg), imm);
+}
+
+
+void Assembler::sbbq(Register dst, const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(dst, address, REX_W);
+  EmitUint8(0x1B);
+  EmitOperand(dst, address);
+}
+
+
+void Assembler::cdq() {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x99);
+}
+
+
+void Assembler::cqo() {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(REX_PREFIX | REX_W);
+  EmitUint8(0x99);
+}
+
+
+void Assembler::idivl(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_NONE);
+  EmitUint8(0xF7);
+  EmitOperand(7, Operand(reg));
+}
+
+
+void Assembler::idivq(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_W);
+  EmitUint8(0xF7);
+  EmitOperand(7, Operand(reg));
+}
+
+
+void Assembler::imull(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0xAF);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::imulq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(dst, src, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0xAF);
+  EmitRegisterOperand(dst, src);
+}
+
+
+void Assembler::imulq(Register reg, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitRegisterRegisterREX(reg, reg, REX_W);
+    EmitUint8(0x69);
+    EmitRegisterOperand(reg, reg);
+    EmitImmediate(imm);
+  } else {
+    ASSERT(reg != TMP);
+    movq(TMP, imm);
+    imulq(reg, TMP);
+  }
+}
+
+
+void Assembler::imulq(Register reg, const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(reg, address, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0xAF);
+  EmitOperand(reg, address);
+}
+
+
+void Assembler::imulq(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_W);
+  EmitUint8(0xF7);
+  EmitOperand(5, Operand(reg));
+}
+
+
+void Assembler::mulq(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_W);
+  EmitUint8(0xF7);
+  EmitOperand(4, Operand(reg));
+}
+
+
+void Assembler::incq(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  // The one byte encodings of inc and dec are REX prefixes on x64.
+  EmitRegisterREX(reg, REX_W);
+  EmitUint8(0xFF);
+  EmitOperand(0, Operand(reg));
+}
+
+
+void Assembler::incq(const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(0, address, REX_W);
+  EmitUint8(0xFF);
+  EmitOperand(0, address);
+}
+
+
+void Assembler::decq(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_W);
+  EmitUint8(0xFF);
+  EmitOperand(1, Operand(reg));
+}
+
+
+void Assembler::decq(const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(1, address, REX_W);
+  EmitUint8(0xFF);
+  EmitOperand(1, address);
+}
+
+
+void Assembler::shll(Register reg, const Immediate& imm) {
+  EmitGenericShift(false, 4, reg, imm);
+}
+
+
+void Assembler::shll(Register operand, Register shifter) {
+  EmitGenericShift(false, 4, operand, shifter);
+}
+
+
+void Assembler::shrl(Register reg, const Immediate& imm) {
+  EmitGenericShift(false, 5, reg, imm);
+}
+
+
+void Assembler::shrl(Register operand, Register shifter) {
+  EmitGenericShift(false, 5, operand, shifter);
+}
+
+
+void Assembler::sarl(Register reg, const Immediate& imm) {
+  EmitGenericShift(false, 7, reg, imm);
+}
+
+
+void Assembler::sarl(Register operand, Register shifter) {
+  EmitGenericShift(false, 7, operand, shifter);
+}
+
+
+void Assembler::shlq(Register reg, const Immediate& imm) {
+  EmitGenericShift(true, 4, reg, imm);
+}
+
+
+void Assembler::shlq(Register operand, Register shifter) {
+  EmitGenericShift(true, 4, operand, shifter);
+}
+
+
+void Assembler::shrq(Register reg, const Immediate& imm) {
+  EmitGenericShift(true, 5, reg, imm);
+}
+
+
+void Assembler::shrq(Register operand, Register shifter) {
+  EmitGenericShift(true, 5, operand, shifter);
+}
+
+
+void Assembler::sarq(Register reg, const Immediate& imm) {
+  EmitGenericShift(true, 7, reg, imm);
+}
+
+
+void Assembler::sarq(Register operand, Register shifter) {
+  EmitGenericShift(true, 7, operand, shifter);
+}
+
+
+void Assembler::shldq(Register dst, Register src) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterRegisterREX(src, dst, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0xA5);
+  EmitRegisterOperand(src, dst);
+}
+
+
+void Assembler::negl(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_NONE);
+  EmitUint8(0xF7);
+  EmitOperand(3, Operand(reg));
+}
+
+
+void Assembler::negq(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_W);
+  EmitUint8(0xF7);
+  EmitOperand(3, Operand(reg));
+}
+
+
+void Assembler::notq(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_W);
+  EmitUint8(0xF7);
+  EmitOperand(2, Operand(reg));
+}
+
+
+void Assembler::enter(const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xC8);
+  ASSERT(imm.is_uint16());
+  EmitUint8(imm.value() & 0xFF);
+  EmitUint8((imm.value() >> 8) & 0xFF);
+  EmitUint8(0x00);
+}
+
+
+void Assembler::leave() {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xC9);
+}
+
+
+void Assembler::ret() {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xC3);
+}
+
+
+void Assembler::ret(const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xC2);
+  ASSERT(imm.is_uint16());
+  EmitUint8(imm.value() & 0xFF);
+  EmitUint8((imm.value() >> 8) & 0xFF);
+}
+
+
+void Assembler::nop() {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x90);
+}
+
+
+void Assembler::int3() {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xCC);
+}
+
+
+void Assembler::hlt() {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF4);
+}
+
+
+void Assembler::j(Condition condition, Label* label, bool near) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  if (label->IsBound()) {
+    static const int kShortSize = 2;
+    static const int kLongSize = 6;
+    int offset = label->Position() - buffer_.Size();
+    ASSERT(offset <= 0);
+    if (Utils::IsInt(8, offset - kShortSize)) {
+      EmitUint8(0x70 + condition);
+      EmitUint8((offset - kShortSize) & 0xFF);
+    } else {
+      EmitUint8(0x0F);
+      EmitUint8(0x80 + condition);
+      EmitInt32(offset - kLongSize);
+    }
+  } else if (near) {
+    EmitUint8(0x70 + condition);
+    EmitNearLabelLink(label);
+  } else {
+    EmitUint8(0x0F);
+    EmitUint8(0x80 + condition);
+    EmitLabelLink(label);
+  }
+}
+
+
+void Assembler::j(Condition condition, const ExternalLabel* label) {
+  // The negated condition is encoded by flipping the lowest bit.
+  Label no_jump;
+  j(static_cast<Condition>(condition ^ 1), &no_jump, kNearJump);
+  jmp(label);
+  Bind(&no_jump);
+}
+
+
+void Assembler::jmp(Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(reg, REX_NONE);
+  EmitUint8(0xFF);
+  EmitRegisterOperand(4, reg);
+}
+
+
+void Assembler::jmp(const Address& address) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(4, address, REX_NONE);
+  EmitUint8(0xFF);
+  EmitOperand(4, address);
+}
+
+
+void Assembler::jmp(Label* label, bool near) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  if (label->IsBound()) {
+    static const int kShortSize = 2;
+    static const int kLongSize = 5;
+    int offset = label->Position() - buffer_.Size();
+    ASSERT(offset <= 0);
+    if (Utils::IsInt(8, offset - kShortSize)) {
+      EmitUint8(0xEB);
+      EmitUint8((offset - kShortSize) & 0xFF);
+    } else {
+      EmitUint8(0xE9);
+      EmitInt32(offset - kLongSize);
+    }
+  } else if (near) {
+    EmitUint8(0xEB);
+    EmitNearLabelLink(label);
+  } else {
+    EmitUint8(0xE9);
+    EmitLabelLink(label);
+  }
+}
+
+
+void Assembler::jmp(const ExternalLabel* label) {
+  {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitRegisterREX(TMP, REX_W);
+    EmitUint8(0xB8 | (TMP & 7));
+    EmitInt64(label->address());
+  }
+  jmp(TMP);
+}
+
+
+void Assembler::lock() {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF0);
+}
+
+
+void Assembler::cmpxchgq(const Address& address, Register reg) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(reg, address, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0xB1);
+  EmitOperand(reg, address);
+}
+
+
+void Assembler::AddImmediate(Register reg, const Immediate& imm) {
+  int64_t value = imm.value();
+  if (value > 0) {
+    if (value == 1) {
+      incq(reg);
+    } else if (value != 0) {
+      addq(reg, imm);
+    }
+  } else if (value < 0) {
+    value = -value;
+    if (value == 1) {
+      decq(reg);
+    } else if (value != 0) {
+      subq(reg, Immediate(value));
+    }
+  }
+}
+
+
+void Assembler::LoadObject(Register dst, const Object& object) {
+  ASSERT(object.IsZoneHandle());
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(dst, REX_W);
+  EmitUint8(0xB8 | (dst & 7));
+  buffer_.EmitObject(object);
+}
+
+
+void Assembler::PushObject(const Object& object) {
+  LoadObject(TMP, object);
+  pushq(TMP);
+}
+
+
+void Assembler::CompareObject(Register reg, const Object& object) {
+  ASSERT(reg != TMP);
+  LoadObject(TMP, object);
+  cmpq(reg, TMP);
+}
+
+
+void Assembler::StoreIntoObject(Register object,
+                                const FieldAddress& dest,
+                                Register value) {
+  // While old space is marked concurrently, the value being overwritten in an
+  // old object is logged by the MarkingBarrier stub.
+  Label not_marking;
+  testq(object, Immediate(kNewObjectAlignmentOffset));
+  j(NOT_ZERO, &not_marking, Assembler::kNearJump);  // New object.
+  movq(TMP, FieldAddress(CTX, Context::isolate_offset()));
+  cmpl(Address(TMP, Isolate::marking_buffer_block_offset() +
+                    MarkingBufferBlock::is_marking_offset()),
+       Immediate(0));
+  j(EQUAL, &not_marking, Assembler::kNearJump);
+  // The MarkingBarrier stub expects the old value in RDX and preserves all
+  // registers.
+  pushq(RDX);
+  movq(RDX, dest);
+  call(&StubCode::MarkingBarrierLabel());
+  popq(RDX);
+  Bind(&not_marking);
+
+  movq(dest, value);
+  // The store buffer only needs to be updated when a new object is stored
+  // into an old object.
+  Label done;
+  testq(value, Immediate(kNewObjectAlignmentOffset));
+  j(ZERO, &done, Assembler::kNearJump);  // Old object or Smi value.
+  testq(value, Immediate(kSmiTagMask));
+  j(ZERO, &done, Assembler::kNearJump);  // Smi value.
+  testq(object, Immediate(kNewObjectAlignmentOffset));
+  j(NOT_ZERO, &done, Assembler::kNearJump);  // Storing into a new object.
+  // The UpdateStoreBuffer stub expects the object in RDX and the address of
+  // the updated slot on the stack, it preserves all registers.
+  pushq(RDX);
+  leaq(RDX, dest);
+  pushq(RDX);
+  if (object != RDX) {
+    movq(RDX, object);
+  } else {
+    movq(RDX, Address(RSP, kWordSize));
+  }
+  call(&StubCode::UpdateStoreBufferLabel());
+  popq(RDX);  // Address of the updated slot.
+  popq(RDX);
+  Bind(&done);
+}
+
+
+void Assembler::LoadDoubleConstant(XmmRegister dst, double value) {
+  // TODO(5410843): Need to have a code constants table.
+  int64_t constant = bit_cast<int64_t, double>(value);
+  movq(TMP, Immediate(constant));
+  movq(dst, TMP);
+}
+
+
+void Assembler::FloatNegate(XmmRegister f) {
+  static const struct ALIGN16 {
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+    uint32_t d;
+  } float_negate_constant =
+      { 0x80000000, 0x00000000, 0x80000000, 0x00000000 };
+  movq(TMP, Immediate(reinterpret_cast<intptr_t>(&float_negate_constant)));
+  xorps(f, Address(TMP, 0));
+}
+
+
+void Assembler::DoubleNegate(XmmRegister d) {
+  static const struct ALIGN16 {
+    uint64_t a;
+    uint64_t b;
+  } double_negate_constant =
+      {0x8000000000000000LL, 0x8000000000000000LL};
+  movq(TMP, Immediate(reinterpret_cast<intptr_t>(&double_negate_constant)));
+  xorpd(d, Address(TMP, 0));
+}
+
+
+void Assembler::DoubleAbs(XmmRegister reg) {
+  static const struct ALIGN16 {
+    uint64_t a;
+    uint64_t b;
+  } double_abs_constant =
+      {0x7FFFFFFFFFFFFFFFLL, 0x7FFFFFFFFFFFFFFFLL};
+  movq(TMP, Immediate(reinterpret_cast<intptr_t>(&double_abs_constant)));
+  andpd(reg, Address(TMP, 0));
+}
+
+
+void Assembler::EnterFrame(intptr_t frame_size) {
+  if (prolog_offset_ == -1) {
+    prolog_offset_ = CodeSize();
+  }
+  pushq(RBP);
+  movq(RBP, RSP);
+  if (frame_size != 0) {
+    Immediate frame_space(frame_size);
+    subq(RSP, frame_space);
+  }
+}
+
+
+void Assembler::LeaveFrame() {
+  movq(RSP, RBP);
+  popq(RBP);
+}
+
+
+void Assembler::CallRuntimeFromDart(const RuntimeEntry& entry) {
+  entry.CallFromDart(this);
+}
+
+
+void Assembler::CallRuntimeFromStub(const RuntimeEntry& entry) {
+  entry.CallFromStub(this);
+}
+
+
+void Assembler::Align(int alignment, int offset) {
+  ASSERT(Utils::IsPowerOfTwo(alignment));
+  // Emit nop instruction until the real position is aligned.
+  while (((offset + buffer_.GetPosition()) & (alignment-1)) != 0) {
+    nop();
+  }
+}
+
+
+void Assembler::Bind(Label* label) {
+  int bound = buffer_.Size();
+  ASSERT(!label->IsBound());  // Labels can only be bound once.
+  while (label->IsLinked()) {
+    int position = label->LinkPosition();
+    int next = buffer_.Load<int32_t>(position);
+    buffer_.Store<int32_t>(position, bound - (position + 4));
+    label->position_ = next;
+  }
+  while (label->HasNear()) {
+    int position = label->NearPosition();
+    int offset = bound - (position + 1);
+    ASSERT(Utils::IsInt(8, offset));
+    buffer_.Store<int8_t>(position, offset);
+  }
+  label->BindTo(bound);
+}
+
+
+void Assembler::Stop(const char* message) {
+  // Emit the message address as immediate operand in the movq instruction,
+  // followed by the int3 instruction.
+  // Execution can be resumed with the 'cont' command in gdb.
+  movq(TMP, Immediate(reinterpret_cast<int64_t>(message)));
+  int3();
+}
+
+
+void Assembler::EmitOperand(int rm, const Operand& operand) {
+  ASSERT(rm >= 0 && rm < 16);
+  const int length = operand.length_;
+  ASSERT(length > 0);
+  // Emit the ModRM byte updated with the given RM value, the high bit of RM
+  // is part of the REX prefix.
+  ASSERT((operand.encoding_[0] & 0x38) == 0);
+  EmitUint8(operand.encoding_[0] + ((rm & 7) << 3));
+  // Emit the rest of the encoded operand.
+  for (int i = 1; i < length; i++) {
+    EmitUint8(operand.encoding_[i]);
+  }
+}
+
+
+void Assembler::EmitImmediate(const Immediate& imm) {
+  ASSERT(imm.is_int32());
+  EmitInt32(static_cast<int32_t>(imm.value()));
+}
+
+
+// The REX prefix has already been emitted by the caller.
+void Assembler::EmitComplex(int rm,
+                            const Operand& operand,
+                            const Immediate& immediate) {
+  ASSERT(rm >= 0 && rm < 8);
+  if (immediate.is_int8()) {
+    // Use sign-extended 8-bit immediate.
+    EmitUint8(0x83);
+    EmitOperand(rm, operand);
+    EmitUint8(immediate.value() & 0xFF);
+  } else if (operand.IsRegister(RAX)) {
+    // Use short form if the destination is rax.
+    EmitUint8(0x05 + (rm << 3));
+    EmitImmediate(immediate);
+  } else {
+    EmitUint8(0x81);
+    EmitOperand(rm, operand);
+    EmitImmediate(immediate);
+  }
+}
+
+
+void Assembler::EmitLabel(Label* label, int instruction_size) {
+  if (label->IsBound()) {
+    int offset = label->Position() - buffer_.Size();
+    ASSERT(offset <= 0);
+    EmitInt32(offset - instruction_size);
+  } else {
+    EmitLabelLink(label);
+  }
+}
+
+
+void Assembler::EmitLabelLink(Label* label) {
+  ASSERT(!label->IsBound());
+  int position = buffer_.Size();
+  EmitInt32(label->position_);
+  label->LinkTo(position);
+}
+
+
+void Assembler::EmitNearLabelLink(Label* label) {
+  ASSERT(!label->IsBound());
+  int position = buffer_.Size();
+  EmitUint8(0);
+  label->NearLinkTo(position);
+}
+
+
+void Assembler::EmitGenericShift(bool wide,
+                                 int rm,
+                                 Register reg,
+                                 const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  ASSERT(imm.is_int8());
+  EmitRegisterREX(reg, wide ? REX_W : REX_NONE);
+  if (imm.value() == 1) {
+    EmitUint8(0xD1);
+    EmitOperand(rm, Operand(reg));
+  } else {
+    EmitUint8(0xC1);
+    EmitOperand(rm, Operand(reg));
+    EmitUint8(imm.value() & 0xFF);
+  }
+}
+
+
+void Assembler::EmitGenericShift(bool wide,
+                                 int rm,
+                                 Register operand,
+                                 Register shifter) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  ASSERT(shifter == RCX);
+  EmitRegisterREX(operand, wide ? REX_W : REX_NONE);
+  EmitUint8(0xD3);
+  EmitOperand(rm, Operand(operand));
+}
+
+}  // namespace dart
+
+#endif  // defined TARGET_ARCH_X64
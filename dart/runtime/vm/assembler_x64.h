@@ -11,14 +11,27 @@
 
 #include "vm/assert.h"
 #include "vm/constants_x64.h"
+#include "vm/utils.h"
 
 namespace dart {
 
+// Forward declarations.
+class RuntimeEntry;
+
+
 #if defined(TESTING) || defined(DEBUG)
 
+#if defined(TARGET_OS_WINDOWS)
+// The MSVC x64 compiler does not support inline assembly.
+#define CHECK_STACK_ALIGNMENT { }
+#else
 #define CHECK_STACK_ALIGNMENT {                                                \
-  UNIMPLEMENTED();                                                             \
+  uword current_sp;                                                            \
+  asm volatile("mov %%rsp, %[current_sp]" : [current_sp] "=r" (current_sp));   \
+  ASSERT((OS::ActivationFrameAlignment() == 0) ||                              \
+         (Utils::IsAligned(current_sp, OS::ActivationFrameAlignment())));      \
 }
+#endif
 
 #else
 
@@ -27,35 +40,235 @@ namespace dart {
 #endif
 
 
+class Immediate : public ValueObject {
+ public:
+  explicit Immediate(int64_t value) : value_(value) { }
+
+  int64_t value() const { return value_; }
+
+  bool is_int8() const { return Utils::IsInt(8, value_); }
+  bool is_uint8() const { return Utils::IsUint(8, value_); }
+  bool is_uint16() const { return Utils::IsUint(16, value_); }
+  bool is_int32() const { return Utils::IsInt(32, value_); }
+
+ private:
+  const int64_t value_;
+
+  // TODO(5411081): Add DISALLOW_COPY_AND_ASSIGN(Immediate) once the mac
+  // build issue is resolved.
+};
+
+
+class Operand : public ValueObject {
+ public:
+  uint8_t rex() const {
+    return rex_;
+  }
+
+  uint8_t mod() const {
+    return (encoding_at(0) >> 6) & 3;
+  }
+
+  Register rm() const {
+    int rm_rex = (rex_ & REX_B) << 3;
+    return static_cast<Register>(rm_rex + (encoding_at(0) & 7));
+  }
+
+  ScaleFactor scale() const {
+    return static_cast<ScaleFactor>((encoding_at(1) >> 6) & 3);
+  }
+
+  Register index() const {
+    int index_rex = (rex_ & REX_X) << 2;
+    return static_cast<Register>(index_rex + ((encoding_at(1) >> 3) & 7));
+  }
+
+  Register base() const {
+    int base_rex = (rex_ & REX_B) << 3;
+    return static_cast<Register>(base_rex + (encoding_at(1) & 7));
+  }
+
+  int8_t disp8() const {
+    ASSERT(length_ >= 2);
+    return static_cast<int8_t>(encoding_[length_ - 1]);
+  }
+
+  int32_t disp32() const {
+    ASSERT(length_ >= 5);
+    return bit_copy<int32_t>(encoding_[length_ - 4]);
+  }
+
+  bool IsRegister(Register reg) const {
+    return ((reg > 7 ? 1 : 0) == (rex_ & REX_B))  // REX.B match.
+        && ((encoding_at(0) & 0xF8) == 0xC0)  // Addressing mode is register.
+        && ((encoding_at(0) & 0x07) == (reg & 7));  // Register codes match.
+  }
+
+ protected:
+  // Operand can be sub classed (e.g: Address).
+  Operand() : length_(0), rex_(REX_NONE) { }
+
+  void SetModRM(int mod, Register rm) {
+    ASSERT((mod & ~3) == 0);
+    if ((rm > 7) && !((rm == R12) && (mod != 3))) {
+      rex_ |= REX_B;
+    }
+    encoding_[0] = (mod << 6) | (rm & 7);
+    length_ = 1;
+  }
+
+  void SetSIB(ScaleFactor scale, Register index, Register base) {
+    ASSERT(length_ == 1);
+    ASSERT((scale & ~3) == 0);
+    encoding_[1] = (scale << 6) | ((index & 7) << 3) | (base & 7);
+    rex_ |= ((base > 7) ? REX_B : REX_NONE) |
+            ((index > 7) ? REX_X : REX_NONE);
+    length_ = 2;
+  }
+
+  void SetDisp8(int8_t disp) {
+    ASSERT(length_ == 1 || length_ == 2);
+    encoding_[length_++] = static_cast<uint8_t>(disp);
+  }
+
+  void SetDisp32(int32_t disp) {
+    ASSERT(length_ == 1 || length_ == 2);
+    int disp_size = sizeof(disp);
+    memmove(&encoding_[length_], &disp, disp_size);
+    length_ += disp_size;
+  }
+
+ private:
+  uint8_t length_;
+  uint8_t rex_;
+  uint8_t encoding_[6];
+
+  explicit Operand(Register reg) : length_(0), rex_(REX_NONE) {
+    SetModRM(3, reg);
+  }
+
+  // Get the operand encoding byte at the given index.
+  uint8_t encoding_at(int index) const {
+    ASSERT(index >= 0 && index < length_);
+    return encoding_[index];
+  }
+
+  friend class Assembler;
+
+  // TODO(5411081): Add DISALLOW_COPY_AND_ASSIGN(Operand) once the mac
+  // build issue is resolved.
+};
+
+
+// The low three bits of RSP and R12 select a SIB byte in the ModRM byte, the
+// low three bits of RBP and R13 select RIP-relative addressing when there is
+// no displacement. Absolute addresses do not fit into the 32-bit displacement
+// of an x64 instruction, they are loaded into a register instead.
+class Address : public Operand {
+ public:
+  Address(Register base, int32_t disp) {
+    if ((disp == 0) && ((base & 7) != RBP)) {
+      SetModRM(0, base);
+      if ((base & 7) == RSP) {
+        SetSIB(TIMES_1, RSP, base);
+      }
+    } else if (Utils::IsInt(8, disp)) {
+      SetModRM(1, base);
+      if ((base & 7) == RSP) {
+        SetSIB(TIMES_1, RSP, base);
+      }
+      SetDisp8(disp);
+    } else {
+      SetModRM(2, base);
+      if ((base & 7) == RSP) {
+        SetSIB(TIMES_1, RSP, base);
+      }
+      SetDisp32(disp);
+    }
+  }
+
+  Address(Register index, ScaleFactor scale, int32_t disp) {
+    ASSERT(index != RSP);  // Illegal addressing mode.
+    SetModRM(0, RSP);
+    SetSIB(scale, index, RBP);
+    SetDisp32(disp);
+  }
+
+  Address(Register base, Register index, ScaleFactor scale, int32_t disp) {
+    ASSERT(index != RSP);  // Illegal addressing mode.
+    if ((disp == 0) && ((base & 7) != RBP)) {
+      SetModRM(0, RSP);
+      SetSIB(scale, index, base);
+    } else if (Utils::IsInt(8, disp)) {
+      SetModRM(1, RSP);
+      SetSIB(scale, index, base);
+      SetDisp8(disp);
+    } else {
+      SetModRM(2, RSP);
+      SetSIB(scale, index, base);
+      SetDisp32(disp);
+    }
+  }
+
+ private:
+  Address() {}
+
+  // TODO(5411081): Add DISALLOW_COPY_AND_ASSIGN(Address) once the mac
+  // build issue is resolved.
+};
+
+
+class FieldAddress : public Address {
+ public:
+  FieldAddress(Register base, int32_t disp)
+      : Address(base, disp - kHeapObjectTag) {}
+  FieldAddress(Register base, Register index, ScaleFactor scale, int32_t disp)
+      : Address(base, index, scale, disp - kHeapObjectTag) {}
+};
+
+
 class Label : public ValueObject {
  public:
-  Label() : position_(0) { }
+  Label() : position_(0), unresolved_(0) {
+#ifdef DEBUG
+    for (int i = 0; i < kMaxUnresolvedBranches; i++) {
+      unresolved_near_positions_[i] = -1;
+    }
+#endif  // DEBUG
+  }
 
   ~Label() {
     // Assert if label is being destroyed with unresolved branches pending.
     ASSERT(!IsLinked());
+    ASSERT(!HasNear());
   }
 
-  // Returns the position for bound and linked labels. Cannot be used
-  // for unused labels.
+  // Returns the position for bound labels. Cannot be used for unused or linked
+  // labels.
   int Position() const {
-    ASSERT(!IsUnused());
-    return IsBound() ? -position_ - kWordSize : position_ - kWordSize;
+    ASSERT(IsBound());
+    return -position_ - kWordSize;
+  }
+
+  int LinkPosition() const {
+    ASSERT(IsLinked());
+    return position_ - kWordSize;
+  }
+
+  int NearPosition() {
+    ASSERT(HasNear());
+    return unresolved_near_positions_[--unresolved_];
   }
 
   bool IsBound() const { return position_ < 0; }
-  bool IsUnused() const { return position_ == 0; }
+  bool IsUnused() const { return (position_ == 0) && (unresolved_ == 0); }
   bool IsLinked() const { return position_ > 0; }
+  bool HasNear() const { return unresolved_ != 0; }
 
  private:
-  int position_;
-
-  void Reinitialize() {
-    position_ = 0;
-  }
-
   void BindTo(int position) {
     ASSERT(!IsBound());
+    ASSERT(!HasNear());
     position_ = -position - kWordSize;
     ASSERT(IsBound());
   }
@@ -66,54 +279,436 @@ class Label : public ValueObject {
     ASSERT(IsLinked());
   }
 
+  void NearLinkTo(int position) {
+    ASSERT(!IsBound());
+    ASSERT(unresolved_ < kMaxUnresolvedBranches);
+    unresolved_near_positions_[unresolved_++] = position;
+  }
+
+  static const int kMaxUnresolvedBranches = 20;
+
+  int position_;
+  int unresolved_;
+  int unresolved_near_positions_[kMaxUnresolvedBranches];
+
   friend class Assembler;
   DISALLOW_COPY_AND_ASSIGN(Label);
 };
 
 
-class Assembler {
+// Instructions taking an Immediate which does not fit into a sign-extended
+// 32-bit field, e.g. the address of the null object, first load it into the
+// scratch register TMP. TMP may therefore not be passed to them.
+class Assembler : public ValueObject {
  public:
-  Assembler() { }
+  Assembler() : buffer_(), prolog_offset_(-1) { }
   ~Assembler() { }
 
-  // Macros for High-level operations.
-  void AddConstant(Register reg, int value) {
-    UNIMPLEMENTED();
+  static const bool kNearJump = true;
+  static const bool kFarJump = false;
+
+  /*
+   * Emit Machine Instructions.
+   */
+  void call(Register reg);
+  void call(const Address& address);
+  void call(Label* label);
+  void call(const ExternalLabel* label);
+
+  // External labels are called through TMP:
+  //   movq TMP, imm64
+  //   call TMP
+  static const intptr_t kCallExternalLabelSize = 13;
+
+  void pushq(Register reg);
+  void pushq(const Address& address);
+  void pushq(const Immediate& imm);
+
+  void popq(Register reg);
+  void popq(const Address& address);
+
+  void movl(Register dst, const Immediate& src);
+  void movl(Register dst, Register src);
+  void movl(Register dst, const Address& src);
+  void movl(const Address& dst, Register src);
+  void movl(const Address& dst, const Immediate& imm);
+
+  void movzxb(Register dst, ByteRegister src);
+  void movzxb(Register dst, const Address& src);
+  void movsxb(Register dst, ByteRegister src);
+  void movsxb(Register dst, const Address& src);
+  void movb(Register dst, const Address& src);
+  void movb(const Address& dst, ByteRegister src);
+  void movb(const Address& dst, const Immediate& imm);
+
+  void movzxw(Register dst, Register src);
+  void movzxw(Register dst, const Address& src);
+  void movsxw(Register dst, Register src);
+  void movsxw(Register dst, const Address& src);
+  void movw(Register dst, const Address& src);
+  void movw(const Address& dst, Register src);
+
+  void movq(Register dst, const Immediate& imm);
+  void movq(Register dst, Register src);
+  void movq(Register dst, const Address& src);
+  void movq(const Address& dst, Register src);
+  void movq(const Address& dst, const Immediate& imm);
+
+  void movsxd(Register dst, Register src);
+  void movsxd(Register dst, const Address& src);
+
+  void leaq(Register dst, const Address& src);
+
+  void cmovsq(Register dst, Register src);
+  void cmovnsq(Register dst, Register src);
+
+  void movss(XmmRegister dst, const Address& src);
+  void movss(const Address& dst, XmmRegister src);
+  void movss(XmmRegister dst, XmmRegister src);
+
+  void movd(XmmRegister dst, Register src);
+  void movd(Register dst, XmmRegister src);
+  void movq(XmmRegister dst, Register src);
+  void movq(Register dst, XmmRegister src);
+
+  void addss(XmmRegister dst, XmmRegister src);
+  void addss(XmmRegister dst, const Address& src);
+  void subss(XmmRegister dst, XmmRegister src);
+  void subss(XmmRegister dst, const Address& src);
+  void mulss(XmmRegister dst, XmmRegister src);
+  void mulss(XmmRegister dst, const Address& src);
+  void divss(XmmRegister dst, XmmRegister src);
+  void divss(XmmRegister dst, const Address& src);
+
+  void movsd(XmmRegister dst, const Address& src);
+  void movsd(const Address& dst, XmmRegister src);
+  void movsd(XmmRegister dst, XmmRegister src);
+
+  void movups(XmmRegister dst, const Address& src);
+  void movups(const Address& dst, XmmRegister src);
+
+  void addsd(XmmRegister dst, XmmRegister src);
+  void addsd(XmmRegister dst, const Address& src);
+  void subsd(XmmRegister dst, XmmRegister src);
+  void subsd(XmmRegister dst, const Address& src);
+  void mulsd(XmmRegister dst, XmmRegister src);
+  void mulsd(XmmRegister dst, const Address& src);
+  void divsd(XmmRegister dst, XmmRegister src);
+  void divsd(XmmRegister dst, const Address& src);
+
+  // The integer operand of the conversions is a 64-bit register.
+  void cvtsi2ss(XmmRegister dst, Register src);
+  void cvtsi2sd(XmmRegister dst, Register src);
+
+  void cvtss2si(Register dst, XmmRegister src);
+  void cvtss2sd(XmmRegister dst, XmmRegister src);
+
+  void cvtsd2si(Register dst, XmmRegister src);
+  void cvtsd2ss(XmmRegister dst, XmmRegister src);
+
+  void cvttss2si(Register dst, XmmRegister src);
+  void cvttsd2si(Register dst, XmmRegister src);
+
+  void cvtdq2pd(XmmRegister dst, XmmRegister src);
+
+  void comiss(XmmRegister a, XmmRegister b);
+  void comisd(XmmRegister a, XmmRegister b);
+
+  void sqrtsd(XmmRegister dst, XmmRegister src);
+  void sqrtss(XmmRegister dst, XmmRegister src);
+
+  void xorpd(XmmRegister dst, const Address& src);
+  void xorpd(XmmRegister dst, XmmRegister src);
+  void xorps(XmmRegister dst, const Address& src);
+  void xorps(XmmRegister dst, XmmRegister src);
+
+  void andpd(XmmRegister dst, const Address& src);
+
+  void xchgq(Register dst, Register src);
+
+  void cmpl(Register reg, const Immediate& imm);
+  void cmpl(Register reg0, Register reg1);
+  void cmpl(const Address& address, const Immediate& imm);
+
+  void cmpq(Register reg, const Immediate& imm);
+  void cmpq(Register reg0, Register reg1);
+  void cmpq(Register reg, const Address& address);
+
+  void cmpq(const Address& address, Register reg);
+  void cmpq(const Address& address, const Immediate& imm);
+
+  void testl(Register reg1, Register reg2);
+  void testl(Register reg, const Immediate& imm);
+
+  void testq(Register reg1, Register reg2);
+  void testq(Register reg, const Immediate& imm);
+
+  void andl(Register dst, Register src);
+  void andl(Register dst, const Immediate& imm);
+
+  void andq(Register dst, const Immediate& imm);
+  void andq(Register dst, Register src);
+  void andq(Register dst, const Address& address);
+
+  void orq(Register dst, const Immediate& imm);
+  void orq(Register dst, Register src);
+  void orq(Register dst, const Address& address);
+
+  void xorq(Register dst, const Immediate& imm);
+  void xorq(Register dst, Register src);
+  void xorq(Register dst, const Address& address);
+
+  void addl(Register dst, Register src);
+  void addl(Register reg, const Immediate& imm);
+
+  void addq(Register dst, Register src);
+  void addq(Register reg, const Immediate& imm);
+  void addq(Register reg, const Address& address);
+
+  void addq(const Address& address, Register reg);
+  void addq(const Address& address, const Immediate& imm);
+
+  void adcq(Register dst, Register src);
+  void adcq(Register reg, const Immediate& imm);
+  void adcq(Register dst, const Address& address);
+
+  void subl(Register dst, Register src);
+  void subl(Register reg, const Immediate& imm);
+
+  void subq(Register dst, Register src);
+  void subq(Register reg, const Immediate& imm);
+  void subq(Register reg, const Address& address);
+
+  void sbbq(Register dst, Register src);
+  void sbbq(Register reg, const Immediate& imm);
+  void sbbq(Register reg, const Address& address);
+
+  void cdq();
+  void cqo();
+
+  void idivl(Register reg);
+  void idivq(Register reg);
+
+  void imull(Register dst, Register src);
+
+  void imulq(Register dst, Register src);
+  void imulq(Register reg, const Immediate& imm);
+  void imulq(Register reg, const Address& address);
+
+  void imulq(Register reg);
+  void mulq(Register reg);
+
+  void incq(Register reg);
+  void incq(const Address& address);
+
+  void decq(Register reg);
+  void decq(const Address& address);
+
+  void shll(Register reg, const Immediate& imm);
+  void shll(Register operand, Register shifter);
+  void shrl(Register reg, const Immediate& imm);
+  void shrl(Register operand, Register shifter);
+  void sarl(Register reg, const Immediate& imm);
+  void sarl(Register operand, Register shifter);
+
+  void shlq(Register reg, const Immediate& imm);
+  void shlq(Register operand, Register shifter);
+  void shrq(Register reg, const Immediate& imm);
+  void shrq(Register operand, Register shifter);
+  void sarq(Register reg, const Immediate& imm);
+  void sarq(Register operand, Register shifter);
+  void shldq(Register dst, Register src);
+
+  void negl(Register reg);
+  void negq(Register reg);
+  void notq(Register reg);
+
+  void enter(const Immediate& imm);
+  void leave();
+
+  void ret();
+  void ret(const Immediate& imm);
+
+  void nop();
+  void int3();
+  void hlt();
+
+  // Jumps to an external label are encoded as a short conditional jump over
+  // a jump through TMP.
+  void j(Condition condition, Label* label, bool near = kFarJump);
+  void j(Condition condition, const ExternalLabel* label);
+
+  void jmp(Register reg);
+  void jmp(const Address& address);
+  void jmp(Label* label, bool near = kFarJump);
+  void jmp(const ExternalLabel* label);
+
+  void lock();
+  void cmpxchgq(const Address& address, Register reg);
+
+  /*
+   * Macros for High-level operations.
+   */
+  void AddImmediate(Register reg, const Immediate& imm);
+
+  // Objects are embedded as 64-bit immediates, only LoadObject emits a single
+  // instruction, PushObject and CompareObject go through TMP.
+  void LoadObject(Register dst, const Object& object);
+  void PushObject(const Object& object);
+  void CompareObject(Register reg, const Object& object);
+  void LoadDoubleConstant(XmmRegister dst, double value);
+
+  void StoreIntoObject(Register object,  // Object we are storing into.
+                       const FieldAddress& dest,  // Where we are storing into.
+                       Register value);  // Value we are storing.
+
+  void DoubleNegate(XmmRegister d);
+  void FloatNegate(XmmRegister f);
+
+  void DoubleAbs(XmmRegister reg);
+
+  void LockCmpxchgq(const Address& address, Register reg) {
+    lock();
+    cmpxchgq(address, reg);
   }
 
-  // Misc. functionality
-  int CodeSize() const {
-    UNIMPLEMENTED();
-    return 0;
+  void EnterFrame(intptr_t frame_space);
+  void LeaveFrame();
+
+  void CallRuntimeFromDart(const RuntimeEntry& entry);
+  void CallRuntimeFromStub(const RuntimeEntry& entry);
+
+  /*
+   * Misc. functionality
+   */
+  void SmiTag(Register reg) {
+    addq(reg, reg);
   }
-  int prolog_offset() const {
-    UNIMPLEMENTED();
-    return 0;
+
+  void SmiUntag(Register reg) {
+    sarq(reg, Immediate(kSmiTagSize));
   }
+
+  int PreferredLoopAlignment() { return 16; }
+  void Align(int alignment, int offset);
+  void Bind(Label* label);
+
+  int CodeSize() const { return buffer_.Size(); }
+  int prolog_offset() const { return prolog_offset_; }
   const ZoneGrowableArray<int>& GetPointerOffsets() const {
-    UNIMPLEMENTED();
-    return *pointer_offsets_;
+    return buffer_.pointer_offsets();
   }
+
   void FinalizeInstructions(const MemoryRegion& region) {
-    UNIMPLEMENTED();
+    buffer_.FinalizeInstructions(region);
   }
 
   // Debugging and bringup support.
-  void Stop(const char* message) { UNIMPLEMENTED(); }
+  void Stop(const char* message);
   void Unimplemented(const char* message);
   void Untested(const char* message);
   void Unreachable(const char* message);
 
-  static void InitializeMemoryWithBreakpoints(uword data, int length) {
-    UNIMPLEMENTED();
-  }
+  static void InitializeMemoryWithBreakpoints(uword data, int length);
 
  private:
-  ZoneGrowableArray<int>* pointer_offsets_;
+  AssemblerBuffer buffer_;
+  int prolog_offset_;
+
+  inline void EmitUint8(uint8_t value);
+  inline void EmitInt32(int32_t value);
+  inline void EmitInt64(int64_t value);
+
+  inline void EmitRegisterREX(Register reg, uint8_t rex);
+  inline void EmitRegisterRegisterREX(Register reg, Register rm, uint8_t rex);
+  inline void EmitOperandREX(int rm, const Operand& operand, uint8_t rex);
+  inline void EmitRegisterOperand(int rm, int reg);
+  inline void EmitXmmRegisterOperand(int rm, XmmRegister reg);
+  inline void EmitFixup(AssemblerFixup* fixup);
+  inline void EmitOperandSizeOverride();
+
+  void EmitOperand(int rm, const Operand& operand);
+  void EmitImmediate(const Immediate& imm);
+  void EmitComplex(int rm, const Operand& operand, const Immediate& immediate);
+  void EmitLabel(Label* label, int instruction_size);
+  void EmitLabelLink(Label* label);
+  void EmitNearLabelLink(Label* label);
+
+  void EmitGenericShift(bool wide, int rm, Register reg, const Immediate& imm);
+  void EmitGenericShift(bool wide, int rm, Register operand, Register shifter);
+
+  // Emits an instruction of the form 'prefix REX 0F opcode' with two XMM
+  // register operands or an XMM register and a memory operand.
+  void EmitXmmOp(uint8_t prefix, uint8_t opcode,
+                 XmmRegister dst, XmmRegister src);
+  void EmitXmmOp(uint8_t prefix, uint8_t opcode,
+                 XmmRegister dst, const Address& src);
+
   DISALLOW_ALLOCATION();
   DISALLOW_COPY_AND_ASSIGN(Assembler);
 };
 
+
+inline void Assembler::EmitUint8(uint8_t value) {
+  buffer_.Emit<uint8_t>(value);
+}
+
+
+inline void Assembler::EmitInt32(int32_t value) {
+  buffer_.Emit<int32_t>(value);
+}
+
+
+inline void Assembler::EmitInt64(int64_t value) {
+  buffer_.Emit<int64_t>(value);
+}
+
+
+inline void Assembler::EmitRegisterREX(Register reg, uint8_t rex) {
+  ASSERT(reg != kNoRegister);
+  rex |= (reg > 7 ? REX_B : REX_NONE);
+  if (rex != REX_NONE) EmitUint8(REX_PREFIX | rex);
+}
+
+
+// 'reg' is encoded in the reg field and 'rm' in the rm field of the ModRM
+// byte.
+inline void Assembler::EmitRegisterRegisterREX(Register reg,
+                                               Register rm,
+                                               uint8_t rex) {
+  rex |= (reg > 7 ? REX_R : REX_NONE) | (rm > 7 ? REX_B : REX_NONE);
+  if (rex != REX_NONE) EmitUint8(REX_PREFIX | rex);
+}
+
+
+inline void Assembler::EmitOperandREX(int rm,
+                                      const Operand& operand,
+                                      uint8_t rex) {
+  rex |= (rm > 7 ? REX_R : REX_NONE) | operand.rex();
+  if (rex != REX_NONE) EmitUint8(REX_PREFIX | rex);
+}
+
+
+inline void Assembler::EmitRegisterOperand(int rm, int reg) {
+  ASSERT(rm >= 0 && rm < 16);
+  buffer_.Emit<uint8_t>(0xC0 + ((rm & 7) << 3) + (reg & 7));
+}
+
+
+inline void Assembler::EmitXmmRegisterOperand(int rm, XmmRegister reg) {
+  EmitRegisterOperand(rm, static_cast<Register>(reg));
+}
+
+
+inline void Assembler::EmitFixup(AssemblerFixup* fixup) {
+  buffer_.EmitFixup(fixup);
+}
+
+
+inline void Assembler::EmitOperandSizeOverride() {
+  EmitUint8(0x66);
+}
+
 }  // namespace dart
 
 #endif  // VM_ASSEMBLER_X64_H_
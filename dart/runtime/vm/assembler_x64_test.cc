@@ -0,0 +1,1247 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/globals.h"
+#if defined(TARGET_ARCH_X64)
+
+#include "vm/assembler.h"
+#include "vm/os.h"
+#include "vm/unit_test.h"
+#include "vm/virtual_memory.h"
+
+namespace dart {
+
+#define __ assembler->
+
+
+ASSEMBLER_TEST_GENERATE(Simple, assembler) {
+  __ movq(RAX, Immediate(42));
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(Simple, entry) {
+  typedef int64_t (*SimpleCode)();
+  EXPECT_EQ(42, reinterpret_cast<SimpleCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(ReadArgument, assembler) {
+  // The first argument is passed in RDI.
+  __ pushq(RDI);
+  __ movq(RAX, Address(RSP, 0));
+  __ popq(RDX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(ReadArgument, entry) {
+  typedef int64_t (*ReadArgumentCode)(int64_t n);
+  EXPECT_EQ(42, reinterpret_cast<ReadArgumentCode>(entry)(42));
+  EXPECT_EQ(87, reinterpret_cast<ReadArgumentCode>(entry)(87));
+  const int64_t kLarge = 0x123456789ABCDEFLL;
+  EXPECT_EQ(kLarge, reinterpret_cast<ReadArgumentCode>(entry)(kLarge));
+}
+
+
+ASSEMBLER_TEST_GENERATE(AddressingModes, assembler) {
+  __ movq(RAX, Address(RSP, 0));
+  __ movq(RAX, Address(RBP, 0));
+  __ movq(RAX, Address(RAX, 0));
+  __ movq(RAX, Address(R10, 0));
+  __ movq(RAX, Address(R12, 0));
+  __ movq(RAX, Address(R13, 0));
+  __ movq(R10, Address(RAX, 0));
+
+  __ movq(RAX, Address(RSP, kWordSize));
+  __ movq(RAX, Address(RBP, kWordSize));
+  __ movq(RAX, Address(RAX, kWordSize));
+  __ movq(RAX, Address(R10, kWordSize));
+  __ movq(RAX, Address(R12, kWordSize));
+  __ movq(RAX, Address(R13, kWordSize));
+
+  __ movq(RAX, Address(RSP, -kWordSize));
+  __ movq(RAX, Address(RBP, -kWordSize));
+  __ movq(RAX, Address(RAX, -kWordSize));
+  __ movq(RAX, Address(R10, -kWordSize));
+  __ movq(RAX, Address(R12, -kWordSize));
+  __ movq(RAX, Address(R13, -kWordSize));
+
+  __ movq(RAX, Address(RSP, 256 * kWordSize));
+  __ movq(RAX, Address(RBP, 256 * kWordSize));
+  __ movq(RAX, Address(RAX, 256 * kWordSize));
+  __ movq(RAX, Address(R10, 256 * kWordSize));
+  __ movq(RAX, Address(R12, 256 * kWordSize));
+  __ movq(RAX, Address(R13, 256 * kWordSize));
+
+  __ movq(RAX, Address(RAX, TIMES_1, 0));
+  __ movq(RAX, Address(RAX, TIMES_2, 0));
+  __ movq(RAX, Address(RAX, TIMES_4, 0));
+  __ movq(RAX, Address(RAX, TIMES_8, 0));
+
+  __ movq(RAX, Address(RBP, TIMES_2, 0));
+  __ movq(RAX, Address(R10, TIMES_2, 0));
+  __ movq(RAX, Address(R13, TIMES_2, 0));
+
+  __ movq(RAX, Address(RBP, TIMES_2, kWordSize));
+  __ movq(RAX, Address(R10, TIMES_2, 256 * kWordSize));
+
+  __ movq(RAX, Address(RAX, RBP, TIMES_2, 0));
+  __ movq(RAX, Address(RBP, RAX, TIMES_2, 0));
+  __ movq(RAX, Address(RSP, RBP, TIMES_2, 0));
+  __ movq(RAX, Address(R12, R10, TIMES_2, 0));
+  __ movq(RAX, Address(R13, R10, TIMES_2, 0));
+  __ movq(RAX, Address(R10, R12, TIMES_2, 0));
+
+  __ movq(RAX, Address(RAX, RBP, TIMES_2, kWordSize));
+  __ movq(RAX, Address(R12, R10, TIMES_2, kWordSize));
+  __ movq(RAX, Address(R13, R10, TIMES_2, kWordSize));
+
+  __ movq(RAX, Address(RAX, RBP, TIMES_2, 256 * kWordSize));
+  __ movq(RAX, Address(R12, R10, TIMES_2, 256 * kWordSize));
+  __ movq(RAX, Address(R13, R10, TIMES_2, 256 * kWordSize));
+}
+
+
+ASSEMBLER_TEST_RUN(AddressingModes, entry) {
+  // Avoid running the code since it is constructed to lead to crashes.
+}
+
+
+ASSEMBLER_TEST_GENERATE(ExtendedRegisterAddressing, assembler) {
+  // Exercise the REX.B and REX.X extensions of the memory operands by storing
+  // and loading through every register that can serve as base or index.
+  __ pushq(R12);
+  __ pushq(R13);
+  __ subq(RSP, Immediate(4 * kWordSize));
+  __ movq(R12, RSP);
+  __ movq(R13, RSP);
+  __ movq(R10, Immediate(1));
+  __ movq(Address(R12, 0), Immediate(1));
+  __ movq(Address(R13, kWordSize), Immediate(2));
+  __ movq(Address(R12, R10, TIMES_8, kWordSize), Immediate(3));
+  __ movq(Address(R13, R10, TIMES_8, 2 * kWordSize), Immediate(4));
+  __ movq(RAX, Address(RSP, 0));
+  __ addq(RAX, Address(R12, kWordSize));
+  __ addq(RAX, Address(R13, R10, TIMES_8, kWordSize));
+  __ movq(R9, Address(R12, R10, TIMES_8, 2 * kWordSize));
+  __ shlq(R9, Immediate(4));
+  __ addq(RAX, R9);
+  __ addq(RSP, Immediate(4 * kWordSize));
+  __ popq(R13);
+  __ popq(R12);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(ExtendedRegisterAddressing, entry) {
+  typedef int64_t (*ExtendedRegisterAddressingCode)();
+  EXPECT_EQ(1 + 2 + 3 + (4 << 4),
+            reinterpret_cast<ExtendedRegisterAddressingCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(JumpAroundCrash, assembler) {
+  Label done;
+  // Make sure all the condition jumps work.
+  for (Condition condition = OVERFLOW;
+       condition <= GREATER;
+       condition = static_cast<Condition>(condition + 1)) {
+    __ j(condition, &done);
+  }
+  // This isn't strictly necessary, but we do an unconditional
+  // jump around the crashing code anyway.
+  __ jmp(&done);
+
+  // Be sure to skip this crashing code.
+  __ movq(RAX, Immediate(0));
+  __ movq(Address(RAX, 0), RAX);
+
+  __ Bind(&done);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(JumpAroundCrash, entry) {
+  Instr* instr = Instr::At(entry);
+  EXPECT(!instr->IsBreakPoint());
+  typedef void (*JumpAroundCrashCode)();
+  reinterpret_cast<JumpAroundCrashCode>(entry)();
+}
+
+
+ASSEMBLER_TEST_GENERATE(NearJumpAroundCrash, assembler) {
+  Label done;
+  // Make sure all the condition jumps work.
+  for (Condition condition = OVERFLOW;
+       condition <= GREATER;
+       condition = static_cast<Condition>(condition + 1)) {
+    __ j(condition, &done, Assembler::kNearJump);
+  }
+  // This isn't strictly necessary, but we do an unconditional
+  // jump around the crashing code anyway.
+  __ jmp(&done, Assembler::kNearJump);
+
+  // Be sure to skip this crashing code.
+  __ movq(RAX, Immediate(0));
+  __ movq(Address(RAX, 0), RAX);
+
+  __ Bind(&done);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(NearJumpAroundCrash, entry) {
+  typedef void (*NearJumpAroundCrashCode)();
+  reinterpret_cast<NearJumpAroundCrashCode>(entry)();
+}
+
+
+ASSEMBLER_TEST_GENERATE(SimpleLoop, assembler) {
+  __ movq(RAX, Immediate(0));
+  __ movq(RCX, Immediate(0));
+  Label loop;
+  __ Bind(&loop);
+  __ addq(RAX, Immediate(2));
+  __ incq(RCX);
+  __ cmpq(RCX, Immediate(87));
+  __ j(LESS, &loop);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(SimpleLoop, entry) {
+  typedef int64_t (*SimpleLoopCode)();
+  EXPECT_EQ(2 * 87, reinterpret_cast<SimpleLoopCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(Increment, assembler) {
+  __ movq(RAX, Immediate(0));
+  __ pushq(RAX);
+  __ incq(Address(RSP, 0));
+  __ movq(R10, Address(RSP, 0));
+  __ incq(R10);
+  __ popq(RAX);
+  __ movq(RAX, R10);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(Increment, entry) {
+  typedef int64_t (*IncrementCode)();
+  EXPECT_EQ(2, reinterpret_cast<IncrementCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(Decrement, assembler) {
+  __ movq(RAX, Immediate(2));
+  __ pushq(RAX);
+  __ decq(Address(RSP, 0));
+  __ movq(R10, Address(RSP, 0));
+  __ decq(R10);
+  __ popq(RAX);
+  __ movq(RAX, R10);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(Decrement, entry) {
+  typedef int64_t (*DecrementCode)();
+  EXPECT_EQ(0, reinterpret_cast<DecrementCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(AddressBinOp, assembler) {
+  __ pushq(RDI);
+  __ movq(RAX, Address(RSP, 0));
+  __ addq(RAX, Address(RSP, 0));
+  __ incq(RAX);
+  __ subq(RAX, Address(RSP, 0));
+  __ imulq(RAX, Address(RSP, 0));
+  __ popq(RDI);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(AddressBinOp, entry) {
+  typedef int64_t (*AddressBinOpCode)(int64_t a);
+  EXPECT_EQ((2 + 2 + 1 - 2) * 2, reinterpret_cast<AddressBinOpCode>(entry)(2));
+}
+
+
+ASSEMBLER_TEST_GENERATE(LargeImmediates, assembler) {
+  // Immediates which do not fit into 32 bits go through TMP.
+  __ movq(RAX, Immediate(0x100000000LL));
+  __ addq(RAX, Immediate(0x200000000LL));
+  __ subq(RAX, Immediate(0x100000000LL));
+  __ pushq(Immediate(0x400000000LL));
+  __ addq(RAX, Address(RSP, 0));
+  __ addq(Address(RSP, 0), Immediate(0x800000000LL));
+  __ cmpq(Address(RSP, 0), Immediate(0xC00000000LL));
+  Label fail;
+  __ j(NOT_EQUAL, &fail);
+  __ cmpq(RAX, Immediate(0x600000000LL));
+  __ j(NOT_EQUAL, &fail);
+  __ popq(RCX);
+  __ andq(RAX, Immediate(0x200000001LL));
+  __ orq(RAX, Immediate(1));
+  __ ret();
+  __ Bind(&fail);
+  __ popq(RCX);
+  __ movq(RAX, Immediate(0));
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(LargeImmediates, entry) {
+  typedef int64_t (*LargeImmediatesCode)();
+  EXPECT_EQ(0x200000001LL,
+            reinterpret_cast<LargeImmediatesCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(SignedMultiply, assembler) {
+  __ movq(RAX, Immediate(2));
+  __ movq(RCX, Immediate(4));
+  __ imulq(RAX, RCX);
+  __ imulq(RAX, Immediate(1000));
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(SignedMultiply, entry) {
+  typedef int64_t (*SignedMultiply)();
+  EXPECT_EQ(8000, reinterpret_cast<SignedMultiply>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(OverflowSignedMultiply, assembler) {
+  Label overflow;
+  __ movq(RAX, Immediate(0x0fffffff));
+  __ movq(RCX, Immediate(0x0fffffff));
+  __ imulq(RAX, RCX);  // Fits into 64 bits.
+  __ j(OVERFLOW, &overflow);
+  __ imulq(RAX, RCX);  // Does not fit into 64 bits.
+  __ j(OVERFLOW, &overflow);
+  __ movq(RAX, Immediate(0));
+  __ ret();
+  __ Bind(&overflow);
+  __ movq(RAX, Immediate(1));
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(OverflowSignedMultiply, entry) {
+  typedef int64_t (*OverflowSignedMultiply)();
+  EXPECT_EQ(1, reinterpret_cast<OverflowSignedMultiply>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(SignedMultiply1, assembler) {
+  __ pushq(R15);  // preserve R15.
+  __ movq(R15, Immediate(2));
+  __ movq(RCX, Immediate(4));
+  __ imulq(R15, RCX);
+  __ imulq(R15, Immediate(1000));
+  __ movq(RAX, R15);
+  __ popq(R15);  // restore R15.
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(SignedMultiply1, entry) {
+  typedef int64_t (*SignedMultiply1)();
+  EXPECT_EQ(8000, reinterpret_cast<SignedMultiply1>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(UnsignedMultiply, assembler) {
+  // The high 64 bits of the product are returned.
+  __ movq(RAX, RDI);
+  __ mulq(RSI);
+  __ movq(RAX, RDX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(UnsignedMultiply, entry) {
+  typedef uint64_t (*UnsignedMultiplyCode)(uint64_t a, uint64_t b);
+  EXPECT_EQ(0xFFFFFFFFFFFFFFFEULL,
+            reinterpret_cast<UnsignedMultiplyCode>(entry)(
+                0xFFFFFFFFFFFFFFFFULL,
+                0xFFFFFFFFFFFFFFFFULL));
+}
+
+
+ASSEMBLER_TEST_GENERATE(Negate, assembler) {
+  __ movq(R8, Immediate(42));
+  __ negq(R8);
+  __ movq(RAX, R8);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(Negate, entry) {
+  typedef int64_t (*Negate)();
+  EXPECT_EQ(-42, reinterpret_cast<Negate>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(MoveExtend, assembler) {
+  __ movq(RDX, Immediate(0x1234ffff));
+  __ movzxb(RAX, DL);  // RAX = 0xff
+  __ movsxw(R8, RDX);  // R8 = -1
+  __ movzxw(RCX, RDX);  // RCX = 0xffff
+  __ addq(R8, RCX);
+  __ addq(RAX, R8);
+  __ movq(RDI, Immediate(0x80));
+  __ movsxb(RCX, DIL);  // RCX = -128
+  __ addq(RAX, RCX);
+  __ movq(RDX, Immediate(-1));
+  __ movl(RDX, RDX);  // Upper 32 bits are cleared.
+  __ movsxd(RCX, RDX);  // RCX = -1
+  __ addq(RAX, RCX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(MoveExtend, entry) {
+  typedef int64_t (*MoveExtend)();
+  EXPECT_EQ(0xff - 1 + 0xffff - 128 - 1,
+            reinterpret_cast<MoveExtend>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(MoveExtendMemory, assembler) {
+  __ movq(RDX, Immediate(0x1234ffff));
+
+  __ pushq(RDX);
+  __ movzxb(RAX, Address(RSP, 0));  // RAX = 0xff
+  __ movsxw(R8, Address(RSP, 0));  // R8 = -1
+  __ movzxw(RCX, Address(RSP, 0));  // RCX = 0xffff
+  __ movb(Address(RSP, 0), Immediate(-128));
+  __ movsxb(R9, Address(RSP, 0));  // R9 = -128
+  __ addq(RSP, Immediate(kWordSize));
+
+  __ addq(R8, RCX);
+  __ addq(RAX, R8);
+  __ addq(RAX, R9);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(MoveExtendMemory, entry) {
+  typedef int64_t (*MoveExtendMemory)();
+  EXPECT_EQ(0xff - 1 + 0xffff - 128,
+            reinterpret_cast<MoveExtendMemory>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(MoveWordAndByte, assembler) {
+  __ pushq(Immediate(0));
+  __ movq(RCX, Immediate(0x1234));
+  __ movw(Address(RSP, 0), RCX);
+  __ movq(RSI, Immediate(0x56));
+  __ movb(Address(RSP, 2), SIL);
+  __ movq(RAX, Address(RSP, 0));
+  __ popq(RCX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(MoveWordAndByte, entry) {
+  typedef int64_t (*MoveWordAndByteCode)();
+  EXPECT_EQ(0x561234, reinterpret_cast<MoveWordAndByteCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(Bitwise, assembler) {
+  __ movq(R10, Immediate(42));
+  __ xorq(R10, R10);
+  __ orq(R10, Immediate(256));
+  __ movq(RAX, Immediate(4));
+  __ orq(R10, RAX);
+  __ movq(RAX, Immediate(0xfff0));
+  __ andq(R10, RAX);
+  __ movq(RAX, Immediate(1));
+  __ orq(R10, RAX);
+  __ notq(R10);
+  __ notq(R10);
+  __ movq(RAX, R10);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(Bitwise, entry) {
+  typedef int64_t (*Bitwise)();
+  EXPECT_EQ(256 + 1, reinterpret_cast<Bitwise>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(Shifts, assembler) {
+  __ movq(RAX, Immediate(1));
+  __ shlq(RAX, Immediate(40));  // 1 << 40.
+  __ movq(RDX, RAX);
+  __ sarq(RDX, Immediate(38));  // 4.
+  __ movq(RCX, Immediate(3));
+  __ shlq(RDX, RCX);  // 32.
+  __ addq(RAX, RDX);
+  __ movq(R8, Immediate(-16));
+  __ sarq(R8, RCX);  // -2.
+  __ addq(RAX, R8);
+  __ movq(R9, Immediate(-1));
+  __ shrq(R9, Immediate(62));  // 3.
+  __ addq(RAX, R9);
+  __ movq(R10, Immediate(-1));
+  __ shrl(R10, Immediate(28));  // 15, upper bits are cleared.
+  __ addq(RAX, R10);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(Shifts, entry) {
+  typedef int64_t (*ShiftsCode)();
+  EXPECT_EQ((1LL << 40) + 32 - 2 + 3 + 15,
+            reinterpret_cast<ShiftsCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(DoubleShiftLeft, assembler) {
+  __ movq(RAX, RDI);
+  __ movq(RDX, RSI);
+  __ movq(RCX, Immediate(8));
+  __ shldq(RAX, RDX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(DoubleShiftLeft, entry) {
+  typedef uint64_t (*DoubleShiftLeftCode)(uint64_t high, uint64_t low);
+  EXPECT_EQ(0x23456789ABCDEFFEULL,
+            reinterpret_cast<DoubleShiftLeftCode>(entry)(
+                0x0123456789ABCDEFULL,
+                0xFE00000000000000ULL));
+}
+
+
+ASSEMBLER_TEST_GENERATE(LogicalTest, assembler) {
+  Label donetest1;
+  __ movq(RAX, Immediate(4));
+  __ movq(RCX, Immediate(2));
+  __ testq(RAX, RCX);
+  __ j(EQUAL, &donetest1);
+  // Be sure to skip this crashing code.
+  __ movq(RAX, Immediate(0));
+  __ movq(Address(RAX, 0), RAX);
+  __ Bind(&donetest1);
+
+  Label donetest2;
+  __ movq(RDX, Immediate(4));
+  __ movq(RCX, Immediate(4));
+  __ testq(RDX, RCX);
+  __ j(NOT_EQUAL, &donetest2);
+  // Be sure to skip this crashing code.
+  __ movq(RAX, Immediate(0));
+  __ movq(Address(RAX, 0), RAX);
+  __ Bind(&donetest2);
+
+  Label donetest3;
+  __ movq(RAX, Immediate(0));
+  __ testq(RAX, Immediate(0));
+  __ j(EQUAL, &donetest3);
+  // Be sure to skip this crashing code.
+  __ movq(RAX, Immediate(0));
+  __ movq(Address(RAX, 0), RAX);
+  __ Bind(&donetest3);
+
+  Label donetest4;
+  __ movq(R10, Immediate(4));
+  __ testq(R10, Immediate(4));
+  __ j(NOT_EQUAL, &donetest4);
+  // Be sure to skip this crashing code.
+  __ movq(RAX, Immediate(0));
+  __ movq(Address(RAX, 0), RAX);
+  __ Bind(&donetest4);
+
+  Label donetest5;
+  __ movq(RCX, Immediate(0x100000000LL));
+  __ testq(RCX, Immediate(0x100000000LL));
+  __ j(NOT_EQUAL, &donetest5);
+  // Be sure to skip this crashing code.
+  __ movq(RAX, Immediate(0));
+  __ movq(Address(RAX, 0), RAX);
+  __ Bind(&donetest5);
+
+  __ movq(RAX, Immediate(0));
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(LogicalTest, entry) {
+  typedef int64_t (*LogicalTestCode)();
+  EXPECT_EQ(0, reinterpret_cast<LogicalTestCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(CompareSwapEQ, assembler) {
+  __ movq(RAX, Immediate(0));
+  __ pushq(RAX);
+  __ movq(RAX, Immediate(4));
+  __ movq(RCX, Immediate(0));
+  __ movq(Address(RSP, 0), RAX);
+  __ LockCmpxchgq(Address(RSP, 0), RCX);
+  __ popq(RAX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(CompareSwapEQ, entry) {
+  typedef int64_t (*CompareSwapEQCode)();
+  EXPECT_EQ(0, reinterpret_cast<CompareSwapEQCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(CompareSwapNEQ, assembler) {
+  __ movq(RAX, Immediate(0));
+  __ pushq(RAX);
+  __ movq(RAX, Immediate(2));
+  __ movq(RCX, Immediate(4));
+  __ movq(Address(RSP, 0), RCX);
+  __ LockCmpxchgq(Address(RSP, 0), RCX);
+  __ popq(RAX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(CompareSwapNEQ, entry) {
+  typedef int64_t (*CompareSwapNEQCode)();
+  EXPECT_EQ(4, reinterpret_cast<CompareSwapNEQCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(SignedDivide, assembler) {
+  __ movq(RAX, Immediate(-87));
+  __ movq(RDX, Immediate(123));
+  __ cqo();
+  __ movq(RCX, Immediate(42));
+  __ idivq(RCX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(SignedDivide, entry) {
+  typedef int64_t (*SignedDivide)();
+  EXPECT_EQ(-87 / 42, reinterpret_cast<SignedDivide>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(SignedDivide32, assembler) {
+  __ movl(RAX, Immediate(-87));
+  __ movl(RDX, Immediate(123));
+  __ cdq();
+  __ movl(R9, Immediate(42));
+  __ idivl(R9);
+  __ movsxd(RAX, RAX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(SignedDivide32, entry) {
+  typedef int64_t (*SignedDivide32)();
+  EXPECT_EQ(-87 / 42, reinterpret_cast<SignedDivide32>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(Exchange, assembler) {
+  __ movq(RAX, Immediate(123456789));
+  __ movq(R10, Immediate(987654321));
+  __ xchgq(RAX, R10);
+  __ subq(RAX, R10);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(Exchange, entry) {
+  typedef int64_t (*Exchange)();
+  EXPECT_EQ(987654321 - 123456789, reinterpret_cast<Exchange>(entry)());
+}
+
+
+static int64_t LeafReturn42() {
+  return 42;
+}
+
+
+static int64_t LeafReturnArgument(int64_t x) {
+  return x + 87;
+}
+
+
+ASSEMBLER_TEST_GENERATE(CallSimpleLeaf, assembler) {
+  ExternalLabel call1("LeafReturn42", reinterpret_cast<uword>(LeafReturn42));
+  ExternalLabel call2("LeafReturnArgument",
+                      reinterpret_cast<uword>(LeafReturnArgument));
+  // Realign the stack pushed out of alignment by the return address.
+  __ subq(RSP, Immediate(kWordSize));
+  __ call(&call1);
+  __ movq(RDI, RAX);
+  __ call(&call2);
+  __ addq(RSP, Immediate(kWordSize));
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(CallSimpleLeaf, entry) {
+  typedef int64_t (*CallSimpleLeafCode)();
+  EXPECT_EQ(42 + 87, reinterpret_cast<CallSimpleLeafCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(JumpSimpleLeaf, assembler) {
+  ExternalLabel call1("LeafReturn42", reinterpret_cast<uword>(LeafReturn42));
+  Label L;
+  __ subq(RSP, Immediate(kWordSize));
+  __ call(&L);
+  __ addq(RSP, Immediate(kWordSize));
+  __ ret();
+  __ Bind(&L);
+  __ jmp(&call1);
+}
+
+
+ASSEMBLER_TEST_RUN(JumpSimpleLeaf, entry) {
+  typedef int64_t (*JumpSimpleLeafCode)();
+  EXPECT_EQ(42, reinterpret_cast<JumpSimpleLeafCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(JumpConditionalSimpleLeaf, assembler) {
+  ExternalLabel call1("LeafReturn42", reinterpret_cast<uword>(LeafReturn42));
+  Label L;
+  __ subq(RSP, Immediate(kWordSize));
+  __ call(&L);
+  __ addq(RSP, Immediate(kWordSize));
+  __ ret();
+  __ Bind(&L);
+  __ cmpq(RSP, Immediate(0));
+  __ j(EQUAL, &call1);  // Not taken.
+  __ j(NOT_EQUAL, &call1);
+  __ int3();
+}
+
+
+ASSEMBLER_TEST_RUN(JumpConditionalSimpleLeaf, entry) {
+  typedef int64_t (*JumpConditionalSimpleLeafCode)();
+  EXPECT_EQ(42, reinterpret_cast<JumpConditionalSimpleLeafCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(SingleFPMoves, assembler) {
+  __ movq(RAX, Immediate(bit_cast<int32_t, float>(234.0f)));
+  __ movd(XMM0, RAX);
+  __ movss(XMM1, XMM0);
+  __ movss(XMM2, XMM1);
+  __ movss(XMM3, XMM2);
+  __ movss(XMM4, XMM3);
+  __ movss(XMM5, XMM4);
+  __ movss(XMM6, XMM5);
+  __ movss(XMM7, XMM6);
+  __ movss(XMM8, XMM7);
+  __ movss(XMM9, XMM8);
+  __ movss(XMM10, XMM9);
+  __ movss(XMM11, XMM10);
+  __ movss(XMM12, XMM11);
+  __ movss(XMM13, XMM12);
+  __ movss(XMM14, XMM13);
+  __ movss(XMM15, XMM14);
+  __ pushq(RAX);
+  __ movq(Address(RSP, 0), Immediate(0));
+  __ movss(Address(RSP, 0), XMM15);
+  __ movss(XMM0, Address(RSP, 0));
+  __ popq(RAX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(SingleFPMoves, entry) {
+  typedef float (*SingleFPMovesCode)();
+  EXPECT_EQ(234.0f, reinterpret_cast<SingleFPMovesCode>(entry)());
+}
+
+
+ASSEMBLER_TEST_GENERATE(SingleFPOperations, assembler) {
+  __ movq(RAX, Immediate(bit_cast<int32_t, float>(12.3f)));
+  __ movd(XMM0, RAX);
+  __ movss(XMM9, XMM0);
+  __ movq(RAX, Immediate(bit_cast<int32_t, float>(3.4f)));
+  __ movd(XMM1, RAX);
+  __ addss(XMM0, XMM1);  // 15.7f
+  __ mulss(XMM0, XMM1);  // 53.38f
+  __ subss(XMM0, XMM1);  // 49.98f
+  __ divss(XMM0, XMM1);  // 14.7f
+  __ pushq(RAX);
+  __ movss(Address(RSP, 0), XMM1);
+  __ addss(XMM9, Address(RSP, 0));  // 15.7f
+  __ mulss(XMM9, Address(RSP, 0));  // 53.38f
+  __ subss(XMM9, Address(RSP, 0));  // 49.98f
+  __ divss(XMM9, Address(RSP, 0));  // 14.7f
+  __ popq(RAX);
+  __ subss(XMM0, XMM9);  // 0.0f
+  __ addss(XMM0, XMM1);  // 3.4f
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(SingleFPOperations, entry) {
+  typedef float (*SingleFPOperationsCode)();
+  float res = reinterpret_cast<SingleFPOperationsCode>(entry)();
+  EXPECT_FLOAT_EQ(3.4f, res, 0.001f);
+}
+
+
+ASSEMBLER_TEST_GENERATE(DoubleFPMoves, assembler) {
+  __ movq(RAX, Immediate(bit_cast<int64_t, double>(1024.67)));
+  __ movq(XMM0, RAX);
+  __ movsd(XMM1, XMM0);
+  __ movsd(XMM2, XMM1);
+  __ movsd(XMM3, XMM2);
+  __ movsd(XMM4, XMM3);
+  __ movsd(XMM5, XMM4);
+  __ movsd(XMM6, XMM5);
+  __ movsd(XMM7, XMM6);
+  __ movsd(XMM8, XMM7);
+  __ movsd(XMM9, XMM8);
+  __ movsd(XMM10, XMM9);
+  __ movsd(XMM11, XMM10);
+  __ movsd(XMM12, XMM11);
+  __ movsd(XMM13, XMM12);
+  __ movsd(XMM14, XMM13);
+  __ movsd(XMM15, XMM14);
+  __ pushq(RAX);
+  __ movq(Address(RSP, 0), Immediate(0));
+  __ movsd(Address(RSP, 0), XMM15);
+  __ movsd(XMM0, Address(RSP, 0));
+  __ popq(RAX);
+  __ movq(RAX, XMM0);
+  __ movq(XMM0, RAX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(DoubleFPMoves, entry) {
+  typedef double (*DoubleFPMovesCode)();
+  EXPECT_FLOAT_EQ(1024.67, reinterpret_cast<DoubleFPMovesCode>(entry)(), 0.001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(PackedFPMoves, assembler) {
+  __ subq(RSP, Immediate(4 * kWordSize));
+  __ movq(RAX, Immediate(bit_cast<int64_t, double>(1.5)));
+  __ movq(Address(RSP, 0), RAX);
+  __ movq(RAX, Immediate(bit_cast<int64_t, double>(1024.67)));
+  __ movq(Address(RSP, kWordSize), RAX);
+  // Both halves are moved, the upper one is read back.
+  __ movups(XMM9, Address(RSP, 0));
+  __ movups(Address(RSP, 2 * kWordSize), XMM9);
+  __ movsd(XMM0, Address(RSP, 3 * kWordSize));
+  __ addq(RSP, Immediate(4 * kWordSize));
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedFPMoves, entry) {
+  typedef double (*PackedFPMovesCode)();
+  EXPECT_FLOAT_EQ(1024.67, reinterpret_cast<PackedFPMovesCode>(entry)(), 0.001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(DoubleFPOperations, assembler) {
+  __ movq(RAX, Immediate(bit_cast<int64_t, double>(12.3)));
+  __ movq(XMM0, RAX);
+  __ movsd(XMM12, XMM0);
+  __ movq(RAX, Immediate(bit_cast<int64_t, double>(3.4)));
+  __ movq(XMM1, RAX);
+  __ addsd(XMM0, XMM1);  // 15.7
+  __ mulsd(XMM0, XMM1);  // 53.38
+  __ subsd(XMM0, XMM1);  // 49.98
+  __ divsd(XMM0, XMM1);  // 14.7
+  __ pushq(RAX);
+  __ addsd(XMM12, Address(RSP, 0));  // 15.7
+  __ mulsd(XMM12, Address(RSP, 0));  // 53.38
+  __ subsd(XMM12, Address(RSP, 0));  // 49.98
+  __ divsd(XMM12, Address(RSP, 0));  // 14.7
+  __ popq(RAX);
+  __ subsd(XMM0, XMM12);  // 0.0
+  __ addsd(XMM0, XMM1);  // 3.4
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(DoubleFPOperations, entry) {
+  typedef double (*DoubleFPOperationsCode)();
+  double res = reinterpret_cast<DoubleFPOperationsCode>(entry)();
+  EXPECT_FLOAT_EQ(3.4, res, 0.000001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(IntToDoubleConversion, assembler) {
+  __ movq(RDX, Immediate(6));
+  __ cvtsi2sd(XMM8, RDX);
+  __ movq(R10, Immediate(-0x100000000LL));
+  __ cvtsi2sd(XMM0, R10);
+  __ addsd(XMM0, XMM8);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(IntToDoubleConversion, entry) {
+  typedef double (*IntToDoubleConversionCode)();
+  double res = reinterpret_cast<IntToDoubleConversionCode>(entry)();
+  EXPECT_FLOAT_EQ(-4294967290.0, res, 0.001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(IntToFloatConversion, assembler) {
+  __ movq(RDX, Immediate(6));
+  __ cvtsi2ss(XMM1, RDX);
+  __ movss(XMM0, XMM1);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(IntToFloatConversion, entry) {
+  typedef float (*IntToFloatConversionCode)();
+  float res = reinterpret_cast<IntToFloatConversionCode>(entry)();
+  EXPECT_FLOAT_EQ(6.0, res, 0.001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(FloatToIntConversionRound, assembler) {
+  __ cvtss2si(RAX, XMM0);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(FloatToIntConversionRound, entry) {
+  typedef int64_t (*FloatToIntConversionRoundCode)(float f);
+  int64_t res =
+      reinterpret_cast<FloatToIntConversionRoundCode>(entry)(12.3);
+  EXPECT_EQ(12, res);
+  res = reinterpret_cast<FloatToIntConversionRoundCode>(entry)(12.8);
+  EXPECT_EQ(13, res);
+}
+
+
+ASSEMBLER_TEST_GENERATE(FloatToIntConversionTrunc, assembler) {
+  __ cvttss2si(RAX, XMM0);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(FloatToIntConversionTrunc, entry) {
+  typedef int64_t (*FloatToIntConversionTruncCode)(float f);
+  int64_t res =
+      reinterpret_cast<FloatToIntConversionTruncCode>(entry)(12.3);
+  EXPECT_EQ(12, res);
+  res = reinterpret_cast<FloatToIntConversionTruncCode>(entry)(12.8);
+  EXPECT_EQ(12, res);
+}
+
+
+ASSEMBLER_TEST_GENERATE(FloatToDoubleConversion, assembler) {
+  __ movq(RAX, Immediate(bit_cast<int32_t, float>(12.3f)));
+  __ movd(XMM9, RAX);
+  __ cvtss2sd(XMM0, XMM9);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(FloatToDoubleConversion, entry) {
+  typedef double (*FloatToDoubleConversionCode)();
+  double res = reinterpret_cast<FloatToDoubleConversionCode>(entry)();
+  EXPECT_FLOAT_EQ(12.3, res, 0.001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(DoubleToFloatConversion, assembler) {
+  __ movq(RAX, Immediate(bit_cast<int64_t, double>(12.3)));
+  __ movq(XMM1, RAX);
+  __ cvtsd2ss(XMM0, XMM1);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(DoubleToFloatConversion, entry) {
+  typedef float (*DoubleToFloatConversionCode)();
+  float res = reinterpret_cast<DoubleToFloatConversionCode>(entry)();
+  EXPECT_FLOAT_EQ(12.3f, res, 0.001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(DoubleToIntConversionRound, assembler) {
+  __ cvtsd2si(RAX, XMM0);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(DoubleToIntConversionRound, entry) {
+  typedef int64_t (*DoubleToIntConversionRoundCode)(double d);
+  int64_t res =
+      reinterpret_cast<DoubleToIntConversionRoundCode>(entry)(12.3);
+  EXPECT_EQ(12, res);
+  res = reinterpret_cast<DoubleToIntConversionRoundCode>(entry)(12.8);
+  EXPECT_EQ(13, res);
+}
+
+
+ASSEMBLER_TEST_GENERATE(DoubleToIntConversionTrunc, assembler) {
+  __ cvttsd2si(RAX, XMM0);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(DoubleToIntConversionTrunc, entry) {
+  typedef int64_t (*DoubleToIntConversionTruncCode)(double d);
+  int64_t res =
+      reinterpret_cast<DoubleToIntConversionTruncCode>(entry)(12.3);
+  EXPECT_EQ(12, res);
+  res = reinterpret_cast<DoubleToIntConversionTruncCode>(entry)(-12.8);
+  EXPECT_EQ(-12, res);
+  res = reinterpret_cast<DoubleToIntConversionTruncCode>(entry)(1e12);
+  EXPECT_EQ(1000000000000LL, res);
+}
+
+
+ASSEMBLER_TEST_GENERATE(DoubleCompare, assembler) {
+  // Returns 1 if the first argument is greater than the second, 0 if they
+  // are equal, -1 otherwise and 2 if they are unordered.
+  Label is_nan, is_equal, is_less;
+  __ comisd(XMM0, XMM1);
+  __ j(PARITY_EVEN, &is_nan, Assembler::kNearJump);
+  __ j(EQUAL, &is_equal, Assembler::kNearJump);
+  __ j(BELOW, &is_less, Assembler::kNearJump);
+  __ movq(RAX, Immediate(1));
+  __ ret();
+  __ Bind(&is_equal);
+  __ movq(RAX, Immediate(0));
+  __ ret();
+  __ Bind(&is_less);
+  __ movq(RAX, Immediate(-1));
+  __ ret();
+  __ Bind(&is_nan);
+  __ movq(RAX, Immediate(2));
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(DoubleCompare, entry) {
+  typedef int64_t (*DoubleCompareCode)(double a, double b);
+  DoubleCompareCode code = reinterpret_cast<DoubleCompareCode>(entry);
+  EXPECT_EQ(1, code(2.0, 1.0));
+  EXPECT_EQ(0, code(2.0, 2.0));
+  EXPECT_EQ(-1, code(1.0, 2.0));
+  const double kNaN = bit_cast<double, int64_t>(0x7FF8000000000000LL);
+  EXPECT_EQ(2, code(kNaN, 2.0));
+}
+
+
+ASSEMBLER_TEST_GENERATE(FloatCompare, assembler) {
+  Label is_less;
+  __ comiss(XMM0, XMM1);
+  __ j(BELOW, &is_less, Assembler::kNearJump);
+  __ movq(RAX, Immediate(0));
+  __ ret();
+  __ Bind(&is_less);
+  __ movq(RAX, Immediate(1));
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(FloatCompare, entry) {
+  typedef int64_t (*FloatCompareCode)(float a, float b);
+  FloatCompareCode code = reinterpret_cast<FloatCompareCode>(entry);
+  EXPECT_EQ(1, code(1.0f, 2.0f));
+  EXPECT_EQ(0, code(2.0f, 1.0f));
+}
+
+
+ASSEMBLER_TEST_GENERATE(SquareRootFloat, assembler) {
+  __ sqrtss(XMM1, XMM0);
+  __ movss(XMM0, XMM1);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(SquareRootFloat, entry) {
+  typedef float (*SquareRootFloatCode)(float f);
+  float res = reinterpret_cast<SquareRootFloatCode>(entry)(64.0f);
+  EXPECT_FLOAT_EQ(8.0f, res, 0.0001f);
+}
+
+
+ASSEMBLER_TEST_GENERATE(SquareRootDouble, assembler) {
+  __ sqrtsd(XMM10, XMM0);
+  __ movsd(XMM0, XMM10);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(SquareRootDouble, entry) {
+  typedef double (*SquareRootDoubleCode)(double d);
+  double res = reinterpret_cast<SquareRootDoubleCode>(entry)(1024.0);
+  EXPECT_FLOAT_EQ(32.0, res, 0.0001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(FloatNegate, assembler) {
+  __ FloatNegate(XMM0);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(FloatNegate, entry) {
+  typedef float (*FloatNegateCode)(float f);
+  float res = reinterpret_cast<FloatNegateCode>(entry)(12.3f);
+  EXPECT_FLOAT_EQ(-12.3f, res, 0.001f);
+}
+
+
+ASSEMBLER_TEST_GENERATE(DoubleNegate, assembler) {
+  __ movsd(XMM11, XMM0);
+  __ DoubleNegate(XMM11);
+  __ movsd(XMM0, XMM11);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(DoubleNegate, entry) {
+  typedef double (*DoubleNegateCode)(double d);
+  double res = reinterpret_cast<DoubleNegateCode>(entry)(12.3);
+  EXPECT_FLOAT_EQ(-12.3, res, 0.001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(DoubleAbs, assembler) {
+  __ DoubleAbs(XMM0);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(DoubleAbs, entry) {
+  typedef double (*DoubleAbsCode)(double d);
+  double val = -12.45;
+  double res = reinterpret_cast<DoubleAbsCode>(entry)(val);
+  EXPECT_FLOAT_EQ(-val, res, 0.001);
+  val = 12.45;
+  res = reinterpret_cast<DoubleAbsCode>(entry)(val);
+  EXPECT_FLOAT_EQ(val, res, 0.001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(XorpdZeroing, assembler) {
+  __ xorpd(XMM0, XMM0);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(XorpdZeroing, entry) {
+  typedef double (*XorpdZeroingCode)(double d);
+  double res = reinterpret_cast<XorpdZeroingCode>(entry)(12.56e3);
+  EXPECT_FLOAT_EQ(0.0, res, 0.0001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(LongAddSub, assembler) {
+  // Adds and subtracts the 128-bit values in RDI:RSI and RDX:RCX and returns
+  // the high word of (a + b) - b + b.
+  __ movq(RAX, RSI);
+  __ movq(R8, RDI);
+  __ addq(RAX, RCX);
+  __ adcq(R8, RDX);
+  __ subq(RAX, RCX);
+  __ sbbq(R8, RDX);
+  __ addq(RAX, RCX);
+  __ adcq(R8, RDX);
+  __ movq(RAX, R8);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(LongAddSub, entry) {
+  typedef int64_t (*LongAddSubCode)(int64_t ah, uint64_t al,
+                                     int64_t bh, uint64_t bl);
+  LongAddSubCode code = reinterpret_cast<LongAddSubCode>(entry);
+  // The carry out of the low words is added to the high word.
+  EXPECT_EQ(3, code(1, 0xFFFFFFFFFFFFFFFFULL, 1, 1));
+  EXPECT_EQ(2, code(1, 1, 1, 1));
+}
+
+
+ASSEMBLER_TEST_GENERATE(ConditionalMovesSign, assembler) {
+  __ xorq(RAX, RAX);
+  __ movq(R8, Immediate(1));
+  __ movq(R9, Immediate(-1));
+  __ testq(RDI, RDI);
+  __ cmovsq(RAX, R9);  // return -1.
+  __ testq(RDI, RDI);
+  __ cmovnsq(RAX, R8);  // return 1.
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(ConditionalMovesSign, entry) {
+  typedef int64_t (*ConditionalMovesSignCode)(int64_t i);
+  int64_t res = reinterpret_cast<ConditionalMovesSignCode>(entry)(785);
+  EXPECT_EQ(1, res);
+  res = reinterpret_cast<ConditionalMovesSignCode>(entry)(-12);
+  EXPECT_EQ(-1, res);
+}
+
+
+ASSEMBLER_TEST_GENERATE(TestLoadDoubleConstant, assembler) {
+  __ LoadDoubleConstant(XMM3, -12.34);
+  __ movsd(XMM0, XMM3);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(TestLoadDoubleConstant, entry) {
+  typedef double (*TestLoadDoubleConstantCode)();
+  double res = reinterpret_cast<TestLoadDoubleConstantCode>(entry)();
+  EXPECT_FLOAT_EQ(-12.34, res, 0.0001);
+}
+
+
+ASSEMBLER_TEST_GENERATE(TestObjectCompare, assembler) {
+  ObjectStore* object_store = Isolate::Current()->object_store();
+  const Object& obj = Object::ZoneHandle(object_store->smi_class());
+  Label fail;
+  __ LoadObject(RAX, obj);
+  __ CompareObject(RAX, obj);
+  __ j(NOT_EQUAL, &fail);
+  __ LoadObject(R10, obj);
+  __ CompareObject(R10, obj);
+  __ j(NOT_EQUAL, &fail);
+  __ PushObject(obj);
+  __ popq(RCX);
+  __ cmpq(RCX, RAX);
+  __ j(NOT_EQUAL, &fail);
+  __ movq(RAX, Immediate(1));  // OK
+  __ ret();
+  __ Bind(&fail);
+  __ movq(RAX, Immediate(0));  // Fail.
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(TestObjectCompare, entry) {
+  typedef bool (*TestObjectCompare)();
+  bool res = reinterpret_cast<TestObjectCompare>(entry)();
+  EXPECT_EQ(true, res);
+}
+
+}  // namespace dart
+
+#endif  // defined TARGET_ARCH_X64
@@ -0,0 +1,26 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_ATOMIC_H_
+#define VM_ATOMIC_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+class AtomicOperations : public AllStatic {
+ public:
+  // Atomically compare the word at 'ptr' with 'old_value' and replace it with
+  // 'new_value' if they are equal. Returns the value found at 'ptr', the swap
+  // succeeded if it equals 'old_value'. Acts as a full memory barrier.
+  static uword CompareAndSwapWord(uword* ptr, uword old_value, uword new_value);
+
+  // Atomically add 'value' to the word at 'ptr' and return the new value.
+  static intptr_t FetchAndIncrementBy(intptr_t* ptr, intptr_t value);
+};
+
+}  // namespace dart
+
+#endif  // VM_ATOMIC_H_
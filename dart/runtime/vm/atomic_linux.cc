@@ -0,0 +1,21 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/atomic.h"
+
+namespace dart {
+
+uword AtomicOperations::CompareAndSwapWord(uword* ptr,
+                                           uword old_value,
+                                           uword new_value) {
+  return __sync_val_compare_and_swap(ptr, old_value, new_value);
+}
+
+
+intptr_t AtomicOperations::FetchAndIncrementBy(intptr_t* ptr,
+                                               intptr_t value) {
+  return __sync_add_and_fetch(ptr, value);
+}
+
+}  // namespace dart
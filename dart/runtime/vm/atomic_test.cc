@@ -0,0 +1,30 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/assert.h"
+#include "vm/atomic.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+UNIT_TEST_CASE(CompareAndSwapWord) {
+  uword value = 42;
+  EXPECT_EQ(static_cast<uword>(42),
+            AtomicOperations::CompareAndSwapWord(&value, 42, 7));
+  EXPECT_EQ(static_cast<uword>(7), value);
+  // A failing swap leaves the value untouched.
+  EXPECT_EQ(static_cast<uword>(7),
+            AtomicOperations::CompareAndSwapWord(&value, 42, 13));
+  EXPECT_EQ(static_cast<uword>(7), value);
+}
+
+
+UNIT_TEST_CASE(FetchAndIncrementBy) {
+  intptr_t value = 40;
+  EXPECT_EQ(42, AtomicOperations::FetchAndIncrementBy(&value, 2));
+  EXPECT_EQ(42, value);
+  EXPECT_EQ(-8, AtomicOperations::FetchAndIncrementBy(&value, -50));
+}
+
+}  // namespace dart
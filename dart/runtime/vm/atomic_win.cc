@@ -0,0 +1,34 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include <windows.h>
+
+#include "vm/atomic.h"
+
+namespace dart {
+
+uword AtomicOperations::CompareAndSwapWord(uword* ptr,
+                                           uword old_value,
+                                           uword new_value) {
+  return reinterpret_cast<uword>(InterlockedCompareExchangePointer(
+      reinterpret_cast<PVOID*>(ptr),
+      reinterpret_cast<PVOID>(new_value),
+      reinterpret_cast<PVOID>(old_value)));
+}
+
+
+intptr_t AtomicOperations::FetchAndIncrementBy(intptr_t* ptr,
+                                               intptr_t value) {
+#if defined(TARGET_ARCH_X64)
+  return static_cast<intptr_t>(InterlockedExchangeAdd64(
+      reinterpret_cast<LONGLONG*>(ptr),
+      static_cast<LONGLONG>(value))) + value;
+#else
+  return static_cast<intptr_t>(InterlockedExchangeAdd(
+      reinterpret_cast<LONG*>(ptr),
+      static_cast<LONG>(value))) + value;
+#endif
+}
+
+}  // namespace dart
@@ -238,7 +238,9 @@ void ClassFinalizer::VerifyBootstrapClasses() {
   if (FLAG_trace_class_finalization) {
     OS::Print("VerifyBootstrapClasses END.\n");
   }
-  Isolate::Current()->heap()->Verify();
+  Heap* heap = Isolate::Current()->heap();
+  heap->CompleteSweeping();
+  heap->Verify();
 }
 
 
@@ -24,6 +24,7 @@ DEFINE_FLAG(bool, trace_deopt, false, "Trace deoptimization");
 DEFINE_FLAG(bool, trace_ic, false, "trace IC handling");
 DEFINE_FLAG(bool, trace_patching, false, "Trace patching of code.");
 DEFINE_FLAG(bool, trace_runtime_calls, false, "Trace runtime calls.");
+DECLARE_FLAG(bool, deferred_compilation);
 DECLARE_FLAG(int, deoptimization_counter_threshold);
 
 
@@ -149,7 +150,16 @@ DEFINE_RUNTIME_ENTRY(AllocateArray, 3) {
 DEFINE_RUNTIME_ENTRY(AllocateObject, 3) {
   ASSERT(arguments.Count() == kAllocateObjectRuntimeEntry.argument_count());
   const Class& cls = Class::CheckedHandle(arguments.At(0));
-  const Instance& instance = Instance::Handle(Instance::New(cls));
+  Heap::Space space = Heap::kNew;
+  if (cls.is_pretenured()) {
+    cls.CountPretenuredAllocation();
+    space = Heap::kOld;
+  }
+  const Instance& instance = Instance::Handle(Instance::New(cls, space));
+  if (cls.is_pretenured() && !cls.HasTypeArguments()) {
+    // The allocation stub ran out of its old space allocation buffer.
+    Isolate::Current()->heap()->RefillOldAllocationBuffer();
+  }
   arguments.SetReturn(instance);
   if (!cls.HasTypeArguments()) {
     // No type arguments required for a non-parameterized type.
@@ -784,6 +794,15 @@ DEFINE_RUNTIME_ENTRY(OptimizeInvokedFunction, 1) {
   }
   if (function.is_optimizable()) {
     ASSERT(!Code::Handle(function.code()).is_optimized());
+    // Keep running the unoptimized code until the run loop compiles the
+    // function on the mutator. A function getting hot again while it is
+    // queued, e.g. in a long running computation, is compiled synchronously
+    // here.
+    if (FLAG_deferred_compilation &&
+        Compiler::QueueOptimizedFunction(function)) {
+      function.set_invocation_counter(0);
+      return;
+    }
     const Code& unoptimized_code = Code::Handle(function.code());
     // Compilation patches the entry of unoptimized code.
     Compiler::CompileOptimizedFunction(function);
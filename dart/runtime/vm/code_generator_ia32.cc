@@ -224,6 +224,84 @@ class CodeGenerator::HandlerList : public ZoneAllocated {
 };
 
 
+// Tracks which fixed frame slots (copied parameters and locals) hold objects
+// while code is generated, and records the state at the call sites. A map is
+// only recorded where the state differs from the previous map, which then
+// also describes the following call sites.
+class CodeGenerator::StackmapList : public ZoneAllocated {
+ public:
+  StackmapList() : slots_(), pc_offsets_(), bits_() {
+  }
+  ~StackmapList() { }
+
+  intptr_t Length() const {
+    return pc_offsets_.length();
+  }
+
+  intptr_t SlotCount() const {
+    return slots_.length();
+  }
+
+  // Start describing a frame of 'count' slots, none of which holds an object.
+  void SetSlotCount(intptr_t count) {
+    ASSERT(SlotCount() == 0);
+    for (intptr_t i = 0; i < count; i++) {
+      slots_.Add(false);
+    }
+  }
+
+  // Slot 'index' is at fp[-1 - index].
+  void SetSlot(intptr_t index, bool is_object) {
+    slots_[index] = is_object;
+  }
+
+  void AddStackmap(intptr_t pc_offset) {
+    if ((Length() > 0) && !HasChanged()) {
+      return;
+    }
+    pc_offsets_.Add(pc_offset);
+    for (intptr_t i = 0; i < SlotCount(); i++) {
+      bits_.Add(slots_[i]);
+    }
+  }
+
+  // Whether the slots changed since the last recorded map.
+  bool HasChanged() const {
+    const intptr_t last = (Length() - 1) * SlotCount();
+    for (intptr_t i = 0; i < SlotCount(); i++) {
+      if (bits_[last + i] != slots_[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  RawArray* FinalizeStackmaps(uword entry_point) {
+    intptr_t num_maps = Length();
+    if (num_maps == 0) {
+      return Array::null();
+    }
+    const Array& maps = Array::Handle(Array::New(num_maps, Heap::kOld));
+    Stackmap& map = Stackmap::Handle();
+    intptr_t slot_count = SlotCount();
+    for (intptr_t i = 0; i < num_maps; i++) {
+      map = Stackmap::New(entry_point + pc_offsets_[i], slot_count);
+      for (intptr_t j = 0; j < slot_count; j++) {
+        map.SetIsObject(j, bits_[(i * slot_count) + j]);
+      }
+      maps.SetAt(i, map);
+    }
+    return maps.raw();
+  }
+
+ private:
+  GrowableArray<bool> slots_;  // Current state of the slots.
+  GrowableArray<intptr_t> pc_offsets_;
+  GrowableArray<bool> bits_;  // SlotCount() entries per recorded pc.
+  DISALLOW_COPY_AND_ASSIGN(StackmapList);
+};
+
+
 CodeGenerator::CodeGenerator(Assembler* assembler,
                              const ParsedFunction& parsed_function)
     : assembler_(assembler),
@@ -232,11 +310,13 @@ CodeGenerator::CodeGenerator(Assembler* assembler,
       state_(NULL),
       pc_descriptors_list_(NULL),
       exception_handlers_list_(NULL),
+      stackmaps_list_(NULL),
       try_index_(CatchClauseNode::kInvalidTryIndex) {
   ASSERT(assembler_ != NULL);
   ASSERT(parsed_function.node_sequence() != NULL);
   pc_descriptors_list_ = new CodeGenerator::DescriptorList();
   exception_handlers_list_ = new CodeGenerator::HandlerList();
+  stackmaps_list_ = new CodeGenerator::StackmapList();
 }
 
 
@@ -407,6 +487,14 @@ void CodeGenerator::FinalizeExceptionHandlers(const Code& code) {
 }
 
 
+void CodeGenerator::FinalizeStackmaps(const Code& code) {
+  ASSERT(stackmaps_list_ != NULL);
+  const Array& maps = Array::Handle(
+      stackmaps_list_->FinalizeStackmaps(code.EntryPoint()));
+  code.set_stackmaps(maps);
+}
+
+
 void CodeGenerator::GenerateLoadVariable(Register dst,
                                          const LocalVariable& variable) {
   if (variable.is_captured()) {
@@ -439,8 +527,10 @@ void CodeGenerator::GenerateStoreVariable(const LocalVariable& variable,
       __ movl(scratch, FieldAddress(base, Context::parent_offset()));
       base = scratch;
     }
-    __ movl(FieldAddress(base, Context::variable_offset(variable.index())),
-            src);
+    __ StoreIntoObject(
+        base,
+        FieldAddress(base, Context::variable_offset(variable.index())),
+        src);
   } else {
     // The variable lives in the current stack frame.
     __ movl(Address(EBP, variable.index() * kWordSize), src);
@@ -548,6 +638,9 @@ void CodeGenerator::GenerateEntryCode() {
   // because pushes of initial values may be more effective than moves.
   set_locals_space_size((num_copied_params + num_locals) * kWordSize);
   __ EnterFrame(locals_space_size());
+  // The slots hold no objects until the parameters are copied and the locals
+  // are initialized below.
+  stackmaps_list_->SetSlotCount(num_copied_params + num_locals);
 
   // We check the number of passed arguments when we have to copy them due to
   // the presence of optional named parameters.
@@ -756,6 +849,9 @@ void CodeGenerator::GenerateEntryCode() {
     }
     __ movl(Address(EBP, index * kWordSize), EAX);
   }
+  for (intptr_t i = 0; i < stackmaps_list_->SlotCount(); i++) {
+    stackmaps_list_->SetSlot(i, true);
+  }
 }
 
 
@@ -908,7 +1004,7 @@ void CodeGenerator::VisitSequenceNode(SequenceNode* node_sequence) {
     GenerateCall(node_sequence->token_index(), &label);
 
     // Chain the new context in EAX to its parent in CTX.
-    __ movl(FieldAddress(EAX, Context::parent_offset()), CTX);
+    __ StoreIntoObject(EAX, FieldAddress(EAX, Context::parent_offset()), CTX);
     // Set new context as current context.
     __ movl(CTX, EAX);
     state()->set_context_level(scope->context_level());
@@ -2091,7 +2187,7 @@ void CodeGenerator::VisitStringConcatNode(StringConcatNode* node) {
   __ LoadObject(ECX, interpol_func);
   __ LoadObject(EDX, ArgumentsDescriptor(interpol_arg->length(),
                                          interpol_arg->names()));
-  GenerateCall(node->token_index(), &StubCode::CallStaticFunctionLabel());
+  GenerateStaticCall(node->token_index());
   __ addl(ESP, Immediate(interpol_arg->length() * kWordSize));
   // Result is in EAX.
   if (IsResultNeeded(node)) {
@@ -2127,7 +2223,7 @@ void CodeGenerator::VisitStaticCallNode(StaticCallNode* node) {
   __ LoadObject(ECX, node->function());
   __ LoadObject(EDX, ArgumentsDescriptor(node->arguments()->length(),
                                          node->arguments()->names()));
-  GenerateCall(node->token_index(), &StubCode::CallStaticFunctionLabel());
+  GenerateStaticCall(node->token_index());
   __ addl(ESP, Immediate(node->arguments()->length() * kWordSize));
   // Result is in EAX.
   if (IsResultNeeded(node)) {
@@ -2293,7 +2389,7 @@ void CodeGenerator::VisitConstructorCallNode(ConstructorCallNode* node) {
     __ LoadObject(ECX, node->constructor());
     __ LoadObject(EDX, ArgumentsDescriptor(num_args,
                                            node->arguments()->names()));
-    GenerateCall(node->token_index(), &StubCode::CallStaticFunctionLabel());
+    GenerateStaticCall(node->token_index());
     // Factory constructor returns object in EAX.
     __ addl(ESP, Immediate(num_args * kWordSize));
     if (IsResultNeeded(node)) {
@@ -2324,7 +2420,7 @@ void CodeGenerator::VisitConstructorCallNode(ConstructorCallNode* node) {
   int num_args = node->arguments()->length() + 1;  // +1 to include receiver.
   __ LoadObject(ECX, node->constructor());
   __ LoadObject(EDX, ArgumentsDescriptor(num_args, node->arguments()->names()));
-  GenerateCall(node->token_index(), &StubCode::CallStaticFunctionLabel());
+  GenerateStaticCall(node->token_index());
   // Constructors do not return any value.
 
   // Pop out all the other arguments on the stack.
@@ -2412,7 +2508,7 @@ void CodeGenerator::GenerateStaticGetterCall(intptr_t token_index,
   const int kNumberOfArguments = 0;
   const Array& kNoArgumentNames = Array::Handle();
   __ LoadObject(EDX, ArgumentsDescriptor(kNumberOfArguments, kNoArgumentNames));
-  GenerateCall(token_index, &StubCode::CallStaticFunctionLabel());
+  GenerateStaticCall(token_index);
   // No arguments were pushed, hence nothing to pop.
 }
 
@@ -2440,7 +2536,7 @@ void CodeGenerator::GenerateStaticSetterCall(intptr_t token_index,
   const int kNumberOfArguments = 1;  // value.
   const Array& kNoArgumentNames = Array::Handle();
   __ LoadObject(EDX, ArgumentsDescriptor(kNumberOfArguments, kNoArgumentNames));
-  GenerateCall(token_index, &StubCode::CallStaticFunctionLabel());
+  GenerateStaticCall(token_index);
   __ addl(ESP, Immediate(kNumberOfArguments * kWordSize));
 }
 
@@ -2605,6 +2701,14 @@ void CodeGenerator::GenerateCall(intptr_t token_index,
 }
 
 
+void CodeGenerator::GenerateStaticCall(intptr_t token_index) {
+  __ call(&StubCode::CallStaticFunctionLabel());
+  AddCurrentDescriptor(PcDescriptors::kFuncCall,
+                       AstNode::kInvalidId,
+                       token_index);
+}
+
+
 void CodeGenerator::GenerateCallRuntime(intptr_t token_index,
                                         const RuntimeEntry& entry) {
   __ CallRuntimeFromDart(entry);
@@ -2628,6 +2732,14 @@ void CodeGenerator::AddCurrentDescriptor(PcDescriptors::Kind kind,
                                       node_id,
                                       token_index,
                                       state()->try_index());
+  // Record a stackmap at the return address of calls made from within the
+  // frame. Calls made before the frame is entered have no map and their
+  // frame is visited conservatively.
+  if ((kind != PcDescriptors::kDeopt) &&
+      (kind != PcDescriptors::kPatchCode) &&
+      (locals_space_size() >= 0)) {
+    stackmaps_list_->AddStackmap(assembler_->CodeSize());
+  }
 }
 
 
@@ -49,6 +49,9 @@ NODE_LIST(DEFINE_VISITOR_FUNCTION)
   // Add pc descriptors to code.
   void FinalizePcDescriptors(const Code& code);
 
+  // Add stackmaps of the call sites to code.
+  void FinalizeStackmaps(const Code& code);
+
   // Allocate and return an arguments descriptor.
   // Let 'num_names' be the length of 'optional_arguments_names'.
   // Treat the first 'num_arguments - num_names' arguments as positional and
@@ -66,11 +69,13 @@ NODE_LIST(DEFINE_VISITOR_FUNCTION)
  private:
   // TODO(srdjan): Remove the friendship once the two compilers are properly
   // structured.
+  friend class FlowGraphCompiler;
   friend class OptimizingCodeGenerator;
 
   // Forward Declarations.
   class DescriptorList;
   class HandlerList;
+  class StackmapList;
 
   // Return true if intrinsification was completed and no other code
   // needs to be generated.
@@ -130,6 +135,9 @@ NODE_LIST(DEFINE_VISITOR_FUNCTION)
   bool IsResultNeeded(AstNode* node) const;
 
   void GenerateCall(intptr_t token_index, const ExternalLabel* ext_label);
+  // Static call of the function in ECX with the arguments descriptor in EDX.
+  // The call target is patched once the function is compiled.
+  void GenerateStaticCall(intptr_t token_index);
   void GenerateCallRuntime(intptr_t token_index, const RuntimeEntry& entry);
 
   void GenerateInlinedFinallyBlocks(SourceLabel* label);
@@ -149,6 +157,7 @@ NODE_LIST(DEFINE_VISITOR_FUNCTION)
   CodeGeneratorState* state_;
   DescriptorList* pc_descriptors_list_;
   HandlerList* exception_handlers_list_;
+  StackmapList* stackmaps_list_;
   int try_index_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(CodeGenerator);
@@ -4,10 +4,12 @@
 
 #include "vm/code_index_table.h"
 
+#include "vm/code_patcher.h"
 #include "vm/isolate.h"
 #include "vm/object.h"
 #include "vm/pages.h"
 #include "vm/raw_object.h"
+#include "vm/stub_code.h"
 #include "vm/visitor.h"
 
 namespace dart {
@@ -18,7 +20,9 @@ CodeIndexTable::CodeIndexTable() : code_pages_(NULL),
                                    largecode_list_(Array::null()) {
   code_pages_ = new IndexArray<CodePageInfo>(kInitialSize);
   ASSERT(code_pages_ != NULL);
-  code_lists_ = Array::New(kInitialSize);
+  // The code lists are allocated in old space, as new space objects are
+  // treated as roots by the marker and would keep all code alive.
+  code_lists_ = Array::New(kInitialSize, Heap::kOld);
 }
 
 
@@ -74,11 +78,10 @@ RawCode* CodeIndexTable::LookupCode(uword pc) const {
     return LookupLargeCode(pc);
   }
   IndexArray<PcRange>* pc_ranges = code_pages_->At(page_index).pc_ranges;
-  const Array& codes_list = Array::Handle(code_lists_);
-  ASSERT(!codes_list.IsNull());
-  ASSERT(page_index < (codes_list.Length() - 1));
-  Array& codes = Array::Handle();
-  codes ^= codes_list.At(page_index);
+  ASSERT(code_lists_ != Array::null());
+  ASSERT(page_index < (Smi::Value(code_lists_->ptr()->length_) - 1));
+  RawArray* codes =
+      reinterpret_cast<RawArray*>(code_lists_->ptr()->data()[page_index]);
   return LookupCodeFromList(pc_ranges, codes, pc, kIsSorted);
 }
 
@@ -90,6 +93,100 @@ void CodeIndexTable::VisitObjectPointers(ObjectPointerVisitor* visitor) {
 }
 
 
+void CodeIndexTable::VisitCodeLists(ObjectVisitor* visitor) {
+  ASSERT(visitor != NULL);
+  visitor->VisitObject(code_lists_);
+  RawObject** codes_list = code_lists_->ptr()->data();
+  for (intptr_t i = 0; i < code_pages_->length(); i++) {
+    visitor->VisitObject(codes_list[i]);
+  }
+  if (largecode_list_ != Array::null()) {
+    visitor->VisitObject(largecode_list_);
+  }
+}
+
+
+static bool IsMarkedCode(uword entrypoint) {
+  RawObject* raw_instructions = Instructions::FromEntryPoint(entrypoint);
+  return HeapPage::Of(raw_instructions)->IsMarked(raw_instructions);
+}
+
+
+intptr_t CodeIndexTable::RemoveUnmarkedFromList(
+    IndexArray<PcRange>* pc_ranges,
+    RawArray* codes) {
+  RawObject** data = codes->ptr()->data();
+  intptr_t length = 0;
+  for (intptr_t i = 0; i < pc_ranges->length(); i++) {
+    if (IsMarkedCode(pc_ranges->At(i).entrypoint)) {
+      pc_ranges->At(length) = pc_ranges->At(i);
+      data[length] = data[i];
+      length++;
+    }
+  }
+  intptr_t removed = pc_ranges->length() - length;
+  for (intptr_t i = length; i < pc_ranges->length(); i++) {
+    data[i] = Object::null();
+  }
+  pc_ranges->Truncate(length);
+  return removed;
+}
+
+
+intptr_t CodeIndexTable::RemoveUnmarkedCode() {
+  intptr_t removed = 0;
+  RawObject** codes_list = code_lists_->ptr()->data();
+  for (intptr_t i = 0; i < code_pages_->length(); i++) {
+    removed += RemoveUnmarkedFromList(code_pages_->At(i).pc_ranges,
+                                      reinterpret_cast<RawArray*>(
+                                          codes_list[i]));
+  }
+  if (largecode_pc_ranges_ != NULL) {
+    removed += RemoveUnmarkedFromList(largecode_pc_ranges_, largecode_list_);
+  }
+  return removed;
+}
+
+
+void CodeIndexTable::RedirectCallsInList(const Array& codes,
+                                         intptr_t length) const {
+  const uword stub_entry = StubCode::CallStaticFunctionEntryPoint();
+  Code& code = Code::Handle();
+  PcDescriptors& descriptors = PcDescriptors::Handle();
+  Function& target_function = Function::Handle();
+  for (intptr_t i = 0; i < length; i++) {
+    code ^= codes.At(i);
+    descriptors = code.pc_descriptors();
+    for (intptr_t j = 0; j < descriptors.Length(); j++) {
+      if (descriptors.DescriptorKind(j) != PcDescriptors::kFuncCall) {
+        continue;
+      }
+      uword call_pc = descriptors.PC(j);
+      uword target = 0;
+      CodePatcher::GetStaticCallAt(call_pc, &target_function, &target);
+      if ((target != stub_entry) && (LookupCode(target) == Code::null())) {
+        CodePatcher::PatchStaticCallAt(call_pc, stub_entry);
+      }
+    }
+  }
+}
+
+
+void CodeIndexTable::RedirectCallsToRemovedCode() {
+  HANDLESCOPE();
+  const Array& codes_list = Array::Handle(code_lists_);
+  Array& codes = Array::Handle();
+  for (intptr_t i = 0; i < code_pages_->length(); i++) {
+    codes ^= codes_list.At(i);
+    RedirectCallsInList(codes, code_pages_->At(i).pc_ranges->length());
+  }
+  if (largecode_pc_ranges_ != NULL) {
+    codes = largecode_list_;
+    RedirectCallsInList(codes, largecode_pc_ranges_->length());
+  }
+}
+
+
 void CodeIndexTable::Init(Isolate* isolate) {
   ASSERT(isolate->code_index_table() == NULL);
   CodeIndexTable* code_index_table = new CodeIndexTable();
@@ -99,6 +196,14 @@ void CodeIndexTable::Init(Isolate* isolate) {
 
 int CodeIndexTable::AddPageIndex(uword page_start) {
   ASSERT(FindPageIndex(page_start) == -1);
+  // Reuse the index of a page without entries, its page may have been
+  // released when the code space was collected.
+  for (int i = 0; i < code_pages_->length(); i++) {
+    if (code_pages_->At(i).pc_ranges->length() == 0) {
+      code_pages_->At(i).page_start = page_start;
+      return i;
+    }
+  }
   int page_index = code_pages_->length();
   CodePageInfo code;
   code.page_start = page_start;
@@ -107,7 +212,7 @@ int CodeIndexTable::AddPageIndex(uword page_start) {
   code_pages_->Add(code);  // code gets added at 'index'.
   const Array& codes_list = Array::Handle(code_lists_);
   ASSERT(!codes_list.IsNull());
-  const Array& codes = Array::Handle(Array::New(kInitialSize));
+  const Array& codes = Array::Handle(Array::New(kInitialSize, Heap::kOld));
   codes_list.SetAt(page_index, codes);
   if (code_pages_->IsFull()) {
     // Grow the index table.
@@ -146,12 +251,12 @@ void CodeIndexTable::AddFunctionToList(int page_index,
   ASSERT(!codes.IsNull());
   // Asserting with an unsorted search, to ensure addition of pc was done right.
   ASSERT(FindPcIndex(*pc_ranges, entrypoint, kIsNotSorted) == -1);
-  AddFuncHelper(pc_ranges, codes, entrypoint, size, func);
+  AddFuncHelper(pc_ranges, codes, entrypoint, size, func, kIsSorted);
   if (pc_ranges->IsFull()) {
     // Grow the pc ranges table and the associated functions table.
     int new_size = pc_ranges->length() + kInitialSize;
     pc_ranges->Resize(new_size);
-    codes = Array::Grow(codes, new_size);
+    codes = Array::Grow(codes, new_size, Heap::kOld);
     codes_list.SetAt(page_index, codes);
   }
 }
@@ -164,17 +269,22 @@ void CodeIndexTable::AddLargeFunction(uword entrypoint,
     // No large functions seen so far.
     largecode_pc_ranges_ = new IndexArray<PcRange>(kInitialSize);
     ASSERT(largecode_pc_ranges_ != NULL);
-    largecode_list_ = Array::New(kInitialSize);
+    largecode_list_ = Array::New(kInitialSize, Heap::kOld);
   }
   ASSERT(FindPcIndex(*largecode_pc_ranges_, entrypoint, kIsNotSorted) == -1);
   const Array& largecode_list = Array::Handle(largecode_list_);
   ASSERT(!largecode_list.IsNull());
-  AddFuncHelper(largecode_pc_ranges_, largecode_list, entrypoint, size, func);
+  AddFuncHelper(largecode_pc_ranges_,
+                largecode_list,
+                entrypoint,
+                size,
+                func,
+                kIsNotSorted);
   if (largecode_pc_ranges_->IsFull()) {
     // Grow largecode_pc_ranges_ and largecode_list_.
     int new_size = largecode_pc_ranges_->length() + kInitialSize;
     largecode_pc_ranges_->Resize(new_size);
-    largecode_list_ = Array::Grow(largecode_list, new_size);
+    largecode_list_ = Array::Grow(largecode_list, new_size, Heap::kOld);
   }
 }
 
@@ -183,20 +293,27 @@ void CodeIndexTable::AddFuncHelper(IndexArray<PcRange>* pc_ranges,
                                    const Array& codes,
                                    uword entrypoint,
                                    intptr_t size,
-                                   const Function& func) {
+                                   const Function& func,
+                                   bool sorted) {
   PcRange pc_range;
   pc_range.entrypoint = entrypoint;
   pc_range.size = size;
-  intptr_t next_slot = pc_ranges->length();
-  pc_ranges->Add(pc_range);  // pc_range gets added at 'next_slot'.
-  codes.SetAt(next_slot, Code::Handle(func.code()));
+  intptr_t slot = pc_ranges->length();
+  if (sorted) {
+    // Shift the entries with higher entry points up by one slot.
+    while ((slot > 0) && (pc_ranges->At(slot - 1).entrypoint > entrypoint)) {
+      codes.SetAt(slot, Object::Handle(codes.At(slot - 1)));
+      slot--;
+    }
+  }
+  pc_ranges->InsertAt(slot, pc_range);  // pc_range gets added at 'slot'.
+  codes.SetAt(slot, Code::Handle(func.code()));
 }
 
 
 RawCode* CodeIndexTable::LookupLargeCode(uword pc) const {
-  const Array& large_codes = Array::Handle(largecode_list_);
   return LookupCodeFromList(largecode_pc_ranges_,
-                            large_codes,
+                            largecode_list_,
                             pc,
                             kIsNotSorted);
 }
@@ -204,7 +321,7 @@ RawCode* CodeIndexTable::LookupLargeCode(uword pc) const {
 
 RawCode* CodeIndexTable::LookupCodeFromList(
     IndexArray<PcRange>* pc_ranges,
-    const Array& codes,
+    RawArray* codes,
     uword pc,
     bool sorted) {
   if (pc_ranges == NULL) {
@@ -216,11 +333,9 @@ RawCode* CodeIndexTable::LookupCodeFromList(
   }
   // 'i' is in the index which holds the entry for the function,
   // access the functions array at 'i' and return the function object.
-  ASSERT(!codes.IsNull());
-  ASSERT(i < (codes.Length() - 1));
-  Code& code = Code::Handle();
-  code ^= codes.At(i);
-  return code.raw();
+  ASSERT(codes != Array::null());
+  ASSERT(i < (Smi::Value(codes->ptr()->length_) - 1));
+  return reinterpret_cast<RawCode*>(codes->ptr()->data()[i]);
 }
 
 
@@ -261,7 +376,7 @@ intptr_t CodeIndexTable::FindPcIndex(const IndexArray<PcRange>& pc_ranges,
 
 void CodeIndexTable::GrowCodeIndexTable(int new_size) {
   code_pages_->Resize(new_size);
-  code_lists_ = Array::Grow(Array::Handle(code_lists_), new_size);
+  code_lists_ = Array::Grow(Array::Handle(code_lists_), new_size, Heap::kOld);
 }
 
 }  // namespace dart
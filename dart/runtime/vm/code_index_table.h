@@ -16,6 +16,7 @@ class Code;
 class Function;
 class Isolate;
 class ObjectPointerVisitor;
+class ObjectVisitor;
 class RawArray;
 class RawCode;
 class RawFunction;
@@ -28,6 +29,8 @@ class RawFunction;
 // functions may have code which is larger than the size of a normal page.
 // These functions are referred to as large functions in this code and are
 // handled by maintaining separate index lists.
+// The table does not keep code alive when the code space is collected: the
+// entries of code which is no longer referenced otherwise are removed.
 class CodeIndexTable {
  public:
   ~CodeIndexTable();
@@ -40,12 +43,28 @@ class CodeIndexTable {
   // is returned.
   RawFunction* LookupFunction(uword pc) const;
 
-  // Lookup code index table to find corresponding code object.
+  // Lookup code index table to find corresponding code object. Does not
+  // allocate handles, so that frames can be visited during GC.
   RawCode* LookupCode(uword pc) const;
 
   // Visit all object pointers (support for GC).
   void VisitObjectPointers(ObjectPointerVisitor* visitor);
 
+  // Visit the arrays holding the code objects, but not the code objects
+  // themselves. Used by the marker to treat the table as weak when the code
+  // space is collected.
+  void VisitCodeLists(ObjectVisitor* visitor);
+
+  // Remove the entries of the code whose instructions have not been marked.
+  // Called by the marker before the code space is swept, does not allocate
+  // handles. Returns the number of removed entries.
+  intptr_t RemoveUnmarkedCode();
+
+  // Redirect the static calls of the remaining code which target removed code
+  // to the static call stub, which resolves and patches them again when they
+  // are executed. Called after the code space has been collected.
+  void RedirectCallsToRemovedCode();
+
   // Initialize the code index table for specified isolate.
   static void Init(Isolate* isolate);
 
@@ -84,6 +103,19 @@ class CodeIndexTable {
       data_[length_] = value;
       length_ += 1;
     }
+    void InsertAt(intptr_t index, const T& value) {
+      ASSERT(0 <= index);
+      ASSERT(index <= length_);
+      ASSERT(length_ < capacity_);
+      memmove(&data_[index + 1], &data_[index], (length_ - index) * sizeof(T));
+      data_[index] = value;
+      length_ += 1;
+    }
+    void Truncate(intptr_t length) {
+      ASSERT(0 <= length);
+      ASSERT(length <= length_);
+      length_ = length;
+    }
     void Resize(int new_capacity) {
       ASSERT(new_capacity > capacity_);
       T* new_data = reinterpret_cast<T*>(realloc(reinterpret_cast<void*>(data_),
@@ -131,12 +163,24 @@ class CodeIndexTable {
   // to the large function list.
   void AddLargeFunction(uword entrypoint, intptr_t size, const Function& func);
 
-  // Helper function to add a function to the list.
+  // Helper function to add a function to the list. Entries of sorted lists
+  // are inserted in entry point order, as code may be allocated in memory
+  // reclaimed from collected code.
   void AddFuncHelper(IndexArray<PcRange>* pc_ranges,
                      const Array& functions,
                      uword entrypoint,
                      intptr_t size,
-                     const Function& func);
+                     const Function& func,
+                     bool sorted);
+
+  // Remove the entries of unmarked code from the list, preserving the order
+  // of the remaining entries. Returns the number of removed entries.
+  static intptr_t RemoveUnmarkedFromList(IndexArray<PcRange>* pc_ranges,
+                                         RawArray* codes);
+
+  // Redirect the static calls of all code in the list, see
+  // RedirectCallsToRemovedCode.
+  void RedirectCallsInList(const Array& codes, intptr_t length) const;
 
   // Lookup code corresponding to the pc in the large functions list
   RawCode* LookupLargeCode(uword pc) const;
@@ -144,7 +188,7 @@ class CodeIndexTable {
   // Lookup code corresponding to the pc in the functions list
   // present at the specified page index.
   static RawCode* LookupCodeFromList(IndexArray<PcRange>* pc_ranges,
-                                     const Array& functions,
+                                     RawArray* codes,
                                      uword pc,
                                      bool sorted);
 
@@ -6,13 +6,17 @@
 
 #include "vm/assert.h"
 #include "vm/class_finalizer.h"
+#include "vm/code_patcher.h"
 #include "vm/compiler.h"
+#include "vm/heap.h"
 #include "vm/object.h"
+#include "vm/stub_code.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
-#if defined(TARGET_ARCH_IA32)  // Compiler only implemented on IA32 now.
+// Compiler only implemented on IA32 and X64 now.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
 
 TEST_CASE(CodeIndexTable) {
   const int kScriptSize = 512 * KB;
@@ -152,6 +156,76 @@ TEST_CASE(CodeIndexTable) {
   EXPECT(code_index_table->LookupCode(pc) == code.raw());
 }
 
-#endif  // TARGET_ARCH_IA32
+
+TEST_CASE(CodeIndexTableCollectCode) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static foo() { return 42; }\n"
+      "  static bar() { return foo(); }\n"
+      "}\n";
+  String& url = String::Handle(String::New("dart-test:CollectCode"));
+  String& source = String::Handle(String::New(kScriptChars));
+  Script& script = Script::Handle(Script::New(url,
+                                              source,
+                                              RawScript::kSource));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(String::NewSymbol("A"))));
+  EXPECT(!cls.IsNull());
+  ClassFinalizer::FinalizePendingClasses();
+  const Function& foo = Function::Handle(
+      cls.LookupStaticFunction(String::Handle(String::New("foo"))));
+  const Function& bar = Function::Handle(
+      cls.LookupStaticFunction(String::Handle(String::New("bar"))));
+  EXPECT(CompilerTest::TestCompileFunction(foo));
+  EXPECT(CompilerTest::TestCompileFunction(bar));
+
+  CodeIndexTable* code_index_table = Isolate::Current()->code_index_table();
+  uword optimized_entry = 0;
+  uword call_pc = 0;
+  {
+    // The compiler keeps the code it creates in zone handles.
+    Zone zone;
+    HANDLESCOPE();
+    Compiler::CompileOptimizedFunction(foo);
+    optimized_entry = Code::Handle(foo.code()).EntryPoint();
+    // Switch back to the unoptimized code, the optimized code is now only
+    // referenced by the code index table.
+    Compiler::CompileFunction(foo);
+    EXPECT(foo.code() == foo.unoptimized_code());
+
+    // Let the static call of foo in bar target the optimized code.
+    const Code& bar_code = Code::Handle(bar.code());
+    const PcDescriptors& descriptors =
+        PcDescriptors::Handle(bar_code.pc_descriptors());
+    for (intptr_t i = 0; i < descriptors.Length(); i++) {
+      if (descriptors.DescriptorKind(i) == PcDescriptors::kFuncCall) {
+        call_pc = descriptors.PC(i);
+      }
+    }
+    EXPECT(call_pc != 0);
+    CodePatcher::PatchStaticCallAt(call_pc, optimized_entry);
+  }
+  EXPECT(code_index_table->LookupCode(optimized_entry) != Code::null());
+  intptr_t code_in_use = Isolate::Current()->heap()->InUse(Heap::kExecutable);
+
+  Isolate::Current()->heap()->CollectGarbage(Heap::kExecutable);
+  EXPECT(code_index_table->LookupCode(optimized_entry) == Code::null());
+  EXPECT(Isolate::Current()->heap()->InUse(Heap::kExecutable) < code_in_use);
+  uword entry = Code::Handle(foo.code()).EntryPoint();
+  EXPECT(code_index_table->LookupCode(entry) == foo.code());
+  entry = Code::Handle(bar.code()).EntryPoint();
+  EXPECT(code_index_table->LookupCode(entry) == bar.code());
+
+  // The call into the collected code is resolved again when it is executed.
+  Function& target_function = Function::Handle();
+  uword target = 0;
+  CodePatcher::GetStaticCallAt(call_pc, &target_function, &target);
+  EXPECT(target_function.raw() == foo.raw());
+  EXPECT_EQ(StubCode::CallStaticFunctionEntryPoint(), target);
+}
+
+#endif  // TARGET_ARCH_IA32 || TARGET_ARCH_X64
 
 }  // namespace dart
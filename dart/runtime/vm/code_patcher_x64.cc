@@ -5,56 +5,253 @@
 #include "vm/globals.h"  // Needed here to get TARGET_ARCH_X64.
 #if defined(TARGET_ARCH_X64)
 
+#include "vm/assembler.h"
 #include "vm/code_patcher.h"
+#include "vm/cpu.h"
+#include "vm/ic_data.h"
+#include "vm/instructions.h"
+#include "vm/object.h"
+#include "vm/raw_object.h"
 
 namespace dart {
 
+// The pattern of a Dart call is:
+//  00: 48 b9 imm64  mov RCX, immediate 1
+//  10: 48 ba imm64  mov RDX, immediate 2
+//  20: 49 bb imm64  mov R11, target_address
+//  30: 41 ff d3     call R11
+//  33: <- return_address
+class DartCallPattern : public ValueObject {
+ public:
+  explicit DartCallPattern(uword return_address)
+      : start_(return_address - kCallPatternSize) {
+    ASSERT(*reinterpret_cast<uint16_t*>(start_) == 0xB948);
+    ASSERT(*reinterpret_cast<uint16_t*>(start_ + kLoadSize) == 0xBA48);
+    ASSERT(Call(call_address()).IsValid());
+    ASSERT(Call::InstructionLength() == Assembler::kCallExternalLabelSize);
+  }
+
+  uword target() const {
+    return Call(call_address()).TargetAddress();
+  }
+
+  void set_target(uword target) const {
+    Call(call_address()).SetTargetAddress(target);
+    CPU::FlushICache(call_address(), Call::InstructionLength());
+  }
+
+  uword immediate_one() const {
+    return *reinterpret_cast<uword*>(start_ + kImmediateOffset);
+  }
+
+  void set_immediate_one(uword value) {
+    uword* target_addr = reinterpret_cast<uword*>(start_ + kImmediateOffset);
+    *target_addr = value;
+    CPU::FlushICache(start_, kLoadSize);
+  }
+
+  uword immediate_two() const {
+    return *reinterpret_cast<uword*>(start_ + kLoadSize + kImmediateOffset);
+  }
+
+  int argument_count() const {
+    Array& args_desc = Array::Handle();
+    args_desc ^= reinterpret_cast<RawObject*>(immediate_two());
+    Smi& num_args = Smi::Handle();
+    num_args ^= args_desc.At(0);
+    return num_args.Value();
+  }
+
+  int named_argument_count() const {
+    Array& args_desc = Array::Handle();
+    args_desc ^= reinterpret_cast<RawObject*>(immediate_two());
+    Smi& num_args = Smi::Handle();
+    num_args ^= args_desc.At(0);
+    Smi& num_pos_args = Smi::Handle();
+    num_pos_args ^= args_desc.At(1);
+    return num_args.Value() - num_pos_args.Value();
+  }
+
+  // Size of the two immediate loads, the REX.W prefix and opcode precede
+  // each immediate.
+  static const int kLoadSize = 10;
+  static const int kImmediateOffset = 2;
+  static const int kCallPatternSize =
+      2 * kLoadSize + Assembler::kCallExternalLabelSize;
+
+ private:
+  uword return_address() const {
+    return start_ + kCallPatternSize;
+  }
+
+  uword call_address() const {
+    return start_ + 2 * kLoadSize;
+  }
+
+  uword start_;
+  DISALLOW_IMPLICIT_CONSTRUCTORS(DartCallPattern);
+};
+
+
+// The expected pattern of a dart static call:
+//  mov RCX, function_object
+//  mov RDX, argument_descriptor_array
+//  call target_address
+//  <- return address
+class StaticCall : public DartCallPattern {
+ public:
+  explicit StaticCall(uword return_address)
+      : DartCallPattern(return_address) {}
+
+  RawFunction* function() const {
+    Function& f = Function::Handle();
+    f ^= reinterpret_cast<RawObject*>(immediate_one());
+    return f.raw();
+  }
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(StaticCall);
+};
+
+
+// The expected pattern of a dart instance call:
+//  mov RCX, ic-data array
+//  mov RDX, argument_descriptor_array
+//  call target_address
+//  <- return address
+class InstanceCall : public DartCallPattern {
+ public:
+  explicit InstanceCall(uword return_address)
+      : DartCallPattern(return_address) {}
+
+  RawArray* ic_data() const {
+    Array& array = Array::Handle();
+    array ^= reinterpret_cast<RawObject*>(immediate_one());
+    return array.raw();
+  }
+
+  void SetIcData(const Array& value) {
+    set_immediate_one(reinterpret_cast<uword>(value.raw()));
+  }
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(InstanceCall);
+};
+
+
 void CodePatcher::GetStaticCallAt(uword return_address,
                                   Function* function,
                                   uword* target) {
-  UNIMPLEMENTED();
+  ASSERT(function != NULL);
+  ASSERT(target != NULL);
+  StaticCall call(return_address);
+  *target = call.target();
+  *function = call.function();
 }
 
 
 void CodePatcher::PatchStaticCallAt(uword return_address, uword new_target) {
-  UNIMPLEMENTED();
+  StaticCall call(return_address);
+  call.set_target(new_target);
 }
 
 
-void CodePatcher::GetInstanceCallAt(uword return_address,
-                                    String* function_name,
-                                    int* num_arguments,
-                                    int* num_named_arguments,
-                                    uword* target) {
-  UNIMPLEMENTED();
+static void SwapCode(intptr_t num_bytes, char* a, char* b) {
+  for (intptr_t i = 0; i < num_bytes; i++) {
+    char tmp = *a;
+    *a = *b;
+    *b = tmp;
+    a++;
+    b++;
+  }
 }
 
 
+// The patch code buffer contains the jmp code which will be inserted at
+// entry point.
 void CodePatcher::PatchEntry(const Code& code) {
-  UNIMPLEMENTED();
+  Jump jmp_entry(code.EntryPoint());
+  ASSERT(!jmp_entry.IsValid());
+  const uword patch_buffer = code.GetPatchCodePc();
+  ASSERT(patch_buffer != 0);
+  Jump jmp_patch(patch_buffer);
+  ASSERT(jmp_patch.IsValid());
+  const uword jump_target = jmp_patch.TargetAddress();
+  SwapCode(jmp_patch.pattern_length_in_bytes(),
+           reinterpret_cast<char*>(code.EntryPoint()),
+           reinterpret_cast<char*>(patch_buffer));
+  jmp_entry.SetTargetAddress(jump_target);
 }
 
 
+// The entry point is a jmp instruction, the patch code buffer contains
+// original code, the entry point contains the jump instruction.
 void CodePatcher::RestoreEntry(const Code& code) {
-  UNIMPLEMENTED();
+  Jump jmp_entry(code.EntryPoint());
+  ASSERT(jmp_entry.IsValid());
+  const uword jump_target = jmp_entry.TargetAddress();
+  const uword patch_buffer = code.GetPatchCodePc();
+  ASSERT(patch_buffer != 0);
+  // 'patch_buffer' contains original entry code.
+  Jump jmp_patch(patch_buffer);
+  ASSERT(!jmp_patch.IsValid());
+  SwapCode(jmp_patch.pattern_length_in_bytes(),
+           reinterpret_cast<char*>(code.EntryPoint()),
+           reinterpret_cast<char*>(patch_buffer));
+  ASSERT(jmp_patch.IsValid());
+  jmp_patch.SetTargetAddress(jump_target);
 }
 
 
 bool CodePatcher::CodeIsPatchable(const Code& code) {
-  UNIMPLEMENTED();
-  return false;
+  Jump jmp_entry(code.EntryPoint());
+  if (code.Size() < (jmp_entry.pattern_length_in_bytes() * 2)) {
+    return false;
+  }
+  uword limit = code.EntryPoint() + jmp_entry.pattern_length_in_bytes();
+  for (intptr_t i = 0; i < code.pointer_offsets_length(); i++) {
+    const uword addr = code.GetPointerOffsetAt(i) + code.EntryPoint();
+    if (addr < limit) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void CodePatcher::GetInstanceCallAt(uword return_address,
+                                    String* function_name,
+                                    int* num_arguments,
+                                    int* num_named_arguments,
+                                    uword* target) {
+  ASSERT(function_name != NULL);
+  ASSERT(num_arguments != NULL);
+  ASSERT(num_named_arguments != NULL);
+  ASSERT(target != NULL);
+  InstanceCall call(return_address);
+  *num_arguments = call.argument_count();
+  *num_named_arguments = call.named_argument_count();
+  *target = call.target();
+  ICData ic_data(Array::ZoneHandle(call.ic_data()));
+  *function_name = ic_data.FunctionName();
 }
 
 
 RawArray* CodePatcher::GetInstanceCallIcDataAt(uword return_address) {
-  UNIMPLEMENTED();
-  return NULL;
+  InstanceCall call(return_address);
+  return call.ic_data();
 }
 
 
 void CodePatcher::SetInstanceCallIcDataAt(uword return_address,
-                                         const Array& ic_data) {
-  UNIMPLEMENTED();
+                                          const Array& ic_data) {
+  InstanceCall call(return_address);
+  call.SetIcData(ic_data);
+}
+
+
+intptr_t CodePatcher::InstanceCallSizeInBytes() {
+  return DartCallPattern::kCallPatternSize;
 }
 
 }  // namespace dart
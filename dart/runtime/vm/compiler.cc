@@ -12,6 +12,10 @@
 #include "vm/dart_entry.h"
 #include "vm/disassembler.h"
 #include "vm/flags.h"
+#include "vm/flow_graph_builder.h"
+#include "vm/flow_graph_compiler.h"
+#include "vm/flow_graph_inliner.h"
+#include "vm/flow_graph_optimizer.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
 #include "vm/opt_code_generator.h"
@@ -19,6 +23,7 @@
 #include "vm/parser.h"
 #include "vm/scanner.h"
 #include "vm/timer.h"
+#include "vm/zone.h"
 
 namespace dart {
 
@@ -27,6 +32,11 @@ DEFINE_FLAG(bool, trace_compiler, false, "Trace compiler operations.");
 DEFINE_FLAG(int, deoptimization_counter_threshold, 2,
     "How many times we allow deoptimization before we disallow"
     " certain optimizations");
+DEFINE_FLAG(bool, use_ssa, false,
+    "Compile optimized code from the SSA flow graph when possible.");
+DEFINE_FLAG(bool, deferred_compilation, false,
+    "Defer the optimizing compilation of hot functions to the run loop, "
+    "between messages. It still runs on the thread of the isolate.");
 
 
 // Compile a function. Should call only if the function has not been compiled.
@@ -41,8 +51,8 @@ DEFINE_RUNTIME_ENTRY(CompileFunction, 1) {
 
 // Extracts IC data associated with a node id.
 // TODO(srdjan): Check performance impact of node id search loop.
-static void ExtractTypeFeedback(const Code& code,
-                                SequenceNode* sequence_node) {
+void Compiler::ExtractTypeFeedback(const Code& code,
+                                   SequenceNode* sequence_node) {
   ASSERT(!code.IsNull() && !code.is_optimized());
   GrowableArray<AstNode*> all_nodes;
   sequence_node->CollectAllNodes(&all_nodes);
@@ -78,6 +88,20 @@ void Compiler::Compile(const Library& library, const Script& script) {
 }
 
 
+static void InstallOptimizedCode(const Function& function,
+                                 const char* function_fullname,
+                                 Assembler* assembler,
+                                 CodeGenerator* code_gen) {
+  Code& code = Code::Handle(
+      Code::FinalizeCode(function_fullname, assembler));
+  code.set_is_optimized(true);
+  code_gen->FinalizePcDescriptors(code);
+  code_gen->FinalizeExceptionHandlers(code);
+  code_gen->FinalizeStackmaps(code);
+  function.SetCode(code);
+}
+
+
 static void CompileFunctionHelper(const Function& function, bool optimized) {
   TIMERSCOPE(time_compilation);
   ParsedFunction parsed_function(function);
@@ -99,17 +123,34 @@ static void CompileFunctionHelper(const Function& function, bool optimized) {
     // Do not use type feedback to optimize a function that was deoptimized.
     if (parsed_function.function().deoptimization_counter() <
         FLAG_deoptimization_counter_threshold) {
-      ExtractTypeFeedback(Code::Handle(parsed_function.function().code()),
-                          parsed_function.node_sequence());
+      Compiler::ExtractTypeFeedback(
+          Code::Handle(parsed_function.function().code()),
+          parsed_function.node_sequence());
+    }
+    FlowGraph* flow_graph = NULL;
+#if defined(TARGET_ARCH_IA32)
+    // The flow graph compiler of the other architectures still compiles the
+    // function from its AST, inlining into the flow graph would be lost.
+    // Inlining is thus only done on IA32, with --use_ssa.
+    if (FLAG_use_ssa) {
+      FlowGraphBuilder builder(parsed_function);
+      flow_graph = builder.BuildGraph();
+    }
+#endif  // TARGET_ARCH_IA32
+    if (flow_graph != NULL) {
+      FlowGraphInliner inliner(flow_graph);
+      inliner.Inline();
+      FlowGraphOptimizer optimizer(flow_graph);
+      optimizer.ApplyTypeFeedback();
+      FlowGraphCompiler code_gen(&assembler, *flow_graph);
+      code_gen.GenerateCode();
+      InstallOptimizedCode(function, function_fullname, &assembler, &code_gen);
+    } else {
+      // The flow graph does not support all constructs yet.
+      OptimizingCodeGenerator code_gen(&assembler, parsed_function);
+      code_gen.GenerateCode();
+      InstallOptimizedCode(function, function_fullname, &assembler, &code_gen);
     }
-    OptimizingCodeGenerator code_gen(&assembler, parsed_function);
-    code_gen.GenerateCode();
-    Code& code = Code::Handle(
-        Code::FinalizeCode(function_fullname, &assembler));
-    code.set_is_optimized(true);
-    code_gen.FinalizePcDescriptors(code);
-    code_gen.FinalizeExceptionHandlers(code);
-    function.SetCode(code);
     code_index_table->AddFunction(function);
     CodePatcher::PatchEntry(Code::Handle(function.unoptimized_code()));
     if (FLAG_trace_compiler) {
@@ -128,6 +169,7 @@ static void CompileFunctionHelper(const Function& function, bool optimized) {
       code.set_is_optimized(false);
       code_gen.FinalizePcDescriptors(code);
       code_gen.FinalizeExceptionHandlers(code);
+      code_gen.FinalizeStackmaps(code);
       function.set_unoptimized_code(code);
       function.SetCode(code);
       ASSERT(CodePatcher::CodeIsPatchable(code));
@@ -197,6 +239,69 @@ void Compiler::CompileOptimizedFunction(const Function& function) {
 }
 
 
+static const intptr_t kInitialOptimizationQueueCapacity = 16;
+
+
+bool Compiler::QueueOptimizedFunction(const Function& function) {
+  if (function.is_queued_for_optimization()) {
+    return false;
+  }
+  ObjectStore* object_store = Isolate::Current()->object_store();
+  Array& queue = Array::Handle(object_store->optimization_queue());
+  const intptr_t length = object_store->optimization_queue_length();
+  if (queue.IsNull()) {
+    queue = Array::New(kInitialOptimizationQueueCapacity);
+    object_store->set_optimization_queue(queue);
+  } else if (length == queue.Length()) {
+    queue = Array::Grow(queue, 2 * length);
+    object_store->set_optimization_queue(queue);
+  }
+  queue.SetAt(length, function);
+  object_store->set_optimization_queue_length(length + 1);
+  function.set_is_queued_for_optimization(true);
+  if (FLAG_trace_compiler) {
+    OS::Print("Queued optimizing compilation of '%s'\n",
+        function.ToFullyQualifiedCString());
+  }
+  return true;
+}
+
+
+void Compiler::CompileQueuedFunctions() {
+  ObjectStore* object_store = Isolate::Current()->object_store();
+  const Array& queue = Array::Handle(object_store->optimization_queue());
+  if (queue.IsNull()) {
+    return;
+  }
+  const intptr_t length = object_store->optimization_queue_length();
+  // Functions getting hot while compiling are queued for the next safe point.
+  object_store->set_optimization_queue(Array::Handle());
+  object_store->set_optimization_queue_length(0);
+  Function& function = Function::Handle();
+  // Dequeue all functions first, a compilation error leaves the queue empty.
+  for (intptr_t i = 0; i < length; i++) {
+    function ^= queue.At(i);
+    function.set_is_queued_for_optimization(false);
+  }
+  for (intptr_t i = 0; i < length; i++) {
+    function ^= queue.At(i);
+    // The function may have been optimized meanwhile because it got hot
+    // again before this safe point.
+    if (!function.is_optimizable() ||
+        Code::Handle(function.code()).is_optimized() ||
+        (function.deoptimization_counter() >=
+         FLAG_deoptimization_counter_threshold)) {
+      continue;
+    }
+    Zone zone;
+    HandleScope handle_scope;
+    // Installing the code patches the entry of the unoptimized code, callers
+    // are redirected to the optimized code on their next call.
+    CompileOptimizedFunction(function);
+  }
+}
+
+
 void Compiler::CompileAllFunctions(const Class& cls) {
   Array& functions = Array::Handle(cls.functions());
   Function& func = Function::Handle();
@@ -255,6 +360,7 @@ RawInstance* Compiler::ExecuteOnce(SequenceNode* fragment) {
   // we don't pollute the system unnecessarily with stale data.
   code_gen.FinalizePcDescriptors(code);
   code_gen.FinalizeExceptionHandlers(code);
+  code_gen.FinalizeStackmaps(code);
 
   GrowableArray<const Object*> arguments;  // no arguments.
   const Array& kNoArgumentNames = Array::Handle();
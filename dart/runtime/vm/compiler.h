@@ -13,6 +13,7 @@ namespace dart {
 
 // Forward declarations.
 class Class;
+class Code;
 class Function;
 class Library;
 class RawInstance;
@@ -33,6 +34,22 @@ class Compiler : public AllStatic {
   // Generates optimized code for function.
   static void CompileOptimizedFunction(const Function& function);
 
+  // Attaches the ICData collected by the unoptimized 'code' of a function to
+  // the nodes of its AST.
+  static void ExtractTypeFeedback(const Code& code,
+                                  SequenceNode* sequence_node);
+
+  // Queues the optimizing compilation of a hot function until the next safe
+  // point, see CompileQueuedFunctions. Returns false if the function is
+  // already queued. This only defers the compilation, it is not done on
+  // another thread.
+  static bool QueueOptimizedFunction(const Function& function);
+
+  // Generates optimized code for the queued functions which are still
+  // optimizable. Called by the run loop between messages, when no Dart code
+  // is running and the type feedback of the functions does not change.
+  static void CompileQueuedFunctions();
+
   // Generates and executes code for a given code fragment, e.g. a
   // compile time constant expression. Returns the result returned
   // by the fragment.
@@ -5,12 +5,15 @@
 #include "vm/compiler.h"
 
 #include "vm/assert.h"
+#include "vm/class_finalizer.h"
 #include "vm/object.h"
+#include "vm/object_store.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
-#if defined(TARGET_ARCH_IA32)  // Compiler only implemented on IA32 now.
+// Compiler only implemented on IA32 and X64 now.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
 
 TEST_CASE(CompileScript) {
   const char* kScriptChars =
@@ -58,6 +61,107 @@ TEST_CASE(CompileFunction) {
   EXPECT(function_moo.HasCode());
 }
 
-#endif  // TARGET_ARCH_IA32
+
+TEST_CASE(CompileFunctionStackmaps) {
+  const char* kScriptChars =
+            "class A {\n"
+            "  static foo() { return 42; }\n"
+            "  static bar(a, [b = 1]) {\n"
+            "    var c = A.foo();\n"
+            "    var d = a;\n"
+            "    return A.foo();\n"
+            "  }\n"
+            "}\n";
+  String& url =
+      String::Handle(String::New("dart-test:CompileFunctionStackmaps"));
+  String& source = String::Handle(String::New(kScriptChars));
+  Script& script = Script::Handle(Script::New(url, source, RawScript::kSource));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(String::NewSymbol("A"))));
+  EXPECT(!cls.IsNull());
+  ClassFinalizer::FinalizePendingClasses();
+  String& function_bar_name = String::Handle(String::New("bar"));
+  Function& function_bar =
+      Function::Handle(cls.LookupStaticFunction(function_bar_name));
+  EXPECT(!function_bar.IsNull());
+  EXPECT(CompilerTest::TestCompileFunction(function_bar));
+  EXPECT(function_bar.HasCode());
+
+  // Both calls to foo are described by the last map, the two copied
+  // parameters and the two locals hold objects at the calls. A map is only
+  // recorded where the slots change.
+  const Code& code = Code::Handle(function_bar.code());
+  const Array& maps = Array::Handle(code.stackmaps());
+  EXPECT(!maps.IsNull());
+  EXPECT(maps.Length() >= 1);
+  Stackmap& map = Stackmap::Handle();
+  Stackmap& previous_map = Stackmap::Handle();
+  for (intptr_t i = 0; i < maps.Length(); i++) {
+    map ^= maps.At(i);
+    EXPECT(map.PC() > code.EntryPoint());
+    EXPECT(map.PC() <= (code.EntryPoint() + code.Size()));
+    EXPECT_EQ(4, map.Length());
+    if (!previous_map.IsNull()) {
+      EXPECT(map.PC() > previous_map.PC());
+      bool differs = false;
+      for (intptr_t j = 0; j < map.Length(); j++) {
+        differs = differs || (map.IsObject(j) != previous_map.IsObject(j));
+      }
+      EXPECT(differs);
+    }
+    previous_map = map.raw();
+  }
+  for (intptr_t j = 0; j < map.Length(); j++) {
+    EXPECT(map.IsObject(j));
+  }
+}
+
+
+
+TEST_CASE(CompileQueuedFunctions) {
+  const char* kScriptChars =
+            "class A {\n"
+            "  static foo(a) { return a + 1; }\n"
+            "}\n";
+  String& url =
+      String::Handle(String::New("dart-test:CompileQueuedFunctions"));
+  String& source = String::Handle(String::New(kScriptChars));
+  Script& script = Script::Handle(Script::New(url, source, RawScript::kSource));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(String::NewSymbol("A"))));
+  EXPECT(!cls.IsNull());
+  String& function_foo_name = String::Handle(String::New("foo"));
+  Function& function_foo =
+      Function::Handle(cls.LookupStaticFunction(function_foo_name));
+  EXPECT(!function_foo.IsNull());
+  EXPECT(CompilerTest::TestCompileFunction(function_foo));
+  EXPECT(function_foo.is_optimizable());
+
+  // Queuing a function twice keeps a single entry.
+  ObjectStore* object_store = Isolate::Current()->object_store();
+  EXPECT(!function_foo.is_queued_for_optimization());
+  EXPECT(Compiler::QueueOptimizedFunction(function_foo));
+  EXPECT(function_foo.is_queued_for_optimization());
+  EXPECT(!Compiler::QueueOptimizedFunction(function_foo));
+  EXPECT_EQ(1, object_store->optimization_queue_length());
+  EXPECT(!Code::Handle(function_foo.code()).is_optimized());
+
+  Compiler::CompileQueuedFunctions();
+  EXPECT(Code::Handle(function_foo.code()).is_optimized());
+  EXPECT(!function_foo.is_queued_for_optimization());
+  EXPECT(Array::Handle(object_store->optimization_queue()).IsNull());
+  EXPECT_EQ(0, object_store->optimization_queue_length());
+
+  // Optimized functions are skipped.
+  EXPECT(Compiler::QueueOptimizedFunction(function_foo));
+  Compiler::CompileQueuedFunctions();
+  EXPECT(Code::Handle(function_foo.code()).is_optimized());
+}
+
+#endif  // TARGET_ARCH_IA32 || TARGET_ARCH_X64
 
 }  // namespace dart
@@ -5,6 +5,8 @@
 #ifndef VM_CONSTANTS_X64_H_
 #define VM_CONSTANTS_X64_H_
 
+#include "vm/assert.h"
+
 namespace dart {
 
 enum Register {
@@ -28,6 +30,154 @@ enum Register {
   kNoRegister = -1  // Signals an illegal register.
 };
 
+
+// The byte registers 4 to 7 are only addressable with a REX prefix, in which
+// case they are SPL, BPL, SIL and DIL instead of AH, CH, DH and BH.
+enum ByteRegister {
+  AL = 0,
+  CL = 1,
+  DL = 2,
+  BL = 3,
+  SPL = 4,
+  BPL = 5,
+  SIL = 6,
+  DIL = 7,
+  R8B = 8,
+  R9B = 9,
+  R10B = 10,
+  R11B = 11,
+  R12B = 12,
+  R13B = 13,
+  R14B = 14,
+  R15B = 15,
+  kNoByteRegister = -1  // Signals an illegal register.
+};
+
+
+enum XmmRegister {
+  XMM0 = 0,
+  XMM1 = 1,
+  XMM2 = 2,
+  XMM3 = 3,
+  XMM4 = 4,
+  XMM5 = 5,
+  XMM6 = 6,
+  XMM7 = 7,
+  XMM8 = 8,
+  XMM9 = 9,
+  XMM10 = 10,
+  XMM11 = 11,
+  XMM12 = 12,
+  XMM13 = 13,
+  XMM14 = 14,
+  XMM15 = 15,
+  kNumberOfXmmRegisters = 16,
+  kNoXmmRegister = -1  // Signals an illegal register.
+};
+
+
+enum RexBits {
+  REX_NONE   = 0,
+  REX_B      = 1 << 0,
+  REX_X      = 1 << 1,
+  REX_R      = 1 << 2,
+  REX_W      = 1 << 3,
+  REX_PREFIX = 1 << 6
+};
+
+
+// Register aliases.
+const Register TMP = R11;  // Used as scratch register by the assembler.
+const Register CTX = R15;  // Caches current context in generated code.
+
+// Exception object is passed in this register to the catch handlers when an
+// exception is thrown.
+const Register kExceptionObjectReg = RAX;
+
+// Stack trace object is passed in this register to the catch handlers when
+// an exception is thrown.
+const Register kStackTraceObjectReg = RDX;
+
+// Registers used to pass the first arguments to C++ functions, and the stack
+// space the caller must reserve below them, as mandated by the calling
+// convention of the target operating system.
+#if defined(TARGET_OS_WINDOWS)
+const Register kCArg0Reg = RCX;
+const Register kCArg1Reg = RDX;
+const Register kCArg2Reg = R8;
+const Register kCArg3Reg = R9;
+const int kCShadowSpaceSize = 4 * 8;  // Home slots of the register arguments.
+// RSI, RDI and XMM6-XMM15 are only callee-saved on Windows, they are saved in
+// the entry frame in addition to the other callee-saved registers.
+const int kCFirstSavedXmmReg = XMM6;
+const int kCSavedXmmRegCount = 10;
+const int kCExtraCalleeSavedSize = (2 * 8) + (kCSavedXmmRegCount * 16);
+#else
+const Register kCArg0Reg = RDI;
+const Register kCArg1Reg = RSI;
+const Register kCArg2Reg = RDX;
+const Register kCArg3Reg = RCX;
+const int kCShadowSpaceSize = 0;
+const int kCExtraCalleeSavedSize = 0;
+#endif
+
+enum ScaleFactor {
+  TIMES_1 = 0,
+  TIMES_2 = 1,
+  TIMES_4 = 2,
+  TIMES_8 = 3
+};
+
+
+enum Condition {
+  OVERFLOW      =  0,
+  NO_OVERFLOW   =  1,
+  BELOW         =  2,
+  ABOVE_EQUAL   =  3,
+  EQUAL         =  4,
+  NOT_EQUAL     =  5,
+  BELOW_EQUAL   =  6,
+  ABOVE         =  7,
+  SIGN          =  8,
+  NOT_SIGN      =  9,
+  PARITY_EVEN   = 10,
+  PARITY_ODD    = 11,
+  LESS          = 12,
+  GREATER_EQUAL = 13,
+  LESS_EQUAL    = 14,
+  GREATER       = 15,
+
+  ZERO          = EQUAL,
+  NOT_ZERO      = NOT_EQUAL,
+  NEGATIVE      = SIGN,
+  POSITIVE      = NOT_SIGN
+};
+
+
+class Instr {
+ public:
+  static const uint8_t kHltInstruction = 0xF4;
+  // We prefer not to use the int3 instruction since it conflicts with gdb.
+  static const uint8_t kBreakPointInstruction = kHltInstruction;
+  static const int kBreakPointInstructionSize = 1;
+
+  bool IsBreakPoint() {
+    ASSERT(kBreakPointInstructionSize == 1);
+    return (*reinterpret_cast<const uint8_t*>(this)) == kBreakPointInstruction;
+  }
+
+  // Instructions are read out of a code stream. The only way to get a
+  // reference to an instruction is to convert a pointer. There is no way
+  // to allocate or create instances of class Instr.
+  // Use the At(pc) function to create references to Instr.
+  static Instr* At(uword pc) { return reinterpret_cast<Instr*>(pc); }
+
+ private:
+  DISALLOW_ALLOCATION();
+  // We need to prevent the creation of instances of class Instr.
+  DISALLOW_IMPLICIT_CONSTRUCTORS(Instr);
+};
+
 }  // namespace dart
 
 #endif  // VM_CONSTANTS_X64_H_
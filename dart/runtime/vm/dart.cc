@@ -14,12 +14,14 @@
 #include "vm/port.h"
 #include "vm/snapshot.h"
 #include "vm/stub_code.h"
+#include "vm/thread_pool.h"
 #include "vm/virtual_memory.h"
 #include "vm/zone.h"
 
 namespace dart {
 
 Isolate* Dart::vm_isolate_ = NULL;
+ThreadPool* Dart::thread_pool_ = NULL;
 DebugInfo* Dart::pprof_symbol_generator_ = NULL;
 
 bool Dart::InitOnce(int argc, char** argv,
@@ -32,6 +34,8 @@ bool Dart::InitOnce(int argc, char** argv,
   Flags::ProcessCommandLineFlags(argc, argv);
   VirtualMemory::InitOnce();
   Isolate::InitOnce();
+  ASSERT(thread_pool_ == NULL);
+  thread_pool_ = new ThreadPool();
   // Create the VM isolate and finish the VM initialization.
   {
     ASSERT(vm_isolate_ == NULL);
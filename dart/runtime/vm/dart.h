@@ -13,6 +13,7 @@ namespace dart {
 // Forward declarations.
 class DebugInfo;
 class Isolate;
+class ThreadPool;
 
 class Dart : public AllStatic {
  public:
@@ -24,6 +25,10 @@ class Dart : public AllStatic {
 
   static Isolate* vm_isolate() { return vm_isolate_; }
 
+  // The threads running the helper tasks of the garbage collector, shared by
+  // all isolates.
+  static ThreadPool* thread_pool() { return thread_pool_; }
+
   static void set_pprof_symbol_generator(DebugInfo* value) {
     pprof_symbol_generator_ = value;
   }
@@ -31,6 +36,7 @@ class Dart : public AllStatic {
 
  private:
   static Isolate* vm_isolate_;
+  static ThreadPool* thread_pool_;
   static DebugInfo* pprof_symbol_generator_;
 };
 
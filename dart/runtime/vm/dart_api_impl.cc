@@ -13,7 +13,11 @@
 #include "vm/dart_entry.h"
 #include "vm/debuginfo.h"
 #include "vm/exceptions.h"
+#include "vm/gc_timeline.h"
 #include "vm/growable_array.h"
+#include "vm/heap.h"
+#include "vm/heap_histogram.h"
+#include "vm/heap_snapshot.h"
 #include "vm/longjump.h"
 #include "vm/native_entry.h"
 #include "vm/object.h"
@@ -103,6 +107,102 @@ DART_EXPORT void Dart_ExitIsolate() {
 }
 
 
+DART_EXPORT void Dart_CompactHeap() {
+  Isolate* isolate = Isolate::Current();
+  ASSERT(isolate != NULL);
+  isolate->heap()->CompactOldSpace();
+}
+
+
+DART_EXPORT void Dart_SetNewSpaceLimits(intptr_t min_semi_space_kb,
+                                        intptr_t max_semi_space_kb) {
+  Isolate* isolate = Isolate::Current();
+  ASSERT(isolate != NULL);
+  isolate->heap()->SetNewSpaceLimits(min_semi_space_kb * KB,
+                                     max_semi_space_kb * KB);
+}
+
+
+DART_EXPORT void Dart_SetOldSpaceLimit(intptr_t max_old_space_kb) {
+  Isolate* isolate = Isolate::Current();
+  ASSERT(isolate != NULL);
+  isolate->heap()->SetOldSpaceLimit(max_old_space_kb * KB);
+}
+
+
+static void GetHeapSpaceStats(Heap* heap,
+                              Heap::Space space,
+                              Dart_HeapSpaceStats* stats) {
+  stats->used = heap->InUse(space);
+  stats->capacity = heap->Capacity(space);
+  stats->collections = heap->Collections(space);
+  stats->collection_time_micros = heap->CollectionTime(space);
+  stats->unswept = heap->Unswept(space);
+  stats->sweep_time_micros = heap->SweepTime(space);
+}
+
+
+DART_EXPORT void Dart_GetHeapStats(Dart_HeapStats* stats) {
+  Isolate* isolate = Isolate::Current();
+  ASSERT(isolate != NULL);
+  ASSERT(stats != NULL);
+  Heap* heap = isolate->heap();
+  GetHeapSpaceStats(heap, Heap::kNew, &stats->new_space);
+  GetHeapSpaceStats(heap, Heap::kOld, &stats->old_space);
+  GetHeapSpaceStats(heap, Heap::kExecutable, &stats->code_space);
+}
+
+
+DART_EXPORT void Dart_GetHeapClassStats(Dart_HeapClassStatsCallback callback,
+                                        void* callback_data) {
+  Isolate* isolate = Isolate::Current();
+  ASSERT(isolate != NULL);
+  ASSERT(callback != NULL);
+  Zone zone;  // Setup a VM zone as we are creating some handles.
+  HandleScope scope;  // Setup a VM handle scope.
+  HeapHistogram histogram(isolate->heap());
+  String& name = String::Handle();
+  for (intptr_t i = 0; i < histogram.Length(); i++) {
+    name = histogram.ClassAt(i).Name();
+    callback(callback_data,
+             name.ToCString(),
+             histogram.CountAt(i),
+             histogram.SizeAt(i));
+  }
+}
+
+
+DART_EXPORT void Dart_SetGCEventCallback(Dart_GCEventCallback callback) {
+  GCTimeline::SetCallback(callback);
+}
+
+
+DART_EXPORT intptr_t Dart_GetGCEvents(Dart_GCEvent* events, intptr_t length) {
+  Isolate* isolate = Isolate::Current();
+  ASSERT(isolate != NULL);
+  ASSERT((events != NULL) || (length == 0));
+  const GCTimeline& timeline = isolate->heap()->timeline();
+  intptr_t count = Utils::Minimum(length, timeline.Length());
+  intptr_t first = timeline.Length() - count;
+  for (intptr_t i = 0; i < count; i++) {
+    GCTimeline::ToApiEvent(timeline.EventAt(first + i), &events[i]);
+  }
+  return count;
+}
+
+
+DART_EXPORT int64_t Dart_GetGCPausePercentile(Dart_GCKind kind,
+                                              intptr_t percentile) {
+  Isolate* isolate = Isolate::Current();
+  ASSERT(isolate != NULL);
+  if ((percentile < 0) || (percentile > 100)) {
+    return 0;
+  }
+  return isolate->heap()->timeline().PausePercentile(
+      static_cast<GCEvent::Kind>(kind), percentile);
+}
+
+
 static void SetupErrorResult(Dart_Handle* handle) {
   // Make a copy of the error message as the original message string
   // may get deallocated when we return back from the Dart API call.
@@ -186,6 +286,12 @@ DART_EXPORT void Dart_HandleMessage(Dart_Port dest_port,
     ProcessUnhandledException(uhe);
   }
   ASSERT(result.IsNull());
+  // A message delivered from a native function is handled while Dart code
+  // is running, the deferred work waits for a later message then.
+  Isolate* isolate = Isolate::Current();
+  if (isolate->top_exit_frame_info() == 0) {
+    isolate->RunBetweenMessages();
+  }
 }
 
 
@@ -1310,9 +1416,23 @@ DART_EXPORT Dart_Handle Dart_NewPersistentHandle(Dart_Handle object) {
 }
 
 
-DART_EXPORT Dart_Handle Dart_MakeWeakPersistentHandle(Dart_Handle object) {
-  UNIMPLEMENTED();
-  return NULL;
+DART_EXPORT Dart_Handle Dart_MakeWeakPersistentHandle(
+    Dart_Handle object,
+    void* peer,
+    Dart_WeakPersistentHandleFinalizer callback) {
+  Isolate* isolate = Isolate::Current();
+  ASSERT(isolate != NULL);
+  ApiState* state = isolate->api_state();
+  ASSERT(state != NULL);
+  Zone zone;  // Setup a VM zone as we are creating some handles.
+  HandleScope scope;  // Setup a VM handle scope.
+  const Object& obj = Object::Handle(Api::UnwrapHandle(object));
+  PersistentHandle* ref = state->weak_persistent_handles().AllocateHandle();
+  ref->set_raw(obj);
+  ref->set_type(PersistentHandle::WeakReference);
+  ref->set_peer(peer);
+  ref->set_callback(callback);
+  return reinterpret_cast<Dart_Handle>(ref);
 }
 
 
@@ -1328,7 +1448,11 @@ DART_EXPORT void Dart_DeletePersistentHandle(Dart_Handle object) {
   ApiState* state = isolate->api_state();
   ASSERT(state != NULL);
   PersistentHandle* ref = Api::UnwrapAsPersistentHandle(*state, object);
-  state->persistent_handles().FreeHandle(ref);
+  if (ref->type() == PersistentHandle::WeakReference) {
+    state->FreeWeakPersistentHandle(ref);
+  } else {
+    state->persistent_handles().FreeHandle(ref);
+  }
 }
 
 
@@ -1627,6 +1751,31 @@ DART_EXPORT Dart_Handle Dart_CreateSnapshot(uint8_t** snapshot_buffer,
 }
 
 
+DART_EXPORT Dart_Handle Dart_CreateHeapSnapshot(uint8_t** buffer,
+                                                intptr_t* buffer_size) {
+  Zone zone;  // Setup a VM zone as we are creating some handles.
+  HandleScope scope;  // Setup a VM handle scope.
+  if (buffer == NULL || buffer_size == NULL) {
+    return Api::Error("Invalid input parameters to Dart_CreateHeapSnapshot");
+  }
+  HeapSnapshotWriter writer(buffer, ApiAllocator);
+  writer.WriteSnapshot(Isolate::Current());
+  *buffer_size = writer.BytesWritten();
+  return Api::Success();
+}
+
+
+DART_EXPORT void Dart_SetHeapSnapshotCallback(
+    Dart_HeapSnapshotCallback callback) {
+  HeapSnapshotWriter::SetCallback(callback);
+}
+
+
+DART_EXPORT void Dart_RequestHeapSnapshot() {
+  HeapSnapshotWriter::RequestSnapshot();
+}
+
+
 static uint8_t* allocator(uint8_t* ptr, intptr_t old_size, intptr_t new_size) {
   void* new_ptr = realloc(reinterpret_cast<void*>(ptr), new_size);
   return reinterpret_cast<uint8_t*>(new_ptr);
@@ -7,6 +7,7 @@
 #include "vm/assert.h"
 #include "vm/dart_api_impl.h"
 #include "vm/dart_api_state.h"
+#include "vm/heap.h"
 #include "vm/unit_test.h"
 #include "vm/utils.h"
 #include "vm/verifier.h"
@@ -57,7 +58,8 @@ UNIT_TEST_CASE(DoubleValues) {
 }
 
 
-#if defined(TARGET_ARCH_IA32)  // only ia32 can run execution tests.
+// Only ia32 and x64 can run execution tests.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
 
 UNIT_TEST_CASE(NumberValues) {
   // TODO(antonm): add various kinds of ints (smi, mint, bigint).
@@ -309,6 +311,121 @@ UNIT_TEST_CASE(PersistentHandles) {
 }
 
 
+static intptr_t finalized_count = 0;
+static void* finalized_peer = NULL;
+
+static void FinalizeWeakHandle(Dart_Handle handle, void* peer) {
+  finalized_count++;
+  finalized_peer = peer;
+  Dart_DeletePersistentHandle(handle);
+}
+
+
+// Unit test for weak persistent handles to new and old objects.
+UNIT_TEST_CASE(WeakPersistentHandles) {
+  Dart_CreateIsolate(NULL, NULL);
+  Isolate* isolate = Isolate::Current();
+  ApiState* state = isolate->api_state();
+  Heap* heap = isolate->heap();
+  static int new_peer = 1;
+  static int old_peer = 2;
+  Dart_Handle strong = NULL;
+  Dart_Handle weak_live = NULL;
+  Dart_EnterScope();
+  {
+    Zone zone;
+    HandleScope hs;
+    const String& live = String::Handle(String::New("live"));
+    strong = Dart_NewPersistentHandle(Api::NewLocalHandle(live));
+    weak_live = Dart_MakeWeakPersistentHandle(Api::NewLocalHandle(live),
+                                              NULL,
+                                              FinalizeWeakHandle);
+    const String& dead_new = String::Handle(String::New("new"));
+    Dart_MakeWeakPersistentHandle(Api::NewLocalHandle(dead_new),
+                                  &new_peer,
+                                  FinalizeWeakHandle);
+    const String& dead_old =
+        String::Handle(String::New("old", Heap::kOld));
+    Dart_MakeWeakPersistentHandle(Api::NewLocalHandle(dead_old),
+                                  &old_peer,
+                                  FinalizeWeakHandle);
+  }
+  Dart_ExitScope();
+  EXPECT_EQ(3, state->CountWeakPersistentHandles());
+
+  // A scavenge clears the handle to the dead new object and runs its
+  // callback, the live object is moved.
+  finalized_count = 0;
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_EQ(1, finalized_count);
+  EXPECT(finalized_peer == &new_peer);
+  EXPECT_EQ(0, state->CountPendingFinalizations());
+  EXPECT(Api::UnwrapHandle(weak_live) == Api::UnwrapHandle(strong));
+
+  // Old space collections clear the handle to the dead old object.
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT_EQ(2, finalized_count);
+  EXPECT(finalized_peer == &old_peer);
+  heap->CompactOldSpace();
+  EXPECT_EQ(2, finalized_count);
+  EXPECT(Api::UnwrapHandle(weak_live) == Api::UnwrapHandle(strong));
+  {
+    Zone zone;
+    HandleScope hs;
+    String& str = String::Handle();
+    str ^= Api::UnwrapHandle(weak_live);
+    EXPECT(str.Equals("live"));
+  }
+
+  // Once the object is unreachable the last handle is cleared as well.
+  Dart_DeletePersistentHandle(strong);
+  heap->CollectAllGarbage();
+  EXPECT_EQ(3, finalized_count);
+  EXPECT(finalized_peer == NULL);
+  Dart_ShutdownIsolate();
+}
+
+
+// The peer of the handles below is the other handle, which is deleted by the
+// callback before its own callback ran.
+static void DeleteOtherWeakHandle(Dart_Handle handle, void* peer) {
+  finalized_count++;
+  Dart_DeletePersistentHandle(*reinterpret_cast<Dart_Handle*>(peer));
+  Dart_DeletePersistentHandle(handle);
+}
+
+
+UNIT_TEST_CASE(WeakPersistentHandleDeletedByFinalizer) {
+  Dart_CreateIsolate(NULL, NULL);
+  Isolate* isolate = Isolate::Current();
+  ApiState* state = isolate->api_state();
+  static Dart_Handle first = NULL;
+  static Dart_Handle second = NULL;
+  Dart_EnterScope();
+  {
+    Zone zone;
+    HandleScope hs;
+    const String& dead = String::Handle(String::New("dead"));
+    first = Dart_MakeWeakPersistentHandle(Api::NewLocalHandle(dead),
+                                          &second,
+                                          DeleteOtherWeakHandle);
+    second = Dart_MakeWeakPersistentHandle(Api::NewLocalHandle(dead),
+                                           &first,
+                                           DeleteOtherWeakHandle);
+  }
+  Dart_ExitScope();
+
+  // Only the callback run first is called, the other handle is freed once
+  // the queue is drained and reused by the next allocation.
+  finalized_count = 0;
+  isolate->heap()->CollectGarbage(Heap::kNew);
+  EXPECT_EQ(1, finalized_count);
+  EXPECT_EQ(0, state->CountPendingFinalizations());
+  EXPECT(state->weak_persistent_handles().free_list() != NULL);
+  Dart_ShutdownIsolate();
+}
+
+
 // Unit test for creating multiple scopes and local handles within them.
 // Ensure that the local handles get all cleaned out when exiting the
 // scope.
@@ -449,6 +566,52 @@ UNIT_TEST_CASE(Isolates) {
 }
 
 
+static void CountHeapClassStats(void* callback_data,
+                                const char* class_name,
+                                intptr_t instance_count,
+                                intptr_t instance_bytes) {
+  EXPECT(class_name != NULL);
+  EXPECT(instance_count > 0);
+  EXPECT(instance_bytes > 0);
+  intptr_t* totals = reinterpret_cast<intptr_t*>(callback_data);
+  totals[0] += instance_count;
+  totals[1] += instance_bytes;
+}
+
+
+UNIT_TEST_CASE(HeapStats) {
+  Dart_CreateIsolate(NULL, NULL);
+  Dart_HeapStats before;
+  Dart_GetHeapStats(&before);
+  EXPECT(before.new_space.used <= before.new_space.capacity);
+  EXPECT(before.old_space.used <= before.old_space.capacity);
+  EXPECT(before.code_space.used <= before.code_space.capacity);
+
+  Heap* heap = Isolate::Current()->heap();
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kExecutable);
+  Dart_HeapStats after;
+  Dart_GetHeapStats(&after);
+  EXPECT_EQ(before.new_space.collections + 1, after.new_space.collections);
+  EXPECT(after.old_space.collections > before.old_space.collections);
+  EXPECT_EQ(before.code_space.collections + 1, after.code_space.collections);
+  EXPECT(after.new_space.collection_time_micros >=
+         before.new_space.collection_time_micros);
+  EXPECT(after.old_space.collection_time_micros >=
+         before.old_space.collection_time_micros);
+  // Unswept pages are counted as used, the code space is swept eagerly.
+  EXPECT(after.old_space.unswept <= after.old_space.used);
+  EXPECT_EQ(0, after.code_space.unswept);
+  EXPECT_EQ(0, after.new_space.sweep_time_micros);
+
+  intptr_t totals[2] = { 0, 0 };
+  Dart_GetHeapClassStats(&CountHeapClassStats, totals);
+  EXPECT(totals[0] > 0);
+  EXPECT(totals[1] > 0);
+  Dart_ShutdownIsolate();
+}
+
+
 static bool MyPostMessageCallback(Dart_Isolate dest_isolate,
                                   Dart_Port send_port,
                                   Dart_Port reply_port,
@@ -472,7 +635,8 @@ UNIT_TEST_CASE(SetMessageCallbacks) {
 }
 
 
-#if defined(TARGET_ARCH_IA32)  // only ia32 can run execution tests.
+// Only ia32 and x64 can run execution tests.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
 
 UNIT_TEST_CASE(FieldAccess) {
   const char* kScriptChars =
@@ -1729,6 +1893,58 @@ UNIT_TEST_CASE(ImportLibrary5) {
   }
   Dart_ShutdownIsolate();
 }
-#endif  // TARGET_ARCH_IA32.
+
+
+UNIT_TEST_CASE(OldSpaceLimit) {
+  const char* kScriptChars =
+      "class OutOfMemoryHelper {\n"
+      "  static bool fill() {\n"
+      "    List list = new List();\n"
+      "    try {\n"
+      "      while (true) {\n"
+      "        list.add(new List(1024));\n"
+      "      }\n"
+      "    } catch (OutOfMemoryException e) {\n"
+      "      list = null;\n"
+      "      return true;\n"
+      "    }\n"
+      "    return false;\n"
+      "  }\n"
+      "}\n";
+  Dart_Handle result;
+
+  Dart_CreateIsolate(NULL, NULL);
+  {
+    Dart_EnterScope();  // Start a Dart API scope for invoking API functions.
+
+    // Create a test library and Load up a test script in it.
+    Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+
+    Heap* heap = Isolate::Current()->heap();
+    Dart_SetOldSpaceLimit(8 * 1024);
+    EXPECT_EQ(8 * MB, heap->OldSpaceLimit());
+    // Exhausting old space throws a catchable exception.
+    result = Dart_InvokeStatic(lib,
+                               Dart_NewString("OutOfMemoryHelper"),
+                               Dart_NewString("fill"),
+                               0,
+                               NULL);
+    EXPECT(Dart_IsValid(result));
+    EXPECT(!Dart_ExceptionOccurred(result));
+    bool value = false;
+    EXPECT(Dart_IsValid(Dart_BooleanValue(result, &value)));
+    EXPECT(value);
+    EXPECT(heap->is_out_of_memory());
+
+    // The limit is restored once the garbage is collected.
+    heap->CollectAllGarbage();
+    EXPECT(!heap->is_out_of_memory());
+    EXPECT(heap->Capacity(Heap::kOld) <= 8 * MB);
+
+    Dart_ExitScope();  // Exit the Dart API scope.
+  }
+  Dart_ShutdownIsolate();
+}
+#endif  // TARGET_ARCH_IA32 || TARGET_ARCH_X64
 
 }  // namespace dart
@@ -73,7 +73,9 @@ class LocalHandle {
 
 
 // Implementation of persistent handles which are handed out through the
-// dart API.
+// dart API. Weak persistent handles do not keep their object alive, once it
+// is collected the handle is cleared and its callback is queued for
+// finalization.
 class PersistentHandle {
  public:
   enum {
@@ -81,15 +83,44 @@ class PersistentHandle {
     WeakReference,
   };
 
+  // A weak handle whose finalization is queued stays allocated until its
+  // callback ran. Deleting it meanwhile only cancels the callback, the
+  // handle is freed once the queue is drained.
+  enum FinalizationState {
+    kNotQueued = 0,
+    kQueued,
+    kCancelled,
+  };
+
   // Accessors.
   RawObject* raw() const { return raw_; }
   void set_raw(const LocalHandle& ref) { raw_ = ref.raw(); }
   void set_raw(const Object& object) { raw_ = object.raw(); }
   static intptr_t raw_offset() { return OFFSET_OF(PersistentHandle, raw_); }
-  void* callback() const { return callback_; }
-  void set_callback(void* value) { callback_ = value; }
+  void* peer() const { return peer_; }
+  void set_peer(void* value) { peer_ = value; }
+  Dart_WeakPersistentHandleFinalizer callback() const { return callback_; }
+  void set_callback(Dart_WeakPersistentHandleFinalizer value) {
+    callback_ = value;
+  }
   intptr_t type() const { return type_; }
   void set_type(intptr_t value) { type_ = value; }
+  FinalizationState finalization_state() const { return finalization_state_; }
+  void set_finalization_state(FinalizationState value) {
+    finalization_state_ = value;
+  }
+
+  // Clear a weak handle whose object has been collected. Does not allocate
+  // handles, it is called during garbage collection.
+  void Clear() { raw_ = Object::null(); }
+
+  // Call the callback of a weak handle whose object has been collected.
+  void Finalize() {
+    ASSERT(type_ == WeakReference);
+    if (callback_ != NULL) {
+      (*callback_)(reinterpret_cast<Dart_Handle>(this), peer_);
+    }
+  }
 
  private:
   friend class PersistentHandles;
@@ -97,13 +128,13 @@ class PersistentHandle {
   PersistentHandle() { }
   ~PersistentHandle() { }
 
-  // Overload the callback_ field as a next pointer when adding freed
-  // handles to the free list.
+  // Overload the peer_ field as a next pointer when adding freed handles to
+  // the free list.
   PersistentHandle* Next() {
-    return reinterpret_cast<PersistentHandle*>(callback_);
+    return reinterpret_cast<PersistentHandle*>(peer_);
   }
   void SetNext(PersistentHandle* free_list) {
-    callback_ = reinterpret_cast<void*>(free_list);
+    peer_ = reinterpret_cast<void*>(free_list);
   }
   void FreeHandle(PersistentHandle* free_list) {
     raw_ = NULL;
@@ -111,8 +142,10 @@ class PersistentHandle {
   }
 
   RawObject* raw_;
-  void* callback_;
+  void* peer_;
+  Dart_WeakPersistentHandleFinalizer callback_;
   intptr_t type_;
+  FinalizationState finalization_state_;
   DISALLOW_ALLOCATION();  // Allocated through AllocateHandle methods.
   DISALLOW_COPY_AND_ASSIGN(PersistentHandle);
 };
@@ -199,8 +232,10 @@ class PersistentHandles : Handles<kPersistentHandleSizeInWords,
     } else {
       handle = reinterpret_cast<PersistentHandle*>(AllocateScopedHandle());
     }
+    handle->set_peer(NULL);
     handle->set_callback(NULL);
     handle->set_type(PersistentHandle::StrongReference);
+    handle->set_finalization_state(PersistentHandle::kNotQueued);
     return handle;
   }
 
@@ -257,8 +292,15 @@ class ApiLocalScope {
 // basis and destroyed when the isolate is shutdown.
 class ApiState {
  public:
-  ApiState() : top_scope_(NULL), true_(NULL) { }
+  ApiState()
+      : top_scope_(NULL),
+        true_(NULL),
+        finalizations_(NULL),
+        finalization_count_(0),
+        finalization_capacity_(0),
+        running_finalizers_(false) { }
   ~ApiState() {
+    free(finalizations_);
     while (top_scope_ != NULL) {
       ApiLocalScope* scope = top_scope_;
       top_scope_ = top_scope_->previous();
@@ -274,6 +316,9 @@ class ApiState {
   ApiLocalScope* top_scope() const { return top_scope_; }
   void set_top_scope(ApiLocalScope* value) { top_scope_ = value; }
   PersistentHandles& persistent_handles() { return persistent_handles_; }
+  PersistentHandles& weak_persistent_handles() {
+    return weak_persistent_handles_;
+  }
 
   void UnwindScopes(uword sp) {
     while (top_scope_ != NULL && top_scope_->stack_marker() < sp) {
@@ -292,6 +337,68 @@ class ApiState {
     persistent_handles().VisitObjectPointers(visitor);
   }
 
+  // Visit the object pointers of the weak persistent handles. These are not
+  // roots, the garbage collector visits them once it knows which objects
+  // survive. A pointer is at offset 0 of its handle, the visitor can recover
+  // the handle from the address of the pointer.
+  void VisitWeakPersistentHandles(ObjectPointerVisitor* visitor) {
+    weak_persistent_handles().VisitObjectPointers(visitor);
+  }
+
+  // Clear the weak persistent handle whose object has been collected and
+  // queue its callback. The callbacks are run together after the collection
+  // by RunFinalizers.
+  void QueueFinalization(PersistentHandle* handle) {
+    ASSERT(handle->type() == PersistentHandle::WeakReference);
+    handle->Clear();
+    if (finalization_count_ == finalization_capacity_) {
+      finalization_capacity_ = (finalization_capacity_ == 0) ?
+          kInitialFinalizationCapacity : (2 * finalization_capacity_);
+      finalizations_ = reinterpret_cast<PersistentHandle**>(
+          realloc(finalizations_,
+                  finalization_capacity_ * sizeof(finalizations_[0])));
+      if (finalizations_ == NULL) {
+        FATAL("Out of memory queueing a finalization.");
+      }
+    }
+    handle->set_finalization_state(PersistentHandle::kQueued);
+    finalizations_[finalization_count_++] = handle;
+  }
+
+  // Free a weak persistent handle. If its finalization is still queued, its
+  // callback is cancelled and the handle is freed by RunFinalizers instead,
+  // so that it is not reused while in the queue.
+  void FreeWeakPersistentHandle(PersistentHandle* handle) {
+    ASSERT(handle->type() == PersistentHandle::WeakReference);
+    if (handle->finalization_state() == PersistentHandle::kQueued) {
+      handle->set_finalization_state(PersistentHandle::kCancelled);
+    } else {
+      weak_persistent_handles().FreeHandle(handle);
+    }
+  }
+
+  // Run the callbacks queued by the last collections. Callbacks may delete
+  // their handles. Collections triggered by the callbacks queue further
+  // callbacks, which are run by the outermost call.
+  void RunFinalizers() {
+    if (running_finalizers_) {
+      return;
+    }
+    running_finalizers_ = true;
+    while (finalization_count_ > 0) {
+      PersistentHandle* handle = finalizations_[--finalization_count_];
+      if (handle->finalization_state() == PersistentHandle::kCancelled) {
+        weak_persistent_handles().FreeHandle(handle);
+        continue;
+      }
+      // The callback may delete the handle.
+      handle->set_finalization_state(PersistentHandle::kNotQueued);
+      handle->Finalize();
+    }
+    running_finalizers_ = false;
+  }
+  intptr_t CountPendingFinalizations() const { return finalization_count_; }
+
   bool IsValidLocalHandle(Dart_Handle object) const {
     ApiLocalScope* scope = top_scope_;
     while (scope != NULL) {
@@ -303,7 +410,8 @@ class ApiState {
     return false;
   }
   bool IsValidPersistentHandle(Dart_Handle object) const {
-    return persistent_handles_.IsValidHandle(object);
+    return persistent_handles_.IsValidHandle(object) ||
+        weak_persistent_handles_.IsValidHandle(object);
   }
 
   int CountLocalHandles() const {
@@ -318,6 +426,9 @@ class ApiState {
   int CountPersistentHandles() const {
     return persistent_handles_.CountHandles();
   }
+  int CountWeakPersistentHandles() const {
+    return weak_persistent_handles_.CountHandles();
+  }
   int ZoneSizeInBytes() const {
     int total = 0;
     ApiLocalScope* scope = top_scope_;
@@ -340,12 +451,21 @@ class ApiState {
   }
 
  private:
+  static const intptr_t kInitialFinalizationCapacity = 16;
+
   PersistentHandles persistent_handles_;
+  PersistentHandles weak_persistent_handles_;
   ApiLocalScope* top_scope_;
 
   // A persistent handle to the "True" object.
   PersistentHandle* true_;
 
+  // The weak persistent handles whose callbacks are still to be run.
+  PersistentHandle** finalizations_;
+  intptr_t finalization_count_;
+  intptr_t finalization_capacity_;
+  bool running_finalizers_;
+
   DISALLOW_COPY_AND_ASSIGN(ApiState);
 };
 
@@ -7,7 +7,10 @@
 #include "vm/cpu.h"
 #include "vm/dart_entry.h"
 #include "vm/flags.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
 #include "vm/object.h"
+#include "vm/object_store.h"
 #include "vm/stack_frame.h"
 
 namespace dart {
@@ -154,9 +157,32 @@ RawInstance* Exceptions::Create(
     case kIllegalJSRegExp:
       class_name = String::NewSymbol("IllegalJSRegExpException");
       break;
+    case kOutOfMemory:
+      class_name = String::NewSymbol("OutOfMemoryException");
+      break;
   }
 
   return DartLibraryCalls::ExceptionCreate(class_name, arguments);
 }
 
+
+void Exceptions::ThrowPendingOutOfMemory() {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  if (!heap->has_pending_out_of_memory()) {
+    return;
+  }
+  // Creating the exception runs Dart code, which must not throw it again.
+  heap->clear_pending_out_of_memory();
+  ObjectStore* object_store = isolate->object_store();
+  Instance& exception = Instance::Handle(object_store->out_of_memory());
+  if (exception.IsNull()) {
+    GrowableArray<const Object*> arguments;
+    exception = Create(kOutOfMemory, arguments);
+    object_store->set_out_of_memory(exception);
+  }
+  ASSERT(isolate->top_exit_frame_info() != 0);
+  Throw(exception);
+}
+
 }  // namespace dart
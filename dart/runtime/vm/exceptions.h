@@ -32,6 +32,7 @@ class Exceptions : AllStatic {
     kInternalError,
     kNullPointer,
     kIllegalJSRegExp,
+    kOutOfMemory,
   };
 
   static void ThrowByType(ExceptionType type,
@@ -39,6 +40,12 @@ class Exceptions : AllStatic {
   static RawInstance* Create(ExceptionType type,
                              const GrowableArray<const Object*>& arguments);
 
+  // Throws an OutOfMemoryException to the Dart code of the current isolate if
+  // an allocation was served from the heap reserve since the last call, see
+  // Heap::AllocateFromReserve. Called by runtime and native entries once
+  // their helper returned.
+  static void ThrowPendingOutOfMemory();
+
  private:
   DISALLOW_COPY_AND_ASSIGN(Exceptions);
 };
@@ -10,7 +10,8 @@
 
 namespace dart {
 
-#if defined(TARGET_ARCH_IA32)  // only ia32 can run exception tests.
+// Only ia32 and x64 can run exception tests.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
 #define FUNCTION_NAME(name) UnhandledExcp_##name
 #define REGISTER_FUNCTION(name, count)                                         \
   { ""#name, FUNCTION_NAME(name), count },
@@ -134,6 +135,6 @@ TEST_CASE(UnhandledExceptions) {
                     0,
                     NULL);
 }
-#endif  // TARGET_ARCH_IA32.
+#endif  // TARGET_ARCH_IA32 || TARGET_ARCH_X64
 
 }  // namespace dart
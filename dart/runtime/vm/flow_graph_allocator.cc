@@ -0,0 +1,409 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/flow_graph_allocator.h"
+
+#include "vm/flags.h"
+#include "vm/flow_graph_builder.h"
+#include "vm/os.h"
+#include "vm/parser.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, use_register_allocator, true,
+    "Keep values in registers in optimized code.");
+DEFINE_FLAG(bool, trace_register_allocation, false,
+    "Trace the live ranges and locations of the values.");
+
+
+class FlowGraphAllocator::LiveRange : public ZoneAllocated {
+ public:
+  explicit LiveRange(Definition* definition)
+      : definition_(definition),
+        start_(-1),
+        end_(-1),
+        register_index_(-1) { }
+
+  Definition* definition() const { return definition_; }
+  intptr_t start() const { return start_; }
+  intptr_t end() const { return end_; }
+
+  void Extend(intptr_t position) {
+    if ((start_ < 0) || (position < start_)) start_ = position;
+    if (position > end_) end_ = position;
+  }
+
+  // Index into the allocatable registers, or -1 if spilled.
+  intptr_t register_index() const { return register_index_; }
+  void set_register_index(intptr_t index) { register_index_ = index; }
+
+ private:
+  Definition* definition_;
+  intptr_t start_;
+  intptr_t end_;
+  intptr_t register_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(LiveRange);
+};
+
+
+FlowGraphAllocator::FlowGraphAllocator(const FlowGraph& flow_graph,
+                                       const Register* registers,
+                                       intptr_t register_count)
+    : flow_graph_(flow_graph),
+      registers_(registers),
+      register_count_(FLAG_use_register_allocator ? register_count : 0),
+      call_positions_(),
+      block_end_positions_(flow_graph.postorder().length()),
+      live_in_(flow_graph.postorder().length()),
+      live_out_(flow_graph.postorder().length()),
+      live_ranges_(flow_graph.ssa_temp_count()),
+      spill_slot_count_(0) {
+}
+
+
+void FlowGraphAllocator::AllocateRegisters() {
+  NumberInstructions();
+  ComputeLiveness();
+  BuildLiveRanges();
+  AllocateLinearScan();
+  if (FLAG_trace_register_allocation) {
+    PrintLiveRanges();
+  }
+}
+
+
+// Numbers the block entries and instructions in the order they are emitted,
+// i.e., in reverse postorder.
+void FlowGraphAllocator::NumberInstructions() {
+  const GrowableArray<BlockEntryInstr*>& postorder = flow_graph_.postorder();
+  for (intptr_t i = 0; i < postorder.length(); i++) {
+    block_end_positions_.Add(-1);
+  }
+  intptr_t position = 0;
+  for (intptr_t i = postorder.length() - 1; i >= 0; i--) {
+    BlockEntryInstr* block = postorder[i];
+    block->set_lifetime_position(position++);
+    for (Instruction* instr = block->next();
+         instr != NULL;
+         instr = instr->next()) {
+      if (instr->HasCall()) {
+        call_positions_.Add(position);
+      }
+      instr->set_lifetime_position(position++);
+    }
+    block_end_positions_[block->postorder_number()] = position - 1;
+  }
+}
+
+
+static ZoneGrowableArray<bool>* NewLiveSet(intptr_t length) {
+  ZoneGrowableArray<bool>* set = new ZoneGrowableArray<bool>(length);
+  for (intptr_t i = 0; i < length; i++) {
+    set->Add(false);
+  }
+  return set;
+}
+
+
+// Adds the non-constant value to 'set' unless it is defined in the block,
+// i.e., it is in 'kill'.
+static void AddUse(Value* value,
+                   const ZoneGrowableArray<bool>& kill,
+                   ZoneGrowableArray<bool>* set) {
+  Definition* definition = value->definition();
+  if (definition->HasSSATemp() && !kill[definition->ssa_temp_index()]) {
+    (*set)[definition->ssa_temp_index()] = true;
+  }
+}
+
+
+// Backward data flow analysis of the live values at the entry and exit of
+// every block. The inputs of the phis of a join are live at the exit of the
+// corresponding predecessor, not at the entry of the join.
+void FlowGraphAllocator::ComputeLiveness() {
+  const GrowableArray<BlockEntryInstr*>& postorder = flow_graph_.postorder();
+  const intptr_t value_count = flow_graph_.ssa_temp_count();
+  GrowableArray<ZoneGrowableArray<bool>*> gen(postorder.length());
+  GrowableArray<ZoneGrowableArray<bool>*> kill(postorder.length());
+  GrowableArray<ZoneGrowableArray<bool>*> phi_uses(postorder.length());
+  for (intptr_t i = 0; i < postorder.length(); i++) {
+    live_in_.Add(NewLiveSet(value_count));
+    live_out_.Add(NewLiveSet(value_count));
+    gen.Add(NewLiveSet(value_count));
+    kill.Add(NewLiveSet(value_count));
+    phi_uses.Add(NewLiveSet(value_count));
+  }
+  // Phi inputs are live at the end of the predecessor, even if defined in it.
+  const ZoneGrowableArray<bool>& none = *NewLiveSet(value_count);
+
+  for (intptr_t i = 0; i < postorder.length(); i++) {
+    BlockEntryInstr* block = postorder[i];
+    ASSERT(block->postorder_number() == i);
+    JoinEntryInstr* join = block->AsJoinEntry();
+    if ((join != NULL) && (join->phis() != NULL)) {
+      for (intptr_t j = 0; j < join->phis()->length(); j++) {
+        (*kill[i])[(*join->phis())[j]->ssa_temp_index()] = true;
+      }
+    }
+    for (Instruction* instr = block->next();
+         instr != NULL;
+         instr = instr->next()) {
+      for (intptr_t j = 0; j < instr->InputCount(); j++) {
+        AddUse(instr->InputAt(j), *kill[i], gen[i]);
+      }
+      Environment* env = instr->env();
+      if (env != NULL) {
+        for (intptr_t j = 0; j < env->LocalCount(); j++) {
+          AddUse(env->LocalAt(j), *kill[i], gen[i]);
+        }
+        for (intptr_t j = 0; j < env->StackCount(); j++) {
+          AddUse(env->StackAt(j), *kill[i], gen[i]);
+        }
+      }
+      Definition* definition = instr->AsDefinition();
+      if ((definition != NULL) && definition->HasSSATemp()) {
+        (*kill[i])[definition->ssa_temp_index()] = true;
+      }
+      GotoInstr* goto_instr = instr->AsGoto();
+      if ((goto_instr != NULL) && (goto_instr->successor()->phis() != NULL)) {
+        JoinEntryInstr* successor = goto_instr->successor();
+        const intptr_t index = successor->IndexOfPredecessor(block);
+        for (intptr_t j = 0; j < successor->phis()->length(); j++) {
+          PhiInstr* phi = (*successor->phis())[j];
+          AddUse(phi->InputAt(index), none, phi_uses[i]);
+        }
+      }
+    }
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (intptr_t i = 0; i < postorder.length(); i++) {
+      BlockEntryInstr* block = postorder[i];
+      ZoneGrowableArray<bool>* live_out = live_out_[i];
+      ZoneGrowableArray<bool>* live_in = live_in_[i];
+      Instruction* last = block->last_instruction();
+      for (intptr_t v = 0; v < value_count; v++) {
+        bool out = (*phi_uses[i])[v];
+        for (intptr_t j = 0; !out && (j < last->SuccessorCount()); j++) {
+          out = (*live_in_[last->SuccessorAt(j)->postorder_number()])[v];
+        }
+        const bool in = (*gen[i])[v] || (out && !(*kill[i])[v]);
+        if ((out != (*live_out)[v]) || (in != (*live_in)[v])) {
+          (*live_out)[v] = out;
+          (*live_in)[v] = in;
+          changed = true;
+        }
+      }
+    }
+  }
+}
+
+
+void FlowGraphAllocator::ExtendLiveRange(Definition* definition,
+                                         intptr_t position) {
+  ASSERT(definition != NULL);
+  if (!definition->HasSSATemp()) {
+    return;
+  }
+  const intptr_t index = definition->ssa_temp_index();
+  if (live_ranges_[index] == NULL) {
+    live_ranges_[index] = new LiveRange(definition);
+  }
+  live_ranges_[index]->Extend(position);
+}
+
+
+void FlowGraphAllocator::ExtendLiveRange(Value* value, intptr_t position) {
+  ExtendLiveRange(value->definition(), position);
+}
+
+
+// The live range of a value covers every position where it is live. A phi is
+// written at the end of each predecessor of its block.
+void FlowGraphAllocator::BuildLiveRanges() {
+  const GrowableArray<BlockEntryInstr*>& postorder = flow_graph_.postorder();
+  const intptr_t value_count = flow_graph_.ssa_temp_count();
+  GrowableArray<Definition*> definitions(value_count);
+  for (intptr_t i = 0; i < value_count; i++) {
+    live_ranges_.Add(NULL);
+    definitions.Add(NULL);
+  }
+  for (intptr_t i = 0; i < postorder.length(); i++) {
+    BlockEntryInstr* block = postorder[i];
+    JoinEntryInstr* join = block->AsJoinEntry();
+    if ((join != NULL) && (join->phis() != NULL)) {
+      for (intptr_t j = 0; j < join->phis()->length(); j++) {
+        PhiInstr* phi = (*join->phis())[j];
+        definitions[phi->ssa_temp_index()] = phi;
+        if (phi->use_count() == 0) continue;
+        ExtendLiveRange(phi, join->lifetime_position());
+        for (intptr_t k = 0; k < join->PredecessorCount(); k++) {
+          BlockEntryInstr* predecessor = join->PredecessorAt(k);
+          ExtendLiveRange(
+              phi, block_end_positions_[predecessor->postorder_number()]);
+        }
+      }
+    }
+    for (Instruction* instr = block->next();
+         instr != NULL;
+         instr = instr->next()) {
+      const intptr_t position = instr->lifetime_position();
+      Definition* definition = instr->AsDefinition();
+      if ((definition != NULL) && definition->HasSSATemp()) {
+        definitions[definition->ssa_temp_index()] = definition;
+        if (definition->use_count() > 0) {
+          ExtendLiveRange(definition, position);
+        }
+      }
+      for (intptr_t j = 0; j < instr->InputCount(); j++) {
+        ExtendLiveRange(instr->InputAt(j), position);
+      }
+      Environment* env = instr->env();
+      if (env != NULL) {
+        for (intptr_t j = 0; j < env->LocalCount(); j++) {
+          ExtendLiveRange(env->LocalAt(j), position);
+        }
+        for (intptr_t j = 0; j < env->StackCount(); j++) {
+          ExtendLiveRange(env->StackAt(j), position);
+        }
+      }
+    }
+  }
+  for (intptr_t i = 0; i < postorder.length(); i++) {
+    const intptr_t start = postorder[i]->lifetime_position();
+    const intptr_t end = block_end_positions_[i];
+    for (intptr_t v = 0; v < value_count; v++) {
+      if ((*live_in_[i])[v]) {
+        ExtendLiveRange(definitions[v], start);
+      }
+      if ((*live_out_[i])[v]) {
+        ExtendLiveRange(definitions[v], end);
+      }
+    }
+  }
+}
+
+
+// Values used or defined by a call are only in registers if their live
+// range starts at the call, i.e., for the result of the call.
+bool FlowGraphAllocator::IsLiveAcrossCall(LiveRange* range) const {
+  for (intptr_t i = 0; i < call_positions_.length(); i++) {
+    const intptr_t position = call_positions_[i];
+    if (position > range->end()) {
+      return false;
+    }
+    if (position > range->start()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void FlowGraphAllocator::Spill(LiveRange* range) {
+  range->set_register_index(-1);
+  range->definition()->set_location(
+      Location::StackSlot(spill_slot_count_++));
+}
+
+
+int FlowGraphAllocator::CompareLiveRangeStart(LiveRange* const* a,
+                                              LiveRange* const* b) {
+  return (*a)->start() - (*b)->start();
+}
+
+
+void FlowGraphAllocator::AllocateLinearScan() {
+  GrowableArray<LiveRange*> unhandled;
+  for (intptr_t i = 0; i < live_ranges_.length(); i++) {
+    if (live_ranges_[i] != NULL) {
+      unhandled.Add(live_ranges_[i]);
+    }
+  }
+  unhandled.Sort(CompareLiveRangeStart);
+
+  // The ranges holding a register, in increasing order of their end.
+  GrowableArray<LiveRange*> active;
+  GrowableArray<bool> is_free(register_count_);
+  for (intptr_t i = 0; i < register_count_; i++) {
+    is_free.Add(true);
+  }
+  for (intptr_t i = 0; i < unhandled.length(); i++) {
+    LiveRange* range = unhandled[i];
+    // Free the registers of the ranges ending before this one starts. A
+    // range ending at the instruction defining the value of this range
+    // may share its register: instructions write their result last.
+    intptr_t expired = 0;
+    while ((expired < active.length()) &&
+           (active[expired]->end() <= range->start())) {
+      is_free[active[expired]->register_index()] = true;
+      expired++;
+    }
+    for (intptr_t j = expired; j < active.length(); j++) {
+      active[j - expired] = active[j];
+    }
+    for (intptr_t j = 0; j < expired; j++) {
+      active.RemoveLast();
+    }
+
+    if (IsLiveAcrossCall(range)) {
+      Spill(range);
+      continue;
+    }
+    intptr_t register_index = -1;
+    for (intptr_t j = 0; j < register_count_; j++) {
+      if (is_free[j]) {
+        register_index = j;
+        break;
+      }
+    }
+    if (register_index < 0) {
+      // Spill the active range ending last, if it ends after this one.
+      if (active.is_empty() || (active.Last()->end() <= range->end())) {
+        Spill(range);
+        continue;
+      }
+      LiveRange* spilled = active.Last();
+      active.RemoveLast();
+      register_index = spilled->register_index();
+      Spill(spilled);
+    }
+    is_free[register_index] = false;
+    range->set_register_index(register_index);
+    range->definition()->set_location(
+        Location::RegisterLocation(registers_[register_index]));
+    // Keep the active ranges sorted by their end.
+    active.Add(range);
+    intptr_t j = active.length() - 1;
+    while ((j > 0) && (active[j - 1]->end() > range->end())) {
+      active[j] = active[j - 1];
+      j--;
+    }
+    active[j] = range;
+  }
+}
+
+
+void FlowGraphAllocator::PrintLiveRanges() const {
+  OS::Print("Live ranges of '%s':\n",
+            flow_graph_.parsed_function().function().ToFullyQualifiedCString());
+  for (intptr_t i = 0; i < live_ranges_.length(); i++) {
+    LiveRange* range = live_ranges_[i];
+    if (range == NULL) continue;
+    const Location& location = range->definition()->location();
+    if (location.IsRegister()) {
+      OS::Print("  v%d [%d, %d]: register %d\n",
+                i, range->start(), range->end(), location.reg());
+    } else {
+      OS::Print("  v%d [%d, %d]: spill slot %d\n",
+                i, range->start(), range->end(), location.stack_index());
+    }
+  }
+  OS::Print("  %d spill slots\n", spill_slot_count_);
+}
+
+}  // namespace dart
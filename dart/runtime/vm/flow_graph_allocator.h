@@ -0,0 +1,67 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_FLOW_GRAPH_ALLOCATOR_H_
+#define VM_FLOW_GRAPH_ALLOCATOR_H_
+
+#include "vm/allocation.h"
+#include "vm/growable_array.h"
+#include "vm/intermediate_language.h"
+#include "vm/locations.h"
+
+namespace dart {
+
+// Forward declarations.
+class FlowGraph;
+
+// Linear scan register allocation (Poletto and Sarkar) of the SSA values of
+// a flow graph. The live range of a value is the hull of the positions, in
+// the reverse postorder of the blocks, where the value is live; uses in
+// deoptimization environments keep values alive. No register is preserved
+// across calls, so values live across a call are spilled. When registers
+// run out, the value whose live range ends last is spilled. Every value gets
+// a location: one of 'registers' or a spill slot numbered from 0.
+class FlowGraphAllocator : public ValueObject {
+ public:
+  FlowGraphAllocator(const FlowGraph& flow_graph,
+                     const Register* registers,
+                     intptr_t register_count);
+
+  void AllocateRegisters();
+
+  intptr_t spill_slot_count() const { return spill_slot_count_; }
+
+ private:
+  class LiveRange;
+
+  static int CompareLiveRangeStart(LiveRange* const* a, LiveRange* const* b);
+  void NumberInstructions();
+  void ComputeLiveness();
+  void BuildLiveRanges();
+  void ExtendLiveRange(Definition* definition, intptr_t position);
+  void ExtendLiveRange(Value* value, intptr_t position);
+  bool IsLiveAcrossCall(LiveRange* range) const;
+  void AllocateLinearScan();
+  void Spill(LiveRange* range);
+  void PrintLiveRanges() const;
+
+  const FlowGraph& flow_graph_;
+  const Register* registers_;
+  const intptr_t register_count_;
+  // Positions of the calls, in increasing order.
+  GrowableArray<intptr_t> call_positions_;
+  // Indexed by the postorder number of the blocks.
+  GrowableArray<intptr_t> block_end_positions_;
+  GrowableArray<ZoneGrowableArray<bool>*> live_in_;
+  GrowableArray<ZoneGrowableArray<bool>*> live_out_;
+  // Indexed by the SSA temp index of the values.
+  GrowableArray<LiveRange*> live_ranges_;
+  intptr_t spill_slot_count_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(FlowGraphAllocator);
+};
+
+}  // namespace dart
+
+#endif  // VM_FLOW_GRAPH_ALLOCATOR_H_
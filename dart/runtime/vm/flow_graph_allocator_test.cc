@@ -0,0 +1,246 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/flow_graph_allocator.h"
+
+#include "vm/assert.h"
+#include "vm/class_finalizer.h"
+#include "vm/compiler.h"
+#include "vm/dart_entry.h"
+#include "vm/flags.h"
+#include "vm/flow_graph_builder.h"
+#include "vm/object.h"
+#include "vm/parser.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(bool, use_ssa);
+
+// The flow graph compiler is only implemented on IA32 now.
+#if defined(TARGET_ARCH_IA32)
+
+static RawFunction* CompileScriptAndLookup(const char* script_chars,
+                                           const char* function_name) {
+  String& url = String::Handle(String::New("dart-test:FlowGraphAllocator"));
+  String& source = String::Handle(String::New(script_chars));
+  Script& script = Script::Handle(Script::New(url, source, RawScript::kSource));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  EXPECT(ClassFinalizer::FinalizePendingClasses());
+  Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(String::NewSymbol("A"))));
+  EXPECT(!cls.IsNull());
+  return cls.LookupStaticFunction(String::Handle(String::New(function_name)));
+}
+
+
+// The flow graph refers to 'parsed_function', which must outlive it.
+static FlowGraph* BuildGraph(ParsedFunction* parsed_function) {
+  Parser::ParseFunction(parsed_function);
+  FlowGraphBuilder builder(*parsed_function);
+  return builder.BuildGraph();
+}
+
+
+// A phi is defined at the entry of its block.
+static intptr_t DefinitionPosition(Definition* definition) {
+  PhiInstr* phi = definition->AsPhi();
+  return (phi != NULL) ?
+      phi->block()->lifetime_position() : definition->lifetime_position();
+}
+
+
+// Checks that no call is between the definition of a value in a register and
+// its use at 'position'. A call using the value counts as being in between,
+// it preserves no registers.
+static void CheckUse(const GrowableArray<intptr_t>& call_positions,
+                     Value* value,
+                     intptr_t position) {
+  Definition* definition = value->definition();
+  if (!definition->location().IsRegister()) return;
+  const intptr_t start = DefinitionPosition(definition);
+  for (intptr_t i = 0; i < call_positions.length(); i++) {
+    EXPECT((call_positions[i] <= start) || (call_positions[i] > position));
+  }
+}
+
+
+// Checks that every used value has a location and that no value in a
+// register is live across a call, using the positions numbered by the
+// register allocator.
+static void CheckLocations(const FlowGraph& flow_graph,
+                           intptr_t spill_slot_count) {
+  const GrowableArray<BlockEntryInstr*>& blocks = flow_graph.preorder();
+  GrowableArray<intptr_t> call_positions;
+  for (intptr_t i = 0; i < blocks.length(); i++) {
+    for (Instruction* instr = blocks[i]->next();
+         instr != NULL;
+         instr = instr->next()) {
+      if (instr->HasCall()) {
+        call_positions.Add(instr->lifetime_position());
+      }
+    }
+  }
+  EXPECT(call_positions.length() > 0);
+  for (intptr_t i = 0; i < blocks.length(); i++) {
+    JoinEntryInstr* join = blocks[i]->AsJoinEntry();
+    if ((join != NULL) && (join->phis() != NULL)) {
+      for (intptr_t j = 0; j < join->phis()->length(); j++) {
+        PhiInstr* phi = (*join->phis())[j];
+        EXPECT(!phi->location().IsInvalid());
+        // The inputs of a phi are used at the end of the predecessors.
+        for (intptr_t k = 0; k < phi->InputCount(); k++) {
+          BlockEntryInstr* predecessor = join->PredecessorAt(k);
+          CheckUse(call_positions,
+                   phi->InputAt(k),
+                   predecessor->last_instruction()->lifetime_position());
+        }
+      }
+    }
+    for (Instruction* instr = blocks[i]->next();
+         instr != NULL;
+         instr = instr->next()) {
+      const intptr_t position = instr->lifetime_position();
+      for (intptr_t j = 0; j < instr->InputCount(); j++) {
+        CheckUse(call_positions, instr->InputAt(j), position);
+      }
+      Environment* env = instr->env();
+      if (env != NULL) {
+        for (intptr_t j = 0; j < env->LocalCount(); j++) {
+          CheckUse(call_positions, env->LocalAt(j), position);
+        }
+        for (intptr_t j = 0; j < env->StackCount(); j++) {
+          CheckUse(call_positions, env->StackAt(j), position);
+        }
+      }
+      // Constants have no location.
+      Definition* definition = instr->AsDefinition();
+      if ((definition == NULL) ||
+          !definition->HasSSATemp() ||
+          (definition->use_count() == 0)) {
+        continue;
+      }
+      const Location& location = definition->location();
+      EXPECT(!location.IsInvalid());
+      if (location.IsStackSlot()) {
+        EXPECT(location.stack_index() < spill_slot_count);
+      }
+    }
+  }
+}
+
+
+TEST_CASE(FlowGraphAllocator_Loop) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static sum(n) {\n"
+      "    var s = 0;\n"
+      "    for (var i = 0; i < n; i++) {\n"
+      "      s = s + i;\n"
+      "    }\n"
+      "    return s;\n"
+      "  }\n"
+      "}\n";
+  const Function& function =
+      Function::ZoneHandle(CompileScriptAndLookup(kScriptChars, "sum"));
+  EXPECT(!function.IsNull());
+  ParsedFunction parsed_function(function);
+  FlowGraph* flow_graph = BuildGraph(&parsed_function);
+  EXPECT(flow_graph != NULL);
+  static const Register kRegisters[] = { EBX, EDI };
+  FlowGraphAllocator allocator(*flow_graph, kRegisters, 2);
+  allocator.AllocateRegisters();
+  CheckLocations(*flow_graph, allocator.spill_slot_count());
+}
+
+
+TEST_CASE(FlowGraphAllocator_NoRegisters) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static foo(a, b) {\n"
+      "    var c = a + b;\n"
+      "    return c - a;\n"
+      "  }\n"
+      "}\n";
+  const Function& function =
+      Function::ZoneHandle(CompileScriptAndLookup(kScriptChars, "foo"));
+  EXPECT(!function.IsNull());
+  ParsedFunction parsed_function(function);
+  FlowGraph* flow_graph = BuildGraph(&parsed_function);
+  EXPECT(flow_graph != NULL);
+  FlowGraphAllocator allocator(*flow_graph, NULL, 0);
+  allocator.AllocateRegisters();
+  EXPECT(allocator.spill_slot_count() > 0);
+  CheckLocations(*flow_graph, allocator.spill_slot_count());
+}
+
+
+static RawInstance* Invoke(const Function& function,
+                           const Object& arg0,
+                           const Object& arg1) {
+  GrowableArray<const Object*> arguments;
+  arguments.Add(&arg0);
+  arguments.Add(&arg1);
+  const Array& kNoArgumentNames = Array::Handle();
+  return DartEntry::InvokeStatic(function, arguments, kNoArgumentNames);
+}
+
+
+// More values are live at once than there are registers, also across the
+// loop and the call in it. The allocated code computes the same results as
+// the unoptimized code.
+TEST_CASE(FlowGraphAllocator_RunWithSpilledValues) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static id(x) { return x; }\n"
+      "  static many(a, b) {\n"
+      "    var c = a + b;\n"
+      "    var d = a - b;\n"
+      "    var e = a * 3;\n"
+      "    var f = b * 5;\n"
+      "    var s = 0;\n"
+      "    for (var i = 0; i < a; i = i + 1) {\n"
+      "      s = s + c - d + (e ^ i) - (f & i);\n"
+      "      s = s + id(i);\n"
+      "    }\n"
+      "    return s + a + b + c + d + e + f;\n"
+      "  }\n"
+      "}\n";
+  const Function& function =
+      Function::ZoneHandle(CompileScriptAndLookup(kScriptChars, "many"));
+  EXPECT(!function.IsNull());
+  const Smi& ten = Smi::Handle(Smi::New(10));
+  const Smi& three = Smi::Handle(Smi::New(3));
+  const Smi& minus_seven = Smi::Handle(Smi::New(-7));
+  const Instance& expected0 = Instance::Handle(Invoke(function, ten, three));
+  const Instance& expected1 =
+      Instance::Handle(Invoke(function, three, minus_seven));
+  EXPECT(expected0.IsSmi() && expected1.IsSmi());
+
+  ParsedFunction parsed_function(function);
+  FlowGraph* flow_graph = BuildGraph(&parsed_function);
+  EXPECT(flow_graph != NULL);
+  static const Register kRegisters[] = { EBX, EDI };
+  FlowGraphAllocator allocator(*flow_graph, kRegisters, 2);
+  allocator.AllocateRegisters();
+  EXPECT(allocator.spill_slot_count() > 2);
+  CheckLocations(*flow_graph, allocator.spill_slot_count());
+
+  const bool saved_use_ssa = FLAG_use_ssa;
+  FLAG_use_ssa = true;
+  Compiler::CompileOptimizedFunction(function);
+  FLAG_use_ssa = saved_use_ssa;
+  EXPECT(Code::Handle(function.code()).is_optimized());
+  Instance& result = Instance::Handle(Invoke(function, ten, three));
+  EXPECT(result.Equals(expected0));
+  result = Invoke(function, three, minus_seven);
+  EXPECT(result.Equals(expected1));
+  EXPECT(Code::Handle(function.code()).is_optimized());
+  EXPECT_EQ(0, function.deoptimization_counter());
+}
+
+#endif  // TARGET_ARCH_IA32
+
+}  // namespace dart
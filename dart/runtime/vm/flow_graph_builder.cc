@@ -0,0 +1,1288 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/flow_graph_builder.h"
+
+#include "vm/flags.h"
+#include "vm/os.h"
+#include "vm/parser.h"
+#include "vm/scopes.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, print_flow_graph, false, "Print the SSA flow graph.");
+DECLARE_FLAG(bool, enable_type_checks);
+DECLARE_FLAG(bool, trace_functions);
+
+
+FlowGraph::FlowGraph(const ParsedFunction& parsed_function,
+                     GraphEntryInstr* graph_entry,
+                     const GrowableArray<const LocalVariable*>& variables)
+    : parsed_function_(parsed_function),
+      graph_entry_(graph_entry),
+      variables_(variables.length()),
+      preorder_(),
+      postorder_(),
+      ssa_temp_count_(0) {
+  for (intptr_t i = 0; i < variables.length(); i++) {
+    variables_.Add(variables[i]);
+  }
+}
+
+
+void FlowGraph::DiscoverBlocks() {
+  for (intptr_t i = 0; i < preorder_.length(); i++) {
+    preorder_[i]->ClearNumbering();
+  }
+  preorder_.Clear();
+  postorder_.Clear();
+  graph_entry_->DiscoverBlocks(&preorder_, &postorder_);
+}
+
+
+// Walks up the dominator tree from 'block1' and 'block2' until both meet.
+// Only blocks whose immediate dominator is already known are visited.
+static BlockEntryInstr* IntersectDominators(
+    BlockEntryInstr* block1,
+    BlockEntryInstr* block2,
+    const GrowableArray<BlockEntryInstr*>& idom) {
+  while (block1 != block2) {
+    while (block1->postorder_number() < block2->postorder_number()) {
+      block1 = idom[block1->postorder_number()];
+    }
+    while (block2->postorder_number() < block1->postorder_number()) {
+      block2 = idom[block2->postorder_number()];
+    }
+  }
+  return block1;
+}
+
+
+// Iterative dominator computation of Cooper, Harvey and Kennedy, "A Simple,
+// Fast Dominance Algorithm". The dominance frontier is indexed by the
+// preorder number of the blocks.
+void FlowGraph::ComputeDominators(
+    GrowableArray<ZoneGrowableArray<BlockEntryInstr*>*>* dominance_frontier) {
+  const intptr_t size = postorder_.length();
+  ASSERT(postorder_[size - 1] == graph_entry_);
+  GrowableArray<BlockEntryInstr*> idom(size);
+  for (intptr_t i = 0; i < size; i++) {
+    idom.Add(NULL);
+  }
+  idom[size - 1] = graph_entry_;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    // Visit all blocks but the graph entry in reverse postorder.
+    for (intptr_t i = size - 2; i >= 0; i--) {
+      BlockEntryInstr* block = postorder_[i];
+      BlockEntryInstr* new_idom = NULL;
+      for (intptr_t j = 0; j < block->PredecessorCount(); j++) {
+        BlockEntryInstr* predecessor = block->PredecessorAt(j);
+        if (idom[predecessor->postorder_number()] == NULL) continue;
+        new_idom = (new_idom == NULL)
+            ? predecessor
+            : IntersectDominators(predecessor, new_idom, idom);
+      }
+      ASSERT(new_idom != NULL);
+      if (idom[i] != new_idom) {
+        idom[i] = new_idom;
+        changed = true;
+      }
+    }
+  }
+
+  for (intptr_t i = 0; i < preorder_.length(); i++) {
+    BlockEntryInstr* block = preorder_[i];
+    if (block != graph_entry_) {
+      BlockEntryInstr* dominator = idom[block->postorder_number()];
+      block->set_dominator(dominator);
+      dominator->AddDominatedBlock(block);
+    }
+    dominance_frontier->Add(new ZoneGrowableArray<BlockEntryInstr*>());
+  }
+
+  // A join is in the dominance frontier of every block on the dominator tree
+  // paths from its predecessors up to, but excluding, its dominator.
+  for (intptr_t i = 0; i < preorder_.length(); i++) {
+    BlockEntryInstr* block = preorder_[i];
+    if (block->PredecessorCount() < 2) continue;
+    for (intptr_t j = 0; j < block->PredecessorCount(); j++) {
+      BlockEntryInstr* runner = block->PredecessorAt(j);
+      while (runner != block->dominator()) {
+        ZoneGrowableArray<BlockEntryInstr*>* frontier =
+            (*dominance_frontier)[runner->preorder_number()];
+        if (frontier->is_empty() || (frontier->Last() != block)) {
+          frontier->Add(block);
+        }
+        runner = runner->dominator();
+      }
+    }
+  }
+}
+
+
+void FlowGraph::InsertPhis(
+    const GrowableArray<ZoneGrowableArray<BlockEntryInstr*>*>&
+        dominance_frontier) {
+  const intptr_t block_count = preorder_.length();
+  const intptr_t variable_count = variables_.length();
+
+  // Collect the blocks assigning each variable.
+  GrowableArray<ZoneGrowableArray<BlockEntryInstr*>*> assigning_blocks(
+      variable_count);
+  for (intptr_t i = 0; i < variable_count; i++) {
+    assigning_blocks.Add(new ZoneGrowableArray<BlockEntryInstr*>());
+  }
+  for (intptr_t i = 0; i < block_count; i++) {
+    BlockEntryInstr* block = preorder_[i];
+    for (Instruction* instr = block->next();
+         instr != NULL;
+         instr = instr->next()) {
+      StoreLocalInstr* store = instr->AsStoreLocal();
+      if (store == NULL) continue;
+      ZoneGrowableArray<BlockEntryInstr*>* blocks =
+          assigning_blocks[store->variable_index()];
+      if (blocks->is_empty() || (blocks->Last() != block)) {
+        blocks->Add(block);
+      }
+    }
+  }
+
+  // Insert phis at the iterated dominance frontier of the assigning blocks.
+  // 'has_phi' and 'in_worklist' hold the last variable processed per block.
+  GrowableArray<intptr_t> has_phi(block_count);
+  GrowableArray<intptr_t> in_worklist(block_count);
+  for (intptr_t i = 0; i < block_count; i++) {
+    has_phi.Add(-1);
+    in_worklist.Add(-1);
+  }
+  GrowableArray<BlockEntryInstr*> worklist;
+  for (intptr_t var_index = 0; var_index < variable_count; var_index++) {
+    ZoneGrowableArray<BlockEntryInstr*>* blocks = assigning_blocks[var_index];
+    for (intptr_t i = 0; i < blocks->length(); i++) {
+      BlockEntryInstr* block = (*blocks)[i];
+      in_worklist[block->preorder_number()] = var_index;
+      worklist.Add(block);
+    }
+    while (!worklist.is_empty()) {
+      BlockEntryInstr* current = worklist.Last();
+      worklist.RemoveLast();
+      ZoneGrowableArray<BlockEntryInstr*>* frontier =
+          dominance_frontier[current->preorder_number()];
+      for (intptr_t i = 0; i < frontier->length(); i++) {
+        BlockEntryInstr* block = (*frontier)[i];
+        const intptr_t index = block->preorder_number();
+        if (has_phi[index] < var_index) {
+          JoinEntryInstr* join = block->AsJoinEntry();
+          ASSERT(join != NULL);
+          join->AddPhi(new PhiInstr(join, var_index));
+          has_phi[index] = var_index;
+          if (in_worklist[index] < var_index) {
+            in_worklist[index] = var_index;
+            worklist.Add(block);
+          }
+        }
+      }
+    }
+  }
+}
+
+
+void FlowGraph::Rename(BlockEntryInstr* block,
+                       GrowableArray<Definition*>* env) {
+  JoinEntryInstr* join = block->AsJoinEntry();
+  if ((join != NULL) && (join->phis() != NULL)) {
+    for (intptr_t i = 0; i < join->phis()->length(); i++) {
+      PhiInstr* phi = (*join->phis())[i];
+      if (phi->variable_index() != PhiInstr::kNoVariable) {
+        (*env)[phi->variable_index()] = phi;
+      }
+    }
+  }
+
+  Instruction* current = block->next();
+  while (current != NULL) {
+    Instruction* next = current->next();
+    Environment* deopt_env = current->env();
+    if ((deopt_env != NULL) && (deopt_env->LocalCount() == 0)) {
+      for (intptr_t i = 0; i < env->length(); i++) {
+        deopt_env->AddLocal(new Value((*env)[i]));
+      }
+    }
+    LoadLocalInstr* load = current->AsLoadLocal();
+    StoreLocalInstr* store = current->AsStoreLocal();
+    if (load != NULL) {
+      load->set_replacement((*env)[load->variable_index()]);
+      load->RemoveFromGraph();
+    } else if (store != NULL) {
+      Definition* value = store->value()->definition()->Resolve();
+      (*env)[store->variable_index()] = value;
+      store->set_replacement(value);
+      store->RemoveFromGraph();
+    }
+    current = next;
+  }
+
+  // Fill in the inputs of the successor's phis flowing in from this block.
+  GotoInstr* goto_instr = block->last_instruction()->AsGoto();
+  if ((goto_instr != NULL) && (goto_instr->successor()->phis() != NULL)) {
+    JoinEntryInstr* successor = goto_instr->successor();
+    const intptr_t pred_index = successor->IndexOfPredecessor(block);
+    for (intptr_t i = 0; i < successor->phis()->length(); i++) {
+      PhiInstr* phi = (*successor->phis())[i];
+      if (phi->variable_index() != PhiInstr::kNoVariable) {
+        phi->SetInputAt(pred_index,
+                        new Value((*env)[phi->variable_index()]));
+      }
+    }
+  }
+
+  for (intptr_t i = 0; i < block->dominated_blocks().length(); i++) {
+    GrowableArray<Definition*> child_env(env->length());
+    for (intptr_t j = 0; j < env->length(); j++) {
+      child_env.Add((*env)[j]);
+    }
+    Rename(block->dominated_blocks()[i], &child_env);
+  }
+}
+
+
+void FlowGraph::ComputeSSA() {
+  GrowableArray<ZoneGrowableArray<BlockEntryInstr*>*> dominance_frontier;
+  ComputeDominators(&dominance_frontier);
+  InsertPhis(dominance_frontier);
+
+  // The graph entry defines the incoming parameters and initializes all other
+  // variables with null.
+  const intptr_t num_params = parsed_function_.function().NumberOfParameters();
+  GrowableArray<Definition*> env(variables_.length());
+  Instruction* last = graph_entry_;
+  for (intptr_t i = 0; i < variables_.length(); i++) {
+    Definition* definition = (i < num_params)
+        ? static_cast<Definition*>(new ParameterInstr(i))
+        : static_cast<Definition*>(new ConstantInstr(Object::ZoneHandle()));
+    last->InsertAfter(definition);
+    last = definition;
+    env.Add(definition);
+  }
+  Rename(graph_entry_, &env);
+  ResolveValues();
+}
+
+
+static void ResolveValue(Value* value) {
+  value->set_definition(value->definition()->Resolve());
+}
+
+
+void FlowGraph::ResolveValues() {
+  for (intptr_t i = 0; i < preorder_.length(); i++) {
+    BlockEntryInstr* block = preorder_[i];
+    JoinEntryInstr* join = block->AsJoinEntry();
+    if ((join != NULL) && (join->phis() != NULL)) {
+      for (intptr_t j = 0; j < join->phis()->length(); j++) {
+        PhiInstr* phi = (*join->phis())[j];
+        for (intptr_t k = 0; k < phi->InputCount(); k++) {
+          ResolveValue(phi->InputAt(k));
+        }
+      }
+    }
+    for (Instruction* instr = block->next();
+         instr != NULL;
+         instr = instr->next()) {
+      for (intptr_t j = 0; j < instr->InputCount(); j++) {
+        ResolveValue(instr->InputAt(j));
+      }
+      Environment* env = instr->env();
+      if (env != NULL) {
+        for (intptr_t j = 0; j < env->LocalCount(); j++) {
+          ResolveValue(env->LocalAt(j));
+        }
+        for (intptr_t j = 0; j < env->StackCount(); j++) {
+          ResolveValue(env->StackAt(j));
+        }
+      }
+    }
+  }
+}
+
+
+static void CountUse(Value* value) {
+  Definition* definition = value->definition();
+  definition->set_use_count(definition->use_count() + 1);
+}
+
+
+void FlowGraph::ComputeUseCounts() {
+  // Number the definitions.
+  ssa_temp_count_ = 0;
+  for (intptr_t i = 0; i < preorder_.length(); i++) {
+    BlockEntryInstr* block = preorder_[i];
+    JoinEntryInstr* join = block->AsJoinEntry();
+    if ((join != NULL) && (join->phis() != NULL)) {
+      for (intptr_t j = 0; j < join->phis()->length(); j++) {
+        PhiInstr* phi = (*join->phis())[j];
+        phi->set_use_count(0);
+        phi->set_ssa_temp_index(ssa_temp_count_++);
+      }
+    }
+    for (Instruction* instr = block->next();
+         instr != NULL;
+         instr = instr->next()) {
+      Definition* definition = instr->AsDefinition();
+      if (definition == NULL) continue;
+      definition->set_use_count(0);
+      definition->set_ssa_temp_index(
+          definition->IsConstant() ? -1 : ssa_temp_count_++);
+    }
+  }
+
+  // Count the uses.
+  for (intptr_t i = 0; i < preorder_.length(); i++) {
+    BlockEntryInstr* block = preorder_[i];
+    JoinEntryInstr* join = block->AsJoinEntry();
+    if ((join != NULL) && (join->phis() != NULL)) {
+      for (intptr_t j = 0; j < join->phis()->length(); j++) {
+        PhiInstr* phi = (*join->phis())[j];
+        for (intptr_t k = 0; k < phi->InputCount(); k++) {
+          CountUse(phi->InputAt(k));
+        }
+      }
+    }
+    for (Instruction* instr = block->next();
+         instr != NULL;
+         instr = instr->next()) {
+      for (intptr_t j = 0; j < instr->InputCount(); j++) {
+        CountUse(instr->InputAt(j));
+      }
+      Environment* env = instr->env();
+      if (env != NULL) {
+        for (intptr_t j = 0; j < env->LocalCount(); j++) {
+          CountUse(env->LocalAt(j));
+        }
+        for (intptr_t j = 0; j < env->StackCount(); j++) {
+          CountUse(env->StackAt(j));
+        }
+      }
+    }
+  }
+}
+
+
+void FlowGraph::Print(const char* phase) const {
+  OS::Print("==== %s: %s\n",
+            phase,
+            parsed_function_.function().ToFullyQualifiedCString());
+  for (intptr_t i = 0; i < preorder_.length(); i++) {
+    BlockEntryInstr* block = preorder_[i];
+    OS::Print("B%d[%s]", block->preorder_number(), block->DebugName());
+    for (intptr_t j = 0; j < block->PredecessorCount(); j++) {
+      OS::Print("%s B%d",
+                (j == 0) ? " pred" : ",",
+                block->PredecessorAt(j)->preorder_number());
+    }
+    OS::Print("\n");
+    JoinEntryInstr* join = block->AsJoinEntry();
+    if ((join != NULL) && (join->phis() != NULL)) {
+      for (intptr_t j = 0; j < join->phis()->length(); j++) {
+        OS::Print("    ");
+        (*join->phis())[j]->Print();
+        OS::Print("\n");
+      }
+    }
+    for (Instruction* instr = block->next();
+         instr != NULL;
+         instr = instr->next()) {
+      OS::Print("    ");
+      instr->Print();
+      for (intptr_t j = 0; j < instr->SuccessorCount(); j++) {
+        OS::Print(" B%d", instr->SuccessorAt(j)->preorder_number());
+      }
+      OS::Print("\n");
+    }
+  }
+}
+
+
+// The break and continue targets of a labeled statement or loop.
+class FlowGraphBuilder::JumpTarget : public ZoneAllocated {
+ public:
+  explicit JumpTarget(SourceLabel* label)
+      : label_(label),
+        break_join_(new JoinEntryInstr()),
+        continue_join_(NULL) { }
+
+  SourceLabel* label() const { return label_; }
+  JoinEntryInstr* break_join() const { return break_join_; }
+  JoinEntryInstr* continue_join() const { return continue_join_; }
+  void set_continue_join(JoinEntryInstr* join) { continue_join_ = join; }
+
+ private:
+  SourceLabel* label_;
+  JoinEntryInstr* break_join_;
+  JoinEntryInstr* continue_join_;
+
+  DISALLOW_COPY_AND_ASSIGN(JumpTarget);
+};
+
+
+FlowGraphBuilder::FlowGraphBuilder(const ParsedFunction& parsed_function)
+    : parsed_function_(parsed_function),
+      graph_entry_(NULL),
+      current_block_(NULL),
+      current_(NULL),
+      value_(NULL),
+      stack_(),
+      variables_(),
+      jump_targets_(),
+      scope_(NULL) { }
+
+
+static bool IsSupportedLocal(const LocalVariable& local) {
+  return !local.is_captured();
+}
+
+
+// Returns the name of the first node the flow graph does not support, or
+// NULL if all nodes are supported.
+static const char* FindUnsupportedNode(
+    const GrowableArray<AstNode*>& nodes) {
+  for (intptr_t i = 0; i < nodes.length(); i++) {
+    AstNode* node = nodes[i];
+    if (node->IsTypeNode() ||
+        node->IsStringConcatNode() ||
+        node->IsIncrOpInstanceFieldNode() ||
+        node->IsIncrOpStaticFieldNode() ||
+        node->IsIncrOpIndexedNode() ||
+        node->IsSwitchNode() ||
+        node->IsCaseNode() ||
+        node->IsArrayNode() ||
+        node->IsClosureNode() ||
+        node->IsClosureCallNode() ||
+        node->IsConstructorCallNode() ||
+        node->IsNativeBodyNode() ||
+        node->IsPrimaryNode() ||
+        node->IsCatchClauseNode() ||
+        node->IsTryCatchNode() ||
+        node->IsThrowNode() ||
+        node->IsInlinedFinallyNode()) {
+      return node->ShortName();
+    }
+    SequenceNode* sequence = node->AsSequenceNode();
+    if ((sequence != NULL) && (sequence->scope()->num_context_variables() > 0)) {
+      return "captured variable";
+    }
+    ComparisonNode* comparison = node->AsComparisonNode();
+    if ((comparison != NULL) &&
+        Token::IsInstanceofOperator(comparison->kind())) {
+      return comparison->Name();
+    }
+    ReturnNode* return_node = node->AsReturnNode();
+    JumpNode* jump = node->AsJumpNode();
+    if (((return_node != NULL) &&
+         (return_node->inlined_finally_list_length() > 0)) ||
+        ((jump != NULL) && (jump->inlined_finally_list_length() > 0))) {
+      return "finally";
+    }
+    LoadLocalNode* load = node->AsLoadLocalNode();
+    StoreLocalNode* store = node->AsStoreLocalNode();
+    IncrOpLocalNode* incr = node->AsIncrOpLocalNode();
+    if (((load != NULL) && !IsSupportedLocal(load->local())) ||
+        ((store != NULL) && !IsSupportedLocal(store->local())) ||
+        ((incr != NULL) && !IsSupportedLocal(incr->local()))) {
+      return "captured variable";
+    }
+    StaticGetterNode* getter = node->AsStaticGetterNode();
+    if ((getter != NULL) &&
+        (getter->cls().LookupStaticFunction(String::Handle(
+             Field::GetterName(getter->field_name()))) == Function::null())) {
+      return getter->ShortName();
+    }
+    StaticSetterNode* setter = node->AsStaticSetterNode();
+    if ((setter != NULL) &&
+        (setter->cls().LookupStaticFunction(String::Handle(
+             Field::SetterName(setter->field_name()))) == Function::null())) {
+      return setter->ShortName();
+    }
+  }
+  return NULL;
+}
+
+
+bool FlowGraphBuilder::CanBuildGraph(const ParsedFunction& parsed_function) {
+  if (FLAG_enable_type_checks || FLAG_trace_functions) {
+    return false;
+  }
+  const Function& function = parsed_function.function();
+  if ((function.kind() == RawFunction::kImplicitGetter) ||
+      (function.kind() == RawFunction::kImplicitSetter)) {
+    return false;
+  }
+  GrowableArray<AstNode*> nodes;
+  parsed_function.node_sequence()->CollectAllNodes(&nodes);
+  const char* unsupported = FindUnsupportedNode(nodes);
+  if (unsupported != NULL) {
+    if (FLAG_print_flow_graph) {
+      OS::Print("No flow graph for %s: %s\n",
+                function.ToFullyQualifiedCString(),
+                unsupported);
+    }
+    return false;
+  }
+  return true;
+}
+
+
+FlowGraph* FlowGraphBuilder::BuildGraph() {
+  if (!CanBuildGraph(parsed_function_)) {
+    return NULL;
+  }
+  SequenceNode* node_sequence = parsed_function_.node_sequence();
+  LocalScope* scope = node_sequence->scope();
+  const intptr_t num_params = parsed_function_.function().NumberOfParameters();
+  for (intptr_t i = 0; i < num_params; i++) {
+    variables_.Add(scope->VariableAt(i));
+  }
+
+  graph_entry_ = new GraphEntryInstr();
+  StartBlock(graph_entry_);
+  node_sequence->Visit(this);
+  if (is_open()) {
+    ConstantInstr* null_value = Constant(Object::ZoneHandle());
+    CloseWith(new ReturnInstr(node_sequence->token_index(),
+                              new Value(null_value)));
+  }
+  ASSERT(stack_.is_empty());
+
+  FlowGraph* graph = new FlowGraph(parsed_function_, graph_entry_, variables_);
+  graph->DiscoverBlocks();
+  graph->ComputeSSA();
+  graph->ComputeUseCounts();
+  if (FLAG_print_flow_graph) {
+    graph->Print("After SSA construction");
+  }
+  return graph;
+}
+
+
+void FlowGraphBuilder::Do(Instruction* instr) {
+  ASSERT(is_open());
+  current_->InsertAfter(instr);
+  current_ = instr;
+}
+
+
+void FlowGraphBuilder::ReturnDefinition(Definition* definition) {
+  Do(definition);
+  value_ = definition;
+}
+
+
+void FlowGraphBuilder::CloseWith(Instruction* instr) {
+  Do(instr);
+  current_block_->set_last_instruction(instr);
+  current_block_ = NULL;
+  current_ = NULL;
+}
+
+
+void FlowGraphBuilder::Goto(JoinEntryInstr* join) {
+  ASSERT(is_open());
+  join->AddPredecessor(current_block_);
+  CloseWith(new GotoInstr(join));
+}
+
+
+void FlowGraphBuilder::Branch(Definition* value,
+                              TargetEntryInstr** true_successor,
+                              TargetEntryInstr** false_successor) {
+  ASSERT(is_open());
+  *true_successor = new TargetEntryInstr();
+  *false_successor = new TargetEntryInstr();
+  (*true_successor)->AddPredecessor(current_block_);
+  (*false_successor)->AddPredecessor(current_block_);
+  BranchInstr* branch = new BranchInstr(new Value(value));
+  branch->SetSuccessors(*true_successor, *false_successor);
+  CloseWith(branch);
+}
+
+
+void FlowGraphBuilder::StartBlock(BlockEntryInstr* block) {
+  ASSERT(!is_open());
+  current_block_ = block;
+  current_ = block;
+}
+
+
+// A join no jump targets needs no block of its own: an open block simply
+// falls through, and a closed one stays closed.
+void FlowGraphBuilder::StartJoinIfReachable(JoinEntryInstr* join) {
+  if (join->PredecessorCount() == 0) return;
+  if (is_open()) {
+    Goto(join);
+  }
+  StartBlock(join);
+}
+
+
+void FlowGraphBuilder::VisitOperand(AstNode* node) {
+  ASSERT(is_open());
+  value_ = NULL;
+  node->Visit(this);
+  ASSERT(value_ != NULL);
+  stack_.Add(value_);
+  value_ = NULL;
+}
+
+
+ZoneGrowableArray<Value*>* FlowGraphBuilder::PopArguments(intptr_t count) {
+  ZoneGrowableArray<Value*>* arguments = new ZoneGrowableArray<Value*>(count);
+  const intptr_t first = stack_.length() - count;
+  ASSERT(first >= 0);
+  for (intptr_t i = first; i < stack_.length(); i++) {
+    arguments->Add(new Value(stack_[i]));
+  }
+  for (intptr_t i = 0; i < count; i++) {
+    stack_.RemoveLast();
+  }
+  return arguments;
+}
+
+
+Definition* FlowGraphBuilder::VisitCondition(AstNode* node) {
+  VisitOperand(node);
+  return PopOperand();
+}
+
+
+void FlowGraphBuilder::VisitStatement(AstNode* node) {
+  ASSERT(stack_.is_empty());
+  value_ = NULL;
+  node->Visit(this);
+  value_ = NULL;
+}
+
+
+ConstantInstr* FlowGraphBuilder::Constant(const Object& value) {
+  ConstantInstr* constant = new ConstantInstr(value);
+  Do(constant);
+  return constant;
+}
+
+
+Environment* FlowGraphBuilder::CurrentEnvironment() {
+  return new Environment(stack_, scope_);
+}
+
+
+intptr_t FlowGraphBuilder::VariableIndex(const LocalVariable& variable) {
+  for (intptr_t i = 0; i < variables_.length(); i++) {
+    if (variables_[i] == &variable) {
+      return i;
+    }
+  }
+  variables_.Add(&variable);
+  return variables_.length() - 1;
+}
+
+
+FlowGraphBuilder::JumpTarget* FlowGraphBuilder::LookupJumpTarget(
+    SourceLabel* label) {
+  for (intptr_t i = 0; i < jump_targets_.length(); i++) {
+    if (jump_targets_[i]->label() == label) {
+      return jump_targets_[i];
+    }
+  }
+  UNREACHABLE();
+  return NULL;
+}
+
+
+FlowGraphBuilder::JumpTarget* FlowGraphBuilder::AddJumpTarget(
+    SourceLabel* label) {
+  ASSERT(label != NULL);
+  JumpTarget* target = new JumpTarget(label);
+  jump_targets_.Add(target);
+  return target;
+}
+
+
+void FlowGraphBuilder::BuildInstanceCall(AstNode* node,
+                                         intptr_t node_id,
+                                         const String& name,
+                                         Token::Kind token_kind,
+                                         intptr_t argument_count,
+                                         const Array& argument_names) {
+  // The deoptimization point of the call is right before the call, with the
+  // arguments still on the expression stack.
+  Environment* env = CurrentEnvironment();
+  ZoneGrowableArray<Value*>* arguments = PopArguments(argument_count);
+  InstanceCallInstr* call = new InstanceCallInstr(node->token_index(),
+                                                  name,
+                                                  token_kind,
+                                                  arguments,
+                                                  argument_names,
+                                                  &node->ICDataAtId(node_id));
+  call->SetDeoptimizationTarget(node_id, env);
+  ReturnDefinition(call);
+}
+
+
+void FlowGraphBuilder::VisitReturnNode(ReturnNode* node) {
+  VisitOperand(node->value());
+  Definition* value = PopOperand();
+  CloseWith(new ReturnInstr(node->token_index(), new Value(value)));
+}
+
+
+void FlowGraphBuilder::VisitLiteralNode(LiteralNode* node) {
+  ReturnValue(Constant(node->literal()));
+}
+
+
+void FlowGraphBuilder::VisitTypeNode(TypeNode* node) {
+  UNREACHABLE();
+}
+
+
+// Operators '&&' and '||' evaluate to true or false. The right operand is
+// only evaluated if the left one does not decide the result.
+void FlowGraphBuilder::BuildLogicalAndOr(BinaryOpNode* node) {
+  const Bool& bool_true = Bool::ZoneHandle(Bool::True());
+  const Bool& bool_false = Bool::ZoneHandle(Bool::False());
+  const bool is_and = (node->kind() == Token::kAND);
+  TargetEntryInstr* true_entry;
+  TargetEntryInstr* false_entry;
+  Branch(VisitCondition(node->left()), &true_entry, &false_entry);
+  JoinEntryInstr* join = new JoinEntryInstr();
+
+  StartBlock(is_and ? true_entry : false_entry);
+  Definition* right = VisitCondition(node->right());
+  StrictCompareInstr* right_value = new StrictCompareInstr(
+      Token::kEQ_STRICT, new Value(right), new Value(Constant(bool_true)));
+  Do(right_value);
+  Goto(join);
+
+  StartBlock(is_and ? false_entry : true_entry);
+  Definition* short_circuit_value = Constant(is_and ? bool_false : bool_true);
+  Goto(join);
+
+  StartBlock(join);
+  PhiInstr* phi = new PhiInstr(join, PhiInstr::kNoVariable);
+  phi->SetInputAt(0, new Value(right_value));
+  phi->SetInputAt(1, new Value(short_circuit_value));
+  join->AddPhi(phi);
+  ReturnValue(phi);
+}
+
+
+void FlowGraphBuilder::VisitBinaryOpNode(BinaryOpNode* node) {
+  if ((node->kind() == Token::kAND) || (node->kind() == Token::kOR)) {
+    BuildLogicalAndOr(node);
+    return;
+  }
+  VisitOperand(node->left());
+  VisitOperand(node->right());
+  BuildInstanceCall(node,
+                    node->id(),
+                    String::ZoneHandle(String::NewSymbol(node->Name())),
+                    node->kind(),
+                    2,
+                    Array::ZoneHandle());
+}
+
+
+void FlowGraphBuilder::VisitStringConcatNode(StringConcatNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitComparisonNode(ComparisonNode* node) {
+  ASSERT(!Token::IsInstanceofOperator(node->kind()));
+  VisitOperand(node->left());
+  VisitOperand(node->right());
+  if ((node->kind() == Token::kEQ_STRICT) ||
+      (node->kind() == Token::kNE_STRICT)) {
+    Definition* right = PopOperand();
+    Definition* left = PopOperand();
+    ReturnDefinition(new StrictCompareInstr(node->kind(),
+                                            new Value(left),
+                                            new Value(right)));
+    return;
+  }
+  if ((node->kind() == Token::kEQ) || (node->kind() == Token::kNE)) {
+    Environment* env = CurrentEnvironment();
+    Definition* right = PopOperand();
+    Definition* left = PopOperand();
+    EqualityCompareInstr* compare =
+        new EqualityCompareInstr(node->token_index(),
+                                 node->kind(),
+                                 new Value(left),
+                                 new Value(right),
+                                 &node->ICDataAtId(node->id()));
+    compare->SetDeoptimizationTarget(node->id(), env);
+    ReturnDefinition(compare);
+    return;
+  }
+  BuildInstanceCall(node,
+                    node->id(),
+                    String::ZoneHandle(String::NewSymbol(node->Name())),
+                    node->kind(),
+                    2,
+                    Array::ZoneHandle());
+}
+
+
+void FlowGraphBuilder::VisitUnaryOpNode(UnaryOpNode* node) {
+  VisitOperand(node->operand());
+  if (node->kind() == Token::kNOT) {
+    ReturnDefinition(new BooleanNegateInstr(new Value(PopOperand())));
+    return;
+  }
+  if (node->kind() == Token::kADD) {
+    // Unary operator '+' does not exist, it's a NOP.
+    ReturnValue(PopOperand());
+    return;
+  }
+  const Token::Kind token_kind =
+      (node->kind() == Token::kSUB) ? Token::kNEGATE : node->kind();
+  const char* name = (node->kind() == Token::kSUB)
+      ? Token::Str(Token::kNEGATE)
+      : node->Name();
+  BuildInstanceCall(node,
+                    node->id(),
+                    String::ZoneHandle(String::NewSymbol(name)),
+                    token_kind,
+                    1,
+                    Array::ZoneHandle());
+}
+
+
+void FlowGraphBuilder::VisitIncrOpLocalNode(IncrOpLocalNode* node) {
+  ASSERT((node->kind() == Token::kINCR) || (node->kind() == Token::kDECR));
+  // Unoptimized code deoptimizes to the start of the increment.
+  Environment* env = CurrentEnvironment();
+  const LocalVariable& local = node->local();
+  const intptr_t variable_index = VariableIndex(local);
+  LoadLocalInstr* old_value = new LoadLocalInstr(local, variable_index);
+  Do(old_value);
+  ConstantInstr* one = Constant(Smi::ZoneHandle(Smi::New(1)));
+  ZoneGrowableArray<Value*>* arguments = new ZoneGrowableArray<Value*>(2);
+  arguments->Add(new Value(old_value));
+  arguments->Add(new Value(one));
+  const bool is_incr = (node->kind() == Token::kINCR);
+  InstanceCallInstr* call = new InstanceCallInstr(
+      node->token_index(),
+      String::ZoneHandle(String::NewSymbol(is_incr ? "+" : "-")),
+      is_incr ? Token::kADD : Token::kSUB,
+      arguments,
+      Array::ZoneHandle(),
+      &node->ICDataAtId(node->id()));
+  call->SetDeoptimizationTarget(node->id(), env);
+  Do(call);
+  Do(new StoreLocalInstr(local, variable_index, new Value(call)));
+  if (node->prefix()) {
+    ReturnValue(call);
+  } else {
+    ReturnValue(old_value);
+  }
+}
+
+
+void FlowGraphBuilder::VisitIncrOpInstanceFieldNode(
+    IncrOpInstanceFieldNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitIncrOpStaticFieldNode(IncrOpStaticFieldNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitIncrOpIndexedNode(IncrOpIndexedNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitConditionalExprNode(ConditionalExprNode* node) {
+  TargetEntryInstr* true_entry;
+  TargetEntryInstr* false_entry;
+  Branch(VisitCondition(node->condition()), &true_entry, &false_entry);
+  JoinEntryInstr* join = new JoinEntryInstr();
+
+  StartBlock(true_entry);
+  VisitOperand(node->true_expr());
+  Definition* true_value = PopOperand();
+  Goto(join);
+
+  StartBlock(false_entry);
+  VisitOperand(node->false_expr());
+  Definition* false_value = PopOperand();
+  Goto(join);
+
+  StartBlock(join);
+  PhiInstr* phi = new PhiInstr(join, PhiInstr::kNoVariable);
+  phi->SetInputAt(0, new Value(true_value));
+  phi->SetInputAt(1, new Value(false_value));
+  join->AddPhi(phi);
+  ReturnValue(phi);
+}
+
+
+void FlowGraphBuilder::VisitIfNode(IfNode* node) {
+  TargetEntryInstr* true_entry;
+  TargetEntryInstr* false_entry;
+  Branch(VisitCondition(node->condition()), &true_entry, &false_entry);
+  JoinEntryInstr* join = new JoinEntryInstr();
+
+  StartBlock(true_entry);
+  node->true_branch()->Visit(this);
+  if (is_open()) {
+    Goto(join);
+  }
+
+  StartBlock(false_entry);
+  if (node->false_branch() != NULL) {
+    node->false_branch()->Visit(this);
+  }
+  if (is_open()) {
+    Goto(join);
+  }
+
+  StartJoinIfReachable(join);
+}
+
+
+void FlowGraphBuilder::VisitSwitchNode(SwitchNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitCaseNode(CaseNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitWhileNode(WhileNode* node) {
+  JumpTarget* target = AddJumpTarget(node->label());
+  JoinEntryInstr* header = new JoinEntryInstr();
+  target->set_continue_join(header);
+  Goto(header);
+
+  StartBlock(header);
+  TargetEntryInstr* body_entry;
+  TargetEntryInstr* exit_entry;
+  Branch(VisitCondition(node->condition()), &body_entry, &exit_entry);
+
+  StartBlock(body_entry);
+  node->body()->Visit(this);
+  if (is_open()) {
+    Goto(header);
+  }
+
+  StartBlock(exit_entry);
+  StartJoinIfReachable(target->break_join());
+}
+
+
+void FlowGraphBuilder::VisitDoWhileNode(DoWhileNode* node) {
+  JumpTarget* target = AddJumpTarget(node->label());
+  JoinEntryInstr* body_join = new JoinEntryInstr();
+  target->set_continue_join(new JoinEntryInstr());
+  Goto(body_join);
+
+  StartBlock(body_join);
+  node->body()->Visit(this);
+  StartJoinIfReachable(target->continue_join());
+  if (is_open()) {
+    TargetEntryInstr* loop_entry;
+    TargetEntryInstr* exit_entry;
+    Branch(VisitCondition(node->condition()), &loop_entry, &exit_entry);
+    StartBlock(loop_entry);
+    Goto(body_join);
+    StartBlock(exit_entry);
+  }
+  StartJoinIfReachable(target->break_join());
+}
+
+
+void FlowGraphBuilder::VisitForNode(ForNode* node) {
+  LocalScope* outer_scope = scope_;
+  node->initializer()->Visit(this);
+  // The condition, body and increment are evaluated in the scope of the
+  // initializer.
+  scope_ = node->initializer()->scope();
+  JumpTarget* target = AddJumpTarget(node->label());
+  JoinEntryInstr* header = new JoinEntryInstr();
+  target->set_continue_join(new JoinEntryInstr());
+  Goto(header);
+
+  StartBlock(header);
+  TargetEntryInstr* exit_entry = NULL;
+  if (node->condition() != NULL) {
+    TargetEntryInstr* body_entry;
+    Branch(VisitCondition(node->condition()), &body_entry, &exit_entry);
+    StartBlock(body_entry);
+  }
+  node->body()->Visit(this);
+  StartJoinIfReachable(target->continue_join());
+  if (is_open()) {
+    node->increment()->Visit(this);
+    if (is_open()) {
+      Goto(header);
+    }
+  }
+
+  if (exit_entry != NULL) {
+    StartBlock(exit_entry);
+  }
+  StartJoinIfReachable(target->break_join());
+  scope_ = outer_scope;
+}
+
+
+void FlowGraphBuilder::VisitJumpNode(JumpNode* node) {
+  JumpTarget* target = LookupJumpTarget(node->label());
+  if (node->kind() == Token::kBREAK) {
+    Goto(target->break_join());
+  } else {
+    ASSERT(target->continue_join() != NULL);
+    Goto(target->continue_join());
+  }
+}
+
+
+void FlowGraphBuilder::VisitArgumentListNode(ArgumentListNode* node) {
+  for (intptr_t i = 0; i < node->length(); i++) {
+    VisitOperand(node->NodeAt(i));
+  }
+}
+
+
+void FlowGraphBuilder::VisitArrayNode(ArrayNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitClosureNode(ClosureNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitInstanceCallNode(InstanceCallNode* node) {
+  VisitOperand(node->receiver());
+  node->arguments()->Visit(this);
+  BuildInstanceCall(node,
+                    node->id(),
+                    node->function_name(),
+                    Token::kILLEGAL,
+                    node->arguments()->length() + 1,
+                    node->arguments()->names());
+}
+
+
+void FlowGraphBuilder::VisitStaticCallNode(StaticCallNode* node) {
+  node->arguments()->Visit(this);
+  ZoneGrowableArray<Value*>* arguments =
+      PopArguments(node->arguments()->length());
+  ReturnDefinition(new StaticCallInstr(node->token_index(),
+                                       node->function(),
+                                       arguments,
+                                       node->arguments()->names()));
+}
+
+
+void FlowGraphBuilder::VisitClosureCallNode(ClosureCallNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitConstructorCallNode(ConstructorCallNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitInstanceGetterNode(InstanceGetterNode* node) {
+  VisitOperand(node->receiver());
+  BuildInstanceCall(node,
+                    node->id(),
+                    String::ZoneHandle(Field::GetterName(node->field_name())),
+                    Token::kGET,
+                    1,
+                    Array::ZoneHandle());
+}
+
+
+// The result of the assignment to a field is the value being stored.
+void FlowGraphBuilder::VisitInstanceSetterNode(InstanceSetterNode* node) {
+  VisitOperand(node->receiver());
+  VisitOperand(node->value());
+  Definition* value = stack_.Last();
+  BuildInstanceCall(node,
+                    node->id(),
+                    String::ZoneHandle(Field::SetterName(node->field_name())),
+                    Token::kSET,
+                    2,
+                    Array::ZoneHandle());
+  ReturnValue(value);
+}
+
+
+void FlowGraphBuilder::VisitStaticGetterNode(StaticGetterNode* node) {
+  const String& getter_name =
+      String::Handle(Field::GetterName(node->field_name()));
+  const Function& function =
+      Function::ZoneHandle(node->cls().LookupStaticFunction(getter_name));
+  ASSERT(!function.IsNull());
+  ReturnDefinition(new StaticCallInstr(node->token_index(),
+                                       function,
+                                       new ZoneGrowableArray<Value*>(0),
+                                       Array::ZoneHandle()));
+}
+
+
+void FlowGraphBuilder::VisitStaticSetterNode(StaticSetterNode* node) {
+  const String& setter_name =
+      String::Handle(Field::SetterName(node->field_name()));
+  const Function& function =
+      Function::ZoneHandle(node->cls().LookupStaticFunction(setter_name));
+  ASSERT(!function.IsNull());
+  VisitOperand(node->value());
+  Definition* value = stack_.Last();
+  ZoneGrowableArray<Value*>* arguments = PopArguments(1);
+  Do(new StaticCallInstr(node->token_index(),
+                         function,
+                         arguments,
+                         Array::ZoneHandle()));
+  ReturnValue(value);
+}
+
+
+void FlowGraphBuilder::VisitNativeBodyNode(NativeBodyNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitPrimaryNode(PrimaryNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitLoadLocalNode(LoadLocalNode* node) {
+  ReturnDefinition(
+      new LoadLocalInstr(node->local(), VariableIndex(node->local())));
+}
+
+
+void FlowGraphBuilder::VisitStoreLocalNode(StoreLocalNode* node) {
+  VisitOperand(node->value());
+  Definition* value = PopOperand();
+  ReturnDefinition(new StoreLocalInstr(node->local(),
+                                       VariableIndex(node->local()),
+                                       new Value(value)));
+}
+
+
+void FlowGraphBuilder::VisitLoadInstanceFieldNode(LoadInstanceFieldNode* node) {
+  VisitOperand(node->instance());
+  Definition* instance = PopOperand();
+  ReturnDefinition(new LoadInstanceFieldInstr(new Value(instance),
+                                              node->field().Offset()));
+}
+
+
+void FlowGraphBuilder::VisitStoreInstanceFieldNode(
+    StoreInstanceFieldNode* node) {
+  VisitOperand(node->instance());
+  VisitOperand(node->value());
+  Definition* value = PopOperand();
+  Definition* instance = PopOperand();
+  Do(new StoreInstanceFieldInstr(new Value(instance),
+                                 new Value(value),
+                                 node->field().Offset()));
+  ReturnValue(value);
+}
+
+
+void FlowGraphBuilder::VisitLoadStaticFieldNode(LoadStaticFieldNode* node) {
+  ReturnDefinition(new LoadStaticFieldInstr(node->field()));
+}
+
+
+void FlowGraphBuilder::VisitStoreStaticFieldNode(StoreStaticFieldNode* node) {
+  VisitOperand(node->value());
+  Definition* value = PopOperand();
+  Do(new StoreStaticFieldInstr(node->field(), new Value(value)));
+  ReturnValue(value);
+}
+
+
+void FlowGraphBuilder::VisitLoadIndexedNode(LoadIndexedNode* node) {
+  VisitOperand(node->array());
+  VisitOperand(node->index_expr());
+  BuildInstanceCall(
+      node,
+      node->id(),
+      String::ZoneHandle(String::NewSymbol(Token::Str(Token::kINDEX))),
+      Token::kINDEX,
+      2,
+      Array::ZoneHandle());
+}
+
+
+void FlowGraphBuilder::VisitStoreIndexedNode(StoreIndexedNode* node) {
+  VisitOperand(node->array());
+  VisitOperand(node->index_expr());
+  VisitOperand(node->value());
+  Definition* value = stack_.Last();
+  BuildInstanceCall(
+      node,
+      node->id(),
+      String::ZoneHandle(String::NewSymbol(Token::Str(Token::kASSIGN_INDEX))),
+      Token::kASSIGN_INDEX,
+      3,
+      Array::ZoneHandle());
+  ReturnValue(value);
+}
+
+
+void FlowGraphBuilder::VisitSequenceNode(SequenceNode* node) {
+  LocalScope* outer_scope = scope_;
+  scope_ = node->scope();
+  JumpTarget* target =
+      (node->label() != NULL) ? AddJumpTarget(node->label()) : NULL;
+  for (intptr_t i = 0; i < node->length(); i++) {
+    // Skip the dead code following a return or jump.
+    if (!is_open()) break;
+    VisitStatement(node->NodeAt(i));
+  }
+  if (target != NULL) {
+    StartJoinIfReachable(target->break_join());
+  }
+  scope_ = outer_scope;
+}
+
+
+void FlowGraphBuilder::VisitCatchClauseNode(CatchClauseNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitTryCatchNode(TryCatchNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitThrowNode(ThrowNode* node) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphBuilder::VisitInlinedFinallyNode(InlinedFinallyNode* node) {
+  UNREACHABLE();
+}
+
+}  // namespace dart
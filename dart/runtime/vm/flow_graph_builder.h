@@ -0,0 +1,165 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_FLOW_GRAPH_BUILDER_H_
+#define VM_FLOW_GRAPH_BUILDER_H_
+
+#include "vm/allocation.h"
+#include "vm/ast.h"
+#include "vm/growable_array.h"
+#include "vm/intermediate_language.h"
+
+namespace dart {
+
+// Forward declarations.
+class ParsedFunction;
+
+// The flow graph of a function in SSA form, built by the FlowGraphBuilder.
+class FlowGraph : public ZoneAllocated {
+ public:
+  FlowGraph(const ParsedFunction& parsed_function,
+            GraphEntryInstr* graph_entry,
+            const GrowableArray<const LocalVariable*>& variables);
+
+  const ParsedFunction& parsed_function() const { return parsed_function_; }
+  GraphEntryInstr* graph_entry() const { return graph_entry_; }
+
+  // The local variables of the function, parameters first. Environments list
+  // the values of the variables in this order.
+  intptr_t variable_count() const { return variables_.length(); }
+  const LocalVariable& VariableAt(intptr_t index) const {
+    return *variables_[index];
+  }
+
+  // The reachable blocks in depth-first preorder and postorder. Code is
+  // emitted in reverse postorder.
+  const GrowableArray<BlockEntryInstr*>& preorder() const { return preorder_; }
+  const GrowableArray<BlockEntryInstr*>& postorder() const {
+    return postorder_;
+  }
+
+  // Numbers the blocks and computes their dominators.
+  void DiscoverBlocks();
+
+  // Replaces the loads and stores of local variables by phis and the reaching
+  // definitions, and fills in the local variables of the environments.
+  void ComputeSSA();
+
+  // Redirects all uses of replaced definitions to their replacements.
+  void ResolveValues();
+
+  // Numbers the definitions producing a value at runtime, i.e., all
+  // definitions but constants, and counts the uses of every definition,
+  // including its uses in environments.
+  void ComputeUseCounts();
+  intptr_t ssa_temp_count() const { return ssa_temp_count_; }
+
+  void Print(const char* phase) const;
+
+ private:
+  void ComputeDominators(
+      GrowableArray<ZoneGrowableArray<BlockEntryInstr*>*>* dominance_frontier);
+  void InsertPhis(
+      const GrowableArray<ZoneGrowableArray<BlockEntryInstr*>*>&
+          dominance_frontier);
+  void Rename(BlockEntryInstr* block, GrowableArray<Definition*>* env);
+
+  const ParsedFunction& parsed_function_;
+  GraphEntryInstr* graph_entry_;
+  GrowableArray<const LocalVariable*> variables_;
+  GrowableArray<BlockEntryInstr*> preorder_;
+  GrowableArray<BlockEntryInstr*> postorder_;
+  intptr_t ssa_temp_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlowGraph);
+};
+
+
+// Builds the flow graph of a function from its AST. Expressions are
+// evaluated in the same order as by the unoptimized code generator, and the
+// builder mirrors the expression stack of the unoptimized code, so that every
+// instruction which may deoptimize records the exact frame state of the
+// corresponding deoptimization point in unoptimized code.
+class FlowGraphBuilder : public AstNodeVisitor {
+ public:
+  explicit FlowGraphBuilder(const ParsedFunction& parsed_function);
+
+  // Returns NULL if the function contains constructs the flow graph does not
+  // support yet (e.g., try-catch, closures or switch statements); such
+  // functions are compiled by the AST based optimizing code generator.
+  FlowGraph* BuildGraph();
+
+#define DECLARE_VISIT(type, name) virtual void Visit##type(type* node);
+NODE_LIST(DECLARE_VISIT)
+#undef DECLARE_VISIT
+
+ private:
+  class JumpTarget;
+
+  static bool CanBuildGraph(const ParsedFunction& parsed_function);
+
+  bool is_open() const { return current_ != NULL; }
+
+  // Appends 'instr' to the current block.
+  void Do(Instruction* instr);
+  // Appends 'definition' and makes it the value of the visited node.
+  void ReturnDefinition(Definition* definition);
+  void ReturnValue(Definition* definition) { value_ = definition; }
+  // Closes the current block with a control instruction.
+  void CloseWith(Instruction* instr);
+  void Goto(JoinEntryInstr* join);
+  // Closes the current block with a branch on 'value' and returns the two
+  // successors.
+  void Branch(Definition* value,
+              TargetEntryInstr** true_successor,
+              TargetEntryInstr** false_successor);
+  void StartBlock(BlockEntryInstr* block);
+  // Continues at 'join' if it is reachable, otherwise leaves the builder
+  // closed.
+  void StartJoinIfReachable(JoinEntryInstr* join);
+
+  // Visits an expression whose value is pushed on the expression stack of
+  // unoptimized code.
+  void VisitOperand(AstNode* node);
+  Definition* PopOperand() {
+    Definition* operand = stack_.Last();
+    stack_.RemoveLast();
+    return operand;
+  }
+  ZoneGrowableArray<Value*>* PopArguments(intptr_t count);
+  // Visits a condition, which unoptimized code pushes and pops again.
+  Definition* VisitCondition(AstNode* node);
+  void VisitStatement(AstNode* node);
+
+  ConstantInstr* Constant(const Object& value);
+  Environment* CurrentEnvironment();
+  intptr_t VariableIndex(const LocalVariable& variable);
+  JumpTarget* LookupJumpTarget(SourceLabel* label);
+  JumpTarget* AddJumpTarget(SourceLabel* label);
+
+  // Emits an instance call of 'name' with the arguments on top of the stack.
+  void BuildInstanceCall(AstNode* node,
+                         intptr_t node_id,
+                         const String& name,
+                         Token::Kind token_kind,
+                         intptr_t argument_count,
+                         const Array& argument_names);
+  void BuildLogicalAndOr(BinaryOpNode* node);
+
+  const ParsedFunction& parsed_function_;
+  GraphEntryInstr* graph_entry_;
+  BlockEntryInstr* current_block_;
+  Instruction* current_;
+  Definition* value_;
+  GrowableArray<Definition*> stack_;
+  GrowableArray<const LocalVariable*> variables_;
+  GrowableArray<JumpTarget*> jump_targets_;
+  LocalScope* scope_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(FlowGraphBuilder);
+};
+
+}  // namespace dart
+
+#endif  // VM_FLOW_GRAPH_BUILDER_H_
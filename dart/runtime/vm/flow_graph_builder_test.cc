@@ -0,0 +1,96 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/flow_graph_builder.h"
+
+#include "vm/assert.h"
+#include "vm/class_finalizer.h"
+#include "vm/compiler.h"
+#include "vm/object.h"
+#include "vm/parser.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+// Compiler only implemented on IA32 and X64 now.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+
+static RawFunction* CompileScriptAndLookup(const char* script_chars,
+                                           const char* function_name) {
+  String& url = String::Handle(String::New("dart-test:FlowGraphBuilder"));
+  String& source = String::Handle(String::New(script_chars));
+  Script& script = Script::Handle(Script::New(url, source, RawScript::kSource));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  EXPECT(ClassFinalizer::FinalizePendingClasses());
+  Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(String::NewSymbol("A"))));
+  EXPECT(!cls.IsNull());
+  return cls.LookupStaticFunction(String::Handle(String::New(function_name)));
+}
+
+
+TEST_CASE(FlowGraphBuilder_LoopPhis) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static sum(n) {\n"
+      "    var s = 0;\n"
+      "    for (var i = 0; i < n; i++) {\n"
+      "      s = s + i;\n"
+      "    }\n"
+      "    return s;\n"
+      "  }\n"
+      "}\n";
+  const Function& function =
+      Function::ZoneHandle(CompileScriptAndLookup(kScriptChars, "sum"));
+  EXPECT(!function.IsNull());
+  ParsedFunction parsed_function(function);
+  Parser::ParseFunction(&parsed_function);
+  FlowGraphBuilder builder(parsed_function);
+  FlowGraph* flow_graph = builder.BuildGraph();
+  EXPECT(flow_graph != NULL);
+  // The loop header merges the values of 's' and 'i'; 'n' is not assigned.
+  intptr_t phi_count = 0;
+  const GrowableArray<BlockEntryInstr*>& blocks = flow_graph->preorder();
+  for (intptr_t i = 0; i < blocks.length(); i++) {
+    JoinEntryInstr* join = blocks[i]->AsJoinEntry();
+    if ((join != NULL) && (join->phis() != NULL)) {
+      phi_count += join->phis()->length();
+    }
+  }
+  EXPECT_EQ(2, phi_count);
+  // Loads and stores of local variables are gone after SSA construction.
+  for (intptr_t i = 0; i < blocks.length(); i++) {
+    for (Instruction* instr = blocks[i]->next();
+         instr != NULL;
+         instr = instr->next()) {
+      EXPECT(!instr->IsLoadLocal() && !instr->IsStoreLocal());
+    }
+  }
+}
+
+
+TEST_CASE(FlowGraphBuilder_Unsupported) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static foo(a) {\n"
+      "    try {\n"
+      "      return a.bar();\n"
+      "    } catch (var e) {\n"
+      "      return null;\n"
+      "    }\n"
+      "  }\n"
+      "}\n";
+  const Function& function =
+      Function::ZoneHandle(CompileScriptAndLookup(kScriptChars, "foo"));
+  EXPECT(!function.IsNull());
+  ParsedFunction parsed_function(function);
+  Parser::ParseFunction(&parsed_function);
+  FlowGraphBuilder builder(parsed_function);
+  EXPECT(builder.BuildGraph() == NULL);
+}
+
+#endif  // TARGET_ARCH_IA32 || TARGET_ARCH_X64
+
+}  // namespace dart
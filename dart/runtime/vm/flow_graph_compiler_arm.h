@@ -0,0 +1,31 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_FLOW_GRAPH_COMPILER_ARM_H_
+#define VM_FLOW_GRAPH_COMPILER_ARM_H_
+
+#ifndef VM_FLOW_GRAPH_COMPILER_H_
+#error Do not include flow_graph_compiler_arm.h; use flow_graph_compiler.h.
+#endif
+
+#include "vm/flow_graph_builder.h"
+#include "vm/opt_code_generator.h"
+
+namespace dart {
+
+// Temporary hierarchy, until the flow graph compiler is implemented; the
+// function is compiled from its AST by the optimizing code generator.
+class FlowGraphCompiler : public OptimizingCodeGenerator {
+ public:
+  FlowGraphCompiler(Assembler* assembler, const FlowGraph& flow_graph)
+      : OptimizingCodeGenerator(assembler, flow_graph.parsed_function()) {}
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(FlowGraphCompiler);
+};
+
+}  // namespace dart
+
+
+#endif  // VM_FLOW_GRAPH_COMPILER_ARM_H_
@@ -0,0 +1,878 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/globals.h"  // Needed here to get TARGET_ARCH_IA32.
+#if defined(TARGET_ARCH_IA32)
+
+#include "vm/flow_graph_compiler.h"
+
+#include "vm/assembler_macros.h"
+#include "vm/flags.h"
+#include "vm/flow_graph_allocator.h"
+#include "vm/intrinsifier.h"
+#include "vm/object.h"
+#include "vm/object_store.h"
+#include "vm/stub_code.h"
+
+namespace dart {
+
+DECLARE_FLAG(bool, intrinsify);
+DECLARE_FLAG(bool, trace_functions);
+
+
+class FlowGraphCompiler::BlockLabel : public ZoneAllocated {
+ public:
+  BlockLabel() : label_() { }
+
+  Label* label() { return &label_; }
+
+ private:
+  Label label_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockLabel);
+};
+
+
+// Rebuilds the unoptimized frame described by the environment of 'instr' and
+// continues in unoptimized code at the instruction's deoptimization point.
+class FlowGraphCompiler::DeoptimizationStub : public ZoneAllocated {
+ public:
+  explicit DeoptimizationStub(Instruction* instr) : instr_(instr), label_() {
+    ASSERT(instr->CanDeoptimize());
+  }
+
+  Instruction* instr() const { return instr_; }
+
+  // Jump to this label to deoptimize.
+  Label* label() { return &label_; }
+
+ private:
+  Instruction* instr_;
+  Label label_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptimizationStub);
+};
+
+
+#define __ assembler()->
+
+
+// EAX, ECX and EDX are the scratch registers of the instructions and hold
+// the arguments of calls, ESI holds the context.
+static const Register kAllocatableRegisters[] = { EBX, EDI };
+
+
+FlowGraphCompiler::FlowGraphCompiler(Assembler* assembler,
+                                     const FlowGraph& flow_graph)
+    : CodeGenerator(assembler, flow_graph.parsed_function()),
+      flow_graph_(flow_graph),
+      block_labels_(flow_graph.preorder().length()),
+      deoptimization_stubs_(),
+      current_block_(NULL),
+      fused_compare_(NULL),
+      fused_condition_(EQUAL),
+      fused_is_double_(false),
+      spill_slot_count_(0) {
+  for (intptr_t i = 0; i < flow_graph.preorder().length(); i++) {
+    block_labels_.Add(new BlockLabel());
+  }
+  FlowGraphAllocator allocator(flow_graph,
+                               kAllocatableRegisters,
+                               ARRAY_SIZE(kAllocatableRegisters));
+  allocator.AllocateRegisters();
+  spill_slot_count_ = allocator.spill_slot_count();
+}
+
+
+bool FlowGraphCompiler::TryIntrinsify() {
+  // Even if an intrinsified version of the function was successfully
+  // generated, it may fall through to the non-intrinsified method body.
+  if (FLAG_intrinsify && !FLAG_trace_functions) {
+    return Intrinsifier::Intrinsify(parsed_function().function(), assembler());
+  }
+  return false;
+}
+
+
+// Check for stack overflow.
+// Note that first 5 bytes may be patched with a jump.
+void FlowGraphCompiler::GeneratePreEntryCode() {
+  __ cmpl(ESP,
+      Address::Absolute(Isolate::Current()->stack_limit_address()));
+  __ j(BELOW_EQUAL, &StubCode::StackOverflowLabel());
+}
+
+
+void FlowGraphCompiler::GenerateDeferredCode() {
+  CodeGenerator::GenerateDeferredCode();
+  for (intptr_t i = 0; i < deoptimization_stubs_.length(); i++) {
+    GenerateDeoptimizationStub(deoptimization_stubs_[i]);
+  }
+}
+
+
+// Emits the flow graph in place of the function body, after the entry code
+// has allocated the local variables.
+void FlowGraphCompiler::VisitSequenceNode(SequenceNode* node) {
+  ASSERT(node == parsed_function().node_sequence());
+  // The spill slots are visited by the GC and must hold objects.
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  for (intptr_t i = 0; i < spill_slot_count_; i++) {
+    __ pushl(raw_null);
+  }
+  const GrowableArray<BlockEntryInstr*>& postorder = flow_graph_.postorder();
+  for (intptr_t i = postorder.length() - 1; i >= 0; i--) {
+    current_block_ = postorder[i];
+    __ Bind(GetBlockLabel(current_block_));
+    for (Instruction* instr = current_block_->next();
+         instr != NULL;
+         instr = instr->next()) {
+      instr->Accept(this);
+    }
+  }
+  current_block_ = NULL;
+}
+
+
+Label* FlowGraphCompiler::GetBlockLabel(BlockEntryInstr* block) const {
+  return block_labels_[block->preorder_number()]->label();
+}
+
+
+bool FlowGraphCompiler::IsNextBlock(BlockEntryInstr* block) const {
+  // Blocks are emitted in reverse postorder.
+  return block->postorder_number() == current_block_->postorder_number() - 1;
+}
+
+
+Label* FlowGraphCompiler::AddDeoptimizationStub(Instruction* instr) {
+  DeoptimizationStub* stub = new DeoptimizationStub(instr);
+  deoptimization_stubs_.Add(stub);
+  return stub->label();
+}
+
+
+// Deoptimization stubs are entered with only the spill slots on the stack and
+// the values in their allocated locations. The values of the live local
+// variables are written to their frame slots, and the values of the
+// expression stack to the slots right below them. EAX is the only register
+// clobbered before all values are read.
+void FlowGraphCompiler::GenerateDeoptimizationStub(DeoptimizationStub* stub) {
+  Instruction* instr = stub->instr();
+  Environment* env = instr->env();
+  __ Bind(stub->label());
+  ASSERT(env->LocalCount() == flow_graph_.variable_count());
+  for (intptr_t i = 0; i < env->LocalCount(); i++) {
+    const LocalVariable& variable = flow_graph_.VariableAt(i);
+    if (env->IsLive(variable)) {
+      LoadValue(EAX, env->LocalAt(i));
+      __ movl(Address(EBP, variable.index() * kWordSize), EAX);
+    }
+  }
+  // The expression stack overlaps the spill slots: push all values before
+  // they are moved, below both areas.
+  const intptr_t stack_count = env->StackCount();
+  if (stack_count > spill_slot_count_) {
+    __ subl(ESP, Immediate((stack_count - spill_slot_count_) * kWordSize));
+  }
+  for (intptr_t i = 0; i < stack_count; i++) {
+    PushValue(env->StackAt(i));
+  }
+  for (intptr_t i = stack_count - 1; i >= 0; i--) {
+    __ popl(SpillSlotAddress(i));
+  }
+  __ leal(ESP, SpillSlotAddress(stack_count - 1));
+  __ call(&StubCode::DeoptimizeLabel());
+  AddCurrentDescriptor(PcDescriptors::kOther,
+                       instr->deopt_id(),
+                       instr->token_index());
+#if defined(DEBUG)
+  __ int3();
+  // Check that deoptimization point exists in unoptimized code.
+  const Code& unoptimized_code =
+      Code::Handle(parsed_function().function().unoptimized_code());
+  ASSERT(!unoptimized_code.IsNull());
+  uword continue_at_pc =
+      unoptimized_code.GetDeoptPcAtNodeId(instr->deopt_id());
+  ASSERT(continue_at_pc != 0);
+#endif  // DEBUG
+}
+
+
+// Spill slot 'index' is also the slot of the expression stack element at
+// that depth in unoptimized code.
+Address FlowGraphCompiler::SpillSlotAddress(intptr_t index) const {
+  return Address(EBP, -(locals_space_size() + (index + 1) * kWordSize));
+}
+
+
+void FlowGraphCompiler::LoadValue(Register dst, Value* value) {
+  if (value->IsConstant()) {
+    __ LoadObject(dst, value->BoundConstant());
+    return;
+  }
+  const Location& location = value->definition()->location();
+  if (location.IsRegister()) {
+    if (location.reg() != dst) {
+      __ movl(dst, location.reg());
+    }
+  } else {
+    __ movl(dst, SpillSlotAddress(location.stack_index()));
+  }
+}
+
+
+void FlowGraphCompiler::PushValue(Value* value) {
+  if (value->IsConstant()) {
+    __ PushObject(value->BoundConstant());
+    return;
+  }
+  const Location& location = value->definition()->location();
+  if (location.IsRegister()) {
+    __ pushl(location.reg());
+  } else {
+    __ pushl(SpillSlotAddress(location.stack_index()));
+  }
+}
+
+
+void FlowGraphCompiler::PopToLocation(const Location& location) {
+  if (location.IsRegister()) {
+    __ popl(location.reg());
+  } else {
+    __ popl(SpillSlotAddress(location.stack_index()));
+  }
+}
+
+
+void FlowGraphCompiler::StoreResult(Definition* definition, Register src) {
+  if (definition->use_count() == 0) {
+    return;
+  }
+  const Location& location = definition->location();
+  if (location.IsRegister()) {
+    if (location.reg() != src) {
+      __ movl(location.reg(), src);
+    }
+  } else {
+    __ movl(SpillSlotAddress(location.stack_index()), src);
+  }
+}
+
+
+void FlowGraphCompiler::LoadDoubleOrSmi(XmmRegister dst,
+                                        Register reg,
+                                        Register temp,
+                                        Label* not_double_or_smi) {
+  const Class& double_class =
+      Class::ZoneHandle(Isolate::Current()->object_store()->double_class());
+  Label is_smi, done;
+  __ testl(reg, Immediate(kSmiTagMask));
+  __ j(ZERO, &is_smi);
+  __ movl(temp, FieldAddress(reg, Object::class_offset()));
+  __ CompareObject(temp, double_class);
+  __ j(NOT_EQUAL, not_double_or_smi);
+  __ movsd(dst, FieldAddress(reg, Double::value_offset()));
+  __ jmp(&done);
+  __ Bind(&is_smi);
+  __ SmiUntag(reg);
+  __ cvtsi2sd(dst, reg);
+  __ Bind(&done);
+}
+
+
+static Condition NegateCondition(Condition condition) {
+  switch (condition) {
+    case EQUAL:         return NOT_EQUAL;
+    case NOT_EQUAL:     return EQUAL;
+    case LESS:          return GREATER_EQUAL;
+    case LESS_EQUAL:    return GREATER;
+    case GREATER:       return LESS_EQUAL;
+    case GREATER_EQUAL: return LESS;
+    case BELOW:         return ABOVE_EQUAL;
+    case BELOW_EQUAL:   return ABOVE;
+    case ABOVE:         return BELOW_EQUAL;
+    case ABOVE_EQUAL:   return BELOW;
+    default:
+      UNIMPLEMENTED();
+      return EQUAL;
+  }
+}
+
+
+bool FlowGraphCompiler::CanFuseWithBranch(Definition* compare) const {
+  BranchInstr* branch = compare->next()->AsBranch();
+  return (branch != NULL) &&
+      (compare->use_count() == 1) &&
+      (branch->value()->definition() == compare);
+}
+
+
+// Materializes the result of a comparison whose condition codes are set, or
+// leaves them to the following branch. Unordered double comparisons are
+// false.
+void FlowGraphCompiler::EmitComparisonResult(Definition* compare,
+                                             Condition true_condition,
+                                             bool is_double) {
+  if (CanFuseWithBranch(compare)) {
+    fused_compare_ = compare;
+    fused_condition_ = true_condition;
+    fused_is_double_ = is_double;
+    return;
+  }
+  const Bool& bool_true = Bool::ZoneHandle(Bool::True());
+  const Bool& bool_false = Bool::ZoneHandle(Bool::False());
+  Label is_false, done;
+  if (is_double) {
+    __ j(PARITY_EVEN, &is_false);
+  }
+  __ j(NegateCondition(true_condition), &is_false);
+  __ LoadObject(EAX, bool_true);
+  __ jmp(&done);
+  __ Bind(&is_false);
+  __ LoadObject(EAX, bool_false);
+  __ Bind(&done);
+  StoreResult(compare, EAX);
+}
+
+
+void FlowGraphCompiler::EmitBranch(BranchInstr* branch,
+                                   Condition true_condition,
+                                   bool is_double) {
+  Label* true_label = GetBlockLabel(branch->true_successor());
+  Label* false_label = GetBlockLabel(branch->false_successor());
+  if (is_double) {
+    __ j(PARITY_EVEN, false_label);
+  }
+  if (IsNextBlock(branch->false_successor())) {
+    __ j(true_condition, true_label);
+  } else if (IsNextBlock(branch->true_successor())) {
+    __ j(NegateCondition(true_condition), false_label);
+  } else {
+    __ j(true_condition, true_label);
+    __ jmp(false_label);
+  }
+}
+
+
+void FlowGraphCompiler::GenerateDirectCall(intptr_t deopt_id,
+                                           intptr_t token_index,
+                                           const Function& function,
+                                           intptr_t argument_count,
+                                           const Array& argument_names) {
+  ASSERT(!function.IsNull());
+  const Code& code = Code::Handle(function.code());
+  ASSERT(!code.IsNull());
+  ExternalLabel target_label("DirectInstanceCall", code.EntryPoint());
+  __ LoadObject(ECX, function);
+  __ LoadObject(EDX, ArgumentsDescriptor(argument_count, argument_names));
+  __ call(&target_label);
+  AddCurrentDescriptor(PcDescriptors::kFuncCall, deopt_id, token_index);
+  __ addl(ESP, Immediate(argument_count * kWordSize));
+}
+
+
+void FlowGraphCompiler::VisitGraphEntry(GraphEntryInstr* instr) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphCompiler::VisitTargetEntry(TargetEntryInstr* instr) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphCompiler::VisitJoinEntry(JoinEntryInstr* instr) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphCompiler::VisitPhi(PhiInstr* instr) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphCompiler::VisitParameter(ParameterInstr* instr) {
+  LocalScope* scope = parsed_function().node_sequence()->scope();
+  const LocalVariable* parameter = scope->VariableAt(instr->index());
+  __ movl(EAX, Address(EBP, parameter->index() * kWordSize));
+  StoreResult(instr, EAX);
+}
+
+
+void FlowGraphCompiler::VisitConstant(ConstantInstr* instr) {
+  // Constants are materialized at their uses.
+}
+
+
+void FlowGraphCompiler::VisitLoadLocal(LoadLocalInstr* instr) {
+  UNREACHABLE();
+}
+
+
+void FlowGraphCompiler::VisitStoreLocal(StoreLocalInstr* instr) {
+  UNREACHABLE();
+}
+
+
+// Moves the phi inputs flowing in from the current block into the spill
+// slots of the phis. The moves happen in parallel, through the stack.
+void FlowGraphCompiler::VisitGoto(GotoInstr* instr) {
+  JoinEntryInstr* successor = instr->successor();
+  ZoneGrowableArray<PhiInstr*>* phis = successor->phis();
+  if (phis != NULL) {
+    const intptr_t predecessor_index =
+        successor->IndexOfPredecessor(current_block_);
+    GrowableArray<PhiInstr*> moved_phis(phis->length());
+    for (intptr_t i = 0; i < phis->length(); i++) {
+      PhiInstr* phi = (*phis)[i];
+      if (phi->use_count() > 0) {
+        PushValue(phi->InputAt(predecessor_index));
+        moved_phis.Add(phi);
+      }
+    }
+    for (intptr_t i = moved_phis.length() - 1; i >= 0; i--) {
+      PopToLocation(moved_phis[i]->location());
+    }
+  }
+  if (!IsNextBlock(successor)) {
+    __ jmp(GetBlockLabel(successor));
+  }
+}
+
+
+void FlowGraphCompiler::VisitBranch(BranchInstr* instr) {
+  if ((fused_compare_ != NULL) &&
+      (instr->value()->definition() == fused_compare_)) {
+    fused_compare_ = NULL;
+    EmitBranch(instr, fused_condition_, fused_is_double_);
+    return;
+  }
+  const Bool& bool_true = Bool::ZoneHandle(Bool::True());
+  LoadValue(EAX, instr->value());
+  __ CompareObject(EAX, bool_true);
+  EmitBranch(instr, EQUAL, false);
+}
+
+
+void FlowGraphCompiler::VisitReturn(ReturnInstr* instr) {
+  LoadValue(EAX, instr->value());
+  __ LeaveFrame();
+  __ ret();
+}
+
+
+void FlowGraphCompiler::VisitInstanceCall(InstanceCallInstr* instr) {
+  const ICData& ic_data = instr->ic_data();
+  if (ic_data.NumberOfChecks() == 0) {
+    // No type feedback, e.g., code not executed yet: call through an inline
+    // cache as unoptimized code does.
+    for (intptr_t i = 0; i < instr->ArgumentCount(); i++) {
+      PushValue(instr->ArgumentAt(i));
+    }
+    GenerateInstanceCall(instr->deopt_id(),
+                         instr->token_index(),
+                         instr->function_name(),
+                         instr->ArgumentCount(),
+                         instr->argument_names());
+    StoreResult(instr, EAX);
+    return;
+  }
+  // Call the targets recorded in the ICData directly, and deoptimize on
+  // other receiver classes. The receiver is checked before the arguments
+  // are pushed.
+  ASSERT(ic_data.NumberOfArgumentsChecked() == 1);
+  Label* deopt = AddDeoptimizationStub(instr);
+  const Class& smi_class =
+      Class::Handle(Isolate::Current()->object_store()->smi_class());
+  // The handles are embedded in the code and must not be reused.
+  ZoneGrowableArray<const Class*> classes(ic_data.NumberOfChecks());
+  ZoneGrowableArray<const Function*> targets(ic_data.NumberOfChecks());
+  intptr_t smi_check = -1;
+  for (intptr_t i = 0; i < ic_data.NumberOfChecks(); i++) {
+    Class& cls = Class::ZoneHandle();
+    Function& target = Function::ZoneHandle();
+    ic_data.GetOneClassCheckAt(i, &cls, &target);
+    if (cls.raw() == smi_class.raw()) {
+      smi_check = i;
+    }
+    classes.Add(&cls);
+    targets.Add(&target);
+  }
+  Label done;
+  LoadValue(EAX, instr->ArgumentAt(0));
+  // Smi receivers have no class field.
+  Label not_smi;
+  __ testl(EAX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &not_smi);
+  if (smi_check < 0) {
+    __ jmp(deopt);
+  } else {
+    for (intptr_t i = 0; i < instr->ArgumentCount(); i++) {
+      PushValue(instr->ArgumentAt(i));
+    }
+    GenerateDirectCall(instr->deopt_id(),
+                       instr->token_index(),
+                       *targets[smi_check],
+                       instr->ArgumentCount(),
+                       instr->argument_names());
+    __ jmp(&done);
+  }
+  __ Bind(&not_smi);
+  __ movl(EAX, FieldAddress(EAX, Object::class_offset()));
+  for (intptr_t i = 0; i < ic_data.NumberOfChecks(); i++) {
+    if (i == smi_check) continue;
+    Label next;
+    __ CompareObject(EAX, *classes[i]);
+    __ j(NOT_EQUAL, &next);
+    for (intptr_t j = 0; j < instr->ArgumentCount(); j++) {
+      PushValue(instr->ArgumentAt(j));
+    }
+    GenerateDirectCall(instr->deopt_id(),
+                       instr->token_index(),
+                       *targets[i],
+                       instr->ArgumentCount(),
+                       instr->argument_names());
+    __ jmp(&done);
+    __ Bind(&next);
+  }
+  __ jmp(deopt);
+  __ Bind(&done);
+  StoreResult(instr, EAX);
+}
+
+
+void FlowGraphCompiler::VisitStaticCall(StaticCallInstr* instr) {
+  for (intptr_t i = 0; i < instr->ArgumentCount(); i++) {
+    PushValue(instr->ArgumentAt(i));
+  }
+  __ LoadObject(ECX, instr->function());
+  __ LoadObject(EDX, ArgumentsDescriptor(instr->ArgumentCount(),
+                                         instr->argument_names()));
+  GenerateStaticCall(instr->token_index());
+  if (instr->ArgumentCount() > 0) {
+    __ addl(ESP, Immediate(instr->ArgumentCount() * kWordSize));
+  }
+  StoreResult(instr, EAX);
+}
+
+
+// A null receiver is compared by identity, other receivers call '=='.
+void FlowGraphCompiler::VisitEqualityCompare(EqualityCompareInstr* instr) {
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  const Bool& bool_true = Bool::ZoneHandle(Bool::True());
+  const Bool& bool_false = Bool::ZoneHandle(Bool::False());
+  const bool is_equal = (instr->kind() == Token::kEQ);
+  Label non_null_receiver, is_true, done;
+  LoadValue(EAX, instr->left());
+  LoadValue(EDX, instr->right());
+  __ cmpl(EAX, raw_null);
+  __ j(NOT_EQUAL, &non_null_receiver);
+  __ cmpl(EAX, EDX);
+  __ j(is_equal ? EQUAL : NOT_EQUAL, &is_true);
+  __ LoadObject(EAX, bool_false);
+  __ jmp(&done);
+  __ Bind(&non_null_receiver);
+  __ pushl(EAX);
+  __ pushl(EDX);
+  const String& operator_name =
+      String::ZoneHandle(String::NewSymbol(Token::Str(Token::kEQ)));
+  GenerateInstanceCall(instr->deopt_id(),
+                       instr->token_index(),
+                       operator_name,
+                       2,
+                       Array::ZoneHandle());
+  if (is_equal) {
+    __ jmp(&done);
+  } else {
+    __ CompareObject(EAX, bool_true);
+    __ j(NOT_EQUAL, &is_true);
+    __ LoadObject(EAX, bool_false);
+    __ jmp(&done);
+  }
+  __ Bind(&is_true);
+  __ LoadObject(EAX, bool_true);
+  __ Bind(&done);
+  StoreResult(instr, EAX);
+}
+
+
+void FlowGraphCompiler::VisitStrictCompare(StrictCompareInstr* instr) {
+  LoadValue(EAX, instr->left());
+  LoadValue(EDX, instr->right());
+  __ cmpl(EAX, EDX);
+  EmitComparisonResult(instr,
+                       (instr->kind() == Token::kEQ_STRICT) ? EQUAL : NOT_EQUAL,
+                       false);
+}
+
+
+void FlowGraphCompiler::VisitBooleanNegate(BooleanNegateInstr* instr) {
+  const Bool& bool_true = Bool::ZoneHandle(Bool::True());
+  const Bool& bool_false = Bool::ZoneHandle(Bool::False());
+  Label done;
+  LoadValue(EDX, instr->value());
+  __ LoadObject(EAX, bool_true);
+  __ cmpl(EAX, EDX);
+  __ j(NOT_EQUAL, &done);
+  __ LoadObject(EAX, bool_false);
+  __ Bind(&done);
+  StoreResult(instr, EAX);
+}
+
+
+void FlowGraphCompiler::VisitLoadInstanceField(LoadInstanceFieldInstr* instr) {
+  LoadValue(EAX, instr->instance());
+  __ movl(EAX, FieldAddress(EAX, instr->offset_in_bytes()));
+  StoreResult(instr, EAX);
+}
+
+
+void FlowGraphCompiler::VisitStoreInstanceField(
+    StoreInstanceFieldInstr* instr) {
+  LoadValue(EDX, instr->instance());
+  LoadValue(EAX, instr->value());
+  __ StoreIntoObject(EDX, FieldAddress(EDX, instr->offset_in_bytes()), EAX);
+  StoreResult(instr, EAX);
+}
+
+
+void FlowGraphCompiler::VisitLoadStaticField(LoadStaticFieldInstr* instr) {
+  __ LoadObject(EDX, instr->field());
+  __ movl(EAX, FieldAddress(EDX, Field::value_offset()));
+  StoreResult(instr, EAX);
+}
+
+
+void FlowGraphCompiler::VisitStoreStaticField(StoreStaticFieldInstr* instr) {
+  LoadValue(EAX, instr->value());
+  __ LoadObject(EDX, instr->field());
+  __ StoreIntoObject(EDX, FieldAddress(EDX, Field::value_offset()), EAX);
+  StoreResult(instr, EAX);
+}
+
+
+void FlowGraphCompiler::VisitCheckClass(CheckClassInstr* instr) {
+  const ICData& ic_data = instr->ic_data();
+  ASSERT(ic_data.NumberOfChecks() > 0);
+  ASSERT(ic_data.NumberOfArgumentsChecked() == 1);
+  Label* deopt = AddDeoptimizationStub(instr);
+  Function& target = Function::Handle();
+  Label is_ok;
+  LoadValue(EAX, instr->value());
+  __ testl(EAX, Immediate(kSmiTagMask));
+  __ j(ZERO, deopt);
+  __ movl(EAX, FieldAddress(EAX, Object::class_offset()));
+  const intptr_t last_check = ic_data.NumberOfChecks() - 1;
+  for (intptr_t i = 0; i <= last_check; i++) {
+    // The handle is embedded in the code and must not be reused.
+    Class& cls = Class::ZoneHandle();
+    ic_data.GetOneClassCheckAt(i, &cls, &target);
+    __ CompareObject(EAX, cls);
+    if (i == last_check) {
+      __ j(NOT_EQUAL, deopt);
+    } else {
+      __ j(EQUAL, &is_ok);
+    }
+  }
+  __ Bind(&is_ok);
+}
+
+
+void FlowGraphCompiler::VisitTestClass(TestClassInstr* instr) {
+  const ZoneGrowableArray<const Class*>& classes = instr->classes();
+  const Class& smi_class =
+      Class::ZoneHandle(Isolate::Current()->object_store()->smi_class());
+  Label not_smi, compare, done;
+  LoadValue(EAX, instr->value());
+  __ testl(EAX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &not_smi);
+  __ LoadObject(EAX, smi_class);
+  __ jmp(&compare);
+  __ Bind(&not_smi);
+  __ movl(EAX, FieldAddress(EAX, Object::class_offset()));
+  __ Bind(&compare);
+  // The condition codes of the last comparison, or of the matching one, are
+  // the result.
+  const intptr_t last_class = classes.length() - 1;
+  for (intptr_t i = 0; i <= last_class; i++) {
+    __ CompareObject(EAX, *classes[i]);
+    if (i < last_class) {
+      __ j(EQUAL, &done);
+    }
+  }
+  __ Bind(&done);
+  EmitComparisonResult(instr, EQUAL, false);
+}
+
+
+void FlowGraphCompiler::VisitBinarySmiOp(BinarySmiOpInstr* instr) {
+  Label* deopt = AddDeoptimizationStub(instr);
+  LoadValue(EAX, instr->left());
+  LoadValue(EDX, instr->right());
+  __ movl(ECX, EAX);
+  __ orl(ECX, EDX);
+  __ testl(ECX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, deopt);
+  switch (instr->op_kind()) {
+    case Token::kADD:
+      __ addl(EAX, EDX);
+      __ j(OVERFLOW, deopt);
+      break;
+    case Token::kSUB:
+      __ subl(EAX, EDX);
+      __ j(OVERFLOW, deopt);
+      break;
+    case Token::kMUL:
+      // One of the operands is untagged, the product is tagged.
+      __ SmiUntag(EAX);
+      __ imull(EAX, EDX);
+      __ j(OVERFLOW, deopt);
+      break;
+    case Token::kBIT_AND:
+      __ andl(EAX, EDX);
+      break;
+    case Token::kBIT_OR:
+      __ orl(EAX, EDX);
+      break;
+    case Token::kBIT_XOR:
+      __ xorl(EAX, EDX);
+      break;
+    default:
+      UNREACHABLE();
+  }
+  StoreResult(instr, EAX);
+}
+
+
+void FlowGraphCompiler::VisitBinaryDoubleOp(BinaryDoubleOpInstr* instr) {
+  Label* deopt = AddDeoptimizationStub(instr);
+  // Allocate the result first; the allocation may call into the runtime,
+  // which does not preserve the XMM registers. The operands are spilled
+  // across the call.
+  const Class& double_class =
+      Class::ZoneHandle(Isolate::Current()->object_store()->double_class());
+  const Code& stub =
+      Code::Handle(StubCode::GetAllocationStubForClass(double_class));
+  const ExternalLabel label(double_class.ToCString(), stub.EntryPoint());
+  GenerateCall(instr->token_index(), &label);
+  // The result stays in EAX.
+  LoadValue(EDX, instr->left());
+  LoadDoubleOrSmi(XMM0, EDX, ECX, deopt);
+  LoadValue(EDX, instr->right());
+  LoadDoubleOrSmi(XMM1, EDX, ECX, deopt);
+  switch (instr->op_kind()) {
+    case Token::kADD: __ addsd(XMM0, XMM1); break;
+    case Token::kSUB: __ subsd(XMM0, XMM1); break;
+    case Token::kMUL: __ mulsd(XMM0, XMM1); break;
+    case Token::kDIV: __ divsd(XMM0, XMM1); break;
+    default: UNREACHABLE();
+  }
+  __ movsd(FieldAddress(EAX, Double::value_offset()), XMM0);
+  StoreResult(instr, EAX);
+}
+
+
+static Condition SmiCondition(Token::Kind kind) {
+  switch (kind) {
+    case Token::kEQ:  return EQUAL;
+    case Token::kNE:  return NOT_EQUAL;
+    case Token::kLT:  return LESS;
+    case Token::kGT:  return GREATER;
+    case Token::kLTE: return LESS_EQUAL;
+    case Token::kGTE: return GREATER_EQUAL;
+    default:
+      UNREACHABLE();
+      return EQUAL;
+  }
+}
+
+
+static Condition DoubleCondition(Token::Kind kind) {
+  switch (kind) {
+    case Token::kEQ:  return EQUAL;
+    case Token::kLT:  return BELOW;
+    case Token::kGT:  return ABOVE;
+    case Token::kLTE: return BELOW_EQUAL;
+    case Token::kGTE: return ABOVE_EQUAL;
+    default:
+      UNREACHABLE();
+      return EQUAL;
+  }
+}
+
+
+void FlowGraphCompiler::VisitRelationalOp(RelationalOpInstr* instr) {
+  Label* deopt = AddDeoptimizationStub(instr);
+  LoadValue(EAX, instr->left());
+  LoadValue(EDX, instr->right());
+  if (instr->operands_class() == RelationalOpInstr::kSmiOperands) {
+    __ movl(ECX, EAX);
+    __ orl(ECX, EDX);
+    __ testl(ECX, Immediate(kSmiTagMask));
+    __ j(NOT_ZERO, deopt);
+    __ cmpl(EAX, EDX);
+    EmitComparisonResult(instr, SmiCondition(instr->kind()), false);
+  } else {
+    ASSERT(instr->operands_class() == RelationalOpInstr::kDoubleOperands);
+    LoadDoubleOrSmi(XMM0, EAX, ECX, deopt);
+    LoadDoubleOrSmi(XMM1, EDX, ECX, deopt);
+    __ comisd(XMM0, XMM1);
+    EmitComparisonResult(instr, DoubleCondition(instr->kind()), true);
+  }
+}
+
+
+void FlowGraphCompiler::VisitLoadIndexed(LoadIndexedInstr* instr) {
+  Label* deopt = AddDeoptimizationStub(instr);
+  LoadValue(ECX, instr->array());
+  LoadValue(EDX, instr->index());
+  __ testl(ECX, Immediate(kSmiTagMask));
+  __ j(ZERO, deopt);
+  __ movl(EAX, FieldAddress(ECX, Object::class_offset()));
+  __ CompareObject(EAX, instr->array_class());
+  __ j(NOT_EQUAL, deopt);
+  __ testl(EDX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, deopt);
+  // Range check; a negative index compares above the length.
+  __ cmpl(EDX, FieldAddress(ECX, Array::length_offset()));
+  __ j(ABOVE_EQUAL, deopt);
+  // Note that EDX is Smi, i.e, times 2.
+  ASSERT(kSmiTagShift == 1);
+  __ movl(EAX, FieldAddress(ECX, EDX, TIMES_2, sizeof(RawArray)));
+  StoreResult(instr, EAX);
+}
+
+
+void FlowGraphCompiler::VisitStoreIndexed(StoreIndexedInstr* instr) {
+  Label* deopt = AddDeoptimizationStub(instr);
+  const Class& array_class =
+      Class::ZoneHandle(Isolate::Current()->object_store()->array_class());
+  LoadValue(EAX, instr->array());
+  LoadValue(ECX, instr->index());
+  __ testl(EAX, Immediate(kSmiTagMask));
+  __ j(ZERO, deopt);
+  __ movl(EDX, FieldAddress(EAX, Object::class_offset()));
+  __ CompareObject(EDX, array_class);
+  __ j(NOT_EQUAL, deopt);
+  __ testl(ECX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, deopt);
+  __ cmpl(ECX, FieldAddress(EAX, Array::length_offset()));
+  __ j(ABOVE_EQUAL, deopt);
+  LoadValue(EDX, instr->value());
+  // Note that ECX is Smi, i.e, times 2.
+  ASSERT(kSmiTagShift == 1);
+  __ StoreIntoObject(EAX,
+                     FieldAddress(EAX, ECX, TIMES_2, sizeof(RawArray)),
+                     EDX);
+  StoreResult(instr, EDX);
+}
+
+#undef __
+
+}  // namespace dart
+
+#endif  // defined TARGET_ARCH_IA32
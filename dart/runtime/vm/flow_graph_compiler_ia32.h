@@ -0,0 +1,102 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_FLOW_GRAPH_COMPILER_IA32_H_
+#define VM_FLOW_GRAPH_COMPILER_IA32_H_
+
+#ifndef VM_FLOW_GRAPH_COMPILER_H_
+#error Do not include flow_graph_compiler_ia32.h; use flow_graph_compiler.h.
+#endif
+
+#include "vm/assembler.h"
+#include "vm/code_generator.h"
+#include "vm/flow_graph_builder.h"
+#include "vm/growable_array.h"
+#include "vm/intermediate_language.h"
+#include "vm/locations.h"
+
+namespace dart {
+
+// Generates optimized code from the flow graph of a function. The frame and
+// the entry code are the same as in unoptimized code; the values of the
+// graph live in the registers assigned by the FlowGraphAllocator or in spill
+// slots below the local variables, and deoptimization rebuilds the
+// unoptimized frame from the environments. The graph is emitted in place of
+// the function body.
+class FlowGraphCompiler : public CodeGenerator, public FlowGraphVisitor {
+ public:
+  FlowGraphCompiler(Assembler* assembler, const FlowGraph& flow_graph);
+
+  virtual void VisitSequenceNode(SequenceNode* node);
+
+#define DECLARE_VISIT(type)                                                    \
+  virtual void Visit##type(type##Instr* instr);
+FOR_EACH_INSTRUCTION(DECLARE_VISIT)
+#undef DECLARE_VISIT
+
+  virtual bool TryIntrinsify();
+  virtual void GeneratePreEntryCode();
+  virtual bool IsOptimizing() const { return true; }
+
+  virtual void CountBackwardLoop() {}
+  virtual void GenerateDeferredCode();
+
+ private:
+  class BlockLabel;
+  class DeoptimizationStub;
+
+  Label* GetBlockLabel(BlockEntryInstr* block) const;
+  bool IsNextBlock(BlockEntryInstr* block) const;
+
+  // Returns the label of the stub deoptimizing at 'instr'.
+  Label* AddDeoptimizationStub(Instruction* instr);
+  void GenerateDeoptimizationStub(DeoptimizationStub* stub);
+
+  Address SpillSlotAddress(intptr_t index) const;
+  void LoadValue(Register dst, Value* value);
+  void PushValue(Value* value);
+  void PopToLocation(const Location& location);
+  // Stores the result of 'definition' in its location if it is used.
+  void StoreResult(Definition* definition, Register src);
+
+  // Checks that the value in 'reg' is a double or a Smi and loads it into
+  // 'dst'; 'reg' and 'temp' are clobbered.
+  void LoadDoubleOrSmi(XmmRegister dst,
+                       Register reg,
+                       Register temp,
+                       Label* not_double_or_smi);
+
+  // Returns true if the branch following 'compare' is its only use; the
+  // comparison then sets the condition codes only, and the branch jumps on
+  // them.
+  bool CanFuseWithBranch(Definition* compare) const;
+  void EmitComparisonResult(Definition* compare,
+                            Condition true_condition,
+                            bool is_double);
+  void EmitBranch(BranchInstr* branch,
+                  Condition true_condition,
+                  bool is_double);
+
+  void GenerateDirectCall(intptr_t deopt_id,
+                          intptr_t token_index,
+                          const Function& function,
+                          intptr_t argument_count,
+                          const Array& argument_names);
+
+  const FlowGraph& flow_graph_;
+  GrowableArray<BlockLabel*> block_labels_;
+  GrowableArray<DeoptimizationStub*> deoptimization_stubs_;
+  BlockEntryInstr* current_block_;
+  // The comparison whose condition codes the next branch jumps on.
+  Definition* fused_compare_;
+  Condition fused_condition_;
+  bool fused_is_double_;
+  intptr_t spill_slot_count_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(FlowGraphCompiler);
+};
+
+}  // namespace dart
+
+#endif  // VM_FLOW_GRAPH_COMPILER_IA32_H_
@@ -0,0 +1,205 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/globals.h"
+#if defined(TARGET_ARCH_IA32)
+
+#include "vm/flow_graph_compiler.h"
+
+#include "vm/assert.h"
+#include "vm/class_finalizer.h"
+#include "vm/compiler.h"
+#include "vm/dart_entry.h"
+#include "vm/flags.h"
+#include "vm/flow_graph_builder.h"
+#include "vm/object.h"
+#include "vm/parser.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(bool, use_ssa);
+
+static RawClass* CompileScript(const char* script_chars) {
+  String& url = String::Handle(String::New("dart-test:FlowGraphCompiler"));
+  String& source = String::Handle(String::New(script_chars));
+  Script& script = Script::Handle(Script::New(url, source, RawScript::kSource));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  EXPECT(ClassFinalizer::FinalizePendingClasses());
+  return lib.LookupClass(String::Handle(String::NewSymbol("A")));
+}
+
+
+static RawFunction* LookupFunction(const Class& cls, const char* name) {
+  const Function& function = Function::Handle(
+      cls.LookupStaticFunction(String::Handle(String::New(name))));
+  EXPECT(!function.IsNull());
+  return function.raw();
+}
+
+
+static RawInstance* Invoke(const Function& function,
+                           const Object& arg0,
+                           const Object& arg1) {
+  GrowableArray<const Object*> arguments;
+  arguments.Add(&arg0);
+  arguments.Add(&arg1);
+  const Array& kNoArgumentNames = Array::Handle();
+  return DartEntry::InvokeStatic(function, arguments, kNoArgumentNames);
+}
+
+
+// Compiles the optimized code of 'function' from its flow graph, using the
+// type feedback of its unoptimized code.
+static void OptimizeFromFlowGraph(const Function& function) {
+  ParsedFunction parsed_function(function);
+  Parser::ParseFunction(&parsed_function);
+  FlowGraphBuilder builder(parsed_function);
+  // The optimizing code generator would be used otherwise.
+  EXPECT(builder.BuildGraph() != NULL);
+  const bool saved_use_ssa = FLAG_use_ssa;
+  FLAG_use_ssa = true;
+  Compiler::CompileOptimizedFunction(function);
+  FLAG_use_ssa = saved_use_ssa;
+  EXPECT(Code::Handle(function.code()).is_optimized());
+}
+
+
+// Runs 'name' on each pair of arguments in unoptimized code, optimizes it
+// and checks that the optimized code returns the same results without
+// deoptimizing.
+static void CompareWithUnoptimized(const Class& cls,
+                                   const char* name,
+                                   const Object** args,
+                                   intptr_t pair_count) {
+  const Function& function = Function::Handle(LookupFunction(cls, name));
+  const Array& expected = Array::Handle(Array::New(pair_count));
+  Instance& result = Instance::Handle();
+  for (intptr_t i = 0; i < pair_count; i++) {
+    result = Invoke(function, *args[2 * i], *args[2 * i + 1]);
+    expected.SetAt(i, result);
+  }
+  OptimizeFromFlowGraph(function);
+  Instance& expected_result = Instance::Handle();
+  for (intptr_t i = 0; i < pair_count; i++) {
+    result = Invoke(function, *args[2 * i], *args[2 * i + 1]);
+    expected_result ^= expected.At(i);
+    EXPECT(result.Equals(expected_result));
+  }
+  EXPECT(Code::Handle(function.code()).is_optimized());
+  EXPECT_EQ(0, function.deoptimization_counter());
+}
+
+
+TEST_CASE(FlowGraphCompiler_SmiLoop) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static sum(n, step) {\n"
+      "    var s = 0;\n"
+      "    for (var i = 0; i < n; i = i + step) {\n"
+      "      if ((i & 1) == 0) {\n"
+      "        s = s + i * 3;\n"
+      "      } else {\n"
+      "        s = s - (i | 4) + (i ^ 2);\n"
+      "      }\n"
+      "    }\n"
+      "    return s;\n"
+      "  }\n"
+      "}\n";
+  const Class& cls = Class::Handle(CompileScript(kScriptChars));
+  const Smi& zero = Smi::Handle(Smi::New(0));
+  const Smi& one = Smi::Handle(Smi::New(1));
+  const Smi& two = Smi::Handle(Smi::New(2));
+  const Smi& hundred = Smi::Handle(Smi::New(100));
+  const Object* args[] = { &hundred, &one, &hundred, &two, &zero, &one };
+  CompareWithUnoptimized(cls, "sum", args, ARRAY_SIZE(args) / 2);
+}
+
+
+TEST_CASE(FlowGraphCompiler_Doubles) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static compute(a, b) {\n"
+      "    var r = (a + b) * a / b - a;\n"
+      "    if (r < a) {\n"
+      "      return r;\n"
+      "    }\n"
+      "    return r >= b;\n"
+      "  }\n"
+      "}\n";
+  const Class& cls = Class::Handle(CompileScript(kScriptChars));
+  const Double& small = Double::Handle(Double::New(1.5));
+  const Double& large = Double::Handle(Double::New(7.25));
+  const Object* args[] = { &small, &large, &large, &small };
+  CompareWithUnoptimized(cls, "compute", args, ARRAY_SIZE(args) / 2);
+}
+
+
+TEST_CASE(FlowGraphCompiler_ArraysAndFields) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static var total;\n"
+      "  static fill(a, n) {\n"
+      "    total = 0;\n"
+      "    for (var i = 0; i < n; i = i + 1) {\n"
+      "      a[i] = i * i;\n"
+      "    }\n"
+      "    for (var i = 0; i < n; i = i + 1) {\n"
+      "      total = total + a[i];\n"
+      "    }\n"
+      "    return total;\n"
+      "  }\n"
+      "  static same(a, b) {\n"
+      "    if (a === b) return 1;\n"
+      "    if (a == null) return 2;\n"
+      "    if (a != b) return 3;\n"
+      "    return !(a == b);\n"
+      "  }\n"
+      "}\n";
+  const Class& cls = Class::Handle(CompileScript(kScriptChars));
+  const intptr_t kLength = 10;
+  const Array& array = Array::Handle(Array::New(kLength));
+  const Smi& length = Smi::Handle(Smi::New(kLength));
+  const Smi& half = Smi::Handle(Smi::New(kLength / 2));
+  const Object* fill_args[] = { &array, &length, &array, &half };
+  CompareWithUnoptimized(cls, "fill", fill_args, ARRAY_SIZE(fill_args) / 2);
+
+  const Smi& one = Smi::Handle(Smi::New(1));
+  const Smi& two = Smi::Handle(Smi::New(2));
+  const Object& null_object = Object::Handle();
+  const Object* same_args[] = {
+    &one, &one, &null_object, &one, &one, &two, &array, &null_object
+  };
+  CompareWithUnoptimized(cls, "same", same_args, ARRAY_SIZE(same_args) / 2);
+}
+
+
+// An overflowing Smi operation deoptimizes and the unoptimized code computes
+// the result.
+TEST_CASE(FlowGraphCompiler_DeoptimizeOnOverflow) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static add(a, b) {\n"
+      "    return a + b;\n"
+      "  }\n"
+      "}\n";
+  const Class& cls = Class::Handle(CompileScript(kScriptChars));
+  const Function& add = Function::Handle(LookupFunction(cls, "add"));
+  const Smi& one = Smi::Handle(Smi::New(1));
+  const Smi& max = Smi::Handle(Smi::New(Smi::kMaxValue));
+  Instance& result = Instance::Handle(Invoke(add, one, one));
+  EXPECT(result.IsSmi());
+  const Instance& expected = Instance::Handle(Invoke(add, max, one));
+  EXPECT(expected.IsMint());
+  OptimizeFromFlowGraph(add);
+  result = Invoke(add, max, one);
+  EXPECT(result.Equals(expected));
+  EXPECT(!Code::Handle(add.code()).is_optimized());
+  EXPECT_EQ(1, add.deoptimization_counter());
+}
+
+}  // namespace dart
+
+#endif  // defined TARGET_ARCH_IA32
@@ -0,0 +1,486 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/flow_graph_inliner.h"
+
+#include "vm/compiler.h"
+#include "vm/flags.h"
+#include "vm/flow_graph_builder.h"
+#include "vm/flow_graph_optimizer.h"
+#include "vm/object_store.h"
+#include "vm/os.h"
+#include "vm/parser.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, use_inlining, true,
+    "Inline small methods, on IA32 with --use_ssa only.");
+DEFINE_FLAG(bool, trace_inlining, false, "Trace the inlining of calls.");
+DEFINE_FLAG(int, inlining_size_threshold, 25,
+    "Maximum number of instructions of an inlined method.");
+DEFINE_FLAG(int, inlining_depth_threshold, 3,
+    "Maximum nesting of inlined calls.");
+DEFINE_FLAG(int, inlining_growth_threshold, 250,
+    "Maximum number of instructions inlined into one function.");
+DEFINE_FLAG(int, inlining_targets_threshold, 3,
+    "Maximum number of targets of an inlined call.");
+DECLARE_FLAG(int, deoptimization_counter_threshold);
+DECLARE_FLAG(bool, print_flow_graph);
+
+
+static void TraceInlining(InstanceCallInstr* call, const char* message) {
+  if (FLAG_trace_inlining) {
+    OS::Print("  %s (token %d): %s\n",
+              call->function_name().ToCString(),
+              call->token_index(),
+              message);
+  }
+}
+
+
+// A target of an inlined call, with the receiver classes dispatching to it
+// and the flow graph inlined for it, which refers to the parsed function.
+class FlowGraphInliner::InliningTarget : public ZoneAllocated {
+ public:
+  explicit InliningTarget(const Function& function)
+      : function_(function),
+        classes_(new ZoneGrowableArray<const Class*>()),
+        parsed_function_(function),
+        graph_(NULL) {
+    ASSERT(function.IsZoneHandle());
+  }
+
+  const Function& function() const { return function_; }
+  ZoneGrowableArray<const Class*>* classes() const { return classes_; }
+  ParsedFunction* parsed_function() { return &parsed_function_; }
+  FlowGraph* graph() const { return graph_; }
+  void set_graph(FlowGraph* graph) { graph_ = graph; }
+
+ private:
+  const Function& function_;
+  ZoneGrowableArray<const Class*>* classes_;
+  ParsedFunction parsed_function_;
+  FlowGraph* graph_;
+
+  DISALLOW_COPY_AND_ASSIGN(InliningTarget);
+};
+
+
+FlowGraphInliner::FlowGraphInliner(FlowGraph* flow_graph)
+    : flow_graph_(flow_graph),
+      active_functions_(),
+      inlined_size_(0) { }
+
+
+void FlowGraphInliner::Inline() {
+  if (!FLAG_use_inlining) {
+    return;
+  }
+  const Function& function = flow_graph_->parsed_function().function();
+  if (FLAG_trace_inlining) {
+    OS::Print("Inlining calls of '%s'\n", function.ToFullyQualifiedCString());
+  }
+  active_functions_.Add(&function);
+  InlineCalls(flow_graph_, 0);
+  active_functions_.RemoveLast();
+  if (FLAG_print_flow_graph && (inlined_size_ > 0)) {
+    flow_graph_->Print("After inlining");
+  }
+}
+
+
+void FlowGraphInliner::InlineCalls(FlowGraph* graph, intptr_t depth) {
+  // Inlining splits blocks; collect the calls first.
+  GrowableArray<InstanceCallInstr*> calls;
+  const GrowableArray<BlockEntryInstr*>& blocks = graph->preorder();
+  for (intptr_t i = 0; i < blocks.length(); i++) {
+    for (Instruction* instr = blocks[i]->next();
+         instr != NULL;
+         instr = instr->next()) {
+      InstanceCallInstr* call = instr->AsInstanceCall();
+      if (call != NULL) {
+        calls.Add(call);
+      }
+    }
+  }
+  bool changed = false;
+  for (intptr_t i = 0; i < calls.length(); i++) {
+    if (TryInlining(calls[i], depth)) {
+      changed = true;
+    }
+  }
+  if (changed) {
+    graph->DiscoverBlocks();
+    graph->ResolveValues();
+    graph->ComputeUseCounts();
+  }
+}
+
+
+bool FlowGraphInliner::IsActive(const Function& function) const {
+  for (intptr_t i = 0; i < active_functions_.length(); i++) {
+    if (active_functions_[i]->raw() == function.raw()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+// Returns NULL if 'target' may be inlined at 'call', otherwise the reason why
+// not.
+static const char* CheckInliningTarget(InstanceCallInstr* call,
+                                       const Function& target) {
+  // Implicit accessors are replaced by field accesses in the optimizer.
+  if ((target.kind() != RawFunction::kFunction) &&
+      (target.kind() != RawFunction::kGetterFunction) &&
+      (target.kind() != RawFunction::kSetterFunction)) {
+    return "implicit accessor";
+  }
+  if (target.is_static() ||
+      !target.is_optimizable() ||
+      (target.num_optional_parameters() > 0) ||
+      (target.num_fixed_parameters() != call->ArgumentCount()) ||
+      Code::Handle(target.unoptimized_code()).IsNull()) {
+    return "unsupported target";
+  }
+  // The type feedback of the target is not used once it deoptimized too
+  // often, see CompileFunctionHelper.
+  if (target.deoptimization_counter() >=
+      FLAG_deoptimization_counter_threshold) {
+    return "target deoptimized too often";
+  }
+  return NULL;
+}
+
+
+bool FlowGraphInliner::GetInliningTargets(
+    InstanceCallInstr* call,
+    GrowableArray<InliningTarget*>* targets) const {
+  const ICData& ic_data = call->ic_data();
+  if ((ic_data.NumberOfChecks() == 0) ||
+      !call->argument_names().IsNull() ||
+      !call->CanDeoptimize()) {
+    return false;
+  }
+  ASSERT(ic_data.NumberOfArgumentsChecked() == 1);
+  const Class& smi_class =
+      Class::Handle(Isolate::Current()->object_store()->smi_class());
+  Function& target = Function::Handle();
+  for (intptr_t i = 0; i < ic_data.NumberOfChecks(); i++) {
+    // The handle is embedded in the code and must not be reused.
+    Class& cls = Class::ZoneHandle();
+    ic_data.GetOneClassCheckAt(i, &cls, &target);
+    // The class check of the receiver deoptimizes on Smis.
+    if (cls.raw() == smi_class.raw()) {
+      TraceInlining(call, "Smi receiver");
+      return false;
+    }
+    InliningTarget* inlining_target = NULL;
+    for (intptr_t j = 0; j < targets->length(); j++) {
+      if ((*targets)[j]->function().raw() == target.raw()) {
+        inlining_target = (*targets)[j];
+      }
+    }
+    if (inlining_target == NULL) {
+      if (targets->length() == FLAG_inlining_targets_threshold) {
+        TraceInlining(call, "too many targets");
+        return false;
+      }
+      const char* reason = CheckInliningTarget(call, target);
+      if (reason != NULL) {
+        TraceInlining(call, reason);
+        return false;
+      }
+      inlining_target =
+          new InliningTarget(Function::ZoneHandle(target.raw()));
+      targets->Add(inlining_target);
+    }
+    inlining_target->classes()->Add(&cls);
+  }
+  return true;
+}
+
+
+// Returns NULL if the flow graph of a callee may be inlined, otherwise the
+// reason why not. All deoptimization points of an inlined body deoptimize to
+// the call, so none may follow an instruction with side effects on any path
+// through the body. Blocks are visited in reverse postorder; a predecessor
+// not visited yet, i.e., a loop back edge, is assumed to have side effects.
+static const char* CheckInlinedBody(const FlowGraph& graph, intptr_t* size) {
+  const GrowableArray<BlockEntryInstr*>& postorder = graph.postorder();
+  GrowableArray<bool> has_side_effects(postorder.length());
+  for (intptr_t i = 0; i < postorder.length(); i++) {
+    has_side_effects.Add(false);
+  }
+  intptr_t return_count = 0;
+  *size = 0;
+  for (intptr_t i = postorder.length() - 1; i >= 0; i--) {
+    BlockEntryInstr* block = postorder[i];
+    bool side_effects = false;
+    for (intptr_t j = 0; j < block->PredecessorCount(); j++) {
+      const intptr_t predecessor = block->PredecessorAt(j)->postorder_number();
+      if ((predecessor <= i) || has_side_effects[predecessor]) {
+        side_effects = true;
+      }
+    }
+    for (Instruction* instr = block->next();
+         instr != NULL;
+         instr = instr->next()) {
+      if (instr->IsInstanceCall() ||
+          instr->IsStaticCall() ||
+          instr->IsEqualityCompare()) {
+        return "call in body";
+      }
+      if (side_effects && instr->CanDeoptimize()) {
+        return "deoptimization after side effect";
+      }
+      if (instr->IsStoreInstanceField() ||
+          instr->IsStoreStaticField() ||
+          instr->IsStoreIndexed()) {
+        side_effects = true;
+      }
+      if (instr->IsReturn()) {
+        return_count++;
+      }
+      if (!instr->IsConstant() && !instr->IsParameter() && !instr->IsGoto()) {
+        (*size)++;
+      }
+    }
+    has_side_effects[i] = side_effects;
+  }
+  if (return_count == 0) {
+    return "no return";
+  }
+  if (*size > FLAG_inlining_size_threshold) {
+    return "too large";
+  }
+  return NULL;
+}
+
+
+FlowGraph* FlowGraphInliner::BuildInlinedGraph(InstanceCallInstr* call,
+                                               InliningTarget* target,
+                                               intptr_t depth,
+                                               intptr_t* size) {
+  const Function& function = target->function();
+  if (IsActive(function)) {
+    TraceInlining(call, "recursive call");
+    return NULL;
+  }
+  ParsedFunction* parsed_function = target->parsed_function();
+  Parser::ParseFunction(parsed_function);
+  Compiler::ExtractTypeFeedback(Code::Handle(function.unoptimized_code()),
+                                parsed_function->node_sequence());
+  FlowGraphBuilder builder(*parsed_function);
+  FlowGraph* callee_graph = builder.BuildGraph();
+  if (callee_graph == NULL) {
+    TraceInlining(call, "no flow graph");
+    return NULL;
+  }
+  if (depth + 1 < FLAG_inlining_depth_threshold) {
+    active_functions_.Add(&function);
+    InlineCalls(callee_graph, depth + 1);
+    active_functions_.RemoveLast();
+  }
+  FlowGraphOptimizer optimizer(callee_graph);
+  optimizer.ApplyTypeFeedback();
+  const char* reason = CheckInlinedBody(*callee_graph, size);
+  if (reason != NULL) {
+    TraceInlining(call, reason);
+    return NULL;
+  }
+  return callee_graph;
+}
+
+
+bool FlowGraphInliner::TryInlining(InstanceCallInstr* call, intptr_t depth) {
+  GrowableArray<InliningTarget*> targets;
+  if (!GetInliningTargets(call, &targets)) {
+    return false;
+  }
+  if (inlined_size_ >= FLAG_inlining_growth_threshold) {
+    TraceInlining(call, "caller too large");
+    return false;
+  }
+  // All targets are inlined, or none.
+  intptr_t size = 0;
+  for (intptr_t i = 0; i < targets.length(); i++) {
+    intptr_t target_size = 0;
+    FlowGraph* callee_graph =
+        BuildInlinedGraph(call, targets[i], depth, &target_size);
+    if (callee_graph == NULL) {
+      return false;
+    }
+    targets[i]->set_graph(callee_graph);
+    size += target_size;
+  }
+  InlineCall(call, targets);
+  if (depth == 0) {
+    inlined_size_ += size;
+  }
+  for (intptr_t i = 0; i < targets.length(); i++) {
+    TraceInlining(call, targets[i]->function().ToFullyQualifiedCString());
+  }
+  return true;
+}
+
+
+static BlockEntryInstr* GetBlock(Instruction* instr) {
+  while (!instr->IsBlockEntry()) {
+    instr = instr->previous();
+  }
+  return instr->AsBlockEntry();
+}
+
+
+// Replaces the parameters of the body of a callee by the arguments of 'call',
+// and makes its deoptimization points deoptimize to the call. Collects the
+// returns of the body. The blocks of the body are numbered again in the
+// graph of the caller.
+static void PrepareBody(InstanceCallInstr* call,
+                        FlowGraph* callee_graph,
+                        GrowableArray<ReturnInstr*>* returns) {
+  const GrowableArray<BlockEntryInstr*>& callee_blocks =
+      callee_graph->preorder();
+  for (intptr_t i = 0; i < callee_blocks.length(); i++) {
+    BlockEntryInstr* block = callee_blocks[i];
+    Instruction* instr = block->next();
+    while (instr != NULL) {
+      Instruction* next = instr->next();
+      ParameterInstr* parameter = instr->AsParameter();
+      if (parameter != NULL) {
+        parameter->set_replacement(
+            call->ArgumentAt(parameter->index())->definition());
+        parameter->RemoveFromGraph();
+      } else if (instr->CanDeoptimize()) {
+        instr->CopyDeoptimizationTarget(*call);
+      }
+      instr = next;
+    }
+    ReturnInstr* return_instr = block->last_instruction()->AsReturn();
+    if (return_instr != NULL) {
+      returns->Add(return_instr);
+    }
+    block->ClearNumbering();
+  }
+}
+
+
+// Links the body of a callee after 'previous', the last instruction of
+// 'block' so far. The returns of the body jump to 'join', their values are
+// added to 'results'.
+static void AppendBody(InstanceCallInstr* call,
+                       FlowGraph* callee_graph,
+                       BlockEntryInstr* block,
+                       Instruction* previous,
+                       JoinEntryInstr* join,
+                       GrowableArray<Definition*>* results) {
+  GrowableArray<ReturnInstr*> returns;
+  PrepareBody(call, callee_graph, &returns);
+  GraphEntryInstr* callee_entry = callee_graph->graph_entry();
+  Instruction* callee_last = callee_entry->last_instruction();
+  Instruction* first = callee_entry->next();
+  previous->set_next(first);
+  first->set_previous(previous);
+  block->set_last_instruction(callee_last);
+  for (intptr_t i = 0; i < callee_last->SuccessorCount(); i++) {
+    callee_last->SuccessorAt(i)->ReplacePredecessor(callee_entry, block);
+  }
+  for (intptr_t i = 0; i < returns.length(); i++) {
+    BlockEntryInstr* return_block = GetBlock(returns[i]);
+    GotoInstr* goto_instr = new GotoInstr(join);
+    returns[i]->ReplaceWith(goto_instr);
+    return_block->set_last_instruction(goto_instr);
+    join->AddPredecessor(return_block);
+    results->Add(returns[i]->value()->definition());
+  }
+}
+
+
+void FlowGraphInliner::InlineCall(
+    InstanceCallInstr* call,
+    const GrowableArray<InliningTarget*>& targets) {
+  // The last body is only valid for the receiver classes recorded for its
+  // target, the classes of the other targets are dispatched before.
+  Definition* receiver = call->ArgumentAt(0)->definition();
+  CheckClassInstr* check =
+      new CheckClassInstr(new Value(receiver), &call->ic_data());
+  check->CopyDeoptimizationTarget(*call);
+
+  BlockEntryInstr* call_block = GetBlock(call);
+  Instruction* previous = call->previous();
+  Instruction* next = call->next();
+  call->RemoveFromGraph();
+  FlowGraph* last_graph = targets.Last()->graph();
+  GraphEntryInstr* last_entry = last_graph->graph_entry();
+  if ((targets.length() == 1) && last_entry->last_instruction()->IsReturn()) {
+    // A single body of a single block replaces the call.
+    previous->InsertAfter(check);
+    previous = check;
+    GrowableArray<ReturnInstr*> returns;
+    PrepareBody(call, last_graph, &returns);
+    ASSERT(returns.length() == 1);
+    Instruction* instr = last_entry->next();
+    while (instr != returns[0]) {
+      Instruction* next_instr = instr->next();
+      instr->set_previous(NULL);
+      instr->set_next(NULL);
+      previous->InsertAfter(instr);
+      previous = instr;
+      instr = next_instr;
+    }
+    call->set_replacement(returns[0]->value()->definition());
+    return;
+  }
+
+  // The instructions following the call move to a new join, which the
+  // returns of the bodies jump to.
+  JoinEntryInstr* join = new JoinEntryInstr();
+  Instruction* call_block_last = call_block->last_instruction();
+  join->set_next(next);
+  next->set_previous(join);
+  join->set_last_instruction(call_block_last);
+  for (intptr_t i = 0; i < call_block_last->SuccessorCount(); i++) {
+    call_block_last->SuccessorAt(i)->ReplacePredecessor(call_block, join);
+  }
+  previous->set_next(NULL);
+  // Each but the last target is entered by a class test of the receiver,
+  // the block of the call continues with the first test.
+  GrowableArray<Definition*> results;
+  BlockEntryInstr* block = call_block;
+  const intptr_t last = targets.length() - 1;
+  for (intptr_t i = 0; i < last; i++) {
+    TestClassInstr* test =
+        new TestClassInstr(new Value(receiver), targets[i]->classes());
+    BranchInstr* branch = new BranchInstr(new Value(test));
+    previous->InsertAfter(test);
+    test->InsertAfter(branch);
+    block->set_last_instruction(branch);
+    TargetEntryInstr* is_class = new TargetEntryInstr();
+    TargetEntryInstr* other_class = new TargetEntryInstr();
+    branch->SetSuccessors(is_class, other_class);
+    is_class->AddPredecessor(block);
+    other_class->AddPredecessor(block);
+    AppendBody(call, targets[i]->graph(), is_class, is_class, join, &results);
+    block = other_class;
+    previous = other_class;
+  }
+  previous->InsertAfter(check);
+  AppendBody(call, last_graph, block, check, join, &results);
+  Definition* result = NULL;
+  if (results.length() == 1) {
+    result = results[0];
+  } else {
+    PhiInstr* phi = new PhiInstr(join, PhiInstr::kNoVariable);
+    for (intptr_t i = 0; i < results.length(); i++) {
+      phi->SetInputAt(i, new Value(results[i]));
+    }
+    join->AddPhi(phi);
+    result = phi;
+  }
+  call->set_replacement(result);
+}
+
+}  // namespace dart
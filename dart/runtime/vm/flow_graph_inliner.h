@@ -0,0 +1,69 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_FLOW_GRAPH_INLINER_H_
+#define VM_FLOW_GRAPH_INLINER_H_
+
+#include "vm/allocation.h"
+#include "vm/growable_array.h"
+#include "vm/intermediate_language.h"
+
+namespace dart {
+
+// Forward declarations.
+class FlowGraph;
+class Function;
+
+// Replaces instance calls by the flow graphs of the targets recorded in their
+// ICData. A call with a single target is replaced by its body, guarded by a
+// class check of the receiver which deoptimizes to the call in unoptimized
+// code. A call with several targets dispatches on the class of the receiver
+// to the body of each target; the last body is guarded by the class check.
+// Every other deoptimization point of a body deoptimizes to the call as well,
+// which re-executes it from the start; bodies with side effects before a
+// deoptimization point are therefore not inlined, nor are bodies which still
+// contain calls after applying their own type feedback. Calls in inlined
+// bodies are inlined up to a depth budget, and bodies are limited in size.
+//
+// Only the optimizing compiler of IA32 uses flow graphs, and only with
+// --use_ssa: inlining is opt-in.
+class FlowGraphInliner : public ValueObject {
+ public:
+  explicit FlowGraphInliner(FlowGraph* flow_graph);
+
+  void Inline();
+
+ private:
+  class InliningTarget;
+
+  void InlineCalls(FlowGraph* graph, intptr_t depth);
+  bool TryInlining(InstanceCallInstr* call, intptr_t depth);
+  // Collects the targets recorded for 'call' with their receiver classes, in
+  // the order of the ICData. Returns false if the call is not a candidate for
+  // inlining.
+  bool GetInliningTargets(InstanceCallInstr* call,
+                          GrowableArray<InliningTarget*>* targets) const;
+  // Returns the flow graph of 'target' to inline at 'call', or NULL if the
+  // target may not be inlined.
+  FlowGraph* BuildInlinedGraph(InstanceCallInstr* call,
+                               InliningTarget* target,
+                               intptr_t depth,
+                               intptr_t* size);
+  bool IsActive(const Function& function) const;
+  // Splices the graphs of the targets into the graph of 'call'.
+  void InlineCall(InstanceCallInstr* call,
+                  const GrowableArray<InliningTarget*>& targets);
+
+  FlowGraph* flow_graph_;
+  // The functions being inlined into, outermost first.
+  GrowableArray<const Function*> active_functions_;
+  // The number of instructions added to the graph so far.
+  intptr_t inlined_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlowGraphInliner);
+};
+
+}  // namespace dart
+
+#endif  // VM_FLOW_GRAPH_INLINER_H_
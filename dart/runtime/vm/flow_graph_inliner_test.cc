@@ -0,0 +1,274 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/flow_graph_inliner.h"
+
+#include "vm/assert.h"
+#include "vm/class_finalizer.h"
+#include "vm/compiler.h"
+#include "vm/dart_entry.h"
+#include "vm/flags.h"
+#include "vm/flow_graph_builder.h"
+#include "vm/object.h"
+#include "vm/parser.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(bool, use_ssa);
+
+// Compiler only implemented on IA32 and X64 now.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+
+// The flow graph refers to 'parsed_function', which must outlive it.
+static FlowGraph* BuildGraphWithTypeFeedback(ParsedFunction* parsed_function) {
+  Parser::ParseFunction(parsed_function);
+  const Function& function = parsed_function->function();
+  Compiler::ExtractTypeFeedback(Code::Handle(function.unoptimized_code()),
+                                parsed_function->node_sequence());
+  FlowGraphBuilder builder(*parsed_function);
+  return builder.BuildGraph();
+}
+
+
+static RawClass* CompileScript(const char* script_chars) {
+  String& url = String::Handle(String::New("dart-test:FlowGraphInliner"));
+  String& source = String::Handle(String::New(script_chars));
+  Script& script = Script::Handle(Script::New(url, source, RawScript::kSource));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  EXPECT(ClassFinalizer::FinalizePendingClasses());
+  return lib.LookupClass(String::Handle(String::NewSymbol("A")));
+}
+
+
+static RawFunction* LookupFunction(const Class& cls, const char* name) {
+  const Function& function = Function::Handle(
+      cls.LookupStaticFunction(String::Handle(String::New(name))));
+  EXPECT(!function.IsNull());
+  return function.raw();
+}
+
+
+static RawInstance* Invoke(const Function& function,
+                           const Object& arg0,
+                           const Object& arg1) {
+  GrowableArray<const Object*> arguments;
+  arguments.Add(&arg0);
+  arguments.Add(&arg1);
+  const Array& kNoArgumentNames = Array::Handle();
+  return DartEntry::InvokeStatic(function, arguments, kNoArgumentNames);
+}
+
+
+static intptr_t CountInstructions(const FlowGraph& flow_graph,
+                                  const char* name) {
+  intptr_t count = 0;
+  const GrowableArray<BlockEntryInstr*>& blocks = flow_graph.preorder();
+  for (intptr_t i = 0; i < blocks.length(); i++) {
+    for (Instruction* instr = blocks[i]->next();
+         instr != NULL;
+         instr = instr->next()) {
+      if (strcmp(instr->DebugName(), name) == 0) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+
+TEST_CASE(FlowGraphInliner_Getter) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  A(this._x);\n"
+      "  get x() { return _x + 1; }\n"
+      "  var _x;\n"
+      "  static make() { return new A(1); }\n"
+      "  static foo(a) { return a.x; }\n"
+      "  static bar(a) { return a.x; }\n"
+      "}\n";
+  String& url = String::Handle(String::New("dart-test:FlowGraphInliner"));
+  String& source = String::Handle(String::New(kScriptChars));
+  Script& script = Script::Handle(Script::New(url, source, RawScript::kSource));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  EXPECT(ClassFinalizer::FinalizePendingClasses());
+  Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(String::NewSymbol("A"))));
+  EXPECT(!cls.IsNull());
+  const Function& make = Function::ZoneHandle(
+      cls.LookupStaticFunction(String::Handle(String::New("make"))));
+  const Function& foo = Function::ZoneHandle(
+      cls.LookupStaticFunction(String::Handle(String::New("foo"))));
+  const Function& bar = Function::ZoneHandle(
+      cls.LookupStaticFunction(String::Handle(String::New("bar"))));
+  EXPECT(!make.IsNull() && !foo.IsNull() && !bar.IsNull());
+
+  // Run foo once to collect the type feedback of foo and of the getter.
+  GrowableArray<const Object*> arguments;
+  const Array& kNoArgumentNames = Array::Handle();
+  const Instance& a = Instance::Handle(
+      DartEntry::InvokeStatic(make, arguments, kNoArgumentNames));
+  EXPECT_EQ(cls.raw(), a.clazz());
+  arguments.Add(&a);
+  DartEntry::InvokeStatic(foo, arguments, kNoArgumentNames);
+  EXPECT(CompilerTest::TestCompileFunction(bar));
+
+  // The getter call is replaced by a check of the receiver class and the
+  // body of the getter.
+  ParsedFunction foo_parsed_function(foo);
+  FlowGraph* foo_graph = BuildGraphWithTypeFeedback(&foo_parsed_function);
+  EXPECT(foo_graph != NULL);
+  FlowGraphInliner foo_inliner(foo_graph);
+  foo_inliner.Inline();
+  EXPECT_EQ(0, CountInstructions(*foo_graph, "InstanceCall"));
+  EXPECT(CountInstructions(*foo_graph, "CheckClass") > 0);
+  EXPECT_EQ(1, CountInstructions(*foo_graph, "BinarySmiOp"));
+
+  // Calls without type feedback stay.
+  ParsedFunction bar_parsed_function(bar);
+  FlowGraph* bar_graph = BuildGraphWithTypeFeedback(&bar_parsed_function);
+  EXPECT(bar_graph != NULL);
+  FlowGraphInliner bar_inliner(bar_graph);
+  bar_inliner.Inline();
+  EXPECT_EQ(1, CountInstructions(*bar_graph, "InstanceCall"));
+}
+
+
+// Receivers of the classes A, B and C answer 2, 6 and 7 to 'x'.
+static const char* kReceiversScriptChars =
+    "class A {\n"
+    "  A(this._x);\n"
+    "  get x() { return _x + 1; }\n"
+    "  var _x;\n"
+    "  static make(k) {\n"
+    "    if (k == 0) return new A(1);\n"
+    "    if (k == 1) return new B(3);\n"
+    "    return new C();\n"
+    "  }\n"
+    "  static sum(a, n) {\n"
+    "    var s = 0;\n"
+    "    for (var i = 0; i < n; i = i + 1) {\n"
+    "      s = s + a.x;\n"
+    "    }\n"
+    "    return s;\n"
+    "  }\n"
+    "}\n"
+    "class B {\n"
+    "  B(this._y);\n"
+    "  get x() { return _y * 2; }\n"
+    "  var _y;\n"
+    "}\n"
+    "class C {\n"
+    "  get x() { return 7; }\n"
+    "}\n";
+
+
+static RawInstance* MakeReceiver(const Class& cls, intptr_t kind) {
+  const Function& make = Function::Handle(LookupFunction(cls, "make"));
+  GrowableArray<const Object*> arguments;
+  const Smi& kind_smi = Smi::Handle(Smi::New(kind));
+  arguments.Add(&kind_smi);
+  const Array& kNoArgumentNames = Array::Handle();
+  return DartEntry::InvokeStatic(make, arguments, kNoArgumentNames);
+}
+
+
+// A call with two targets dispatches on the receiver class to both bodies.
+TEST_CASE(FlowGraphInliner_Polymorphic) {
+  const Class& cls = Class::Handle(CompileScript(kReceiversScriptChars));
+  const Function& sum = Function::ZoneHandle(LookupFunction(cls, "sum"));
+  const Instance& a = Instance::Handle(MakeReceiver(cls, 0));
+  const Instance& b = Instance::Handle(MakeReceiver(cls, 1));
+  const Smi& one = Smi::Handle(Smi::New(1));
+  Invoke(sum, a, one);
+  Invoke(sum, b, one);
+  ParsedFunction parsed_function(sum);
+  FlowGraph* graph = BuildGraphWithTypeFeedback(&parsed_function);
+  EXPECT(graph != NULL);
+  const intptr_t call_count = CountInstructions(*graph, "InstanceCall");
+  FlowGraphInliner inliner(graph);
+  inliner.Inline();
+  // The getter call is gone, the operators are left to the optimizer.
+  EXPECT_EQ(call_count - 1, CountInstructions(*graph, "InstanceCall"));
+  EXPECT_EQ(1, CountInstructions(*graph, "TestClass"));
+  EXPECT(CountInstructions(*graph, "CheckClass") > 0);
+  EXPECT_EQ(2, CountInstructions(*graph, "BinarySmiOp"));
+}
+
+
+// The flow graph is only compiled on IA32.
+#if defined(TARGET_ARCH_IA32)
+
+static void OptimizeFromFlowGraph(const Function& function) {
+  const bool saved_use_ssa = FLAG_use_ssa;
+  FLAG_use_ssa = true;
+  Compiler::CompileOptimizedFunction(function);
+  FLAG_use_ssa = saved_use_ssa;
+  EXPECT(Code::Handle(function.code()).is_optimized());
+}
+
+
+static void ExpectSmiResult(intptr_t expected, const Instance& result) {
+  EXPECT(result.IsSmi());
+  Smi& smi = Smi::Handle();
+  smi ^= result.raw();
+  EXPECT_EQ(expected, smi.Value());
+}
+
+
+// The inlined getter computes the result, a receiver of another class fails
+// the class check and deoptimizes.
+TEST_CASE(FlowGraphInliner_RunMonomorphic) {
+  const Class& cls = Class::Handle(CompileScript(kReceiversScriptChars));
+  const Function& sum = Function::ZoneHandle(LookupFunction(cls, "sum"));
+  const Instance& a = Instance::Handle(MakeReceiver(cls, 0));
+  const Instance& b = Instance::Handle(MakeReceiver(cls, 1));
+  const Smi& ten = Smi::Handle(Smi::New(10));
+  Instance& result = Instance::Handle(Invoke(sum, a, ten));
+  ExpectSmiResult(20, result);
+  OptimizeFromFlowGraph(sum);
+  result = Invoke(sum, a, ten);
+  ExpectSmiResult(20, result);
+  EXPECT(Code::Handle(sum.code()).is_optimized());
+  EXPECT_EQ(0, sum.deoptimization_counter());
+
+  result = Invoke(sum, b, ten);
+  ExpectSmiResult(60, result);
+  EXPECT(!Code::Handle(sum.code()).is_optimized());
+  EXPECT_EQ(1, sum.deoptimization_counter());
+}
+
+
+// Both inlined getters compute the result, a receiver of a third class fails
+// the class check and deoptimizes.
+TEST_CASE(FlowGraphInliner_RunPolymorphic) {
+  const Class& cls = Class::Handle(CompileScript(kReceiversScriptChars));
+  const Function& sum = Function::ZoneHandle(LookupFunction(cls, "sum"));
+  const Instance& a = Instance::Handle(MakeReceiver(cls, 0));
+  const Instance& b = Instance::Handle(MakeReceiver(cls, 1));
+  const Instance& c = Instance::Handle(MakeReceiver(cls, 2));
+  const Smi& ten = Smi::Handle(Smi::New(10));
+  Invoke(sum, a, ten);
+  Invoke(sum, b, ten);
+  OptimizeFromFlowGraph(sum);
+  Instance& result = Instance::Handle(Invoke(sum, a, ten));
+  ExpectSmiResult(20, result);
+  result = Invoke(sum, b, ten);
+  ExpectSmiResult(60, result);
+  EXPECT(Code::Handle(sum.code()).is_optimized());
+  EXPECT_EQ(0, sum.deoptimization_counter());
+
+  result = Invoke(sum, c, ten);
+  ExpectSmiResult(70, result);
+  EXPECT(!Code::Handle(sum.code()).is_optimized());
+  EXPECT_EQ(1, sum.deoptimization_counter());
+}
+
+#endif  // TARGET_ARCH_IA32
+
+#endif  // TARGET_ARCH_IA32 || TARGET_ARCH_X64
+
+}  // namespace dart
@@ -0,0 +1,317 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/flow_graph_optimizer.h"
+
+#include "vm/flags.h"
+#include "vm/flow_graph_builder.h"
+#include "vm/object_store.h"
+#include "vm/parser.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, trace_type_feedback, false,
+    "Trace the specialization of instance calls using type feedback.");
+DECLARE_FLAG(bool, print_flow_graph);
+
+
+void FlowGraphOptimizer::ApplyTypeFeedback() {
+  const GrowableArray<BlockEntryInstr*>& blocks = flow_graph_->preorder();
+  for (intptr_t i = 0; i < blocks.length(); i++) {
+    Instruction* instr = blocks[i]->next();
+    while (instr != NULL) {
+      // The visited instruction may be replaced.
+      Instruction* next = instr->next();
+      instr->Accept(this);
+      instr = next;
+    }
+  }
+  flow_graph_->ResolveValues();
+  flow_graph_->ComputeUseCounts();
+  if (FLAG_print_flow_graph) {
+    flow_graph_->Print("After type feedback");
+  }
+}
+
+
+static void TraceTypeFeedback(Instruction* instr, const char* message) {
+  if (FLAG_trace_type_feedback) {
+    OS::Print("  %s (token %d): %s\n",
+              instr->DebugName(), instr->token_index(), message);
+  }
+}
+
+
+// Returns true if 'ic_data' recorded exactly one receiver class, 'cls'.
+static bool HasOnlyReceiverClass(const ICData& ic_data, const Class& cls) {
+  if (ic_data.NumberOfChecks() != 1) {
+    return false;
+  }
+  ASSERT(ic_data.NumberOfArgumentsChecked() == 1);
+  Class& receiver_class = Class::Handle();
+  Function& target = Function::Handle();
+  ic_data.GetOneClassCheckAt(0, &receiver_class, &target);
+  return receiver_class.raw() == cls.raw();
+}
+
+
+static intptr_t GetFieldOffset(const Class& field_class,
+                               const String& field_name) {
+  Class& cls = Class::Handle(field_class.raw());
+  Field& field = Field::Handle();
+  while (!cls.IsNull()) {
+    field = cls.LookupInstanceField(field_name);
+    if (!field.IsNull()) {
+      return field.Offset();
+    }
+    cls = cls.SuperClass();
+  }
+  return -1;
+}
+
+
+// Returns the offset of the field accessed by all targets recorded in
+// 'ic_data' if they are implicit accessors of the same kind and of fields at
+// the same offset, otherwise -1. Smi receivers have no fields.
+static intptr_t GetImplicitAccessorFieldOffset(const ICData& ic_data,
+                                               RawFunction::Kind kind) {
+  if (ic_data.NumberOfChecks() == 0) {
+    return -1;
+  }
+  ASSERT(ic_data.NumberOfArgumentsChecked() == 1);
+  const Class& smi_class =
+      Class::Handle(Isolate::Current()->object_store()->smi_class());
+  Class& cls = Class::Handle();
+  Function& target = Function::Handle();
+  String& field_name = String::Handle();
+  intptr_t offset = -1;
+  for (intptr_t i = 0; i < ic_data.NumberOfChecks(); i++) {
+    ic_data.GetOneClassCheckAt(i, &cls, &target);
+    if ((cls.raw() == smi_class.raw()) || (target.kind() != kind)) {
+      return -1;
+    }
+    field_name = target.name();
+    field_name = (kind == RawFunction::kImplicitGetter)
+        ? Field::NameFromGetter(field_name)
+        : Field::NameFromSetter(field_name);
+    const intptr_t field_offset = GetFieldOffset(cls, field_name);
+    if ((field_offset < 0) || ((offset >= 0) && (field_offset != offset))) {
+      return -1;
+    }
+    offset = field_offset;
+  }
+  return offset;
+}
+
+
+void FlowGraphOptimizer::ReplaceCall(Definition* call,
+                                     Definition* replacement) {
+  replacement->CopyDeoptimizationTarget(*call);
+  call->ReplaceWith(replacement);
+  call->set_replacement(replacement);
+}
+
+
+bool FlowGraphOptimizer::TryReplaceWithBinaryOp(InstanceCallInstr* call) {
+  ASSERT(call->ArgumentCount() == 2);
+  const Token::Kind op_kind = call->token_kind();
+  ObjectStore* object_store = Isolate::Current()->object_store();
+  Definition* replacement = NULL;
+  if (HasOnlyReceiverClass(call->ic_data(),
+                           Class::Handle(object_store->smi_class()))) {
+    switch (op_kind) {
+      case Token::kADD:
+      case Token::kSUB:
+      case Token::kMUL:
+      case Token::kBIT_AND:
+      case Token::kBIT_OR:
+      case Token::kBIT_XOR:
+        replacement = new BinarySmiOpInstr(op_kind,
+                                           call->ArgumentAt(0),
+                                           call->ArgumentAt(1));
+        break;
+      default:
+        return false;
+    }
+  } else if (HasOnlyReceiverClass(
+      call->ic_data(), Class::Handle(object_store->double_class()))) {
+    switch (op_kind) {
+      case Token::kADD:
+      case Token::kSUB:
+      case Token::kMUL:
+      case Token::kDIV:
+        replacement = new BinaryDoubleOpInstr(op_kind,
+                                              call->ArgumentAt(0),
+                                              call->ArgumentAt(1));
+        break;
+      default:
+        return false;
+    }
+  } else {
+    return false;
+  }
+  TraceTypeFeedback(call, replacement->DebugName());
+  ReplaceCall(call, replacement);
+  return true;
+}
+
+
+bool FlowGraphOptimizer::TryReplaceWithRelationalOp(InstanceCallInstr* call) {
+  ASSERT(call->ArgumentCount() == 2);
+  ObjectStore* object_store = Isolate::Current()->object_store();
+  RelationalOpInstr::OperandsClass operands_class;
+  if (HasOnlyReceiverClass(call->ic_data(),
+                           Class::Handle(object_store->smi_class()))) {
+    operands_class = RelationalOpInstr::kSmiOperands;
+  } else if (HasOnlyReceiverClass(
+      call->ic_data(), Class::Handle(object_store->double_class()))) {
+    operands_class = RelationalOpInstr::kDoubleOperands;
+  } else {
+    return false;
+  }
+  RelationalOpInstr* replacement = new RelationalOpInstr(call->token_kind(),
+                                                         operands_class,
+                                                         call->ArgumentAt(0),
+                                                         call->ArgumentAt(1));
+  TraceTypeFeedback(call, replacement->DebugName());
+  ReplaceCall(call, replacement);
+  return true;
+}
+
+
+bool FlowGraphOptimizer::TryReplaceWithIndexedOp(InstanceCallInstr* call) {
+  ObjectStore* object_store = Isolate::Current()->object_store();
+  const Class& array_class = Class::ZoneHandle(object_store->array_class());
+  Definition* replacement = NULL;
+  if (call->token_kind() == Token::kINDEX) {
+    ASSERT(call->ArgumentCount() == 2);
+    const Class& immutable_array_class =
+        Class::ZoneHandle(object_store->immutable_array_class());
+    if (HasOnlyReceiverClass(call->ic_data(), array_class)) {
+      replacement = new LoadIndexedInstr(call->ArgumentAt(0),
+                                         call->ArgumentAt(1),
+                                         array_class);
+    } else if (HasOnlyReceiverClass(call->ic_data(), immutable_array_class)) {
+      replacement = new LoadIndexedInstr(call->ArgumentAt(0),
+                                         call->ArgumentAt(1),
+                                         immutable_array_class);
+    } else {
+      return false;
+    }
+  } else {
+    ASSERT(call->token_kind() == Token::kASSIGN_INDEX);
+    ASSERT(call->ArgumentCount() == 3);
+    if (!HasOnlyReceiverClass(call->ic_data(), array_class)) {
+      return false;
+    }
+    replacement = new StoreIndexedInstr(call->ArgumentAt(0),
+                                        call->ArgumentAt(1),
+                                        call->ArgumentAt(2));
+  }
+  TraceTypeFeedback(call, replacement->DebugName());
+  ReplaceCall(call, replacement);
+  return true;
+}
+
+
+bool FlowGraphOptimizer::TryInlineInstanceGetter(InstanceCallInstr* call) {
+  ASSERT(call->ArgumentCount() == 1);
+  const intptr_t offset = GetImplicitAccessorFieldOffset(
+      call->ic_data(), RawFunction::kImplicitGetter);
+  if (offset < 0) {
+    return false;
+  }
+  CheckClassInstr* check = new CheckClassInstr(call->ArgumentAt(0),
+                                               &call->ic_data());
+  check->CopyDeoptimizationTarget(*call);
+  call->previous()->InsertAfter(check);
+  LoadInstanceFieldInstr* load =
+      new LoadInstanceFieldInstr(call->ArgumentAt(0), offset);
+  TraceTypeFeedback(call, load->DebugName());
+  ReplaceCall(call, load);
+  return true;
+}
+
+
+bool FlowGraphOptimizer::TryInlineInstanceSetter(InstanceCallInstr* call) {
+  ASSERT(call->ArgumentCount() == 2);
+  const intptr_t offset = GetImplicitAccessorFieldOffset(
+      call->ic_data(), RawFunction::kImplicitSetter);
+  if (offset < 0) {
+    return false;
+  }
+  CheckClassInstr* check = new CheckClassInstr(call->ArgumentAt(0),
+                                               &call->ic_data());
+  check->CopyDeoptimizationTarget(*call);
+  call->previous()->InsertAfter(check);
+  StoreInstanceFieldInstr* store = new StoreInstanceFieldInstr(
+      call->ArgumentAt(0), call->ArgumentAt(1), offset);
+  TraceTypeFeedback(call, store->DebugName());
+  ReplaceCall(call, store);
+  return true;
+}
+
+
+void FlowGraphOptimizer::VisitInstanceCall(InstanceCallInstr* instr) {
+  if (instr->ic_data().NumberOfChecks() == 0) {
+    TraceTypeFeedback(instr, "no type feedback");
+    return;
+  }
+  switch (instr->token_kind()) {
+    case Token::kADD:
+    case Token::kSUB:
+    case Token::kMUL:
+    case Token::kDIV:
+    case Token::kBIT_AND:
+    case Token::kBIT_OR:
+    case Token::kBIT_XOR:
+      TryReplaceWithBinaryOp(instr);
+      break;
+    case Token::kLT:
+    case Token::kGT:
+    case Token::kLTE:
+    case Token::kGTE:
+      TryReplaceWithRelationalOp(instr);
+      break;
+    case Token::kINDEX:
+    case Token::kASSIGN_INDEX:
+      TryReplaceWithIndexedOp(instr);
+      break;
+    case Token::kGET:
+      TryInlineInstanceGetter(instr);
+      break;
+    case Token::kSET:
+      TryInlineInstanceSetter(instr);
+      break;
+    default:
+      break;
+  }
+}
+
+
+static bool IsNullConstant(Value* value) {
+  return value->IsConstant() && value->BoundConstant().IsNull();
+}
+
+
+void FlowGraphOptimizer::VisitEqualityCompare(EqualityCompareInstr* instr) {
+  // Comparisons with null are cheaper as identity checks than as Smi checks.
+  if (IsNullConstant(instr->left()) || IsNullConstant(instr->right())) {
+    return;
+  }
+  const Class& smi_class =
+      Class::Handle(Isolate::Current()->object_store()->smi_class());
+  if (!HasOnlyReceiverClass(instr->ic_data(), smi_class)) {
+    return;
+  }
+  RelationalOpInstr* replacement =
+      new RelationalOpInstr(instr->kind(),
+                            RelationalOpInstr::kSmiOperands,
+                            instr->left(),
+                            instr->right());
+  TraceTypeFeedback(instr, replacement->DebugName());
+  ReplaceCall(instr, replacement);
+}
+
+}  // namespace dart
@@ -0,0 +1,47 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_FLOW_GRAPH_OPTIMIZER_H_
+#define VM_FLOW_GRAPH_OPTIMIZER_H_
+
+#include "vm/allocation.h"
+#include "vm/intermediate_language.h"
+
+namespace dart {
+
+// Forward declarations.
+class FlowGraph;
+
+// Rewrites the instance calls of a flow graph whose ICData shows a single
+// receiver class (e.g., Smi arithmetic or implicit getters) into specialized
+// instructions which deoptimize if the assumption fails.
+class FlowGraphOptimizer : public FlowGraphVisitor {
+ public:
+  explicit FlowGraphOptimizer(FlowGraph* flow_graph)
+      : flow_graph_(flow_graph) { }
+  virtual ~FlowGraphOptimizer() { }
+
+  void ApplyTypeFeedback();
+
+  virtual void VisitInstanceCall(InstanceCallInstr* instr);
+  virtual void VisitEqualityCompare(EqualityCompareInstr* instr);
+
+ private:
+  bool TryReplaceWithBinaryOp(InstanceCallInstr* call);
+  bool TryReplaceWithRelationalOp(InstanceCallInstr* call);
+  bool TryReplaceWithIndexedOp(InstanceCallInstr* call);
+  bool TryInlineInstanceGetter(InstanceCallInstr* call);
+  bool TryInlineInstanceSetter(InstanceCallInstr* call);
+
+  // Replaces 'call' by 'replacement', which deoptimizes to the same point.
+  void ReplaceCall(Definition* call, Definition* replacement);
+
+  FlowGraph* flow_graph_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlowGraphOptimizer);
+};
+
+}  // namespace dart
+
+#endif  // VM_FLOW_GRAPH_OPTIMIZER_H_
@@ -0,0 +1,152 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/freelist.h"
+
+#include "vm/object.h"
+
+namespace dart {
+
+FreeListElement* FreeListElement::AsElement(uword addr, intptr_t size) {
+  ASSERT(size >= kObjectAlignment);
+  ASSERT(Utils::IsAligned(size, kObjectAlignment));
+  FreeListElement* result = reinterpret_cast<FreeListElement*>(addr);
+  result->class_ = Object::free_list_element_class();
+  result->size_ = size;
+  if (size > kObjectAlignment) {
+    result->next_ = NULL;
+  }
+  return result;
+}
+
+
+FreeList::FreeList() {
+  Reset();
+}
+
+
+intptr_t FreeList::NextNonEmptyIndex(intptr_t index) const {
+  while (index < kNumLists) {
+    uword bits = free_map_[index / kBitsPerWord] >> (index % kBitsPerWord);
+    if (bits == 0) {
+      // Skip the rest of this word.
+      index = Utils::RoundDown(index, kBitsPerWord) + kBitsPerWord;
+      continue;
+    }
+    while ((bits & 1) == 0) {
+      bits >>= 1;
+      index++;
+    }
+    return index;
+  }
+  return kLargeIndex;
+}
+
+
+FreeListElement* FreeList::Dequeue(intptr_t index) {
+  ASSERT(index < kNumLists);
+  FreeListElement* result = free_lists_[index];
+  ASSERT(result != NULL);
+  free_lists_[index] = result->next();
+  if (free_lists_[index] == NULL) {
+    Clear(index);
+  }
+  free_bytes_ -= result->size();
+  return result;
+}
+
+
+void FreeList::Enqueue(FreeListElement* element) {
+  intptr_t index = IndexForSize(element->size());
+  element->set_next(free_lists_[index]);
+  free_lists_[index] = element;
+  if (index < kNumLists) {
+    Set(index);
+  }
+  free_bytes_ += element->size();
+}
+
+
+FreeListElement* FreeList::TryAllocateLarge(intptr_t size) {
+  FreeListElement* previous = NULL;
+  FreeListElement* current = free_lists_[kLargeIndex];
+  FreeListElement* best_previous = NULL;
+  FreeListElement* best = NULL;
+  while (current != NULL) {
+    if ((current->size() >= size) &&
+        ((best == NULL) || (current->size() < best->size()))) {
+      best_previous = previous;
+      best = current;
+      if (current->size() == size) {
+        break;
+      }
+    }
+    previous = current;
+    current = current->next();
+  }
+  if (best != NULL) {
+    if (best_previous == NULL) {
+      free_lists_[kLargeIndex] = best->next();
+    } else {
+      best_previous->set_next(best->next());
+    }
+    free_bytes_ -= best->size();
+  }
+  return best;
+}
+
+
+void FreeList::SplitAndRelease(FreeListElement* element, intptr_t size) {
+  intptr_t remaining = element->size() - size;
+  ASSERT(remaining >= 0);
+  if (remaining > 0) {
+    Free(reinterpret_cast<uword>(element) + size, remaining);
+  }
+}
+
+
+uword FreeList::TryAllocate(intptr_t size) {
+  ASSERT(Utils::IsAligned(size, kObjectAlignment));
+  intptr_t index = IndexForSize(size);
+  FreeListElement* element = NULL;
+  if (index < kNumLists) {
+    // Exact fit first, otherwise split the smallest larger small block.
+    index = NextNonEmptyIndex(index);
+    if (index < kNumLists) {
+      element = Dequeue(index);
+    }
+  }
+  if (element == NULL) {
+    element = TryAllocateLarge(size);
+    if (element == NULL) {
+      return 0;
+    }
+  }
+  // Return the unused tail of the block to the free list.
+  SplitAndRelease(element, size);
+  return reinterpret_cast<uword>(element);
+}
+
+
+void FreeList::Free(uword addr, intptr_t size) {
+  FreeListElement* element = FreeListElement::AsElement(addr, size);
+  if (size == kObjectAlignment) {
+    // Too small to be linked, only keeps the page walkable.
+    return;
+  }
+  Enqueue(element);
+}
+
+
+void FreeList::Reset() {
+  for (intptr_t i = 0; i <= kNumLists; i++) {
+    free_lists_[i] = NULL;
+  }
+  for (intptr_t i = 0; i < kMaskLength; i++) {
+    free_map_[i] = 0;
+  }
+  free_bytes_ = 0;
+}
+
+}  // namespace dart
@@ -0,0 +1,118 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_FREELIST_H_
+#define VM_FREELIST_H_
+
+#include "vm/allocation.h"
+#include "vm/assert.h"
+#include "vm/globals.h"
+#include "vm/raw_object.h"
+#include "vm/utils.h"
+
+namespace dart {
+
+// FreeListElement describes a free block of memory in an old space page. It
+// looks like a regular object to heap walkers: its class_ field points to a
+// VM internal class with instance kind kFreeListElement and its size is
+// stored in the second word. Elements are at least kObjectAlignment bytes
+// large. Elements of exactly kObjectAlignment bytes have no room for a next
+// pointer and are only kept as fillers to keep the page walkable.
+class FreeListElement {
+ public:
+  FreeListElement* next() const {
+    ASSERT(size_ > kObjectAlignment);
+    return next_;
+  }
+  void set_next(FreeListElement* next) {
+    ASSERT(size_ > kObjectAlignment);
+    next_ = next;
+  }
+
+  intptr_t size() const { return size_; }
+
+  // Write a free list element header covering [addr, addr + size).
+  static FreeListElement* AsElement(uword addr, intptr_t size);
+
+  static intptr_t size_offset() { return OFFSET_OF(FreeListElement, size_); }
+
+ private:
+  // This layout mirrors the layout of RawObject.
+  RawClass* class_;
+  intptr_t size_;
+  FreeListElement* next_;
+
+  // FreeListElements cannot be allocated. Instead references to them are
+  // created using the AsElement factory method.
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(FreeListElement);
+};
+
+
+// FreeList keeps free blocks segregated by size. Blocks smaller than
+// kNumLists * kObjectAlignment bytes are kept in exact-fit lists, one per
+// size. Larger blocks are kept in a single list searched for the best fit.
+class FreeList {
+ public:
+  FreeList();
+  ~FreeList() {}
+
+  // Returns the address of a block of exactly 'size' bytes or 0 if no block
+  // large enough is available.
+  uword TryAllocate(intptr_t size);
+
+  // Add the block [addr, addr + size) to the free list.
+  void Free(uword addr, intptr_t size);
+
+  // Drop all elements. Used before the free list is rebuilt by sweeping.
+  void Reset();
+
+  // Number of bytes held in linked free list elements.
+  intptr_t free_bytes() const { return free_bytes_; }
+
+ private:
+  static const intptr_t kNumLists = 128;
+  static const intptr_t kLargeIndex = kNumLists;
+  static const intptr_t kMaskLength =
+      (kNumLists + kBitsPerWord - 1) / kBitsPerWord;
+
+  static intptr_t IndexForSize(intptr_t size) {
+    ASSERT(Utils::IsAligned(size, kObjectAlignment));
+    intptr_t index = size / kObjectAlignment;
+    return (index < kNumLists) ? index : kLargeIndex;
+  }
+
+  // Bits in free_map_ are set for the non-empty exact-fit lists, so that the
+  // smallest block larger than a request is found without walking them all.
+  bool IsSet(intptr_t index) const {
+    return (free_map_[index / kBitsPerWord] &
+            (static_cast<uword>(1) << (index % kBitsPerWord))) != 0;
+  }
+  void Set(intptr_t index) {
+    free_map_[index / kBitsPerWord] |=
+        (static_cast<uword>(1) << (index % kBitsPerWord));
+  }
+  void Clear(intptr_t index) {
+    free_map_[index / kBitsPerWord] &=
+        ~(static_cast<uword>(1) << (index % kBitsPerWord));
+  }
+  // Returns the first non-empty exact-fit list at or above 'index', or
+  // kLargeIndex if there is none.
+  intptr_t NextNonEmptyIndex(intptr_t index) const;
+
+  FreeListElement* Dequeue(intptr_t index);
+  void Enqueue(FreeListElement* element);
+  FreeListElement* TryAllocateLarge(intptr_t size);
+  void SplitAndRelease(FreeListElement* element, intptr_t size);
+
+  FreeListElement* free_lists_[kNumLists + 1];
+  uword free_map_[kMaskLength];
+  intptr_t free_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(FreeList);
+};
+
+}  // namespace dart
+
+#endif  // VM_FREELIST_H_
@@ -0,0 +1,50 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/assert.h"
+#include "vm/freelist.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+TEST_CASE(FreeList) {
+  const intptr_t kBlockSize = 64 * kObjectAlignment;
+  const intptr_t kBufferSize = 4 * kBlockSize + 2 * KB * kObjectAlignment;
+  uword* buffer = new uword[kBufferSize / kWordSize + 2];
+  uword base = Utils::RoundUp(reinterpret_cast<uword>(buffer),
+                              kObjectAlignment);
+  FreeList free_list;
+  EXPECT_EQ(static_cast<uword>(0), free_list.TryAllocate(kObjectAlignment * 2));
+
+  // Small blocks are reused exactly.
+  uword small = base;
+  free_list.Free(small, kBlockSize);
+  EXPECT_EQ(kBlockSize, free_list.free_bytes());
+  EXPECT_EQ(small, free_list.TryAllocate(kBlockSize));
+  EXPECT_EQ(0, free_list.free_bytes());
+
+  // A larger small block is split and its tail reused.
+  free_list.Free(small, 2 * kBlockSize);
+  EXPECT_EQ(small, free_list.TryAllocate(kBlockSize));
+  EXPECT_EQ(kBlockSize, free_list.free_bytes());
+  EXPECT_EQ(small + kBlockSize, free_list.TryAllocate(kBlockSize));
+  EXPECT_EQ(0, free_list.free_bytes());
+
+  // Large blocks are allocated best fit.
+  uword large = base + 2 * kBlockSize;
+  uword larger = large + KB * kObjectAlignment;
+  free_list.Free(larger, KB * kObjectAlignment);
+  free_list.Free(large, 512 * kObjectAlignment);
+  EXPECT_EQ(large, free_list.TryAllocate(256 * kObjectAlignment));
+  EXPECT_EQ(larger, free_list.TryAllocate(768 * kObjectAlignment));
+  EXPECT_EQ(static_cast<uword>(0),
+            free_list.TryAllocate(512 * kObjectAlignment));
+
+  free_list.Reset();
+  EXPECT_EQ(0, free_list.free_bytes());
+  EXPECT_EQ(static_cast<uword>(0), free_list.TryAllocate(2 * kObjectAlignment));
+  delete[] buffer;
+}
+
+}  // namespace dart
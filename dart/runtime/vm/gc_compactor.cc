@@ -0,0 +1,341 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/gc_compactor.h"
+
+#include "vm/assert.h"
+#include "vm/dart_api_state.h"
+#include "vm/freelist.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/pages.h"
+#include "vm/raw_object.h"
+#include "vm/stack_frame.h"
+#include "vm/store_buffer.h"
+#include "vm/utils.h"
+#include "vm/visitor.h"
+
+namespace dart {
+
+// Forwarding information for the live objects of a page being compacted.
+// The page is divided into blocks of kBlockUnits allocation units. All live
+// objects starting in a block move together, so the new address of an object
+// is the new address of its block plus the size of the live objects in front
+// of it in the block. These sizes are counted in the live bits of the block.
+class ForwardingTable {
+ public:
+  static const intptr_t kBlockUnits = 32;
+  static const intptr_t kBlockSize = kBlockUnits * kObjectAlignment;
+  static const intptr_t kNumBlocks = HeapPage::kPageSize / kBlockSize;
+
+  struct Block {
+    // Destination of the first live object starting in this block.
+    uword new_address;
+    // One bit per allocation unit covered by the live objects starting in
+    // this block, up to the end of the block.
+    uint32_t live_bits;
+    // The block contains a live object which must not move, all its objects
+    // stay in place.
+    bool pinned;
+    intptr_t live_size;
+    uword live_end;
+    // Memory in front of a pinned block which is left unused.
+    uword gap_start;
+    uword gap_end;
+  };
+
+  explicit ForwardingTable(HeapPage* page)
+      : page_start_(page->start()), new_top_(0), new_used_(0) {
+    memset(blocks_, 0, sizeof(blocks_));
+  }
+
+  Block* BlockAt(intptr_t index) {
+    ASSERT((index >= 0) && (index < kNumBlocks));
+    return &blocks_[index];
+  }
+
+  uword BlockStart(intptr_t index) const {
+    return page_start_ + index * kBlockSize;
+  }
+
+  void RecordLive(uword addr, intptr_t size, bool pinned) {
+    intptr_t unit = (addr - page_start_) / kObjectAlignment;
+    Block* block = BlockAt(unit / kBlockUnits);
+    intptr_t first_bit = unit % kBlockUnits;
+    intptr_t last_bit = Utils::Minimum(first_bit + size / kObjectAlignment,
+                                       kBlockUnits);
+    for (intptr_t bit = first_bit; bit < last_bit; bit++) {
+      block->live_bits |= (static_cast<uint32_t>(1) << bit);
+    }
+    block->pinned = block->pinned || pinned;
+    block->live_size += size;
+    block->live_end = addr + size;
+  }
+
+  uword Lookup(uword addr) const {
+    intptr_t unit = (addr - page_start_) / kObjectAlignment;
+    const Block& block = blocks_[unit / kBlockUnits];
+    intptr_t bit = unit % kBlockUnits;
+    uint32_t before = block.live_bits & ((static_cast<uint32_t>(1) << bit) - 1);
+    ASSERT((block.live_bits & (static_cast<uint32_t>(1) << bit)) != 0);
+    return block.new_address + Utils::CountOneBits(before) * kObjectAlignment;
+  }
+
+  // Top and bytes in use of the page once compaction is done.
+  uword new_top() const { return new_top_; }
+  void set_new_top(uword new_top) { new_top_ = new_top; }
+  intptr_t new_used() const { return new_used_; }
+  void AddNewUsed(intptr_t size) { new_used_ += size; }
+
+ private:
+  uword page_start_;
+  uword new_top_;
+  intptr_t new_used_;
+  Block blocks_[kNumBlocks];
+
+  DISALLOW_COPY_AND_ASSIGN(ForwardingTable);
+};
+
+
+class CompactorUpdateVisitor : public ObjectPointerVisitor {
+ public:
+  explicit CompactorUpdateVisitor(GCCompactor* compactor)
+      : compactor_(compactor) { }
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      *current = compactor_->Forward(*current);
+    }
+  }
+
+ private:
+  GCCompactor* compactor_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompactorUpdateVisitor);
+};
+
+
+static bool IsPinned(RawObject* raw_obj) {
+  return raw_obj->IsClass();
+}
+
+
+RawObject* GCCompactor::Forward(RawObject* raw_obj) const {
+  if (!raw_obj->IsHeapObject() || raw_obj->IsNewObject()) {
+    return raw_obj;
+  }
+  HeapPage* page = HeapPage::Of(raw_obj);
+  if ((page->owner() != page_space_) || (page->forwarding() == NULL)) {
+    return raw_obj;
+  }
+  uword new_addr = page->forwarding()->Lookup(RawObject::ToAddr(raw_obj));
+  return RawObject::FromAddr(new_addr);
+}
+
+
+void GCCompactor::PlanPage(HeapPage* page) {
+  ForwardingTable* table = new ForwardingTable(page);
+  page->set_forwarding(table);
+  uword addr = page->NextMarkedObject(page->first_object_start());
+  while (addr < page->top()) {
+    RawObject* raw_obj = RawObject::FromAddr(addr);
+    intptr_t size = raw_obj->Size();
+    table->RecordLive(addr, size, IsPinned(raw_obj));
+    addr = page->NextMarkedObject(addr + size);
+  }
+}
+
+
+void GCCompactor::ComputeForwarding(HeapPage* pages) {
+  // Objects only move towards the front: the destination is never behind the
+  // start of the next live object, so moving them in order is safe.
+  HeapPage* dest_page = pages;
+  ForwardingTable* dest_table = dest_page->forwarding();
+  uword dest = dest_page->first_object_start();
+  for (HeapPage* page = pages; page != NULL; page = page->next()) {
+    ForwardingTable* table = page->forwarding();
+    for (intptr_t i = 0; i < ForwardingTable::kNumBlocks; i++) {
+      ForwardingTable::Block* block = table->BlockAt(i);
+      if (block->live_size == 0) {
+        continue;
+      }
+      if (block->pinned) {
+        // Nothing moves past a pinned block. Finish the destination pages up
+        // to this page.
+        while (dest_page != page) {
+          dest_table->set_new_top(dest);
+          dest_page = dest_page->next();
+          dest_table = dest_page->forwarding();
+          dest = dest_page->first_object_start();
+        }
+        intptr_t first_bit = 0;
+        while ((block->live_bits & (static_cast<uint32_t>(1) << first_bit)) ==
+               0) {
+          first_bit++;
+        }
+        block->gap_start = dest;
+        block->gap_end = table->BlockStart(i) + first_bit * kObjectAlignment;
+        ASSERT(block->gap_start <= block->gap_end);
+        // Forward all objects of the block to themselves.
+        block->new_address = table->BlockStart(i);
+        block->live_bits = ~static_cast<uint32_t>(0);
+        dest_table->AddNewUsed(block->live_size);
+        dest = block->live_end;
+        continue;
+      }
+      if ((dest + block->live_size) > dest_page->end()) {
+        dest_table->set_new_top(dest);
+        dest_page = dest_page->next();
+        dest_table = dest_page->forwarding();
+        dest = dest_page->first_object_start();
+      }
+      ASSERT((dest + block->live_size) <= dest_page->end());
+      block->new_address = dest;
+      dest_table->AddNewUsed(block->live_size);
+      dest += block->live_size;
+    }
+  }
+  dest_table->set_new_top(dest);
+  // Pages behind the last destination page are left empty.
+  for (HeapPage* page = dest_page->next(); page != NULL; page = page->next()) {
+    page->forwarding()->set_new_top(page->first_object_start());
+  }
+}
+
+
+void GCCompactor::VisitLiveObjectPointers(HeapPage* page,
+                                          ObjectPointerVisitor* visitor) {
+  uword addr = page->NextMarkedObject(page->first_object_start());
+  while (addr < page->top()) {
+    RawObject* raw_obj = RawObject::FromAddr(addr);
+    addr = page->NextMarkedObject(addr + raw_obj->VisitPointers(visitor));
+  }
+}
+
+
+void GCCompactor::UpdatePointers(Isolate* isolate,
+                                 HeapPage* pages,
+                                 HeapPage* large_pages) {
+  // Every slot has to be visited exactly once, as forwarding an already
+  // forwarded pointer is not meaningful.
+  CompactorUpdateVisitor visitor(this);
+  isolate->VisitObjectPointers(&visitor,
+                               StackFrameIterator::kDontValidateFrames);
+  heap_->IterateNewPointers(&visitor);
+  heap_->IterateCodePointers(&visitor);
+  // The weak persistent handles to unmarked objects were cleared by marking.
+  ApiState* api_state = isolate->api_state();
+  if (api_state != NULL) {
+    api_state->VisitWeakPersistentHandles(&visitor);
+  }
+  for (HeapPage* page = pages; page != NULL; page = page->next()) {
+    VisitLiveObjectPointers(page, &visitor);
+  }
+  for (HeapPage* page = large_pages; page != NULL; page = page->next()) {
+    RawObject* raw_obj = RawObject::FromAddr(page->first_object_start());
+    if (page->IsMarked(raw_obj)) {
+      raw_obj->VisitPointers(&visitor);
+    }
+  }
+
+  // The store buffer remembers old objects by address.
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  intptr_t length = 0;
+  uword* pointers = store_buffer->TakePointers(&length);
+  for (intptr_t i = 0; i < length; i++) {
+    RawObject* raw_obj = Forward(reinterpret_cast<RawObject*>(pointers[i]));
+    store_buffer->AddPointer(reinterpret_cast<uword>(raw_obj));
+  }
+  free(pointers);
+}
+
+
+void GCCompactor::MoveObjects(HeapPage* pages) {
+  // The classes are not moved, so the size of every live object can still be
+  // computed once the objects in front of it have been moved.
+  for (HeapPage* page = pages; page != NULL; page = page->next()) {
+    ForwardingTable* table = page->forwarding();
+    uword addr = page->NextMarkedObject(page->first_object_start());
+    while (addr < page->top()) {
+      RawObject* raw_obj = RawObject::FromAddr(addr);
+      intptr_t size = raw_obj->Size();
+      uword new_addr = table->Lookup(addr);
+      if (new_addr != addr) {
+        ASSERT(!IsPinned(raw_obj));
+        memmove(reinterpret_cast<void*>(new_addr),
+                reinterpret_cast<void*>(addr),
+                size);
+      }
+      addr = page->NextMarkedObject(addr + size);
+    }
+  }
+}
+
+
+// The dead objects between the live objects of a pinned block stay in place.
+// They are turned into free list elements, so that heap walkers never see
+// them or the stale objects they refer to.
+static void FreeDeadObjects(HeapPage* page,
+                            uword start,
+                            uword end,
+                            FreeList* freelist) {
+  uword addr = start;
+  while (addr < end) {
+    uword live = Utils::Minimum(page->NextMarkedObject(addr), end);
+    if (addr < live) {
+      freelist->Free(addr, live - addr);
+    }
+    if (live == end) {
+      break;
+    }
+    addr = live + RawObject::FromAddr(live)->Size();
+  }
+}
+
+
+intptr_t GCCompactor::Finish(HeapPage* pages, FreeList* freelist) {
+  intptr_t in_use = 0;
+  for (HeapPage* page = pages; page != NULL; page = page->next()) {
+    ForwardingTable* table = page->forwarding();
+    // The mark bits of the objects which did not move are still valid.
+    for (intptr_t i = 0; i < ForwardingTable::kNumBlocks; i++) {
+      ForwardingTable::Block* block = table->BlockAt(i);
+      if (!block->pinned) {
+        continue;
+      }
+      if (block->gap_start < block->gap_end) {
+        freelist->Free(block->gap_start, block->gap_end - block->gap_start);
+      }
+      FreeDeadObjects(page, block->gap_end, block->live_end, freelist);
+    }
+    page->set_top(table->new_top());
+    page->set_used(table->new_used());
+    in_use += table->new_used();
+    page->set_forwarding(NULL);
+    delete table;
+    page->ClearMarkBits();
+  }
+  return in_use;
+}
+
+
+intptr_t GCCompactor::CompactPages(Isolate* isolate,
+                                   PageSpace* page_space,
+                                   HeapPage* pages,
+                                   HeapPage* large_pages,
+                                   FreeList* freelist) {
+  if (pages == NULL) {
+    return 0;
+  }
+  page_space_ = page_space;
+  for (HeapPage* page = pages; page != NULL; page = page->next()) {
+    PlanPage(page);
+  }
+  ComputeForwarding(pages);
+  UpdatePointers(isolate, pages, large_pages);
+  MoveObjects(pages);
+  return Finish(pages, freelist);
+}
+
+}  // namespace dart
@@ -0,0 +1,67 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_GC_COMPACTOR_H_
+#define VM_GC_COMPACTOR_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// Forward declarations.
+class FreeList;
+class Heap;
+class HeapPage;
+class Isolate;
+class ObjectPointerVisitor;
+class PageSpace;
+class RawObject;
+
+// The class GCCompactor is used after marking to slide the live objects of
+// the regular sized pages of a page space towards the front of its page list.
+// Class objects are never moved, as every heap walk reads the layout of an
+// object from its class.
+class GCCompactor : public ValueObject {
+ public:
+  explicit GCCompactor(Heap* heap) : heap_(heap), page_space_(NULL) { }
+  ~GCCompactor() { }
+
+  // Compact the marked objects in 'pages' and update all pointers to them.
+  // Afterwards the top of each page is at the end of its last object, pages
+  // left empty have their top at the first object start, and holes in front
+  // of objects which could not move are added to 'freelist'. Large pages are
+  // not moved, only the pointers of their marked objects are updated. The
+  // mark bits of 'pages' are cleared. Returns the number of bytes in use in
+  // 'pages'.
+  intptr_t CompactPages(Isolate* isolate,
+                        PageSpace* page_space,
+                        HeapPage* pages,
+                        HeapPage* large_pages,
+                        FreeList* freelist);
+
+  // Returns the location 'raw_obj' is moved to.
+  RawObject* Forward(RawObject* raw_obj) const;
+
+ private:
+  void PlanPage(HeapPage* page);
+  void ComputeForwarding(HeapPage* pages);
+  void UpdatePointers(Isolate* isolate,
+                      HeapPage* pages,
+                      HeapPage* large_pages);
+  void MoveObjects(HeapPage* pages);
+  intptr_t Finish(HeapPage* pages, FreeList* freelist);
+
+  static void VisitLiveObjectPointers(HeapPage* page,
+                                      ObjectPointerVisitor* visitor);
+
+  Heap* heap_;
+  PageSpace* page_space_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(GCCompactor);
+};
+
+}  // namespace dart
+
+#endif  // VM_GC_COMPACTOR_H_
@@ -0,0 +1,345 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/gc_marker.h"
+
+#include "vm/assert.h"
+#include "vm/code_index_table.h"
+#include "vm/dart.h"
+#include "vm/dart_api_state.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/object.h"
+#include "vm/object_stack.h"
+#include "vm/pages.h"
+#include "vm/raw_object.h"
+#include "vm/stack_frame.h"
+#include "vm/store_buffer.h"
+#include "vm/thread_pool.h"
+#include "vm/visitor.h"
+
+namespace dart {
+
+class MarkingVisitor : public ObjectPointerVisitor {
+ public:
+  // Concurrent visitors set mark bits atomically as they race with the
+  // mutator and with each other. Objects in 'code_space' are only marked if
+  // it is not NULL.
+  MarkingVisitor(PageSpace* page_space,
+                 PageSpace* code_space,
+                 ObjectStack* marking_stack,
+                 bool is_concurrent = false)
+      : page_space_(page_space),
+        code_space_(code_space),
+        marking_stack_(marking_stack),
+        is_concurrent_(is_concurrent) { }
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      MarkObject(*current);
+    }
+  }
+
+  ObjectStack* marking_stack() const { return marking_stack_; }
+
+  void MarkObject(RawObject* raw_obj) {
+    // Fast exit if the raw object is a Smi or a new object. New objects are
+    // treated as roots.
+    if (!raw_obj->IsHeapObject() || raw_obj->IsNewObject()) {
+      return;
+    }
+    // Only objects in the spaces being collected are marked. Objects in the
+    // VM isolate heap are never collected.
+    HeapPage* page = HeapPage::Of(raw_obj);
+    if ((page->owner() != page_space_) && (page->owner() != code_space_)) {
+      return;
+    }
+    if (is_concurrent_) {
+      if (!page->AtomicSetMarked(raw_obj)) {
+        return;
+      }
+    } else {
+      if (page->IsMarked(raw_obj)) {
+        return;
+      }
+      page->SetMarked(raw_obj);
+    }
+    marking_stack_->Push(raw_obj);
+  }
+
+ private:
+  PageSpace* page_space_;
+  PageSpace* code_space_;
+  ObjectStack* marking_stack_;
+  const bool is_concurrent_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(MarkingVisitor);
+};
+
+
+// Marks the arrays of the code index table without pushing them, so that the
+// code objects they hold are not visited.
+class MarkCodeListsVisitor : public ObjectVisitor {
+ public:
+  explicit MarkCodeListsVisitor(PageSpace* page_space)
+      : page_space_(page_space) { }
+
+  void VisitObject(RawObject* raw_obj) {
+    ASSERT(raw_obj->IsOldObject());
+    HeapPage* page = HeapPage::Of(raw_obj);
+    ASSERT(page->owner() == page_space_);
+    page->SetMarked(raw_obj);
+  }
+
+ private:
+  PageSpace* page_space_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkCodeListsVisitor);
+};
+
+
+// Clears the weak persistent handles whose objects are in a collected space
+// but were not marked, and queues them for finalization.
+class MarkingWeakVisitor : public ObjectPointerVisitor {
+ public:
+  MarkingWeakVisitor(PageSpace* page_space,
+                     PageSpace* code_space,
+                     ApiState* api_state)
+      : page_space_(page_space),
+        code_space_(code_space),
+        api_state_(api_state) { }
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      RawObject* raw_obj = *current;
+      if (!raw_obj->IsHeapObject() || raw_obj->IsNewObject()) {
+        continue;
+      }
+      HeapPage* page = HeapPage::Of(raw_obj);
+      if ((page->owner() != page_space_) && (page->owner() != code_space_)) {
+        continue;
+      }
+      if (!page->IsMarked(raw_obj)) {
+        api_state_->QueueFinalization(
+            reinterpret_cast<PersistentHandle*>(current));
+      }
+    }
+  }
+
+ private:
+  PageSpace* page_space_;
+  PageSpace* code_space_;
+  ApiState* api_state_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkingWeakVisitor);
+};
+
+
+void GCMarker::IterateRoots(Isolate* isolate,
+                            ObjectPointerVisitor* visitor,
+                            PageSpace* code_space) {
+  isolate->VisitObjectPointers(visitor,
+                               StackFrameIterator::kDontValidateFrames);
+  heap_->IterateNewPointers(visitor);
+  if (code_space == NULL) {
+    heap_->IterateCodePointers(visitor);
+  }
+}
+
+
+void GCMarker::MarkFrameCode(MarkingVisitor* visitor, PageSpace* code_space) {
+  // Return addresses are not object pointers, mark the instructions they
+  // point into. Their code is marked when the instructions are visited.
+  StackFrameIterator frames_iterator(StackFrameIterator::kDontValidateFrames);
+  StackFrame* frame = frames_iterator.NextFrame();
+  while (frame != NULL) {
+    RawObject* raw_instructions = code_space->FindObject(frame->pc());
+    if (raw_instructions != Object::null()) {
+      visitor->MarkObject(raw_instructions);
+    }
+    frame = frames_iterator.NextFrame();
+  }
+}
+
+
+void GCMarker::DrainMarkingStack(MarkingVisitor* visitor) {
+  ObjectStack* marking_stack = visitor->marking_stack();
+  while (!marking_stack->IsEmpty()) {
+    RawObject* raw_obj = marking_stack->Pop();
+    raw_obj->VisitPointers(visitor);
+  }
+}
+
+
+void GCMarker::ProcessStoreBuffer(Isolate* isolate, PageSpace* page_space) {
+  // Forget unreachable objects before their memory is reused by the sweeper.
+  isolate->store_buffer_block()->ProcessBuffer(isolate);
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  intptr_t length = 0;
+  uword* pointers = store_buffer->TakePointers(&length);
+  for (intptr_t i = 0; i < length; i++) {
+    RawObject* raw_obj = reinterpret_cast<RawObject*>(pointers[i]);
+    HeapPage* page = HeapPage::Of(raw_obj);
+    if ((page->owner() != page_space) || page->IsMarked(raw_obj)) {
+      store_buffer->AddPointer(pointers[i]);
+    }
+  }
+  free(pointers);
+}
+
+
+void GCMarker::ProcessWeakHandles(Isolate* isolate,
+                                  PageSpace* page_space,
+                                  PageSpace* code_space) {
+  ApiState* api_state = isolate->api_state();
+  if (api_state == NULL) {
+    return;
+  }
+  MarkingWeakVisitor visitor(page_space, code_space, api_state);
+  api_state->VisitWeakPersistentHandles(&visitor);
+}
+
+
+void GCMarker::MarkObjects(Isolate* isolate,
+                           PageSpace* page_space,
+                           PageSpace* code_space) {
+  ObjectStack marking_stack;
+  MarkingVisitor mark(page_space, code_space, &marking_stack);
+  CodeIndexTable* code_index_table = isolate->code_index_table();
+  if ((code_space != NULL) && (code_index_table != NULL)) {
+    // The code index table is weak. Its arrays are already marked when the
+    // isolate roots are visited, so the code they hold is not traced.
+    MarkCodeListsVisitor code_lists_visitor(page_space);
+    code_index_table->VisitCodeLists(&code_lists_visitor);
+  }
+  IterateRoots(isolate, &mark, code_space);
+  if (code_space != NULL) {
+    MarkFrameCode(&mark, code_space);
+  }
+  DrainMarkingStack(&mark);
+  if ((code_space != NULL) && (code_index_table != NULL)) {
+    // Forget the unmarked code before its instructions are swept.
+    code_index_table->RemoveUnmarkedCode();
+  }
+  ProcessWeakHandles(isolate, page_space, code_space);
+  ProcessStoreBuffer(isolate, page_space);
+}
+
+
+ConcurrentMarker::ConcurrentMarker(Heap* heap, PageSpace* page_space)
+    : heap_(heap),
+      page_space_(page_space),
+      monitor_(),
+      shared_stack_(),
+      stop_requested_(false),
+      helper_running_(false) {
+}
+
+
+ConcurrentMarker::~ConcurrentMarker() {
+  ASSERT(!helper_running_);
+}
+
+
+void ConcurrentMarker::Start(Isolate* isolate) {
+  ASSERT(!helper_running_);
+  // The helper is not running yet, the roots can be pushed without locking.
+  MarkingVisitor visitor(page_space_, NULL, &shared_stack_, true);
+  GCMarker marker(heap_);
+  marker.IterateRoots(isolate, &visitor);
+  isolate->marking_buffer_block()->set_is_marking(true);
+  helper_running_ = true;
+  Dart::thread_pool()->Run(ConcurrentMarker::RunHelper,
+                           reinterpret_cast<uword>(this));
+}
+
+
+void ConcurrentMarker::MarkPointers(uword* pointers, intptr_t length) {
+  MonitorLocker ml(&monitor_);
+  MarkingVisitor visitor(page_space_, NULL, &shared_stack_, true);
+  for (intptr_t i = 0; i < length; i++) {
+    visitor.MarkObject(reinterpret_cast<RawObject*>(pointers[i]));
+  }
+  if (!shared_stack_.IsEmpty()) {
+    ml.Notify();
+  }
+}
+
+
+void ConcurrentMarker::RunHelper(uword parameter) {
+  ConcurrentMarker* marker = reinterpret_cast<ConcurrentMarker*>(parameter);
+  marker->Run();
+}
+
+
+bool ConcurrentMarker::TakeWork(ObjectStack* local_stack) {
+  MonitorLocker ml(&monitor_);
+  while (!stop_requested_) {
+    if (!local_stack->IsEmpty()) {
+      return true;
+    }
+    if (!shared_stack_.IsEmpty()) {
+      for (intptr_t i = 0;
+           (i < kWorkBatchSize) && !shared_stack_.IsEmpty();
+           i++) {
+        local_stack->Push(shared_stack_.Pop());
+      }
+      return true;
+    }
+    ml.Wait();
+  }
+  return false;
+}
+
+
+void ConcurrentMarker::Run() {
+  ObjectStack local_stack;
+  MarkingVisitor visitor(page_space_, NULL, &local_stack, true);
+  while (TakeWork(&local_stack)) {
+    for (intptr_t i = 0; (i < kWorkBatchSize) && !local_stack.IsEmpty(); i++) {
+      RawObject* raw_obj = local_stack.Pop();
+      raw_obj->VisitPointers(&visitor);
+    }
+  }
+  // Hand the remaining work back to the mutator, which completes marking.
+  MonitorLocker ml(&monitor_);
+  while (!local_stack.IsEmpty()) {
+    shared_stack_.Push(local_stack.Pop());
+  }
+  helper_running_ = false;
+  ml.NotifyAll();
+}
+
+
+void ConcurrentMarker::StopHelper() {
+  MonitorLocker ml(&monitor_);
+  stop_requested_ = true;
+  ml.NotifyAll();
+  while (helper_running_) {
+    ml.Wait();
+  }
+}
+
+
+void ConcurrentMarker::Finish(Isolate* isolate) {
+  StopHelper();
+  MarkingBufferBlock* block = isolate->marking_buffer_block();
+  block->ProcessBuffer(isolate);
+  block->set_is_marking(false);
+
+  // Rescan the roots and drain all remaining work on this thread.
+  MarkingVisitor visitor(page_space_, NULL, &shared_stack_);
+  GCMarker marker(heap_);
+  marker.IterateRoots(isolate, &visitor);
+  marker.DrainMarkingStack(&visitor);
+  marker.ProcessWeakHandles(isolate, page_space_, NULL);
+  marker.ProcessStoreBuffer(isolate, page_space_);
+}
+
+
+void ConcurrentMarker::Abort() {
+  StopHelper();
+}
+
+}  // namespace dart
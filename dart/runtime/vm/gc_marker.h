@@ -0,0 +1,107 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_GC_MARKER_H_
+#define VM_GC_MARKER_H_
+
+#include "vm/allocation.h"
+#include "vm/object_stack.h"
+#include "vm/thread.h"
+
+namespace dart {
+
+// Forward declarations.
+class Heap;
+class Isolate;
+class MarkingVisitor;
+class ObjectPointerVisitor;
+class PageSpace;
+
+// The class GCMarker is used to mark reachable old generation objects as part
+// of the mark-sweep collection. The marking bit is tracked in the mark bitmap
+// of the HeapPage containing the object.
+// When the code space is marked as well, it is not treated as roots. Code is
+// then live if it is referenced from outside the code space and the code
+// index table, or if a stack frame returns into it.
+class GCMarker : public ValueObject {
+ public:
+  explicit GCMarker(Heap* heap) : heap_(heap) { }
+  ~GCMarker() { }
+
+  void MarkObjects(Isolate* isolate,
+                   PageSpace* page_space,
+                   PageSpace* code_space = NULL);
+
+ private:
+  void IterateRoots(Isolate* isolate,
+                    ObjectPointerVisitor* visitor,
+                    PageSpace* code_space = NULL);
+  void MarkFrameCode(MarkingVisitor* visitor, PageSpace* code_space);
+  void DrainMarkingStack(MarkingVisitor* visitor);
+  // Clear the weak persistent handles whose objects were not marked and
+  // queue their callbacks.
+  void ProcessWeakHandles(Isolate* isolate,
+                          PageSpace* page_space,
+                          PageSpace* code_space);
+  void ProcessStoreBuffer(Isolate* isolate, PageSpace* page_space);
+
+  Heap* heap_;
+
+  friend class ConcurrentMarker;
+  DISALLOW_IMPLICIT_CONSTRUCTORS(GCMarker);
+};
+
+
+// The class ConcurrentMarker marks old generation objects on a helper thread
+// of the thread pool while the mutator keeps running. The mutator is only
+// paused to mark the roots when marking starts and for the final remark. In
+// between, the write barrier logs the old objects whose references are
+// overwritten in old objects, and objects allocated in old space are marked on
+// allocation. Thus everything reachable when marking started gets marked
+// (snapshot-at-the-beginning).
+class ConcurrentMarker {
+ public:
+  ConcurrentMarker(Heap* heap, PageSpace* page_space);
+  ~ConcurrentMarker();
+
+  // Mark the roots and start the helper task on the thread pool.
+  void Start(Isolate* isolate);
+
+  // Mark the objects logged by the write barrier and hand them to the helper
+  // thread for scanning. Called by the mutator.
+  void MarkPointers(uword* pointers, intptr_t length);
+
+  // Stop the helper thread and complete marking on the calling thread. The
+  // roots are scanned once more to pick up unlogged stores.
+  void Finish(Isolate* isolate);
+
+  // Stop the helper thread without completing marking. Used when the heap
+  // is destroyed together with its isolate.
+  void Abort();
+
+ private:
+  // Number of objects the helper scans between checks for more work or for a
+  // request to stop.
+  static const intptr_t kWorkBatchSize = 1024;
+
+  static void RunHelper(uword parameter);
+  void Run();
+  bool TakeWork(ObjectStack* local_stack);
+  void StopHelper();
+
+  Heap* heap_;
+  PageSpace* page_space_;
+
+  // Protects the fields below, which are shared with the helper thread.
+  Monitor monitor_;
+  ObjectStack shared_stack_;
+  bool stop_requested_;
+  bool helper_running_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(ConcurrentMarker);
+};
+
+}  // namespace dart
+
+#endif  // VM_GC_MARKER_H_
@@ -0,0 +1,53 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/gc_sweeper.h"
+
+#include "vm/assert.h"
+#include "vm/freelist.h"
+#include "vm/pages.h"
+#include "vm/raw_object.h"
+
+namespace dart {
+
+intptr_t GCSweeper::SweepPage(HeapPage* page, FreeList* freelist) {
+  uword current = page->first_object_start();
+  uword end = page->top();
+  intptr_t in_use = 0;
+
+  // A free block extends up to the next marked object, so the size of dead
+  // objects is never needed. Pages may be swept lazily, long after the
+  // classes of their dead objects have been swept and reused themselves.
+  while (current < end) {
+    RawObject* raw_obj = RawObject::FromAddr(current);
+    if (page->IsMarked(raw_obj)) {
+      intptr_t obj_size = raw_obj->Size();
+      in_use += obj_size;
+      current += obj_size;
+    } else {
+      uword free_end = page->NextMarkedObject(current);
+      freelist->Free(current, free_end - current);
+      current = free_end;
+    }
+  }
+  ASSERT(current == end);
+
+  page->ClearMarkBits();
+  page->set_used(in_use);
+  return in_use;
+}
+
+
+intptr_t GCSweeper::SweepLargePage(HeapPage* page) {
+  RawObject* raw_obj = RawObject::FromAddr(page->first_object_start());
+  if (!page->IsMarked(raw_obj)) {
+    return 0;
+  }
+  page->ClearMarkBits();
+  intptr_t in_use = raw_obj->Size();
+  page->set_used(in_use);
+  return in_use;
+}
+
+}  // namespace dart
@@ -0,0 +1,42 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_GC_SWEEPER_H_
+#define VM_GC_SWEEPER_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// Forward declarations.
+class FreeList;
+class Heap;
+class HeapPage;
+
+// The class GCSweeper is used to visit the heap after marking to reclaim unused
+// memory.
+class GCSweeper : public ValueObject {
+ public:
+  explicit GCSweeper(Heap* heap) : heap_(heap) { }
+  ~GCSweeper() { }
+
+  // Sweep the regular sized data page. Runs of unmarked objects are coalesced
+  // and added to the free list. Returns the number of bytes in use and clears
+  // the mark bits of the page.
+  intptr_t SweepPage(HeapPage* page, FreeList* freelist);
+
+  // Returns the number of bytes in use by the single object in the large page
+  // or zero if the object is not marked.
+  intptr_t SweepLargePage(HeapPage* page);
+
+ private:
+  Heap* heap_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(GCSweeper);
+};
+
+}  // namespace dart
+
+#endif  // VM_GC_SWEEPER_H_
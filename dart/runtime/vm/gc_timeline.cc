@@ -0,0 +1,93 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/gc_timeline.h"
+
+#include "vm/assert.h"
+#include "vm/utils.h"
+
+namespace dart {
+
+Dart_GCEventCallback GCTimeline::callback_ = NULL;
+
+
+GCTimeline::GCTimeline() : added_(0) {
+  for (intptr_t kind = 0; kind < GCEvent::kNumKinds; kind++) {
+    counts_[kind] = 0;
+    for (intptr_t i = 0; i < kNumBuckets; i++) {
+      buckets_[kind][i] = 0;
+    }
+  }
+}
+
+
+intptr_t GCTimeline::BucketFor(int64_t duration_micros) {
+  intptr_t bucket = 0;
+  while ((bucket < (kNumBuckets - 1)) &&
+         (duration_micros >= (static_cast<int64_t>(1) << bucket))) {
+    bucket++;
+  }
+  return bucket;
+}
+
+
+void GCTimeline::Add(const GCEvent& event) {
+  ASSERT((event.kind >= 0) && (event.kind < GCEvent::kNumKinds));
+  events_[added_ % kLength] = event;
+  added_++;
+  counts_[event.kind]++;
+  buckets_[event.kind][BucketFor(event.duration_micros)]++;
+  if (callback_ != NULL) {
+    Dart_GCEvent api_event;
+    ToApiEvent(event, &api_event);
+    (*callback_)(&api_event);
+  }
+}
+
+
+void GCTimeline::ToApiEvent(const GCEvent& event, Dart_GCEvent* api_event) {
+  api_event->kind = static_cast<Dart_GCKind>(event.kind);
+  api_event->reason = static_cast<Dart_GCReason>(event.reason);
+  api_event->start_micros = event.start_micros;
+  api_event->duration_micros = event.duration_micros;
+  api_event->used_before = event.used_before;
+  api_event->used_after = event.used_after;
+}
+
+
+intptr_t GCTimeline::Length() const {
+  return Utils::Minimum(added_, kLength);
+}
+
+
+const GCEvent& GCTimeline::EventAt(intptr_t index) const {
+  ASSERT((index >= 0) && (index < Length()));
+  intptr_t oldest = (added_ > kLength) ? (added_ % kLength) : 0;
+  return events_[(oldest + index) % kLength];
+}
+
+
+int64_t GCTimeline::PausePercentile(GCEvent::Kind kind,
+                                    intptr_t percentile) const {
+  ASSERT((kind >= 0) && (kind < GCEvent::kNumKinds));
+  ASSERT((percentile >= 0) && (percentile <= 100));
+  intptr_t count = counts_[kind];
+  if (count == 0) {
+    return 0;
+  }
+  // Number of collections which need to fit below the returned bound.
+  intptr_t needed = Utils::Maximum(
+      static_cast<intptr_t>(1), (count * percentile + 99) / 100);
+  intptr_t seen = 0;
+  for (intptr_t i = 0; i < kNumBuckets; i++) {
+    seen += buckets_[kind][i];
+    if (seen >= needed) {
+      return static_cast<int64_t>(1) << i;
+    }
+  }
+  UNREACHABLE();
+  return 0;
+}
+
+}  // namespace dart
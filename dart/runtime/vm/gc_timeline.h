@@ -0,0 +1,91 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_GC_TIMELINE_H_
+#define VM_GC_TIMELINE_H_
+
+#include "include/dart_api.h"
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// A single garbage collection pause of an isolate.
+struct GCEvent {
+  enum Kind {
+    kScavenge = 0,
+    kMarkSweep,
+    kMarkCompact,
+    kNumKinds
+  };
+
+  enum Reason {
+    kAllocation = 0,  // An allocation did not fit into its space.
+    kPromotion,  // Promotion grew old space beyond its growth limit.
+    kFragmentation,  // Old space was compacted between messages.
+    kExplicit,  // Requested by the VM or the embedder.
+  };
+
+  Kind kind;
+  Reason reason;
+  int64_t start_micros;
+  int64_t duration_micros;
+  // Bytes in use in the whole heap, unswept pages are counted as used.
+  intptr_t used_before;
+  intptr_t used_after;
+};
+
+
+// GCTimeline keeps the most recent collections of an isolate in a ring
+// buffer, and a histogram of the pause times of all collections of each kind
+// to correlate latency spikes with garbage collection. Each added event is
+// passed to the callback set by the embedder.
+class GCTimeline {
+ public:
+  // Number of events kept in the ring buffer.
+  static const intptr_t kLength = 256;
+  // Histogram bucket i counts the pauses shorter than 2^i microseconds which
+  // do not fit into bucket i - 1.
+  static const intptr_t kNumBuckets = 32;
+
+  GCTimeline();
+  ~GCTimeline() {}
+
+  void Add(const GCEvent& event);
+
+  // Number of events in the ring buffer, event 0 is the oldest one.
+  intptr_t Length() const;
+  const GCEvent& EventAt(intptr_t index) const;
+
+  // Number of collections of the given kind since the isolate was created.
+  intptr_t Count(GCEvent::Kind kind) const { return counts_[kind]; }
+
+  // Upper bound in microseconds of the pause time of the given percentage of
+  // the collections of the given kind, 0 if there were none.
+  int64_t PausePercentile(GCEvent::Kind kind, intptr_t percentile) const;
+
+  static void SetCallback(Dart_GCEventCallback callback) {
+    callback_ = callback;
+  }
+  static void ToApiEvent(const GCEvent& event, Dart_GCEvent* api_event);
+
+ private:
+  static intptr_t BucketFor(int64_t duration_micros);
+
+  GCEvent events_[kLength];
+  // Total number of events added, the next event is stored at
+  // added_ % kLength.
+  intptr_t added_;
+
+  intptr_t counts_[GCEvent::kNumKinds];
+  intptr_t buckets_[GCEvent::kNumKinds][kNumBuckets];
+
+  static Dart_GCEventCallback callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(GCTimeline);
+};
+
+}  // namespace dart
+
+#endif  // VM_GC_TIMELINE_H_
@@ -0,0 +1,93 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "include/dart_api.h"
+#include "vm/assert.h"
+#include "vm/gc_timeline.h"
+#include "vm/heap.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static GCEvent MakeEvent(GCEvent::Kind kind, int64_t duration_micros) {
+  GCEvent event;
+  event.kind = kind;
+  event.reason = GCEvent::kExplicit;
+  event.start_micros = 0;
+  event.duration_micros = duration_micros;
+  event.used_before = 0;
+  event.used_after = 0;
+  return event;
+}
+
+
+UNIT_TEST_CASE(GCTimelineRingBuffer) {
+  GCTimeline timeline;
+  EXPECT_EQ(0, timeline.Length());
+  // Copied into a local, EXPECT_EQ binds its arguments to references.
+  const intptr_t kLength = GCTimeline::kLength;
+  const intptr_t kNumEvents = kLength + 10;
+  for (intptr_t i = 0; i < kNumEvents; i++) {
+    timeline.Add(MakeEvent(GCEvent::kScavenge, i));
+  }
+  // Only the most recent events are kept, oldest first.
+  EXPECT_EQ(kLength, timeline.Length());
+  EXPECT_EQ(10, timeline.EventAt(0).duration_micros);
+  EXPECT_EQ(kNumEvents - 1,
+            timeline.EventAt(kLength - 1).duration_micros);
+  EXPECT_EQ(kNumEvents, timeline.Count(GCEvent::kScavenge));
+  EXPECT_EQ(0, timeline.Count(GCEvent::kMarkSweep));
+}
+
+
+UNIT_TEST_CASE(GCTimelinePercentiles) {
+  GCTimeline timeline;
+  EXPECT_EQ(0, timeline.PausePercentile(GCEvent::kMarkSweep, 50));
+  // 90 short pauses and 10 long ones.
+  for (intptr_t i = 0; i < 90; i++) {
+    timeline.Add(MakeEvent(GCEvent::kMarkSweep, 100));
+  }
+  for (intptr_t i = 0; i < 10; i++) {
+    timeline.Add(MakeEvent(GCEvent::kMarkSweep, 10000));
+  }
+  EXPECT_EQ(128, timeline.PausePercentile(GCEvent::kMarkSweep, 50));
+  EXPECT_EQ(128, timeline.PausePercentile(GCEvent::kMarkSweep, 90));
+  EXPECT_EQ(16384, timeline.PausePercentile(GCEvent::kMarkSweep, 99));
+  EXPECT_EQ(16384, timeline.PausePercentile(GCEvent::kMarkSweep, 100));
+  EXPECT_EQ(0, timeline.PausePercentile(GCEvent::kScavenge, 100));
+}
+
+
+static intptr_t gc_event_count = 0;
+static Dart_GCEvent last_gc_event;
+
+static void RecordGCEvent(const Dart_GCEvent* event) {
+  gc_event_count++;
+  last_gc_event = *event;
+}
+
+
+TEST_CASE(GCTimelineCallback) {
+  Heap* heap = Isolate::Current()->heap();
+  gc_event_count = 0;
+  Dart_SetGCEventCallback(RecordGCEvent);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_EQ(1, gc_event_count);
+  EXPECT_EQ(kGCScavenge, last_gc_event.kind);
+  EXPECT_EQ(kGCExplicit, last_gc_event.reason);
+  EXPECT(last_gc_event.duration_micros >= 0);
+  heap->CompactOldSpace();
+  EXPECT_EQ(2, gc_event_count);
+  EXPECT_EQ(kGCMarkCompact, last_gc_event.kind);
+  Dart_SetGCEventCallback(NULL);
+
+  const GCTimeline& timeline = heap->timeline();
+  EXPECT(timeline.Length() >= 2);
+  const GCEvent& event = timeline.EventAt(timeline.Length() - 1);
+  EXPECT_EQ(GCEvent::kMarkCompact, event.kind);
+  EXPECT_EQ(last_gc_event.used_after, event.used_after);
+  EXPECT(timeline.PausePercentile(GCEvent::kScavenge, 100) > 0);
+}
+
+}  // namespace dart
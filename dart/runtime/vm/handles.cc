@@ -102,13 +102,17 @@ HandleScope::~HandleScope() {
 #if defined(DEBUG)
 NoHandleScope::NoHandleScope() : StackResource() {
   Isolate* isolate = Isolate::Current();
-  isolate->IncrementNoHandleScopeDepth();
+  if (isolate != NULL) {
+    isolate->IncrementNoHandleScopeDepth();
+  }
 }
 
 
 NoHandleScope::~NoHandleScope() {
   Isolate* isolate = Isolate::Current();
-  isolate->DecrementNoHandleScopeDepth();
+  if (isolate != NULL) {
+    isolate->DecrementNoHandleScopeDepth();
+  }
 }
 #endif  // defined(DEBUG)
 
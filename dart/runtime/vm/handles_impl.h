@@ -21,10 +21,14 @@ void Handles<kHandleSizeInWords,
     block = block->next_block();
   }
 
-  // Visit all scoped handles.
+  // Visit all scoped handles. The blocks after the current one are kept for
+  // reuse, their handles belong to scopes which have already been exited.
   block = &first_scoped_block_;
   do {
     block->VisitObjectPointers(visitor);
+    if (block == scoped_blocks_) {
+      return;
+    }
     block = block->next_block();
   } while (block != NULL);
 }
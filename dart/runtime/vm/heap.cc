@@ -5,7 +5,10 @@
 #include "vm/heap.h"
 
 #include "vm/assert.h"
+#include "vm/code_index_table.h"
 #include "vm/compiler_stats.h"
+#include "vm/dart.h"
+#include "vm/dart_api_state.h"
 #include "vm/flags.h"
 #include "vm/isolate.h"
 #include "vm/os.h"
@@ -19,11 +22,24 @@ namespace dart {
 
 DEFINE_FLAG(bool, verbose_gc, false, "Enables verbose GC.");
 DEFINE_FLAG(bool, gc_at_alloc, false, "GC at every allocation.");
+DEFINE_FLAG(int, new_gen_semi_min_size, 256,
+    "Minimum size of each new space semi-space in KB, new space starts out "
+    "at this size.");
+DEFINE_FLAG(int, new_gen_semi_max_size, 16 * 1024,
+    "Maximum size of each new space semi-space in KB.");
+DEFINE_FLAG(int, old_gen_heap_size, 512,
+    "Maximum size of the old generation of each isolate in MB.");
 
 Heap::Heap() {
-  new_space_ = new Scavenger(this, 32 * MB, kNewObjectAlignmentOffset);
-  old_space_ = new PageSpace(this, kHeapSize);
+  new_space_ = new Scavenger(this,
+                             FLAG_new_gen_semi_min_size * KB,
+                             FLAG_new_gen_semi_max_size * KB,
+                             kNewObjectAlignmentOffset);
+  old_space_limit_ = FLAG_old_gen_heap_size * MB;
+  old_space_ = new PageSpace(this, old_space_limit_);
   code_space_ = new PageSpace(this, kCodeHeapSize, true);
+  out_of_memory_ = false;
+  pending_out_of_memory_ = false;
 }
 
 
@@ -40,13 +56,7 @@ uword Heap::AllocateNew(intptr_t size) {
   if (addr != 0) {
     return addr;
   }
-  new_space_->Scavenge();
-  if (FLAG_verbose_gc) {
-    OS::PrintErr("New space (%dk) Old space (%dk) Code space (%dk)\n",
-                 (new_space_->in_use() / KB),
-                 (old_space_->in_use() / KB),
-                 (code_space_->in_use() / KB));
-  }
+  CollectGarbage(kNew, GCEvent::kAllocation);
   addr = new_space_->TryAllocate(size);
   if (addr != 0) {
     return addr;
@@ -57,12 +67,35 @@ uword Heap::AllocateNew(intptr_t size) {
 
 uword Heap::AllocateOld(intptr_t size) {
   ASSERT(Isolate::Current()->no_gc_scope_depth() == 0);
+  // Start marking before allocating, so that the new object is marked.
+  if (old_space_->NeedsConcurrentMarking()) {
+    StartConcurrentMarking();
+  }
   uword addr = old_space_->TryAllocate(size);
-  if (addr == 0) {
-    // TODO(iposva): Support GC.
-    FATAL("Exhausted heap space.");
+  if (addr != 0) {
+    return addr;
   }
-  return addr;
+  CollectGarbage(kOld, GCEvent::kAllocation);
+  return old_space_->TryAllocate(size, PageSpace::kForceGrowth);
+}
+
+
+uword Heap::AllocateFromReserve(intptr_t size, Space space) {
+  ASSERT(space != kNew);
+  SetOutOfMemory();
+  pending_out_of_memory_ = true;
+  PageSpace* page_space = (space == kExecutable) ? code_space_ : old_space_;
+  return page_space->TryAllocate(size, PageSpace::kForceGrowth);
+}
+
+
+uword Heap::TryAllocatePromoted(intptr_t size) {
+  return old_space_->TryAllocate(size, PageSpace::kForceGrowth);
+}
+
+
+void Heap::FreePromoted(uword addr, intptr_t size) {
+  old_space_->FreeUnused(addr, size);
 }
 
 
@@ -71,8 +104,11 @@ uword Heap::AllocateCode(intptr_t size) {
   ASSERT(Utils::IsAligned(size, OS::PreferredCodeAlignment()));
   uword addr = code_space_->TryAllocate(size);
   if (addr == 0) {
-    // TODO(iposva): Support GC.
-    FATAL("Exhausted code heap space.");
+    CollectGarbage(kExecutable, GCEvent::kAllocation);
+    addr = code_space_->TryAllocate(size, PageSpace::kForceGrowth);
+    if (addr == 0) {
+      return 0;
+    }
   }
   if (FLAG_compiler_stats) {
     CompilerStats::code_allocated += size;
@@ -100,7 +136,293 @@ void Heap::Init(Isolate* isolate) {
 }
 
 
+void Heap::CollectGarbage(Space space, GCEvent::Reason reason) {
+  ASSERT(Isolate::Current()->no_gc_scope_depth() == 0);
+  int64_t start = OS::GetCurrentTimeMicros();
+  intptr_t used_before = UsedInHeap();
+  switch (space) {
+    case kNew:
+      new_space_->Scavenge();
+      RecordCollection(GCEvent::kScavenge, reason, start, used_before);
+      // Promotion grows old space without regard to its growth limit.
+      // Collect old space now if the limit has been exceeded.
+      if (old_space_->NeedsGarbageCollection()) {
+        PrintSizes();
+        CollectGarbage(kOld, GCEvent::kPromotion);
+        return;
+      }
+      // Otherwise start marking it before the limit is reached.
+      if (old_space_->NeedsConcurrentMarking()) {
+        StartConcurrentMarking();
+      }
+      break;
+    case kOld:
+      // The VM isolate heap holds the shared read-only objects which are only
+      // reachable through static fields, it is never collected.
+      if (Isolate::Current() == Dart::vm_isolate()) {
+        return;
+      }
+      // Objects in old space only move at the explicit compaction points,
+      // the callers of an allocation may hold raw pointers to old objects.
+      old_space_->MarkSweep();
+      RecordCollection(GCEvent::kMarkSweep, reason, start, used_before);
+      break;
+    case kExecutable: {
+      if (Isolate::Current() == Dart::vm_isolate()) {
+        return;
+      }
+      // The code objects owning the instructions in the code space live in
+      // old space, both spaces are collected together.
+      intptr_t code_in_use_before = code_space_->in_use();
+      old_space_->MarkSweep(code_space_);
+      CodeIndexTable* code_index_table =
+          Isolate::Current()->code_index_table();
+      if ((code_space_->in_use() < code_in_use_before) &&
+          (code_index_table != NULL)) {
+        // Static calls may still target the collected code.
+        code_index_table->RedirectCallsToRemovedCode();
+      }
+      RecordCollection(GCEvent::kMarkSweep, reason, start, used_before);
+      break;
+    }
+    default:
+      UNREACHABLE();
+  }
+  UpdateOutOfMemory();
+  PrintSizes();
+  RunFinalizers();
+}
+
+
+void Heap::CollectAllGarbage() {
+  CollectGarbage(kNew);
+  // Collecting the code space collects old space as well.
+  CollectGarbage(kExecutable);
+}
+
+
+void Heap::CompactOldSpace(GCEvent::Reason reason) {
+  ASSERT(Isolate::Current()->no_gc_scope_depth() == 0);
+  if (Isolate::Current() == Dart::vm_isolate()) {
+    return;
+  }
+  int64_t start = OS::GetCurrentTimeMicros();
+  intptr_t used_before = UsedInHeap();
+  old_space_->MarkCompact();
+  RecordCollection(GCEvent::kMarkCompact, reason, start, used_before);
+  UpdateOutOfMemory();
+  PrintSizes();
+  RunFinalizers();
+}
+
+
+void Heap::CompactOldSpaceIfFragmented() {
+  // The free blocks of the unswept pages are only known once they are swept.
+  // No Dart code is running between messages, sweep them now instead of on
+  // demand.
+  old_space_->CompleteSweeping();
+  if (old_space_->NeedsCompaction()) {
+    CompactOldSpace(GCEvent::kFragmentation);
+  }
+}
+
+
+void Heap::SetOldSpaceLimit(intptr_t max_old_space_size) {
+  old_space_limit_ = max_old_space_size;
+  if (!out_of_memory_) {
+    old_space_->set_max_capacity(old_space_limit_);
+  }
+}
+
+
+void Heap::SetOutOfMemory() {
+  if (out_of_memory_) {
+    return;
+  }
+  out_of_memory_ = true;
+  old_space_->set_max_capacity(old_space_limit_ + kOutOfMemoryReserve);
+  code_space_->set_max_capacity(kCodeHeapSize + kOutOfMemoryReserve);
+}
+
+
+void Heap::UpdateOutOfMemory() {
+  if (!out_of_memory_) {
+    return;
+  }
+  // Empty pages are only released once they are swept.
+  old_space_->CompleteSweeping();
+  if ((old_space_->capacity() > old_space_limit_) ||
+      (code_space_->capacity() > kCodeHeapSize)) {
+    return;
+  }
+  out_of_memory_ = false;
+  old_space_->set_max_capacity(old_space_limit_);
+  code_space_->set_max_capacity(kCodeHeapSize);
+}
+
+
+void Heap::SetNewSpaceLimits(intptr_t min_semi_space_size,
+                             intptr_t max_semi_space_size) {
+  new_space_->SetSemiSpaceLimits(min_semi_space_size, max_semi_space_size);
+}
+
+
+void Heap::StartConcurrentMarking() {
+  ASSERT(Isolate::Current()->no_gc_scope_depth() == 0);
+  if ((Isolate::Current() == Dart::vm_isolate()) || old_space_->is_marking()) {
+    return;
+  }
+  old_space_->StartConcurrentMarking();
+}
+
+
+bool Heap::IsMarking() const {
+  return old_space_->is_marking();
+}
+
+
+void Heap::MarkPointers(uword* pointers, intptr_t length) {
+  old_space_->MarkPointers(pointers, length);
+}
+
+
+intptr_t Heap::InUse(Space space) const {
+  switch (space) {
+    case kNew:
+      return new_space_->in_use();
+    case kOld:
+      return old_space_->in_use();
+    case kExecutable:
+      return code_space_->in_use();
+    default:
+      UNREACHABLE();
+  }
+  return 0;
+}
+
+
+intptr_t Heap::Capacity(Space space) const {
+  switch (space) {
+    case kNew:
+      return new_space_->capacity();
+    case kOld:
+      return old_space_->capacity();
+    case kExecutable:
+      return code_space_->capacity();
+    default:
+      UNREACHABLE();
+  }
+  return 0;
+}
+
+
+intptr_t Heap::Collections(Space space) const {
+  switch (space) {
+    case kNew:
+      return new_space_->collections();
+    case kOld:
+      return old_space_->collections();
+    case kExecutable:
+      return code_space_->collections();
+    default:
+      UNREACHABLE();
+  }
+  return 0;
+}
+
+
+int64_t Heap::CollectionTime(Space space) const {
+  switch (space) {
+    case kNew:
+      return new_space_->collection_time_micros();
+    case kOld:
+      return old_space_->collection_time_micros();
+    case kExecutable:
+      return code_space_->collection_time_micros();
+    default:
+      UNREACHABLE();
+  }
+  return 0;
+}
+
+
+intptr_t Heap::Unswept(Space space) const {
+  switch (space) {
+    case kNew:
+      return 0;
+    case kOld:
+      return old_space_->unswept();
+    case kExecutable:
+      return code_space_->unswept();
+    default:
+      UNREACHABLE();
+  }
+  return 0;
+}
+
+
+int64_t Heap::SweepTime(Space space) const {
+  switch (space) {
+    case kNew:
+      return 0;
+    case kOld:
+      return old_space_->sweep_time_micros();
+    case kExecutable:
+      return code_space_->sweep_time_micros();
+    default:
+      UNREACHABLE();
+  }
+  return 0;
+}
+
+
+void Heap::RunFinalizers() {
+  ApiState* api_state = Isolate::Current()->api_state();
+  if (api_state != NULL) {
+    api_state->RunFinalizers();
+  }
+}
+
+
+intptr_t Heap::UsedInHeap() const {
+  return new_space_->in_use() + old_space_->in_use() + code_space_->in_use();
+}
+
+
+void Heap::RecordCollection(GCEvent::Kind kind,
+                            GCEvent::Reason reason,
+                            int64_t start_micros,
+                            intptr_t used_before) {
+  GCEvent event;
+  event.kind = kind;
+  event.reason = reason;
+  event.start_micros = start_micros;
+  event.duration_micros = OS::GetCurrentTimeMicros() - start_micros;
+  event.used_before = used_before;
+  event.used_after = UsedInHeap();
+  timeline_.Add(event);
+}
+
+
+void Heap::PrintSizes() const {
+  if (FLAG_verbose_gc) {
+    OS::PrintErr("New space (%dk) Old space (%dk) Code space (%dk)\n",
+                 (new_space_->in_use() / KB),
+                 (old_space_->in_use() / KB),
+                 (code_space_->in_use() / KB));
+  }
+}
+
+
+void Heap::CompleteSweeping() {
+  old_space_->CompleteSweeping();
+}
+
+
 bool Heap::Verify() const {
+  // The dead objects in unswept pages may point to reused memory, the caller
+  // sweeps them first.
+  ASSERT(old_space_->unswept() == 0);
   VerifyPointersVisitor visitor;
   new_space_->VisitObjectPointers(&visitor);
   old_space_->VisitObjectPointers(&visitor);
@@ -110,12 +432,41 @@ bool Heap::Verify() const {
 }
 
 
+void Heap::IterateNewPointers(ObjectPointerVisitor* visitor) {
+  new_space_->VisitObjectPointers(visitor);
+}
+
+
 void Heap::IterateOldPointers(ObjectPointerVisitor* visitor) {
+  old_space_->CompleteSweeping();
   old_space_->VisitObjectPointers(visitor);
   code_space_->VisitObjectPointers(visitor);
 }
 
 
+void Heap::IterateCodePointers(ObjectPointerVisitor* visitor) {
+  code_space_->VisitObjectPointers(visitor);
+}
+
+
+void Heap::IterateObjects(ObjectVisitor* visitor) {
+  new_space_->VisitObjects(visitor);
+  IterateOldObjects(visitor);
+}
+
+
+void Heap::IterateOldObjects(ObjectVisitor* visitor) {
+  old_space_->CompleteSweeping();
+  old_space_->VisitObjects(visitor);
+  code_space_->VisitObjects(visitor);
+}
+
+
+HeapPage* Heap::OldLargePages() const {
+  return old_space_->large_pages();
+}
+
+
 uword Heap::TopAddress() {
   return reinterpret_cast<uword>(new_space_->TopAddress());
 }
@@ -126,6 +477,21 @@ uword Heap::EndAddress() {
 }
 
 
+uword Heap::OldTopAddress() {
+  return reinterpret_cast<uword>(old_space_->AllocationTopAddress());
+}
+
+
+uword Heap::OldEndAddress() {
+  return reinterpret_cast<uword>(old_space_->AllocationEndAddress());
+}
+
+
+void Heap::RefillOldAllocationBuffer() {
+  old_space_->RefillAllocationBuffer();
+}
+
+
 #if defined(DEBUG)
 NoGCScope::NoGCScope() : StackResource(), isolate_(Isolate::Current()) {
   isolate_->IncrementNoGCScopeDepth();
@@ -7,13 +7,16 @@
 
 #include "vm/allocation.h"
 #include "vm/flags.h"
+#include "vm/gc_timeline.h"
 #include "vm/globals.h"
 
 namespace dart {
 
 // Forward declarations.
+class HeapPage;
 class Isolate;
 class ObjectPointerVisitor;
+class ObjectVisitor;
 class PageSpace;
 class Scavenger;
 class VirtualMemory;
@@ -45,6 +48,19 @@ class Heap {
     return 0;
   }
 
+  // Allocate space in old space for an object promoted by the scavenger.
+  // Old space is grown beyond its growth limit if needed, and no garbage
+  // collection is triggered. Returns 0 if old space is exhausted.
+  uword TryAllocatePromoted(intptr_t size);
+  // Return the memory of a promoted copy which was never used.
+  void FreePromoted(uword addr, intptr_t size);
+
+  // Allocate in old space or the code space once an allocation failed after
+  // a full collection. Grants the spaces their reserve and records a pending
+  // out of memory error, no garbage collection is triggered. Returns 0 if the
+  // reserve is exhausted as well.
+  uword AllocateFromReserve(intptr_t size, Space space);
+
   // Heap contains the specified address.
   bool Contains(uword addr) const;
   bool CodeContains(uword addr) const;
@@ -52,14 +68,99 @@ class Heap {
   // Initialize the heap and register it with the isolate.
   static void Init(Isolate* isolate);
 
-  // Verify that all pointers in the heap point to the heap.
+  // Collect the garbage in the specified space. Collecting the code space
+  // also collects old space, and reclaims the code which is no longer
+  // referenced by any function, stack frame or other live object. The reason
+  // is recorded in the timeline.
+  void CollectGarbage(Space space,
+                      GCEvent::Reason reason = GCEvent::kExplicit);
+  // Collect the garbage in all spaces.
+  void CollectAllGarbage();
+  // Collect the garbage in old space and compact it, releasing the pages left
+  // empty.
+  void CompactOldSpace(GCEvent::Reason reason = GCEvent::kExplicit);
+  // Compact old space if too much of it is fragmented into free blocks. Only
+  // called where no raw pointers into the heap are held, e.g. between
+  // messages.
+  void CompactOldSpaceIfFragmented();
+
+  // Limit the size of each of the two new space semi-spaces, in bytes. New
+  // space adapts its size within these limits at every scavenge.
+  void SetNewSpaceLimits(intptr_t min_semi_space_size,
+                         intptr_t max_semi_space_size);
+
+  // Limit the capacity of old space, in bytes. Allocation which would exceed
+  // the limit after a full collection is served from the reserve, see
+  // AllocateFromReserve.
+  void SetOldSpaceLimit(intptr_t max_old_space_size);
+  intptr_t OldSpaceLimit() const { return old_space_limit_; }
+
+  // Set once an allocation failed after a full collection. The limits of old
+  // space and the code space are raised by kOutOfMemoryReserve so that the
+  // allocation, the OutOfMemoryException and its stack trace succeed, and
+  // restored once a collection brings both spaces back within their limits.
+  bool is_out_of_memory() const { return out_of_memory_; }
+  void SetOutOfMemory();
+
+  // Set by AllocateFromReserve. The allocation itself cannot unwind, the
+  // OutOfMemoryException is thrown once control returns to a runtime or
+  // native entry, see Exceptions::ThrowPendingOutOfMemory.
+  bool has_pending_out_of_memory() const { return pending_out_of_memory_; }
+  void clear_pending_out_of_memory() { pending_out_of_memory_ = false; }
+
+  // Start marking old space on a helper thread, see --concurrent_mark. The
+  // next collection of old space completes the marking and uses its result.
+  void StartConcurrentMarking();
+  bool IsMarking() const;
+
+  // Mark the old objects logged by the write barrier while marking.
+  void MarkPointers(uword* pointers, intptr_t length);
+
+  // Number of bytes in use and reserved for objects in the specified space.
+  intptr_t InUse(Space space) const;
+  intptr_t Capacity(Space space) const;
+
+  // Number of collections of the specified space and the total time in
+  // microseconds the mutator was paused by them. The code space is only
+  // collected together with old space, its pauses are included in both.
+  intptr_t Collections(Space space) const;
+  int64_t CollectionTime(Space space) const;
+
+  // Number of bytes in the pages of the specified space which have not been
+  // swept since the last collection, and the total time in microseconds
+  // spent sweeping pages on demand. New space is never swept.
+  intptr_t Unswept(Space space) const;
+  int64_t SweepTime(Space space) const;
+
+  // The recent collections of this heap and the histograms of their pauses.
+  const GCTimeline& timeline() const { return timeline_; }
+
+  // Sweep the pages of old space left unswept by the last collection.
+  void CompleteSweeping();
+
+  // Verify that all pointers in the heap point to the heap. Old space must
+  // have been swept completely.
   bool Verify() const;
 
+  void IterateNewPointers(ObjectPointerVisitor* visitor);
   void IterateOldPointers(ObjectPointerVisitor* visitor);
+  void IterateCodePointers(ObjectPointerVisitor* visitor);
+
+  void IterateObjects(ObjectVisitor* visitor);
+  void IterateOldObjects(ObjectVisitor* visitor);
+
+  // The pages of the large objects in old space. Their card tables remember
+  // the parts of large arrays which point into new space.
+  HeapPage* OldLargePages() const;
 
   // Accessors for inlined allocation in generated code.
   uword TopAddress();
   uword EndAddress();
+  // Pretenured instances are allocated inline in the allocation buffer of
+  // old space, which the runtime refills once it ran out.
+  uword OldTopAddress();
+  uword OldEndAddress();
+  void RefillOldAllocationBuffer();
   static intptr_t new_space_offset() { return OFFSET_OF(Heap, new_space_); }
 
  private:
@@ -69,15 +170,40 @@ class Heap {
   uword AllocateOld(intptr_t size);
   uword AllocateCode(intptr_t size);
 
-  // Allocation is limited to the below sizes.
-  static const intptr_t kHeapSize = 512 * MB;
-  static const intptr_t kCodeHeapSize = 4 * MB;
+  // Bytes in use in all spaces.
+  intptr_t UsedInHeap() const;
+  // Add the collection which started at 'start_micros' to the timeline.
+  void RecordCollection(GCEvent::Kind kind,
+                        GCEvent::Reason reason,
+                        int64_t start_micros,
+                        intptr_t used_before);
+
+  // Run the callbacks of the weak persistent handles cleared by the last
+  // collection, once it is complete.
+  void RunFinalizers();
+
+  // Clear the out of memory state if the last collection freed enough.
+  void UpdateOutOfMemory();
+
+  void PrintSizes() const;
+
+  // Allocation in the code space is limited to the below size, old space is
+  // limited by --old_gen_heap_size or SetOldSpaceLimit.
+  static const intptr_t kCodeHeapSize = 256 * MB;
+  // Headroom granted to the spaces once they are exhausted.
+  static const intptr_t kOutOfMemoryReserve = 1 * MB;
 
   // The different spaces used for allocation.
   Scavenger* new_space_;
   PageSpace* old_space_;
   PageSpace* code_space_;
 
+  intptr_t old_space_limit_;
+  bool out_of_memory_;
+  bool pending_out_of_memory_;
+
+  GCTimeline timeline_;
+
   DISALLOW_COPY_AND_ASSIGN(Heap);
 };
 
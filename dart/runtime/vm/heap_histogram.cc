@@ -0,0 +1,152 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/heap_histogram.h"
+
+#include "vm/heap.h"
+#include "vm/object.h"
+#include "vm/os.h"
+#include "vm/visitor.h"
+
+namespace dart {
+
+class HeapHistogramVisitor : public ObjectVisitor {
+ public:
+  explicit HeapHistogramVisitor(HeapHistogram* histogram)
+      : histogram_(histogram) {}
+
+  void VisitObject(RawObject* raw_obj) {
+    RawClass* cls = raw_obj->ptr()->class_;
+    // Free list elements fill the holes in old space pages, they are not
+    // objects of the program.
+    if (cls == Object::free_list_element_class()) {
+      return;
+    }
+    histogram_->Add(cls, raw_obj->Size());
+  }
+
+ private:
+  HeapHistogram* histogram_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapHistogramVisitor);
+};
+
+
+static inline uword ClassHash(RawClass* cls) {
+  // Objects are aligned, drop the low bits before mixing.
+  return (reinterpret_cast<uword>(cls) / kObjectAlignment) * 2654435761U;
+}
+
+
+HeapHistogram::HeapHistogram(Heap* heap)
+    : entries_(NULL),
+      capacity_(0),
+      length_(0),
+      classes_(NULL),
+      total_count_(0),
+      total_size_(0) {
+  NoGCScope no_gc;
+  Grow();
+  HeapHistogramVisitor visitor(this);
+  heap->IterateObjects(&visitor);
+  Sort();
+}
+
+
+HeapHistogram::~HeapHistogram() {
+  free(entries_);
+  free(classes_);
+}
+
+
+void HeapHistogram::Add(RawClass* cls, intptr_t size) {
+  // Keep the load factor of the table below 50%.
+  if ((2 * (length_ + 1)) > capacity_) {
+    Grow();
+  }
+  intptr_t mask = capacity_ - 1;
+  intptr_t index = ClassHash(cls) & mask;
+  while (entries_[index].cls != NULL) {
+    if (entries_[index].cls == cls) {
+      break;
+    }
+    index = (index + 1) & mask;
+  }
+  Entry* entry = &entries_[index];
+  if (entry->cls == NULL) {
+    entry->cls = cls;
+    length_++;
+  }
+  entry->count++;
+  entry->size += size;
+  total_count_++;
+  total_size_ += size;
+}
+
+
+void HeapHistogram::Grow() {
+  Entry* old_entries = entries_;
+  intptr_t old_capacity = capacity_;
+  capacity_ = (old_capacity == 0) ? kInitialCapacity : (2 * old_capacity);
+  ASSERT(Utils::IsPowerOfTwo(capacity_));
+  entries_ = reinterpret_cast<Entry*>(calloc(capacity_, sizeof(Entry)));
+  if (entries_ == NULL) {
+    FATAL("Out of memory growing the heap histogram.");
+  }
+  intptr_t mask = capacity_ - 1;
+  for (intptr_t i = 0; i < old_capacity; i++) {
+    if (old_entries[i].cls != NULL) {
+      intptr_t index = ClassHash(old_entries[i].cls) & mask;
+      while (entries_[index].cls != NULL) {
+        index = (index + 1) & mask;
+      }
+      entries_[index] = old_entries[i];
+    }
+  }
+  free(old_entries);
+}
+
+
+int HeapHistogram::CompareEntries(const void* a, const void* b) {
+  intptr_t a_size = reinterpret_cast<const Entry*>(a)->size;
+  intptr_t b_size = reinterpret_cast<const Entry*>(b)->size;
+  if (a_size > b_size) {
+    return -1;
+  }
+  return (a_size < b_size) ? 1 : 0;
+}
+
+
+void HeapHistogram::Sort() {
+  intptr_t j = 0;
+  for (intptr_t i = 0; i < capacity_; i++) {
+    if (entries_[i].cls != NULL) {
+      entries_[j++] = entries_[i];
+    }
+  }
+  ASSERT(j == length_);
+  qsort(entries_, length_, sizeof(Entry), CompareEntries);
+  classes_ = reinterpret_cast<const Class**>(
+      malloc(Utils::Maximum(length_, static_cast<intptr_t>(1)) *
+             sizeof(classes_[0])));
+  if (classes_ == NULL) {
+    FATAL("Out of memory sorting the heap histogram.");
+  }
+  for (intptr_t i = 0; i < length_; i++) {
+    classes_[i] = &Class::ZoneHandle(entries_[i].cls);
+  }
+}
+
+
+void HeapHistogram::Print() const {
+  OS::Print("%10s %10s  %s\n", "count", "bytes", "class");
+  String& name = String::Handle();
+  for (intptr_t i = 0; i < length_; i++) {
+    name = ClassAt(i).Name();
+    OS::Print("%10d %10d  %s\n", CountAt(i), SizeAt(i), name.ToCString());
+  }
+  OS::Print("%10d %10d  total\n", total_count_, total_size_);
+}
+
+}  // namespace dart
@@ -0,0 +1,82 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_HEAP_HISTOGRAM_H_
+#define VM_HEAP_HISTOGRAM_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// Forward declarations.
+class Class;
+class Heap;
+class RawClass;
+
+// HeapHistogram counts the instances of each class and the bytes they occupy
+// by walking all objects of a heap. The classes are kept in zone handles, so
+// the histogram remains valid across garbage collections.
+class HeapHistogram : public ValueObject {
+ public:
+  explicit HeapHistogram(Heap* heap);
+  ~HeapHistogram();
+
+  // Number of classes with instances. Entries are sorted by the number of
+  // bytes occupied by the instances of the class, largest first.
+  intptr_t Length() const { return length_; }
+
+  const Class& ClassAt(intptr_t index) const {
+    ASSERT((index >= 0) && (index < length_));
+    return *classes_[index];
+  }
+  intptr_t CountAt(intptr_t index) const {
+    ASSERT((index >= 0) && (index < length_));
+    return entries_[index].count;
+  }
+  intptr_t SizeAt(intptr_t index) const {
+    ASSERT((index >= 0) && (index < length_));
+    return entries_[index].size;
+  }
+
+  // Total number of objects and bytes counted.
+  intptr_t total_count() const { return total_count_; }
+  intptr_t total_size() const { return total_size_; }
+
+  void Print() const;
+
+ private:
+  struct Entry {
+    RawClass* cls;
+    intptr_t count;
+    intptr_t size;
+  };
+
+  static const intptr_t kInitialCapacity = 256;
+
+  void Add(RawClass* cls, intptr_t size);
+  void Grow();
+  // Move the used entries of the table to its front, sort them and create
+  // the handles of their classes.
+  void Sort();
+  static int CompareEntries(const void* a, const void* b);
+
+  // Open addressed hash table keyed by class, unused entries have no class.
+  // Once the heap has been walked the used entries are moved to the front.
+  Entry* entries_;
+  intptr_t capacity_;
+  intptr_t length_;
+  const Class** classes_;
+
+  intptr_t total_count_;
+  intptr_t total_size_;
+
+  friend class HeapHistogramVisitor;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapHistogram);
+};
+
+}  // namespace dart
+
+#endif  // VM_HEAP_HISTOGRAM_H_
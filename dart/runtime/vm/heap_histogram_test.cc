@@ -0,0 +1,55 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/assert.h"
+#include "vm/heap.h"
+#include "vm/heap_histogram.h"
+#include "vm/object.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+TEST_CASE(HeapHistogram) {
+  const intptr_t kNumArrays = 100;
+  const intptr_t kArrayLength = 10;
+  const Array& retained = Array::Handle(Array::New(kNumArrays, Heap::kOld));
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    const Array& array = Array::Handle(Array::New(kArrayLength, Heap::kNew));
+    retained.SetAt(i, array);
+  }
+  Heap* heap = Isolate::Current()->heap();
+  HeapHistogram histogram(heap);
+  EXPECT(histogram.Length() > 0);
+
+  // Entries are sorted by size and add up to the totals.
+  const Class& array_class = Class::Handle(retained.clazz());
+  intptr_t array_index = -1;
+  intptr_t total_count = 0;
+  intptr_t total_size = 0;
+  for (intptr_t i = 0; i < histogram.Length(); i++) {
+    if (i > 0) {
+      EXPECT(histogram.SizeAt(i - 1) >= histogram.SizeAt(i));
+    }
+    if (histogram.ClassAt(i).raw() == array_class.raw()) {
+      array_index = i;
+    }
+    total_count += histogram.CountAt(i);
+    total_size += histogram.SizeAt(i);
+  }
+  EXPECT_EQ(histogram.total_count(), total_count);
+  EXPECT_EQ(histogram.total_size(), total_size);
+
+  // The arrays allocated above are counted, in both spaces.
+  EXPECT(array_index >= 0);
+  EXPECT(histogram.CountAt(array_index) >= (kNumArrays + 1));
+  EXPECT(histogram.SizeAt(array_index) >=
+         ((kNumArrays * Array::InstanceSize(kArrayLength)) +
+          Array::InstanceSize(kNumArrays)));
+
+  // The histogram holds on to its classes across collections.
+  heap->CollectAllGarbage();
+  EXPECT(histogram.ClassAt(array_index).raw() == array_class.raw());
+}
+
+}  // namespace dart
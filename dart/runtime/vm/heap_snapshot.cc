@@ -0,0 +1,309 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/heap_snapshot.h"
+
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/object.h"
+#include "vm/visitor.h"
+#include "vm/zone.h"
+
+namespace dart {
+
+const char HeapSnapshotWriter::kMagic[] = "dartheap";
+volatile bool HeapSnapshotWriter::requested_ = false;
+Dart_HeapSnapshotCallback HeapSnapshotWriter::callback_ = NULL;
+
+
+// Null is shared by all isolates and referenced by most fields, references
+// to it are not written.
+static inline bool IsSnapshotReference(RawObject* raw_obj) {
+  return raw_obj->IsHeapObject() && (raw_obj != Object::null());
+}
+
+
+class HeapSnapshotEdgeVisitor : public ObjectPointerVisitor {
+ public:
+  explicit HeapSnapshotEdgeVisitor(HeapSnapshotWriter* writer)
+      : writer_(writer) {}
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      if (IsSnapshotReference(*current)) {
+        writer_->AddEdge(*current);
+      }
+    }
+  }
+
+ private:
+  HeapSnapshotWriter* writer_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapSnapshotEdgeVisitor);
+};
+
+
+class HeapSnapshotObjectVisitor : public ObjectVisitor {
+ public:
+  explicit HeapSnapshotObjectVisitor(HeapSnapshotWriter* writer)
+      : writer_(writer) {}
+
+  void VisitObject(RawObject* raw_obj) {
+    writer_->WriteObject(raw_obj);
+  }
+
+ private:
+  HeapSnapshotWriter* writer_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapSnapshotObjectVisitor);
+};
+
+
+class HeapSnapshotRootVisitor : public ObjectPointerVisitor {
+ public:
+  explicit HeapSnapshotRootVisitor(HeapSnapshotWriter* writer)
+      : writer_(writer) {}
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      if (IsSnapshotReference(*current)) {
+        writer_->WriteUnsigned(HeapSnapshotWriter::kRootRecord);
+        writer_->WriteId(*current);
+      }
+    }
+  }
+
+ private:
+  HeapSnapshotWriter* writer_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapSnapshotRootVisitor);
+};
+
+
+HeapSnapshotWriter::HeapSnapshotWriter(uint8_t** buffer, ReAlloc alloc)
+    : buffer_(buffer),
+      current_(NULL),
+      end_(NULL),
+      size_(0),
+      alloc_(alloc),
+      edges_(NULL),
+      edge_count_(0),
+      edge_capacity_(kInitialEdgeCapacity),
+      classes_(NULL),
+      class_count_(0),
+      class_capacity_(0) {
+  ASSERT(buffer != NULL);
+  ASSERT(alloc != NULL);
+  *buffer_ = alloc_(NULL, 0, kBufferIncrementSize);
+  ASSERT(*buffer_ != NULL);
+  current_ = *buffer_;
+  size_ = kBufferIncrementSize;
+  end_ = *buffer_ + size_;
+  edges_ = reinterpret_cast<RawObject**>(
+      malloc(edge_capacity_ * sizeof(edges_[0])));
+  if (edges_ == NULL) {
+    FATAL("Out of memory writing the heap snapshot.");
+  }
+  GrowClasses();
+}
+
+
+HeapSnapshotWriter::~HeapSnapshotWriter() {
+  free(edges_);
+  free(classes_);
+}
+
+
+void HeapSnapshotWriter::WriteByte(uint8_t value) {
+  if (current_ >= end_) {
+    intptr_t new_size = size_ + kBufferIncrementSize;
+    *buffer_ = alloc_(*buffer_, size_, new_size);
+    ASSERT(*buffer_ != NULL);
+    current_ = *buffer_ + size_;
+    size_ = new_size;
+    end_ = *buffer_ + size_;
+  }
+  *current_++ = value;
+}
+
+
+void HeapSnapshotWriter::WriteUnsigned(uword value) {
+  while (value >= 0x80) {
+    WriteByte(static_cast<uint8_t>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  WriteByte(static_cast<uint8_t>(value));
+}
+
+
+void HeapSnapshotWriter::WriteId(RawObject* raw_obj) {
+  WriteUnsigned(RawObject::ToAddr(raw_obj) / kObjectAlignment);
+}
+
+
+void HeapSnapshotWriter::WriteSnapshot(Isolate* isolate) {
+  ASSERT(isolate == Isolate::Current());
+  // Objects are identified by their address, they must not move while the
+  // snapshot is written.
+  NoGCScope no_gc;
+  for (intptr_t i = 0; i < kMagicLength; i++) {
+    WriteByte(kMagic[i]);
+  }
+  WriteUnsigned(kVersion);
+  WriteUnsigned(kWordSize);
+
+  HeapSnapshotObjectVisitor object_visitor(this);
+  isolate->heap()->IterateObjects(&object_visitor);
+
+  HeapSnapshotRootVisitor root_visitor(this);
+  isolate->VisitObjectPointers(&root_visitor, false);
+
+  WriteClasses();
+  WriteUnsigned(kEndRecord);
+}
+
+
+void HeapSnapshotWriter::WriteObject(RawObject* raw_obj) {
+  RawClass* raw_class = raw_obj->ptr()->class_;
+  // Free list elements fill the holes in old space pages, they are not
+  // objects of the program.
+  if (raw_class == Object::free_list_element_class()) {
+    return;
+  }
+  AddClass(raw_class);
+  edge_count_ = 0;
+  HeapSnapshotEdgeVisitor edge_visitor(this);
+  intptr_t size = raw_obj->VisitPointers(&edge_visitor);
+  WriteUnsigned(kObjectRecord);
+  WriteId(raw_obj);
+  WriteId(raw_class);
+  WriteUnsigned(size);
+  WriteUnsigned(edge_count_);
+  for (intptr_t i = 0; i < edge_count_; i++) {
+    WriteId(edges_[i]);
+  }
+}
+
+
+void HeapSnapshotWriter::WriteClasses() {
+  HandleScope handle_scope;
+  Class& cls = Class::Handle();
+  String& name = String::Handle();
+  for (intptr_t i = 0; i < class_capacity_; i++) {
+    if (classes_[i] == NULL) {
+      continue;
+    }
+    cls = classes_[i];
+    // The names of the VM internal classes are allocated on demand, which is
+    // not possible while the snapshot is written.
+    const char* class_name = NULL;
+    intptr_t index = Object::GetSingletonClassIndex(cls.raw());
+    if (index != Object::kInvalidIndex) {
+      class_name = Object::GetSingletonClassName(index);
+    } else {
+      name = cls.Name();
+      class_name = name.ToCString();
+    }
+    intptr_t length = strlen(class_name);
+    WriteUnsigned(kClassRecord);
+    WriteId(cls.raw());
+    WriteUnsigned(length);
+    for (intptr_t j = 0; j < length; j++) {
+      WriteByte(class_name[j]);
+    }
+  }
+}
+
+
+void HeapSnapshotWriter::AddEdge(RawObject* raw_obj) {
+  if (edge_count_ == edge_capacity_) {
+    edge_capacity_ *= 2;
+    edges_ = reinterpret_cast<RawObject**>(
+        realloc(edges_, edge_capacity_ * sizeof(edges_[0])));
+    if (edges_ == NULL) {
+      FATAL("Out of memory writing the heap snapshot.");
+    }
+  }
+  edges_[edge_count_++] = raw_obj;
+}
+
+
+static inline uword ClassHash(RawClass* cls) {
+  // Objects are aligned, drop the low bits before mixing.
+  return (reinterpret_cast<uword>(cls) / kObjectAlignment) * 2654435761U;
+}
+
+
+void HeapSnapshotWriter::AddClass(RawClass* raw_class) {
+  intptr_t mask = class_capacity_ - 1;
+  intptr_t index = ClassHash(raw_class) & mask;
+  while (classes_[index] != NULL) {
+    if (classes_[index] == raw_class) {
+      return;
+    }
+    index = (index + 1) & mask;
+  }
+  classes_[index] = raw_class;
+  class_count_++;
+  // Keep the load factor of the set below 50%.
+  if ((2 * class_count_) > class_capacity_) {
+    GrowClasses();
+  }
+}
+
+
+void HeapSnapshotWriter::GrowClasses() {
+  RawClass** old_classes = classes_;
+  intptr_t old_capacity = class_capacity_;
+  class_capacity_ =
+      (old_capacity == 0) ? kInitialClassCapacity : (2 * old_capacity);
+  ASSERT(Utils::IsPowerOfTwo(class_capacity_));
+  classes_ = reinterpret_cast<RawClass**>(
+      calloc(class_capacity_, sizeof(classes_[0])));
+  if (classes_ == NULL) {
+    FATAL("Out of memory writing the heap snapshot.");
+  }
+  intptr_t mask = class_capacity_ - 1;
+  for (intptr_t i = 0; i < old_capacity; i++) {
+    if (old_classes[i] != NULL) {
+      intptr_t index = ClassHash(old_classes[i]) & mask;
+      while (classes_[index] != NULL) {
+        index = (index + 1) & mask;
+      }
+      classes_[index] = old_classes[i];
+    }
+  }
+  free(old_classes);
+}
+
+
+static uint8_t* MallocAllocator(uint8_t* ptr,
+                                intptr_t old_size,
+                                intptr_t new_size) {
+  void* new_ptr = realloc(reinterpret_cast<void*>(ptr), new_size);
+  return reinterpret_cast<uint8_t*>(new_ptr);
+}
+
+
+void HeapSnapshotWriter::HandleRequest() {
+  if (!requested_) {
+    return;
+  }
+  requested_ = false;
+  if (callback_ == NULL) {
+    return;
+  }
+  uint8_t* buffer = NULL;
+  intptr_t size = 0;
+  {
+    Zone zone;
+    HeapSnapshotWriter writer(&buffer, MallocAllocator);
+    writer.WriteSnapshot(Isolate::Current());
+    size = writer.BytesWritten();
+  }
+  (*callback_)(buffer, size);
+  free(buffer);
+}
+
+}  // namespace dart
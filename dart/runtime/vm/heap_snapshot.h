@@ -0,0 +1,111 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_HEAP_SNAPSHOT_H_
+#define VM_HEAP_SNAPSHOT_H_
+
+#include "include/dart_api.h"
+#include "vm/allocation.h"
+#include "vm/globals.h"
+#include "vm/snapshot.h"
+
+namespace dart {
+
+// Forward declarations.
+class Isolate;
+class RawClass;
+class RawObject;
+
+// HeapSnapshotWriter writes the object graph of an isolate for offline
+// analysis, e.g. to find the objects retaining most of the heap of a program
+// which leaks memory. The graph consists of all objects in the heap with
+// their classes, sizes and references, and of the roots of the isolate.
+//
+// All numbers are unsigned LEB128 encoded. Objects are identified by their
+// address divided by kObjectAlignment. The snapshot is laid out as:
+//   header:  "dartheap" kVersion kWordSize
+//   records: kObjectRecord id class_id size edge_count edge_id*
+//            kClassRecord class_id name_length name_bytes
+//            kRootRecord id
+//   end:     kEndRecord
+// Classes are objects as well, a class record names the object with the
+// same id. References to objects outside of the isolate heap, such as the
+// objects shared in the VM isolate, have no object record.
+class HeapSnapshotWriter : public ValueObject {
+ public:
+  enum RecordTag {
+    kEndRecord = 0,
+    kObjectRecord,
+    kClassRecord,
+    kRootRecord,
+  };
+
+  static const char kMagic[];
+  static const intptr_t kMagicLength = 8;
+  static const intptr_t kVersion = 1;
+
+  HeapSnapshotWriter(uint8_t** buffer, ReAlloc alloc);
+  ~HeapSnapshotWriter();
+
+  // Write the object graph of 'isolate', which must be the current isolate.
+  void WriteSnapshot(Isolate* isolate);
+
+  intptr_t BytesWritten() const { return current_ - *buffer_; }
+
+  // Ask for a snapshot to be written by the next isolate which reaches a safe
+  // point, see HandleRequest. Only sets a flag, so it may be called from a
+  // signal handler.
+  static void RequestSnapshot() { requested_ = true; }
+  static void SetCallback(Dart_HeapSnapshotCallback callback) {
+    callback_ = callback;
+  }
+  // Write a snapshot of the current isolate and pass it to the callback if
+  // one has been requested. Called between messages by the run loop.
+  static void HandleRequest();
+
+ private:
+  static const intptr_t kBufferIncrementSize = 64 * KB;
+  static const intptr_t kInitialClassCapacity = 256;
+  static const intptr_t kInitialEdgeCapacity = 64;
+
+  void WriteByte(uint8_t value);
+  void WriteUnsigned(uword value);
+  void WriteId(RawObject* raw_obj);
+
+  void WriteObject(RawObject* raw_obj);
+  void WriteClasses();
+  void AddEdge(RawObject* raw_obj);
+  void AddClass(RawClass* raw_class);
+  void GrowClasses();
+
+  uint8_t** const buffer_;
+  uint8_t* current_;
+  uint8_t* end_;
+  intptr_t size_;
+  ReAlloc alloc_;
+
+  // Targets of the references of the object being written.
+  RawObject** edges_;
+  intptr_t edge_count_;
+  intptr_t edge_capacity_;
+
+  // Open addressed hash set of the classes of the objects written, unused
+  // entries are NULL.
+  RawClass** classes_;
+  intptr_t class_count_;
+  intptr_t class_capacity_;
+
+  static volatile bool requested_;
+  static Dart_HeapSnapshotCallback callback_;
+
+  friend class HeapSnapshotEdgeVisitor;
+  friend class HeapSnapshotObjectVisitor;
+  friend class HeapSnapshotRootVisitor;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapSnapshotWriter);
+};
+
+}  // namespace dart
+
+#endif  // VM_HEAP_SNAPSHOT_H_
@@ -0,0 +1,109 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/assert.h"
+#include "vm/heap.h"
+#include "vm/heap_snapshot.h"
+#include "vm/object.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static uint8_t* malloc_allocator(
+    uint8_t* ptr, intptr_t old_size, intptr_t new_size) {
+  return reinterpret_cast<uint8_t*>(realloc(ptr, new_size));
+}
+
+
+static uword ReadUnsigned(const uint8_t** current) {
+  uword result = 0;
+  intptr_t shift = 0;
+  uint8_t byte;
+  do {
+    byte = *(*current)++;
+    result |= static_cast<uword>(byte & 0x7f) << shift;
+    shift += 7;
+  } while ((byte & 0x80) != 0);
+  return result;
+}
+
+
+static uword SnapshotId(const Object& obj) {
+  return RawObject::ToAddr(obj.raw()) / kObjectAlignment;
+}
+
+
+TEST_CASE(HeapSnapshot) {
+  const Array& array = Array::Handle(Array::New(1, Heap::kOld));
+  const String& element = String::Handle(String::New("element"));
+  array.SetAt(0, element);
+  const Class& array_class = Class::Handle(array.clazz());
+
+  uint8_t* buffer = NULL;
+  HeapSnapshotWriter writer(&buffer, &malloc_allocator);
+  writer.WriteSnapshot(Isolate::Current());
+  const uint8_t* current = buffer;
+  const uint8_t* end = buffer + writer.BytesWritten();
+
+  EXPECT(memcmp(current,
+                HeapSnapshotWriter::kMagic,
+                HeapSnapshotWriter::kMagicLength) == 0);
+  current += HeapSnapshotWriter::kMagicLength;
+  EXPECT_EQ(static_cast<uword>(HeapSnapshotWriter::kVersion),
+            ReadUnsigned(&current));
+  EXPECT_EQ(static_cast<uword>(kWordSize), ReadUnsigned(&current));
+
+  bool found_array = false;
+  bool found_array_root = false;
+  bool found_array_class = false;
+  bool found_end = false;
+  while (current < end) {
+    uword tag = ReadUnsigned(&current);
+    if (tag == HeapSnapshotWriter::kEndRecord) {
+      found_end = true;
+      break;
+    }
+    uword id = ReadUnsigned(&current);
+    if (tag == HeapSnapshotWriter::kObjectRecord) {
+      uword class_id = ReadUnsigned(&current);
+      uword size = ReadUnsigned(&current);
+      uword edge_count = ReadUnsigned(&current);
+      bool references_element = false;
+      for (uword i = 0; i < edge_count; i++) {
+        if (ReadUnsigned(&current) == SnapshotId(element)) {
+          references_element = true;
+        }
+      }
+      if (id == SnapshotId(array)) {
+        found_array = true;
+        EXPECT_EQ(SnapshotId(array_class), class_id);
+        EXPECT_EQ(static_cast<uword>(Array::InstanceSize(1)), size);
+        // The class and the element.
+        EXPECT_EQ(static_cast<uword>(2), edge_count);
+        EXPECT(references_element);
+      }
+    } else if (tag == HeapSnapshotWriter::kClassRecord) {
+      uword length = ReadUnsigned(&current);
+      current += length;
+      if (id == SnapshotId(array_class)) {
+        EXPECT(length > 0);
+        found_array_class = true;
+      }
+    } else {
+      EXPECT_EQ(static_cast<uword>(HeapSnapshotWriter::kRootRecord), tag);
+      if (id == SnapshotId(array)) {
+        // Referenced from the handle above.
+        found_array_root = true;
+      }
+    }
+  }
+  EXPECT(found_array);
+  EXPECT(found_array_root);
+  EXPECT(found_array_class);
+  EXPECT(found_end);
+  EXPECT(current == end);
+  free(buffer);
+}
+
+}  // namespace dart
@@ -2,4 +2,569 @@
 // for details. All rights reserved. Use of this source code is governed by a
 // BSD-style license that can be found in the LICENSE file.
 
-// TODO(iposva): Intentionally left blank for now.
+#include "include/dart_api.h"
+#include "vm/assert.h"
+#include "vm/dart.h"
+#include "vm/dart_api_impl.h"
+#include "vm/heap.h"
+#include "vm/object.h"
+#include "vm/os.h"
+#include "vm/pages.h"
+#include "vm/store_buffer.h"
+#include "vm/thread_pool.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(bool, heap_huge_pages);
+DECLARE_FLAG(int, scavenger_tasks);
+DECLARE_FLAG(int, tenure_threshold);
+DECLARE_FLAG(bool, lazy_sweep);
+DECLARE_FLAG(bool, pretenure);
+
+TEST_CASE(OldGC) {
+  const String& name = String::Handle(String::New("retained", Heap::kOld));
+  const Array& retained = Array::Handle(Array::New(2, Heap::kOld));
+  retained.SetAt(0, name);
+  // Allocate plenty of garbage in old space, more than the initial growth
+  // limit allows, so that allocation triggers collections on its own.
+  // Array::New leaves a handle behind, release them with their scope.
+  {
+    HANDLESCOPE();
+    for (intptr_t i = 0; i < 4096; i++) {
+      Array::New(1024, Heap::kOld);
+    }
+  }
+  Heap* heap = Isolate::Current()->heap();
+  heap->CollectGarbage(Heap::kOld);
+  String& str = String::Handle();
+  str ^= retained.At(0);
+  EXPECT(str.Equals("retained"));
+  EXPECT(retained.At(1) == Object::null());
+  // Reuse the reclaimed memory.
+  {
+    HANDLESCOPE();
+    for (intptr_t i = 0; i < 4096; i++) {
+      Array::New(1024, Heap::kOld);
+    }
+  }
+  heap->CollectAllGarbage();
+  str ^= retained.At(0);
+  EXPECT(str.Equals("retained"));
+  heap->CompleteSweeping();
+  EXPECT(heap->Verify());
+}
+
+
+TEST_CASE(RememberedSet) {
+  const Array& old_array = Array::Handle(Array::New(1, Heap::kOld));
+  const String& str = String::Handle(String::New("remembered", Heap::kNew));
+  old_array.SetAt(0, str);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  heap->CollectGarbage(Heap::kNew);
+  // The old array was remembered and its element updated by the scavenge.
+  EXPECT(old_array.At(0) == str.raw());
+  EXPECT(str.raw()->IsNewObject());
+  EXPECT(isolate->store_buffer()->Contains(
+      reinterpret_cast<uword>(old_array.raw())));
+  // Once the array no longer points into new space it is forgotten.
+  old_array.SetAt(0, Object::Handle());
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(!isolate->store_buffer()->Contains(
+      reinterpret_cast<uword>(old_array.raw())));
+  EXPECT(heap->Verify());
+}
+
+
+TEST_CASE(Promotion) {
+  const intptr_t saved_threshold = FLAG_tenure_threshold;
+  FLAG_tenure_threshold = 2;
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const Array& array = Array::Handle(Array::New(1));
+  EXPECT(array.raw()->IsNewObject());
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(array.raw()->IsNewObject());
+  // Store a younger object which is not promoted together with the array.
+  const String& str = String::Handle(String::New("young"));
+  array.SetAt(0, str);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(array.raw()->IsOldObject());
+  EXPECT(str.raw()->IsNewObject());
+  EXPECT(array.At(0) == str.raw());
+  // The promoted array still points into new space.
+  EXPECT(isolate->store_buffer()->Contains(
+      reinterpret_cast<uword>(array.raw())));
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(str.raw()->IsOldObject());
+  EXPECT(array.At(0) == str.raw());
+  EXPECT(str.Equals("young"));
+  EXPECT(heap->Verify());
+  FLAG_tenure_threshold = saved_threshold;
+}
+
+
+TEST_CASE(NewSpaceSizing) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const Array& array = Array::Handle(Array::New(1, Heap::kNew));
+  array.SetAt(0, Smi::Handle(Smi::New(42)));
+  // The semi-spaces are resized to fit the limits at the next scavenge.
+  heap->SetNewSpaceLimits(512 * KB, 512 * KB);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_EQ(512 * KB, heap->Capacity(Heap::kNew));
+  heap->SetNewSpaceLimits(2 * MB, 4 * MB);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(heap->Capacity(Heap::kNew) >= 2 * MB);
+  EXPECT(heap->Capacity(Heap::kNew) <= 4 * MB);
+  // Objects survive the resizing.
+  EXPECT_EQ(1, array.Length());
+  EXPECT_EQ(42, Smi::CheckedHandle(array.At(0)).Value());
+  EXPECT(heap->Verify());
+}
+
+
+// Helper threads return to the pool after they signal the completion of
+// their task.
+static void WaitForIdleThreads(ThreadPool* thread_pool) {
+  while (thread_pool->idle_thread_count() < thread_pool->thread_count()) {
+    OS::Sleep(1);
+  }
+}
+
+
+TEST_CASE(ParallelScavenge) {
+  const intptr_t saved_tasks = FLAG_scavenger_tasks;
+  FLAG_scavenger_tasks = 4;
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // A long chain of new arrays spanning many local allocation buffers, held
+  // by a remembered old array.
+  const intptr_t kLength = 10000;
+  const Array& old_array = Array::Handle(Array::New(1, Heap::kOld));
+  Array& array = Array::Handle();
+  Array& previous = Array::Handle();
+  for (intptr_t i = 0; i < kLength; i++) {
+    array = Array::New(2);
+    array.SetAt(0, Smi::Handle(Smi::New(i)));
+    array.SetAt(1, previous);
+    previous = array.raw();
+  }
+  old_array.SetAt(0, array);
+  array ^= Object::null();
+  previous ^= Object::null();
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(isolate->store_buffer()->Contains(
+      reinterpret_cast<uword>(old_array.raw())));
+  Smi& smi = Smi::Handle();
+  array ^= old_array.At(0);
+  for (intptr_t i = kLength - 1; i >= 0; i--) {
+    smi ^= array.At(0);
+    EXPECT_EQ(i, smi.Value());
+    array ^= array.At(1);
+  }
+  EXPECT(array.IsNull());
+  EXPECT(heap->Verify());
+  // Later scavenges reuse the helper threads.
+  ThreadPool* thread_pool = Dart::thread_pool();
+  WaitForIdleThreads(thread_pool);
+  const intptr_t thread_count = thread_pool->thread_count();
+  EXPECT_LE(FLAG_scavenger_tasks - 1, thread_count);
+  for (intptr_t i = 0; i < 5; i++) {
+    heap->CollectGarbage(Heap::kNew);
+    WaitForIdleThreads(thread_pool);
+  }
+  EXPECT_EQ(thread_count, thread_pool->thread_count());
+  FLAG_scavenger_tasks = saved_tasks;
+}
+
+
+TEST_CASE(Pretenuring) {
+  const bool saved_pretenure = FLAG_pretenure;
+  FLAG_pretenure = true;
+  Heap* heap = Isolate::Current()->heap();
+  const Class& cls =
+      Class::Handle(Type::Handle(Type::ObjectType()).type_class());
+  EXPECT(!cls.is_pretenured());
+  const intptr_t kCount = 2000;
+  // Start sampling with the next allocation.
+  heap->CollectGarbage(Heap::kNew);
+  // Instances which die young do not get their class pretenured. Each
+  // allocation leaves a handle behind, release them with their scope.
+  {
+    HANDLESCOPE();
+    for (intptr_t i = 0; i < kCount; i++) {
+      Instance::New(cls);
+    }
+  }
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(!cls.is_pretenured());
+  // Instances which all survive do.
+  Instance& instance = Instance::Handle();
+  const Array& retained = Array::Handle(Array::New(kCount, Heap::kOld));
+  for (intptr_t i = 0; i < kCount; i++) {
+    instance = Instance::New(cls);
+    retained.SetAt(i, instance);
+  }
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(cls.is_pretenured());
+  instance ^= retained.At(0);
+  EXPECT(!instance.IsNull());
+  EXPECT(heap->Verify());
+  FLAG_pretenure = saved_pretenure;
+}
+
+
+TEST_CASE(PretenuredAllocationStub) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  var f;\n"
+      "}\n"
+      "class PretenuringTest {\n"
+      "  static testMain() {\n"
+      "    var list = new List(2000);\n"
+      "    for (var i = 0; i < list.length; i++) {\n"
+      "      list[i] = new A();\n"
+      "    }\n"
+      "    return list;\n"
+      "  }\n"
+      "}\n";
+  const bool saved_pretenure = FLAG_pretenure;
+  FLAG_pretenure = true;
+  Heap* heap = Isolate::Current()->heap();
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Array& list = Array::Handle();
+  Instance& instance = Instance::Handle();
+  Class& cls = Class::Handle();
+  // The instances all survive, their class is pretenured once the scavenge
+  // samples them.
+  for (intptr_t i = 0; (i < 3) && (cls.IsNull() || !cls.is_pretenured()); i++) {
+    Dart_Handle result = Dart_InvokeStatic(lib,
+                                           Dart_NewString("PretenuringTest"),
+                                           Dart_NewString("testMain"),
+                                           0,
+                                           NULL);
+    EXPECT(Dart_IsValid(result));
+    list ^= Api::UnwrapHandle(result);
+    instance ^= list.At(0);
+    EXPECT(instance.raw()->IsNewObject());
+    cls = instance.clazz();
+    heap->CollectGarbage(Heap::kNew);
+  }
+  EXPECT(cls.is_pretenured());
+  // The allocation stub now allocates them in old space, mostly without
+  // calling into the runtime.
+  Dart_Handle result = Dart_InvokeStatic(lib,
+                                         Dart_NewString("PretenuringTest"),
+                                         Dart_NewString("testMain"),
+                                         0,
+                                         NULL);
+  EXPECT(Dart_IsValid(result));
+  list ^= Api::UnwrapHandle(result);
+  for (intptr_t i = 0; i < list.Length(); i++) {
+    instance ^= list.At(i);
+    EXPECT(instance.raw()->IsOldObject());
+    EXPECT_EQ(cls.raw(), instance.clazz());
+  }
+  // The unused part of the allocation buffer keeps old space walkable.
+  EXPECT(heap->Verify());
+  heap->CollectGarbage(Heap::kOld);
+  heap->CompleteSweeping();
+  EXPECT(heap->Verify());
+  instance ^= list.At(list.Length() - 1);
+  EXPECT_EQ(cls.raw(), instance.clazz());
+  FLAG_pretenure = saved_pretenure;
+}
+
+
+TEST_CASE(Compaction) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // Fill several pages with arrays and only keep every 16th of them alive.
+  const intptr_t kNumArrays = 4096;
+  const intptr_t kArrayLength = 64;
+  const intptr_t kStride = 16;
+  const Array& retained =
+      Array::Handle(Array::New(kNumArrays / kStride, Heap::kOld));
+  {
+    // Each allocation leaves a handle behind, release them with their scope.
+    HANDLESCOPE();
+    Array& array = Array::Handle();
+    for (intptr_t i = 0; i < kNumArrays; i++) {
+      array = Array::New(kArrayLength, Heap::kOld);
+      array.SetAt(0, Smi::Handle(Smi::New(i)));
+      if ((i % kStride) == 0) {
+        retained.SetAt(i / kStride, array);
+      }
+    }
+  }
+  Array& array = Array::Handle();
+  intptr_t capacity_before = heap->Capacity(Heap::kOld);
+  heap->CompactOldSpace();
+  EXPECT(heap->Capacity(Heap::kOld) < capacity_before);
+  Smi& smi = Smi::Handle();
+  for (intptr_t i = 0; i < kNumArrays / kStride; i++) {
+    array ^= retained.At(i);
+    EXPECT_EQ(kArrayLength, array.Length());
+    smi ^= array.At(0);
+    EXPECT_EQ(i * kStride, smi.Value());
+  }
+  EXPECT(heap->Verify());
+}
+
+
+TEST_CASE(LazySweep) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const bool saved_lazy_sweep = FLAG_lazy_sweep;
+  FLAG_lazy_sweep = true;
+  // Fill several pages with arrays and only keep every other one alive.
+  const intptr_t kNumArrays = 4096;
+  const intptr_t kArrayLength = 64;
+  const intptr_t kStride = 2;
+  const Array& retained =
+      Array::Handle(Array::New(kNumArrays / kStride, Heap::kOld));
+  {
+    // Each allocation leaves a handle behind, release them with their scope.
+    HANDLESCOPE();
+    Array& array = Array::Handle();
+    for (intptr_t i = 0; i < kNumArrays; i++) {
+      array = Array::New(kArrayLength, Heap::kOld);
+      array.SetAt(0, Smi::Handle(Smi::New(i)));
+      if ((i % kStride) == 0) {
+        retained.SetAt(i / kStride, array);
+      }
+    }
+  }
+  Array& array = Array::Handle();
+  heap->CollectGarbage(Heap::kOld);
+  // The pages but the tail page are left to the allocator.
+  intptr_t unswept = heap->Unswept(Heap::kOld);
+  EXPECT(unswept > 0);
+  EXPECT(heap->InUse(Heap::kOld) >= unswept);
+  for (intptr_t i = 0;
+       (i < kNumArrays) && (heap->Unswept(Heap::kOld) == unswept);
+       i++) {
+    array = Array::New(kArrayLength, Heap::kOld);
+  }
+  EXPECT(heap->Unswept(Heap::kOld) < unswept);
+  heap->CompleteSweeping();
+  EXPECT_EQ(0, heap->Unswept(Heap::kOld));
+  EXPECT(heap->Verify());
+  EXPECT(heap->SweepTime(Heap::kOld) >= 0);
+  Smi& smi = Smi::Handle();
+  for (intptr_t i = 0; i < kNumArrays / kStride; i++) {
+    array ^= retained.At(i);
+    EXPECT_EQ(kArrayLength, array.Length());
+    smi ^= array.At(0);
+    EXPECT_EQ(i * kStride, smi.Value());
+  }
+  FLAG_lazy_sweep = saved_lazy_sweep;
+}
+
+
+TEST_CASE(LargeObjectSpace) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // Arrays of this length are too large for a regular page.
+  const intptr_t kLength = (128 * KB) / kWordSize;
+  const Array& retained = Array::Handle(Array::New(kLength, Heap::kOld));
+  retained.SetAt(kLength - 1, Smi::Handle(Smi::New(7)));
+  heap->CollectGarbage(Heap::kOld);
+  intptr_t capacity = heap->Capacity(Heap::kOld);
+  {
+    HANDLESCOPE();
+    for (intptr_t i = 0; i < 8; i++) {
+      Array::New(kLength, Heap::kOld);
+    }
+  }
+  EXPECT(heap->Capacity(Heap::kOld) >= capacity + 8 * kLength * kWordSize);
+  // The memory of the dead arrays is released.
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(heap->Capacity(Heap::kOld) <= capacity);
+  EXPECT_EQ(kLength, retained.Length());
+  EXPECT_EQ(7, Smi::CheckedHandle(retained.At(kLength - 1)).Value());
+  heap->CompleteSweeping();
+  EXPECT(heap->Verify());
+}
+
+
+static intptr_t CountDirtyCards(HeapPage* page) {
+  intptr_t count = 0;
+  for (intptr_t i = 0; i < page->card_count(); i++) {
+    if (page->card_table()[i] != 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+
+TEST_CASE(CardMarking) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // Arrays of this length are too large for a regular page.
+  const intptr_t kLength = (128 * KB) / kWordSize;
+  const Array& array = Array::Handle(Array::New(kLength, Heap::kOld));
+  HeapPage* page = HeapPage::Of(array.raw());
+  EXPECT(page->card_table() != NULL);
+  EXPECT_EQ(0, CountDirtyCards(page));
+  // Store a new object into the last slot and dirty its card like the write
+  // barrier does.
+  const String& element = String::Handle(String::New("element"));
+  EXPECT(element.raw()->IsNewObject());
+  array.SetAt(kLength - 1, element);
+  uword slot = RawObject::ToAddr(array.raw()) + Array::data_offset() +
+      ((kLength - 1) * kWordSize);
+  page->RememberCard(reinterpret_cast<RawObject**>(slot));
+  EXPECT_EQ(1, CountDirtyCards(page));
+  // The card is visited by the scavenge and stays dirty while the element is
+  // still in new space.
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(!isolate->store_buffer()->Contains(
+      reinterpret_cast<uword>(array.raw())));
+  EXPECT(array.At(kLength - 1) == element.raw());
+  EXPECT(String::CheckedHandle(array.At(kLength - 1)).Equals("element"));
+  EXPECT_EQ(1, CountDirtyCards(page));
+  // Cards no longer pointing into new space are cleared.
+  array.SetAt(kLength - 1, Object::Handle());
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_EQ(0, CountDirtyCards(page));
+  EXPECT(heap->Verify());
+}
+
+
+TEST_CASE(ConcurrentMark) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // Build a chain of old arrays which is only reachable through 'root'.
+  const intptr_t kChainLength = 1000;
+  const Array& root = Array::Handle(Array::New(1, Heap::kOld));
+  Array& array = Array::Handle();
+  Array& previous = Array::Handle();
+  for (intptr_t i = 0; i < kChainLength; i++) {
+    array = Array::New(2, Heap::kOld);
+    array.SetAt(0, Smi::Handle(Smi::New(i)));
+    if (i == 0) {
+      root.SetAt(0, array);
+    } else {
+      previous.SetAt(1, array);
+    }
+    previous = array.raw();
+  }
+  array ^= Object::null();
+  previous ^= Object::null();
+
+  heap->StartConcurrentMarking();
+  EXPECT(heap->IsMarking());
+  // Move the chain to an array allocated while marking. The reference
+  // overwritten in 'root' is logged by the write barrier.
+  const Array& other = Array::Handle(Array::New(1, Heap::kOld));
+  array ^= root.At(0);
+  other.SetAt(0, array);
+  array ^= Object::null();
+  root.SetAt(0, Object::Handle());
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(!heap->IsMarking());
+
+  Smi& smi = Smi::Handle();
+  array ^= other.At(0);
+  for (intptr_t i = 0; i < kChainLength; i++) {
+    smi ^= array.At(0);
+    EXPECT_EQ(i, smi.Value());
+    array ^= array.At(1);
+  }
+  EXPECT(array.IsNull());
+  heap->CompleteSweeping();
+  EXPECT(heap->Verify());
+
+  // Later marking cycles reuse the helper thread.
+  ThreadPool* thread_pool = Dart::thread_pool();
+  WaitForIdleThreads(thread_pool);
+  const intptr_t thread_count = thread_pool->thread_count();
+  for (intptr_t i = 0; i < 5; i++) {
+    heap->StartConcurrentMarking();
+    heap->CollectGarbage(Heap::kOld);
+    WaitForIdleThreads(thread_pool);
+  }
+  EXPECT_EQ(thread_count, thread_pool->thread_count());
+}
+
+
+TEST_CASE(OutOfMemoryReserve) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  heap->CollectGarbage(Heap::kOld);
+  intptr_t limit = heap->OldSpaceLimit();
+  heap->SetOldSpaceLimit(heap->Capacity(Heap::kOld) + 1 * MB);
+  const intptr_t kLength = (64 * KB) / kWordSize;
+  const Array& retained = Array::Handle(Array::New(64, Heap::kOld));
+  // Allocation beyond the limit is served from the reserve instead of
+  // unwinding from Object::Allocate.
+  {
+    HANDLESCOPE();
+    intptr_t i = 0;
+    while (!heap->has_pending_out_of_memory()) {
+      ASSERT(i < retained.Length());
+      retained.SetAt(i++, Array::Handle(Array::New(kLength, Heap::kOld)));
+    }
+  }
+  EXPECT(heap->is_out_of_memory());
+  heap->clear_pending_out_of_memory();
+  // The limit is restored once the garbage is collected.
+  for (intptr_t i = 0; i < retained.Length(); i++) {
+    retained.SetAt(i, Object::Handle());
+  }
+  heap->CollectAllGarbage();
+  EXPECT(!heap->is_out_of_memory());
+  heap->SetOldSpaceLimit(limit);
+}
+
+
+// Allocates short-lived arrays while a window of recent arrays survives,
+// so that most of the time is spent scavenging and promoting. Returns the
+// time taken in microseconds.
+static int64_t RunScavengeBenchmark() {
+  const intptr_t kWindowLength = 16 * KB;
+  const intptr_t kIterations = 500000;
+  int64_t start = OS::GetCurrentTimeMicros();
+  const Array& window = Array::Handle(Array::New(kWindowLength));
+  Array& array = Array::Handle();
+  for (intptr_t i = 0; i < kIterations; i++) {
+    array = Array::New(4);
+    array.SetAt(0, Smi::Handle(Smi::New(i)));
+    window.SetAt(i % kWindowLength, array);
+  }
+  int64_t elapsed = OS::GetCurrentTimeMicros() - start;
+  Smi& smi = Smi::Handle();
+  for (intptr_t i = kIterations - kWindowLength; i < kIterations; i++) {
+    array ^= window.At(i % kWindowLength);
+    smi ^= array.At(0);
+    EXPECT_EQ(i, smi.Value());
+  }
+  Heap* heap = Isolate::Current()->heap();
+  heap->CompleteSweeping();
+  EXPECT(heap->Verify());
+  return elapsed;
+}
+
+
+// Compares the scavenge-heavy benchmark with and without huge pages. Each run
+// uses a new isolate, the heap regions are reserved when it is created.
+UNIT_TEST_CASE(ScavengeHugePagesBenchmark) {
+  const bool saved_huge_pages = FLAG_heap_huge_pages;
+  int64_t elapsed[2];
+  for (intptr_t i = 0; i < 2; i++) {
+    FLAG_heap_huge_pages = (i == 1);
+    TestIsolateScope test_isolate;
+    Zone zone;
+    HandleScope handle_scope;
+    elapsed[i] = RunScavengeBenchmark();
+  }
+  FLAG_heap_huge_pages = saved_huge_pages;
+  OS::Print("ScavengeHugePagesBenchmark: %lld us, with huge pages %lld us\n",
+            elapsed[0], elapsed[1]);
+}
+
+}  // namespace dart
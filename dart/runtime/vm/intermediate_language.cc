@@ -0,0 +1,265 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/intermediate_language.h"
+
+#include "vm/os.h"
+#include "vm/scopes.h"
+
+namespace dart {
+
+#define DEFINE_ACCEPT(type)                                                    \
+  void type##Instr::Accept(FlowGraphVisitor* visitor) {                        \
+    visitor->Visit##type(this);                                                \
+  }
+FOR_EACH_INSTRUCTION(DEFINE_ACCEPT)
+#undef DEFINE_ACCEPT
+
+
+bool Value::IsConstant() const {
+  return definition_->IsConstant();
+}
+
+
+const Object& Value::BoundConstant() const {
+  ASSERT(IsConstant());
+  return definition_->AsConstant()->value();
+}
+
+
+Environment::Environment(const GrowableArray<Definition*>& stack,
+                         LocalScope* scope)
+    : locals_(), stack_(stack.length()), scope_(scope) {
+  ASSERT(scope != NULL);
+  for (intptr_t i = 0; i < stack.length(); i++) {
+    stack_.Add(new Value(stack[i]));
+  }
+}
+
+
+bool Environment::IsLive(const LocalVariable& variable) const {
+  for (LocalScope* scope = scope_; scope != NULL; scope = scope->parent()) {
+    if (variable.owner() == scope) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void Instruction::InsertAfter(Instruction* instr) {
+  ASSERT((instr->previous() == NULL) && (instr->next() == NULL));
+  instr->set_previous(this);
+  instr->set_next(next_);
+  if (next_ != NULL) {
+    next_->set_previous(instr);
+  }
+  next_ = instr;
+}
+
+
+void Instruction::RemoveFromGraph() {
+  ASSERT(!IsBlockEntry());
+  ASSERT(previous_ != NULL);
+  previous_->set_next(next_);
+  if (next_ != NULL) {
+    next_->set_previous(previous_);
+  }
+  previous_ = NULL;
+  next_ = NULL;
+}
+
+
+void Instruction::ReplaceWith(Instruction* instr) {
+  ASSERT(!IsBlockEntry());
+  ASSERT(previous_ != NULL);
+  Instruction* previous = previous_;
+  RemoveFromGraph();
+  previous->InsertAfter(instr);
+}
+
+
+Definition* Definition::Resolve() {
+  Definition* definition = this;
+  while (definition->replacement() != NULL) {
+    definition = definition->replacement();
+  }
+  return definition;
+}
+
+
+intptr_t BlockEntryInstr::IndexOfPredecessor(
+    BlockEntryInstr* predecessor) const {
+  for (intptr_t i = 0; i < PredecessorCount(); i++) {
+    if (PredecessorAt(i) == predecessor) {
+      return i;
+    }
+  }
+  UNREACHABLE();
+  return -1;
+}
+
+
+void BlockEntryInstr::DiscoverBlocks(
+    GrowableArray<BlockEntryInstr*>* preorder,
+    GrowableArray<BlockEntryInstr*>* postorder) {
+  ASSERT(preorder_number_ == -1);
+  ASSERT(last_instruction_ != NULL);
+  preorder_number_ = preorder->length();
+  preorder->Add(this);
+  for (intptr_t i = 0; i < last_instruction_->SuccessorCount(); i++) {
+    BlockEntryInstr* successor = last_instruction_->SuccessorAt(i);
+    if (successor->preorder_number() == -1) {
+      successor->DiscoverBlocks(preorder, postorder);
+    }
+  }
+  postorder_number_ = postorder->length();
+  postorder->Add(this);
+}
+
+
+void BlockEntryInstr::ClearNumbering() {
+  preorder_number_ = -1;
+  postorder_number_ = -1;
+  dominator_ = NULL;
+  dominated_blocks_.Clear();
+}
+
+
+void JoinEntryInstr::AddPhi(PhiInstr* phi) {
+  if (phis_ == NULL) {
+    phis_ = new ZoneGrowableArray<PhiInstr*>(2);
+  }
+  phis_->Add(phi);
+}
+
+
+PhiInstr::PhiInstr(JoinEntryInstr* block, intptr_t variable_index)
+    : block_(block),
+      variable_index_(variable_index),
+      inputs_(block->PredecessorCount()) {
+  for (intptr_t i = 0; i < block->PredecessorCount(); i++) {
+    inputs_.Add(NULL);
+  }
+}
+
+
+BlockEntryInstr* GotoInstr::SuccessorAt(intptr_t index) const {
+  ASSERT(index == 0);
+  return successor_;
+}
+
+
+BlockEntryInstr* BranchInstr::SuccessorAt(intptr_t index) const {
+  ASSERT((index == 0) || (index == 1));
+  return (index == 0) ? true_successor_ : false_successor_;
+}
+
+
+static void PrintValue(Value* value) {
+  if (value == NULL) {
+    OS::Print("_");
+  } else if (value->IsConstant()) {
+    OS::Print("#%s", value->BoundConstant().ToCString());
+  } else {
+    OS::Print("v%d", value->definition()->ssa_temp_index());
+  }
+}
+
+
+void Instruction::Print() const {
+  if (IsDefinition()) {
+    const Definition* definition = static_cast<const Definition*>(this);
+    if (definition->HasSSATemp()) {
+      OS::Print("v%d <- ", definition->ssa_temp_index());
+    }
+  }
+  OS::Print("%s(", DebugName());
+  PrintOperands();
+  OS::Print(")");
+  if (env_ != NULL) {
+    OS::Print(" deopt %d {", deopt_id_);
+    for (intptr_t i = 0; i < env_->StackCount(); i++) {
+      if (i > 0) OS::Print(", ");
+      PrintValue(env_->StackAt(i));
+    }
+    OS::Print("}");
+  }
+}
+
+
+void Instruction::PrintOperands() const {
+  for (intptr_t i = 0; i < InputCount(); i++) {
+    if (i > 0) OS::Print(", ");
+    PrintValue(InputAt(i));
+  }
+}
+
+
+void ParameterInstr::PrintOperands() const {
+  OS::Print("%d", index_);
+}
+
+
+void ConstantInstr::PrintOperands() const {
+  OS::Print("#%s", value_.ToCString());
+}
+
+
+void InstanceCallInstr::PrintOperands() const {
+  OS::Print("%s", function_name_.ToCString());
+  for (intptr_t i = 0; i < ArgumentCount(); i++) {
+    OS::Print(", ");
+    PrintValue(ArgumentAt(i));
+  }
+  if (ic_data().NumberOfChecks() > 0) {
+    OS::Print(" IC[%d]", ic_data().NumberOfChecks());
+  }
+}
+
+
+void StaticCallInstr::PrintOperands() const {
+  OS::Print("%s", String::Handle(function_.name()).ToCString());
+  for (intptr_t i = 0; i < ArgumentCount(); i++) {
+    OS::Print(", ");
+    PrintValue(ArgumentAt(i));
+  }
+}
+
+
+void EqualityCompareInstr::PrintOperands() const {
+  PrintValue(left_);
+  OS::Print(" %s ", Token::Str(kind_));
+  PrintValue(right_);
+}
+
+
+void StrictCompareInstr::PrintOperands() const {
+  PrintValue(left_);
+  OS::Print(" %s ", Token::Str(kind_));
+  PrintValue(right_);
+}
+
+
+void BinarySmiOpInstr::PrintOperands() const {
+  PrintValue(left_);
+  OS::Print(" %s ", Token::Str(op_kind_));
+  PrintValue(right_);
+}
+
+
+void BinaryDoubleOpInstr::PrintOperands() const {
+  PrintValue(left_);
+  OS::Print(" %s ", Token::Str(op_kind_));
+  PrintValue(right_);
+}
+
+
+void RelationalOpInstr::PrintOperands() const {
+  PrintValue(left_);
+  OS::Print(" %s ", Token::Str(kind_));
+  PrintValue(right_);
+}
+
+}  // namespace dart
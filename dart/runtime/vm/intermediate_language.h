@@ -0,0 +1,1162 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_INTERMEDIATE_LANGUAGE_H_
+#define VM_INTERMEDIATE_LANGUAGE_H_
+
+#include "vm/allocation.h"
+#include "vm/ast.h"
+#include "vm/growable_array.h"
+#include "vm/ic_data.h"
+#include "vm/locations.h"
+#include "vm/object.h"
+#include "vm/token.h"
+
+namespace dart {
+
+// Forward declarations.
+class BlockEntryInstr;
+class Definition;
+class Environment;
+class Instruction;
+class Value;
+
+// The intermediate language (IL) of the optimizing compiler is a flow graph
+// of basic blocks in SSA form. Every block starts with a block entry, is
+// followed by a doubly linked list of instructions and ends with a control
+// instruction (goto, branch or return). Instructions producing a value are
+// definitions; their uses are Value objects referring to the definition.
+//
+// (type)
+#define FOR_EACH_INSTRUCTION(M)                                                \
+  M(GraphEntry)                                                                \
+  M(TargetEntry)                                                               \
+  M(JoinEntry)                                                                 \
+  M(Phi)                                                                       \
+  M(Parameter)                                                                 \
+  M(Constant)                                                                  \
+  M(LoadLocal)                                                                 \
+  M(StoreLocal)                                                                \
+  M(Goto)                                                                      \
+  M(Branch)                                                                    \
+  M(Return)                                                                    \
+  M(InstanceCall)                                                              \
+  M(StaticCall)                                                                \
+  M(EqualityCompare)                                                           \
+  M(StrictCompare)                                                             \
+  M(BooleanNegate)                                                             \
+  M(LoadInstanceField)                                                         \
+  M(StoreInstanceField)                                                        \
+  M(LoadStaticField)                                                           \
+  M(StoreStaticField)                                                          \
+  M(CheckClass)                                                                \
+  M(TestClass)                                                                 \
+  M(BinarySmiOp)                                                               \
+  M(BinaryDoubleOp)                                                            \
+  M(RelationalOp)                                                              \
+  M(LoadIndexed)                                                               \
+  M(StoreIndexed)                                                              \
+
+
+#define FORWARD_DECLARATION(type) class type##Instr;
+FOR_EACH_INSTRUCTION(FORWARD_DECLARATION)
+#undef FORWARD_DECLARATION
+
+
+// Abstract class to implement a visitor of the instructions of a flow graph,
+// e.g., the flow graph compiler.
+class FlowGraphVisitor {
+ public:
+  FlowGraphVisitor() { }
+  virtual ~FlowGraphVisitor() { }
+
+#define DECLARE_VISIT(type)                                                    \
+  virtual void Visit##type(type##Instr* instr) { }
+FOR_EACH_INSTRUCTION(DECLARE_VISIT)
+#undef DECLARE_VISIT
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(FlowGraphVisitor);
+};
+
+
+#define DECLARE_INSTRUCTION(type)                                              \
+  virtual void Accept(FlowGraphVisitor* visitor);                              \
+  virtual bool Is##type() const { return true; }                               \
+  virtual type##Instr* As##type() { return this; }                             \
+  virtual const char* DebugName() const { return #type; }
+
+
+// A use of a definition, either as the input of an instruction or as a slot
+// of a deoptimization environment.
+class Value : public ZoneAllocated {
+ public:
+  explicit Value(Definition* definition) : definition_(definition) {
+    ASSERT(definition != NULL);
+  }
+
+  Definition* definition() const { return definition_; }
+  void set_definition(Definition* definition) {
+    ASSERT(definition != NULL);
+    definition_ = definition;
+  }
+
+  // Returns true if the value is a compile time constant.
+  bool IsConstant() const;
+  const Object& BoundConstant() const;
+
+ private:
+  Definition* definition_;
+
+  DISALLOW_COPY_AND_ASSIGN(Value);
+};
+
+
+// The state of the unoptimized frame at a deoptimization point: the values of
+// the local variables of the function, in the order of the flow graph's
+// variables, and the values on the expression stack of the unoptimized code,
+// deepest element first. Only the variables of 'scope' and of its parents are
+// live in the unoptimized frame; variables of sibling scopes may share their
+// frame slots.
+class Environment : public ZoneAllocated {
+ public:
+  Environment(const GrowableArray<Definition*>& stack, LocalScope* scope);
+
+  LocalScope* scope() const { return scope_; }
+
+  // Returns true if 'variable' is allocated in the unoptimized frame at this
+  // point of the function.
+  bool IsLive(const LocalVariable& variable) const;
+
+  intptr_t LocalCount() const { return locals_.length(); }
+  Value* LocalAt(intptr_t index) const { return locals_[index]; }
+  void AddLocal(Value* value) { locals_.Add(value); }
+
+  intptr_t StackCount() const { return stack_.length(); }
+  Value* StackAt(intptr_t index) const { return stack_[index]; }
+
+ private:
+  GrowableArray<Value*> locals_;
+  GrowableArray<Value*> stack_;
+  LocalScope* scope_;
+
+  DISALLOW_COPY_AND_ASSIGN(Environment);
+};
+
+
+class Instruction : public ZoneAllocated {
+ public:
+  Instruction()
+      : previous_(NULL),
+        next_(NULL),
+        token_index_(0),
+        deopt_id_(AstNode::kInvalidId),
+        env_(NULL),
+        lifetime_position_(-1) { }
+
+  Instruction* previous() const { return previous_; }
+  void set_previous(Instruction* instr) { previous_ = instr; }
+  Instruction* next() const { return next_; }
+  void set_next(Instruction* instr) { next_ = instr; }
+
+  // Links 'instr' into the instruction list right after this instruction.
+  void InsertAfter(Instruction* instr);
+  // Unlinks this instruction from its instruction list.
+  void RemoveFromGraph();
+  // Links 'instr' into the instruction list in place of this instruction.
+  void ReplaceWith(Instruction* instr);
+
+  virtual intptr_t InputCount() const = 0;
+  virtual Value* InputAt(intptr_t index) const = 0;
+
+  // Control instructions end a block and have successors.
+  virtual intptr_t SuccessorCount() const { return 0; }
+  virtual BlockEntryInstr* SuccessorAt(intptr_t index) const {
+    UNREACHABLE();
+    return NULL;
+  }
+
+  // Calls, including the calls of stubs which may allocate, preserve no
+  // registers.
+  virtual bool HasCall() const { return false; }
+
+  virtual bool IsBlockEntry() const { return false; }
+  virtual BlockEntryInstr* AsBlockEntry() { return NULL; }
+  virtual bool IsDefinition() const { return false; }
+  virtual Definition* AsDefinition() { return NULL; }
+
+#define INSTRUCTION_TYPE_CHECK(type)                                           \
+  virtual bool Is##type() const { return false; }                              \
+  virtual type##Instr* As##type() { return NULL; }
+FOR_EACH_INSTRUCTION(INSTRUCTION_TYPE_CHECK)
+#undef INSTRUCTION_TYPE_CHECK
+
+  virtual void Accept(FlowGraphVisitor* visitor) = 0;
+  virtual const char* DebugName() const = 0;
+
+  // Prints the instruction on one line, without a trailing new line.
+  void Print() const;
+
+  intptr_t token_index() const { return token_index_; }
+  void set_token_index(intptr_t value) { token_index_ = value; }
+
+  // Instructions which may deoptimize have the id of the AST node whose
+  // deoptimization point in unoptimized code continues the execution, and the
+  // environment describing the unoptimized frame at that point.
+  bool CanDeoptimize() const { return env_ != NULL; }
+  intptr_t deopt_id() const { return deopt_id_; }
+  Environment* env() const { return env_; }
+  void SetDeoptimizationTarget(intptr_t deopt_id, Environment* env) {
+    ASSERT(deopt_id != AstNode::kInvalidId);
+    ASSERT(env != NULL);
+    deopt_id_ = deopt_id;
+    env_ = env;
+  }
+  void CopyDeoptimizationTarget(const Instruction& other) {
+    token_index_ = other.token_index_;
+    deopt_id_ = other.deopt_id_;
+    env_ = other.env_;
+  }
+
+  // The position of the instruction in the linear order of the register
+  // allocator.
+  intptr_t lifetime_position() const { return lifetime_position_; }
+  void set_lifetime_position(intptr_t position) {
+    lifetime_position_ = position;
+  }
+
+ protected:
+  virtual void PrintOperands() const;
+
+ private:
+  Instruction* previous_;
+  Instruction* next_;
+  intptr_t token_index_;
+  intptr_t deopt_id_;
+  Environment* env_;
+  intptr_t lifetime_position_;
+
+  DISALLOW_COPY_AND_ASSIGN(Instruction);
+};
+
+
+// An instruction producing a value.
+class Definition : public Instruction {
+ public:
+  Definition()
+      : ssa_temp_index_(-1),
+        use_count_(0),
+        replacement_(NULL),
+        location_() { }
+
+  virtual bool IsDefinition() const { return true; }
+  virtual Definition* AsDefinition() { return this; }
+
+  bool HasSSATemp() const { return ssa_temp_index_ >= 0; }
+  intptr_t ssa_temp_index() const { return ssa_temp_index_; }
+  void set_ssa_temp_index(intptr_t index) { ssa_temp_index_ = index; }
+
+  intptr_t use_count() const { return use_count_; }
+  void set_use_count(intptr_t count) { use_count_ = count; }
+
+  // The register or spill slot holding the value, assigned by the register
+  // allocator. Constants have no location.
+  const Location& location() const { return location_; }
+  void set_location(const Location& location) { location_ = location; }
+
+  // A definition removed from the graph while it is rewritten (e.g., a load
+  // of a local variable during SSA construction) forwards its uses to its
+  // replacement.
+  Definition* replacement() const { return replacement_; }
+  void set_replacement(Definition* definition) { replacement_ = definition; }
+
+  // Follows the chain of replacements.
+  Definition* Resolve();
+
+ private:
+  intptr_t ssa_temp_index_;
+  intptr_t use_count_;
+  Definition* replacement_;
+  Location location_;
+
+  DISALLOW_COPY_AND_ASSIGN(Definition);
+};
+
+
+class BlockEntryInstr : public Instruction {
+ public:
+  BlockEntryInstr()
+      : preorder_number_(-1),
+        postorder_number_(-1),
+        dominator_(NULL),
+        dominated_blocks_(),
+        last_instruction_(NULL) { }
+
+  virtual bool IsBlockEntry() const { return true; }
+  virtual BlockEntryInstr* AsBlockEntry() { return this; }
+
+  virtual intptr_t PredecessorCount() const = 0;
+  virtual BlockEntryInstr* PredecessorAt(intptr_t index) const = 0;
+  virtual void AddPredecessor(BlockEntryInstr* predecessor) = 0;
+  // Keeps the index of the predecessor, and thus the phi inputs, unchanged.
+  virtual void ReplacePredecessor(BlockEntryInstr* old_predecessor,
+                                  BlockEntryInstr* new_predecessor) = 0;
+  intptr_t IndexOfPredecessor(BlockEntryInstr* predecessor) const;
+
+  virtual intptr_t InputCount() const { return 0; }
+  virtual Value* InputAt(intptr_t index) const {
+    UNREACHABLE();
+    return NULL;
+  }
+
+  intptr_t preorder_number() const { return preorder_number_; }
+  intptr_t postorder_number() const { return postorder_number_; }
+
+  BlockEntryInstr* dominator() const { return dominator_; }
+  void set_dominator(BlockEntryInstr* block) { dominator_ = block; }
+  const GrowableArray<BlockEntryInstr*>& dominated_blocks() const {
+    return dominated_blocks_;
+  }
+  void AddDominatedBlock(BlockEntryInstr* block) {
+    dominated_blocks_.Add(block);
+  }
+
+  // The goto, branch or return instruction ending the block.
+  Instruction* last_instruction() const { return last_instruction_; }
+  void set_last_instruction(Instruction* instr) { last_instruction_ = instr; }
+
+  // Numbers this block and all blocks reachable from it in depth-first
+  // order, appending them to 'preorder' and 'postorder'.
+  void DiscoverBlocks(GrowableArray<BlockEntryInstr*>* preorder,
+                      GrowableArray<BlockEntryInstr*>* postorder);
+  // Resets the numbering and dominator information before the blocks are
+  // discovered again.
+  void ClearNumbering();
+
+ private:
+  intptr_t preorder_number_;
+  intptr_t postorder_number_;
+  BlockEntryInstr* dominator_;
+  GrowableArray<BlockEntryInstr*> dominated_blocks_;
+  Instruction* last_instruction_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockEntryInstr);
+};
+
+
+// The first block of the graph. Its instructions define the incoming
+// parameters and the initial values of the local variables.
+class GraphEntryInstr : public BlockEntryInstr {
+ public:
+  GraphEntryInstr() { }
+
+  DECLARE_INSTRUCTION(GraphEntry)
+
+  virtual intptr_t PredecessorCount() const { return 0; }
+  virtual BlockEntryInstr* PredecessorAt(intptr_t index) const {
+    UNREACHABLE();
+    return NULL;
+  }
+  virtual void AddPredecessor(BlockEntryInstr* predecessor) { UNREACHABLE(); }
+  virtual void ReplacePredecessor(BlockEntryInstr* old_predecessor,
+                                  BlockEntryInstr* new_predecessor) {
+    UNREACHABLE();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(GraphEntryInstr);
+};
+
+
+// The target of a branch, with a single predecessor.
+class TargetEntryInstr : public BlockEntryInstr {
+ public:
+  TargetEntryInstr() : predecessor_(NULL) { }
+
+  DECLARE_INSTRUCTION(TargetEntry)
+
+  virtual intptr_t PredecessorCount() const {
+    return (predecessor_ == NULL) ? 0 : 1;
+  }
+  virtual BlockEntryInstr* PredecessorAt(intptr_t index) const {
+    ASSERT((index == 0) && (predecessor_ != NULL));
+    return predecessor_;
+  }
+  virtual void AddPredecessor(BlockEntryInstr* predecessor) {
+    ASSERT(predecessor_ == NULL);
+    predecessor_ = predecessor;
+  }
+  virtual void ReplacePredecessor(BlockEntryInstr* old_predecessor,
+                                  BlockEntryInstr* new_predecessor) {
+    ASSERT(predecessor_ == old_predecessor);
+    predecessor_ = new_predecessor;
+  }
+
+ private:
+  BlockEntryInstr* predecessor_;
+
+  DISALLOW_COPY_AND_ASSIGN(TargetEntryInstr);
+};
+
+
+// A block entered by gotos from one or more predecessors, e.g., a loop header
+// or the join point of an if statement. Only join entries have phis.
+class JoinEntryInstr : public BlockEntryInstr {
+ public:
+  JoinEntryInstr() : predecessors_(2), phis_(NULL) { }
+
+  DECLARE_INSTRUCTION(JoinEntry)
+
+  virtual intptr_t PredecessorCount() const { return predecessors_.length(); }
+  virtual BlockEntryInstr* PredecessorAt(intptr_t index) const {
+    return predecessors_[index];
+  }
+  virtual void AddPredecessor(BlockEntryInstr* predecessor) {
+    predecessors_.Add(predecessor);
+  }
+  virtual void ReplacePredecessor(BlockEntryInstr* old_predecessor,
+                                  BlockEntryInstr* new_predecessor) {
+    predecessors_[IndexOfPredecessor(old_predecessor)] = new_predecessor;
+  }
+
+  ZoneGrowableArray<PhiInstr*>* phis() const { return phis_; }
+  void AddPhi(PhiInstr* phi);
+
+ private:
+  GrowableArray<BlockEntryInstr*> predecessors_;
+  ZoneGrowableArray<PhiInstr*>* phis_;
+
+  DISALLOW_COPY_AND_ASSIGN(JoinEntryInstr);
+};
+
+
+// Merges the values flowing in from the predecessors of a join entry. The
+// inputs are in the order of the block's predecessors. Phis of local variables
+// are inserted during SSA construction; phis of expression values (e.g., of
+// a conditional expression) have no variable.
+class PhiInstr : public Definition {
+ public:
+  static const intptr_t kNoVariable = -1;
+
+  PhiInstr(JoinEntryInstr* block, intptr_t variable_index);
+
+  DECLARE_INSTRUCTION(Phi)
+
+  JoinEntryInstr* block() const { return block_; }
+  intptr_t variable_index() const { return variable_index_; }
+
+  virtual intptr_t InputCount() const { return inputs_.length(); }
+  virtual Value* InputAt(intptr_t index) const { return inputs_[index]; }
+  void SetInputAt(intptr_t index, Value* value) { inputs_[index] = value; }
+
+ private:
+  JoinEntryInstr* block_;
+  const intptr_t variable_index_;
+  GrowableArray<Value*> inputs_;
+
+  DISALLOW_COPY_AND_ASSIGN(PhiInstr);
+};
+
+
+// The incoming value of the parameter at 'index' in the function's scope.
+class ParameterInstr : public Definition {
+ public:
+  explicit ParameterInstr(intptr_t index) : index_(index) { }
+
+  DECLARE_INSTRUCTION(Parameter)
+
+  intptr_t index() const { return index_; }
+
+  virtual intptr_t InputCount() const { return 0; }
+  virtual Value* InputAt(intptr_t index) const {
+    UNREACHABLE();
+    return NULL;
+  }
+
+ protected:
+  virtual void PrintOperands() const;
+
+ private:
+  const intptr_t index_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParameterInstr);
+};
+
+
+class ConstantInstr : public Definition {
+ public:
+  explicit ConstantInstr(const Object& value) : value_(value) {
+    ASSERT(value.IsZoneHandle());
+  }
+
+  DECLARE_INSTRUCTION(Constant)
+
+  const Object& value() const { return value_; }
+
+  virtual intptr_t InputCount() const { return 0; }
+  virtual Value* InputAt(intptr_t index) const {
+    UNREACHABLE();
+    return NULL;
+  }
+
+ protected:
+  virtual void PrintOperands() const;
+
+ private:
+  const Object& value_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConstantInstr);
+};
+
+
+// Loads and stores of local variables only exist while the graph is built;
+// SSA construction replaces them by the reaching definitions.
+class LoadLocalInstr : public Definition {
+ public:
+  LoadLocalInstr(const LocalVariable& local, intptr_t variable_index)
+      : local_(local), variable_index_(variable_index) { }
+
+  DECLARE_INSTRUCTION(LoadLocal)
+
+  const LocalVariable& local() const { return local_; }
+  intptr_t variable_index() const { return variable_index_; }
+
+  virtual intptr_t InputCount() const { return 0; }
+  virtual Value* InputAt(intptr_t index) const {
+    UNREACHABLE();
+    return NULL;
+  }
+
+ private:
+  const LocalVariable& local_;
+  const intptr_t variable_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadLocalInstr);
+};
+
+
+class StoreLocalInstr : public Definition {
+ public:
+  StoreLocalInstr(const LocalVariable& local,
+                  intptr_t variable_index,
+                  Value* value)
+      : local_(local), variable_index_(variable_index), value_(value) { }
+
+  DECLARE_INSTRUCTION(StoreLocal)
+
+  const LocalVariable& local() const { return local_; }
+  intptr_t variable_index() const { return variable_index_; }
+  Value* value() const { return value_; }
+
+  virtual intptr_t InputCount() const { return 1; }
+  virtual Value* InputAt(intptr_t index) const {
+    ASSERT(index == 0);
+    return value_;
+  }
+
+ private:
+  const LocalVariable& local_;
+  const intptr_t variable_index_;
+  Value* value_;
+
+  DISALLOW_COPY_AND_ASSIGN(StoreLocalInstr);
+};
+
+
+class GotoInstr : public Instruction {
+ public:
+  explicit GotoInstr(JoinEntryInstr* successor) : successor_(successor) { }
+
+  DECLARE_INSTRUCTION(Goto)
+
+  JoinEntryInstr* successor() const { return successor_; }
+
+  virtual intptr_t InputCount() const { return 0; }
+  virtual Value* InputAt(intptr_t index) const {
+    UNREACHABLE();
+    return NULL;
+  }
+
+  virtual intptr_t SuccessorCount() const { return 1; }
+  virtual BlockEntryInstr* SuccessorAt(intptr_t index) const;
+
+ private:
+  JoinEntryInstr* successor_;
+
+  DISALLOW_COPY_AND_ASSIGN(GotoInstr);
+};
+
+
+// Continues at the true successor if the value is the true object, otherwise
+// at the false successor.
+class BranchInstr : public Instruction {
+ public:
+  explicit BranchInstr(Value* value)
+      : value_(value), true_successor_(NULL), false_successor_(NULL) { }
+
+  DECLARE_INSTRUCTION(Branch)
+
+  Value* value() const { return value_; }
+
+  TargetEntryInstr* true_successor() const { return true_successor_; }
+  TargetEntryInstr* false_successor() const { return false_successor_; }
+  void SetSuccessors(TargetEntryInstr* true_successor,
+                     TargetEntryInstr* false_successor) {
+    true_successor_ = true_successor;
+    false_successor_ = false_successor;
+  }
+
+  virtual intptr_t InputCount() const { return 1; }
+  virtual Value* InputAt(intptr_t index) const {
+    ASSERT(index == 0);
+    return value_;
+  }
+
+  virtual intptr_t SuccessorCount() const { return 2; }
+  virtual BlockEntryInstr* SuccessorAt(intptr_t index) const;
+
+ private:
+  Value* value_;
+  TargetEntryInstr* true_successor_;
+  TargetEntryInstr* false_successor_;
+
+  DISALLOW_COPY_AND_ASSIGN(BranchInstr);
+};
+
+
+class ReturnInstr : public Instruction {
+ public:
+  ReturnInstr(intptr_t token_index, Value* value) : value_(value) {
+    set_token_index(token_index);
+  }
+
+  DECLARE_INSTRUCTION(Return)
+
+  Value* value() const { return value_; }
+
+  virtual intptr_t InputCount() const { return 1; }
+  virtual Value* InputAt(intptr_t index) const {
+    ASSERT(index == 0);
+    return value_;
+  }
+
+ private:
+  Value* value_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReturnInstr);
+};
+
+
+// A dynamically dispatched call. The token kind identifies calls of operators,
+// getters and setters, which may be specialized using the type feedback
+// collected in the call's ICData; it is Token::kILLEGAL for other calls.
+class InstanceCallInstr : public Definition {
+ public:
+  InstanceCallInstr(intptr_t token_index,
+                    const String& function_name,
+                    Token::Kind token_kind,
+                    ZoneGrowableArray<Value*>* arguments,
+                    const Array& argument_names,
+                    const ICData* ic_data)
+      : function_name_(function_name),
+        token_kind_(token_kind),
+        arguments_(arguments),
+        argument_names_(argument_names),
+        ic_data_(ic_data) {
+    ASSERT(function_name.IsZoneHandle());
+    ASSERT(argument_names.IsZoneHandle());
+    ASSERT(ic_data != NULL);
+    set_token_index(token_index);
+  }
+
+  DECLARE_INSTRUCTION(InstanceCall)
+
+  virtual bool HasCall() const { return true; }
+
+  const String& function_name() const { return function_name_; }
+  Token::Kind token_kind() const { return token_kind_; }
+  intptr_t ArgumentCount() const { return arguments_->length(); }
+  Value* ArgumentAt(intptr_t index) const { return (*arguments_)[index]; }
+  const Array& argument_names() const { return argument_names_; }
+  const ICData& ic_data() const { return *ic_data_; }
+
+  virtual intptr_t InputCount() const { return ArgumentCount(); }
+  virtual Value* InputAt(intptr_t index) const { return ArgumentAt(index); }
+
+ protected:
+  virtual void PrintOperands() const;
+
+ private:
+  const String& function_name_;
+  const Token::Kind token_kind_;
+  ZoneGrowableArray<Value*>* arguments_;
+  const Array& argument_names_;
+  const ICData* ic_data_;
+
+  DISALLOW_COPY_AND_ASSIGN(InstanceCallInstr);
+};
+
+
+class StaticCallInstr : public Definition {
+ public:
+  StaticCallInstr(intptr_t token_index,
+                  const Function& function,
+                  ZoneGrowableArray<Value*>* arguments,
+                  const Array& argument_names)
+      : function_(function),
+        arguments_(arguments),
+        argument_names_(argument_names) {
+    ASSERT(function.IsZoneHandle());
+    ASSERT(argument_names.IsZoneHandle());
+    set_token_index(token_index);
+  }
+
+  DECLARE_INSTRUCTION(StaticCall)
+
+  virtual bool HasCall() const { return true; }
+
+  const Function& function() const { return function_; }
+  intptr_t ArgumentCount() const { return arguments_->length(); }
+  Value* ArgumentAt(intptr_t index) const { return (*arguments_)[index]; }
+  const Array& argument_names() const { return argument_names_; }
+
+  virtual intptr_t InputCount() const { return ArgumentCount(); }
+  virtual Value* InputAt(intptr_t index) const { return ArgumentAt(index); }
+
+ protected:
+  virtual void PrintOperands() const;
+
+ private:
+  const Function& function_;
+  ZoneGrowableArray<Value*>* arguments_;
+  const Array& argument_names_;
+
+  DISALLOW_COPY_AND_ASSIGN(StaticCallInstr);
+};
+
+
+// Operators '==' and '!='. A null receiver is compared by identity, other
+// receivers call their operator '=='.
+class EqualityCompareInstr : public Definition {
+ public:
+  EqualityCompareInstr(intptr_t token_index,
+                       Token::Kind kind,
+                       Value* left,
+                       Value* right,
+                       const ICData* ic_data)
+      : kind_(kind), left_(left), right_(right), ic_data_(ic_data) {
+    ASSERT((kind == Token::kEQ) || (kind == Token::kNE));
+    ASSERT(ic_data != NULL);
+    set_token_index(token_index);
+  }
+
+  DECLARE_INSTRUCTION(EqualityCompare)
+
+  virtual bool HasCall() const { return true; }
+
+  Token::Kind kind() const { return kind_; }
+  Value* left() const { return left_; }
+  Value* right() const { return right_; }
+  const ICData& ic_data() const { return *ic_data_; }
+
+  virtual intptr_t InputCount() const { return 2; }
+  virtual Value* InputAt(intptr_t index) const {
+    return (index == 0) ? left_ : right_;
+  }
+
+ protected:
+  virtual void PrintOperands() const;
+
+ private:
+  const Token::Kind kind_;
+  Value* left_;
+  Value* right_;
+  const ICData* ic_data_;
+
+  DISALLOW_COPY_AND_ASSIGN(EqualityCompareInstr);
+};
+
+
+// Operators '===' and '!=='.
+class StrictCompareInstr : public Definition {
+ public:
+  StrictCompareInstr(Token::Kind kind, Value* left, Value* right)
+      : kind_(kind), left_(left), right_(right) {
+    ASSERT((kind == Token::kEQ_STRICT) || (kind == Token::kNE_STRICT));
+  }
+
+  DECLARE_INSTRUCTION(StrictCompare)
+
+  Token::Kind kind() const { return kind_; }
+  Value* left() const { return left_; }
+  Value* right() const { return right_; }
+
+  virtual intptr_t InputCount() const { return 2; }
+  virtual Value* InputAt(intptr_t index) const {
+    return (index == 0) ? left_ : right_;
+  }
+
+ protected:
+  virtual void PrintOperands() const;
+
+ private:
+  const Token::Kind kind_;
+  Value* left_;
+  Value* right_;
+
+  DISALLOW_COPY_AND_ASSIGN(StrictCompareInstr);
+};
+
+
+// Operator '!': false if the value is the true object, otherwise true.
+class BooleanNegateInstr : public Definition {
+ public:
+  explicit BooleanNegateInstr(Value* value) : value_(value) { }
+
+  DECLARE_INSTRUCTION(BooleanNegate)
+
+  Value* value() const { return value_; }
+
+  virtual intptr_t InputCount() const { return 1; }
+  virtual Value* InputAt(intptr_t index) const {
+    ASSERT(index == 0);
+    return value_;
+  }
+
+ private:
+  Value* value_;
+
+  DISALLOW_COPY_AND_ASSIGN(BooleanNegateInstr);
+};
+
+
+class LoadInstanceFieldInstr : public Definition {
+ public:
+  LoadInstanceFieldInstr(Value* instance, intptr_t offset_in_bytes)
+      : instance_(instance), offset_in_bytes_(offset_in_bytes) { }
+
+  DECLARE_INSTRUCTION(LoadInstanceField)
+
+  Value* instance() const { return instance_; }
+  intptr_t offset_in_bytes() const { return offset_in_bytes_; }
+
+  virtual intptr_t InputCount() const { return 1; }
+  virtual Value* InputAt(intptr_t index) const {
+    ASSERT(index == 0);
+    return instance_;
+  }
+
+ private:
+  Value* instance_;
+  const intptr_t offset_in_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadInstanceFieldInstr);
+};
+
+
+class StoreInstanceFieldInstr : public Definition {
+ public:
+  StoreInstanceFieldInstr(Value* instance,
+                          Value* value,
+                          intptr_t offset_in_bytes)
+      : instance_(instance), value_(value), offset_in_bytes_(offset_in_bytes) {
+  }
+
+  DECLARE_INSTRUCTION(StoreInstanceField)
+
+  Value* instance() const { return instance_; }
+  Value* value() const { return value_; }
+  intptr_t offset_in_bytes() const { return offset_in_bytes_; }
+
+  virtual intptr_t InputCount() const { return 2; }
+  virtual Value* InputAt(intptr_t index) const {
+    return (index == 0) ? instance_ : value_;
+  }
+
+ private:
+  Value* instance_;
+  Value* value_;
+  const intptr_t offset_in_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(StoreInstanceFieldInstr);
+};
+
+
+class LoadStaticFieldInstr : public Definition {
+ public:
+  explicit LoadStaticFieldInstr(const Field& field) : field_(field) {
+    ASSERT(field.IsZoneHandle());
+  }
+
+  DECLARE_INSTRUCTION(LoadStaticField)
+
+  const Field& field() const { return field_; }
+
+  virtual intptr_t InputCount() const { return 0; }
+  virtual Value* InputAt(intptr_t index) const {
+    UNREACHABLE();
+    return NULL;
+  }
+
+ private:
+  const Field& field_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadStaticFieldInstr);
+};
+
+
+class StoreStaticFieldInstr : public Definition {
+ public:
+  StoreStaticFieldInstr(const Field& field, Value* value)
+      : field_(field), value_(value) {
+    ASSERT(field.IsZoneHandle());
+  }
+
+  DECLARE_INSTRUCTION(StoreStaticField)
+
+  const Field& field() const { return field_; }
+  Value* value() const { return value_; }
+
+  virtual intptr_t InputCount() const { return 1; }
+  virtual Value* InputAt(intptr_t index) const {
+    ASSERT(index == 0);
+    return value_;
+  }
+
+ private:
+  const Field& field_;
+  Value* value_;
+
+  DISALLOW_COPY_AND_ASSIGN(StoreStaticFieldInstr);
+};
+
+
+// Deoptimizes unless the class of the value is one of the receiver classes
+// recorded in 'ic_data'.
+class CheckClassInstr : public Instruction {
+ public:
+  CheckClassInstr(Value* value, const ICData* ic_data)
+      : value_(value), ic_data_(ic_data) {
+    ASSERT(ic_data != NULL);
+  }
+
+  DECLARE_INSTRUCTION(CheckClass)
+
+  Value* value() const { return value_; }
+  const ICData& ic_data() const { return *ic_data_; }
+
+  virtual intptr_t InputCount() const { return 1; }
+  virtual Value* InputAt(intptr_t index) const {
+    ASSERT(index == 0);
+    return value_;
+  }
+
+ private:
+  Value* value_;
+  const ICData* ic_data_;
+
+  DISALLOW_COPY_AND_ASSIGN(CheckClassInstr);
+};
+
+
+// The true object if the class of the value is one of 'classes', otherwise
+// the false object. The class of a Smi is the Smi class.
+class TestClassInstr : public Definition {
+ public:
+  TestClassInstr(Value* value, ZoneGrowableArray<const Class*>* classes)
+      : value_(value), classes_(classes) {
+    ASSERT((classes != NULL) && (classes->length() > 0));
+  }
+
+  DECLARE_INSTRUCTION(TestClass)
+
+  Value* value() const { return value_; }
+  const ZoneGrowableArray<const Class*>& classes() const { return *classes_; }
+
+  virtual intptr_t InputCount() const { return 1; }
+  virtual Value* InputAt(intptr_t index) const {
+    ASSERT(index == 0);
+    return value_;
+  }
+
+ private:
+  Value* value_;
+  ZoneGrowableArray<const Class*>* classes_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestClassInstr);
+};
+
+
+// Arithmetic and bitwise operators on two Smi operands, deoptimizing if an
+// operand is not a Smi or the result overflows.
+class BinarySmiOpInstr : public Definition {
+ public:
+  BinarySmiOpInstr(Token::Kind op_kind, Value* left, Value* right)
+      : op_kind_(op_kind), left_(left), right_(right) { }
+
+  DECLARE_INSTRUCTION(BinarySmiOp)
+
+  Token::Kind op_kind() const { return op_kind_; }
+  Value* left() const { return left_; }
+  Value* right() const { return right_; }
+
+  virtual intptr_t InputCount() const { return 2; }
+  virtual Value* InputAt(intptr_t index) const {
+    return (index == 0) ? left_ : right_;
+  }
+
+ protected:
+  virtual void PrintOperands() const;
+
+ private:
+  const Token::Kind op_kind_;
+  Value* left_;
+  Value* right_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinarySmiOpInstr);
+};
+
+
+// Arithmetic operators on a double and a double or Smi operand, producing a
+// newly allocated double. Deoptimizes on other operands.
+class BinaryDoubleOpInstr : public Definition {
+ public:
+  BinaryDoubleOpInstr(Token::Kind op_kind, Value* left, Value* right)
+      : op_kind_(op_kind), left_(left), right_(right) { }
+
+  DECLARE_INSTRUCTION(BinaryDoubleOp)
+
+  // Calls the allocation stub of the result.
+  virtual bool HasCall() const { return true; }
+
+  Token::Kind op_kind() const { return op_kind_; }
+  Value* left() const { return left_; }
+  Value* right() const { return right_; }
+
+  virtual intptr_t InputCount() const { return 2; }
+  virtual Value* InputAt(intptr_t index) const {
+    return (index == 0) ? left_ : right_;
+  }
+
+ protected:
+  virtual void PrintOperands() const;
+
+ private:
+  const Token::Kind op_kind_;
+  Value* left_;
+  Value* right_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryDoubleOpInstr);
+};
+
+
+// Relational operators, and for Smi operands also equality, on two operands
+// of the same class. Deoptimizes if an operand is of another class.
+class RelationalOpInstr : public Definition {
+ public:
+  enum OperandsClass {
+    kSmiOperands,
+    kDoubleOperands
+  };
+
+  RelationalOpInstr(Token::Kind kind,
+                    OperandsClass operands_class,
+                    Value* left,
+                    Value* right)
+      : kind_(kind),
+        operands_class_(operands_class),
+        left_(left),
+        right_(right) { }
+
+  DECLARE_INSTRUCTION(RelationalOp)
+
+  Token::Kind kind() const { return kind_; }
+  OperandsClass operands_class() const { return operands_class_; }
+  Value* left() const { return left_; }
+  Value* right() const { return right_; }
+
+  virtual intptr_t InputCount() const { return 2; }
+  virtual Value* InputAt(intptr_t index) const {
+    return (index == 0) ? left_ : right_;
+  }
+
+ protected:
+  virtual void PrintOperands() const;
+
+ private:
+  const Token::Kind kind_;
+  const OperandsClass operands_class_;
+  Value* left_;
+  Value* right_;
+
+  DISALLOW_COPY_AND_ASSIGN(RelationalOpInstr);
+};
+
+
+// Indexed load from an object array of class 'array_class'. Deoptimizes if the
+// array is of another class, the index is not a Smi or is out of range.
+class LoadIndexedInstr : public Definition {
+ public:
+  LoadIndexedInstr(Value* array, Value* index, const Class& array_class)
+      : array_(array), index_(index), array_class_(array_class) {
+    ASSERT(array_class.IsZoneHandle());
+  }
+
+  DECLARE_INSTRUCTION(LoadIndexed)
+
+  Value* array() const { return array_; }
+  Value* index() const { return index_; }
+  const Class& array_class() const { return array_class_; }
+
+  virtual intptr_t InputCount() const { return 2; }
+  virtual Value* InputAt(intptr_t index) const {
+    return (index == 0) ? array_ : index_;
+  }
+
+ private:
+  Value* array_;
+  Value* index_;
+  const Class& array_class_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadIndexedInstr);
+};
+
+
+// Indexed store into a mutable object array, with the same checks as
+// LoadIndexedInstr.
+class StoreIndexedInstr : public Definition {
+ public:
+  StoreIndexedInstr(Value* array, Value* index, Value* value)
+      : array_(array), index_(index), value_(value) { }
+
+  DECLARE_INSTRUCTION(StoreIndexed)
+
+  Value* array() const { return array_; }
+  Value* index() const { return index_; }
+  Value* value() const { return value_; }
+
+  virtual intptr_t InputCount() const { return 3; }
+  virtual Value* InputAt(intptr_t index) const {
+    switch (index) {
+      case 0: return array_;
+      case 1: return index_;
+      case 2: return value_;
+      default: UNREACHABLE();
+    }
+    return NULL;
+  }
+
+ private:
+  Value* array_;
+  Value* index_;
+  Value* value_;
+
+  DISALLOW_COPY_AND_ASSIGN(StoreIndexedInstr);
+};
+
+#undef DECLARE_INSTRUCTION
+
+}  // namespace dart
+
+#endif  // VM_INTERMEDIATE_LANGUAGE_H_
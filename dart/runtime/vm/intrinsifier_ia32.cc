@@ -182,20 +182,16 @@ static bool Array_getIndexed(Assembler* assembler) {
 }
 
 
-// Intrinsify only for Smi value and index. Non-smi values need a store buffer
-// update. Array length is always a Smi.
+// Intrinsify only for Smi index. Stores of new objects into an old array
+// update the store buffer. Array length is always a Smi.
 static bool Array_setIndexed(Assembler* assembler) {
   if (FLAG_enable_type_checks) {
     return false;
   }
-  const Immediate raw_null =
-      Immediate(reinterpret_cast<intptr_t>(Object::null()));
   Label fall_through;
-  __ movl(EAX, Address(ESP, + 1 * kWordSize));  // Value.
   __ movl(EBX, Address(ESP, + 2 * kWordSize));  // Index.
-  __ orl(EAX, EBX);
   __ testl(EBX, Immediate(kSmiTagMask));
-  // Value or index not Smi.
+  // Index not Smi.
   __ j(NOT_ZERO, &fall_through, Assembler::kNearJump);
   __ movl(EAX, Address(ESP, + 3 * kWordSize));  // Array.
   // Range check.
@@ -205,8 +201,10 @@ static bool Array_setIndexed(Assembler* assembler) {
   // Note that EBX is Smi, i.e, times 2.
   ASSERT(kSmiTagShift == 1);
   // Destroy ECX as we will not continue in the function.
-  __ movl(ECX, Address(ESP, + 1 * kWordSize));
-  __ movl(FieldAddress(EAX, EBX, TIMES_2, sizeof(RawArray)), ECX);
+  __ movl(ECX, Address(ESP, + 1 * kWordSize));  // Value.
+  __ StoreIntoObject(EAX,
+                     FieldAddress(EAX, EBX, TIMES_2, sizeof(RawArray)),
+                     ECX);
   // Caller is responsible of preserving the value if necessary.
   __ ret();
   __ Bind(&fall_through);
@@ -1,15 +1,921 @@
 // Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
 // for details. All rights reserved. Use of this source code is governed by a
 // BSD-style license that can be found in the LICENSE file.
+//
+// The intrinsic code below is executed before a method has built its frame.
+// The return address is on the stack and the arguments below it.
+// Registers RDX (arguments descriptor) and RCX (function) must be preserved.
+// Each intrinsification method returns true if the corresponding
+// Dart method was intrinsified.
 
 #include "vm/globals.h"  // Needed here to get TARGET_ARCH_X64.
 #if defined(TARGET_ARCH_X64)
 
 #include "vm/intrinsifier.h"
 
+#include "vm/assembler.h"
+#include "vm/assembler_macros.h"
+#include "vm/object.h"
+#include "vm/object_store.h"
+#include "vm/os.h"
+#include "vm/stub_code.h"
+
 namespace dart {
 
+DEFINE_FLAG(bool, intrinsify, true, "Instrinsify when possible");
+DECLARE_FLAG(bool, enable_type_checks);
+
+// List of intrinsics: (class-name, function-name, intrinsification method).
+#define INTRINSIC_LIST(V)                                                      \
+  V(IntegerImplementation, addFromInteger, Integer_addFromInteger)             \
+  V(IntegerImplementation, +, Integer_addFromInteger)                          \
+  V(IntegerImplementation, subFromInteger, Integer_subFromInteger)             \
+  V(IntegerImplementation, -, Integer_sub)                                     \
+  V(IntegerImplementation, mulFromInteger, Integer_mulFromInteger)             \
+  V(IntegerImplementation, *, Integer_mulFromInteger)                          \
+  V(IntegerImplementation, %, Integer_modulo)                                  \
+  V(IntegerImplementation, negate, Integer_negate)                             \
+  V(IntegerImplementation, bitAndFromInteger, Integer_bitAndFromInteger)       \
+  V(IntegerImplementation, &, Integer_bitAndFromInteger)                       \
+  V(IntegerImplementation, bitOrFromInteger, Integer_bitOrFromInteger)         \
+  V(IntegerImplementation, |, Integer_bitOrFromInteger)                        \
+  V(IntegerImplementation, bitXorFromInteger, Integer_bitXorFromInteger)       \
+  V(IntegerImplementation, ^, Integer_bitXorFromInteger)                       \
+  V(IntegerImplementation, greaterThanFromInteger, Integer_lessThan)           \
+  V(IntegerImplementation, >, Integer_greaterThan)                             \
+  V(IntegerImplementation, ==, Integer_equalToInteger)                         \
+  V(IntegerImplementation, equalToInteger, Integer_equalToInteger)             \
+  V(IntegerImplementation, <, Integer_lessThan)                                \
+  V(IntegerImplementation, <=, Integer_lessEqualThan)                          \
+  V(IntegerImplementation, >=, Integer_greaterEqualThan)                       \
+  V(IntegerImplementation, <<, Integer_shl)                                    \
+  V(IntegerImplementation, >>, Integer_sar)                                    \
+  V(Smi, ~, Smi_bitNegate)                                                     \
+  V(Double, >, Double_greaterThan)                                             \
+  V(Double, >=, Double_greaterEqualThan)                                       \
+  V(Double, <, Double_lessThan)                                                \
+  V(Double, <=, Double_lessEqualThan)                                          \
+  V(Double, ==, Double_equal)                                                  \
+  V(Double, +, Double_add)                                                     \
+  V(Double, -, Double_sub)                                                     \
+  V(Double, *, Double_mul)                                                     \
+  V(Double, /, Double_div)                                                     \
+  V(Double, toDouble, Double_toDouble)                                         \
+  V(Double, mulFromInteger, Double_mulFromInteger)                             \
+  V(Double, Double.fromInteger, Double_fromInteger)                            \
+  V(ObjectArray, ObjectArray., ObjectArray_Allocate)                           \
+  V(ObjectArray, get:length, Array_getLength)                                  \
+  V(ObjectArray, [], Array_getIndexed)                                         \
+  V(ObjectArray, []=, Array_setIndexed)                                        \
+  V(GrowableObjectArray, get:length, GrowableArray_getLength)                  \
+  V(GrowableObjectArray, [], GrowableArray_getIndexed)                         \
+  V(ImmutableArray, [], Array_getIndexed)                                      \
+  V(ImmutableArray, get:length, Array_getLength)                               \
+  V(Math, sqrt, Math_sqrt)                                                     \
+  V(Object, ==, Object_equal)                                                  \
+  V(FixedSizeArrayIterator, next, FixedSizeArrayIterator_next)                 \
+  V(FixedSizeArrayIterator, hasNext, FixedSizeArrayIterator_hasNext)           \
+
+#define __ assembler->
+
+static bool ObjectArray_Allocate(Assembler* assembler) {
+  // This snippet of inlined code uses the following registers:
+  // RAX, RBX, R12
+  // and the newly allocated object is returned in RAX.
+  const intptr_t kTypeArgumentsOffset = 2 * kWordSize;
+  const intptr_t kArrayLengthOffset = 1 * kWordSize;
+  Label fall_through;
+
+  // Compute the size to be allocated, it is based on the array length
+  // and it computed as:
+  // RoundedAllocationSize((array_length * kwordSize) + sizeof(RawArray)).
+  __ movq(R12, Address(RSP, kArrayLengthOffset));  // Array Length.
+  // Assert that length is a Smi.
+  __ testq(R12, Immediate(kSmiTagSize));
+  __ j(NOT_ZERO, &fall_through);
+  intptr_t fixed_size = sizeof(RawArray) + kObjectAlignment - 1;
+  __ leaq(R12, Address(R12, TIMES_4, fixed_size));  // R12 is a Smi.
+  ASSERT(kSmiTagShift == 1);
+  __ andq(R12, Immediate(-kObjectAlignment));
+
+  Heap* heap = Isolate::Current()->heap();
+
+  // R12: size to allocate.
+  __ movq(TMP, Immediate(heap->TopAddress()));
+  __ movq(RAX, Address(TMP, 0));
+  __ leaq(RBX, Address(RAX, R12, TIMES_1, 0));
+
+  // Check if the allocation fits into the remaining space.
+  // RAX: potential new object start.
+  // RBX: potential next object start.
+  __ movq(TMP, Immediate(heap->EndAddress()));
+  __ cmpq(RBX, Address(TMP, 0));
+  __ j(ABOVE_EQUAL, &fall_through);
+
+  // Successfully allocated the object(s), now update top to point to
+  // next object start and initialize the object.
+  __ movq(TMP, Immediate(heap->TopAddress()));
+  __ movq(Address(TMP, 0), RBX);
+  __ addq(RAX, Immediate(kHeapObjectTag));
+
+  // RAX: new object start as a tagged pointer.
+  // RBX: new object end address.
+  // Store class value for array.
+  __ movq(R12, FieldAddress(CTX, Context::isolate_offset()));
+  __ movq(R12, Address(R12, Isolate::object_store_offset()));
+  __ movq(R12, Address(R12, ObjectStore::array_class_offset()));
+  __ movq(FieldAddress(RAX, Instance::class_offset()), R12);
+
+  // Store the type argument field.
+  __ movq(R12, Address(RSP, kTypeArgumentsOffset));  // type argument.
+  __ movq(FieldAddress(RAX, Array::type_arguments_offset()), R12);
+
+  // Set the length field.
+  __ movq(R12, Address(RSP, kArrayLengthOffset));  // Array Length.
+  __ movq(FieldAddress(RAX, Array::length_offset()), R12);
+
+  // Initialize all array elements to raw_null.
+  // RAX: new object start as a tagged pointer.
+  // RBX: new object end address.
+  // R12: iterator which initially points to the start of the variable
+  // data area to be initialized.
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  __ leaq(R12, FieldAddress(RAX, sizeof(RawArray)));
+  Label done;
+  Label init_loop;
+  __ Bind(&init_loop);
+  __ cmpq(R12, RBX);
+  __ j(ABOVE_EQUAL, &done, Assembler::kNearJump);
+  __ movq(Address(R12, 0), raw_null);
+  __ addq(R12, Immediate(kWordSize));
+  __ jmp(&init_loop, Assembler::kNearJump);
+  __ Bind(&done);
+  __ ret();  // returns the newly allocated object in RAX.
+
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Array_getLength(Assembler* assembler) {
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));
+  __ movq(RAX, FieldAddress(RAX, Array::length_offset()));
+  __ ret();
+  return true;
+}
+
+
+static bool Array_getIndexed(Assembler* assembler) {
+  Label fall_through;
+  __ movq(RBX, Address(RSP, + 1 * kWordSize));  // Index.
+  __ movq(RAX, Address(RSP, + 2 * kWordSize));  // Array.
+  __ testq(RBX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &fall_through, Assembler::kNearJump);  // Non-smi index.
+  // Range check.
+  __ cmpq(RBX, FieldAddress(RAX, Array::length_offset()));
+  // Runtime throws exception.
+  __ j(ABOVE_EQUAL, &fall_through, Assembler::kNearJump);
+  // Note that RBX is Smi, i.e, times 2.
+  ASSERT(kSmiTagShift == 1);
+  __ movq(RAX, FieldAddress(RAX, RBX, TIMES_4, sizeof(RawArray)));
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+// Intrinsify only for Smi index. Stores of new objects into an old array
+// update the store buffer. Array length is always a Smi.
+static bool Array_setIndexed(Assembler* assembler) {
+  if (FLAG_enable_type_checks) {
+    return false;
+  }
+  Label fall_through;
+  __ movq(RBX, Address(RSP, + 2 * kWordSize));  // Index.
+  __ testq(RBX, Immediate(kSmiTagMask));
+  // Index not Smi.
+  __ j(NOT_ZERO, &fall_through, Assembler::kNearJump);
+  __ movq(RAX, Address(RSP, + 3 * kWordSize));  // Array.
+  // Range check.
+  __ cmpq(RBX, FieldAddress(RAX, Array::length_offset()));
+  // Runtime throws exception.
+  __ j(ABOVE_EQUAL, &fall_through, Assembler::kNearJump);
+  // Note that RBX is Smi, i.e, times 2.
+  ASSERT(kSmiTagShift == 1);
+  // Destroy RCX as we will not continue in the function.
+  __ movq(RCX, Address(RSP, + 1 * kWordSize));  // Value.
+  __ StoreIntoObject(RAX,
+                     FieldAddress(RAX, RBX, TIMES_4, sizeof(RawArray)),
+                     RCX);
+  // Caller is responsible of preserving the value if necessary.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static intptr_t GetOffsetForField(const char* class_name_p,
+                                  const char* field_name_p) {
+  const String& class_name = String::Handle(String::NewSymbol(class_name_p));
+  const String& field_name = String::Handle(String::NewSymbol(field_name_p));
+  const Class& cls = Class::Handle(Library::Handle(
+      Library::CoreImplLibrary()).LookupClass(class_name));
+  ASSERT(!cls.IsNull());
+  const Field& field = Field::ZoneHandle(cls.LookupInstanceField(field_name));
+  ASSERT(!field.IsNull());
+  return field.Offset();
+}
+
+
+static const char* kGrowableArrayClassName = "GrowableObjectArray";
+static const char* kGrowableArrayLengthFieldName = "_length";
+static const char* kGrowableArrayArrayFieldName = "backingArray";
+
+// Read the length_ instance field.
+static bool GrowableArray_getLength(Assembler* assembler) {
+  intptr_t length_offset = GetOffsetForField(kGrowableArrayClassName,
+                                             kGrowableArrayLengthFieldName);
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));
+  __ movq(RAX, FieldAddress(RAX, length_offset));
+  __ ret();
+  return true;
+}
+
+
+static bool GrowableArray_getIndexed(Assembler* assembler) {
+  intptr_t length_offset = GetOffsetForField(kGrowableArrayClassName,
+                                             kGrowableArrayLengthFieldName);
+  intptr_t array_offset = GetOffsetForField(kGrowableArrayClassName,
+                                            kGrowableArrayArrayFieldName);
+  Label fall_through;
+  __ movq(RBX, Address(RSP, + 1 * kWordSize));  // Index.
+  __ movq(RAX, Address(RSP, + 2 * kWordSize));  // GrowableArray.
+  __ testq(RBX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &fall_through, Assembler::kNearJump);  // Non-smi index.
+  // Range check.
+  __ cmpq(RBX, FieldAddress(RAX, length_offset));
+  // Runtime throws exception.
+  __ j(ABOVE_EQUAL, &fall_through, Assembler::kNearJump);
+  __ movq(RAX, FieldAddress(RAX, array_offset));  // backingArray.
+
+  // Note that RBX is Smi, i.e, times 2.
+  ASSERT(kSmiTagShift == 1);
+  __ movq(RAX, FieldAddress(RAX, RBX, TIMES_4, sizeof(RawArray)));
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+// Tests if two top most arguments are smis, jumps to label not_smi if not.
+// Topmost argument is in RAX.
+static void TestBothArgumentsSmis(Assembler* assembler, Label* not_smi) {
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));
+  __ movq(RBX, Address(RSP, + 2 * kWordSize));
+  __ orq(RBX, RAX);
+  __ testq(RBX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, not_smi);
+}
+
+
+static bool Integer_addFromInteger(Assembler* assembler) {
+  Label fall_through;
+  TestBothArgumentsSmis(assembler, &fall_through);
+  __ addq(RAX, Address(RSP, + 2 * kWordSize));
+  __ j(OVERFLOW, &fall_through, Assembler::kNearJump);
+  // Result is in RAX.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Integer_subFromInteger(Assembler* assembler) {
+  Label fall_through;
+  TestBothArgumentsSmis(assembler, &fall_through);
+  __ subq(RAX, Address(RSP, + 2 * kWordSize));
+  __ j(OVERFLOW, &fall_through, Assembler::kNearJump);
+  // Result is in RAX.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Integer_sub(Assembler* assembler) {
+  Label fall_through;
+  TestBothArgumentsSmis(assembler, &fall_through);
+  __ movq(RBX, RAX);
+  __ movq(RAX, Address(RSP, + 2 * kWordSize));
+  __ subq(RAX, RBX);
+  __ j(OVERFLOW, &fall_through, Assembler::kNearJump);
+  // Result is in RAX.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+
+static bool Integer_mulFromInteger(Assembler* assembler) {
+  Label fall_through;
+  TestBothArgumentsSmis(assembler, &fall_through);
+  ASSERT(kSmiTag == 0);  // Adjust code below if not the case.
+  __ SmiUntag(RAX);
+  __ imulq(RAX, Address(RSP, + 2 * kWordSize));
+  __ j(OVERFLOW, &fall_through, Assembler::kNearJump);
+  // Result is in RAX.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+// Simple implementation: for positive dividend values greater than divisor,
+// return dividend.
+static bool Integer_modulo(Assembler* assembler) {
+  Label fall_through, return_zero;
+  TestBothArgumentsSmis(assembler, &fall_through);
+  // RAX: right argument (divisor)
+  __ movq(RBX, Address(RSP, + 2 * kWordSize));  // Left argument (dividend).
+  __ cmpq(RBX, Immediate(0));
+  __ j(LESS, &fall_through, Assembler::kNearJump);
+  __ cmpq(RBX, RAX);
+  __ j(EQUAL, &return_zero, Assembler::kNearJump);
+  __ j(GREATER, &fall_through, Assembler::kNearJump);
+  __ movq(RAX, RBX);  // Return dividend.
+  __ ret();
+  __ Bind(&return_zero);
+  __ xorq(RAX, RAX);  // Return zero.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Integer_negate(Assembler* assembler) {
+  Label fall_through;
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &fall_through, Assembler::kNearJump);  // Non-smi value.
+  __ negq(RAX);
+  __ j(OVERFLOW, &fall_through, Assembler::kNearJump);
+  // Result is in RAX.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Integer_bitAndFromInteger(Assembler* assembler) {
+  Label fall_through;
+  TestBothArgumentsSmis(assembler, &fall_through);
+  __ movq(RBX, Address(RSP, + 2 * kWordSize));
+  __ andq(RAX, RBX);
+  // Result is in RAX.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Integer_bitOrFromInteger(Assembler* assembler) {
+  Label fall_through;
+  TestBothArgumentsSmis(assembler, &fall_through);
+  __ movq(RBX, Address(RSP, + 2 * kWordSize));
+  __ orq(RAX, RBX);
+  // Result is in RAX.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Integer_bitXorFromInteger(Assembler* assembler) {
+  Label fall_through;
+  TestBothArgumentsSmis(assembler, &fall_through);
+  __ movq(RBX, Address(RSP, + 2 * kWordSize));
+  __ xorq(RAX, RBX);
+  // Result is in RAX.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Integer_shl(Assembler* assembler) {
+  ASSERT(kSmiTagShift == 1);
+  ASSERT(kSmiTag == 0);
+  Label fall_through, overflow;
+  TestBothArgumentsSmis(assembler, &fall_through);
+  // Shift value is in RAX. Compare with tagged Smi.
+  __ cmpq(RAX, Immediate(Smi::RawValue(Smi::kBits)));
+  __ j(ABOVE_EQUAL, &fall_through);
+
+  __ SmiUntag(RAX);
+  __ movq(RCX, RAX);  // Shift amount must be in RCX.
+  __ movq(RAX, Address(RSP, + 2 * kWordSize));  // Value.
+
+  // Overflow test - all the shifted-out bits must be same as the sign bit.
+  __ movq(RBX, RAX);
+  __ shlq(RAX, RCX);
+  __ sarq(RAX, RCX);
+  __ cmpq(RAX, RBX);
+  __ j(NOT_EQUAL, &overflow, Assembler::kNearJump);
+
+  __ shlq(RAX, RCX);  // Shift for result now we know there is no overflow.
+
+  // RAX is a correctly tagged Smi.
+  __ ret();
+
+  __ Bind(&overflow);
+  // Arguments are Smi but the shift produced an overflow to Mint.
+  __ cmpq(RBX, Immediate(0));
+  // TODO(srdjan): Implement negative values, for now fall through.
+  __ j(LESS, &fall_through);
+  __ SmiUntag(RBX);
+  __ movq(R12, RBX);
+  __ shlq(RBX, RCX);
+  // The shifted value must also fit into the 64 bits of a Mint.
+  __ movq(RAX, RBX);
+  __ sarq(RAX, RCX);
+  __ cmpq(RAX, R12);
+  __ j(NOT_EQUAL, &fall_through);
+  // Result in RBX.
+  const Class& mint_class = Class::ZoneHandle(
+      Isolate::Current()->object_store()->mint_class());
+  __ LoadObject(RCX, mint_class);
+  AssemblerMacros::TryAllocate(assembler,
+                               mint_class,
+                               RCX,  // Class register.
+                               &fall_through,
+                               RAX);  // Result register.
+  __ movq(FieldAddress(RAX, Mint::value_offset()), RBX);
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool CompareIntegers(Assembler* assembler, Condition true_condition) {
+  Label fall_through, true_label;
+  const Bool& bool_true = Bool::ZoneHandle(Bool::True());
+  const Bool& bool_false = Bool::ZoneHandle(Bool::False());
+  TestBothArgumentsSmis(assembler, &fall_through);
+  // RAX contains the right argument.
+  __ cmpq(Address(RSP, + 2 * kWordSize), RAX);
+  __ j(true_condition, &true_label, Assembler::kNearJump);
+  __ LoadObject(RAX, bool_false);
+  __ ret();
+  __ Bind(&true_label);
+  __ LoadObject(RAX, bool_true);
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Integer_lessThan(Assembler* assembler) {
+  return CompareIntegers(assembler, LESS);
+}
+
+
+static bool Integer_greaterThan(Assembler* assembler) {
+  return CompareIntegers(assembler, GREATER);
+}
+
+
+static bool Integer_lessEqualThan(Assembler* assembler) {
+  return CompareIntegers(assembler, LESS_EQUAL);
+}
+
+
+static bool Integer_greaterEqualThan(Assembler* assembler) {
+  return CompareIntegers(assembler, GREATER_EQUAL);
+}
+
+
+// This is called for Smi, Mint and Bigint receivers. Bigints are not handled.
+static bool Integer_equalToInteger(Assembler* assembler) {
+  Label fall_through, true_label, check_for_mint;
+  const Bool& bool_true = Bool::ZoneHandle(Bool::True());
+  const Bool& bool_false = Bool::ZoneHandle(Bool::False());
+  // For integer receiver '===' check first.
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));
+  __ cmpq(RAX, Address(RSP, + 2 * kWordSize));
+  __ j(EQUAL, &true_label, Assembler::kNearJump);
+  __ movq(RBX, Address(RSP, + 2 * kWordSize));
+  __ orq(RAX, RBX);
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &check_for_mint, Assembler::kNearJump);
+  // Both arguments are smi, '===' is good enough.
+  __ LoadObject(RAX, bool_false);
+  __ ret();
+  __ Bind(&true_label);
+  __ LoadObject(RAX, bool_true);
+  __ ret();
+
+  // At least one of the arguments was not Smi, inline code for Smi/Mint
+  // equality comparison.
+  ObjectStore* object_store = Isolate::Current()->object_store();
+  Label receiver_not_smi;
+  __ Bind(&check_for_mint);
+  __ movq(RAX, Address(RSP, + 2 * kWordSize));  // Receiver.
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &receiver_not_smi);
+
+  // Note that an instance of Mint never contains a value that can be
+  // represented by Smi.
+  // Left is Smi, return false if right is Mint, otherwise fall through.
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));  // Right argument.
+  __ movq(RAX, FieldAddress(RAX, Object::class_offset()));
+  __ CompareObject(RAX, Class::ZoneHandle(object_store->mint_class()));
+  __ j(NOT_EQUAL, &fall_through);
+  __ LoadObject(RAX, bool_false);  // Smi == Mint -> false.
+  __ ret();
+
+  __ Bind(&receiver_not_smi);
+  // RAX:: receiver.
+  __ movq(RAX, FieldAddress(RAX, Object::class_offset()));
+  __ CompareObject(RAX, Class::ZoneHandle(object_store->mint_class()));
+  __ j(NOT_EQUAL, &fall_through);
+  // Receiver is Mint, return false if right is Smi.
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));  // Right argument.
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &fall_through);
+  __ LoadObject(RAX, bool_false);  // Smi == Mint -> false.
+  __ ret();
+  // TODO(srdjan): Implement Mint == Mint comparison.
+
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Integer_sar(Assembler* assembler) {
+  Label fall_through, shift_count_ok;
+  TestBothArgumentsSmis(assembler, &fall_through);
+  // Can destroy RCX since we are not falling through.
+  Immediate count_limit = Immediate(0x3F);
+  // Check that the count is not larger than what the hardware can handle.
+  // For shifting right a Smi the result is the same for all numbers
+  // >= count_limit.
+  __ SmiUntag(RAX);
+  __ cmpq(RAX, count_limit);
+  __ j(LESS_EQUAL, &shift_count_ok, Assembler::kNearJump);
+  __ movq(RAX, count_limit);
+  __ Bind(&shift_count_ok);
+  __ movq(RCX, RAX);  // Shift amount must be in RCX.
+  __ movq(RAX, Address(RSP, + 2 * kWordSize));  // Value.
+  __ SmiUntag(RAX);  // Value.
+  __ sarq(RAX, RCX);
+  __ SmiTag(RAX);
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Smi_bitNegate(Assembler* assembler) {
+  Label fall_through;
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));  // Index.
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &fall_through, Assembler::kNearJump);  // Non-smi.
+  __ notq(RAX);
+  __ andq(RAX, Immediate(~kSmiTagMask));  // Remove inverted smi-tag.
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+// Check if the last argument is a double, jump to label 'is_smi' if smi
+// (easy to convert to double), otherwise jump to label 'not_double_smi',
+// Returns the last argument in RAX.
+static void TestLastArgumentIsDouble(Assembler* assembler,
+                                     Label* is_smi,
+                                     Label* not_double_smi) {
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(ZERO, is_smi, Assembler::kNearJump);  // Jump if Smi.
+  __ LoadObject(RBX, Class::ZoneHandle(
+      Isolate::Current()->object_store()->double_class()));
+  __ cmpq(RBX, FieldAddress(RAX, Object::class_offset()));
+  __ j(NOT_EQUAL, not_double_smi, Assembler::kNearJump);
+  // Fall through if double.
+}
+
+
+// Both arguments on stack, arg0 (left) is a double, arg1 (right) is of unknown
+// type. Return true or false object in the register RAX. Any NaN argument
+// returns false. Any non-double arg1 causes control flow to fall through to the
+// slow case (compiled method body).
+static bool CompareDoubles(Assembler* assembler, Condition true_condition) {
+  const Bool& bool_true = Bool::ZoneHandle(Bool::True());
+  const Bool& bool_false = Bool::ZoneHandle(Bool::False());
+  Label fall_through, is_false, is_true, is_smi, double_op;
+  TestLastArgumentIsDouble(assembler, &is_smi, &fall_through);
+  // Both arguments are double, right operand is in RAX.
+  __ movsd(XMM1, FieldAddress(RAX, Double::value_offset()));
+  __ Bind(&double_op);
+  __ movq(RAX, Address(RSP, + 2 * kWordSize));  // Left argument.
+  __ movsd(XMM0, FieldAddress(RAX, Double::value_offset()));
+  __ comisd(XMM0, XMM1);
+  __ j(PARITY_EVEN, &is_false, Assembler::kNearJump);  // NaN -> false;
+  __ j(true_condition, &is_true, Assembler::kNearJump);
+  // Fall through false.
+  __ Bind(&is_false);
+  __ LoadObject(RAX, bool_false);
+  __ ret();
+  __ Bind(&is_true);
+  __ LoadObject(RAX, bool_true);
+  __ ret();
+  __ Bind(&is_smi);
+  __ SmiUntag(RAX);
+  __ cvtsi2sd(XMM1, RAX);
+  __ jmp(&double_op);
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+// arg0 is Double, arg1 is unknown.
+static bool Double_greaterThan(Assembler* assembler) {
+  return CompareDoubles(assembler, ABOVE);
+}
+
+
+// arg0 is Double, arg1 is unknown.
+static bool Double_greaterEqualThan(Assembler* assembler) {
+  return CompareDoubles(assembler, ABOVE_EQUAL);
+}
+
+
+// arg0 is Double, arg1 is unknown.
+static bool Double_lessThan(Assembler* assembler) {
+  return CompareDoubles(assembler, BELOW);
+}
+
+
+// arg0 is Double, arg1 is unknown.
+static bool Double_equal(Assembler* assembler) {
+  return CompareDoubles(assembler, EQUAL);
+}
+
+
+// arg0 is Double, arg1 is unknown.
+static bool Double_lessEqualThan(Assembler* assembler) {
+  return CompareDoubles(assembler, BELOW_EQUAL);
+}
+
+
+static bool Double_toDouble(Assembler* assembler) {
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));
+  __ ret();
+  return true;
+}
+
+
+// Expects RAX to contain right argument, left argument is on stack. Left
+// argument is double, right argument is of unknown type.
+static bool DoubleArithmeticOperations(Assembler* assembler, Token::Kind kind) {
+  Label fall_through;
+  TestLastArgumentIsDouble(assembler, &fall_through, &fall_through);
+  // Both arguments are double, right operand is in RAX, class in RBX.
+  __ movsd(XMM1, FieldAddress(RAX, Double::value_offset()));
+  __ movq(RAX, Address(RSP, + 2 * kWordSize));  // Left argument.
+  __ movsd(XMM0, FieldAddress(RAX, Double::value_offset()));
+  switch (kind) {
+    case Token::kADD: __ addsd(XMM0, XMM1); break;
+    case Token::kSUB: __ subsd(XMM0, XMM1); break;
+    case Token::kMUL: __ mulsd(XMM0, XMM1); break;
+    case Token::kDIV: __ divsd(XMM0, XMM1); break;
+    default: UNREACHABLE();
+  }
+  const Class& double_class = Class::ZoneHandle(
+      Isolate::Current()->object_store()->double_class());
+  AssemblerMacros::TryAllocate(assembler,
+                               double_class,
+                               RBX,  // Class register.
+                               &fall_through,
+                               RAX);  // Result register.
+  __ movsd(FieldAddress(RAX, Double::value_offset()), XMM0);
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Double_add(Assembler* assembler) {
+  return DoubleArithmeticOperations(assembler, Token::kADD);
+}
+
+
+static bool Double_mul(Assembler* assembler) {
+  return DoubleArithmeticOperations(assembler, Token::kMUL);
+}
+
+
+static bool Double_sub(Assembler* assembler) {
+  return DoubleArithmeticOperations(assembler, Token::kSUB);
+}
+
+
+static bool Double_div(Assembler* assembler) {
+  return DoubleArithmeticOperations(assembler, Token::kDIV);
+}
+
+
+// Left is double right is integer (bigint or Smi)
+static bool Double_mulFromInteger(Assembler* assembler) {
+  Label fall_through;
+  // Only Smi-s allowed.
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &fall_through, Assembler::kNearJump);
+  // Is Smi.
+  __ SmiUntag(RAX);
+  __ cvtsi2sd(XMM1, RAX);
+  __ movq(RAX, Address(RSP, + 2 * kWordSize));
+  __ movsd(XMM0, FieldAddress(RAX, Double::value_offset()));
+  __ mulsd(XMM0, XMM1);
+  const Class& double_class = Class::ZoneHandle(
+      Isolate::Current()->object_store()->double_class());
+  __ LoadObject(RBX, double_class);
+  AssemblerMacros::TryAllocate(assembler,
+                               double_class,
+                               RBX,  // Class register.
+                               &fall_through,
+                               RAX);  // Result register.
+  __ movsd(FieldAddress(RAX, Double::value_offset()), XMM0);
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+static bool Double_fromInteger(Assembler* assembler) {
+  Label fall_through;
+  __ movq(RAX, Address(RSP, +1 * kWordSize));
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &fall_through, Assembler::kNearJump);
+  // Is Smi.
+  __ SmiUntag(RAX);
+  __ cvtsi2sd(XMM0, RAX);
+  const Class& double_class = Class::ZoneHandle(
+      Isolate::Current()->object_store()->double_class());
+  __ LoadObject(RBX, double_class);
+  AssemblerMacros::TryAllocate(assembler,
+                               double_class,
+                               RBX,  // Class register.
+                               &fall_through,
+                               RAX);  // Result register.
+  __ movsd(FieldAddress(RAX, Double::value_offset()), XMM0);
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+// Argument type is not known
+static bool Math_sqrt(Assembler* assembler) {
+  Label fall_through, is_smi, double_op;
+  TestLastArgumentIsDouble(assembler, &is_smi, &fall_through);
+  // Argument is double and is in RAX, class in RBX.
+  __ movsd(XMM1, FieldAddress(RAX, Double::value_offset()));
+  __ Bind(&double_op);
+  __ sqrtsd(XMM0, XMM1);
+  const Class& double_class = Class::ZoneHandle(
+      Isolate::Current()->object_store()->double_class());
+  AssemblerMacros::TryAllocate(assembler,
+                               double_class,
+                               RBX,  // Class register.
+                               &fall_through,
+                               RAX);  // Result register.
+  __ movsd(FieldAddress(RAX, Double::value_offset()), XMM0);
+  __ ret();
+  __ Bind(&is_smi);
+  __ SmiUntag(RAX);
+  __ cvtsi2sd(XMM1, RAX);
+  __ jmp(&double_op);
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+// Identity comparison.
+static bool Object_equal(Assembler* assembler) {
+  Label is_true;
+  const Bool& bool_true = Bool::ZoneHandle(Bool::True());
+  const Bool& bool_false = Bool::ZoneHandle(Bool::False());
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));
+  __ cmpq(RAX, Address(RSP, + 2 * kWordSize));
+  __ j(EQUAL, &is_true, Assembler::kNearJump);
+  __ LoadObject(RAX, bool_false);
+  __ ret();
+  __ Bind(&is_true);
+  __ LoadObject(RAX, bool_true);
+  __ ret();
+  return true;
+}
+
+
+static const char* kFixedSizeArrayIteratorClassName = "FixedSizeArrayIterator";
+
+
+// Class 'FixedSizeArrayIterator':
+//   T next() {
+//     return _array[_pos++];
+//   }
+// Intrinsify: return _array[_pos++];
+// TODO(srdjan): Throw a 'NoMoreElementsException' exception if the iterator
+// has no more elements.
+static bool FixedSizeArrayIterator_next(Assembler* assembler) {
+  Label fall_through;
+  intptr_t array_offset =
+      GetOffsetForField(kFixedSizeArrayIteratorClassName, "_array");
+  intptr_t pos_offset =
+      GetOffsetForField(kFixedSizeArrayIteratorClassName, "_pos");
+  ASSERT(array_offset >= 0 && pos_offset >= 0);
+  // Receiver is not NULL.
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));  // Receiver.
+  __ movq(RBX, FieldAddress(RAX, pos_offset));  // Field _pos.
+  // '_pos' cannot be greater than array length and therefore is always Smi.
+#if defined(DEBUG)
+  Label pos_ok;
+  __ testq(RBX, Immediate(kSmiTagMask));
+  __ j(ZERO, &pos_ok, Assembler::kNearJump);
+  __ Stop("pos must be Smi");
+  __ Bind(&pos_ok);
+#endif
+  // Check that we are not trying to call 'next' when 'hasNext' is false.
+  __ movq(RAX, FieldAddress(RAX, array_offset));  // Field _array.
+  __ cmpq(RBX, FieldAddress(RAX, Array::length_offset()));  // Range check.
+  __ j(ABOVE_EQUAL, &fall_through, Assembler::kNearJump);
+
+  // RBX is Smi, i.e, times 2.
+  ASSERT(kSmiTagShift == 1);
+  __ movq(R12, FieldAddress(RAX, RBX, TIMES_4, sizeof(RawArray)));  // Result.
+  const Immediate value = Immediate(reinterpret_cast<intptr_t>(Smi::New(1)));
+  __ addq(RBX, value);  // _pos++.
+  __ j(OVERFLOW, &fall_through, Assembler::kNearJump);
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));  // Receiver.
+  __ movq(FieldAddress(RAX, pos_offset), RBX);  // Store _pos.
+  __ movq(RAX, R12);
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+// Class 'FixedSizeArrayIterator':
+//   bool hasNext() {
+//     return _length > _pos;
+//   }
+static bool FixedSizeArrayIterator_hasNext(Assembler* assembler) {
+  Label fall_through, is_true;
+  const Bool& bool_true = Bool::ZoneHandle(Bool::True());
+  const Bool& bool_false = Bool::ZoneHandle(Bool::False());
+  intptr_t length_offset =
+      GetOffsetForField(kFixedSizeArrayIteratorClassName, "_length");
+  intptr_t pos_offset =
+      GetOffsetForField(kFixedSizeArrayIteratorClassName, "_pos");
+  __ movq(RAX, Address(RSP, + 1 * kWordSize));     // Receiver.
+  __ movq(RBX, FieldAddress(RAX, length_offset));  // Field _length.
+  __ movq(RAX, FieldAddress(RAX, pos_offset));    // Field _pos.
+  __ movq(R12, RAX);
+  __ orq(R12, RBX);
+  __ testq(R12, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &fall_through, Assembler::kNearJump);  // Non-smi _length.
+  __ cmpq(RBX, RAX);     // _length > _pos.
+  __ j(GREATER, &is_true, Assembler::kNearJump);
+  __ LoadObject(RAX, bool_false);
+  __ ret();
+  __ Bind(&is_true);
+  __ LoadObject(RAX, bool_true);
+  __ ret();
+  __ Bind(&fall_through);
+  return false;
+}
+
+
+#undef __
+
+
 bool Intrinsifier::Intrinsify(const Function& function, Assembler* assembler) {
+  if (!FLAG_intrinsify) return false;
+  const char* function_name = String::Handle(function.name()).ToCString();
+  const Class& function_class = Class::Handle(function.owner());
+  const char* class_name = String::Handle(function_class.Name()).ToCString();
+#define FIND_INTRINSICS(test_class_name, test_function_name, destination)      \
+  if ((strcmp(#test_function_name, function_name) == 0) &&                     \
+      (strcmp(#test_class_name, class_name) == 0)) {                           \
+    return destination(assembler);                                             \
+  }                                                                            \
+
+INTRINSIC_LIST(FIND_INTRINSICS);
+#undef FIND_INTRINSICS
   return false;
 }
 
@@ -9,10 +9,13 @@
 #include "vm/assert.h"
 #include "vm/bigint_store.h"
 #include "vm/code_index_table.h"
+#include "vm/compiler.h"
 #include "vm/compiler_stats.h"
 #include "vm/dart_api_state.h"
 #include "vm/debuginfo.h"
 #include "vm/heap.h"
+#include "vm/heap_histogram.h"
+#include "vm/heap_snapshot.h"
 #include "vm/message_queue.h"
 #include "vm/object_store.h"
 #include "vm/parser.h"
@@ -28,11 +31,16 @@ namespace dart {
 
 DEFINE_FLAG(bool, report_invocation_count, false,
     "Count function invocations and report.");
+DEFINE_FLAG(bool, print_heap_histogram, false,
+    "Print the number and size of the instances of each class at isolate "
+    "shutdown.");
 DECLARE_FLAG(bool, generate_gdb_symbols);
 
 
 Isolate::Isolate()
-    : store_buffer_(),
+    : store_buffer_block_(),
+      store_buffer_(),
+      marking_buffer_block_(),
       message_queue_(NULL),
       post_message_callback_(NULL),
       close_port_callback_(NULL),
@@ -195,7 +203,12 @@ void Isolate::PrintInvokedFunctions() {
 void Isolate::Shutdown() {
   ASSERT(this == Isolate::Current());
   ASSERT(top_resource_ == NULL);
-  ASSERT((heap_ == NULL) || heap_->Verify());
+#if defined(DEBUG)
+  if (heap_ != NULL) {
+    heap_->CompleteSweeping();
+    heap_->Verify();
+  }
+#endif  // defined(DEBUG)
 
   // Close all the ports owned by this isolate.
   PortMap::ClosePorts();
@@ -209,6 +222,12 @@ void Isolate::Shutdown() {
     PrintInvokedFunctions();
   }
   CompilerStats::Print();
+  if (FLAG_print_heap_histogram && (heap_ != NULL)) {
+    Zone zone;
+    HandleScope handle_scope;
+    HeapHistogram histogram(heap_);
+    histogram.Print();
+  }
   if (FLAG_generate_gdb_symbols) {
     DebugInfo::UnregisterAllSections();
   }
@@ -251,39 +270,69 @@ void Isolate::StandardRunLoop() {
 }
 
 
+void Isolate::RunBetweenMessages() {
+  // Between messages no Dart code is running, write a heap snapshot if one
+  // has been requested meanwhile, compact a fragmented old space and
+  // optimize the functions which got hot.
+  HeapSnapshotWriter::HandleRequest();
+  heap()->CompactOldSpaceIfFragmented();
+  Compiler::CompileQueuedFunctions();
+}
+
+
 void Isolate::VisitObjectPointers(ObjectPointerVisitor* visitor,
                                   bool validate_frames) {
   ASSERT(visitor != NULL);
-
-  // Visit objects in the object store.
-  object_store()->VisitObjectPointers(visitor);
-
-  // Visit objects in per isolate stubs.
-  StubCode::VisitObjectPointers(visitor);
-
-  // Visit objects in zones.
-  current_zone()->VisitObjectPointers(visitor);
-
-  // Iterate over all the stack frames and visit objects on the stack.
-  StackFrameIterator frames_iterator(validate_frames);
-  StackFrame* frame = frames_iterator.NextFrame();
-  while (frame != NULL) {
-    frame->VisitObjectPointers(visitor);
-    frame = frames_iterator.NextFrame();
+  for (intptr_t i = 0; i < kNumRootSets; i++) {
+    VisitRootSet(static_cast<RootSet>(i), visitor, validate_frames);
   }
+}
 
-  // Visit the dart api state for all local and persistent handles.
-  if (api_state() != NULL) {
-    api_state()->VisitObjectPointers(visitor);
-  }
 
-  // Visit all objects in the code index table.
-  if (code_index_table() != NULL) {
-    code_index_table()->VisitObjectPointers(visitor);
+void Isolate::VisitRootSet(RootSet root_set,
+                           ObjectPointerVisitor* visitor,
+                           bool validate_frames) {
+  ASSERT(visitor != NULL);
+  switch (root_set) {
+    case kObjectStoreRoots:
+      // Visit objects in the object store.
+      object_store()->VisitObjectPointers(visitor);
+      break;
+    case kStubCodeRoots:
+      // Visit objects in per isolate stubs.
+      StubCode::VisitObjectPointers(visitor);
+      break;
+    case kZoneRoots:
+      // Visit objects in zones.
+      current_zone()->VisitObjectPointers(visitor);
+      break;
+    case kStackRoots: {
+      // Iterate over all the stack frames and visit objects on the stack.
+      StackFrameIterator frames_iterator(validate_frames);
+      StackFrame* frame = frames_iterator.NextFrame();
+      while (frame != NULL) {
+        frame->VisitObjectPointers(visitor);
+        frame = frames_iterator.NextFrame();
+      }
+      // Visit the top context which is stored in the isolate.
+      visitor->VisitPointer(reinterpret_cast<RawObject**>(&top_context_));
+      break;
+    }
+    case kApiRoots:
+      // Visit the dart api state for all local and persistent handles.
+      if (api_state() != NULL) {
+        api_state()->VisitObjectPointers(visitor);
+      }
+      break;
+    case kCodeIndexRoots:
+      // Visit all objects in the code index table.
+      if (code_index_table() != NULL) {
+        code_index_table()->VisitObjectPointers(visitor);
+      }
+      break;
+    default:
+      UNREACHABLE();
   }
-
-  // Visit the top context which is stored in the isolate.
-  visitor->VisitPointer(reinterpret_cast<RawObject**>(&top_context_));
 }
 
 }  // namespace dart
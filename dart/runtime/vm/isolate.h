@@ -44,7 +44,37 @@ class Isolate {
   // Visit all object pointers.
   void VisitObjectPointers(ObjectPointerVisitor* visitor, bool validate_frames);
 
-  StoreBufferBlock* store_buffer() { return &store_buffer_; }
+  // The roots of the isolate are split into sets which can be visited
+  // independently, for example by the tasks of a parallel scavenge. The stub
+  // and stack roots are found through the current isolate and can only be
+  // visited on the thread of the isolate.
+  enum RootSet {
+    kObjectStoreRoots,
+    kStubCodeRoots,
+    kZoneRoots,
+    kStackRoots,
+    kApiRoots,
+    kCodeIndexRoots,
+    kNumRootSets
+  };
+  static bool NeedsIsolateThread(RootSet root_set) {
+    return (root_set == kStubCodeRoots) || (root_set == kStackRoots);
+  }
+  void VisitRootSet(RootSet root_set,
+                    ObjectPointerVisitor* visitor,
+                    bool validate_frames);
+
+  StoreBufferBlock* store_buffer_block() { return &store_buffer_block_; }
+  static intptr_t store_buffer_block_offset() {
+    return OFFSET_OF(Isolate, store_buffer_block_);
+  }
+
+  StoreBuffer* store_buffer() { return &store_buffer_; }
+
+  MarkingBufferBlock* marking_buffer_block() { return &marking_buffer_block_; }
+  static intptr_t marking_buffer_block_offset() {
+    return OFFSET_OF(Isolate, marking_buffer_block_);
+  }
 
   Dart_PostMessageCallback post_message_callback() const {
     return post_message_callback_;
@@ -222,6 +252,10 @@ class Isolate {
 
   void StandardRunLoop();
 
+  // Runs the work deferred until no Dart code of the isolate is running,
+  // called by Dart_HandleMessage once the message is handled.
+  void RunBetweenMessages();
+
   intptr_t ast_node_id() const { return ast_node_id_; }
   void set_ast_node_id(int value) { ast_node_id_ = value; }
 
@@ -235,7 +269,9 @@ class Isolate {
   static const uword kStackSizeBuffer = (128 * KB);
   static const uword kDefaultStackSize = (1 * MB);
 
-  StoreBufferBlock store_buffer_;
+  StoreBufferBlock store_buffer_block_;
+  StoreBuffer store_buffer_;
+  MarkingBufferBlock marking_buffer_block_;
   Monitor* monitor_;
   MessageQueue* message_queue_;
   Dart_PostMessageCallback post_message_callback_;
@@ -0,0 +1,67 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_LOCATIONS_H_
+#define VM_LOCATIONS_H_
+
+#include "vm/allocation.h"
+#include "vm/assembler.h"
+
+namespace dart {
+
+// The location of an SSA value in optimized code, assigned by the register
+// allocator: a CPU register or a spill slot of the frame.
+class Location : public ValueObject {
+ public:
+  enum Kind {
+    kInvalid,
+    kRegister,
+    kStackSlot
+  };
+
+  Location() : kind_(kInvalid), payload_(0) { }
+  Location(const Location& other)
+      : ValueObject(), kind_(other.kind_), payload_(other.payload_) { }
+  Location& operator=(const Location& other) {
+    kind_ = other.kind_;
+    payload_ = other.payload_;
+    return *this;
+  }
+
+  static Location RegisterLocation(Register reg) {
+    return Location(kRegister, static_cast<intptr_t>(reg));
+  }
+  static Location StackSlot(intptr_t index) {
+    ASSERT(index >= 0);
+    return Location(kStackSlot, index);
+  }
+
+  Kind kind() const { return kind_; }
+  bool IsInvalid() const { return kind_ == kInvalid; }
+  bool IsRegister() const { return kind_ == kRegister; }
+  bool IsStackSlot() const { return kind_ == kStackSlot; }
+
+  Register reg() const {
+    ASSERT(IsRegister());
+    return static_cast<Register>(payload_);
+  }
+  intptr_t stack_index() const {
+    ASSERT(IsStackSlot());
+    return payload_;
+  }
+
+  bool Equals(const Location& other) const {
+    return (kind_ == other.kind_) && (payload_ == other.payload_);
+  }
+
+ private:
+  Location(Kind kind, intptr_t payload) : kind_(kind), payload_(payload) { }
+
+  Kind kind_;
+  intptr_t payload_;
+};
+
+}  // namespace dart
+
+#endif  // VM_LOCATIONS_H_
@@ -7,6 +7,7 @@
 
 #include "vm/allocation.h"
 #include "vm/assembler.h"
+#include "vm/exceptions.h"
 #include "vm/native_arguments.h"
 #include "vm/verifier.h"
 
@@ -43,6 +44,7 @@ typedef void (*NativeFunction)(NativeArguments* arguments);
       Zone zone;                                                               \
       HANDLESCOPE();                                                           \
       DN_Helper##name(arguments);                                              \
+      Exceptions::ThrowPendingOutOfMemory();                                   \
     }                                                                          \
     VERIFY_ON_TRANSITION;                                                      \
   }                                                                            \
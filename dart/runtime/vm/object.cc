@@ -16,6 +16,7 @@
 #include "vm/class_finalizer.h"
 #include "vm/dart.h"
 #include "vm/debuginfo.h"
+#include "vm/exceptions.h"
 #include "vm/growable_array.h"
 #include "vm/heap.h"
 #include "vm/ic_data.h"
@@ -72,9 +73,12 @@ RawClass* Object::instructions_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
 RawClass* Object::pc_descriptors_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
 RawClass* Object::exception_handlers_class_ =
     reinterpret_cast<RawClass*>(RAW_NULL);
+RawClass* Object::stackmap_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
 RawClass* Object::context_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
 RawClass* Object::context_scope_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
 RawClass* Object::api_failure_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
+RawClass* Object::free_list_element_class_ =
+    reinterpret_cast<RawClass*>(RAW_NULL);
 #undef RAW_NULL
 
 int Object::GetSingletonClassIndex(const RawClass* raw_class) {
@@ -121,6 +125,8 @@ int Object::GetSingletonClassIndex(const RawClass* raw_class) {
     return kPcDescriptorsClass;
   } else if (raw_class == exception_handlers_class()) {
     return kExceptionHandlersClass;
+  } else if (raw_class == stackmap_class()) {
+    return kStackmapClass;
   } else if (raw_class == context_class()) {
     return kContextClass;
   } else if (raw_class == context_scope_class()) {
@@ -156,6 +162,7 @@ RawClass* Object::GetSingletonClass(int index) {
     case kInstructionsClass: return instructions_class();
     case kPcDescriptorsClass: return pc_descriptors_class();
     case kExceptionHandlersClass: return exception_handlers_class();
+    case kStackmapClass: return stackmap_class();
     case kContextClass: return context_class();
     case kContextScopeClass: return context_scope_class();
     case kApiFailureClass: return api_failure_class();
@@ -189,6 +196,7 @@ const char* Object::GetSingletonClassName(int index) {
     case kInstructionsClass: return "Instructions";
     case kPcDescriptorsClass: return "PcDescriptors";
     case kExceptionHandlersClass: return "ExceptionHandlers";
+    case kStackmapClass: return "Stackmap";
     case kContextClass: return "Context";
     case kContextScopeClass: return "ContextScope";
     case kApiFailureClass: return "ApiFailure";
@@ -322,6 +330,9 @@ void Object::InitOnce() {
   cls = Class::New<ExceptionHandlers>();
   exception_handlers_class_ = cls.raw();
 
+  cls = Class::New<Stackmap>();
+  stackmap_class_ = cls.raw();
+
   cls = Class::New<Context>();
   context_class_ = cls.raw();
 
@@ -331,6 +342,13 @@ void Object::InitOnce() {
   cls = Class::New<ApiFailure>();
   api_failure_class_ = cls.raw();
 
+  // Free list elements are not objects, but heap walkers treat them like
+  // variable sized objects. Their size is stored in the element itself.
+  cls = Class::New<Instance>();
+  cls.set_instance_kind(kFreeListElement);
+  cls.set_instance_size(0);
+  free_list_element_class_ = cls.raw();
+
   ASSERT(class_class() != null_);
 }
 
@@ -689,6 +707,16 @@ RawObject* Object::Allocate(const Class& cls,
 
   // TODO(iposva): Get a proper halt instruction from the assembler.
   uword address = heap->Allocate(size, space);
+  if (address == 0) {
+    // Callers, e.g. the compiler, may not be able to unwind from here. The
+    // allocation is served from the reserve instead and the exception thrown
+    // on return to Dart code.
+    address = heap->AllocateFromReserve(
+        size, (space == Heap::kExecutable) ? Heap::kExecutable : Heap::kOld);
+    if (address == 0) {
+      FATAL("Exhausted heap space.");
+    }
+  }
   NoGCScope no_gc;
   InitializeObject(address, size);
   RawObject* raw_obj = reinterpret_cast<RawObject*>(address + kHeapObjectTag);
@@ -769,6 +797,7 @@ RawClass* Class::New() {
   result.raw_ptr()->type_arguments_instance_field_offset_ = kNoTypeArguments;
   result.raw_ptr()->num_constants_ = 0;
   result.raw_ptr()->num_native_fields_ = 0;
+  result.InitPretenuring();
   result.InitEmptyFields();
   return result.raw();
 }
@@ -1005,6 +1034,7 @@ RawClass* Class::New(const String& name, const Script& script) {
   result.raw_ptr()->type_arguments_instance_field_offset_ = kNoTypeArguments;
   result.raw_ptr()->num_constants_ = 0;
   result.raw_ptr()->num_native_fields_ = 0;
+  result.InitPretenuring();
   result.InitEmptyFields();
   return result.raw();
 }
@@ -1211,6 +1241,22 @@ void Class::set_allocation_stub(const Code& value) const {
 }
 
 
+void Class::InitPretenuring() const {
+  raw_ptr()->is_pretenured_ = 0;
+  raw_ptr()->allocated_count_ = 0;
+  raw_ptr()->survived_count_ = 0;
+}
+
+
+void Class::CountPretenuredAllocation() const {
+  ASSERT(is_pretenured());
+  raw_ptr()->allocated_count_++;
+  if (raw_ptr()->allocated_count_ >= kPretenuredAllocationLimit) {
+    InitPretenuring();
+  }
+}
+
+
 bool Class::IsObjectClass() const {
   return raw() == Type::Handle(Type::ObjectType()).type_class();
 }
@@ -2909,6 +2955,7 @@ RawFunction* Function::New(const String& name,
   result.set_invocation_counter(0);
   result.set_deoptimization_counter(0);
   result.set_is_optimizable(true);
+  result.set_is_queued_for_optimization(false);
   return result.raw();
 }
 
@@ -3897,9 +3944,11 @@ RawLibrary* Library::New() {
 RawLibrary* Library::NewLibraryHelper(const String& url,
                                       bool import_core_lib) {
   const Library& result = Library::Handle(Library::New());
-  result.raw_ptr()->name_ = url.raw();
-  result.raw_ptr()->url_ = url.raw();
-  result.raw_ptr()->private_key_ = Scanner::AllocatePrivateKey(result);
+  result.StorePointer(&result.raw_ptr()->name_, url.raw());
+  result.StorePointer(&result.raw_ptr()->url_, url.raw());
+  const String& private_key =
+      String::Handle(Scanner::AllocatePrivateKey(result));
+  result.StorePointer(&result.raw_ptr()->private_key_, private_key.raw());
   result.raw_ptr()->dictionary_ = Array::Empty();
   result.raw_ptr()->anonymous_classes_ = Array::Empty();
   result.raw_ptr()->num_anonymous_ = 0;
@@ -4193,6 +4242,7 @@ const char* PcDescriptors::KindAsStr(intptr_t index) const {
     case (PcDescriptors::kDeopt) : return "deopt";
     case (PcDescriptors::kPatchCode) : return "patch";
     case (PcDescriptors::kIcCall) : return "ic-call";
+    case (PcDescriptors::kFuncCall) : return "fn-call";
     case (PcDescriptors::kOther) : return "other";
   }
   UNREACHABLE();
@@ -4297,6 +4347,71 @@ const char* ExceptionHandlers::ToCString() const {
 }
 
 
+intptr_t Stackmap::Length() const {
+  return Smi::Value(raw_ptr()->length_);
+}
+
+
+void Stackmap::SetLength(intptr_t value) const {
+  // This is only safe because we create a new Smi, which does not cause
+  // heap allocation.
+  raw_ptr()->length_ = Smi::New(value);
+}
+
+
+bool Stackmap::IsObject(intptr_t index) const {
+  ASSERT((index >= 0) && (index < Length()));
+  uint8_t byte = raw_ptr()->data_[index / kBitsPerByte];
+  return (byte & (1 << (index % kBitsPerByte))) != 0;
+}
+
+
+void Stackmap::SetIsObject(intptr_t index, bool value) const {
+  ASSERT((index >= 0) && (index < Length()));
+  uint8_t* byte_addr = &raw_ptr()->data_[index / kBitsPerByte];
+  uint8_t bit = 1 << (index % kBitsPerByte);
+  if (value) {
+    *byte_addr |= bit;
+  } else {
+    *byte_addr &= ~bit;
+  }
+}
+
+
+RawStackmap* Stackmap::New(uword pc, intptr_t length) {
+  ASSERT(length >= 0);
+  const Class& cls = Class::Handle(Object::stackmap_class());
+  Stackmap& result = Stackmap::Handle();
+  {
+    uword size = Stackmap::InstanceSize(length);
+    RawObject* raw = Object::Allocate(cls, size, Heap::kOld);
+    NoGCScope no_gc;
+    result ^= raw;
+    result.SetLength(length);
+    result.SetPC(pc);
+    // The object was initialized with null values, clear the bitmap.
+    memset(result.raw_ptr()->data_,
+           0,
+           (length + kBitsPerByte - 1) / kBitsPerByte);
+  }
+  return result.raw();
+}
+
+
+const char* Stackmap::ToCString() const {
+  const char* kFormat = "0x%x: ";
+  intptr_t len = OS::SNPrint(NULL, 0, kFormat, PC()) + Length() + 1;
+  char* buffer = reinterpret_cast<char*>(
+      Isolate::Current()->current_zone()->Allocate(len));
+  intptr_t index = OS::SNPrint(buffer, len, kFormat, PC());
+  for (intptr_t i = 0; i < Length(); i++) {
+    buffer[index++] = IsObject(i) ? '1' : '0';
+  }
+  buffer[index] = '\0';
+  return buffer;
+}
+
+
 RawCode* Code::New(int pointer_offsets_length) {
   const Class& cls = Class::Handle(Object::code_class());
   Code& result = Code::Handle();
@@ -4365,11 +4480,22 @@ RawCode* Code::FinalizeCode(const char* name, Assembler* assembler) {
     // Set pointer offsets list in Code object and resolve all handles in
     // the instruction stream to raw objects.
     ASSERT(code.pointer_offsets_length() == pointer_offsets.length());
+    bool has_new_pointers = false;
     for (int i = 0; i < pointer_offsets.length(); i++) {
       int offset_in_instrs = pointer_offsets[i];
       code.SetPointerOffsetAt(i, offset_in_instrs);
       const Object* object = region.Load<const Object*>(offset_in_instrs);
-      region.Store<RawObject*>(offset_in_instrs, object->raw());
+      RawObject* raw_obj = object->raw();
+      if (raw_obj->IsHeapObject() && raw_obj->IsNewObject()) {
+        has_new_pointers = true;
+      }
+      region.Store<RawObject*>(offset_in_instrs, raw_obj);
+    }
+    // The embedded pointers are visited through the code object, remember it
+    // if any of them points into new space.
+    if (has_new_pointers) {
+      uword ptr = reinterpret_cast<uword>(code.raw());
+      Isolate::Current()->store_buffer_block()->AddPointer(ptr);
     }
 
     // Hook up Code and Instruction objects.
@@ -4390,6 +4516,17 @@ void Code::set_ic_data(const Array& ic_data) const {
   StorePointer(&raw_ptr()->ic_data_, ic_data.raw());
 }
 
+
+RawArray* Code::stackmaps() const {
+  return raw_ptr()->stackmaps_;
+}
+
+
+void Code::set_stackmaps(const Array& maps) const {
+  StorePointer(&raw_ptr()->stackmaps_, maps.raw());
+}
+
+
 intptr_t Code::GetTokenIndexOfPC(uword pc) const {
   intptr_t token_index = -1;
   const PcDescriptors& descriptors = PcDescriptors::Handle(pc_descriptors());
@@ -6517,12 +6654,12 @@ RawClosure* Closure::New(const Function& function,
 
 
 void Closure::set_context(const Context& value) const {
-  raw_ptr()->context_ = value.raw();
+  StorePointer(&raw_ptr()->context_, value.raw());
 }
 
 
 void Closure::set_function(const Function& value) const {
-  raw_ptr()->function_ = value.raw();
+  StorePointer(&raw_ptr()->function_, value.raw());
 }
 
 
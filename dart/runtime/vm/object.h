@@ -12,6 +12,7 @@
 #include "vm/heap.h"
 #include "vm/isolate.h"
 #include "vm/os.h"
+#include "vm/pages.h"
 #include "vm/raw_object.h"
 #include "vm/scanner.h"
 #include "vm/utils.h"
@@ -137,6 +138,7 @@ class Object {
     kInstructionsClass,
     kPcDescriptorsClass,
     kExceptionHandlersClass,
+    kStackmapClass,
     kContextClass,
     kContextScopeClass,
     kApiFailureClass,
@@ -237,9 +239,13 @@ CLASS_LIST_NO_OBJECT(DEFINE_CLASS_TESTER);
   static RawClass* exception_handlers_class() {
     return exception_handlers_class_;
   }
+  static RawClass* stackmap_class() { return stackmap_class_; }
   static RawClass* context_class() { return context_class_; }
   static RawClass* context_scope_class() { return context_scope_class_; }
   static RawClass* api_failure_class() { return api_failure_class_; }
+  static RawClass* free_list_element_class() {
+    return free_list_element_class_;
+  }
 
   static int GetSingletonClassIndex(const RawClass* raw_class);
   static RawClass* GetSingletonClass(int index);
@@ -283,12 +289,29 @@ CLASS_LIST_NO_OBJECT(DEFINE_CLASS_TESTER);
 
   template<typename type> void StorePointer(type* addr, type value) const {
     ASSERT(Isolate::Current()->no_gc_scope_depth() == 0);
-    // TODO(iposva): Implement real store barrier here.
+    // While old space is marked concurrently, log the old value being
+    // overwritten in an old object.
+    if (raw()->IsOldObject()) {
+      MarkingBufferBlock* block = Isolate::Current()->marking_buffer_block();
+      if (block->is_marking()) {
+        RawObject* old_value = *addr;
+        if (old_value->IsHeapObject() && old_value->IsOldObject()) {
+          block->AddPointer(reinterpret_cast<uword>(old_value));
+        }
+      }
+    }
     *addr = value;
     // Filter stores based on source and target.
-    if (raw()->IsOldObject() && value->IsNewObject()) {
-      uword ptr = reinterpret_cast<uword>(addr);
-      Isolate::Current()->store_buffer()->AddPointer(ptr);
+    if (value->IsHeapObject() && value->IsNewObject() &&
+        raw()->IsOldObject()) {
+      // Large arrays only remember the card of the updated slot.
+      HeapPage* page = HeapPage::Of(raw());
+      if (page->card_table() != NULL) {
+        page->RememberCard(reinterpret_cast<RawObject**>(addr));
+        return;
+      }
+      uword ptr = reinterpret_cast<uword>(raw());
+      Isolate::Current()->store_buffer_block()->AddPointer(ptr);
     }
   }
 
@@ -330,9 +353,11 @@ CLASS_LIST_NO_OBJECT(DEFINE_CLASS_TESTER);
   static RawClass* instructions_class_;  // Class of the Instructions vm object.
   static RawClass* pc_descriptors_class_;  // Class of PcDescriptors vm object.
   static RawClass* exception_handlers_class_;  // Class of ExceptionHandlers.
+  static RawClass* stackmap_class_;  // Class of Stackmap vm object.
   static RawClass* context_class_;  // Class of the Context vm object.
   static RawClass* context_scope_class_;  // Class of ContextScope vm object.
   static RawClass* api_failure_class_;  // Class of ApiFailure.
+  static RawClass* free_list_element_class_;  // Class of free list elements.
 
   friend class Class;
 
@@ -569,6 +594,21 @@ class Class : public Object {
   }
   void set_allocation_stub(const Code& value) const;
 
+  // The allocation stub of a pretenured class allocates its instances in old
+  // space, see Scavenger::UpdatePretenuring.
+  bool is_pretenured() const { return raw_ptr()->is_pretenured_ != 0; }
+  static intptr_t is_pretenured_offset() {
+    return OFFSET_OF(RawClass, is_pretenured_);
+  }
+  // Count an instance allocated in old space because the class is
+  // pretenured. Once in a while the class goes back to allocating in new
+  // space, so that the survival of its instances is sampled again. The
+  // allocation stub counts the instances it allocates inline.
+  void CountPretenuredAllocation() const;
+  static intptr_t allocated_count_offset() {
+    return OFFSET_OF(RawClass, allocated_count_);
+  }
+
   void Finalize() const;
 
   // Allocate a class used for VM internal objects.
@@ -613,6 +653,11 @@ class Class : public Object {
   void set_num_constants(intptr_t value) const;
   intptr_t num_constants() const;
 
+  // Number of instances allocated in old space before a pretenured class is
+  // sampled again.
+  static const intptr_t kPretenuredAllocationLimit = 100000;
+  void InitPretenuring() const;
+
   void CalculateFieldOffsets() const;
 
   // Check the subtype or assignability relationship.
@@ -1177,6 +1222,15 @@ class Function : public Object {
   }
   void set_is_optimizable(bool value) const;
 
+  // Whether the function is in the optimization queue of the isolate, see
+  // Compiler::QueueOptimizedFunction.
+  bool is_queued_for_optimization() const {
+    return raw_ptr()->is_queued_for_optimization_;
+  }
+  void set_is_queued_for_optimization(bool value) const {
+    raw_ptr()->is_queued_for_optimization_ = value;
+  }
+
   intptr_t NumberOfParameters() const;
 
   bool AreValidArgumentCounts(int num_arguments, int num_named_arguments) const;
@@ -1646,6 +1700,7 @@ class PcDescriptors : public Object {
     kDeopt = 0,  // Deoptimization cotinuation point.
     kPatchCode,  // Buffer for patching code entry.
     kIcCall,     // IC call.
+    kFuncCall,   // Patchable static call to a Dart function.
     kOther
   };
 
@@ -1773,6 +1828,40 @@ class ExceptionHandlers : public Object {
 };
 
 
+// Stackmap describes the fixed slots of a Dart frame (copied parameters and
+// locals) at the return address of one call site. Slot i is at fp[-1 - i].
+// Slots which are not described by the map, i.e. the expression stack and the
+// outgoing arguments, always hold objects.
+class Stackmap : public Object {
+ public:
+  intptr_t Length() const;
+
+  uword PC() const { return raw_ptr()->pc_; }
+  void SetPC(uword value) const { raw_ptr()->pc_ = value; }
+
+  bool IsObject(intptr_t index) const;
+  void SetIsObject(intptr_t index, bool value) const;
+
+  static intptr_t InstanceSize() {
+    ASSERT(sizeof(RawStackmap) == OFFSET_OF(RawStackmap, data_));
+    return 0;
+  }
+  static intptr_t InstanceSize(intptr_t length) {
+    return RoundedAllocationSize(sizeof(RawStackmap) +
+                                 ((length + kBitsPerByte - 1) / kBitsPerByte));
+  }
+
+  // Allocate a stackmap of 'length' slots, none of which holds an object.
+  static RawStackmap* New(uword pc, intptr_t length);
+
+ private:
+  void SetLength(intptr_t value) const;
+
+  HEAP_OBJECT_IMPLEMENTATION(Stackmap, Object);
+  friend class Class;
+};
+
+
 class Code : public Object {
  public:
   RawInstructions* instructions() const { return raw_ptr()->instructions_; }
@@ -1815,6 +1904,10 @@ class Code : public Object {
     StorePointer(&raw_ptr()->exception_handlers_, handlers.raw());
   }
 
+  // Array of Stackmap objects sorted by pc, null if the code has no maps.
+  RawArray* stackmaps() const;
+  void set_stackmaps(const Array& maps) const;
+
   RawFunction* function() const {
     return raw_ptr()->function_;
   }
@@ -2066,7 +2159,7 @@ class Instance : public Object {
   }
 
   void SetField(const Field& field, const Object& value) const {
-    *FieldAddr(field) = value.raw();
+    StorePointer(FieldAddr(field), value.raw());
   }
 
   RawType* GetType() const;
@@ -2124,7 +2217,7 @@ class Instance : public Object {
                                        + sizeof(RawObject));
   }
   void SetFieldAtOffset(intptr_t offset, const Object& value) const {
-    *FieldAddrAtOffset(offset) = value.raw();
+    StorePointer(FieldAddrAtOffset(offset), value.raw());
   }
   bool IsValidFieldOffset(int offset) const;
 
@@ -2680,14 +2773,14 @@ class Array : public Instance {
   }
   void SetAt(intptr_t index, const Object& value) const {
     // TODO(iposva): Add storing NoGCScope.
-    *ObjectAddr(index) = value.raw();
+    StorePointer(ObjectAddr(index), value.raw());
   }
 
   virtual RawTypeArguments* GetTypeArguments() const {
     return raw_ptr()->type_arguments_;
   }
   virtual void SetTypeArguments(const TypeArguments& value) const {
-    raw_ptr()->type_arguments_ = value.raw();
+    StorePointer(&raw_ptr()->type_arguments_, value.raw());
   }
 
   virtual bool Equals(const Instance& other) const;
@@ -2776,7 +2869,7 @@ class Closure : public Instance {
     return raw_ptr()->type_arguments_;
   }
   virtual void SetTypeArguments(const TypeArguments& value) const {
-    raw_ptr()->type_arguments_ = value.raw();
+    StorePointer(&raw_ptr()->type_arguments_, value.raw());
   }
   static intptr_t type_arguments_offset() {
     return OFFSET_OF(RawClosure, type_arguments_);
@@ -2785,7 +2878,7 @@ class Closure : public Instance {
   // TODO(iposva): Remove smrck support once mapping to arbitrary is available.
   RawInteger* smrck() const { return raw_ptr()->smrck_; }
   void set_smrck(const Integer& smrck) const {
-    raw_ptr()->smrck_ = smrck.raw();
+    StorePointer(&raw_ptr()->smrck_, smrck.raw());
   }
   static intptr_t smrck_offset() { return OFFSET_OF(RawClosure, smrck_); }
 
@@ -0,0 +1,70 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_OBJECT_STACK_H_
+#define VM_OBJECT_STACK_H_
+
+#include <stdlib.h>
+
+#include "vm/allocation.h"
+#include "vm/assert.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// Forward declarations.
+class RawObject;
+
+// A simple growable stack of raw objects used as a work list by the garbage
+// collectors. It is allocated outside of the zone as collections can happen
+// at any allocation.
+class ObjectStack : public ValueObject {
+ public:
+  ObjectStack() : data_(NULL), length_(0), capacity_(0) {
+    Resize(kInitialCapacity);
+  }
+  ~ObjectStack() {
+    free(data_);
+  }
+
+  bool IsEmpty() const { return length_ == 0; }
+  intptr_t length() const { return length_; }
+
+  void Push(RawObject* raw_obj) {
+    if (length_ == capacity_) {
+      Resize(2 * capacity_);
+    }
+    data_[length_++] = raw_obj;
+  }
+
+  RawObject* Pop() {
+    ASSERT(!IsEmpty());
+    return data_[--length_];
+  }
+
+ private:
+  static const intptr_t kInitialCapacity = 1024;
+
+  void Resize(intptr_t new_capacity) {
+    ASSERT(new_capacity > capacity_);
+    RawObject** new_data = reinterpret_cast<RawObject**>(
+        realloc(reinterpret_cast<void*>(data_),
+                new_capacity * sizeof(RawObject*)));
+    if (new_data == NULL) {
+      FATAL("Out of memory growing the object stack.");
+    }
+    data_ = new_data;
+    capacity_ = new_capacity;
+  }
+
+  RawObject** data_;
+  intptr_t length_;
+  intptr_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(ObjectStack);
+};
+
+}  // namespace dart
+
+#endif  // VM_OBJECT_STACK_H_
@@ -41,8 +41,11 @@ ObjectStore::ObjectStore()
     root_library_(Library::null()),
     registered_libraries_(Library::null()),
     pending_classes_(Array::null()),
+    optimization_queue_(Array::null()),
     sticky_error_(String::null()),
-    empty_context_(Context::null()) {
+    out_of_memory_(Instance::null()),
+    empty_context_(Context::null()),
+    optimization_queue_length_(0) {
 }
 
 
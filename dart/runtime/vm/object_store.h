@@ -202,12 +202,34 @@ class ObjectStore {
     pending_classes_ = value.raw();
   }
 
+  // Functions waiting for optimizing compilation, see
+  // Compiler::CompileQueuedFunctions. Null when empty. The array grows
+  // geometrically, only its first optimization_queue_length() elements are
+  // queued.
+  RawArray* optimization_queue() const { return optimization_queue_; }
+  void set_optimization_queue(const Array& value) {
+    optimization_queue_ = value.raw();
+  }
+  intptr_t optimization_queue_length() const {
+    return optimization_queue_length_;
+  }
+  void set_optimization_queue_length(intptr_t value) {
+    optimization_queue_length_ = value;
+  }
+
   RawString* sticky_error() const { return sticky_error_; }
   void set_sticky_error(const String& value) {
     ASSERT(!value.IsNull());
     sticky_error_ = value.raw();
   }
 
+  // The exception thrown when the heap of this isolate is exhausted, created
+  // on the first failed allocation.
+  RawInstance* out_of_memory() const { return out_of_memory_; }
+  void set_out_of_memory(const Instance& value) {
+    out_of_memory_ = value.raw();
+  }
+
   RawBool* true_value() const { return true_value_; }
   void set_true_value(const Bool& value) { true_value_ = value.raw(); }
 
@@ -269,9 +291,12 @@ class ObjectStore {
   RawLibrary* root_library_;
   RawLibrary* registered_libraries_;
   RawArray* pending_classes_;
+  RawArray* optimization_queue_;
   RawString* sticky_error_;
+  RawInstance* out_of_memory_;
   RawContext* empty_context_;
   RawObject** to() { return reinterpret_cast<RawObject**>(&empty_context_); }
+  intptr_t optimization_queue_length_;
 
   friend class SnapshotReader;
 
@@ -1801,7 +1801,8 @@ TEST_CASE(CheckedHandle) {
 }
 
 
-#if defined(TARGET_ARCH_IA32)  // only ia32 can run execution tests.
+// Only ia32 and x64 can run execution tests.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
 // Test for Code and Instruction object creation.
 TEST_CASE(Code) {
   extern void GenerateIncrement(Assembler* assembler);
@@ -1916,6 +1917,37 @@ TEST_CASE(PcDescriptors) {
 }
 
 
+TEST_CASE(Stackmap) {
+  const int kNumSlots = 11;
+  Stackmap& map = Stackmap::Handle();
+  map ^= Stackmap::New(100, kNumSlots);
+  EXPECT_EQ(kNumSlots, map.Length());
+  EXPECT_EQ(static_cast<uword>(100), map.PC());
+  for (intptr_t i = 0; i < kNumSlots; i++) {
+    EXPECT(!map.IsObject(i));
+  }
+  map.SetIsObject(0, true);
+  map.SetIsObject(8, true);
+  map.SetIsObject(10, true);
+  map.SetIsObject(10, false);
+  EXPECT(map.IsObject(0));
+  EXPECT(!map.IsObject(1));
+  EXPECT(map.IsObject(8));
+  EXPECT(!map.IsObject(10));
+  EXPECT_STREQ("0x64: 10000000100", map.ToCString());
+
+  const Array& maps = Array::Handle(Array::New(1));
+  maps.SetAt(0, map);
+  extern void GenerateIncrement(Assembler* assembler);
+  Assembler _assembler_;
+  GenerateIncrement(&_assembler_);
+  Code& code = Code::Handle(Code::FinalizeCode("Test_Code", &_assembler_));
+  EXPECT(Array::Handle(code.stackmaps()).IsNull());
+  code.set_stackmaps(maps);
+  EXPECT_EQ(maps.raw(), code.stackmaps());
+}
+
+
 static RawClass* CreateTestClass(const char* name) {
   const String& class_name = String::Handle(String::NewSymbol(name));
   const Class& cls = Class::Handle(Class::New(class_name, Script::Handle()));
@@ -1954,6 +1986,6 @@ TEST_CASE(ClassDictionaryIterator) {
   ASSERT(count == 2);
 }
 
-#endif  // TARGET_ARCH_IA32.
+#endif  // TARGET_ARCH_IA32 || TARGET_ARCH_X64
 
 }  // namespace dart
@@ -2049,7 +2049,7 @@ void OptimizingCodeGenerator::GenerateDirectCall(
   __ LoadObject(ECX, target);
   __ LoadObject(EDX, ArgumentsDescriptor(arg_count, optional_argument_names));
   __ call(&target_label);
-  AddCurrentDescriptor(PcDescriptors::kOther, node_id, token_index);
+  AddCurrentDescriptor(PcDescriptors::kFuncCall, node_id, token_index);
   __ addl(ESP, Immediate(arg_count * kWordSize));
 }
 
@@ -2250,7 +2250,7 @@ bool OptimizingCodeGenerator::TryInlineStaticCall(StaticCallNode* node) {
     __ LoadObject(ECX, node->function());
     __ LoadObject(EDX, ArgumentsDescriptor(node->arguments()->length(),
                                            node->arguments()->names()));
-    GenerateCall(node->token_index(), &StubCode::CallStaticFunctionLabel());
+    GenerateStaticCall(node->token_index());
     __ Bind(&done);
     return true;
   }
@@ -2266,7 +2266,7 @@ void OptimizingCodeGenerator::VisitStaticCallNode(StaticCallNode* node) {
     __ LoadObject(ECX, node->function());
     __ LoadObject(EDX, ArgumentsDescriptor(node->arguments()->length(),
                                            node->arguments()->names()));
-    GenerateCall(node->token_index(), &StubCode::CallStaticFunctionLabel());
+    GenerateStaticCall(node->token_index());
   }
   __ addl(ESP, Immediate(node->arguments()->length() * kWordSize));
   // Result is in EAX.
@@ -5,28 +5,57 @@
 #include "vm/pages.h"
 
 #include "vm/assert.h"
+#include "vm/atomic.h"
+#include "vm/gc_compactor.h"
+#include "vm/gc_marker.h"
+#include "vm/gc_sweeper.h"
+#include "vm/isolate.h"
 #include "vm/object.h"
+#include "vm/os.h"
 #include "vm/virtual_memory.h"
+#include "vm/visitor.h"
 
 namespace dart {
 
-HeapPage* HeapPage::Initialize(VirtualMemory* memory, bool is_executable) {
+DEFINE_FLAG(int, heap_growth_rate, 16,
+    "Minimum number of pages old space may grow by before the next "
+    "collection.");
+DEFINE_FLAG(int, heap_growth_ratio, 100,
+    "Percentage of the live old space size it may grow by before the next "
+    "collection.");
+DEFINE_FLAG(int, compaction_threshold, 25,
+    "Percentage of the old space capacity held in free blocks beyond which "
+    "old space is compacted between messages, 0 disables compaction.");
+DEFINE_FLAG(bool, concurrent_mark, false,
+    "Mark old space on a helper thread while the mutator is running.");
+DEFINE_FLAG(bool, lazy_sweep, true,
+    "Sweep the pages of old space on demand after a mark-sweep instead of "
+    "during the pause.");
+DECLARE_FLAG(bool, heap_huge_pages);
+DECLARE_FLAG(bool, verbose_gc);
+
+HeapPage* HeapPage::Initialize(VirtualMemory* memory, PageSpace* owner) {
   ASSERT(memory->size() > VirtualMemory::PageSize());
-  memory->Commit(is_executable);
-
   HeapPage* result = reinterpret_cast<HeapPage*>(memory->address());
   result->memory_ = memory;
+  result->owner_ = owner;
   result->next_ = NULL;
   result->used_ = 0;
   result->top_ = result->first_object_start();
+  result->forwarding_ = NULL;
+  result->card_table_ = NULL;
+  result->ClearMarkBits();
   return result;
 }
 
 
-HeapPage* HeapPage::Allocate(intptr_t size, bool is_executable) {
+HeapPage* HeapPage::Allocate(intptr_t size,
+                             PageSpace* owner,
+                             bool is_executable) {
   VirtualMemory* memory =
       VirtualMemory::ReserveAligned(size, PageSpace::kPageAlignment);
-  return Initialize(memory, is_executable);
+  memory->Commit(is_executable);
+  return Initialize(memory, owner);
 }
 
 
@@ -36,6 +65,75 @@ void HeapPage::Deallocate() {
 }
 
 
+bool HeapPage::AtomicSetMarked(RawObject* raw_obj) {
+  intptr_t index = MarkBitIndex(raw_obj);
+  uword* word = &mark_bits_[index / kBitsPerWord];
+  uword mask = static_cast<uword>(1) << (index % kBitsPerWord);
+  uword old_bits = *word;
+  while ((old_bits & mask) == 0) {
+    uword bits =
+        AtomicOperations::CompareAndSwapWord(word, old_bits, old_bits | mask);
+    if (bits == old_bits) {
+      return true;
+    }
+    old_bits = bits;
+  }
+  return false;
+}
+
+
+bool HeapPage::HasMarkedObjects() const {
+  for (intptr_t i = 0; i < kMarkBitsLength; i++) {
+    if (mark_bits_[i] != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void HeapPage::ClearMarkBits() {
+  memset(mark_bits_, 0, sizeof(mark_bits_));
+}
+
+
+uword HeapPage::NextMarkedObject(uword addr) const {
+  ASSERT(addr >= first_object_start());
+  intptr_t limit = (top() - start()) / kObjectAlignment;
+  limit = Utils::Minimum(limit, kMarkBitsLength * kBitsPerWord);
+  intptr_t index = (addr - start()) / kObjectAlignment;
+  while (index < limit) {
+    uword bits = mark_bits_[index / kBitsPerWord] >> (index % kBitsPerWord);
+    if (bits == 0) {
+      // Skip the rest of this word.
+      index = Utils::RoundDown(index, kBitsPerWord) + kBitsPerWord;
+      continue;
+    }
+    while ((bits & 1) == 0) {
+      bits >>= 1;
+      index++;
+    }
+    break;
+  }
+  if (index >= limit) {
+    return top();
+  }
+  return start() + index * kObjectAlignment;
+}
+
+
+void HeapPage::VisitObjects(ObjectVisitor* visitor) const {
+  uword obj_addr = first_object_start();
+  uword end_addr = top();
+  while (obj_addr < end_addr) {
+    RawObject* raw_obj = RawObject::FromAddr(obj_addr);
+    visitor->VisitObject(raw_obj);
+    obj_addr += raw_obj->Size();
+  }
+  ASSERT(obj_addr == end_addr);
+}
+
+
 void HeapPage::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
   uword obj_addr = first_object_start();
   uword end_addr = top();
@@ -47,25 +145,226 @@ void HeapPage::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
 }
 
 
+RawObject* HeapPage::FindObject(uword addr) const {
+  uword obj_addr = first_object_start();
+  uword end_addr = top();
+  if ((addr < obj_addr) || (addr >= end_addr)) {
+    return Object::null();
+  }
+  while (obj_addr < end_addr) {
+    RawObject* raw_obj = RawObject::FromAddr(obj_addr);
+    uword next_addr = obj_addr + raw_obj->Size();
+    if (addr < next_addr) {
+      return raw_obj;
+    }
+    obj_addr = next_addr;
+  }
+  return Object::null();
+}
+
+
+LargeObjectSpace::LargeObjectSpace(PageSpace* owner, bool is_executable)
+    : owner_(owner),
+      is_executable_(is_executable),
+      pages_(NULL),
+      cache_length_(0) {
+}
+
+
+LargeObjectSpace::~LargeObjectSpace() {
+  HeapPage* page = pages_;
+  while (page != NULL) {
+    HeapPage* next = page->next();
+    FreeCardTable(page);
+    page->Deallocate();
+    page = next;
+  }
+  for (intptr_t i = 0; i < cache_length_; i++) {
+    delete cache_[i];
+  }
+}
+
+
+intptr_t LargeObjectSpace::PageSizeFor(intptr_t size) {
+  return Utils::RoundUp(size + HeapPage::ObjectStartOffset(),
+                        VirtualMemory::PageSize());
+}
+
+
+VirtualMemory* LargeObjectSpace::TakeCachedMapping(intptr_t page_size) {
+  intptr_t best = -1;
+  for (intptr_t i = 0; i < cache_length_; i++) {
+    intptr_t size = cache_[i]->size();
+    if ((size >= page_size) && (size <= 2 * page_size) &&
+        ((best < 0) || (size < cache_[best]->size()))) {
+      best = i;
+    }
+  }
+  if (best < 0) {
+    return NULL;
+  }
+  VirtualMemory* result = cache_[best];
+  cache_[best] = cache_[--cache_length_];
+  return result;
+}
+
+
+HeapPage* LargeObjectSpace::AllocatePage(intptr_t size) {
+  intptr_t page_size = PageSizeFor(size);
+  VirtualMemory* memory = TakeCachedMapping(page_size);
+  if (memory == NULL) {
+    memory = VirtualMemory::ReserveHeapRegion(page_size,
+                                              PageSpace::kPageAlignment);
+    if (memory == NULL) {
+      return NULL;
+    }
+    memory->Commit(is_executable_);
+  }
+  // Cached mappings stay committed.
+  HeapPage* page = HeapPage::Initialize(memory, owner_);
+  if (!is_executable_) {
+    page->card_table_ = reinterpret_cast<uint8_t*>(
+        calloc(page->card_count(), sizeof(uint8_t)));
+    if (page->card_table_ == NULL) {
+      FATAL("Out of memory allocating a card table.");
+    }
+  }
+  page->set_next(pages_);
+  pages_ = page;
+  return page;
+}
+
+
+intptr_t LargeObjectSpace::FreePage(HeapPage* page, HeapPage* previous_page) {
+  if (previous_page == NULL) {
+    ASSERT(page == pages_);
+    pages_ = page->next();
+  } else {
+    previous_page->set_next(page->next());
+  }
+  FreeCardTable(page);
+  VirtualMemory* memory = page->memory_;
+  intptr_t size = memory->size();
+  if ((cache_length_ < kMaxCachedMappings) && (size <= kMaxCachedPageSize)) {
+    // Keep the mapping, but give its memory back to the OS.
+    memory->ReleasePages(memory->start(), size);
+    cache_[cache_length_++] = memory;
+  } else {
+    page->Deallocate();
+  }
+  return size;
+}
+
+
+void LargeObjectSpace::FreeCardTable(HeapPage* page) {
+  free(page->card_table_);
+  page->card_table_ = NULL;
+}
+
+
+intptr_t LargeObjectSpace::Sweep(GCSweeper* sweeper, intptr_t* released) {
+  intptr_t in_use = 0;
+  *released = 0;
+  HeapPage* prev_page = NULL;
+  HeapPage* page = pages_;
+  while (page != NULL) {
+    HeapPage* next_page = page->next();
+    intptr_t page_in_use = sweeper->SweepLargePage(page);
+    if (page_in_use == 0) {
+      *released += FreePage(page, prev_page);
+    } else {
+      in_use += page_in_use;
+      prev_page = page;
+    }
+    page = next_page;
+  }
+  return in_use;
+}
+
+
+bool LargeObjectSpace::Contains(uword addr) const {
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    if (page->Contains(addr)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void LargeObjectSpace::VisitObjects(ObjectVisitor* visitor) const {
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    page->VisitObjects(visitor);
+  }
+}
+
+
+void LargeObjectSpace::VisitObjectPointers(
+    ObjectPointerVisitor* visitor) const {
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    page->VisitObjectPointers(visitor);
+  }
+}
+
+
+RawObject* LargeObjectSpace::FindObject(uword addr) const {
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    if (page->Contains(addr)) {
+      return page->FindObject(addr);
+    }
+  }
+  return Object::null();
+}
+
+
 PageSpace::PageSpace(Heap* heap, intptr_t max_capacity, bool is_executable)
     : heap_(heap),
       pages_(NULL),
       pages_tail_(NULL),
-      large_pages_(NULL),
+      huge_page_extent_(NULL),
+      large_object_space_(this, is_executable),
+      freelist_(),
+      allocation_top_(0),
+      allocation_end_(0),
       max_capacity_(max_capacity),
       capacity_(0),
       in_use_(0),
-      is_executable_(is_executable) { }
+      growth_limit_(0),
+      marking_limit_(0),
+      concurrent_marker_(NULL),
+      sweep_next_(NULL),
+      sweep_end_(NULL),
+      unswept_(0),
+      sweep_time_micros_(0),
+      is_executable_(is_executable),
+      count_(0),
+      collection_time_micros_(0),
+      collecting_(false) {
+  SetGrowthLimit();
+}
 
 
 PageSpace::~PageSpace() {
+  if (concurrent_marker_ != NULL) {
+    concurrent_marker_->Abort();
+    delete concurrent_marker_;
+  }
   FreePages(pages_);
-  FreePages(large_pages_);
+  delete huge_page_extent_;
 }
 
 
 void PageSpace::AllocatePage() {
-  HeapPage* page = HeapPage::Allocate(kPageSize, is_executable_);
+  HeapPage* page = NULL;
+  VirtualMemory* memory = NULL;
+  if (FLAG_heap_huge_pages) {
+    memory = TakeHugePageExtentPage();
+  }
+  if (memory != NULL) {
+    page = HeapPage::Initialize(memory, this);
+  } else {
+    page = HeapPage::Allocate(kPageSize, this, is_executable_);
+  }
   if (pages_ == NULL) {
     pages_ = page;
   } else {
@@ -76,14 +375,44 @@ void PageSpace::AllocatePage() {
 }
 
 
-HeapPage* PageSpace::AllocateLargePage(intptr_t size) {
-  intptr_t page_size = Utils::RoundUp(size + sizeof(HeapPage),
-                                      VirtualMemory::PageSize());
-  HeapPage* page = HeapPage::Allocate(page_size, is_executable_);
-  page->set_next(large_pages_);
-  large_pages_ = page;
-  capacity_ += page_size;
-  return page;
+VirtualMemory* PageSpace::TakeHugePageExtentPage() {
+  if (huge_page_extent_ == NULL) {
+    ASSERT((VirtualMemory::kHugePageSize % kPageSize) == 0);
+    // The whole extent is committed at once, so that the first access to
+    // any of its pages faults in a huge page for all of them.
+    VirtualMemory* extent =
+        VirtualMemory::ReserveHeapRegion(VirtualMemory::kHugePageSize,
+                                         VirtualMemory::kHugePageSize);
+    if (extent == NULL) {
+      return NULL;
+    }
+    if (!extent->uses_huge_pages() || !extent->Commit(is_executable_)) {
+      delete extent;
+      return NULL;
+    }
+    huge_page_extent_ = extent;
+  }
+  // Freeing a page unmaps it, which splits the huge page of its extent.
+  VirtualMemory* memory = huge_page_extent_->SplitOff(kPageSize);
+  if ((memory == NULL) || (huge_page_extent_->size() == 0)) {
+    delete huge_page_extent_;
+    huge_page_extent_ = NULL;
+  }
+  return memory;
+}
+
+
+void PageSpace::FreePage(HeapPage* page, HeapPage* previous_page) {
+  // The tail page is used for bump allocation and is never released.
+  ASSERT(page != pages_tail_);
+  if (previous_page == NULL) {
+    ASSERT(page == pages_);
+    pages_ = page->next();
+  } else {
+    previous_page->set_next(page->next());
+  }
+  capacity_ -= kPageSize;
+  page->Deallocate();
 }
 
 
@@ -112,34 +441,79 @@ uword PageSpace::TryBumpAllocate(intptr_t size) {
 }
 
 
-uword PageSpace::TryAllocate(intptr_t size) {
+bool PageSpace::CanIncreaseCapacity(intptr_t increase,
+                                    GrowthPolicy growth_policy) const {
+  intptr_t new_capacity = capacity_ + increase;
+  if (new_capacity > max_capacity_) {
+    return false;
+  }
+  return (growth_policy == kForceGrowth) || (new_capacity <= growth_limit_);
+}
+
+
+void PageSpace::SetGrowthLimit() {
+  intptr_t growth = Utils::Maximum(
+      static_cast<intptr_t>(FLAG_heap_growth_rate) * kPageSize,
+      (in_use_ / 100) * FLAG_heap_growth_ratio);
+  growth_limit_ = Utils::Minimum(capacity_ + growth, max_capacity_);
+  marking_limit_ = capacity_ + (growth / 100) * kConcurrentMarkingStart;
+}
+
+
+uword PageSpace::TryAllocate(intptr_t size, GrowthPolicy growth_policy) {
   ASSERT(size >= kObjectAlignment);
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
   uword result = 0;
-  if (size < kAllocatablePageSize) {
-    result = TryBumpAllocate(size);
+  if (size < kLargeObjectThreshold) {
+    result = freelist_.TryAllocate(size);
+    while ((result == 0) && SweepNextPage()) {
+      result = freelist_.TryAllocate(size);
+    }
     if (result == 0) {
-      if (capacity_ < max_capacity_) {
+      result = TryBumpAllocate(size);
+    }
+    if (result == 0) {
+      if (CanIncreaseCapacity(kPageSize, growth_policy)) {
         AllocatePage();
         result = TryBumpAllocate(size);
         ASSERT(result != 0);
       }
     }
   } else {
-    // Large page allocation.
-    HeapPage* page = AllocateLargePage(size);
-    if (page != NULL) {
-      result = page->top();
-      page->set_top(result + size);
+    // Large object allocation.
+    intptr_t page_size = LargeObjectSpace::PageSizeFor(size);
+    if (CanIncreaseCapacity(page_size, growth_policy)) {
+      HeapPage* page = large_object_space_.AllocatePage(size);
+      if (page != NULL) {
+        capacity_ += page->end() - page->start();
+        result = page->top();
+        page->set_top(result + size);
+      }
     }
   }
   if (result != 0) {
     in_use_ += size;
+    if (concurrent_marker_ != NULL) {
+      // Objects allocated while marking are live for this collection.
+      RawObject* raw_obj = RawObject::FromAddr(result);
+      HeapPage::Of(raw_obj)->AtomicSetMarked(raw_obj);
+    }
   }
   return result;
 }
 
 
+void PageSpace::FreeUnused(uword addr, intptr_t size) {
+  if (size < kLargeObjectThreshold) {
+    freelist_.Free(addr, size);
+    in_use_ -= size;
+  } else {
+    // The large page is released by the next collection of this space.
+    FreeListElement::AsElement(addr, size);
+  }
+}
+
+
 bool PageSpace::Contains(uword addr) const {
   HeapPage* page = pages_;
   while (page != NULL) {
@@ -148,30 +522,352 @@ bool PageSpace::Contains(uword addr) const {
     }
     page = page->next();
   }
+  return large_object_space_.Contains(addr);
+}
+
 
-  page = large_pages_;
+void PageSpace::RefillAllocationBuffer() {
+  ReleaseAllocationBuffer();
+  // Objects allocated while marking have to be marked, which only the
+  // runtime does.
+  if (concurrent_marker_ != NULL) {
+    return;
+  }
+  uword block = TryAllocate(kAllocationBufferSize);
+  if (block != 0) {
+    allocation_top_ = block;
+    allocation_end_ = block + kAllocationBufferSize;
+  }
+}
+
+
+void PageSpace::ReleaseAllocationBuffer() {
+  if (allocation_top_ < allocation_end_) {
+    FreeUnused(allocation_top_, allocation_end_ - allocation_top_);
+  }
+  allocation_top_ = 0;
+  allocation_end_ = 0;
+}
+
+
+void PageSpace::MakeAllocationBufferWalkable() const {
+  if (allocation_top_ < allocation_end_) {
+    FreeListElement::AsElement(allocation_top_,
+                               allocation_end_ - allocation_top_);
+  }
+}
+
+
+void PageSpace::VisitObjects(ObjectVisitor* visitor) const {
+  MakeAllocationBufferWalkable();
+  HeapPage* page = pages_;
   while (page != NULL) {
-    if (page->Contains(addr)) {
-      return true;
-    }
+    page->VisitObjects(visitor);
     page = page->next();
   }
-  return false;
+  large_object_space_.VisitObjects(visitor);
 }
 
 
 void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
+  MakeAllocationBufferWalkable();
   HeapPage* page = pages_;
   while (page != NULL) {
     page->VisitObjectPointers(visitor);
     page = page->next();
   }
+  large_object_space_.VisitObjectPointers(visitor);
+}
 
-  page = large_pages_;
+
+RawObject* PageSpace::FindObject(uword addr) const {
+  MakeAllocationBufferWalkable();
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    if (page->Contains(addr)) {
+      return page->FindObject(addr);
+    }
+  }
+  return large_object_space_.FindObject(addr);
+}
+
+
+intptr_t PageSpace::SweepLargePages(GCSweeper* sweeper) {
+  intptr_t released = 0;
+  intptr_t in_use = large_object_space_.Sweep(sweeper, &released);
+  capacity_ -= released;
+  return in_use;
+}
+
+
+bool PageSpace::NeedsCompaction() const {
+  if ((FLAG_compaction_threshold <= 0) || (capacity_ == 0)) {
+    return false;
+  }
+  return ((freelist_.free_bytes() + unswept_) / FLAG_compaction_threshold) >
+      (capacity_ / 100);
+}
+
+
+bool PageSpace::NeedsConcurrentMarking() const {
+  return FLAG_concurrent_mark &&
+      !is_executable_ &&
+      (concurrent_marker_ == NULL) &&
+      !collecting_ &&
+      (capacity_ > marking_limit_);
+}
+
+
+void PageSpace::StartConcurrentMarking() {
+  ASSERT(concurrent_marker_ == NULL);
+  ASSERT(!is_executable_);
+  NoHandleScope no_handles;
+  Timer timer(FLAG_verbose_gc, "StartConcurrentMarking");
+  timer.Start();
+  int64_t start = OS::GetCurrentTimeMicros();
+  ReleaseAllocationBuffer();
+  // The mark bits of the unswept pages are still in use.
+  CompleteSweeping();
+  concurrent_marker_ = new ConcurrentMarker(heap_, this);
+  concurrent_marker_->Start(Isolate::Current());
+  collection_time_micros_ += OS::GetCurrentTimeMicros() - start;
+  timer.Stop();
+  if (FLAG_verbose_gc) {
+    OS::PrintErr("StartConcurrentMarking[%d]: %dus (%dK, capacity %dK)\n",
+                 count_,
+                 timer.TotalElapsedTime(),
+                 in_use_ / KB,
+                 capacity_ / KB);
+  }
+}
+
+
+void PageSpace::MarkPointers(uword* pointers, intptr_t length) {
+  if (concurrent_marker_ != NULL) {
+    concurrent_marker_->MarkPointers(pointers, length);
+  }
+}
+
+
+void PageSpace::MarkObjects(Isolate* isolate, PageSpace* code_space) {
+  if (concurrent_marker_ != NULL) {
+    // Complete the marking started concurrently. It treats the code space as
+    // roots, the code space is not collected.
+    ASSERT(code_space == NULL);
+    concurrent_marker_->Finish(isolate);
+    delete concurrent_marker_;
+    concurrent_marker_ = NULL;
+  } else {
+    GCMarker marker(heap_);
+    marker.MarkObjects(isolate, this, code_space);
+  }
+}
+
+
+void PageSpace::Sweep(GCSweeper* sweeper) {
+  ASSERT(sweep_next_ == NULL);
+  freelist_.Reset();
+  intptr_t in_use = 0;
+  intptr_t unswept = 0;
+  // The code space is always swept eagerly, its objects are looked up by the
+  // return addresses on the stack.
+  bool lazy = FLAG_lazy_sweep && !is_executable_;
+
+  HeapPage* prev_page = NULL;
+  HeapPage* page = pages_;
   while (page != NULL) {
-    page->VisitObjectPointers(visitor);
-    page = page->next();
+    HeapPage* next_page = page->next();
+    if (page->HasMarkedObjects()) {
+      if (lazy && (page != pages_tail_)) {
+        if (sweep_next_ == NULL) {
+          sweep_next_ = page;
+        }
+        unswept += page->top() - page->first_object_start();
+      } else {
+        in_use += sweeper->SweepPage(page, &freelist_);
+      }
+      prev_page = page;
+    } else if (page == pages_tail_) {
+      // Keep the empty tail page and make all of it available for bump
+      // allocation.
+      page->set_top(page->first_object_start());
+      page->set_used(0);
+      prev_page = page;
+    } else {
+      FreePage(page, prev_page);
+    }
+    page = next_page;
+  }
+
+  if (sweep_next_ != NULL) {
+    sweep_end_ = pages_tail_;
+  }
+
+  in_use += SweepLargePages(sweeper);
+  in_use_ = in_use + unswept;
+  unswept_ = unswept;
+  SetGrowthLimit();
+}
+
+
+bool PageSpace::SweepNextPage() {
+  if (sweep_next_ == NULL) {
+    return false;
+  }
+  int64_t start = OS::GetCurrentTimeMicros();
+  HeapPage* page = sweep_next_;
+  sweep_next_ = page->next();
+  if (sweep_next_ == sweep_end_) {
+    sweep_next_ = NULL;
+    sweep_end_ = NULL;
+  }
+  intptr_t page_size = page->top() - page->first_object_start();
+  GCSweeper sweeper(heap_);
+  intptr_t page_in_use = sweeper.SweepPage(page, &freelist_);
+  in_use_ -= page_size - page_in_use;
+  unswept_ -= page_size;
+  sweep_time_micros_ += OS::GetCurrentTimeMicros() - start;
+  return true;
+}
+
+
+void PageSpace::CompleteSweeping() {
+  while (SweepNextPage()) {
+  }
+  ASSERT(unswept_ == 0);
+}
+
+
+void PageSpace::MarkSweep(PageSpace* code_space) {
+  // Mark-sweep is not reentrant. Make sure that is the case.
+  ASSERT(!collecting_);
+  ASSERT(!is_executable_);
+  ASSERT((code_space == NULL) || code_space->is_executable_);
+  collecting_ = true;
+  NoHandleScope no_handles;
+
+  Timer timer(FLAG_verbose_gc, "MarkSweep");
+  timer.Start();
+  int64_t start = OS::GetCurrentTimeMicros();
+  intptr_t in_use_before = in_use_;
+
+  // Marking started concurrently treats the code space as roots.
+  if (concurrent_marker_ != NULL) {
+    code_space = NULL;
+  }
+  ReleaseAllocationBuffer();
+  // The mark bits of the pages left unswept by the last collection are
+  // still in use.
+  CompleteSweeping();
+
+  // Mark all reachable objects in this space, and in the code space if it is
+  // collected as well.
+  MarkObjects(Isolate::Current(), code_space);
+
+  GCSweeper sweeper(heap_);
+  Sweep(&sweeper);
+  if (code_space != NULL) {
+    code_space->Sweep(&sweeper);
+  }
+  int64_t time = OS::GetCurrentTimeMicros() - start;
+  collection_time_micros_ += time;
+  if (code_space != NULL) {
+    // The pause collected both spaces.
+    code_space->collection_time_micros_ += time;
+    code_space->count_++;
   }
+  timer.Stop();
+  if (FLAG_verbose_gc) {
+    OS::PrintErr("MarkSweep[%d]: %dus (%dK -> %dK, capacity %dK, "
+                 "unswept %dK)\n",
+                 count_,
+                 timer.TotalElapsedTime(),
+                 in_use_before / KB,
+                 in_use_ / KB,
+                 capacity_ / KB,
+                 unswept_ / KB);
+  }
+
+  count_++;
+  // Done collecting. Reset the marker.
+  ASSERT(collecting_);
+  collecting_ = false;
+}
+
+
+void PageSpace::MarkCompact() {
+  // Mark-compact is not reentrant. Make sure that is the case.
+  ASSERT(!collecting_);
+  ASSERT(!is_executable_);
+  collecting_ = true;
+  NoHandleScope no_handles;
+
+  Timer timer(FLAG_verbose_gc, "MarkCompact");
+  timer.Start();
+  int64_t start = OS::GetCurrentTimeMicros();
+  intptr_t in_use_before = in_use_;
+  intptr_t capacity_before = capacity_;
+
+  ReleaseAllocationBuffer();
+  CompleteSweeping();
+  Isolate* isolate = Isolate::Current();
+  MarkObjects(isolate, NULL);
+
+  // Slide the live objects of the regular pages together. Holes in front of
+  // objects that cannot move are put on the free list.
+  freelist_.Reset();
+  GCCompactor compactor(heap_);
+  intptr_t in_use = compactor.CompactPages(isolate, this, pages_,
+                                           large_object_space_.pages(),
+                                           &freelist_);
+
+  // The last page still holding objects becomes the tail page used for bump
+  // allocation. All other pages left empty are released, the unused ends of
+  // the remaining pages are put on the free list.
+  HeapPage* new_tail = pages_;
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    if (page->top() > page->first_object_start()) {
+      new_tail = page;
+    }
+  }
+  pages_tail_ = new_tail;
+  HeapPage* prev_page = NULL;
+  HeapPage* page = pages_;
+  while (page != NULL) {
+    HeapPage* next_page = page->next();
+    if (page == pages_tail_) {
+      prev_page = page;
+    } else if (page->top() == page->first_object_start()) {
+      FreePage(page, prev_page);
+    } else {
+      if (page->top() < page->end()) {
+        freelist_.Free(page->top(), page->end() - page->top());
+        page->set_top(page->end());
+      }
+      prev_page = page;
+    }
+    page = next_page;
+  }
+
+  GCSweeper sweeper(heap_);
+  in_use += SweepLargePages(&sweeper);
+  in_use_ = in_use;
+  SetGrowthLimit();
+  collection_time_micros_ += OS::GetCurrentTimeMicros() - start;
+  timer.Stop();
+  if (FLAG_verbose_gc) {
+    OS::PrintErr("MarkCompact[%d]: %dus (%dK -> %dK, capacity %dK -> %dK)\n",
+                 count_,
+                 timer.TotalElapsedTime(),
+                 in_use_before / KB,
+                 in_use_ / KB,
+                 capacity_before / KB,
+                 capacity_ / KB);
+  }
+
+  count_++;
+  // Done collecting. Reset the marker.
+  ASSERT(collecting_);
+  collecting_ = false;
 }
 
 }  // namespace dart
@@ -5,19 +5,31 @@
 #ifndef VM_PAGES_H_
 #define VM_PAGES_H_
 
+#include "vm/freelist.h"
 #include "vm/globals.h"
+#include "vm/raw_object.h"
+#include "vm/utils.h"
 #include "vm/virtual_memory.h"
 
 namespace dart {
 
 // Forward declarations.
+class ConcurrentMarker;
+class ForwardingTable;
+class GCSweeper;
 class Heap;
+class Isolate;
 class ObjectPointerVisitor;
+class ObjectVisitor;
+class PageSpace;
 
 // An aligned page containing old generation objects. Alignment is used to be
 // able to get to a HeapPage header quickly based on a pointer to an object.
 class HeapPage {
  public:
+  // TODO(iposva): Determine heap sizes and tune the page size accordingly.
+  static const intptr_t kPageSize = 256 * KB;
+
   HeapPage* next() const { return next_; }
   void set_next(HeapPage* next) { next_ = next; }
 
@@ -32,7 +44,14 @@ class HeapPage {
   void set_top(uword top) { top_ = top; }
 
   uword first_object_start() const {
-    return (reinterpret_cast<uword>(this) + sizeof(HeapPage));
+    return (reinterpret_cast<uword>(this) + ObjectStartOffset());
+  }
+
+  // The page header is padded so that objects in the page are aligned like
+  // all other old objects.
+  static intptr_t ObjectStartOffset() {
+    return Utils::RoundUp(static_cast<intptr_t>(sizeof(HeapPage)),
+                          kObjectAlignment);
   }
 
   void set_used(uword used) { used_ = used; }
@@ -41,21 +60,103 @@ class HeapPage {
     used_ += size;
   }
 
+  PageSpace* owner() const { return owner_; }
+
+  // Returns the page containing the start of the old space object 'raw_obj'.
+  // Objects in large pages always start in the first kPageSize bytes.
+  static HeapPage* Of(RawObject* raw_obj) {
+    ASSERT(raw_obj->IsHeapObject() && raw_obj->IsOldObject());
+    uword addr = RawObject::ToAddr(raw_obj);
+    return reinterpret_cast<HeapPage*>(addr & ~(kPageSize - 1));
+  }
+
+  // Mark bits are kept on the side so that the class_ header word, which is
+  // compared directly by generated code, is never modified by the collector.
+  bool IsMarked(RawObject* raw_obj) const {
+    intptr_t index = MarkBitIndex(raw_obj);
+    return (mark_bits_[index / kBitsPerWord] &
+            (static_cast<uword>(1) << (index % kBitsPerWord))) != 0;
+  }
+  void SetMarked(RawObject* raw_obj) {
+    intptr_t index = MarkBitIndex(raw_obj);
+    mark_bits_[index / kBitsPerWord] |=
+        (static_cast<uword>(1) << (index % kBitsPerWord));
+  }
+  // Mark bits are set from several threads while old space is marked
+  // concurrently. Returns false if the object was already marked.
+  bool AtomicSetMarked(RawObject* raw_obj);
+  bool HasMarkedObjects() const;
+  void ClearMarkBits();
+  // Returns the address of the first marked object at or after 'addr', or
+  // top() if there is none.
+  uword NextMarkedObject(uword addr) const;
+
+  // The pages of large objects in old space have a card table with one byte
+  // per kCardSize bytes of the page. A card is dirtied by the write barrier
+  // when a new object is stored into a slot it covers, so that the scavenger
+  // only visits the dirty parts of large arrays. Other pages have no card
+  // table and their objects are remembered in the store buffer.
+  static const intptr_t kCardBits = 9;
+  static const intptr_t kCardSize = 1 << kCardBits;
+
+  uint8_t* card_table() const { return card_table_; }
+  intptr_t card_count() const { return (end() - start()) >> kCardBits; }
+  void RememberCard(RawObject** slot) {
+    ASSERT(card_table_ != NULL);
+    uword offset = reinterpret_cast<uword>(slot) - start();
+    ASSERT(offset < (end() - start()));
+    card_table_[offset >> kCardBits] = 1;
+  }
+  bool IsCardRemembered(RawObject** slot) const {
+    ASSERT(card_table_ != NULL);
+    uword offset = reinterpret_cast<uword>(slot) - start();
+    return card_table_[offset >> kCardBits] != 0;
+  }
+  static int card_table_offset() { return OFFSET_OF(HeapPage, card_table_); }
+
+  // Forwarding addresses of the objects in this page while it is compacted.
+  ForwardingTable* forwarding() const { return forwarding_; }
+  void set_forwarding(ForwardingTable* forwarding) {
+    forwarding_ = forwarding;
+  }
+
+  void VisitObjects(ObjectVisitor* visitor) const;
   void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
 
+  // Returns the object containing 'addr' by walking the objects of this page,
+  // or Object::null() if there is none.
+  RawObject* FindObject(uword addr) const;
+
  private:
-  static HeapPage* Initialize(VirtualMemory* memory, bool is_executable);
-  static HeapPage* Allocate(intptr_t size, bool is_executable);
+  static const intptr_t kMarkBitsLength =
+      kPageSize / (kObjectAlignment * kBitsPerWord);
+
+  // Sets up a page in the committed 'memory'.
+  static HeapPage* Initialize(VirtualMemory* memory, PageSpace* owner);
+  static HeapPage* Allocate(intptr_t size,
+                            PageSpace* owner,
+                            bool is_executable);
 
   // Deallocate the virtual memory backing this page. The page pointer to this
   // page becomes immediately inaccessible.
   void Deallocate();
 
+  intptr_t MarkBitIndex(RawObject* raw_obj) const {
+    uword offset = RawObject::ToAddr(raw_obj) - start();
+    ASSERT(offset < static_cast<uword>(kPageSize));
+    return offset / kObjectAlignment;
+  }
+
   VirtualMemory* memory_;
+  PageSpace* owner_;
   HeapPage* next_;
   uword used_;
   uword top_;
+  ForwardingTable* forwarding_;
+  uint8_t* card_table_;
+  uword mark_bits_[kMarkBitsLength];
 
+  friend class LargeObjectSpace;
   friend class PageSpace;
 
   DISALLOW_ALLOCATION();
@@ -63,50 +164,246 @@ class HeapPage {
 };
 
 
+// The large object space of a PageSpace keeps each object too large for a
+// regular page in its own virtual memory mapping, headed by a HeapPage owned
+// by the PageSpace. Large objects are marked in place and never move. The
+// mappings of dead objects are unmapped when swept, except for a few which are
+// kept for reuse after their physical pages have been released to the OS.
+class LargeObjectSpace {
+ public:
+  LargeObjectSpace(PageSpace* owner, bool is_executable);
+  ~LargeObjectSpace();
+
+  // Size of the mapping needed for an object of 'size' bytes.
+  static intptr_t PageSizeFor(intptr_t size);
+
+  // Returns a page which can hold an object of 'size' bytes at its first
+  // object start, or NULL if no memory could be reserved.
+  HeapPage* AllocatePage(intptr_t size);
+
+  // Release the pages of the unmarked objects. Returns the number of bytes
+  // used by the surviving objects, the size of the released mappings is
+  // stored in 'released'.
+  intptr_t Sweep(GCSweeper* sweeper, intptr_t* released);
+
+  HeapPage* pages() const { return pages_; }
+
+  bool Contains(uword addr) const;
+  void VisitObjects(ObjectVisitor* visitor) const;
+  void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
+  RawObject* FindObject(uword addr) const;
+
+ private:
+  // Dead mappings up to kMaxCachedPageSize bytes are cached for reuse by
+  // objects needing at least half of their size.
+  static const intptr_t kMaxCachedMappings = 4;
+  static const intptr_t kMaxCachedPageSize = 4 * HeapPage::kPageSize;
+
+  intptr_t FreePage(HeapPage* page, HeapPage* previous_page);
+  VirtualMemory* TakeCachedMapping(intptr_t page_size);
+  static void FreeCardTable(HeapPage* page);
+
+  PageSpace* owner_;
+  bool is_executable_;
+  HeapPage* pages_;
+  VirtualMemory* cache_[kMaxCachedMappings];
+  intptr_t cache_length_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(LargeObjectSpace);
+};
+
+
 class PageSpace {
  public:
-  // TODO(iposva): Determine heap sizes and tune the page size accordingly.
-  static const intptr_t kPageSize = 256 * KB;
+  static const intptr_t kPageSize = HeapPage::kPageSize;
   static const intptr_t kPageAlignment = kPageSize;
 
+  enum GrowthPolicy {
+    kControlGrowth,
+    kForceGrowth
+  };
+
   PageSpace(Heap* heap, intptr_t max_capacity, bool is_executable = false);
   ~PageSpace();
 
-  uword TryAllocate(intptr_t size);
+  // Allocation first reuses memory reclaimed by the last collection, then
+  // bump allocates in the tail page. New pages are only added while capacity
+  // stays below the growth limit computed after the last collection, unless
+  // growth is forced.
+  uword TryAllocate(intptr_t size, GrowthPolicy growth_policy = kControlGrowth);
+  // Return the memory of an object just allocated by TryAllocate which was
+  // never published to the rest of the heap.
+  void FreeUnused(uword addr, intptr_t size);
 
   intptr_t in_use() const { return in_use_; }
+  intptr_t capacity() const { return capacity_; }
+
+  // The capacity this space never grows beyond. Lowering it below the
+  // current capacity only prevents further growth.
+  intptr_t max_capacity() const { return max_capacity_; }
+  void set_max_capacity(intptr_t value) {
+    max_capacity_ = value;
+    SetGrowthLimit();
+  }
+
+  // Number of collections of this space and the total time the mutator was
+  // paused by them. The code space is collected together with old space.
+  intptr_t collections() const { return count_; }
+  int64_t collection_time_micros() const { return collection_time_micros_; }
+
+  // With --lazy_sweep, mark-sweep only sweeps the tail page and the large
+  // pages of old space, and releases the pages without live objects. The
+  // other pages are swept on demand by the allocator once the free list runs
+  // out, and are counted as fully in use until then. Bytes in the pages still
+  // to be swept and the total time spent sweeping them:
+  intptr_t unswept() const { return unswept_; }
+  int64_t sweep_time_micros() const { return sweep_time_micros_; }
+
+  // Sweep all pages left unswept by the last mark-sweep. Called before old
+  // space is marked again or its objects are iterated.
+  void CompleteSweeping();
+
+  // Pages were added beyond the growth limit since the last collection.
+  bool NeedsGarbageCollection() const { return capacity_ > growth_limit_; }
   bool Contains(uword addr) const;
   bool IsValidAddress(uword addr) const {
     return Contains(addr);
   }
   static intptr_t IsPageAllocatableSize(intptr_t size) {
-    return size <= kAllocatablePageSize;
+    return size < kLargeObjectThreshold;
   }
 
+  void VisitObjects(ObjectVisitor* visitor) const;
   void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
 
+  // Generated code bump allocates the instances of pretenured classes in
+  // [allocation_top_, allocation_end_), a block taken from this space by
+  // RefillAllocationBuffer once the previous one ran out. Heap walks see the
+  // unused part of the block as a free list element, collections and
+  // concurrent marking give it back to the free list.
+  uword* AllocationTopAddress() { return &allocation_top_; }
+  uword* AllocationEndAddress() { return &allocation_end_; }
+  void RefillAllocationBuffer();
+  void ReleaseAllocationBuffer();
+
+  // The pages of the large objects in this space. Only the large pages of a
+  // non-executable space have a card table.
+  HeapPage* large_pages() const { return large_object_space_.pages(); }
+
+  // Returns the object containing 'addr', or Object::null() if 'addr' is not
+  // in an object of this space. Walks the objects of a whole page, only meant
+  // for infrequent lookups such as of the return addresses on the stack.
+  RawObject* FindObject(uword addr) const;
+
+  // Collect the garbage in this space using mark-sweep. Roots are the isolate
+  // roots and all objects in the other spaces of the heap. If 'code_space' is
+  // not NULL, the code which is only referenced from the code space and the
+  // code index table is collected as well.
+  void MarkSweep(PageSpace* code_space = NULL);
+
+  // Collect the garbage in this space and slide the live objects together,
+  // releasing the pages left empty.
+  void MarkCompact();
+
+  // The free list holds more than --compaction_threshold percent of the
+  // capacity of this space. The pages left unswept are counted as free, the
+  // caller sweeps them first for a precise answer.
+  bool NeedsCompaction() const;
+
+  // Old space grew close enough to its growth limit that marking should be
+  // started concurrently when --concurrent_mark is set.
+  bool NeedsConcurrentMarking() const;
+
+  // Mark this space on a helper thread while the mutator keeps running. The
+  // next MarkSweep or MarkCompact completes the marking and uses its result.
+  void StartConcurrentMarking();
+  bool is_marking() const { return concurrent_marker_ != NULL; }
+
+  // Mark the old objects logged by the write barrier while marking.
+  void MarkPointers(uword* pointers, intptr_t length);
+
  private:
-  static const intptr_t kAllocatablePageSize = kPageSize - sizeof(HeapPage);
+  // Percentage of the allowed growth after which concurrent marking starts.
+  static const intptr_t kConcurrentMarkingStart = 75;
+
+  static const intptr_t kAllocatablePageSize =
+      kPageSize - ((sizeof(HeapPage) + kObjectAlignment - 1) &
+                   ~(kObjectAlignment - 1));
+  // Objects of this size and larger are kept in the large object space.
+  static const intptr_t kLargeObjectThreshold = kPageSize / 4;
+  static const intptr_t kAllocationBufferSize = 16 * KB;
 
   void AllocatePage();
-  HeapPage* AllocateLargePage(intptr_t size);
+  // With --heap_huge_pages, pages are carved out of committed extents of
+  // VirtualMemory::kHugePageSize bytes, so that the pages of an extent share
+  // a huge page. Returns NULL if no extent can be used.
+  VirtualMemory* TakeHugePageExtentPage();
+  void FreePage(HeapPage* page, HeapPage* previous_page);
   void FreePages(HeapPage* pages);
+  intptr_t SweepLargePages(GCSweeper* sweeper);
+
+  // Rebuild the free list from the unmarked objects and release the pages
+  // without any live objects.
+  void Sweep(GCSweeper* sweeper);
+  // Sweep the next page left unswept by Sweep. Returns false if there is
+  // none.
+  bool SweepNextPage();
+
+  bool CanIncreaseCapacity(intptr_t increase,
+                           GrowthPolicy growth_policy) const;
+  void SetGrowthLimit();
+
+  void MarkObjects(Isolate* isolate, PageSpace* code_space);
 
   uword TryBumpAllocate(intptr_t size);
 
+  // Write a free list element over the unused part of the allocation buffer,
+  // which generated code overwrites as it allocates.
+  void MakeAllocationBufferWalkable() const;
+
   Heap* heap_;
 
   HeapPage* pages_;
   HeapPage* pages_tail_;
-  HeapPage* large_pages_;
+  // The part of the current huge page extent not taken by pages yet.
+  VirtualMemory* huge_page_extent_;
+
+  LargeObjectSpace large_object_space_;
+
+  FreeList freelist_;
+
+  uword allocation_top_;
+  uword allocation_end_;
 
   // Various sizes being tracked for this generation.
   intptr_t max_capacity_;
   intptr_t capacity_;
   intptr_t in_use_;
 
+  // Capacity beyond which allocation triggers a collection.
+  intptr_t growth_limit_;
+  // Capacity beyond which concurrent marking is started.
+  intptr_t marking_limit_;
+
+  // The marker of the concurrent marking in progress, if any.
+  ConcurrentMarker* concurrent_marker_;
+
+  // The pages from sweep_next_ up to, but excluding, sweep_end_ still have to
+  // be swept. Pages are only added after the tail page, which is swept
+  // eagerly, and only released during collections.
+  HeapPage* sweep_next_;
+  HeapPage* sweep_end_;
+  intptr_t unswept_;
+  int64_t sweep_time_micros_;
+
   bool is_executable_;
 
+  // Collection cycle count and the time spent collecting.
+  int count_;
+  int64_t collection_time_micros_;
+  // Keep track whether a collection is currently running.
+  bool collecting_;
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(PageSpace);
 };
 
@@ -3,11 +3,14 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "vm/assert.h"
+#include "vm/flags.h"
 #include "vm/pages.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, heap_huge_pages);
+
 TEST_CASE(Pages) {
   PageSpace* space = new PageSpace(NULL, 4 * MB);
   EXPECT(!space->Contains(reinterpret_cast<uword>(&space)));
@@ -31,4 +34,35 @@ TEST_CASE(Pages) {
   delete space;
 }
 
+
+TEST_CASE(PagesInHugePageExtents) {
+  const bool saved_huge_pages = FLAG_heap_huge_pages;
+  FLAG_heap_huge_pages = true;
+  PageSpace* space = new PageSpace(NULL, 4 * MB);
+  const intptr_t kPagesPerExtent =
+      VirtualMemory::kHugePageSize / PageSpace::kPageSize;
+  // Fill the pages of one extent with objects below the large object size.
+  const intptr_t kBlockSize = PageSpace::kPageSize / 8;
+  uword first_page = 0;
+  intptr_t page_count = 0;
+  uword last_page = 0;
+  while (page_count < kPagesPerExtent) {
+    uword block = space->TryAllocate(kBlockSize);
+    EXPECT(block != 0);
+    uword page = block & ~(PageSpace::kPageSize - 1);
+    if (page != last_page) {
+      if (page_count == 0) {
+        first_page = page;
+        EXPECT((first_page & (VirtualMemory::kHugePageSize - 1)) == 0);
+      }
+      // Pages are taken from the extent in address order.
+      EXPECT_EQ(first_page + page_count * PageSpace::kPageSize, page);
+      page_count++;
+      last_page = page;
+    }
+  }
+  delete space;
+  FLAG_heap_huge_pages = saved_huge_pages;
+}
+
 }  // namespace dart
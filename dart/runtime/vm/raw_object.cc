@@ -4,6 +4,7 @@
 
 #include "vm/raw_object.h"
 
+#include "vm/freelist.h"
 #include "vm/object.h"
 #include "vm/visitor.h"
 
@@ -24,16 +25,33 @@ void RawObject::Validate() const {
 }
 
 
-intptr_t RawObject::Size() const {
+bool RawObject::IsClass() const {
+  return ptr()->class_->ptr()->instance_kind_ == kClass;
+}
+
+
+bool RawObject::IsArray() const {
+  ObjectKind kind = ptr()->class_->ptr()->instance_kind_;
+  return (kind == kArray) || (kind == kImmutableArray);
+}
+
+
+intptr_t RawObject::SizeFromClass(RawClass* raw_class) const {
   NoHandleScope no_handles;
 
   // Only reasonable to be called on heap objects.
   ASSERT(IsHeapObject());
 
-  RawClass* raw_class = ptr()->class_;
   intptr_t instance_size = raw_class->ptr()->instance_size_;
   if (instance_size == 0) {
     switch (raw_class->ptr()->instance_kind_) {
+      case kTypeArray: {
+        const RawTypeArray* raw_array =
+            reinterpret_cast<const RawTypeArray*>(this);
+        intptr_t array_length = Smi::Value(raw_array->ptr()->length_);
+        instance_size = TypeArray::InstanceSize(array_length);
+        break;
+      }
       case kTokenStream: {
         const RawTokenStream* raw_tokens =
             reinterpret_cast<const RawTokenStream*>(this);
@@ -117,6 +135,12 @@ intptr_t RawObject::Size() const {
         instance_size = ExceptionHandlers::InstanceSize(num_handlers);
         break;
       }
+      case kStackmap: {
+        const RawStackmap* raw_map = reinterpret_cast<const RawStackmap*>(this);
+        intptr_t length = Smi::Value(raw_map->ptr()->length_);
+        instance_size = Stackmap::InstanceSize(length);
+        break;
+      }
       case kJSRegExp: {
         const RawJSRegExp* raw_jsregexp =
             reinterpret_cast<const RawJSRegExp*>(this);
@@ -124,6 +148,12 @@ intptr_t RawObject::Size() const {
         instance_size = JSRegExp::InstanceSize(data_length);
         break;
       }
+      case kFreeListElement: {
+        uword addr = RawObject::ToAddr(const_cast<RawObject*>(this));
+        FreeListElement* element = reinterpret_cast<FreeListElement*>(addr);
+        instance_size = element->size();
+        break;
+      }
       default:
         UNREACHABLE();
         break;
@@ -156,6 +186,12 @@ intptr_t RawObject::VisitPointers(ObjectPointerVisitor* visitor) {
     }
     CLASS_LIST_NO_OBJECT(RAW_VISITPOINTERS)
 #undef RAW_VISITPOINTERS
+    case kFreeListElement: {
+      uword addr = RawObject::ToAddr(this);
+      FreeListElement* element = reinterpret_cast<FreeListElement*>(addr);
+      size = element->size();
+      break;
+    }
     default:
       UNREACHABLE();
       break;
@@ -318,6 +354,15 @@ intptr_t RawExceptionHandlers::VisitExceptionHandlersPointers(
 }
 
 
+intptr_t RawStackmap::VisitStackmapPointers(RawStackmap* raw_obj,
+                                            ObjectPointerVisitor* visitor) {
+  RawStackmap* obj = raw_obj->ptr();
+  intptr_t length = Smi::Value(obj->length_);
+  visitor->VisitPointer(reinterpret_cast<RawObject**>(&obj->length_));
+  return Stackmap::InstanceSize(length);
+}
+
+
 intptr_t RawContext::VisitContextPointers(RawContext* raw_obj,
                                           ObjectPointerVisitor* visitor) {
   intptr_t num_variables = raw_obj->ptr()->num_variables_;
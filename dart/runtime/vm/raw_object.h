@@ -34,6 +34,7 @@ namespace dart {
   V(Instructions)                                                              \
   V(PcDescriptors)                                                             \
   V(ExceptionHandlers)                                                         \
+  V(Stackmap)                                                                  \
   V(Context)                                                                   \
   V(ContextScope)                                                              \
   V(UnhandledException)                                                        \
@@ -145,7 +146,15 @@ class RawObject {
   }
 
   void Validate() const;
-  intptr_t Size() const;
+  // This object is a class, as opposed to an instance of a class.
+  bool IsClass() const;
+  // This object is an array, all words of which are pointers.
+  bool IsArray() const;
+  intptr_t Size() const { return SizeFromClass(ptr()->class_); }
+  // Size of this object computed from 'raw_class' instead of the class
+  // pointer in the header, which may be overwritten concurrently while
+  // the object is being forwarded by a parallel scavenge.
+  intptr_t SizeFromClass(RawClass* raw_class) const;
   intptr_t VisitPointers(ObjectPointerVisitor* visitor);
 
   static RawObject* FromAddr(uword addr) {
@@ -170,6 +179,9 @@ class RawObject {
 
   friend class Object;
   friend class Array;
+  friend class HeapHistogramVisitor;
+  friend class HeapSnapshotWriter;
+  friend class Scavenger;
   friend class SnapshotWriter;
   friend class SnapshotReader;
 
@@ -219,9 +231,15 @@ class RawClass : public RawObject {
   int8_t class_state_;  // Of type ClassState.
   bool is_const_;
   bool is_interface_;
+  // Survival feedback of the instances, see Scavenger::UpdatePretenuring.
+  // is_pretenured_ is tested by the allocation stub of the class.
+  intptr_t is_pretenured_;
+  intptr_t allocated_count_;
+  intptr_t survived_count_;
 
   friend class Object;
   friend class RawInstance;
+  friend class Scavenger;
 };
 
 
@@ -373,6 +391,7 @@ class RawFunction : public RawObject {
   bool is_static_;
   bool is_const_;
   bool is_optimizable_;
+  bool is_queued_for_optimization_;
 };
 
 
@@ -489,8 +508,9 @@ class RawCode : public RawObject {
   RawPcDescriptors* pc_descriptors_;
   // Ongoing redesign of inline caches may soon remove the need for 'ic_data_'.
   RawArray* ic_data_;  // Used to store IC stub data (see class ICData).
+  RawArray* stackmaps_;  // Stackmaps of the call sites, sorted by pc.
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&ptr()->ic_data_);
+    return reinterpret_cast<RawObject**>(&ptr()->stackmaps_);
   }
 
   intptr_t pointer_offsets_length_;
@@ -499,6 +519,8 @@ class RawCode : public RawObject {
 
   // Variable length data follows here.
   int32_t data_[0];
+
+  friend class DartFrame;
 };
 
 
@@ -535,6 +557,22 @@ class RawExceptionHandlers : public RawObject {
 };
 
 
+// A stackmap describes which of the fixed slots of a Dart frame hold objects
+// at the return address of one call site.
+class RawStackmap : public RawObject {
+  RAW_HEAP_OBJECT_IMPLEMENTATION(Stackmap);
+
+  RawSmi* length_;  // Number of slots described by the bitmap.
+  uword pc_;  // Return address of the call site.
+
+  // Variable length data follows here. Bit i is set if the slot at
+  // fp[-1 - i] holds an object.
+  uint8_t data_[0];
+
+  friend class DartFrame;
+};
+
+
 class RawContext : public RawObject {
   RAW_HEAP_OBJECT_IMPLEMENTATION(Context);
 
@@ -710,6 +748,8 @@ class RawArray : public RawInstance {
     return reinterpret_cast<RawObject**>(&ptr()->data()[length - 1]);
   }
 
+  friend class CodeIndexTable;
+  friend class DartFrame;
   friend class RawImmutableArray;
 };
 
@@ -402,6 +402,8 @@ RawFunction* Function::ReadFrom(SnapshotReader* reader,
   func.set_is_static(reader->Read<bool>());
   func.set_is_const(reader->Read<bool>());
   func.set_is_optimizable(reader->Read<bool>());
+  // The optimization queue is not part of the snapshot.
+  func.set_is_queued_for_optimization(false);
 
   // Set all the object fields.
   // TODO(5411462): Need to assert No GC can happen here, even though
@@ -738,6 +740,21 @@ void RawExceptionHandlers::WriteTo(SnapshotWriter* writer,
 }
 
 
+RawStackmap* Stackmap::ReadFrom(SnapshotReader* reader,
+                                intptr_t object_id,
+                                bool classes_serialized) {
+  UNREACHABLE();
+  return Stackmap::null();
+}
+
+
+void RawStackmap::WriteTo(SnapshotWriter* writer,
+                          intptr_t object_id,
+                          bool serialize_classes) {
+  UNREACHABLE();
+}
+
+
 RawContext* Context::ReadFrom(SnapshotReader* reader,
                               intptr_t object_id,
                               bool classes_serialized) {
@@ -1295,7 +1312,7 @@ RawJSRegExp* JSRegExp::ReadFrom(SnapshotReader* reader,
   regex.raw_ptr()->num_bracket_expressions_ = GetSmi(reader->Read<intptr_t>());
   String& pattern = String::Handle();
   pattern ^= reader->ReadObject();
-  regex.raw_ptr()->pattern_ = pattern.raw();
+  regex.set_pattern(pattern);
   regex.raw_ptr()->type_ = reader->Read<intptr_t>();
   regex.raw_ptr()->flags_ = reader->Read<intptr_t>();
 
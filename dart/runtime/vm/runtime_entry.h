@@ -7,6 +7,7 @@
 
 #include "vm/allocation.h"
 #include "vm/assembler.h"
+#include "vm/exceptions.h"
 #include "vm/flags.h"
 #include "vm/native_arguments.h"
 
@@ -61,6 +62,7 @@ class RuntimeEntry : public ValueObject {
       Zone zone;                                                               \
       HANDLESCOPE();                                                           \
       DRT_Helper##name(arguments);                                             \
+      Exceptions::ThrowPendingOutOfMemory();                                   \
     }                                                                          \
     VERIFY_ON_TRANSITION;                                                      \
   }                                                                            \
@@ -4,20 +4,189 @@
 
 #include "vm/scavenger.h"
 
+#include "vm/atomic.h"
 #include "vm/dart.h"
+#include "vm/dart_api_state.h"
+#include "vm/flags.h"
+#include "vm/freelist.h"
+#include "vm/isolate.h"
 #include "vm/object.h"
+#include "vm/object_stack.h"
+#include "vm/pages.h"
 #include "vm/stack_frame.h"
+#include "vm/store_buffer.h"
+#include "vm/thread_pool.h"
 #include "vm/verifier.h"
 #include "vm/visitor.h"
 
 namespace dart {
 
+DEFINE_FLAG(int, scavenger_tasks, 1,
+    "Number of tasks scavenging new space in parallel, values larger than 1 "
+    "use GC helper threads.");
+DEFINE_FLAG(int, tenure_threshold, 2,
+    "Number of scavenges an object has to survive before it is promoted to "
+    "old space.");
+DEFINE_FLAG(bool, pretenure, false,
+    "Allocate the instances of classes which mostly survive their first "
+    "scavenge directly in old space.");
+DEFINE_FLAG(bool, verify_store_buffer, false,
+    "Verify that all old objects pointing into new space are remembered in "
+    "the store buffer before scavenging.");
+
+enum {
+  kForwardingMask = 3,
+  kNotForwarded = 1,  // Tagged pointer.
+  kForwarded = 3,  // Tagged pointer and forwarding bit set.
+};
+
+
+static inline bool IsForwarding(uword header) {
+  uword bits = header & kForwardingMask;
+  ASSERT((bits == kNotForwarded) || (bits == kForwarded));
+  return bits == kForwarded;
+}
+
+
+static inline uword ForwardedAddr(uword header) {
+  ASSERT(IsForwarding(header));
+  return header & ~kForwardingMask;
+}
+
+
+// Objects are promoted once they have survived this many scavenges.
+static intptr_t TenureThreshold() {
+  intptr_t threshold = Utils::Maximum(FLAG_tenure_threshold, 1);
+  return Utils::Minimum(threshold, Scavenger::kMaxAge);
+}
+
+
+// The shared work list of a parallel scavenge. Tasks publish the unscanned
+// part of their local allocation buffers here when they retire them. The
+// scavenge is done once the list is empty and all tasks are waiting for work.
+class ScavengerWorkList {
+ public:
+  explicit ScavengerWorkList(intptr_t num_tasks)
+      : ranges_(NULL),
+        length_(0),
+        capacity_(0),
+        num_tasks_(num_tasks),
+        num_idle_(0),
+        num_running_helpers_(num_tasks - 1),
+        done_(false) {}
+  ~ScavengerWorkList() {
+    ASSERT(length_ == 0);
+    free(ranges_);
+  }
+
+  // Add the to space range [start, end) of copied but unscanned objects.
+  void Push(uword start, uword end) {
+    ASSERT(start < end);
+    MonitorLocker ml(&monitor_);
+    ASSERT(!done_);
+    if (length_ == capacity_) {
+      Grow();
+    }
+    ranges_[length_].start = start;
+    ranges_[length_].end = end;
+    length_++;
+    ml.Notify();
+  }
+
+  // Wait for a range to scan. Returns false once all tasks ran out of work.
+  bool Pop(uword* start, uword* end) {
+    MonitorLocker ml(&monitor_);
+    num_idle_++;
+    while ((length_ == 0) && !done_) {
+      if (num_idle_ == num_tasks_) {
+        done_ = true;
+        ml.NotifyAll();
+        break;
+      }
+      ml.Wait();
+    }
+    num_idle_--;
+    if (length_ == 0) {
+      ASSERT(done_);
+      return false;
+    }
+    length_--;
+    *start = ranges_[length_].start;
+    *end = ranges_[length_].end;
+    return true;
+  }
+
+  // Helper tasks report their completion, the main thread waits for all of
+  // them before finishing the scavenge.
+  void HelperDone() {
+    MonitorLocker ml(&monitor_);
+    num_running_helpers_--;
+    ml.NotifyAll();
+  }
+  void WaitForHelpers() {
+    MonitorLocker ml(&monitor_);
+    while (num_running_helpers_ > 0) {
+      ml.Wait();
+    }
+  }
+
+ private:
+  struct Range {
+    uword start;
+    uword end;
+  };
+
+  void Grow() {
+    intptr_t new_capacity = (capacity_ == 0) ? 64 : 2 * capacity_;
+    Range* new_ranges = reinterpret_cast<Range*>(
+        realloc(reinterpret_cast<void*>(ranges_),
+                new_capacity * sizeof(Range)));
+    if (new_ranges == NULL) {
+      FATAL("Out of memory growing the scavenger work list.");
+    }
+    ranges_ = new_ranges;
+    capacity_ = new_capacity;
+  }
+
+  Monitor monitor_;
+  Range* ranges_;
+  intptr_t length_;
+  intptr_t capacity_;
+  const intptr_t num_tasks_;
+  intptr_t num_idle_;
+  intptr_t num_running_helpers_;
+  bool done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScavengerWorkList);
+};
+
+
 class ScavengerVisitor : public ObjectPointerVisitor {
  public:
-  explicit ScavengerVisitor(Scavenger* scavenger)
-      : scavenger_(scavenger),
+  // A visitor without a work list scavenges serially. With a work list it
+  // is one of several parallel tasks: it copies objects into its own local
+  // allocation buffer and collects remembered objects in 'remembered_stack'.
+  ScavengerVisitor(Isolate* isolate,
+                   Scavenger* scavenger,
+                   ObjectStack* promoted_stack,
+                   ScavengerWorkList* work_list = NULL,
+                   ObjectStack* remembered_stack = NULL)
+      : isolate_(isolate),
+        scavenger_(scavenger),
         heap_(scavenger->heap_),
-        vm_heap_(Dart::vm_isolate()->heap()) {}
+        vm_heap_(Dart::vm_isolate()->heap()),
+        promoted_stack_(promoted_stack),
+        work_list_(work_list),
+        remembered_stack_(remembered_stack),
+        tenure_threshold_(TenureThreshold()),
+        bytes_promoted_(0),
+        visiting_old_object_(NULL),
+        visiting_card_page_(NULL),
+        lab_scan_(0),
+        lab_top_(0),
+        lab_end_(0) {
+    ASSERT((work_list_ == NULL) == (remembered_stack_ == NULL));
+  }
 
   void VisitPointers(RawObject** first, RawObject** last) {
     for (RawObject** current = first; current <= last; current++) {
@@ -25,24 +194,47 @@ class ScavengerVisitor : public ObjectPointerVisitor {
     }
   }
 
- private:
-  enum {
-    kForwardingMask = 3,
-    kNotForwarded = 1,  // Tagged pointer.
-    kForwarded = 3,  // Tagged pointer and forwarding bit set.
-  };
-
-  static inline bool IsForwarding(uword header) {
-    uword bits = header & kForwardingMask;
-    ASSERT((bits == kNotForwarded) || (bits == kForwarded));
-    return bits == kForwarded;
+  // Set while the pointers of a remembered old object are being visited, so
+  // that the object can be remembered again if it still points into new
+  // space after the scavenge. Arrays in pages with a card table remember the
+  // cards of these pointers instead.
+  void VisitingOldObject(RawObject* obj) {
+    ASSERT((obj == NULL) || obj->IsOldObject());
+    visiting_old_object_ = obj;
+    visiting_card_page_ = NULL;
+    if ((obj != NULL) && obj->IsArray()) {
+      HeapPage* page = HeapPage::Of(obj);
+      if (page->card_table() != NULL) {
+        visiting_card_page_ = page;
+      }
+    }
   }
 
-  static inline uword ForwardedAddr(uword header) {
-    ASSERT(IsForwarding(header));
-    return header & ~kForwardingMask;
+  ObjectStack* promoted_stack() const { return promoted_stack_; }
+  intptr_t bytes_promoted() const { return bytes_promoted_; }
+
+  // Scan the objects copied and promoted by this task, then help the other
+  // tasks until the parallel scavenge is done.
+  void ProcessWork() {
+    ASSERT(work_list_ != NULL);
+    while (true) {
+      ProcessLocalWork();
+      uword start = 0;
+      uword end = 0;
+      if (!work_list_->Pop(&start, &end)) {
+        break;
+      }
+      while (start < end) {
+        RawObject* raw_obj = RawObject::FromAddr(start);
+        start += raw_obj->VisitPointers(this);
+      }
+    }
+    ASSERT(lab_scan_ == lab_top_);
+    RetireLab();
   }
 
+ private:
+
   static inline void ForwardTo(uword orignal, uword target) {
     // Make sure forwarding can be encoded.
     ASSERT((target & kForwardingMask) == 0);
@@ -50,7 +242,124 @@ class ScavengerVisitor : public ObjectPointerVisitor {
   }
 
   void UpdateStoreBuffer(RawObject** p, RawObject* obj) {
-    // TODO(iposva): Implement store buffers.
+    if ((visiting_old_object_ != NULL) && obj->IsNewObject()) {
+      if (visiting_card_page_ != NULL) {
+        // Cards are only ever set, parallel tasks may set them concurrently.
+        visiting_card_page_->RememberCard(p);
+      } else if (remembered_stack_ != NULL) {
+        // The store buffer is not thread safe, remembered objects are merged
+        // into it once all tasks are done.
+        remembered_stack_->Push(visiting_old_object_);
+        visiting_old_object_ = NULL;
+      } else {
+        uword ptr = reinterpret_cast<uword>(visiting_old_object_);
+        isolate_->store_buffer()->AddPointer(ptr);
+      }
+    }
+  }
+
+  void ProcessLocalWork() {
+    while ((lab_scan_ < lab_top_) || !promoted_stack_->IsEmpty()) {
+      while (lab_scan_ < lab_top_) {
+        // Advance the scan pointer before visiting, so that only the objects
+        // behind it are published if the buffer is retired meanwhile.
+        RawObject* raw_obj = RawObject::FromAddr(lab_scan_);
+        lab_scan_ += raw_obj->Size();
+        raw_obj->VisitPointers(this);
+      }
+      while (!promoted_stack_->IsEmpty()) {
+        RawObject* raw_obj = promoted_stack_->Pop();
+        VisitingOldObject(raw_obj);
+        raw_obj->VisitPointers(this);
+      }
+      VisitingOldObject(NULL);
+    }
+  }
+
+  // Publish the unscanned objects of the current local allocation buffer and
+  // fill its unused tail to keep to space walkable.
+  void RetireLab() {
+    if (lab_scan_ < lab_top_) {
+      work_list_->Push(lab_scan_, lab_top_);
+    }
+    if (lab_top_ < lab_end_) {
+      FreeListElement::AsElement(lab_top_, lab_end_ - lab_top_);
+    }
+    lab_scan_ = 0;
+    lab_top_ = 0;
+    lab_end_ = 0;
+  }
+
+  uword TryAllocateInLab(intptr_t size) {
+    if ((lab_end_ - lab_top_) < static_cast<uword>(size)) {
+      RetireLab();
+      intptr_t lab_size = 0;
+      uword lab = scavenger_->AtomicTryAllocate(size, &lab_size);
+      if (lab == 0) {
+        return 0;
+      }
+      lab_scan_ = lab;
+      lab_top_ = lab;
+      lab_end_ = lab + lab_size;
+    }
+    uword result = lab_top_;
+    lab_top_ += size;
+    return result;
+  }
+
+  // Copy the object at 'raw_addr' whose header was read as 'header' while
+  // other tasks may be racing to copy it. Returns the forwarding address.
+  uword ParallelCopy(uword raw_addr, uword header) {
+    RawObject* raw_obj = RawObject::FromAddr(raw_addr);
+    // Another task may replace the header with a forwarding address at any
+    // time, so the size is computed from the class read above.
+    intptr_t size = raw_obj->SizeFromClass(reinterpret_cast<RawClass*>(header));
+    intptr_t age = scavenger_->AgeOf(raw_addr) + 1;
+    uword new_addr = 0;
+    bool promoted = false;
+    if (age >= tenure_threshold_) {
+      new_addr = scavenger_->TryAllocatePromoted(size);
+      promoted = (new_addr != 0);
+    }
+    if (new_addr == 0) {
+      new_addr = TryAllocateInLab(size);
+      if (new_addr == 0) {
+        // To space can be exhausted by the unused tails of retired buffers,
+        // promote the object instead.
+        new_addr = scavenger_->TryAllocatePromoted(size);
+        if (new_addr == 0) {
+          new_addr = scavenger_->AllocatePromotedFromReserve(size);
+          if (new_addr == 0) {
+            FATAL("Exhausted heap space while scavenging.");
+          }
+        }
+        promoted = true;
+      }
+    }
+    memmove(reinterpret_cast<void*>(new_addr),
+            reinterpret_cast<void*>(raw_addr),
+            size);
+    *reinterpret_cast<uword*>(new_addr) = header;
+    ASSERT((new_addr & kForwardingMask) == 0);
+    uword result = AtomicOperations::CompareAndSwapWord(
+        reinterpret_cast<uword*>(raw_addr), header, new_addr | kForwarded);
+    if (result != header) {
+      // Another task forwarded the object first, drop our copy.
+      if (promoted) {
+        scavenger_->FreePromoted(new_addr, size);
+      } else {
+        ASSERT(new_addr + size == lab_top_);
+        lab_top_ = new_addr;
+      }
+      return ForwardedAddr(result);
+    }
+    if (promoted) {
+      promoted_stack_->Push(RawObject::FromAddr(new_addr));
+      bytes_promoted_ += size;
+    } else {
+      scavenger_->SetAge(new_addr, Utils::Minimum(age, Scavenger::kMaxAge));
+    }
+    return new_addr;
   }
 
   void ScavengePointer(RawObject** p) {
@@ -80,17 +389,36 @@ class ScavengerVisitor : public ObjectPointerVisitor {
     if (IsForwarding(header)) {
       // Get the new location of the object.
       new_addr = ForwardedAddr(header);
+    } else if (work_list_ != NULL) {
+      new_addr = ParallelCopy(raw_addr, header);
     } else {
       intptr_t size = raw_obj->Size();
-      // TODO(iposva): Check whether object should be promoted.
-      new_addr = scavenger_->TryAllocate(size);
-      // During a scavenge we always succeed to at least copy all of the
-      // current objects to the to space.
-      ASSERT(new_addr != 0);
-      // Copy the object to the new location.
-      memmove(reinterpret_cast<void*>(new_addr),
-              reinterpret_cast<void*>(raw_addr),
-              size);
+      // Count this scavenge as survived.
+      intptr_t age = scavenger_->AgeOf(raw_addr) + 1;
+      if (age >= tenure_threshold_) {
+        // Promote the object to old space. If old space is exhausted it
+        // stays in new space for another cycle.
+        new_addr = heap_->TryAllocatePromoted(size);
+      }
+      if (new_addr != 0) {
+        memmove(reinterpret_cast<void*>(new_addr),
+                reinterpret_cast<void*>(raw_addr),
+                size);
+        // The pointers of the promoted object are visited once the to space
+        // has been processed.
+        promoted_stack_->Push(RawObject::FromAddr(new_addr));
+        bytes_promoted_ += size;
+      } else {
+        new_addr = scavenger_->TryAllocate(size);
+        // During a scavenge we always succeed to at least copy all of the
+        // current objects to the to space.
+        ASSERT(new_addr != 0);
+        // Copy the object to the new location.
+        memmove(reinterpret_cast<void*>(new_addr),
+                reinterpret_cast<void*>(raw_addr),
+                size);
+        scavenger_->SetAge(new_addr, Utils::Minimum(age, Scavenger::kMaxAge));
+      }
       // Remember forwarding address.
       ForwardTo(raw_addr, new_addr);
     }
@@ -101,30 +429,254 @@ class ScavengerVisitor : public ObjectPointerVisitor {
     UpdateStoreBuffer(p, new_obj);
   }
 
+  Isolate* isolate_;
   Scavenger* scavenger_;
   Heap* heap_;
   Heap* vm_heap_;
+  ObjectStack* promoted_stack_;
+  ScavengerWorkList* work_list_;
+  ObjectStack* remembered_stack_;
+  const intptr_t tenure_threshold_;
+  intptr_t bytes_promoted_;
+  RawObject* visiting_old_object_;
+  HeapPage* visiting_card_page_;
+
+  // Local allocation buffer of a parallel task: [lab_scan_, lab_top_) holds
+  // copied but unscanned objects, [lab_top_, lab_end_) is unused.
+  uword lab_scan_;
+  uword lab_top_;
+  uword lab_end_;
+};
+
+
+// Visits the weak persistent handles once all surviving objects have been
+// copied. Handles to objects which were not copied are cleared and queued
+// for finalization, the others are updated to the new addresses.
+class ScavengerWeakVisitor : public ObjectPointerVisitor {
+ public:
+  ScavengerWeakVisitor(Scavenger* scavenger, ApiState* api_state)
+      : scavenger_(scavenger), api_state_(api_state) {}
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      RawObject* raw_obj = *current;
+      if (!raw_obj->IsHeapObject()) {
+        continue;
+      }
+      uword raw_addr = RawObject::ToAddr(raw_obj);
+      if (!scavenger_->from_->Contains(raw_addr)) {
+        continue;
+      }
+      uword header = *reinterpret_cast<uword*>(raw_addr);
+      if (IsForwarding(header)) {
+        *current = RawObject::FromAddr(ForwardedAddr(header));
+      } else {
+        api_state_->QueueFinalization(
+            reinterpret_cast<PersistentHandle*>(current));
+      }
+    }
+  }
+
+ private:
+  Scavenger* scavenger_;
+  ApiState* api_state_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScavengerWeakVisitor);
 };
 
 
-Scavenger::Scavenger(Heap* heap, intptr_t max_capacity, uword object_alignment)
-    : heap_(heap),
+// One task of a parallel scavenge. Each task visits its share of the
+// remembered old objects, of the large pages with cards and of the sets of
+// isolate roots. The first task runs on the thread owning the isolate and
+// visits the roots which can only be visited on that thread.
+class ScavengerTask {
+ public:
+  ScavengerTask(Isolate* isolate,
+                Scavenger* scavenger,
+                ScavengerWorkList* work_list,
+                uword* remembered,
+                intptr_t remembered_length,
+                HeapPage* large_pages,
+                intptr_t index,
+                intptr_t num_tasks)
+      : isolate_(isolate),
+        scavenger_(scavenger),
+        work_list_(work_list),
+        remembered_(remembered),
+        remembered_length_(remembered_length),
+        large_pages_(large_pages),
+        index_(index),
+        num_tasks_(num_tasks),
+        visitor_(isolate,
+                 scavenger,
+                 &promoted_stack_,
+                 work_list,
+                 &remembered_stack_) {}
+
+  void Run() {
+    for (intptr_t i = index_; i < remembered_length_; i += num_tasks_) {
+      RawObject* raw_obj = reinterpret_cast<RawObject*>(remembered_[i]);
+      visitor_.VisitingOldObject(raw_obj);
+      raw_obj->VisitPointers(&visitor_);
+    }
+    visitor_.VisitingOldObject(NULL);
+    scavenger_->IterateRememberedCards(large_pages_, &visitor_,
+                                       index_, num_tasks_);
+    for (intptr_t i = 0; i < Isolate::kNumRootSets; i++) {
+      Isolate::RootSet root_set = static_cast<Isolate::RootSet>(i);
+      intptr_t task = Isolate::NeedsIsolateThread(root_set) ?
+          0 : (i % num_tasks_);
+      if (task == index_) {
+        isolate_->VisitRootSet(root_set, &visitor_,
+                               StackFrameIterator::kDontValidateFrames);
+      }
+    }
+    visitor_.ProcessWork();
+  }
+
+  // Entry point of the helper tasks, run on the threads of the thread pool.
+  static void RunHelper(uword parameter) {
+    ScavengerTask* task = reinterpret_cast<ScavengerTask*>(parameter);
+    task->Run();
+    task->work_list_->HelperDone();
+  }
+
+  ObjectStack* remembered_stack() { return &remembered_stack_; }
+  intptr_t bytes_promoted() const { return visitor_.bytes_promoted(); }
+
+ private:
+  Isolate* isolate_;
+  Scavenger* scavenger_;
+  ScavengerWorkList* work_list_;
+  uword* remembered_;
+  intptr_t remembered_length_;
+  HeapPage* large_pages_;
+  const intptr_t index_;
+  const intptr_t num_tasks_;
+  ObjectStack promoted_stack_;
+  ObjectStack remembered_stack_;
+  ScavengerVisitor visitor_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScavengerTask);
+};
+
+
+// Checks whether any of the visited pointers points into new space.
+class ContainsNewPointerVisitor : public ObjectPointerVisitor {
+ public:
+  ContainsNewPointerVisitor() : found_(false) {}
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      RawObject* raw_obj = *current;
+      if (raw_obj->IsHeapObject() && raw_obj->IsNewObject()) {
+        found_ = true;
+      }
+    }
+  }
+
+  bool found() const { return found_; }
+
+ private:
+  bool found_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContainsNewPointerVisitor);
+};
+
+
+// Other objects in pages with a card table are remembered by any dirty card.
+static bool HasDirtyCard(HeapPage* page) {
+  uint8_t* cards = page->card_table();
+  if (cards == NULL) {
+    return false;
+  }
+  for (intptr_t i = 0; i < page->card_count(); i++) {
+    if (cards[i] != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+// Checks that the card of every visited pointer into new space is dirty.
+class VerifyCardsVisitor : public ObjectPointerVisitor {
+ public:
+  explicit VerifyCardsVisitor(HeapPage* page) : page_(page) {}
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      RawObject* raw_obj = *current;
+      if (raw_obj->IsHeapObject() && raw_obj->IsNewObject() &&
+          !page_->IsCardRemembered(current)) {
+        FATAL1("Slot %p points into new space but its card is not dirty.",
+               current);
+      }
+    }
+  }
+
+ private:
+  HeapPage* page_;
+
+  DISALLOW_COPY_AND_ASSIGN(VerifyCardsVisitor);
+};
+
+
+// Checks that every old object pointing into new space is remembered, either
+// in the store buffer or by the cards of its page.
+class VerifyStoreBufferVisitor : public ObjectVisitor {
+ public:
+  explicit VerifyStoreBufferVisitor(StoreBuffer* store_buffer)
+      : store_buffer_(store_buffer) {}
+
+  void VisitObject(RawObject* raw_obj) {
+    if (store_buffer_->Contains(reinterpret_cast<uword>(raw_obj))) {
+      return;
+    }
+    HeapPage* page = HeapPage::Of(raw_obj);
+    if ((page->card_table() != NULL) && raw_obj->IsArray()) {
+      VerifyCardsVisitor visitor(page);
+      raw_obj->VisitPointers(&visitor);
+      return;
+    }
+    ContainsNewPointerVisitor visitor;
+    raw_obj->VisitPointers(&visitor);
+    if (visitor.found() && !HasDirtyCard(page)) {
+      FATAL1("Old object %p points into new space but is not remembered.",
+             raw_obj);
+    }
+  }
+
+ private:
+  StoreBuffer* store_buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(VerifyStoreBufferVisitor);
+};
+
+
+Scavenger::Scavenger(Heap* heap,
+                     intptr_t min_semi_space_size,
+                     intptr_t max_semi_space_size,
+                     uword object_alignment)
+    : to_(NULL),
+      from_(NULL),
+      min_semi_space_size_(0),
+      max_semi_space_size_(0),
+      target_semi_space_size_(0),
+      last_scavenge_end_(0),
+      heap_(heap),
       object_alignment_(object_alignment),
       count_(0),
+      collection_time_micros_(0),
       scavenging_(false) {
-  // Allocate the virtual memory for this scavenge heap.
-  space_ = VirtualMemory::Reserve(max_capacity);
-  ASSERT(space_ != NULL);
-
-  // Allocate the entire space at the beginning.
-  space_->Commit(false);
+  SetSemiSpaceLimits(min_semi_space_size, max_semi_space_size);
+  target_semi_space_size_ = min_semi_space_size_;
 
-  // Setup the semi spaces.
-  uword semi_space_size = space_->size() / 2;
-  ASSERT((semi_space_size & (VirtualMemory::PageSize() - 1)) == 0);
-  to_ = new MemoryRegion(space_->address(), semi_space_size);
-  uword middle = space_->start() + semi_space_size;
-  from_ = new MemoryRegion(reinterpret_cast<void*>(middle), semi_space_size);
+  // Setup the semi spaces, starting out small.
+  to_ = AllocateSemiSpace(target_semi_space_size_);
+  from_ = AllocateSemiSpace(target_semi_space_size_);
+  to_ages_ = AllocateAges(target_semi_space_size_);
+  from_ages_ = AllocateAges(target_semi_space_size_);
 
   // Make sure that the two semi-spaces are aligned properly.
   ASSERT(Utils::IsAligned(to_->start(), kObjectAlignment));
@@ -133,9 +685,11 @@ Scavenger::Scavenger(Heap* heap, intptr_t max_capacity, uword object_alignment)
   // Setup local fields.
   top_ = FirstObjectStart();
   end_ = to_->end();
+  survivor_end_ = FirstObjectStart();
+  last_scavenge_end_ = OS::GetCurrentTimeMicros();
 #if defined(DEBUG)
-  memset(to_->pointer(), 0xf3, to_->size());
-  memset(from_->pointer(), 0xf3, from_->size());
+  memset(to_->address(), 0xf3, to_->size());
+  memset(from_->address(), 0xf3, from_->size());
 #endif  // defined(DEBUG)
 }
 
@@ -143,45 +697,343 @@ Scavenger::Scavenger(Heap* heap, intptr_t max_capacity, uword object_alignment)
 Scavenger::~Scavenger() {
   delete to_;
   delete from_;
-  delete space_;
+  free(to_ages_);
+  free(from_ages_);
+}
+
+
+VirtualMemory* Scavenger::AllocateSemiSpace(intptr_t size) {
+  ASSERT(Utils::IsAligned(size, VirtualMemory::PageSize()));
+  VirtualMemory* memory =
+      VirtualMemory::ReserveHeapRegion(size, VirtualMemory::PageSize());
+  if ((memory == NULL) || !memory->Commit(false)) {
+    FATAL("Out of memory allocating a new space semi-space.");
+  }
+  return memory;
+}
+
+
+uint8_t* Scavenger::AllocateAges(intptr_t size) {
+  // One age entry per object alignment unit. The tables are only touched for
+  // surviving objects.
+  intptr_t ages_size = size / kObjectAlignment;
+  uint8_t* ages =
+      reinterpret_cast<uint8_t*>(calloc(ages_size, sizeof(uint8_t)));
+  if (ages == NULL) {
+    FATAL("Out of memory allocating the new space age table.");
+  }
+  return ages;
+}
+
+
+void Scavenger::SetSemiSpaceLimits(intptr_t min_size, intptr_t max_size) {
+  // Semi-spaces are whole pages and hold at least one allocation buffer of a
+  // parallel scavenger task.
+  intptr_t page_size = VirtualMemory::PageSize();
+  min_semi_space_size_ =
+      Utils::RoundUp(Utils::Maximum(min_size, 2 * kLabSize), page_size);
+  max_semi_space_size_ =
+      Utils::RoundUp(Utils::Maximum(max_size, min_semi_space_size_),
+                     page_size);
+  target_semi_space_size_ = Utils::Maximum(
+      Utils::Minimum(target_semi_space_size_, max_semi_space_size_),
+      min_semi_space_size_);
+}
+
+
+void Scavenger::UpdateTargetSize(intptr_t survived,
+                                 int64_t start,
+                                 int64_t end) {
+  intptr_t size = to_->size();
+  int64_t scavenge_time = end - start;
+  int64_t total_time = end - last_scavenge_end_;
+  last_scavenge_end_ = end;
+  if (((survived / kGrowSurvivalPercent) > (size / 100)) ||
+      ((scavenge_time * 100) > (total_time * kGrowTimePercent))) {
+    size = 2 * size;
+  } else if (((survived / kShrinkSurvivalPercent) < (size / 100)) &&
+             ((scavenge_time * 100) < (total_time * kShrinkTimePercent))) {
+    size = Utils::RoundUp(size / 2, VirtualMemory::PageSize());
+  }
+  target_semi_space_size_ = Utils::Maximum(
+      Utils::Minimum(size, max_semi_space_size_), min_semi_space_size_);
+}
+
+
+uword Scavenger::AtomicTryAllocate(intptr_t min_size, intptr_t* size) {
+  ASSERT(Utils::IsAligned(min_size, kObjectAlignment));
+  uword top = top_;
+  while (true) {
+    // The last word of to space cannot hold an aligned object.
+    intptr_t remaining = Utils::RoundDown(end_ - top, kObjectAlignment);
+    if (remaining < min_size) {
+      return 0;
+    }
+    intptr_t chunk_size =
+        Utils::Minimum(Utils::Maximum(min_size, kLabSize), remaining);
+    uword old_top =
+        AtomicOperations::CompareAndSwapWord(&top_, top, top + chunk_size);
+    if (old_top == top) {
+      *size = chunk_size;
+      return top;
+    }
+    top = old_top;
+  }
+}
+
+
+uword Scavenger::TryAllocatePromoted(intptr_t size) {
+  MutexLocker ml(&promotion_mutex_);
+  return heap_->TryAllocatePromoted(size);
+}
+
+
+uword Scavenger::AllocatePromotedFromReserve(intptr_t size) {
+  MutexLocker ml(&promotion_mutex_);
+  return heap_->AllocateFromReserve(size, Heap::kOld);
+}
+
+
+void Scavenger::FreePromoted(uword addr, intptr_t size) {
+  MutexLocker ml(&promotion_mutex_);
+  heap_->FreePromoted(addr, size);
 }
 
 
 void Scavenger::Prologue() {
+  // Resize the empty from space before it becomes the to space. It has to be
+  // large enough to hold all objects which could survive this scavenge.
+  intptr_t used = top_ - to_->start();
+  intptr_t size = Utils::Maximum(
+      target_semi_space_size_,
+      Utils::RoundUp(used, VirtualMemory::PageSize()));
+  if (from_->size() != size) {
+    delete from_;
+    free(from_ages_);
+    from_ = AllocateSemiSpace(size);
+    from_ages_ = AllocateAges(size);
+  }
+
   // Flip the two semi-spaces so that to_ is always the space for allocating
   // objects.
-  MemoryRegion* temp = from_;
+  VirtualMemory* temp = from_;
   from_ = to_;
   to_ = temp;
+  // The ages of the survivors of the last scavenge move along with them.
+  uint8_t* temp_ages = from_ages_;
+  from_ages_ = to_ages_;
+  to_ages_ = temp_ages;
   top_ = FirstObjectStart();
   end_ = to_->end();
 }
 
 
 void Scavenger::Epilogue() {
+  // All objects copied by this scavenge are below the current top.
+  survivor_end_ = top_;
 #if defined(DEBUG)
-  memset(from_->pointer(), 0xf3, from_->size());
+  memset(from_->address(), 0xf3, from_->size());
 #endif  // defined(DEBUG)
 }
 
 
-void Scavenger::IterateRoots(ObjectPointerVisitor* visitor) {
-  Isolate::Current()->VisitObjectPointers(
-      visitor, StackFrameIterator::kDontValidateFrames);
-  heap_->IterateOldPointers(visitor);
+void Scavenger::UpdatePretenuring(uword start, uword end) {
+  // The objects allocated since the last scavenge have been forwarded if they
+  // survived, otherwise they are left in from space as garbage. Only the
+  // objects at the start of the allocated area are sampled.
+  end = Utils::Minimum(end, start + kPretenureScanSize);
+  uword cur = start;
+  while (cur < end) {
+    uword header = *reinterpret_cast<uword*>(cur);
+    bool survived = IsForwarding(header);
+    RawObject* raw_obj =
+        RawObject::FromAddr(survived ? ForwardedAddr(header) : cur);
+    RawClass* cls = raw_obj->ptr()->class_->ptr();
+    cur += raw_obj->Size();
+    // Only instances of Dart classes are allocated by allocation stubs, the
+    // instances of pretenured classes found here were allocated before the
+    // class was pretenured.
+    if ((cls->instance_kind_ != Instance::kInstanceKind) ||
+        (cls->is_pretenured_ != 0)) {
+      continue;
+    }
+    cls->allocated_count_++;
+    if (survived) {
+      cls->survived_count_++;
+    }
+    if (cls->allocated_count_ == kPretenureSampleSize) {
+      if ((cls->survived_count_ * 100) >=
+          (kPretenureSampleSize * kPretenureSurvivalPercent)) {
+        cls->is_pretenured_ = 1;
+      }
+      cls->allocated_count_ = 0;
+      cls->survived_count_ = 0;
+    }
+  }
+}
+
+
+void Scavenger::IterateStoreBuffers(Isolate* isolate,
+                                    ScavengerVisitor* visitor) {
+  // Drain the pending store buffer block and take all remembered objects.
+  // The visitor remembers the objects that still point into new space again.
+  isolate->store_buffer_block()->ProcessBuffer(isolate);
+  intptr_t length = 0;
+  uword* pointers = isolate->store_buffer()->TakePointers(&length);
+  for (intptr_t i = 0; i < length; i++) {
+    RawObject* raw_obj = reinterpret_cast<RawObject*>(pointers[i]);
+    visitor->VisitingOldObject(raw_obj);
+    raw_obj->VisitPointers(visitor);
+  }
+  visitor->VisitingOldObject(NULL);
+  free(pointers);
+}
+
+
+void Scavenger::IterateRememberedCards(HeapPage* pages,
+                                       ScavengerVisitor* visitor,
+                                       intptr_t first,
+                                       intptr_t stride) {
+  intptr_t index = 0;
+  for (HeapPage* page = pages;
+       page != NULL;
+       page = page->next(), index++) {
+    if ((index % stride) != first) {
+      continue;
+    }
+    uint8_t* cards = page->card_table();
+    ASSERT(cards != NULL);
+    intptr_t card_count = page->card_count();
+    RawObject* raw_obj = RawObject::FromAddr(page->first_object_start());
+    // The cards are cleared before their slots are visited. Visiting them as
+    // the slots of an old object sets the cards of the slots which still
+    // point into new space again.
+    visitor->VisitingOldObject(raw_obj);
+    if (raw_obj->IsArray()) {
+      // Only the slots covered by dirty cards are visited.
+      uword object_start = RawObject::ToAddr(raw_obj);
+      uword object_end = object_start + raw_obj->Size();
+      for (intptr_t i = 0; i < card_count; i++) {
+        if (cards[i] == 0) {
+          continue;
+        }
+        cards[i] = 0;
+        uword card_start = page->start() + (i << HeapPage::kCardBits);
+        uword first = Utils::Maximum(card_start, object_start);
+        uword end = Utils::Minimum(card_start + HeapPage::kCardSize,
+                                   object_end);
+        if (first < end) {
+          visitor->VisitPointers(reinterpret_cast<RawObject**>(first),
+                                 reinterpret_cast<RawObject**>(end) - 1);
+        }
+      }
+    } else {
+      // Other large objects are visited as a whole if any card is dirty, and
+      // are remembered in the store buffer if they still point into new
+      // space.
+      bool is_dirty = false;
+      for (intptr_t i = 0; i < card_count; i++) {
+        if (cards[i] != 0) {
+          is_dirty = true;
+          cards[i] = 0;
+        }
+      }
+      if (is_dirty) {
+        raw_obj->VisitPointers(visitor);
+      }
+    }
+  }
+  visitor->VisitingOldObject(NULL);
+}
+
+
+void Scavenger::IterateRoots(Isolate* isolate, ScavengerVisitor* visitor) {
+  IterateStoreBuffers(isolate, visitor);
+  IterateRememberedCards(heap_->OldLargePages(), visitor, 0, 1);
+  isolate->VisitObjectPointers(visitor,
+                               StackFrameIterator::kDontValidateFrames);
+}
+
+
+void Scavenger::ProcessWeakHandles(Isolate* isolate) {
+  ApiState* api_state = isolate->api_state();
+  if (api_state == NULL) {
+    return;
+  }
+  ScavengerWeakVisitor visitor(this, api_state);
+  api_state->VisitWeakPersistentHandles(&visitor);
 }
 
 
-void Scavenger::ProcessToSpace(ObjectPointerVisitor* visitor) {
+void Scavenger::VerifyStoreBuffers(Isolate* isolate) {
+  isolate->store_buffer_block()->ProcessBuffer(isolate);
+  VerifyStoreBufferVisitor visitor(isolate->store_buffer());
+  heap_->IterateOldObjects(&visitor);
+}
+
+
+void Scavenger::ProcessToSpace(ScavengerVisitor* visitor) {
   uword resolved_top = FirstObjectStart();
+  ObjectStack* promoted_stack = visitor->promoted_stack();
   // Iterate until all work has been drained.
-  while (resolved_top < top_) {
-    RawObject* raw_obj = RawObject::FromAddr(resolved_top);
-    resolved_top += raw_obj->VisitPointers(visitor);
+  while ((resolved_top < top_) || !promoted_stack->IsEmpty()) {
+    while (resolved_top < top_) {
+      RawObject* raw_obj = RawObject::FromAddr(resolved_top);
+      resolved_top += raw_obj->VisitPointers(visitor);
+    }
+    // Promoted objects are old and have to be remembered if they still point
+    // into new space once visited.
+    while (!promoted_stack->IsEmpty()) {
+      RawObject* raw_obj = promoted_stack->Pop();
+      visitor->VisitingOldObject(raw_obj);
+      raw_obj->VisitPointers(visitor);
+    }
+    visitor->VisitingOldObject(NULL);
   }
 }
 
 
+intptr_t Scavenger::ParallelScavenge(Isolate* isolate, intptr_t num_tasks) {
+  ASSERT(num_tasks > 1);
+  isolate->store_buffer_block()->ProcessBuffer(isolate);
+  intptr_t length = 0;
+  uword* pointers = isolate->store_buffer()->TakePointers(&length);
+  // Large pages are added while objects are promoted, only the pages which
+  // existed before the scavenge have cards to visit.
+  HeapPage* large_pages = heap_->OldLargePages();
+
+  ScavengerWorkList work_list(num_tasks);
+  ScavengerTask** tasks = new ScavengerTask*[num_tasks];
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    tasks[i] = new ScavengerTask(isolate, this, &work_list, pointers, length,
+                                 large_pages, i, num_tasks);
+  }
+  ThreadPool* thread_pool = Dart::thread_pool();
+  for (intptr_t i = 1; i < num_tasks; i++) {
+    thread_pool->Run(ScavengerTask::RunHelper,
+                     reinterpret_cast<uword>(tasks[i]));
+  }
+  tasks[0]->Run();
+  work_list.WaitForHelpers();
+
+  // Remember the old objects which still point into new space.
+  intptr_t bytes_promoted = 0;
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    ObjectStack* remembered_stack = tasks[i]->remembered_stack();
+    while (!remembered_stack->IsEmpty()) {
+      store_buffer->AddPointer(
+          reinterpret_cast<uword>(remembered_stack->Pop()));
+    }
+    bytes_promoted += tasks[i]->bytes_promoted();
+    delete tasks[i];
+  }
+  delete[] tasks;
+  free(pointers);
+  return bytes_promoted;
+}
+
+
 void Scavenger::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
   uword cur = FirstObjectStart();
   while (cur < top_) {
@@ -191,23 +1043,67 @@ void Scavenger::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
 }
 
 
+void Scavenger::VisitObjects(ObjectVisitor* visitor) const {
+  uword cur = FirstObjectStart();
+  while (cur < top_) {
+    RawObject* raw_obj = RawObject::FromAddr(cur);
+    visitor->VisitObject(raw_obj);
+    cur += raw_obj->Size();
+  }
+}
+
+
 void Scavenger::Scavenge() {
   // Scavenging is not reentrant. Make sure that is the case.
   ASSERT(!scavenging_);
   scavenging_ = true;
   NoHandleScope no_handles;
 
+  Isolate* isolate = Isolate::Current();
+  if (FLAG_verify_store_buffer) {
+    VerifyStoreBuffers(isolate);
+  }
+
   Timer timer(FLAG_verbose_gc, "Scavenge");
   timer.Start();
-  // Setup the visitor and run a scavenge.
-  ScavengerVisitor visitor(this);
+  int64_t start = OS::GetCurrentTimeMicros();
+  intptr_t in_use_before = in_use();
+  intptr_t capacity_before = capacity();
+  intptr_t bytes_promoted = 0;
+  // The objects allocated since the last scavenge, in from space once the
+  // semi-spaces have been flipped.
+  uword allocated_start = survivor_end_;
+  uword allocated_end = top_;
   Prologue();
-  IterateRoots(&visitor);
-  ProcessToSpace(&visitor);
+  if (FLAG_scavenger_tasks > 1) {
+    bytes_promoted = ParallelScavenge(isolate, FLAG_scavenger_tasks);
+  } else {
+    // Setup the visitor and run a scavenge.
+    ObjectStack promoted_stack;
+    ScavengerVisitor visitor(isolate, this, &promoted_stack);
+    IterateRoots(isolate, &visitor);
+    ProcessToSpace(&visitor);
+    bytes_promoted = visitor.bytes_promoted();
+  }
+  ProcessWeakHandles(isolate);
+  if (FLAG_pretenure) {
+    UpdatePretenuring(allocated_start, allocated_end);
+  }
   Epilogue();
+  int64_t end = OS::GetCurrentTimeMicros();
+  UpdateTargetSize(in_use(), start, end);
+  collection_time_micros_ += end - start;
   timer.Stop();
   if (FLAG_verbose_gc) {
-    OS::PrintErr("Scavenge[%d]: %dus\n", count_, timer.TotalElapsedTime());
+    OS::PrintErr("Scavenge[%d]: %dus (%dK -> %dK, promoted %dK, "
+                 "semi-space %dK -> %dK)\n",
+                 count_,
+                 timer.TotalElapsedTime(),
+                 in_use_before / KB,
+                 in_use() / KB,
+                 bytes_promoted / KB,
+                 capacity_before / KB,
+                 target_semi_space_size_ / KB);
   }
 
   count_++;
@@ -7,6 +7,7 @@
 
 #include "vm/globals.h"
 #include "vm/object.h"
+#include "vm/thread.h"
 #include "vm/utils.h"
 #include "vm/virtual_memory.h"
 
@@ -14,10 +15,23 @@ namespace dart {
 
 // Forward declarations.
 class Heap;
+class HeapPage;
+class Isolate;
+class ScavengerTask;
+class ScavengerVisitor;
 
 class Scavenger {
  public:
-  Scavenger(Heap* heap, intptr_t max_capacity, uword object_alignment);
+  // Ages saturate at this value.
+  static const intptr_t kMaxAge = 0xff;
+
+  // Each of the two semi-spaces starts out at 'min_semi_space_size' bytes.
+  // It grows towards 'max_semi_space_size' when scavenges are frequent or
+  // many objects survive them, and shrinks again when they are not.
+  Scavenger(Heap* heap,
+            intptr_t min_semi_space_size,
+            intptr_t max_semi_space_size,
+            uword object_alignment);
   ~Scavenger();
 
   // Check whether this Scavenger contains this address.
@@ -62,19 +76,116 @@ class Scavenger {
   static intptr_t end_offset() { return OFFSET_OF(Scavenger, end_); }
 
   intptr_t in_use() const { return (top_ - FirstObjectStart()); }
+  intptr_t capacity() const { return to_->size(); }
+
+  // Number of scavenges and the total time spent in them.
+  intptr_t collections() const { return count_; }
+  int64_t collection_time_micros() const { return collection_time_micros_; }
+
+  // Limit the size of each semi-space. The semi-spaces are resized when they
+  // are flipped by the next scavenge.
+  void SetSemiSpaceLimits(intptr_t min_size, intptr_t max_size);
+  intptr_t min_semi_space_size() const { return min_semi_space_size_; }
+  intptr_t max_semi_space_size() const { return max_semi_space_size_; }
+  // Size of the semi-spaces after the next scavenge.
+  intptr_t target_semi_space_size() const { return target_semi_space_size_; }
 
   void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
+  void VisitObjects(ObjectVisitor* visitor) const;
 
  private:
   uword FirstObjectStart() const { return to_->start() | object_alignment_; }
+
+  // Number of scavenges survived by the object at 'addr' in from space.
+  // Objects allocated since the last scavenge are above survivor_end_.
+  intptr_t AgeOf(uword addr) const {
+    ASSERT(from_->Contains(addr));
+    if (addr >= survivor_end_) {
+      return 0;
+    }
+    return from_ages_[(addr - from_->start()) / kObjectAlignment];
+  }
+  void SetAge(uword addr, intptr_t age) {
+    ASSERT(to_->Contains(addr));
+    ASSERT((age > 0) && (age <= kMaxAge));
+    to_ages_[(addr - to_->start()) / kObjectAlignment] =
+        static_cast<uint8_t>(age);
+  }
+
+  // Size of the local allocation buffers handed out to parallel scavenger
+  // tasks.
+  static const intptr_t kLabSize = 16 * KB;
+
+  // Atomically carve a chunk of at least 'min_size' bytes out of to space for
+  // a parallel scavenger task. Returns 0 if to space is exhausted, otherwise
+  // the chunk start with its size in 'size'.
+  uword AtomicTryAllocate(intptr_t min_size, intptr_t* size);
+
+  // Promotion into old space is serialized between scavenger tasks. A
+  // promoted copy which lost the race to forward its object is freed again.
+  uword TryAllocatePromoted(intptr_t size);
+  void FreePromoted(uword addr, intptr_t size);
+  // Promote into the reserve of old space once both to space and old space
+  // are exhausted, the mutator throws an OutOfMemoryException afterwards.
+  uword AllocatePromotedFromReserve(intptr_t size);
+
+  // Semi-spaces double in size when survivors fill more than
+  // kGrowSurvivalPercent of them, or when scavenging takes more than
+  // kGrowTimePercent of the time since the end of the previous scavenge. They
+  // are halved when both stay below the shrink thresholds.
+  static const intptr_t kGrowSurvivalPercent = 25;
+  static const intptr_t kGrowTimePercent = 10;
+  static const intptr_t kShrinkSurvivalPercent = 5;
+  static const intptr_t kShrinkTimePercent = 1;
+
+  static VirtualMemory* AllocateSemiSpace(intptr_t size);
+  static uint8_t* AllocateAges(intptr_t size);
+
+  void UpdateTargetSize(intptr_t survived, int64_t start, int64_t end);
+
+  // Classes are pretenured once at least kPretenureSurvivalPercent of a
+  // sample of kPretenureSampleSize instances survived their first scavenge.
+  static const intptr_t kPretenureSampleSize = 1000;
+  static const intptr_t kPretenureSurvivalPercent = 90;
+  // Bytes of the objects allocated since the last scavenge which are walked
+  // for the sample.
+  static const intptr_t kPretenureScanSize = 64 * KB;
+
+  // Count the instances allocated at the start of [start, end) of from space
+  // since the last scavenge and how many of them survived, and pretenure the classes
+  // whose instances mostly survive.
+  void UpdatePretenuring(uword start, uword end);
+
   void Prologue();
-  void IterateRoots(ObjectPointerVisitor* visitor);
-  void ProcessToSpace(ObjectPointerVisitor* visitor);
+  void IterateStoreBuffers(Isolate* isolate, ScavengerVisitor* visitor);
+  // Visit the slots covered by the dirty cards of the large old space 'pages',
+  // or of every 'stride'-th page starting with the 'first' one.
+  void IterateRememberedCards(HeapPage* pages,
+                              ScavengerVisitor* visitor,
+                              intptr_t first,
+                              intptr_t stride);
+  void IterateRoots(Isolate* isolate, ScavengerVisitor* visitor);
+  void ProcessToSpace(ScavengerVisitor* visitor);
+  // Clear the weak persistent handles whose objects did not survive and
+  // update the others.
+  void ProcessWeakHandles(Isolate* isolate);
+  // Scavenge using 'num_tasks' tasks, all but the first one running on GC
+  // helper threads of the thread pool. Returns the number of bytes promoted.
+  intptr_t ParallelScavenge(Isolate* isolate, intptr_t num_tasks);
   void Epilogue();
 
-  VirtualMemory* space_;
-  MemoryRegion* to_;
-  MemoryRegion* from_;
+  // Check that all old objects pointing into new space are remembered.
+  void VerifyStoreBuffers(Isolate* isolate);
+
+  VirtualMemory* to_;
+  VirtualMemory* from_;
+
+  // The semi-space size is kept within these limits.
+  intptr_t min_semi_space_size_;
+  intptr_t max_semi_space_size_;
+  intptr_t target_semi_space_size_;
+  // Time at which the previous scavenge ended.
+  int64_t last_scavenge_end_;
 
   Heap* heap_;
 
@@ -83,15 +194,27 @@ class Scavenger {
   uword top_;
   uword end_;
 
+  // Objects below survivor_end_ survived the last scavenge, their ages are
+  // kept on the side as the object header only holds the class pointer.
+  uword survivor_end_;
+  uint8_t* to_ages_;
+  uint8_t* from_ages_;
+
+  // Guards old space allocation during a parallel scavenge.
+  Mutex promotion_mutex_;
+
   // All object are aligned to this value.
   uword object_alignment_;
 
-  // Scavenge cycle count.
+  // Scavenge cycle count and the time spent scavenging.
   int count_;
+  int64_t collection_time_micros_;
   // Keep track whether a scavenge is currently running.
   bool scavenging_;
 
+  friend class ScavengerTask;
   friend class ScavengerVisitor;
+  friend class ScavengerWeakVisitor;
 
   DISALLOW_COPY_AND_ASSIGN(Scavenger);
 };
@@ -181,7 +181,8 @@ RawObject* SnapshotReader::ReadInlinedObject(intptr_t object_id) {
     intptr_t instance_size = cls.instance_size();
     ASSERT(instance_size > 0);
     // Allocate the instance and read in all the fields for the object.
-    RawObject* raw = Object::Allocate(cls, instance_size, Heap::kNew);
+    Heap::Space space = classes_serialized_ ? Heap::kOld : Heap::kNew;
+    RawObject* raw = Object::Allocate(cls, instance_size, space);
     result ^= raw;
     intptr_t offset = Object::InstanceSize();
     Object& obj = Object::Handle();
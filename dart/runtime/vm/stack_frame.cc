@@ -35,10 +35,62 @@ void EntryFrame::VisitObjectPointers(ObjectPointerVisitor* visitor) {
 
 
 void DartFrame::VisitObjectPointers(ObjectPointerVisitor* visitor) {
-  // Visit objects between SP and FP.
   ASSERT(visitor != NULL);
-  visitor->VisitPointers(reinterpret_cast<RawObject**>(sp()),
-                         reinterpret_cast<RawObject**>(fp() - kWordSize));
+  RawObject** first = reinterpret_cast<RawObject**>(sp());
+  RawObject** last = reinterpret_cast<RawObject**>(fp() - kWordSize);
+  RawStackmap* map = LookupStackmap();
+  if (map == Stackmap::null()) {
+    // No stackmap, visit all objects between SP and FP.
+    visitor->VisitPointers(first, last);
+    return;
+  }
+  // Visit the fixed slots at fp[-1 - i] which are marked as holding objects.
+  intptr_t length = Smi::Value(map->ptr()->length_);
+  const uint8_t* bits = map->ptr()->data_;
+  for (intptr_t i = 0; i < length; i++) {
+    if ((bits[i / kBitsPerByte] & (1 << (i % kBitsPerByte))) != 0) {
+      visitor->VisitPointer(last - i);
+    }
+  }
+  // The expression stack and the outgoing arguments below the fixed slots
+  // only hold objects.
+  last -= length;
+  if (first <= last) {
+    visitor->VisitPointers(first, last);
+  }
+}
+
+
+RawStackmap* DartFrame::LookupStackmap() const {
+  ASSERT(Isolate::Current() != NULL);
+  CodeIndexTable* code_index_table = Isolate::Current()->code_index_table();
+  ASSERT(code_index_table != NULL);
+  RawCode* code = code_index_table->LookupCode(pc());
+  if (code == Code::null()) {
+    return Stackmap::null();
+  }
+  RawArray* maps = code->ptr()->stackmaps_;
+  if (maps == Array::null()) {
+    return Stackmap::null();
+  }
+  // The maps are sorted by pc and a map describes the call sites up to the
+  // next map, binary search the last map at or before pc.
+  RawObject** data = maps->ptr()->data();
+  intptr_t low = 0;
+  intptr_t high = Smi::Value(maps->ptr()->length_);
+  while (low < high) {
+    intptr_t mid = low + (high - low) / 2;
+    RawStackmap* map = reinterpret_cast<RawStackmap*>(data[mid]);
+    if (map->ptr()->pc_ <= pc()) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == 0) {
+    return Stackmap::null();
+  }
+  return reinterpret_cast<RawStackmap*>(data[low - 1]);
 }
 
 
@@ -135,6 +135,11 @@ class DartFrame : public StackFrame {
   // Find exception handler pc in frame if one exists.
   bool FindExceptionHandler(uword* handler_pc) const;
 
+  // Get the stackmap describing the pc of the frame, the last one recorded at
+  // or before it, or a null object if the code has none. Does not allocate
+  // handles.
+  RawStackmap* LookupStackmap() const;
+
  protected:
   virtual const char* GetName() const { return "dart"; }
 
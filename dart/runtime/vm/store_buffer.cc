@@ -5,12 +5,122 @@
 #include "vm/store_buffer.h"
 
 #include "vm/assert.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/raw_object.h"
+#include "vm/utils.h"
 
 namespace dart {
 
 void StoreBufferBlock::ProcessBuffer() {
-  // TODO(iposva): Do the right thing for store buffer overflow.
-  top_ = 0;  // Currently just reset back to the beginning.
+  ProcessBuffer(Isolate::Current());
+}
+
+
+void StoreBufferBlock::ProcessBuffer(Isolate* isolate) {
+  StoreBuffer* buffer = isolate->store_buffer();
+  for (int32_t i = 0; i < top_; i++) {
+    buffer->AddPointer(pointers_[i]);
+  }
+  top_ = 0;
+}
+
+
+void MarkingBufferBlock::ProcessBuffer() {
+  ProcessBuffer(Isolate::Current());
+}
+
+
+void MarkingBufferBlock::ProcessBuffer(Isolate* isolate) {
+  isolate->heap()->MarkPointers(pointers_, top_);
+  top_ = 0;
+}
+
+
+static inline uword StoreBufferHash(uword pointer) {
+  // Objects are aligned, drop the low bits before mixing.
+  return (pointer / kObjectAlignment) * 2654435761U;
+}
+
+
+StoreBuffer::StoreBuffer() : data_(NULL), capacity_(0), count_(0) {
+}
+
+
+StoreBuffer::~StoreBuffer() {
+  free(data_);
+}
+
+
+void StoreBuffer::AddPointer(uword pointer) {
+  ASSERT(pointer != 0);
+  // Keep the load factor of the table below 50%.
+  if ((2 * (count_ + 1)) > capacity_) {
+    Grow();
+  }
+  intptr_t mask = capacity_ - 1;
+  intptr_t index = StoreBufferHash(pointer) & mask;
+  while (data_[index] != 0) {
+    if (data_[index] == pointer) {
+      return;
+    }
+    index = (index + 1) & mask;
+  }
+  data_[index] = pointer;
+  count_++;
+}
+
+
+bool StoreBuffer::Contains(uword pointer) const {
+  if (count_ == 0) {
+    return false;
+  }
+  intptr_t mask = capacity_ - 1;
+  intptr_t index = StoreBufferHash(pointer) & mask;
+  while (data_[index] != 0) {
+    if (data_[index] == pointer) {
+      return true;
+    }
+    index = (index + 1) & mask;
+  }
+  return false;
+}
+
+
+uword* StoreBuffer::TakePointers(intptr_t* length) {
+  ASSERT(length != NULL);
+  uword* result = reinterpret_cast<uword*>(
+      malloc(Utils::Maximum(count_, static_cast<intptr_t>(1)) * sizeof(uword)));
+  intptr_t j = 0;
+  for (intptr_t i = 0; i < capacity_; i++) {
+    if (data_[i] != 0) {
+      result[j++] = data_[i];
+      data_[i] = 0;
+    }
+  }
+  ASSERT(j == count_);
+  *length = count_;
+  count_ = 0;
+  return result;
+}
+
+
+void StoreBuffer::Grow() {
+  uword* old_data = data_;
+  intptr_t old_capacity = capacity_;
+  capacity_ = (old_capacity == 0) ? kInitialCapacity : (2 * old_capacity);
+  ASSERT(Utils::IsPowerOfTwo(capacity_));
+  data_ = reinterpret_cast<uword*>(calloc(capacity_, sizeof(uword)));
+  if (data_ == NULL) {
+    FATAL("Out of memory growing the store buffer.");
+  }
+  count_ = 0;
+  for (intptr_t i = 0; i < old_capacity; i++) {
+    if (old_data[i] != 0) {
+      AddPointer(old_data[i]);
+    }
+  }
+  free(old_data);
 }
 
 }  // namespace dart
@@ -6,9 +6,16 @@
 #define VM_STORE_BUFFER_H_
 
 #include "vm/assert.h"
+#include "vm/globals.h"
 
 namespace dart {
 
+// Forward declarations.
+class Isolate;
+
+// The store buffer block is filled by the write barrier with the addresses of
+// old objects that had a pointer to a new object stored into them. Its layout
+// is accessed directly from generated code.
 class StoreBufferBlock {
  public:
   // Each block contains kSize pointers.
@@ -31,14 +38,103 @@ class StoreBufferBlock {
     }
   }
 
-  // Process this store buffer and remember its contents in the heap.
+  intptr_t Count() const { return top_; }
+
+  // Process this store buffer and remember its contents in the store buffer
+  // set of the current isolate.
   void ProcessBuffer();
+  void ProcessBuffer(Isolate* isolate);
 
  private:
   int32_t top_;
   uword pointers_[kSize];
 };
 
+
+// The marking buffer block is filled by the write barrier with the old objects
+// whose references are overwritten while old space is marked concurrently.
+// Marking these objects preserves everything that was reachable when marking
+// started. Its layout is accessed directly from generated code.
+class MarkingBufferBlock {
+ public:
+  // Each block contains kSize pointers.
+  static const int32_t kSize = 1024;
+
+  MarkingBufferBlock() : is_marking_(0), top_(0) {}
+
+  static int is_marking_offset() {
+    return OFFSET_OF(MarkingBufferBlock, is_marking_);
+  }
+  static int top_offset() { return OFFSET_OF(MarkingBufferBlock, top_); }
+  static int pointers_offset() {
+    return OFFSET_OF(MarkingBufferBlock, pointers_);
+  }
+
+  // The write barrier only logs overwritten values while this is set.
+  bool is_marking() const { return is_marking_ != 0; }
+  uword is_marking_address() const {
+    return reinterpret_cast<uword>(&is_marking_);
+  }
+  void set_is_marking(bool value) { is_marking_ = value ? 1 : 0; }
+
+  // Add a pointer to the block of pointers. The buffer will be processed if it
+  // has been filled by this operation.
+  void AddPointer(uword pointer) {
+    ASSERT(top_ < kSize);
+    pointers_[top_++] = pointer;
+    if (top_ == kSize) {
+      ProcessBuffer();
+    }
+  }
+
+  intptr_t Count() const { return top_; }
+
+  // Process this marking buffer and mark its contents in the heap of the
+  // current isolate.
+  void ProcessBuffer();
+  void ProcessBuffer(Isolate* isolate);
+
+ private:
+  int32_t is_marking_;
+  int32_t top_;
+  uword pointers_[kSize];
+};
+
+
+// The store buffer is the remembered set of an isolate: the deduplicated set
+// of old objects which may contain pointers into new space. Full store buffer
+// blocks are drained into it, and it is consumed as a root set by the
+// scavenger.
+class StoreBuffer {
+ public:
+  StoreBuffer();
+  ~StoreBuffer();
+
+  // Remember the old object at 'pointer'. Duplicates are ignored.
+  void AddPointer(uword pointer);
+
+  bool Contains(uword pointer) const;
+
+  // Number of distinct remembered objects.
+  intptr_t Count() const { return count_; }
+
+  // Return all remembered objects in a newly malloced array and empty the
+  // set. The caller is responsible for freeing the returned array.
+  uword* TakePointers(intptr_t* length);
+
+ private:
+  static const intptr_t kInitialCapacity = 1024;
+
+  void Grow();
+
+  // Open addressed hash table of pointers, unused entries are 0.
+  uword* data_;
+  intptr_t capacity_;
+  intptr_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(StoreBuffer);
+};
+
 }  // namespace dart
 
 #endif  // VM_STORE_BUFFER_H_
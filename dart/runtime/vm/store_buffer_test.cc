@@ -0,0 +1,39 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/assert.h"
+#include "vm/store_buffer.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+UNIT_TEST_CASE(StoreBuffer) {
+  StoreBuffer store_buffer;
+  EXPECT_EQ(0, store_buffer.Count());
+  // Adding the same pointers repeatedly keeps a single entry for each.
+  const intptr_t kNumPointers = 5000;
+  for (intptr_t repeat = 0; repeat < 3; repeat++) {
+    for (intptr_t i = 1; i <= kNumPointers; i++) {
+      store_buffer.AddPointer(i * 2 * kWordSize);
+    }
+  }
+  EXPECT_EQ(kNumPointers, store_buffer.Count());
+  EXPECT(store_buffer.Contains(2 * kWordSize));
+  EXPECT(store_buffer.Contains(kNumPointers * 2 * kWordSize));
+  EXPECT(!store_buffer.Contains((kNumPointers + 1) * 2 * kWordSize));
+
+  intptr_t length = 0;
+  uword* pointers = store_buffer.TakePointers(&length);
+  EXPECT_EQ(kNumPointers, length);
+  uword sum = 0;
+  for (intptr_t i = 0; i < length; i++) {
+    sum += pointers[i] / (2 * kWordSize);
+  }
+  EXPECT_EQ(static_cast<uword>(kNumPointers * (kNumPointers + 1) / 2), sum);
+  free(pointers);
+  EXPECT_EQ(0, store_buffer.Count());
+  EXPECT(!store_buffer.Contains(2 * kWordSize));
+}
+
+}  // namespace dart
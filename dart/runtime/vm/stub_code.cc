@@ -50,8 +50,8 @@ StubCode::~StubCode() {
 
 
 void StubCode::InitOnce() {
-  // TODO(regis): Re-enable this after we are able to generate x64 and arm code.
-#if defined(TARGET_ARCH_IA32)
+  // TODO(regis): Re-enable this after we are able to generate arm code.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
   // Generate all the stubs.
   Code& code = Code::Handle();
   VM_STUB_CODE_LIST(STUB_CODE_GENERATE);
@@ -60,8 +60,8 @@ void StubCode::InitOnce() {
 
 
 void StubCode::GenerateFor(Isolate* init) {
-  // TODO(regis): Re-enable this after we are able to generate x64 and arm code.
-#if defined(TARGET_ARCH_IA32)
+  // TODO(regis): Re-enable this after we are able to generate arm code.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
   // Generate all the stubs.
   Code& code = Code::Handle();
   STUB_CODE_LIST(STUB_CODE_GENERATE);
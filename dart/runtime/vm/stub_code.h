@@ -32,6 +32,8 @@ class RawCode;
   V(OptimizeInvokedFunction)                                                   \
   V(FixCallersTarget)                                                          \
   V(Deoptimize)                                                                \
+  V(UpdateStoreBuffer)                                                         \
+  V(MarkingBarrier)                                                            \
 
 // Is it permitted for the stubs above to refer to Object::null(), which is
 // allocated in the VM isolate and shared across all isolates.
@@ -51,6 +51,16 @@ void StubCode::GenerateCallClosureFunctionStub(Assembler* assembler) {
 }
 
 
+void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+  __ Unimplemented("UpdateStoreBuffer stub");
+}
+
+
+void StubCode::GenerateMarkingBarrierStub(Assembler* assembler) {
+  __ Unimplemented("MarkingBarrier stub");
+}
+
+
 void StubCode::GenerateAllocateContextStub(Assembler* assembler) {
   __ Unimplemented("AllocateContext stub");
 }
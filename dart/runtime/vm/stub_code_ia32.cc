@@ -20,6 +20,7 @@
 namespace dart {
 
 DEFINE_FLAG(bool, inline_alloc, true, "Inline allocation of objects.");
+DECLARE_FLAG(bool, pretenure);
 
 // Input parameters:
 //   ESP : points to return address.
@@ -611,6 +612,172 @@ void StubCode::GenerateDeoptimizeStub(Assembler* assembler) {
 }
 
 
+// Shared overflow path of the UpdateStoreBuffer and MarkingBarrier stubs:
+// calls 'process' with the isolate as argument in a leaf call to the runtime
+// and returns from the stub. No Dart objects are allocated, so no exit frame
+// needs to be setup. Preserves all registers.
+static void GenerateProcessBufferCall(Assembler* assembler,
+                                      void (*process)(Isolate* isolate)) {
+  __ EnterFrame(0);
+  __ pushl(EAX);
+  __ pushl(ECX);
+  __ pushl(EDX);
+  // Values in XMM registers are not preserved across C calls.
+  const intptr_t xmm_slot_size = sizeof(double);
+  const intptr_t xmm_save_size = kNumberOfXmmRegisters * xmm_slot_size;
+  __ subl(ESP, Immediate(xmm_save_size));
+  for (intptr_t i = 0; i < kNumberOfXmmRegisters; i++) {
+    __ movsd(Address(ESP, i * xmm_slot_size), static_cast<XmmRegister>(i));
+  }
+  const intptr_t saved_size = 3 * kWordSize + xmm_save_size;
+
+  // Pass the isolate as argument and align the frame.
+  __ movl(EAX, FieldAddress(CTX, Context::isolate_offset()));
+  __ subl(ESP, Immediate(kWordSize));
+  if (OS::ActivationFrameAlignment() > 0) {
+    __ andl(ESP, Immediate(~(OS::ActivationFrameAlignment() - 1)));
+  }
+  __ movl(Address(ESP, 0), EAX);
+  __ movl(EAX, Immediate(reinterpret_cast<int32_t>(process)));
+  __ call(EAX);
+
+  // Restore the saved registers and return.
+  __ leal(ESP, Address(EBP, -saved_size));
+  for (intptr_t i = 0; i < kNumberOfXmmRegisters; i++) {
+    __ movsd(static_cast<XmmRegister>(i), Address(ESP, i * xmm_slot_size));
+  }
+  __ addl(ESP, Immediate(xmm_save_size));
+  __ popl(EDX);
+  __ popl(ECX);
+  __ popl(EAX);
+  __ LeaveFrame();
+  __ ret();
+}
+
+
+// Called from the UpdateStoreBuffer stub when the store buffer block of the
+// isolate is full.
+static void ProcessStoreBufferBlock(Isolate* isolate) {
+  isolate->store_buffer_block()->ProcessBuffer(isolate);
+}
+
+
+// Helper stub to implement Assembler::StoreIntoObject. Large arrays have a
+// card table in their page and only the card of the updated slot is dirtied,
+// other objects are added to the store buffer.
+// Input parameters:
+//   EDX: Address of the old object being stored into.
+//   TOS + 1: Address of the updated slot.
+// Preserves all registers.
+void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+  const intptr_t top_offset =
+      Isolate::store_buffer_block_offset() + StoreBufferBlock::top_offset();
+  const intptr_t pointers_offset =
+      Isolate::store_buffer_block_offset() +
+      StoreBufferBlock::pointers_offset();
+
+  // Save values being destroyed.
+  __ pushl(EAX);
+  __ pushl(ECX);
+
+  // Dirty the card of the slot if the page of the object has a card table.
+  Label no_card_table;
+  __ movl(EAX, EDX);
+  __ andl(EAX, Immediate(~(HeapPage::kPageSize - 1)));
+  __ movl(ECX, Address(EAX, HeapPage::card_table_offset()));
+  __ testl(ECX, ECX);
+  __ j(ZERO, &no_card_table, Assembler::kNearJump);
+  __ negl(EAX);
+  __ addl(EAX, Address(ESP, 3 * kWordSize));  // Offset of the slot in page.
+  __ shrl(EAX, Immediate(HeapPage::kCardBits));
+  __ movb(Address(ECX, EAX, TIMES_1, 0), Immediate(1));
+  __ popl(ECX);
+  __ popl(EAX);
+  __ ret();
+
+  __ Bind(&no_card_table);
+  // Load the isolate out of the context.
+  __ movl(EAX, FieldAddress(CTX, Context::isolate_offset()));
+
+  // Load top_ out of the StoreBufferBlock and add the address to pointers_.
+  __ movl(ECX, Address(EAX, top_offset));
+  __ movl(Address(EAX, ECX, TIMES_4, pointers_offset), EDX);
+
+  // Increment top_ and check for overflow.
+  __ incl(ECX);
+  __ movl(Address(EAX, top_offset), ECX);
+  __ cmpl(ECX, Immediate(StoreBufferBlock::kSize));
+
+  // Restore values, popl does not change the flags.
+  __ popl(ECX);
+  __ popl(EAX);
+  Label overflow;
+  __ j(EQUAL, &overflow, Assembler::kNearJump);
+  __ ret();
+
+  // Handle overflow: Process the block in a leaf call to the runtime.
+  __ Bind(&overflow);
+  GenerateProcessBufferCall(assembler, &ProcessStoreBufferBlock);
+}
+
+
+// Called from the MarkingBarrier stub when the marking buffer block of the
+// isolate is full.
+static void ProcessMarkingBufferBlock(Isolate* isolate) {
+  isolate->marking_buffer_block()->ProcessBuffer(isolate);
+}
+
+
+// Helper stub to implement Assembler::StoreIntoObject while old space is
+// marked concurrently.
+// Input parameters:
+//   EDX: Value being overwritten in an old object.
+// Preserves all registers.
+void StubCode::GenerateMarkingBarrierStub(Assembler* assembler) {
+  const intptr_t top_offset =
+      Isolate::marking_buffer_block_offset() +
+      MarkingBufferBlock::top_offset();
+  const intptr_t pointers_offset =
+      Isolate::marking_buffer_block_offset() +
+      MarkingBufferBlock::pointers_offset();
+
+  // Only old objects need to be logged.
+  Label done;
+  __ testl(EDX, Immediate(kSmiTagMask));
+  __ j(ZERO, &done, Assembler::kNearJump);  // Smi value.
+  __ testl(EDX, Immediate(kNewObjectAlignmentOffset));
+  __ j(NOT_ZERO, &done, Assembler::kNearJump);  // New object.
+
+  // Save values being destroyed.
+  __ pushl(EAX);
+  __ pushl(ECX);
+
+  // Load the isolate out of the context.
+  __ movl(EAX, FieldAddress(CTX, Context::isolate_offset()));
+
+  // Load top_ out of the MarkingBufferBlock and add the value to pointers_.
+  __ movl(ECX, Address(EAX, top_offset));
+  __ movl(Address(EAX, ECX, TIMES_4, pointers_offset), EDX);
+
+  // Increment top_ and check for overflow.
+  __ incl(ECX);
+  __ movl(Address(EAX, top_offset), ECX);
+  __ cmpl(ECX, Immediate(MarkingBufferBlock::kSize));
+
+  // Restore values, popl does not change the flags.
+  __ popl(ECX);
+  __ popl(EAX);
+  Label overflow;
+  __ j(EQUAL, &overflow, Assembler::kNearJump);
+  __ Bind(&done);
+  __ ret();
+
+  // Handle overflow: Mark the logged objects in a leaf call to the runtime.
+  __ Bind(&overflow);
+  GenerateProcessBufferCall(assembler, &ProcessMarkingBufferBlock);
+}
+
+
 // Called for inline allocation of arrays.
 // Input parameters:
 //   EDX : Array length as Smi.
@@ -1058,8 +1225,32 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
   const intptr_t type_args_size = InstantiatedTypeArguments::InstanceSize();
   if (FLAG_inline_alloc &&
       PageSpace::IsPageAllocatableSize(instance_size + type_args_size)) {
-    Label slow_case;
+    Label slow_case, initialize;
     Heap* heap = Isolate::Current()->heap();
+    if (FLAG_pretenure) {
+      __ LoadObject(EDX, cls);
+      __ cmpl(FieldAddress(EDX, Class::is_pretenured_offset()), Immediate(0));
+      if (is_cls_parameterized) {
+        // The type arguments may be new objects, which would have to be
+        // remembered. Instances of pretenured parameterized classes are
+        // allocated in old space by the runtime.
+        __ j(NOT_EQUAL, &slow_case);
+      } else {
+        // Instances of pretenured classes are allocated in the allocation
+        // buffer of old space, the runtime refills it once it ran out.
+        Label not_pretenured;
+        __ j(EQUAL, &not_pretenured, Assembler::kNearJump);
+        __ movl(EAX, Address::Absolute(heap->OldTopAddress()));
+        __ leal(EBX, Address(EAX, instance_size));
+        __ cmpl(EBX, Address::Absolute(heap->OldEndAddress()));
+        __ j(ABOVE, &slow_case);
+        __ movl(Address::Absolute(heap->OldTopAddress()), EBX);
+        // EDX: class of the object to be allocated.
+        __ incl(FieldAddress(EDX, Class::allocated_count_offset()));
+        __ jmp(&initialize);
+        __ Bind(&not_pretenured);
+      }
+    }
     __ movl(EAX, Address::Absolute(heap->TopAddress()));
     __ leal(EBX, Address(EAX, instance_size));
     if (is_cls_parameterized) {
@@ -1120,6 +1311,7 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     // EAX: new object start.
     // EBX: next object start.
     // EDI: new object type arguments (if is_cls_parameterized).
+    __ Bind(&initialize);
     __ LoadObject(EDX, cls);  // Load class of object to be allocated.
     __ movl(Address(EAX, Instance::class_offset()), EDX);
 
@@ -5,66 +5,1774 @@
 #include "vm/globals.h"
 #if defined(TARGET_ARCH_X64)
 
+#include "vm/code_generator.h"
+#include "vm/compiler.h"
+#include "vm/ic_data.h"
+#include "vm/object_store.h"
+#include "vm/pages.h"
+#include "vm/resolver.h"
+#include "vm/scavenger.h"
 #include "vm/stub_code.h"
 
+
 #define __ assembler->
 
 namespace dart {
 
+DEFINE_FLAG(bool, inline_alloc, true, "Inline allocation of objects.");
+DECLARE_FLAG(bool, pretenure);
+
+// Input parameters:
+//   RSP : points to return address.
+//   RSP + 8 : address of last argument in argument array.
+//   RSP + 8*RDX : address of first argument in argument array.
+//   RSP + 8*RDX + 8 : address of return value.
+//   RCX : address of the runtime function to call.
+//   RDX : number of arguments to the call.
+// Must preserve callee saved registers R12 and RBX.
+static void GenerateCallRuntimeStub(Assembler* assembler) {
+  const intptr_t argc_offset =
+      NativeArguments::argc_offset() + kCShadowSpaceSize;
+  const intptr_t argv_offset =
+      NativeArguments::argv_offset() + kCShadowSpaceSize;
+  const intptr_t retval_offset =
+      NativeArguments::retval_offset() + kCShadowSpaceSize;
+
+  __ EnterFrame(0);
+
+  // Load current Isolate pointer from Context structure into RAX.
+  __ movq(RAX, FieldAddress(CTX, Context::isolate_offset()));
+
+  // Save exit frame information to enable stack walking as we are about
+  // to transition to dart VM code.
+  __ movq(Address(RAX, Isolate::top_exit_frame_info_offset()), RSP);
+
+  // Save current Context pointer into Isolate structure.
+  __ movq(Address(RAX, Isolate::top_context_offset()), CTX);
+
+  // Cache Isolate pointer into CTX while executing runtime code.
+  __ movq(CTX, RAX);
+
+  // Reserve space for arguments and align frame before entering C++ world.
+  __ AddImmediate(RSP,
+                  Immediate(-sizeof(NativeArguments) - kCShadowSpaceSize));
+  if (OS::ActivationFrameAlignment() > 0) {
+    __ andq(RSP, Immediate(~(OS::ActivationFrameAlignment() - 1)));
+  }
+
+  // Pass NativeArguments structure by value and call runtime. The structure
+  // is passed in memory by the System V ABI and by reference by the Windows
+  // ABI, so its address is also passed in the first argument register.
+  __ movl(Address(RSP, argc_offset), RDX);  // Set argc in NativeArguments.
+  __ leaq(RAX, Address(RBP, RDX, TIMES_8, 1 * kWordSize));  // Compute argv.
+  __ movq(Address(RSP, argv_offset), RAX);  // Set argv in NativeArguments.
+  __ addq(RAX, Immediate(1 * kWordSize));  // Retval is next to 1st argument.
+  __ movq(Address(RSP, retval_offset), RAX);  // Set retval in NativeArguments.
+  __ movq(RAX, RCX);  // RCX may be an argument register.
+  __ leaq(kCArg0Reg, Address(RSP, kCShadowSpaceSize));
+  __ call(RAX);
+
+  // Reset exit frame information in Isolate structure.
+  __ movq(Address(CTX, Isolate::top_exit_frame_info_offset()), Immediate(0));
+
+  // Load Context pointer from Isolate structure into RCX.
+  __ movq(RCX, Address(CTX, Isolate::top_context_offset()));
+
+  // Reset Context pointer in Isolate structure.
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  __ movq(Address(CTX, Isolate::top_context_offset()), raw_null);
+
+  // Cache Context pointer into CTX while executing dart code.
+  __ movq(CTX, RCX);
+
+  __ LeaveFrame();
+  __ ret();
+}
+
+
+// Input parameters:
+//   RSP : points to return address.
+//   RSP + 8 : address of last argument in argument array.
+//   RSP + 8*RDX : address of first argument in argument array.
+//   RSP + 8*RDX + 8 : address of return value.
+//   RCX : address of the runtime function to call.
+//   RDX : number of arguments to the call.
+// Must preserve callee saved registers R12 and RBX.
 void StubCode::GenerateDartCallToRuntimeStub(Assembler* assembler) {
-  __ Unimplemented("DartCallToRuntime stub");
+  GenerateCallRuntimeStub(assembler);
 }
 
 
+// Input parameters:
+//   RSP : points to return address.
+//   RSP + 8 : address of last argument in argument array.
+//   RSP + 8*RDX : address of first argument in argument array.
+//   RSP + 8*RDX + 8 : address of return value.
+//   RCX : address of the runtime function to call.
+//   RDX : number of arguments to the call.
+// Must preserve callee saved registers R12 and RBX.
 void StubCode::GenerateStubCallToRuntimeStub(Assembler* assembler) {
-  __ Unimplemented("StubCallToRuntime stub");
+  GenerateCallRuntimeStub(assembler);
 }
 
 
+// Input parameters:
+//   RSP : points to return address.
+//   RSP + 8 : address of return value.
+//   RAX : address of first argument in argument array.
+//   RAX - 8*RDX + 8 : address of last argument in argument array.
+//   RCX : address of the native function to call.
+//   RDX : number of arguments to the call.
+// Uses R12.
 void StubCode::GenerateCallNativeCFunctionStub(Assembler* assembler) {
-  __ Unimplemented("CallNativeCFunction stub");
+  const intptr_t argc_offset =
+      NativeArguments::argc_offset() + kCShadowSpaceSize;
+  const intptr_t argv_offset =
+      NativeArguments::argv_offset() + kCShadowSpaceSize;
+  const intptr_t retval_offset =
+      NativeArguments::retval_offset() + kCShadowSpaceSize;
+
+  __ EnterFrame(0);
+
+  // Load current Isolate pointer from Context structure into R12.
+  __ movq(R12, FieldAddress(CTX, Context::isolate_offset()));
+
+  // Save exit frame information to enable stack walking as we are about
+  // to transition to dart VM code.
+  __ movq(Address(R12, Isolate::top_exit_frame_info_offset()), RSP);
+
+  // Save current Context pointer into Isolate structure.
+  __ movq(Address(R12, Isolate::top_context_offset()), CTX);
+
+  // Cache Isolate pointer into CTX while executing native code.
+  __ movq(CTX, R12);
+
+  // Reserve space for the native arguments structure and align frame before
+  // entering the C++ world.
+  __ AddImmediate(RSP,
+                  Immediate(-sizeof(NativeArguments) - kCShadowSpaceSize));
+  if (OS::ActivationFrameAlignment() > 0) {
+    __ andq(RSP, Immediate(~(OS::ActivationFrameAlignment() - 1)));
+  }
+
+  // Pass the pointer to the NativeArguments structure and call native code.
+  __ movl(Address(RSP, argc_offset), RDX);  // Set argc in NativeArguments.
+  __ movq(Address(RSP, argv_offset), RAX);  // Set argv in NativeArguments.
+  __ leaq(RAX, Address(RBP, 2 * kWordSize));  // Compute return value addr.
+  __ movq(Address(RSP, retval_offset), RAX);  // Set retval in NativeArguments.
+  __ movq(RAX, RCX);  // RCX may be an argument register.
+  __ leaq(kCArg0Reg, Address(RSP, kCShadowSpaceSize));
+  __ call(RAX);
+
+  // Reset exit frame information in Isolate structure.
+  __ movq(Address(CTX, Isolate::top_exit_frame_info_offset()), Immediate(0));
+
+  // Load Context pointer from Isolate structure into R12.
+  __ movq(R12, Address(CTX, Isolate::top_context_offset()));
+
+  // Reset Context pointer in Isolate structure.
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  __ movq(Address(CTX, Isolate::top_context_offset()), raw_null);
+
+  // Cache Context pointer into CTX while executing dart code.
+  __ movq(CTX, R12);
+
+  __ LeaveFrame();
+  __ ret();
 }
 
 
-void StubCode::GenerateCallNoSuchMethodFunctionStub(Assembler* assembler) {
-  __ Unimplemented("CallNoSuchMethodFunction stub");
+// Input parameters:
+//   RCX: function object.
+//   RDX: arguments descriptor array (num_args is first Smi element).
+void StubCode::GenerateCallStaticFunctionStub(Assembler* assembler) {
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+
+  __ movq(RAX, FieldAddress(RCX, Function::code_offset()));
+  __ cmpq(RAX, raw_null);
+  Label function_compiled;
+  __ j(NOT_EQUAL, &function_compiled, Assembler::kNearJump);
+
+  // Create a stub frame as we are pushing some objects on the stack before
+  // calling into the runtime.
+  __ EnterFrame(0);
+
+  __ pushq(RDX);  // Preserve arguments descriptor array.
+  __ pushq(RCX);
+  __ CallRuntimeFromStub(kCompileFunctionRuntimeEntry);
+  __ popq(RCX);  // Restore read-only function object argument in RCX.
+  __ popq(RDX);  // Restore arguments descriptor array.
+  // Restore RAX.
+  __ movq(RAX, FieldAddress(RCX, Function::code_offset()));
+
+  // Remove the stub frame as we are about to jump to the dart function.
+  __ LeaveFrame();
+
+  __ Bind(&function_compiled);
+  // Patch caller.
+  __ EnterFrame(0);
+
+  __ pushq(RDX);  // Preserve arguments descriptor array.
+  __ pushq(RCX);  // Preserve function object.
+  __ CallRuntimeFromStub(kPatchStaticCallRuntimeEntry);
+  __ popq(RCX);  // Restore function object argument in RCX.
+  __ popq(RDX);  // Restore arguments descriptor array.
+  // Remove the stub frame as we are about to jump to the dart function.
+  __ LeaveFrame();
+  __ movq(RAX, FieldAddress(RCX, Function::code_offset()));
+
+  __ movq(RCX, FieldAddress(RAX, Code::instructions_offset()));
+  __ addq(RCX, Immediate(Instructions::HeaderSize() - kHeapObjectTag));
+  __ jmp(RCX);
 }
 
 
-void StubCode::GenerateInvokeDartCodeStub(Assembler* assembler) {
-  __ Unimplemented("InvokeDartCode stub");
+// Stub is entered after a call but before the callee's frame has been
+// constructed.
+// Handle stack overflow by calling the runtime routine and preserving
+// the argument descriptor (RDX) and the ic-data array/function object of
+// the call (RCX).
+// The stub must be able to return to callee in case the stack overflow
+// exception is not thrown.
+void StubCode::GenerateStackOverflowStub(Assembler* assembler) {
+  __ EnterFrame(0);
+  // Stack at this point:
+  // TOS + 0: Saved RBP of previous frame. <== RBP
+  // TOS + 1: Dart code return address
+  // TOS + 2: Last argument of caller.
+  // ....
+  __ pushq(RDX);  // Preserve arguments descriptor array.
+  __ pushq(RCX);  // Preserve object (ic-data array or function object).
+  __ CallRuntimeFromStub(kStackOverflowRuntimeEntry);
+  __ popq(RCX);  // Restore object (ic-data array or function object).
+  __ popq(RDX);  // Restore arguments descriptor array.
+  __ LeaveFrame();
+  __ int3();
 }
 
 
-void StubCode::GenerateCallStaticFunctionStub(Assembler* assembler) {
-  __ Unimplemented("CallStaticFunction stub");
+// Called when number of invocations exceeds
+// --optimization_invocation_threshold.
+// RAX: target function.
+// RDX: arguments descriptor array (num_args is first Smi element).
+void StubCode::GenerateOptimizeInvokedFunctionStub(Assembler* assembler) {
+  __ EnterFrame(0);
+  __ pushq(RDX);  // Preserve arguments descriptor array.
+  __ pushq(RAX);  // Preserve target function.
+  __ pushq(RAX);  // Target function.
+  __ CallRuntimeFromStub(kOptimizeInvokedFunctionRuntimeEntry);
+  __ popq(RAX);  // discard argument.
+  __ popq(RAX);  // Restore function.
+  __ popq(RDX);  // Restore arguments descriptor array.
+  __ movq(RAX, FieldAddress(RAX, Function::code_offset()));
+  __ movq(RAX, FieldAddress(RAX, Code::instructions_offset()));
+  __ addq(RAX, Immediate(Instructions::HeaderSize() - kHeapObjectTag));
+  __ LeaveFrame();
+  __ jmp(RAX);
+  __ int3();
+}
+
+
+// Called from a static call only when an invalid code has been entered
+// (invalid because its function was optimized or deoptimized).
+// RCX: function object.
+// RDX: arguments descriptor array (num_args is first Smi element).
+void StubCode::GenerateFixCallersTargetStub(Assembler* assembler) {
+  __ EnterFrame(0);
+  __ pushq(RDX);  // Preserve arguments descriptor array.
+  __ pushq(RCX);  // Preserve target function.
+  __ pushq(RCX);  // Target function.
+  __ CallRuntimeFromStub(kFixCallersTargetRuntimeEntry);
+  __ popq(RAX);  // discard argument.
+  __ popq(RAX);  // Restore function.
+  __ popq(RDX);  // Restore arguments descriptor array.
+  __ movq(RAX, FieldAddress(RAX, Function::code_offset()));
+  __ movq(RAX, FieldAddress(RAX, Code::instructions_offset()));
+  __ addq(RAX, Immediate(Instructions::HeaderSize() - kHeapObjectTag));
+  __ LeaveFrame();
+  __ jmp(RAX);
+  __ int3();
+}
+
+
+// Lookup for [function-name, arg count] in 'functions_map_'.
+// Input parameters (to be treated as read only, unless calling to target!):
+//   RCX: ic-data array.
+//   RDX: arguments descriptor array (num_args is first Smi element).
+//   Stack: return address, arguments.
+// If the lookup succeeds we jump to the target method from here, otherwise
+// we continue in code generated by the caller of 'MegamorphicLookup'.
+static void MegamorphicLookup(Assembler* assembler) {
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  Label class_in_rax, smi_receiver, null_receiver, not_found;
+  // Total number of args is the first Smi in args descriptor array (RDX).
+  __ movq(RAX, FieldAddress(RDX, Array::data_offset()));
+  __ movq(RAX, Address(RSP, RAX, TIMES_4, 0));  // Get receiver. RAX is a Smi.
+  // TODO(srdjan): Remove the special casing below for null receiver, once
+  // NullClass is implemented.
+  __ cmpq(RAX, raw_null);
+  // Use Object class if receiver is null.
+  __ j(EQUAL, &null_receiver, Assembler::kNearJump);
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(ZERO, &smi_receiver, Assembler::kNearJump);
+  __ movq(RAX, FieldAddress(RAX, Object::class_offset()));
+  __ jmp(&class_in_rax, Assembler::kNearJump);
+  __ Bind(&smi_receiver);
+  // For Smis we need to get the class from the isolate.
+  // Load current Isolate pointer from Context structure into RAX.
+  __ movq(RAX, FieldAddress(CTX, Context::isolate_offset()));
+  __ movq(RAX, Address(RAX, Isolate::object_store_offset()));
+  __ movq(RAX, Address(RAX, ObjectStore::smi_class_offset()));
+  __ jmp(&class_in_rax, Assembler::kNearJump);
+  __ Bind(&null_receiver);
+  __ movq(RAX, FieldAddress(CTX, Context::isolate_offset()));
+  __ movq(RAX, Address(RAX, Isolate::object_store_offset()));
+  __ movq(RAX, Address(RAX, ObjectStore::object_class_offset()));
+
+  __ Bind(&class_in_rax);
+  // Class is in RAX.
+
+  Label loop, next_iteration;
+  // Get functions_cache, since it is allocated lazily it maybe null.
+  __ movq(RAX, FieldAddress(RAX, Class::functions_cache_offset()));
+  // Iterate and search for identical name.
+  __ leaq(RBX, FieldAddress(RAX, Array::data_offset()));
+
+  // RBX is  pointing into content of functions_map_ array.
+  __ Bind(&loop);
+  __ movq(R12, Address(RBX, FunctionsCache::kFunctionName * kWordSize));
+
+  __ cmpq(R12, raw_null);
+  __ j(EQUAL, &not_found, Assembler::kNearJump);
+
+  ASSERT(ICData::kNameIndex == 0);
+  __ cmpq(R12, FieldAddress(RCX, Array::data_offset()));
+  __ j(NOT_EQUAL, &next_iteration, Assembler::kNearJump);
+
+  // Name found, check total argument count and named argument count.
+  __ movq(RAX, FieldAddress(RDX, Array::data_offset()));
+  // RAX is total argument count as Smi.
+  __ movq(R12, Address(RBX, FunctionsCache::kArgCount * kWordSize));
+  __ cmpq(RAX, R12);  // Compare total argument counts.
+  __ j(NOT_EQUAL, &next_iteration, Assembler::kNearJump);
+  __ subq(RAX, FieldAddress(RDX, Array::data_offset() + kWordSize));
+  // RAX is named argument count as Smi.
+  __ movq(R12, Address(RBX, FunctionsCache::kNamedArgCount * kWordSize));
+  __ cmpq(RAX, R12);  // Compare named argument counts.
+  __ j(NOT_EQUAL, &next_iteration, Assembler::kNearJump);
+
+  // Argument count matches, jump to target.
+  // RDX: arguments descriptor array.
+  __ movq(RCX, Address(RBX, FunctionsCache::kFunction * kWordSize));
+  __ movq(RCX, FieldAddress(RCX, Function::code_offset()));
+  __ movq(RCX, FieldAddress(RCX, Code::instructions_offset()));
+  __ addq(RCX, Immediate(Instructions::HeaderSize() - kHeapObjectTag));
+  __ jmp(RCX);
+
+  __ Bind(&next_iteration);
+  __ AddImmediate(RBX, Immediate(FunctionsCache::kNumEntries * kWordSize));
+  __ jmp(&loop, Assembler::kNearJump);
+
+  __ Bind(&not_found);
+}
+
+
+// Input parameters:
+//   R12: argument count, may be zero.
+// Uses RAX, RBX, RCX, RDX.
+static void PushArgumentsArray(Assembler* assembler, intptr_t arg_offset) {
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+
+  // Allocate array to store arguments of caller.
+  __ movq(RDX, R12);  // Arguments array length.
+  __ SmiTag(RDX);  // Convert to Smi.
+  __ movq(RCX, raw_null);  // Null element type for raw Array.
+  __ call(&StubCode::AllocateArrayLabel());
+  __ SmiUntag(RDX);
+  // RAX: newly allocated array.
+  // RDX: length of the array (was preserved by the stub).
+  __ pushq(RAX);  // Array is in RAX and on top of stack.
+  __ leaq(RBX, Address(RSP, RDX, TIMES_8, arg_offset));  // Addr of first arg.
+  __ leaq(RCX, FieldAddress(RAX, Array::data_offset()));
+  Label loop, loop_condition;
+  __ jmp(&loop_condition, Assembler::kNearJump);
+  __ Bind(&loop);
+  __ movq(RAX, Address(RBX, 0));
+  __ movq(Address(RCX, 0), RAX);
+  __ AddImmediate(RCX, Immediate(kWordSize));
+  __ AddImmediate(RBX, Immediate(-kWordSize));
+  __ Bind(&loop_condition);
+  __ decq(RDX);
+  __ j(POSITIVE, &loop, Assembler::kNearJump);
 }
 
 
+// Input parameters:
+//   RCX: ic-data array.
+//   RDX: arguments descriptor array (num_args is first Smi element).
+// Note: The receiver object is the first argument to the function being
+//       called, the stub accesses the receiver from this location directly
+//       when trying to resolve the call.
+// Uses R12.
 void StubCode::GenerateMegamorphicLookupStub(Assembler* assembler) {
-  __ Unimplemented("MegamorphicLookup stub");
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+
+  MegamorphicLookup(assembler);
+  // Lookup in function_table_ failed, resolve, compile and enter function
+  // into function_table_.
+
+  // Create a stub frame as we are pushing some objects on the stack before
+  // calling into the runtime.
+  __ EnterFrame(0);
+
+  // Preserve values across call to resolving.
+  // Stack at this point:
+  // TOS + 0: Saved RBP of previous frame. <== RBP
+  // TOS + 1: Dart code return address
+  // TOS + 2: Last argument of caller.
+  // ....
+  // Total number of args is the first Smi in args descriptor array (RDX).
+  __ movq(RAX, FieldAddress(RDX, Array::data_offset()));
+  __ movq(RAX, Address(RSP, RAX, TIMES_4, kWordSize));  // Get receiver.
+  __ pushq(RDX);  // Preserve arguments descriptor array.
+  __ pushq(RAX);  // Preserve receiver.
+  __ pushq(RCX);  // Preserve ic-data array.
+  // First resolve the function to get the function object.
+
+  // Setup space for return value on stack by pushing smi 0.
+  __ pushq(Immediate(0));
+  __ pushq(RAX);  // Push receiver.
+  __ CallRuntimeFromStub(kResolveCompileInstanceFunctionRuntimeEntry);
+  __ popq(RAX);  // Remove receiver pushed earlier.
+  __ popq(RCX);  // Pop returned code object into RCX.
+  // Pop preserved values
+  __ popq(RDX);  // Restore ic-data array.
+  __ popq(RAX);  // Restore receiver.
+  __ popq(R12);  // Restore arguments descriptor array.
+
+  __ cmpq(RCX, raw_null);
+  Label check_implicit_closure;
+  __ j(EQUAL, &check_implicit_closure, Assembler::kNearJump);
+
+  // Remove the stub frame as we are about to jump to the dart function.
+  __ LeaveFrame();
+
+  __ movq(RDX, R12);
+  __ movq(RCX, FieldAddress(RCX, Code::instructions_offset()));
+  __ addq(RCX, Immediate(Instructions::HeaderSize() - kHeapObjectTag));
+  __ jmp(RCX);
+
+  __ Bind(&check_implicit_closure);
+  // RAX: receiver.
+  // RDX: ic-data array.
+  // RCX: raw_null.
+  // R12: arguments descriptor array.
+  // The target function was not found.
+  // First check to see if this is a getter function and we are
+  // trying to create a closure of an instance function.
+  // Push values that need to be preserved across runtime call.
+  __ pushq(RAX);  // Preserve receiver.
+  __ pushq(RDX);  // Preserve ic-data array.
+  __ pushq(R12);  // Preserve arguments descriptor array.
+
+  __ pushq(Immediate(0));
+  __ pushq(RAX);  // Push receiver.
+  __ pushq(RDX);  // Ic-data array.
+  __ CallRuntimeFromStub(kResolveImplicitClosureFunctionRuntimeEntry);
+  __ popq(RAX);
+  __ popq(RAX);
+  __ popq(RCX);  // Get return value into RCX, might be Closure object.
+
+  // Pop preserved values.
+  __ popq(R12);  // Restore arguments descriptor array.
+  __ popq(RDX);  // Restore ic-data array.
+  __ popq(RAX);  // Restore receiver.
+
+  __ cmpq(RCX, raw_null);
+  Label check_implicit_closure_through_getter;
+  __ j(EQUAL, &check_implicit_closure_through_getter, Assembler::kNearJump);
+
+  __ movq(RAX, RCX);  // Return value is the closure object.
+  // Remove the stub frame as we are about return.
+  __ LeaveFrame();
+  __ ret();
+
+  __ Bind(&check_implicit_closure_through_getter);
+  // RAX: receiver.
+  // RDX: ic-data array.
+  // RCX: raw_null.
+  // R12: arguments descriptor array.
+  // This is not the case of an instance so invoke the getter of the
+  // same name and see if we get a closure back which we are then
+  // supposed to invoke.
+  // Push values that need to be preserved across runtime call.
+  __ pushq(RAX);  // Preserve receiver.
+  __ pushq(RDX);  // Preserve ic-data array.
+  __ pushq(R12);  // Preserve arguments descriptor array.
+
+  __ pushq(Immediate(0));
+  __ pushq(RAX);  // Push receiver.
+  __ pushq(RDX);  // Ic-data array.
+  __ CallRuntimeFromStub(kResolveImplicitClosureThroughGetterRuntimeEntry);
+  __ popq(RDX);  // Pop argument.
+  __ popq(RAX);  // Pop argument.
+  __ popq(RCX);  // get return value into RCX, might be Closure object.
+
+  // Pop preserved values.
+  __ popq(R12);  // Restore arguments descriptor array.
+  __ popq(RDX);  // Restore ic-data array.
+  __ popq(RAX);  // Restore receiver.
+
+  __ cmpq(RCX, raw_null);
+  Label function_not_found;
+  __ j(EQUAL, &function_not_found, Assembler::kNearJump);
+
+  // RCX: Closure object.
+  // R12: Arguments descriptor array.
+  __ pushq(Immediate(0));  // Result from invoking Closure.
+  __ pushq(RCX);  // Closure object.
+  __ pushq(R12);  // Arguments descriptor.
+  __ movq(R12, FieldAddress(R12, Array::data_offset()));
+  __ SmiUntag(R12);
+  __ subq(R12, Immediate(1));  // Arguments array length, minus the receiver.
+  PushArgumentsArray(assembler, (kWordSize * 5));
+  // Stack layout explaining "(kWordSize * 5)" offset.
+  // TOS + 0: Argument array.
+  // TOS + 1: Arguments descriptor array.
+  // TOS + 2: Closure object.
+  // TOS + 3: Place for result from closure function.
+  // TOS + 4: Saved RBP of previous frame. <== RBP
+  // TOS + 5: Dart code return address
+  // TOS + 6: Last argument of caller.
+  // ....
+
+  __ CallRuntimeFromStub(kInvokeImplicitClosureFunctionRuntimeEntry);
+  // Remove arguments.
+  __ popq(RAX);
+  __ popq(RAX);
+  __ popq(RAX);
+  __ popq(RAX);  // Get result into RAX.
+
+  // Remove the stub frame as we are about to return.
+  __ LeaveFrame();
+  __ ret();
+
+  __ Bind(&function_not_found);
+  // The target function was not found, so invoke method
+  // "void noSuchMethod(function_name, args_array)".
+  //   RAX: receiver.
+  //   RDX: ic-data array.
+  //   RCX: raw_null.
+  //   R12: argument descriptor array.
+
+  // Setup space for return value on stack by pushing smi 0.
+  __ pushq(Immediate(0));  // Result from noSuchMethod.
+  __ pushq(RAX);  // Receiver.
+  __ pushq(RDX);  // IC-data array.
+  __ pushq(R12);  // Argument descriptor array.
+  __ movq(R12, FieldAddress(R12, Array::data_offset()));
+  __ SmiUntag(R12);
+  __ subq(R12, Immediate(1));  // Arguments array length, minus the receiver.
+  // See stack layout below explaining "wordSize * 6" offset.
+  PushArgumentsArray(assembler, (kWordSize * 6));
+
+  // Stack:
+  // TOS + 0: Argument array.
+  // TOS + 1: Argument descriptor array.
+  // TOS + 2: IC-data array.
+  // TOS + 3: Receiver.
+  // TOS + 4: Place for result from noSuchMethod.
+  // TOS + 5: Saved RBP of previous frame. <== RBP
+  // TOS + 6: Dart code return address
+  // TOS + 7: Last argument of caller.
+  // ....
+
+  __ CallRuntimeFromStub(kInvokeNoSuchMethodFunctionRuntimeEntry);
+  // Remove arguments.
+  __ popq(RAX);
+  __ popq(RAX);
+  __ popq(RAX);
+  __ popq(RAX);
+  __ popq(RAX);  // Get result into RAX.
+
+  // Remove the stub frame as we are about to return.
+  __ LeaveFrame();
+  __ ret();
+}
+
+
+void StubCode::GenerateDeoptimizeStub(Assembler* assembler) {
+  __ EnterFrame(0);
+  // Stack at this point:
+  // TOS + 0: Saved RBP of function frame that will be deoptimized. <== RBP
+  // TOS + 1: Deoptimization point (return address), will be patched.
+  // TOS + 2: top-of-stack at deoptimization point (all arguments on stack).
+  __ CallRuntimeFromStub(kDeoptimizeRuntimeEntry);
+  __ LeaveFrame();
+  __ ret();
+}
+
+
+// Registers that are not preserved across calls to C++ functions.
+static const Register kVolatileCpuRegisters[] = {
+  RAX, RCX, RDX, RSI, RDI, R8, R9, R10, R11
+};
+static const intptr_t kNumberOfVolatileCpuRegisters =
+    ARRAY_SIZE(kVolatileCpuRegisters);
+static const intptr_t kXmmSaveSize = kNumberOfXmmRegisters * sizeof(double);
+
+
+// Saves the volatile cpu and xmm registers in the current frame, which must
+// not contain anything else, before a leaf call to the runtime.
+static void SaveVolatileRegisters(Assembler* assembler) {
+  for (intptr_t i = 0; i < kNumberOfVolatileCpuRegisters; i++) {
+    __ pushq(kVolatileCpuRegisters[i]);
+  }
+  __ subq(RSP, Immediate(kXmmSaveSize));
+  for (intptr_t i = 0; i < kNumberOfXmmRegisters; i++) {
+    __ movsd(Address(RSP, i * sizeof(double)), static_cast<XmmRegister>(i));
+  }
+}
+
+
+// Restores the registers saved by SaveVolatileRegisters, discarding whatever
+// was pushed on the stack after them.
+static void RestoreVolatileRegisters(Assembler* assembler) {
+  const intptr_t saved_size =
+      kNumberOfVolatileCpuRegisters * kWordSize + kXmmSaveSize;
+  __ leaq(RSP, Address(RBP, -saved_size));
+  for (intptr_t i = 0; i < kNumberOfXmmRegisters; i++) {
+    __ movsd(static_cast<XmmRegister>(i), Address(RSP, i * sizeof(double)));
+  }
+  __ addq(RSP, Immediate(kXmmSaveSize));
+  for (intptr_t i = kNumberOfVolatileCpuRegisters - 1; i >= 0; i--) {
+    __ popq(kVolatileCpuRegisters[i]);
+  }
+}
+
+
+// Shared overflow path of the UpdateStoreBuffer and MarkingBarrier stubs:
+// calls 'process' with the isolate as argument in a leaf call to the runtime
+// and returns from the stub. No Dart objects are allocated, so no exit frame
+// needs to be setup. Preserves all registers.
+static void GenerateProcessBufferCall(Assembler* assembler,
+                                      void (*process)(Isolate* isolate)) {
+  __ EnterFrame(0);
+  SaveVolatileRegisters(assembler);
+
+  // Pass the isolate as argument and align the frame.
+  __ movq(kCArg0Reg, FieldAddress(CTX, Context::isolate_offset()));
+  if (kCShadowSpaceSize > 0) {
+    __ subq(RSP, Immediate(kCShadowSpaceSize));
+  }
+  if (OS::ActivationFrameAlignment() > 0) {
+    __ andq(RSP, Immediate(~(OS::ActivationFrameAlignment() - 1)));
+  }
+  __ movq(RAX, Immediate(reinterpret_cast<intptr_t>(process)));
+  __ call(RAX);
+
+  RestoreVolatileRegisters(assembler);
+  __ LeaveFrame();
+  __ ret();
+}
+
+
+// Called from the UpdateStoreBuffer stub when the store buffer block of the
+// isolate is full.
+static void ProcessStoreBufferBlock(Isolate* isolate) {
+  isolate->store_buffer_block()->ProcessBuffer(isolate);
+}
+
+
+// Helper stub to implement Assembler::StoreIntoObject. Large arrays have a
+// card table in their page and only the card of the updated slot is dirtied,
+// other objects are added to the store buffer.
+// Input parameters:
+//   RDX: Address of the old object being stored into.
+//   TOS + 1: Address of the updated slot.
+// Preserves all registers.
+void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+  const intptr_t top_offset =
+      Isolate::store_buffer_block_offset() + StoreBufferBlock::top_offset();
+  const intptr_t pointers_offset =
+      Isolate::store_buffer_block_offset() +
+      StoreBufferBlock::pointers_offset();
+
+  // Save values being destroyed.
+  __ pushq(RAX);
+  __ pushq(RCX);
+
+  // Dirty the card of the slot if the page of the object has a card table.
+  Label no_card_table;
+  __ movq(RAX, RDX);
+  __ andq(RAX, Immediate(~(HeapPage::kPageSize - 1)));
+  __ movq(RCX, Address(RAX, HeapPage::card_table_offset()));
+  __ testq(RCX, RCX);
+  __ j(ZERO, &no_card_table, Assembler::kNearJump);
+  __ negq(RAX);
+  __ addq(RAX, Address(RSP, 3 * kWordSize));  // Offset of the slot in page.
+  __ shrq(RAX, Immediate(HeapPage::kCardBits));
+  __ movb(Address(RCX, RAX, TIMES_1, 0), Immediate(1));
+  __ popq(RCX);
+  __ popq(RAX);
+  __ ret();
+
+  __ Bind(&no_card_table);
+  // Load the isolate out of the context.
+  __ movq(RAX, FieldAddress(CTX, Context::isolate_offset()));
+
+  // Load top_ out of the StoreBufferBlock and add the address to pointers_.
+  __ movl(RCX, Address(RAX, top_offset));
+  __ movq(Address(RAX, RCX, TIMES_8, pointers_offset), RDX);
+
+  // Increment top_ and check for overflow.
+  __ incq(RCX);
+  __ movl(Address(RAX, top_offset), RCX);
+  __ cmpq(RCX, Immediate(StoreBufferBlock::kSize));
+
+  // Restore values, popq does not change the flags.
+  __ popq(RCX);
+  __ popq(RAX);
+  Label overflow;
+  __ j(EQUAL, &overflow, Assembler::kNearJump);
+  __ ret();
+
+  // Handle overflow: Process the block in a leaf call to the runtime.
+  __ Bind(&overflow);
+  GenerateProcessBufferCall(assembler, &ProcessStoreBufferBlock);
+}
+
+
+// Called from the MarkingBarrier stub when the marking buffer block of the
+// isolate is full.
+static void ProcessMarkingBufferBlock(Isolate* isolate) {
+  isolate->marking_buffer_block()->ProcessBuffer(isolate);
 }
 
 
+// Helper stub to implement Assembler::StoreIntoObject while old space is
+// marked concurrently.
+// Input parameters:
+//   RDX: Value being overwritten in an old object.
+// Preserves all registers.
+void StubCode::GenerateMarkingBarrierStub(Assembler* assembler) {
+  const intptr_t top_offset =
+      Isolate::marking_buffer_block_offset() +
+      MarkingBufferBlock::top_offset();
+  const intptr_t pointers_offset =
+      Isolate::marking_buffer_block_offset() +
+      MarkingBufferBlock::pointers_offset();
+
+  // Only old objects need to be logged.
+  Label done;
+  __ testq(RDX, Immediate(kSmiTagMask));
+  __ j(ZERO, &done, Assembler::kNearJump);  // Smi value.
+  __ testq(RDX, Immediate(kNewObjectAlignmentOffset));
+  __ j(NOT_ZERO, &done, Assembler::kNearJump);  // New object.
+
+  // Save values being destroyed.
+  __ pushq(RAX);
+  __ pushq(RCX);
+
+  // Load the isolate out of the context.
+  __ movq(RAX, FieldAddress(CTX, Context::isolate_offset()));
+
+  // Load top_ out of the MarkingBufferBlock and add the value to pointers_.
+  __ movl(RCX, Address(RAX, top_offset));
+  __ movq(Address(RAX, RCX, TIMES_8, pointers_offset), RDX);
+
+  // Increment top_ and check for overflow.
+  __ incq(RCX);
+  __ movl(Address(RAX, top_offset), RCX);
+  __ cmpq(RCX, Immediate(MarkingBufferBlock::kSize));
+
+  // Restore values, popq does not change the flags.
+  __ popq(RCX);
+  __ popq(RAX);
+  Label overflow;
+  __ j(EQUAL, &overflow, Assembler::kNearJump);
+  __ Bind(&done);
+  __ ret();
+
+  // Handle overflow: Mark the logged objects in a leaf call to the runtime.
+  __ Bind(&overflow);
+  GenerateProcessBufferCall(assembler, &ProcessMarkingBufferBlock);
+}
+
+
+// Called for inline allocation of arrays.
+// Input parameters:
+//   RDX : Array length as Smi.
+//   RCX : array element type (either NULL or an instantiated type).
+// Uses RAX, RBX, RCX, R12  as temporary registers.
+// NOTE: RDX cannot be cloberred here as the caller relies on it
+// being saved.
+// The newly allocated object is returned in RAX.
+void StubCode::GenerateAllocateArrayStub(Assembler* assembler) {
+  Label slow_case;
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+
+  if (FLAG_inline_alloc) {
+    // Compute the size to be allocated, it is based on the array length
+    // and it computed as:
+    // RoundedAllocationSize((array_length * kwordSize) + sizeof(RawArray)).
+    // Assert that length is a Smi.
+    __ testq(RDX, Immediate(kSmiTagSize));
+    __ j(NOT_ZERO, &slow_case, Assembler::kNearJump);
+    __ movq(R12, FieldAddress(CTX, Context::isolate_offset()));
+    __ movq(R12, Address(R12, Isolate::heap_offset()));
+    __ movq(R12, Address(R12, Heap::new_space_offset()));
+
+    // Calculate and align allocation size.
+    // Load new object start and calculate next object start.
+    // RCX: array element type.
+    // RDX: Array length as Smi.
+    // R12: Points to new space object.
+    __ movq(RAX, Address(R12, Scavenger::top_offset()));
+    intptr_t fixed_size = sizeof(RawArray) + kObjectAlignment - 1;
+    __ leaq(RBX, Address(RDX, TIMES_4, fixed_size));
+    ASSERT(kSmiTagShift == 1);
+    __ andq(RBX, Immediate(-kObjectAlignment));
+    __ leaq(RBX, Address(RAX, RBX, TIMES_1, 0));
+
+    // Check if the allocation fits into the remaining space.
+    // RAX: potential new object start.
+    // RBX: potential next object start.
+    // RCX: array element type.
+    // RDX: Array length as Smi.
+    // R12: Points to new space object.
+    __ cmpq(RBX, Address(R12, Scavenger::end_offset()));
+    __ j(ABOVE_EQUAL, &slow_case, Assembler::kNearJump);
+
+    // Successfully allocated the object(s), now update top to point to
+    // next object start and initialize the object.
+    // RAX: potential new object start.
+    // RBX: potential next object start.
+    // R12: Points to new space object.
+    __ movq(Address(R12, Scavenger::top_offset()), RBX);
+    __ addq(RAX, Immediate(kHeapObjectTag));
+
+    // RAX: new object start as a tagged pointer.
+    // RBX: new object end address.
+    // RCX: array element type.
+    // RDX: Array length as Smi.
+
+    // Store the type argument field.
+    __ movq(FieldAddress(RAX, Array::type_arguments_offset()), RCX);
+
+    // Set the length field.
+    __ movq(FieldAddress(RAX, Array::length_offset()), RDX);
+
+    // Store class value for array.
+    __ movq(RCX, FieldAddress(CTX, Context::isolate_offset()));
+    __ movq(RCX, Address(RCX, Isolate::object_store_offset()));
+    __ movq(RCX, Address(RCX, ObjectStore::array_class_offset()));
+    __ movq(FieldAddress(RAX, Array::class_offset()), RCX);
+
+    // Initialize all array elements to raw_null.
+    // RAX: new object start as a tagged pointer.
+    // RBX: new object end address.
+    // RCX: iterator which initially points to the start of the variable
+    // data area to be initialized.
+    __ leaq(RCX, FieldAddress(RAX, Array::data_offset()));
+    Label done;
+    Label init_loop;
+    __ Bind(&init_loop);
+    __ cmpq(RCX, RBX);
+    __ j(ABOVE_EQUAL, &done, Assembler::kNearJump);
+    __ movq(Address(RCX, 0), raw_null);
+    __ addq(RCX, Immediate(kWordSize));
+    __ jmp(&init_loop, Assembler::kNearJump);
+    __ Bind(&done);
+
+    // Done allocating and initializing the array.
+    // RAX: new object.
+    __ ret();
+  }
+
+  // Unable to allocate the array using the fast inline code, just call
+  // into the runtime.
+  __ Bind(&slow_case);
+  __ EnterFrame(0);
+  __ pushq(raw_null);  // Push Null object for return value.
+  __ pushq(RDX);  // Array length as Smi.
+  __ pushq(RCX);  // Element type.
+  __ pushq(raw_null);  // Null instantiator.
+  __ CallRuntimeFromStub(kAllocateArrayRuntimeEntry);
+  __ popq(RAX);  // Pop instantiator.
+  __ popq(RAX);  // Pop element type argument.
+  __ popq(RDX);  // Pop array length argument.
+  __ popq(RAX);  // Pop return value from return slot.
+  __ LeaveFrame();
+  __ ret();
+}
+
+
+// Input parameters:
+//   RDX: Arguments descriptor array (num_args is first Smi element, closure
+//        object is not included in num_args).
+// Note: The closure object is pushed before the first argument to the function
+//       being called, the stub accesses the closure from this location directly
+//       when setting up the context and resolving the entry point.
+// Uses R12.
 void StubCode::GenerateCallClosureFunctionStub(Assembler* assembler) {
-  __ Unimplemented("CallClosureFunction stub");
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+
+  // Total number of args is the first Smi in args descriptor array (RDX).
+  __ movq(RAX, FieldAddress(RDX, Array::data_offset()));  // Load num_args.
+  // Load closure object in R12.
+  __ movq(R12, Address(RSP, RAX, TIMES_4, kWordSize));  // RAX is a Smi.
+
+  // Verify that R12 is a closure by checking its class.
+  Label not_closure;
+  __ cmpq(R12, raw_null);
+  // Not a closure, but null object.
+  __ j(EQUAL, &not_closure, Assembler::kNearJump);
+  __ testq(R12, Immediate(kSmiTagMask));
+  __ j(ZERO, &not_closure, Assembler::kNearJump);  // Not a closure, but a smi.
+  // Verify that the class of the object is a closure class by checking that
+  // class.signature_function() is not null.
+  __ movq(RAX, FieldAddress(R12, Object::class_offset()));
+  __ movq(RAX, FieldAddress(RAX, Class::signature_function_offset()));
+  __ cmpq(RAX, raw_null);
+  // Actual class is not a closure class.
+  __ j(EQUAL, &not_closure, Assembler::kNearJump);
+
+  // RAX is just the signature function. Load the actual closure function.
+  __ movq(RCX, FieldAddress(R12, Closure::function_offset()));
+
+  // Load closure context in CTX; note that CTX has already been preserved.
+  __ movq(CTX, FieldAddress(R12, Closure::context_offset()));
+
+  // Load closure function code in RAX.
+  __ movq(RAX, FieldAddress(RCX, Function::code_offset()));
+  __ cmpq(RAX, raw_null);
+  Label function_compiled;
+  __ j(NOT_EQUAL, &function_compiled, Assembler::kNearJump);
+
+  // Create a stub frame as we are pushing some objects on the stack before
+  // calling into the runtime.
+  __ EnterFrame(0);
+
+  __ pushq(RDX);  // Preserve arguments descriptor array.
+  __ pushq(RCX);
+  __ CallRuntimeFromStub(kCompileFunctionRuntimeEntry);
+  __ popq(RCX);  // Restore read-only function object argument in RCX.
+  __ popq(RDX);  // Restore arguments descriptor array.
+  // Restore RAX.
+  __ movq(RAX, FieldAddress(RCX, Function::code_offset()));
+
+  // Remove the stub frame as we are about to jump to the closure function.
+  __ LeaveFrame();
+
+  __ Bind(&function_compiled);
+  // RAX: Code.
+  // RCX: Function.
+  // RDX: Arguments descriptor array (num_args is first Smi element).
+
+  __ movq(RCX, FieldAddress(RAX, Code::instructions_offset()));
+  __ addq(RCX, Immediate(Instructions::HeaderSize() - kHeapObjectTag));
+  __ jmp(RCX);
+
+  __ Bind(&not_closure);
+  // Call runtime to report that a closure call was attempted on a non-closure
+  // object, passing the non-closure object and its arguments array.
+  // R12: non-closure object.
+  // RDX: arguments descriptor array (num_args is first Smi element, closure
+  //      object is not included in num_args).
+
+  // Create a stub frame as we are pushing some objects on the stack before
+  // calling into the runtime.
+  __ EnterFrame(0);
+
+  // Setup space for return value on stack by pushing smi 0.
+  __ pushq(Immediate(0));  // Result from reporting the error.
+  __ pushq(R12);  // Non-closure object.
+    // Total number of args is the first Smi in args descriptor array (RDX).
+  __ movq(R12, FieldAddress(RDX, Array::data_offset()));  // Load num_args.
+  __ SmiUntag(R12);
+  // See stack layout below explaining "wordSize * 4" offset.
+  PushArgumentsArray(assembler, (kWordSize * 4));
+
+  // Stack:
+  // TOS + 0: Argument array.
+  // TOS + 1: Non-closure object.
+  // TOS + 2: Place for result from reporting the error.
+  // TOS + 3: Saved RBP of previous frame. <== RBP
+  // TOS + 4: Dart code return address
+  // TOS + 5: Last argument of caller.
+  // ....
+  __ CallRuntimeFromStub(kReportObjectNotClosureRuntimeEntry);
+  __ Stop("runtime call throws an exception");
+}
+
+
+// Called when invoking dart code from C++ (VM code).
+// Input parameters:
+//   RSP : points to return address.
+//   kCArg0Reg : entrypoint of the dart function to call.
+//   kCArg1Reg : arguments descriptor array.
+//   kCArg2Reg : pointer to the argument array.
+//   kCArg3Reg : new context containing the current isolate pointer.
+// Uses RAX, RDX, RCX, R12 as temporary registers.
+void StubCode::GenerateInvokeDartCodeStub(Assembler* assembler) {
+  const int kEntryPointOffset = -1 * kWordSize;
+  const int kArgumentsDescOffset = -2 * kWordSize;
+  const int kArgumentsOffset = -3 * kWordSize;
+  const int kNewContextOffset = -4 * kWordSize;
+
+  // Save frame pointer coming in.
+  __ EnterFrame(0);
+
+  // Save the incoming arguments in the frame, they are reread after the call
+  // to the dart code.
+  __ pushq(kCArg0Reg);
+  __ pushq(kCArg1Reg);
+  __ pushq(kCArg2Reg);
+  __ pushq(kCArg3Reg);
+
+  // Save C++ ABI callee-saved registers.
+  __ pushq(RBX);
+  __ pushq(R12);
+  __ pushq(R13);
+  __ pushq(R14);
+  __ pushq(CTX);
+#if defined(TARGET_OS_WINDOWS)
+  __ pushq(RSI);
+  __ pushq(RDI);
+  __ subq(RSP, Immediate(kCSavedXmmRegCount * 16));
+  for (intptr_t i = 0; i < kCSavedXmmRegCount; i++) {
+    XmmRegister reg = static_cast<XmmRegister>(kCFirstSavedXmmReg + i);
+    __ movups(Address(RSP, i * 16), reg);
+  }
+#endif
+
+  // The new Context structure contains a pointer to the current Isolate
+  // structure. Cache the Context pointer in the CTX register so that it is
+  // available in generated code and calls to Isolate::Current() need not be
+  // done. The assumption is that this register will never be clobbered by
+  // compiled or runtime stub code.
+
+  // Cache the new Context pointer into CTX while executing dart code.
+  __ movq(CTX, Address(RBP, kNewContextOffset));
+  __ movq(CTX, Address(CTX, VMHandles::kOffsetOfRawPtrInHandle));
+
+  // Load Isolate pointer from Context structure into R12.
+  __ movq(R12, FieldAddress(CTX, Context::isolate_offset()));
+
+  // Save the top exit frame info. Use RDX as a temporary register.
+  __ movq(RDX, Address(R12, Isolate::top_exit_frame_info_offset()));
+  __ pushq(RDX);
+  __ movq(Address(R12, Isolate::top_exit_frame_info_offset()), Immediate(0));
+
+  // StackFrameIterator reads the top exit frame info saved in this frame.
+  // The constant kExitLinkOffsetInEntryFrame must be kept in sync with the
+  // code above: RBP - 10 * kWordSize - kCExtraCalleeSavedSize.
+
+  // Save the old Context pointer. Use RCX as a temporary register.
+  // Note that VisitObjectPointers will find this saved Context pointer during
+  // GC marking, since it traverses any information between SP and
+  // FP - kExitLinkOffsetInEntryFrame.
+  __ movq(RCX, Address(R12, Isolate::top_context_offset()));
+  __ pushq(RCX);
+
+  // Load arguments descriptor array into RDX.
+  __ movq(RDX, Address(RBP, kArgumentsDescOffset));
+  __ movq(RDX, Address(RDX, VMHandles::kOffsetOfRawPtrInHandle));
+
+  // Load number of arguments into RBX.
+  __ movq(RBX, FieldAddress(RDX, Array::data_offset()));
+  __ SmiUntag(RBX);
+
+  // Set up arguments for the dart call.
+  Label push_arguments;
+  Label done_push_arguments;
+  __ testq(RBX, RBX);  // check if there are arguments.
+  __ j(ZERO, &done_push_arguments, Assembler::kNearJump);
+  __ movq(RAX, Immediate(0));
+  __ movq(R12, Address(RBP, kArgumentsOffset));  // start of arguments.
+  __ Bind(&push_arguments);
+  __ movq(RCX, Address(R12, RAX, TIMES_8, 0));
+  __ movq(RCX, Address(RCX, VMHandles::kOffsetOfRawPtrInHandle));
+  __ pushq(RCX);
+  __ incq(RAX);
+  __ cmpq(RAX, RBX);
+  __ j(LESS, &push_arguments, Assembler::kNearJump);
+  __ Bind(&done_push_arguments);
+
+  // Call the dart code entrypoint.
+  __ call(Address(RBP, kEntryPointOffset));
+
+  // Reread the Context pointer.
+  __ movq(CTX, Address(RBP, kNewContextOffset));
+  __ movq(CTX, Address(CTX, VMHandles::kOffsetOfRawPtrInHandle));
+
+  // Reread the arguments descriptor array to obtain the number of passed
+  // arguments, which is the first element of the array, a Smi.
+  __ movq(RDX, Address(RBP, kArgumentsDescOffset));
+  __ movq(RDX, Address(RDX, VMHandles::kOffsetOfRawPtrInHandle));
+  __ movq(RDX, FieldAddress(RDX, Array::data_offset()));
+  // Get rid of arguments pushed on the stack.
+  __ leaq(RSP, Address(RSP, RDX, TIMES_4, 0));  // RDX is a Smi.
+
+  // Load Isolate pointer from Context structure into CTX. Drop Context.
+  __ movq(CTX, FieldAddress(CTX, Context::isolate_offset()));
+
+  // Restore the saved Context pointer into the Isolate structure.
+  // Uses RCX as a temporary register for this.
+  __ popq(RCX);
+  __ movq(Address(CTX, Isolate::top_context_offset()), RCX);
+
+  // Restore the saved top exit frame info back into the Isolate structure.
+  // Uses RDX as a temporary register for this.
+  __ popq(RDX);
+  __ movq(Address(CTX, Isolate::top_exit_frame_info_offset()), RDX);
+
+  // Restore C++ ABI callee-saved registers.
+#if defined(TARGET_OS_WINDOWS)
+  for (intptr_t i = 0; i < kCSavedXmmRegCount; i++) {
+    XmmRegister reg = static_cast<XmmRegister>(kCFirstSavedXmmReg + i);
+    __ movups(reg, Address(RSP, i * 16));
+  }
+  __ addq(RSP, Immediate(kCSavedXmmRegCount * 16));
+  __ popq(RDI);
+  __ popq(RSI);
+#endif
+  __ popq(CTX);
+  __ popq(R14);
+  __ popq(R13);
+  __ popq(R12);
+  __ popq(RBX);
+
+  // Restore the frame pointer.
+  __ LeaveFrame();
+
+  __ ret();
 }
 
 
+// Called for inline allocation of contexts.
+// Input:
+// RDX: number of context variables.
+// Output:
+// RAX: new allocated RawContext object.
+// RBX and RDX are destroyed.
 void StubCode::GenerateAllocateContextStub(Assembler* assembler) {
-  __ Unimplemented("AllocateContext stub");
+  if (FLAG_inline_alloc) {
+    const Class& context_class = Class::ZoneHandle(Object::context_class());
+    Label slow_case;
+    Heap* heap = Isolate::Current()->heap();
+    // First compute the rounded instance size.
+    // RDX: number of context variables.
+    intptr_t fixed_size = (sizeof(RawContext) + kObjectAlignment - 1);
+    __ leaq(RBX, Address(RDX, TIMES_8, fixed_size));
+    __ andq(RBX, Immediate(-kObjectAlignment));
+
+    // Now allocate the object.
+    // RDX: number of context variables.
+    __ movq(TMP, Immediate(heap->TopAddress()));
+    __ movq(RAX, Address(TMP, 0));
+    __ addq(RBX, RAX);
+    // Check if the allocation fits into the remaining space.
+    // RAX: potential new object.
+    // RBX: potential next object start.
+    // RDX: number of context variables.
+    __ movq(TMP, Immediate(heap->EndAddress()));
+    __ cmpq(RBX, Address(TMP, 0));
+    __ j(ABOVE_EQUAL, &slow_case, Assembler::kNearJump);
+
+    // Successfully allocated the object, now update top to point to
+    // next object start and initialize the object.
+    // RAX: new object.
+    // RBX: next object start.
+    // RDX: number of context variables.
+    __ movq(TMP, Immediate(heap->TopAddress()));
+    __ movq(Address(TMP, 0), RBX);
+    __ addq(RAX, Immediate(kHeapObjectTag));
+
+    // Initialize the class field in the context object.
+    // RAX: new object.
+    // RDX: number of context variables.
+    __ LoadObject(RBX, context_class);  // Load up class field of context.
+    __ movq(FieldAddress(RAX, Context::class_offset()), RBX);
+
+    // Setup up number of context variables field.
+    // RAX: new object.
+    // RDX: number of context variables.
+    __ movq(FieldAddress(RAX, Context::num_variables_offset()), RDX);
+
+    // Setup isolate field.
+    // Load Isolate pointer from Context structure into RBX.
+    // RAX: new object.
+    // RDX: number of context variables.
+    __ movq(RBX, FieldAddress(CTX, Context::isolate_offset()));
+    __ movq(FieldAddress(RAX, Context::isolate_offset()), RBX);
+
+    const Immediate raw_null =
+        Immediate(reinterpret_cast<intptr_t>(Object::null()));
+    // Setup the parent field.
+    // RAX: new object.
+    // RDX: number of context variables.
+    __ movq(FieldAddress(RAX, Context::parent_offset()), raw_null);
+
+    // Initialize the context variables.
+    // RAX: new object.
+    // RDX: number of context variables.
+    {
+      Label loop, entry;
+      __ leaq(RBX, FieldAddress(RAX, Context::variable_offset(0)));
+
+      __ jmp(&entry, Assembler::kNearJump);
+      __ Bind(&loop);
+      __ decq(RDX);
+      __ movq(Address(RBX, RDX, TIMES_8, 0), raw_null);
+      __ Bind(&entry);
+      __ cmpq(RDX, Immediate(0));
+      __ j(NOT_EQUAL, &loop, Assembler::kNearJump);
+    }
+
+    // Done allocating and initializing the context.
+    // RAX: new object.
+    __ ret();
+
+    __ Bind(&slow_case);
+  }
+  // Create a stub frame.
+  __ EnterFrame(0);
+  const Context& new_context = Context::ZoneHandle();
+  __ PushObject(new_context);  // Push Null context for return value.
+  __ SmiTag(RDX);
+  __ pushq(RDX);
+  __ CallRuntimeFromStub(kAllocateContextRuntimeEntry);  // Allocate context.
+  __ popq(RAX);  // Pop number of context variables argument.
+  __ popq(RAX);  // Pop the new context object.
+  // RAX: new object
+  // Restore the frame pointer.
+  __ LeaveFrame();
+  __ ret();
 }
 
 
+// Called for inline allocation of objects.
+// Input parameters:
+//   RSP + 16 : type arguments object (only if class is parameterized).
+//   RSP + 8 : type arguments of instantiator (only if class is parameterized).
+//   RSP : points to return address.
+// Uses RAX, RBX, RCX, RDX, R12 as temporary registers.
 void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
                                               const Class& cls) {
-  __ Unimplemented("AllocateObject stub");
+  const intptr_t kObjectTypeArgumentsOffset = 2 * kWordSize;
+  const intptr_t kInstantiatorTypeArgumentsOffset = 1 * kWordSize;
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  // The generated code is different if the class is parameterized.
+  const bool is_cls_parameterized =
+      cls.type_arguments_instance_field_offset() != Class::kNoTypeArguments;
+  // kInlineInstanceSize is a constant used as a threshold for determining
+  // when the object initialization should be done as a loop or as
+  // straight line code.
+  const int kInlineInstanceSize = 12;
+  const intptr_t instance_size = cls.instance_size();
+  ASSERT(instance_size > 0);
+  const intptr_t type_args_size = InstantiatedTypeArguments::InstanceSize();
+  if (FLAG_inline_alloc &&
+      PageSpace::IsPageAllocatableSize(instance_size + type_args_size)) {
+    Label slow_case, initialize;
+    Heap* heap = Isolate::Current()->heap();
+    if (FLAG_pretenure) {
+      __ LoadObject(RDX, cls);
+      __ cmpq(FieldAddress(RDX, Class::is_pretenured_offset()), Immediate(0));
+      if (is_cls_parameterized) {
+        // The type arguments may be new objects, which would have to be
+        // remembered. Instances of pretenured parameterized classes are
+        // allocated in old space by the runtime.
+        __ j(NOT_EQUAL, &slow_case);
+      } else {
+        // Instances of pretenured classes are allocated in the allocation
+        // buffer of old space, the runtime refills it once it ran out.
+        Label not_pretenured;
+        __ j(EQUAL, &not_pretenured, Assembler::kNearJump);
+        __ movq(TMP, Immediate(heap->OldTopAddress()));
+        __ movq(RAX, Address(TMP, 0));
+        __ leaq(RBX, Address(RAX, instance_size));
+        __ movq(TMP, Immediate(heap->OldEndAddress()));
+        __ cmpq(RBX, Address(TMP, 0));
+        __ j(ABOVE, &slow_case);
+        __ movq(TMP, Immediate(heap->OldTopAddress()));
+        __ movq(Address(TMP, 0), RBX);
+        // RDX: class of the object to be allocated.
+        __ incq(FieldAddress(RDX, Class::allocated_count_offset()));
+        __ jmp(&initialize);
+        __ Bind(&not_pretenured);
+      }
+    }
+    __ movq(TMP, Immediate(heap->TopAddress()));
+    __ movq(RAX, Address(TMP, 0));
+    __ leaq(RBX, Address(RAX, instance_size));
+    if (is_cls_parameterized) {
+      __ movq(RCX, RBX);
+      // A new InstantiatedTypeArguments object only needs to be allocated if
+      // the instantiator is non-null.
+      Label null_instantiator;
+      __ cmpq(Address(RSP, kInstantiatorTypeArgumentsOffset), raw_null);
+      __ j(EQUAL, &null_instantiator, Assembler::kNearJump);
+      __ addq(RBX, Immediate(type_args_size));
+      __ Bind(&null_instantiator);
+      // RCX: potential new object end and, if RCX != RBX, potential new
+      // InstantiatedTypeArguments object start.
+    }
+    // Check if the allocation fits into the remaining space.
+    // RAX: potential new object start.
+    // RBX: potential next object start.
+    __ movq(TMP, Immediate(heap->EndAddress()));
+    __ cmpq(RBX, Address(TMP, 0));
+    __ j(ABOVE_EQUAL, &slow_case);
+
+    // Successfully allocated the object(s), now update top to point to
+    // next object start and initialize the object.
+    __ movq(TMP, Immediate(heap->TopAddress()));
+    __ movq(Address(TMP, 0), RBX);
+
+    if (is_cls_parameterized) {
+      // Initialize the type arguments field in the object.
+      // RAX: new object start.
+      // RCX: potential new object end and, if RCX != RBX, potential new
+      // InstantiatedTypeArguments object start.
+      // RBX: next object start.
+      Label type_arguments_ready;
+      __ movq(R12, Address(RSP, kObjectTypeArgumentsOffset));
+      __ cmpq(RCX, RBX);
+      __ j(EQUAL, &type_arguments_ready, Assembler::kNearJump);
+      // Initialize InstantiatedTypeArguments object at RCX.
+      __ movq(Address(RCX,
+          InstantiatedTypeArguments::uninstantiated_type_arguments_offset()),
+              R12);
+      __ movq(RDX, Address(RSP, kInstantiatorTypeArgumentsOffset));
+      __ movq(Address(RCX,
+          InstantiatedTypeArguments::instantiator_type_arguments_offset()),
+              RDX);
+      __ LoadObject(RDX,
+          Class::ZoneHandle(Object::instantiated_type_arguments_class()));
+      __ movq(Address(RCX, Instance::class_offset()), RDX);  // Set its class.
+      // Set the new InstantiatedTypeArguments object (RCX) as the type
+      // arguments (R12) of the new object (RAX).
+      __ movq(R12, RCX);
+      __ addq(R12, Immediate(kHeapObjectTag));
+      // Set RBX to new object end.
+      __ movq(RBX, RCX);
+      __ Bind(&type_arguments_ready);
+      // RAX: new object.
+      // R12: new object type arguments.
+    }
+
+    // Initialize the class field in the object.
+    // RAX: new object start.
+    // RBX: next object start.
+    // R12: new object type arguments (if is_cls_parameterized).
+    __ Bind(&initialize);
+    __ LoadObject(RDX, cls);  // Load class of object to be allocated.
+    __ movq(Address(RAX, Instance::class_offset()), RDX);
+
+    // Initialize the remaining words of the object.
+    const Immediate raw_null =
+        Immediate(reinterpret_cast<intptr_t>(Object::null()));
+
+    // RAX: new object start.
+    // RBX: next object start.
+    // RDX: class of the object to be allocated.
+    // First try inlining the initialization without a loop.
+    if (instance_size < (kInlineInstanceSize * kWordSize) &&
+        cls.num_native_fields() == 0) {
+      // Check if the object contains any non-header fields.
+      // Small objects are initialized using a consecutive set of writes.
+      for (intptr_t current_offset = 1 * kWordSize;
+           current_offset < instance_size;
+           current_offset += kWordSize) {
+        __ movq(Address(RAX, current_offset), raw_null);
+      }
+    } else {
+      __ leaq(RCX, Address(RAX, 1 * kWordSize));
+      // Loop until the whole object is initialized.
+      Label init_loop;
+      if (cls.num_native_fields() > 0) {
+        // Initialize native fields.
+        // RAX: new object.
+        // RBX: next object start.
+        // RDX: class of the object to be allocated.
+        // RCX: next word to be initialized.
+        intptr_t offset = Class::num_native_fields_offset() - kHeapObjectTag;
+        __ movq(RDX, Address(RDX, offset));
+        __ leaq(RDX, Address(RAX, RDX, TIMES_8, 0));
+
+        // RDX: start of dart fields.
+        // RCX: next word to be initialized.
+        Label init_native_loop;
+        __ Bind(&init_native_loop);
+        __ cmpq(RCX, RDX);
+        __ j(ABOVE_EQUAL, &init_loop, Assembler::kNearJump);
+        __ movq(Address(RCX, 0), Immediate(0));
+        __ addq(RCX, Immediate(kWordSize));
+        __ jmp(&init_native_loop, Assembler::kNearJump);
+      }
+      // Now initialize the dart fields.
+      // RAX: new object.
+      // RBX: next object start.
+      // RCX: next word to be initialized.
+      Label done;
+      __ Bind(&init_loop);
+      __ cmpq(RCX, RBX);
+      __ j(ABOVE_EQUAL, &done, Assembler::kNearJump);
+      __ movq(Address(RCX, 0), raw_null);
+      __ addq(RCX, Immediate(kWordSize));
+      __ jmp(&init_loop, Assembler::kNearJump);
+      __ Bind(&done);
+    }
+    if (is_cls_parameterized) {
+      // R12: new object type arguments.
+      // Set the type arguments in the new object.
+      __ movq(Address(RAX, cls.type_arguments_instance_field_offset()), R12);
+    }
+    // Done allocating and initializing the instance.
+    // RAX: new object.
+    __ addq(RAX, Immediate(kHeapObjectTag));
+    __ ret();
+
+    __ Bind(&slow_case);
+  }
+  if (is_cls_parameterized) {
+    __ movq(RAX, Address(RSP, kObjectTypeArgumentsOffset));
+    __ movq(RDX, Address(RSP, kInstantiatorTypeArgumentsOffset));
+  }
+  // Create a stub frame.
+  __ EnterFrame(0);
+  const Object& new_object = Object::ZoneHandle();
+  __ PushObject(new_object);  // Push Null object for return value.
+  __ PushObject(cls);  // Push class of object to be allocated.
+  if (is_cls_parameterized) {
+    __ pushq(RAX);  // Push type arguments of object to be allocated.
+    __ pushq(RDX);  // Push type arguments of instantiator.
+  } else {
+    __ pushq(raw_null);  // Push null type arguments.
+    __ pushq(raw_null);  // Push null instantiator.
+  }
+  __ CallRuntimeFromStub(kAllocateObjectRuntimeEntry);  // Allocate object.
+  __ popq(RAX);  // Pop argument (instantiator).
+  __ popq(RAX);  // Pop argument (type arguments of object).
+  __ popq(RAX);  // Pop argument (class of object).
+  __ popq(RAX);  // Pop result (newly allocated object).
+  // RAX: new object
+  // Restore the frame pointer.
+  __ LeaveFrame();
+  __ ret();
 }
 
 
+// Called for inline allocation of closures.
+// Input parameters:
+//   If the signature class is not parameterized, the receiver, if any, will be
+//   at RSP + 8 instead of RSP + 16, since no type arguments are passed.
+//   RSP + 16 (or RSP + 8): receiver (only if implicit instance closure).
+//   RSP + 8 : type arguments object (only if signature class is parameterized).
+//   RSP : points to return address.
+// Uses RAX, RBX, RCX, RDX as temporary registers.
 void StubCode::GenerateAllocationStubForClosure(Assembler* assembler,
                                                 const Function& func) {
-  __ Unimplemented("AllocateClosure stub");
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  ASSERT(func.IsClosureFunction());
+  const bool is_implicit_static_closure =
+      func.IsImplicitStaticClosureFunction();
+  const bool is_implicit_instance_closure =
+      func.IsImplicitInstanceClosureFunction();
+  const Class& cls = Class::ZoneHandle(func.signature_class());
+  const bool has_type_arguments = cls.HasTypeArguments();
+  const intptr_t kTypeArgumentsOffset = 1 * kWordSize;
+  const intptr_t kReceiverOffset = (has_type_arguments ? 2 : 1) * kWordSize;
+  const intptr_t closure_size = Closure::InstanceSize();
+  const intptr_t context_size = Context::InstanceSize(1);  // Captured receiver.
+  if (FLAG_inline_alloc &&
+      PageSpace::IsPageAllocatableSize(closure_size + context_size)) {
+    Label slow_case;
+    Heap* heap = Isolate::Current()->heap();
+    __ movq(TMP, Immediate(heap->TopAddress()));
+    __ movq(RAX, Address(TMP, 0));
+    __ leaq(RBX, Address(RAX, closure_size));
+    if (is_implicit_instance_closure) {
+      __ movq(RCX, RBX);  // RCX: new context address.
+      __ addq(RBX, Immediate(context_size));
+    }
+    // Check if the allocation fits into the remaining space.
+    // RAX: potential new closure object.
+    // RCX: potential new context object (only if is_implicit_closure).
+    // RBX: potential next object start.
+    __ movq(TMP, Immediate(heap->EndAddress()));
+    __ cmpq(RBX, Address(TMP, 0));
+    __ j(ABOVE_EQUAL, &slow_case);
+
+    // Successfully allocated the object, now update top to point to
+    // next object start and initialize the object.
+    __ movq(TMP, Immediate(heap->TopAddress()));
+    __ movq(Address(TMP, 0), RBX);
+
+    // Initialize the class field in the object.
+    // RAX: new closure object.
+    // RCX: new context object (only if is_implicit_closure).
+    __ LoadObject(RDX, cls);  // Load signature class of closure.
+    __ movq(Address(RAX, Closure::class_offset()), RDX);
+
+    // Initialize the function field in the object.
+    // RAX: new closure object.
+    // RCX: new context object (only if is_implicit_closure).
+    // RBX: next object start.
+    __ LoadObject(RDX, func);  // Load function of closure to be allocated.
+    __ movq(Address(RAX, Closure::function_offset()), RDX);
+
+    // Setup the context for this closure.
+    if (is_implicit_static_closure) {
+      ObjectStore* object_store = Isolate::Current()->object_store();
+      ASSERT(object_store != NULL);
+      const Context& empty_context =
+          Context::ZoneHandle(object_store->empty_context());
+      __ LoadObject(RDX, empty_context);
+      __ movq(Address(RAX, Closure::context_offset()), RDX);
+    } else if (is_implicit_instance_closure) {
+      // Initialize the new context capturing the receiver.
+
+      // Set the class field to the Context class.
+      __ LoadObject(RBX, Class::ZoneHandle(Object::context_class()));
+      __ movq(Address(RCX, Context::class_offset()), RBX);
+
+      // Set number of variables field to 1 (for captured receiver).
+      __ movq(Address(RCX, Context::num_variables_offset()), Immediate(1));
+
+      // Set isolate field to isolate of current context.
+      __ movq(RDX, FieldAddress(CTX, Context::isolate_offset()));
+      __ movq(Address(RCX, Context::isolate_offset()), RDX);
+
+      // Set the parent field to null.
+      __ movq(Address(RCX, Context::parent_offset()), raw_null);
+
+      // Initialize the context variable to the receiver.
+      __ movq(RDX, Address(RSP, kReceiverOffset));
+      __ movq(Address(RCX, Context::variable_offset(0)), RDX);
+
+      // Set the newly allocated context in the newly allocated closure.
+      __ addq(RCX, Immediate(kHeapObjectTag));
+      __ movq(Address(RAX, Closure::context_offset()), RCX);
+    } else {
+      __ movq(Address(RAX, Closure::context_offset()), CTX);
+    }
+
+    // Set the type arguments field in the newly allocated closure.
+    if (has_type_arguments) {
+      ASSERT(!is_implicit_static_closure);
+      // Use the passed-in type arguments.
+      __ movq(RDX, Address(RSP, kTypeArgumentsOffset));
+      __ movq(Address(RAX, Closure::type_arguments_offset()), RDX);
+    } else {
+      // Set to null.
+      __ movq(Address(RAX, Closure::type_arguments_offset()), raw_null);
+    }
+
+    __ movq(Address(RAX, Closure::smrck_offset()), raw_null);
+
+    // Done allocating and initializing the instance.
+    // RAX: new object.
+    __ addq(RAX, Immediate(kHeapObjectTag));
+    __ ret();
+
+    __ Bind(&slow_case);
+  }
+  if (has_type_arguments) {
+    __ movq(RCX, Address(RSP, kTypeArgumentsOffset));
+  }
+  if (is_implicit_instance_closure) {
+    __ movq(RAX, Address(RSP, kReceiverOffset));
+  }
+  // Create a stub frame.
+  __ EnterFrame(0);
+  const Closure& new_closure = Closure::ZoneHandle();
+  __ PushObject(new_closure);  // Push Null closure for return value.
+  __ PushObject(func);
+  if (has_type_arguments) {
+    __ pushq(RCX);  // Push type arguments of closure to be allocated.
+  } else {
+    __ pushq(raw_null);  // Push null type arguments.
+  }
+  if (is_implicit_static_closure) {
+    __ CallRuntimeFromStub(kAllocateImplicitStaticClosureRuntimeEntry);
+  } else if (is_implicit_instance_closure) {
+    __ pushq(RAX);  // Receiver.
+    __ CallRuntimeFromStub(kAllocateImplicitInstanceClosureRuntimeEntry);
+    __ popq(RAX);  // Pop receiver.
+  } else {
+    ASSERT(func.IsNonImplicitClosureFunction());
+    __ CallRuntimeFromStub(kAllocateClosureRuntimeEntry);
+  }
+  __ popq(RAX);  // Pop argument (type arguments of object).
+  __ popq(RAX);  // Pop function object.
+  __ popq(RAX);
+  // RAX: new object
+  // Restore the frame pointer.
+  __ LeaveFrame();
+  __ ret();
+}
+
+
+// Called for invoking noSuchMethod function from the entry code of a dart
+// function after an error in passed named arguments is detected.
+// Input parameters:
+//   RBP : points to previous frame pointer.
+//   RBP + 8 : points to return address.
+//   RBP + 16 : address of last argument (arg n-1).
+//   RBP + 16 + 8*(n-1) : address of first argument (arg 0).
+//   RCX : ic-data array.
+//   RDX : arguments descriptor array.
+// Uses RAX, RBX, R12 as temporary registers.
+void StubCode::GenerateCallNoSuchMethodFunctionStub(Assembler* assembler) {
+  // The target function was not found, so invoke method
+  // "void noSuchMethod(function_name, Array arguments)".
+  // TODO(regis): For now, we simply pass the actual arguments, both positional
+  // and named, as the argument array. This is not correct if out-of-order
+  // named arguments were passed.
+  // The signature of the "noSuchMethod" method has to change from
+  // noSuchMethod(String name, Array arguments) to something like
+  // noSuchMethod(InvocationMirror call).
+  // Also, the class NoSuchMethodException has to be modified accordingly.
+  // Total number of args is the first Smi in args descriptor array (RDX).
+  __ movq(R12, FieldAddress(RDX, Array::data_offset()));
+  __ SmiUntag(R12);
+  __ movq(RAX, Address(RBP, R12, TIMES_8, kWordSize));  // Get receiver.
+
+  __ EnterFrame(0);
+  // Setup space for return value on stack by pushing smi 0.
+  __ pushq(Immediate(0));  // Result from noSuchMethod.
+  __ pushq(RAX);  // Receiver.
+  __ pushq(RCX);  // IC data array.
+  __ pushq(RDX);  // Arguments descriptor array.
+  __ subq(R12, Immediate(1));  // Arguments array length, minus the receiver.
+  // See stack layout below explaining "wordSize * 8" offset.
+  PushArgumentsArray(assembler, (kWordSize * 8));
+
+  // Stack:
+  // TOS + 0: Argument array.
+  // TOS + 1: Arguments descriptor array.
+  // TOS + 2: Ic-data array.
+  // TOS + 3: Receiver.
+  // TOS + 4: Place for result from noSuchMethod.
+  // TOS + 5: Saved RBP of previous frame. <== RBP
+  // TOS + 6: Dart callee (or stub) code return address
+  // TOS + 7: Saved RBP of dart caller frame.
+  // TOS + 8: Dart caller code return address
+  // TOS + 9: Last argument of caller.
+  // ....
+  __ CallRuntimeFromStub(kInvokeNoSuchMethodFunctionRuntimeEntry);
+  // Remove arguments.
+  __ popq(RAX);
+  __ popq(RAX);
+  __ popq(RAX);
+  __ popq(RAX);
+  __ popq(RAX);  // Get result into RAX.
+
+  // Remove the stub frame as we are about to return.
+  __ LeaveFrame();
+  __ ret();
+}
+
+
+// Use inline cache data array to invoke the target or continue in inline
+// cache miss handler. Stub for 1-argument check (receiver class).
+//  RCX: Inline cache data array
+//  RDX: Arguments array
+//  TOS(0): return address
+void StubCode::GenerateInlineCacheStub(Assembler* assembler) {
+  Label ic_miss, is_smi, test_class;
+  // Get receiver.
+  __ movq(RAX, FieldAddress(RDX, Array::data_offset()));
+  __ movq(RAX, Address(RSP, RAX, TIMES_4, 0));
+
+  __ CompareObject(RAX, Instance::ZoneHandle(Instance::null()));
+  __ j(EQUAL, &ic_miss, Assembler::kNearJump);  // Null receiver -> IC miss.
+
+  // Test if Smi -> load Smi class for comparison.
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(ZERO, &is_smi, Assembler::kNearJump);
+  __ movq(RAX, FieldAddress(RAX, Object::class_offset()));
+  __ jmp(&test_class);
+  __ Bind(&is_smi);
+  const Class& smi_class =
+      Class::ZoneHandle(Isolate::Current()->object_store()->smi_class());
+  __ LoadObject(RAX, smi_class);
+
+  __ Bind(&test_class);
+  // RAX: receiver's class
+  // RCX: IC data array.
+
+#if defined(DEBUG)
+  { Label ok;
+    // Check that the IC data array has NumberOfArgumentsChecked() == 1.
+    __ movq(RBX, FieldAddress(RCX,
+        Array::data_offset() + ICData::kNumArgsCheckedIndex * kWordSize));
+    const Immediate value = Immediate(reinterpret_cast<intptr_t>(Smi::New(1)));
+    __ cmpq(RBX, value);
+    __ j(EQUAL, &ok, Assembler::kNearJump);
+    __ Stop("Incorrect stub for IC data");
+    __ Bind(&ok);
+  }
+#endif  // DEBUG
+
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  __ leaq(RBX, FieldAddress(RCX,
+      Array::data_offset() + ICData::kChecksStartIndex * kWordSize));
+  Label loop, found, call_target_function;
+  __ Bind(&loop);
+  __ movq(R12, Address(RBX, 0));  // Get class to check.
+  __ cmpq(RAX, R12);  // Match?
+  __ j(EQUAL, &found, Assembler::kNearJump);
+  __ addq(RBX, Immediate(kWordSize * 2));  // next element (class + target).
+  __ cmpq(R12, raw_null);   // Done?
+  __ j(NOT_EQUAL, &loop, Assembler::kNearJump);
+
+  __ Bind(&ic_miss);
+
+    // Get receiver.
+  __ movq(RAX, FieldAddress(RDX, Array::data_offset()));
+  __ movq(RAX, Address(RSP, RAX, TIMES_4, 0));
+  __ EnterFrame(0);
+  // Setup space for return value on stack by pushing smi 0.
+  __ pushq(RDX);  // Preserve arguments array.
+  __ pushq(RCX);  // Preserve IC data array
+  __ pushq(Immediate(0));
+  __ pushq(RAX);  // Push receiver.
+  __ CallRuntimeFromStub(kInlineCacheMissHandlerRuntimeEntry);
+  __ popq(RAX);  // Remove receiver pushed earlier.
+  __ popq(RAX);  // Pop returned code object into RAX.
+  __ popq(RCX);  // Restore IC data array.
+  __ popq(RDX);  // Restore arguments array.
+  __ LeaveFrame();
+  __ cmpq(RAX, raw_null);
+  __ j(NOT_EQUAL, &call_target_function, Assembler::kNearJump);
+  // NoSuchMethod or closure.
+  __ jmp(&StubCode::MegamorphicLookupLabel());
+
+  __ Bind(&found);
+  __ movq(RAX, Address(RBX, kWordSize));  // Target function.
+
+  __ Bind(&call_target_function);
+  // RAX: Target function.
+  __ movq(RAX, FieldAddress(RAX, Function::code_offset()));
+  __ movq(RAX, FieldAddress(RAX, Code::instructions_offset()));
+  __ addq(RAX, Immediate(Instructions::HeaderSize() - kHeapObjectTag));
+  __ jmp(RAX);
 }
 
 }  // namespace dart
@@ -0,0 +1,121 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/thread_pool.h"
+
+#include "vm/assert.h"
+
+namespace dart {
+
+class ThreadPool::Task {
+ public:
+  Task(TaskFunction function, uword parameter)
+      : function_(function), parameter_(parameter), next_(NULL) {}
+
+  void Run() const { function_(parameter_); }
+
+  Task* next() const { return next_; }
+  void set_next(Task* value) { next_ = value; }
+
+ private:
+  TaskFunction function_;
+  uword parameter_;
+  Task* next_;
+
+  DISALLOW_COPY_AND_ASSIGN(Task);
+};
+
+
+ThreadPool::ThreadPool()
+    : monitor_(),
+      pending_(NULL),
+      pending_count_(0),
+      idle_count_(0),
+      thread_count_(0),
+      shutting_down_(false) {
+}
+
+
+ThreadPool::~ThreadPool() {
+  MonitorLocker ml(&monitor_);
+  shutting_down_ = true;
+  ml.NotifyAll();
+  while (thread_count_ > 0) {
+    ml.Wait();
+  }
+  ASSERT(pending_ == NULL);
+}
+
+
+void ThreadPool::Run(TaskFunction function, uword parameter) {
+  Task* task = new Task(function, parameter);
+  MonitorLocker ml(&monitor_);
+  ASSERT(!shutting_down_);
+  // Tasks are taken in the order they were added.
+  if (pending_ == NULL) {
+    pending_ = task;
+  } else {
+    Task* last = pending_;
+    while (last->next() != NULL) {
+      last = last->next();
+    }
+    last->set_next(task);
+  }
+  pending_count_++;
+  // Every pending task needs its own idle thread, the task could otherwise
+  // wait for a task queued behind it.
+  if (pending_count_ > idle_count_) {
+    idle_count_++;
+    thread_count_++;
+    new Thread(ThreadPool::WorkerMain, reinterpret_cast<uword>(this));
+  }
+  ml.NotifyAll();
+}
+
+
+intptr_t ThreadPool::thread_count() {
+  MonitorLocker ml(&monitor_);
+  return thread_count_;
+}
+
+
+intptr_t ThreadPool::idle_thread_count() {
+  MonitorLocker ml(&monitor_);
+  return idle_count_;
+}
+
+
+void ThreadPool::WorkerMain(uword parameter) {
+  ThreadPool* pool = reinterpret_cast<ThreadPool*>(parameter);
+  pool->Work();
+}
+
+
+void ThreadPool::Work() {
+  // The thread was counted as idle when it was started.
+  monitor_.Enter();
+  while (true) {
+    while ((pending_ == NULL) && !shutting_down_) {
+      monitor_.Wait(Monitor::kNoTimeout);
+    }
+    if (pending_ == NULL) {
+      break;
+    }
+    Task* task = pending_;
+    pending_ = task->next();
+    pending_count_--;
+    idle_count_--;
+    monitor_.Exit();
+    task->Run();
+    delete task;
+    monitor_.Enter();
+    idle_count_++;
+  }
+  idle_count_--;
+  thread_count_--;
+  monitor_.NotifyAll();
+  monitor_.Exit();
+}
+
+}  // namespace dart
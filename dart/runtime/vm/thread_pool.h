@@ -0,0 +1,58 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_THREAD_POOL_H_
+#define VM_THREAD_POOL_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+#include "vm/thread.h"
+
+namespace dart {
+
+// A pool of threads running short tasks, e.g., the helper tasks of the
+// garbage collector. Threads are started on demand and park on the monitor
+// of the pool between tasks, so that they are reused instead of being started
+// for every task. A task never waits for another task to finish before it is
+// started: tasks may synchronize with each other.
+class ThreadPool {
+ public:
+  typedef void (*TaskFunction)(uword parameter);
+
+  ThreadPool();
+
+  // Waits for the running tasks to finish and stops all threads.
+  ~ThreadPool();
+
+  // Run 'function' with 'parameter' on an idle thread of the pool, a new
+  // thread is started if all threads are busy.
+  void Run(TaskFunction function, uword parameter);
+
+  // Number of threads started by the pool and not stopped yet.
+  intptr_t thread_count();
+
+  // Number of threads of the pool not running a task.
+  intptr_t idle_thread_count();
+
+ private:
+  class Task;
+
+  static void WorkerMain(uword parameter);
+  void Work();
+
+  // Protects the fields below, which are shared with the pool threads.
+  Monitor monitor_;
+  Task* pending_;
+  intptr_t pending_count_;
+  // Number of pool threads not running a task.
+  intptr_t idle_count_;
+  intptr_t thread_count_;
+  bool shutting_down_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+};
+
+}  // namespace dart
+
+#endif  // VM_THREAD_POOL_H_
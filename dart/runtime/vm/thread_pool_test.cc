@@ -0,0 +1,92 @@
+// Copyright (c) 2011, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/assert.h"
+#include "vm/os.h"
+#include "vm/thread_pool.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+class TestTaskState {
+ public:
+  TestTaskState() : monitor_(), started_(0), finished_(0), release_(false) {}
+
+  // Tasks wait until all of them are started and they are released.
+  static void WaitingTask(uword parameter) {
+    TestTaskState* state = reinterpret_cast<TestTaskState*>(parameter);
+    MonitorLocker ml(&state->monitor_);
+    state->started_++;
+    ml.NotifyAll();
+    while (!state->release_) {
+      ml.Wait();
+    }
+    state->finished_++;
+    ml.NotifyAll();
+  }
+
+  void WaitForStarted(intptr_t count) {
+    MonitorLocker ml(&monitor_);
+    while (started_ < count) {
+      ml.Wait();
+    }
+  }
+
+  void Release() {
+    MonitorLocker ml(&monitor_);
+    release_ = true;
+    ml.NotifyAll();
+  }
+
+  void WaitForFinished(intptr_t count) {
+    MonitorLocker ml(&monitor_);
+    while (finished_ < count) {
+      ml.Wait();
+    }
+  }
+
+ private:
+  Monitor monitor_;
+  intptr_t started_;
+  intptr_t finished_;
+  bool release_;
+};
+
+
+UNIT_TEST_CASE(ThreadPoolRunsTasksConcurrently) {
+  ThreadPool pool;
+  TestTaskState state;
+  const intptr_t kTaskCount = 4;
+  for (intptr_t i = 0; i < kTaskCount; i++) {
+    pool.Run(TestTaskState::WaitingTask, reinterpret_cast<uword>(&state));
+  }
+  // Would not return if a task waited for another one to be started.
+  state.WaitForStarted(kTaskCount);
+  EXPECT_EQ(kTaskCount, pool.thread_count());
+  state.Release();
+  state.WaitForFinished(kTaskCount);
+}
+
+
+UNIT_TEST_CASE(ThreadPoolReusesThreads) {
+  ThreadPool pool;
+  const intptr_t kRounds = 10;
+  const intptr_t kTaskCount = 2;
+  for (intptr_t round = 0; round < kRounds; round++) {
+    TestTaskState state;
+    state.Release();
+    for (intptr_t i = 0; i < kTaskCount; i++) {
+      pool.Run(TestTaskState::WaitingTask, reinterpret_cast<uword>(&state));
+    }
+    state.WaitForFinished(kTaskCount);
+    // Let the threads return to the pool before the next round.
+    while (pool.idle_thread_count() < pool.thread_count()) {
+      OS::Sleep(1);
+    }
+  }
+  // The threads of the first round ran the tasks of the later rounds.
+  EXPECT_EQ(kTaskCount, pool.thread_count());
+}
+
+}  // namespace dart
@@ -16,6 +16,7 @@ DECLARE_FLAG(bool, verify_on_transition);
 #define VERIFY_ON_TRANSITION                                                   \
   if (FLAG_verify_on_transition) {                                             \
     VerifyPointersVisitor::VerifyPointers();                                   \
+    Isolate::Current()->heap()->CompleteSweeping();                            \
     Isolate::Current()->heap()->Verify();                                      \
   }                                                                            \
 
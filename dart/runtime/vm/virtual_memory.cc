@@ -5,16 +5,24 @@
 #include "vm/virtual_memory.h"
 
 #include "vm/assert.h"
+#include "vm/flags.h"
 #include "vm/utils.h"
 
 namespace dart {
 
+DEFINE_FLAG(bool, heap_huge_pages, false,
+    "Back the new space, the old space pages and the large objects of the "
+    "heap with transparent huge pages.");
+
 VirtualMemory* VirtualMemory::ReserveAligned(intptr_t size,
                                              intptr_t alignment) {
   ASSERT((size & (PageSize() - 1)) == 0);
   ASSERT(Utils::IsPowerOfTwo(alignment));
   ASSERT(alignment >= PageSize());
   VirtualMemory* result = VirtualMemory::Reserve(size + alignment);
+  if (result == NULL) {
+    return NULL;
+  }
   uword start = result->start();
   uword real_start = (start + alignment - 1) & ~(alignment - 1);
   result->Truncate(real_start, size);
@@ -22,6 +30,34 @@ VirtualMemory* VirtualMemory::ReserveAligned(intptr_t size,
 }
 
 
+VirtualMemory* VirtualMemory::ReserveHeapRegion(intptr_t size,
+                                                intptr_t alignment) {
+  if (!FLAG_heap_huge_pages || (size < kHugePageSize)) {
+    return ReserveAligned(size, alignment);
+  }
+  VirtualMemory* result =
+      ReserveAligned(size, Utils::Maximum(alignment, kHugePageSize));
+  if (result != NULL) {
+    result->huge_pages_ = true;
+  }
+  return result;
+}
+
+
+VirtualMemory* VirtualMemory::SplitOff(intptr_t split_size) {
+  ASSERT((split_size & (PageSize() - 1)) == 0);
+  ASSERT(split_size <= size());
+  if (reserved_pointer_ != NULL) {
+    return NULL;
+  }
+  MemoryRegion region(address(), split_size);
+  VirtualMemory* result = new VirtualMemory(region, NULL);
+  result->huge_pages_ = huge_pages_;
+  region_.Subregion(region_, split_size, size() - split_size);
+  return result;
+}
+
+
 void VirtualMemory::Truncate(uword new_start, intptr_t new_size) {
   ASSERT(new_start >= start());
   ASSERT((new_size & (PageSize() - 1)) == 0);
@@ -13,6 +13,9 @@ namespace dart {
 
 class VirtualMemory {
  public:
+  // Size and alignment of the transparent huge pages of the OS.
+  static const intptr_t kHugePageSize = 2 * MB;
+
   // The reserved memory is unmapped on destruction.
   ~VirtualMemory();
 
@@ -32,6 +35,10 @@ class VirtualMemory {
     return Commit(start(), size(), is_executable);
   }
 
+  // Returns the physical pages backing the committed range [addr, addr + size)
+  // to the OS. The range stays accessible, its contents are undefined.
+  void ReleasePages(uword addr, intptr_t size);
+
   // Reserves a virtual memory segment with size. If a segment of the requested
   // size cannot be allocated NULL is returned.
   static VirtualMemory* Reserve(intptr_t size);
@@ -40,6 +47,20 @@ class VirtualMemory {
   // the requested power of two.
   static VirtualMemory* ReserveAligned(intptr_t size, intptr_t alignment);
 
+  // Reserves a virtual memory segment for a heap region, aligned like
+  // ReserveAligned. With --heap_huge_pages, regions of at least kHugePageSize
+  // are aligned to kHugePageSize and backed by huge pages once committed, on
+  // operating systems which support it.
+  static VirtualMemory* ReserveHeapRegion(intptr_t size, intptr_t alignment);
+
+  // Committing this segment asks the OS to back it with huge pages.
+  bool uses_huge_pages() const { return huge_pages_; }
+
+  // Splits the first 'size' bytes off this segment into a new segment, which
+  // keeps their commit state and is unmapped on its own. Returns NULL on
+  // operating systems which cannot free sub-segments.
+  VirtualMemory* SplitOff(intptr_t size);
+
   static intptr_t PageSize() {
     ASSERT(page_size_ != 0);
     ASSERT(Utils::IsPowerOfTwo(page_size_));
@@ -58,7 +79,8 @@ class VirtualMemory {
   // It does not reserve any virtual address space on its own.
   VirtualMemory(const MemoryRegion& region, void* reserved_pointer) :
       region_(region.pointer(), region.size()),
-      reserved_pointer_(reserved_pointer) { }
+      reserved_pointer_(reserved_pointer),
+      huge_pages_(false) { }
 
   // Commit a reserved memory area, so that the memory can be accessed.
   bool Commit(uword addr, intptr_t size, bool is_executable);
@@ -73,6 +95,8 @@ class VirtualMemory {
   // truncated.
   void* reserved_pointer_;
 
+  bool huge_pages_;
+
   static uword page_size_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(VirtualMemory);
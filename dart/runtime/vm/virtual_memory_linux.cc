@@ -68,7 +68,22 @@ bool VirtualMemory::Commit(uword addr, intptr_t size, bool executable) {
   if (address == MAP_FAILED) {
     return false;
   }
+#if defined(MADV_HUGEPAGE)
+  // Only a hint, the kernel may not have transparent huge pages enabled.
+  if (huge_pages_) {
+    madvise(address, size, MADV_HUGEPAGE);
+  }
+#endif
   return true;
 }
 
+
+void VirtualMemory::ReleasePages(uword addr, intptr_t size) {
+  ASSERT(Contains(addr));
+  ASSERT(Contains(addr + size) || (addr + size == end()));
+  if (madvise(reinterpret_cast<void*>(addr), size, MADV_DONTNEED) != 0) {
+    FATAL("madvise failed\n");
+  }
+}
+
 }  // namespace dart
@@ -71,4 +71,13 @@ bool VirtualMemory::Commit(uword addr, intptr_t size, bool executable) {
   return true;
 }
 
+
+void VirtualMemory::ReleasePages(uword addr, intptr_t size) {
+  ASSERT(Contains(addr));
+  ASSERT(Contains(addr + size) || (addr + size == end()));
+  if (madvise(reinterpret_cast<void*>(addr), size, MADV_FREE) != 0) {
+    FATAL("madvise failed\n");
+  }
+}
+
 }  // namespace dart
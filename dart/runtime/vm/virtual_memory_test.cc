@@ -3,11 +3,14 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "vm/assert.h"
+#include "vm/flags.h"
 #include "vm/unit_test.h"
 #include "vm/virtual_memory.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, heap_huge_pages);
+
 UNIT_TEST_CASE(AllocateVirtualMemory) {
   const intptr_t kVirtualMemoryBlockSize = 64 * KB;
   VirtualMemory* vm = VirtualMemory::Reserve(kVirtualMemoryBlockSize);
@@ -44,4 +47,81 @@ UNIT_TEST_CASE(AllocateVirtualMemory) {
   delete vm;
 }
 
+
+UNIT_TEST_CASE(ReleaseVirtualMemoryPages) {
+  const intptr_t kVirtualMemoryBlockSize = 64 * KB;
+  VirtualMemory* vm = VirtualMemory::Reserve(kVirtualMemoryBlockSize);
+  EXPECT(vm != NULL);
+  vm->Commit(false);
+  char* buf = reinterpret_cast<char*>(vm->address());
+  buf[0] = 'a';
+  // The released range stays accessible.
+  vm->ReleasePages(vm->start(), vm->size());
+  buf[0] = 'b';
+  buf[kVirtualMemoryBlockSize - 1] = 'c';
+  EXPECT_EQ('b', buf[0]);
+  EXPECT_EQ('c', buf[kVirtualMemoryBlockSize - 1]);
+  delete vm;
+}
+
+
+UNIT_TEST_CASE(ReserveHeapRegion) {
+  const bool saved_huge_pages = FLAG_heap_huge_pages;
+  const intptr_t kAlignment = 256 * KB;
+  FLAG_heap_huge_pages = false;
+  VirtualMemory* vm =
+      VirtualMemory::ReserveHeapRegion(VirtualMemory::kHugePageSize,
+                                       kAlignment);
+  EXPECT(vm != NULL);
+  EXPECT((vm->start() & (kAlignment - 1)) == 0);
+  EXPECT(!vm->uses_huge_pages());
+  delete vm;
+
+  FLAG_heap_huge_pages = true;
+  // Regions smaller than a huge page are reserved as before.
+  vm = VirtualMemory::ReserveHeapRegion(kAlignment, kAlignment);
+  EXPECT(vm != NULL);
+  EXPECT(!vm->uses_huge_pages());
+  delete vm;
+  vm = VirtualMemory::ReserveHeapRegion(2 * VirtualMemory::kHugePageSize,
+                                        kAlignment);
+  EXPECT(vm != NULL);
+  EXPECT(vm->uses_huge_pages());
+  EXPECT((vm->start() & (VirtualMemory::kHugePageSize - 1)) == 0);
+  EXPECT_EQ(2 * VirtualMemory::kHugePageSize, vm->size());
+  EXPECT(vm->Commit(false));
+  char* buf = reinterpret_cast<char*>(vm->address());
+  buf[0] = 'a';
+  buf[vm->size() - 1] = 'b';
+  EXPECT_EQ('a', buf[0]);
+  EXPECT_EQ('b', buf[vm->size() - 1]);
+  delete vm;
+  FLAG_heap_huge_pages = saved_huge_pages;
+}
+
+
+UNIT_TEST_CASE(SplitOffVirtualMemory) {
+  const intptr_t kSplitSize = 64 * KB;
+  VirtualMemory* vm = VirtualMemory::Reserve(4 * kSplitSize);
+  EXPECT(vm != NULL);
+  EXPECT(vm->Commit(false));
+  uword start = vm->start();
+  VirtualMemory* first = vm->SplitOff(kSplitSize);
+  if (first == NULL) {
+    // Sub-segments cannot be freed on this operating system.
+    delete vm;
+    return;
+  }
+  EXPECT_EQ(start, first->start());
+  EXPECT_EQ(kSplitSize, first->size());
+  EXPECT_EQ(start + kSplitSize, vm->start());
+  EXPECT_EQ(3 * kSplitSize, vm->size());
+  // The split off segment stays committed and is unmapped on its own.
+  char* buf = reinterpret_cast<char*>(vm->address());
+  buf[0] = 'a';
+  delete first;
+  EXPECT_EQ('a', buf[0]);
+  delete vm;
+}
+
 }  // namespace dart
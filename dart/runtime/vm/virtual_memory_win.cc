@@ -58,4 +58,14 @@ bool VirtualMemory::Commit(uword addr, intptr_t size, bool executable) {
   return true;
 }
 
+
+void VirtualMemory::ReleasePages(uword addr, intptr_t size) {
+  ASSERT(Contains(addr));
+  ASSERT(Contains(addr + size) || (addr + size == end()));
+  if (VirtualAlloc(reinterpret_cast<void*>(addr), size, MEM_RESET,
+                   PAGE_READWRITE) == NULL) {
+    FATAL("VirtualAlloc failed");
+  }
+}
+
 }  // namespace dart